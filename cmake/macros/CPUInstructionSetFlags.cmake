@@ -97,9 +97,12 @@ IF(CPU_i386 OR CPU_amd64)
 			SET(SSSE3_FLAG "/arch:SSE2")
 			SET(SSE41_FLAG "/arch:SSE2")
 		ENDIF(CPU_i386)
+		SET(AVX2_FLAG "/arch:AVX2")
 		IF(CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
 			SET(SSSE3_FLAG "-mssse3")
 			SET(SSE41_FLAG "-msse4.1")
+			SET(AVX2_FLAG "-mavx2")
+			SET(AES_FLAG "-msse2 -maes")
 		ENDIF(CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
 	ELSE()
 		IF(CPU_i386)
@@ -108,6 +111,8 @@ IF(CPU_i386 OR CPU_amd64)
 		ENDIF(CPU_i386)
 		SET(SSSE3_FLAG "-mssse3")
 		SET(SSE41_FLAG "-msse4.1")
+		SET(AVX2_FLAG "-mavx2")
+		SET(AES_FLAG "-msse2 -maes")
 	ENDIF()
 ENDIF(CPU_i386 OR CPU_amd64)
 
@@ -129,4 +134,10 @@ IF(CPU_arm OR CPU_arm64 OR CPU_arm64ec)
 			SET(NEON_FLAG "${NEON_FLAG} -fno-lto")
 		ENDIF(ENABLE_LTO)
 	ENDIF(CPU_arm AND NOT MSVC)
+
+	# ARMv8 Crypto Extensions (AES)
+	# MSVC always has the crypto intrinsics available on arm64.
+	IF(CPU_arm64 AND NOT MSVC)
+		SET(ARMV8_CRYPTO_FLAG "-march=armv8-a+crypto")
+	ENDIF(CPU_arm64 AND NOT MSVC)
 ENDIF(CPU_arm OR CPU_arm64 OR CPU_arm64ec)
@@ -18,6 +18,7 @@
 #include "librpbase/config/Config.hpp"
 #include "librpbase/img/RpPngWriter.hpp"
 #include "librpbase/RomData.hpp"
+#include "librpfile/CachedFile.hpp"
 #include "librpfile/FileSystem.hpp"
 #include "libromdata/RomDataFactory.hpp"
 using namespace LibRpBase;
@@ -114,6 +115,16 @@ public:
 		return PIMGTYPE_scale(imgClass, sz.width, sz.height, (method == ScalingMethod::Bilinear));
 	}
 
+	/**
+	 * Should internal images be rescaled using rp_image::scaled()?
+	 * @return True to use rp_image::scaled(); false to use rescaleImgClass().
+	 */
+	bool useNativeScaler(void) const final
+	{
+		// Use rp_image::scaled() so thumbnails match the other frontends.
+		return true;
+	}
+
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
@@ -267,9 +278,10 @@ static RomDataPtr openFromFilenameOrURI(const char *source_file, string &s_uri,
 			}
 
 			// Open the file using RpFileGio.
+			// Each read is a round-trip to GVfs, so wrap it in CachedFile.
 			// TODO: Directories using RpFileGio?
-			const IRpFilePtr file = std::make_shared<RpFileGio>(source_file);
-			if (!file) {
+			const IRpFilePtr file = std::make_shared<CachedFile>(std::make_shared<RpFileGio>(source_file));
+			if (!file->isOpen()) {
 				// Could not open the file.
 				if (p_err) {
 					*p_err = RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
@@ -439,6 +451,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(
 		ret = RPCT_ERROR_OUTPUT_FILE_FAILED;
 		goto cleanup;
 	}
+	pngWriter.setEncodeProfile(Config::instance()->pngEncodeProfile());
 
 	/** tEXt chunks. **/
 	// NOTE: These are written before IHDR in order to put the
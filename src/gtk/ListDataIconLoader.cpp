@@ -0,0 +1,239 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * ListDataIconLoader.cpp: On-demand icon conversion for RFT_LISTDATA.     *
+ *                                                                         *
+ * Copyright (c) 2017-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ListDataIconLoader.hpp"
+
+using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_const_ptr;
+
+// C++ STL classes
+#include <deque>
+using std::deque;
+using std::vector;
+
+// Maximum number of converted icons to keep.
+// This should be larger than the number of rows visible at once.
+static constexpr size_t MAX_ICONS = 128;
+
+// Row states
+enum class RowState : uint8_t {
+	None = 0,	// Not converted
+	Pending,	// Queued for conversion
+	Loaded,		// Converted
+};
+
+struct _RpListDataIconLoader {
+	vector<rp_image_const_ptr> icons;
+	vector<RowState> state;		// Main thread only
+	deque<guint> loaded;		// Main thread only; oldest first
+	int icon_sz;
+
+	GObject *target;
+	RpListDataIconReadyFunc func;
+
+	GThreadPool *pool;
+	gint refcnt;
+	gint cancelled;
+};
+
+// Converted icon, passed from the worker thread to the main thread.
+struct IconReadyData {
+	RpListDataIconLoader *loader;
+	guint row;
+	PIMGTYPE icon;
+};
+
+static void
+rp_list_data_icon_loader_unref(RpListDataIconLoader *loader)
+{
+	if (g_atomic_int_dec_and_test(&loader->refcnt)) {
+		g_object_unref(loader->target);
+		delete loader;
+	}
+}
+
+/**
+ * Convert an icon. (Worker thread)
+ * @param icon		[in] rp_image
+ * @param icon_sz	[in] Icon size, or 0 to not scale the icon
+ * @return PIMGTYPE, or nullptr on error.
+ */
+static PIMGTYPE
+convert_icon(const rp_image *icon, int icon_sz)
+{
+	PIMGTYPE pixbuf = rp_image_to_PIMGTYPE(icon);
+	if (!pixbuf || icon_sz <= 0) {
+		// NOTE: GtkPicture *can* scale the pixbuf itself.
+		return pixbuf;
+	}
+
+#if defined(RP_GTK_USE_CAIRO)
+	// NOTE: Assuming square icons.
+	int icon_w = icon->width();
+	int icon_h = icon->height();
+	if (icon_w > icon_sz || icon_h > icon_sz) {
+		// Instead of scaling icons down, set a device pixel ratio.
+		// This allows for higher-resolution display on high-DPI screens.
+		const float scale_x = static_cast<float>(icon_w) / static_cast<float>(icon_sz);
+		const float scale_y = static_cast<float>(icon_h) / static_cast<float>(icon_sz);
+		cairo_surface_set_device_scale(pixbuf, scale_x, scale_y);
+	} else if (icon_w > 0 && icon_h > 0) {
+		// Scale up using integer scaling, then set a device pixel ratio.
+		while (icon_w < icon_sz) {
+			icon_w += icon->width();
+			icon_h += icon->height();
+		}
+		PIMGTYPE scaled = PIMGTYPE_scale(pixbuf, icon_w, icon_h, true);
+		if (scaled) {
+			PIMGTYPE_unref(pixbuf);
+			pixbuf = scaled;
+
+			const float scale_x = static_cast<float>(icon_w) / static_cast<float>(icon_sz);
+			const float scale_y = static_cast<float>(icon_h) / static_cast<float>(icon_sz);
+			cairo_surface_set_device_scale(pixbuf, scale_x, scale_y);
+		}
+	}
+#elif !defined(RP_GTK_USE_GDKTEXTURE)
+	// Cannot use device scale factor with GdkPixbuf.
+	// Resize the icon manually.
+	// TODO: Get the X11 dpi?
+	if (!PIMGTYPE_size_check(pixbuf, icon_sz, icon_sz)) {
+		// TODO: Use nearest-neighbor if upscaling.
+		// Also, preserve the aspect ratio.
+		PIMGTYPE scaled = PIMGTYPE_scale(pixbuf, icon_sz, icon_sz, true);
+		if (scaled) {
+			PIMGTYPE_unref(pixbuf);
+			pixbuf = scaled;
+		}
+	}
+#endif /* RP_GTK_USE_CAIRO */
+
+	return pixbuf;
+}
+
+/**
+ * An icon has been converted. (Main thread)
+ * @param data IconReadyData
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+icon_ready_idle(IconReadyData *data)
+{
+	RpListDataIconLoader *const loader = data->loader;
+	if (!g_atomic_int_get(&loader->cancelled)) {
+		loader->state[data->row] = RowState::Loaded;
+		loader->loaded.push_back(data->row);
+		loader->func(loader->target, data->row, data->icon);
+
+		// Evict the oldest icons if we have too many.
+		while (loader->loaded.size() > MAX_ICONS) {
+			const guint row = loader->loaded.front();
+			loader->loaded.pop_front();
+			loader->state[row] = RowState::None;
+			loader->func(loader->target, row, nullptr);
+		}
+	}
+
+	if (data->icon) {
+		PIMGTYPE_unref(data->icon);
+	}
+	rp_list_data_icon_loader_unref(loader);
+	g_free(data);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Icon conversion worker function. (Worker thread)
+ * @param data Row index, plus 1
+ * @param loader RpListDataIconLoader
+ */
+static void
+icon_worker(gpointer data, RpListDataIconLoader *loader)
+{
+	if (g_atomic_int_get(&loader->cancelled)) {
+		return;
+	}
+
+	const guint row = GPOINTER_TO_UINT(data) - 1;
+	IconReadyData *const ready = g_new(IconReadyData, 1);
+	ready->loader = loader;
+	ready->row = row;
+	ready->icon = convert_icon(loader->icons[row].get(), loader->icon_sz);
+
+	g_atomic_int_inc(&loader->refcnt);
+	g_idle_add(reinterpret_cast<GSourceFunc>(icon_ready_idle), ready);
+}
+
+/**
+ * Create an RFT_LISTDATA icon loader.
+ * @param icons		[in] RFT_LISTDATA icons (copied)
+ * @param icon_sz	[in] Icon size, or 0 to not scale the icons
+ * @param target	[in] Target object (a reference will be taken)
+ * @param func		[in] Icon ready callback
+ * @return RpListDataIconLoader
+ */
+RpListDataIconLoader *
+rp_list_data_icon_loader_new(const vector<rp_image_const_ptr> &icons,
+	int icon_sz, GObject *target, RpListDataIconReadyFunc func)
+{
+	RpListDataIconLoader *const loader = new RpListDataIconLoader;
+	loader->icons = icons;
+	loader->state.resize(icons.size(), RowState::None);
+	loader->icon_sz = icon_sz;
+	loader->target = G_OBJECT(g_object_ref(target));
+	loader->func = func;
+	loader->refcnt = 1;
+	loader->cancelled = 0;
+
+	// A single worker thread is sufficient here, since only
+	// visible rows are converted.
+	loader->pool = g_thread_pool_new(reinterpret_cast<GFunc>(icon_worker),
+		loader, 1, false, nullptr);
+	return loader;
+}
+
+/**
+ * Free an RFT_LISTDATA icon loader.
+ * Pending requests are cancelled.
+ * @param loader RpListDataIconLoader
+ */
+void
+rp_list_data_icon_loader_free(RpListDataIconLoader *loader)
+{
+	g_atomic_int_set(&loader->cancelled, 1);
+
+	// Drop pending requests and wait for the current conversion to finish.
+	// Idle callbacks that are already queued hold their own references.
+	g_thread_pool_free(loader->pool, true, true);
+	loader->pool = nullptr;
+
+	rp_list_data_icon_loader_unref(loader);
+}
+
+/**
+ * Request an icon.
+ * If the icon hasn't been converted yet, it will be converted
+ * in a worker thread, and the callback will be called once it's ready.
+ * @param loader	[in] RpListDataIconLoader
+ * @param row		[in] Row index
+ */
+void
+rp_list_data_icon_loader_request(RpListDataIconLoader *loader, guint row)
+{
+	assert(row < loader->icons.size());
+	if (row >= loader->icons.size() || !loader->icons[row] ||
+	    loader->state[row] != RowState::None)
+	{
+		// Invalid row, no icon, or already converted/pending.
+		return;
+	}
+
+	// NOTE: GThreadPool doesn't allow nullptr data, so add 1 to the row index.
+	loader->state[row] = RowState::Pending;
+	g_thread_pool_push(loader->pool, GUINT_TO_POINTER(row + 1), nullptr);
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * ListDataIconLoader.hpp: On-demand icon conversion for RFT_LISTDATA.     *
+ *                                                                         *
+ * Copyright (c) 2017-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "PIMGTYPE.hpp"
+
+// C++ includes
+#include <vector>
+
+/**
+ * RFT_LISTDATA icon loader.
+ *
+ * Icons are converted from rp_image to PIMGTYPE in a worker thread
+ * when a row is requested, i.e. when the row becomes visible.
+ * Converted icons are handed back to the main thread using the
+ * ListDataIconReadyFunc callback.
+ *
+ * The number of converted icons is bounded. If the limit is exceeded,
+ * the least-recently converted icon is evicted by calling the callback
+ * with icon == nullptr. The row will be converted again if requested.
+ */
+typedef struct _RpListDataIconLoader RpListDataIconLoader;
+
+/**
+ * Icon ready callback. Always called on the main thread.
+ * @param target	[in] Target object (e.g. GtkListStore)
+ * @param row		[in] Row index
+ * @param icon		[in] Icon, or nullptr if the icon was evicted (caller must take a reference)
+ */
+typedef void (*RpListDataIconReadyFunc)(GObject *target, guint row, PIMGTYPE icon);
+
+/**
+ * Create an RFT_LISTDATA icon loader.
+ * @param icons		[in] RFT_LISTDATA icons (copied)
+ * @param icon_sz	[in] Icon size, or 0 to not scale the icons
+ * @param target	[in] Target object (a reference will be taken)
+ * @param func		[in] Icon ready callback
+ * @return RpListDataIconLoader
+ */
+RpListDataIconLoader *rp_list_data_icon_loader_new(
+	const std::vector<LibRpTexture::rp_image_const_ptr> &icons,
+	int icon_sz, GObject *target, RpListDataIconReadyFunc func);
+
+/**
+ * Free an RFT_LISTDATA icon loader.
+ * Pending requests are cancelled.
+ * @param loader RpListDataIconLoader
+ */
+void rp_list_data_icon_loader_free(RpListDataIconLoader *loader);
+
+/**
+ * Request an icon.
+ * If the icon hasn't been converted yet, it will be converted
+ * in a worker thread, and the callback will be called once it's ready.
+ * @param loader	[in] RpListDataIconLoader
+ * @param row		[in] Row index
+ */
+void rp_list_data_icon_loader_request(RpListDataIconLoader *loader, guint row);
@@ -262,7 +262,7 @@ rp_list_data_item_set_icon(RpListDataItem *item, PIMGTYPE icon)
 	if (item->icon) {
 		PIMGTYPE_unref(item->icon);
 	}
-	item->icon = PIMGTYPE_ref(icon);
+	item->icon = (icon) ? PIMGTYPE_ref(icon) : NULL;
 
 	g_object_notify_by_pspec(G_OBJECT(item), props[PROP_ICON]);
 }
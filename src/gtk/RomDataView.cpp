@@ -26,7 +26,11 @@ using namespace LibRpBase;
 using namespace LibRpTexture;
 
 // C++ STL classes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
@@ -54,6 +58,8 @@ static GParamSpec *props[PROP_LAST];
 // NOTE: Don't make these static. They're needed in RomDataView_ops.cpp.
 GQuark RFT_BITFIELD_value_quark = 0;
 GQuark RFT_LISTDATA_rows_visible_quark = 0;
+GQuark RFT_LISTDATA_icon_loader_quark = 0;
+GQuark RFT_LISTDATA_row_quark = 0;
 GQuark RFT_fieldIdx_quark = 0;
 GQuark RFT_STRING_warning_quark = 0;
 
@@ -78,6 +84,10 @@ static void	rp_rom_data_view_adjust_image_height	(RpDragImage	*image,
 static void	rp_rom_data_view_init_header_row(RpRomDataView	*page);
 static gboolean	rp_rom_data_view_update_display	(RpRomDataView	*page);
 static gboolean	rp_rom_data_view_load_rom_data	(RpRomDataView	*page);
+static void	rp_rom_data_view_start_loader	(RpRomDataView	*page,
+						 const RomDataPtr &romData);
+static void	rp_rom_data_view_cancel_loader	(RpRomDataView	*page);
+static void	rp_rom_data_view_finish_loader	(RpRomDataView	*page);
 static void	rp_rom_data_view_delete_tabs	(RpRomDataView	*page);
 
 /** Signal handlers **/
@@ -99,6 +109,53 @@ static void	cboLanguage_notify_selected_lc_handler(RpLanguageComboBox *widget,
 #  define MARGIN_END   "margin-right"
 #endif /* GTK_CHECK_VERSION(3, 11, 2) */
 
+/**
+ * Header row information.
+ * Copied out of the RomData object so the header row can be
+ * shown while the RomData object is still being loaded.
+ */
+struct RomDataViewHeaderInfo {
+	string sysInfo;				// System name and file type
+	rp_image_const_ptr banner;		// Internal banner
+	rp_image_const_ptr icon;		// Internal icon
+	IconAnimDataConstPtr iconAnimData;	// Animated icon data
+	bool ecksBawks = false;
+};
+
+/**
+ * Asynchronous RomData loader.
+ *
+ * The RomData object is opened and its fields are loaded in a worker
+ * thread, so slow parsing and decryption (e.g. large disc images on
+ * network filesystems) doesn't block the main loop. The header row is
+ * shown first, then the tabs once the fields have been loaded.
+ *
+ * The loader is shared by the RomDataView and the worker thread.
+ * RomData objects aren't thread-safe, so the RomDataView doesn't
+ * touch the RomData object until the worker thread is done with it.
+ */
+struct RomDataViewLoader {
+	RpRomDataView *page = nullptr;	// RomDataView (nullptr if cancelled) [main thread only]
+	gchar *uri = nullptr;		// URI to open if romData is nullptr
+	RomDataPtr romData;		// RomData object
+	RomDataViewHeaderInfo header;	// Header row information
+
+	// NOTE: RomData functions can't be interrupted, so cancellation
+	// is only checked between loading steps.
+	std::atomic<bool> cancelled{false};
+
+	// Set once the worker thread is done with romData.
+	std::mutex mtx;
+	std::condition_variable cond;
+	bool done = false;
+
+	~RomDataViewLoader()
+	{
+		g_free(uri);
+	}
+};
+typedef shared_ptr<RomDataViewLoader> RomDataViewLoaderPtr;
+
 // NOTE: G_DEFINE_TYPE() doesn't work in C++ mode with gcc-6.2
 // due to an implicit int to GTypeFlags conversion.
 G_DEFINE_TYPE_EXTENDED(RpRomDataView, rp_rom_data_view,
@@ -119,6 +176,8 @@ rp_rom_data_view_class_init(RpRomDataViewClass *klass)
 	// because the extension can be unloaded.
 	RFT_BITFIELD_value_quark = g_quark_from_string("RFT_BITFIELD_value");
 	RFT_LISTDATA_rows_visible_quark = g_quark_from_string("RFT_LISTDATA_rows_visible");
+	RFT_LISTDATA_icon_loader_quark = g_quark_from_string("RFT_LISTDATA_icon_loader");
+	RFT_LISTDATA_row_quark = g_quark_from_string("RFT_LISTDATA_row");
 	RFT_fieldIdx_quark = g_quark_from_string("RFT_fieldIdx");
 	RFT_STRING_warning_quark = g_quark_from_string("RFT_STRING_warning");
 
@@ -368,6 +427,9 @@ rp_rom_data_view_dispose(GObject *object)
 	// Unregister changed_idle.
 	g_clear_handle_id(&page->changed_idle, g_source_remove);
 
+	// Cancel the RomData loader.
+	rp_rom_data_view_cancel_loader(page);
+
 	// Delete the icon frames and tabs.
 	rp_rom_data_view_delete_tabs(page);
 
@@ -417,19 +479,14 @@ rp_rom_data_view_new_with_romData(const gchar *uri, const RomDataPtr &romData, R
 		g_object_new(RP_TYPE_ROM_DATA_VIEW, "desc_format_type", desc_format_type, nullptr));
 	if (uri) {
 		page->uri = g_strdup(uri);
-		if (romData) {
-			page->cxx->romData = romData;
-			// NOTE: Not emitting this notification here...
-			//g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
-		}
 	}
 
 	if (G_LIKELY((bool)romData)) {
 		// NOTE: Don't call rp_rom_data_view_load_rom_data() because that will
 		// close and reopen romData, which wastes CPU cycles.
-		// Call rp_rom_data_view_update_display() instead.
-		page->changed_idle = g_idle_add(G_SOURCE_FUNC(rp_rom_data_view_update_display), page);
-		page->hasCheckedAchievements = false;
+		// Load the fields from the existing RomData object instead.
+		// NOTE: page->cxx->romData is set once the loader is finished.
+		rp_rom_data_view_start_loader(page, romData);
 	} else if (G_LIKELY(uri != nullptr)) {
 		// URI is specified, but not RomData.
 		// We'll need to create a RomData object.
@@ -529,6 +586,9 @@ rp_rom_data_view_set_uri(RpRomDataView	*page,
 	if (G_LIKELY(page->uri != nullptr)) {
 		g_clear_pointer(&page->uri, g_free);
 
+		// Cancel the RomData loader, if it's running.
+		rp_rom_data_view_cancel_loader(page);
+
 		// Unreference the existing RomData object.
 		page->cxx->romData.reset();
 		page->hasCheckedAchievements = false;
@@ -628,18 +688,29 @@ rp_rom_data_view_is_showing_data(RpRomDataView *page)
 {
 	g_return_val_if_fail(RP_IS_ROM_DATA_VIEW(page), false);
 
-	// If page->changed_idle is non-zero, the display hasn't been updated yet.
-	// Update it, then clear the idle timeout.
+	// If page->changed_idle is non-zero, the RomData object hasn't been loaded yet.
+	// Start loading it, then clear the idle timeout.
 	const guint changed_idle = page->changed_idle;
 	if (changed_idle != 0) {
-		gboolean ret = rp_rom_data_view_update_display(page);
+		gboolean ret = rp_rom_data_view_load_rom_data(page);
 		if (ret == G_SOURCE_REMOVE) {
-			// rp_rom_data_view_update_display() sets page->changed_idle to 0,
+			// rp_rom_data_view_load_rom_data() sets page->changed_idle to 0,
 			// but expects the caller to actually remove the source.
 			g_source_remove(changed_idle);
 		}
 	}
 
+	// If the RomData object is still being loaded, wait for the worker thread.
+	// NOTE: Not iterating the main loop here, since callers expect
+	// this function to return without dispatching other events.
+	if (page->cxx->loader) {
+		RomDataViewLoader *const loader = page->cxx->loader.get();
+		std::unique_lock<std::mutex> lock(loader->mtx);
+		loader->cond.wait(lock, [loader] { return loader->done; });
+		lock.unlock();
+		rp_rom_data_view_finish_loader(page);
+	}
+
 	return (bool)page->cxx->romData;
 }
 
@@ -668,22 +739,17 @@ rp_rom_data_view_adjust_image_height(RpDragImage *image, int img_w, int img_h, i
 	}
 }
 
+/**
+ * Get the header row information from a RomData object.
+ * This can be called from a worker thread, as long as the
+ * caller has exclusive access to the RomData object.
+ *
+ * @param romData	[in] RomData object
+ * @param info		[out] Header row information
+ */
 static void
-rp_rom_data_view_init_header_row(RpRomDataView *page)
+rp_rom_data_view_get_header_info(const RomData *romData, RomDataViewHeaderInfo &info)
 {
-	// Initialize the header row.
-	assert(page != nullptr);
-
-	// NOTE: romData might be nullptr in some cases.
-	const RomData *const romData = page->cxx->romData.get();
-	//assert(romData != nullptr);
-	if (!romData) {
-		// No ROM data.
-		// Hide the widgets.
-		gtk_widget_set_visible(page->hboxHeaderRow, false);
-		return;
-	}
-
 	// System name and file type.
 	// TODO: System logo and/or game title?
 	const char *systemName = romData->systemName(
@@ -698,77 +764,136 @@ rp_rom_data_view_init_header_row(RpRomDataView *page)
 		fileType = C_("RomDataView", "(unknown filetype)");
 	}
 
-	const string sysInfo = fmt::format(
+	info.sysInfo = fmt::format(
 		// tr: {0:s} == system name, {1:s} == file type
 		FRUN(C_("RomDataView", "{0:s}\n{1:s}")), systemName, fileType);
-	gtk_label_set_text(GTK_LABEL(page->lblSysInfo), sysInfo.c_str());
 
 	// Supported image types.
 	const uint32_t imgbf = romData->supportedImageTypes();
+
+	// Banner
+	if (imgbf & RomData::IMGBF_INT_BANNER) {
+		info.banner = romData->image(RomData::IMG_INT_BANNER);
+	}
+
+	// Icon
+	if (imgbf & RomData::IMGBF_INT_ICON) {
+		info.icon = romData->image(RomData::IMG_INT_ICON);
+		if (info.icon && info.icon->isValid()) {
+			// Is this an animated icon?
+			info.iconAnimData = romData->iconAnimData();
+		}
+	}
+
+	info.ecksBawks = (romData->fileType() == RomData::FileType::DiscImage &&
+	                  strstr(systemName, "Xbox") != nullptr);
+}
+
+/**
+ * Set the header row widgets.
+ * @param page RomDataView
+ * @param info Header row information
+ */
+static void
+rp_rom_data_view_set_header_row(RpRomDataView *page, const RomDataViewHeaderInfo &info)
+{
+	gtk_label_set_text(GTK_LABEL(page->lblSysInfo), info.sysInfo.c_str());
+
 	// FIXME: Store the standard image height somewhere else.
 	static constexpr int imgStdHeight = 32;
 	bool ok = false;
 
 	// Banner
 	gtk_widget_set_visible(page->imgBanner, false);
-	if (imgbf & RomData::IMGBF_INT_BANNER) {
-		// Get the banner.
-		const rp_image_const_ptr img = romData->image(RomData::IMG_INT_BANNER);
-		ok = rp_drag_image_set_rp_image(RP_DRAG_IMAGE(page->imgBanner), img);
+	if (info.banner) {
+		ok = rp_drag_image_set_rp_image(RP_DRAG_IMAGE(page->imgBanner), info.banner);
 		if (ok) {
 			// Adjust the banner size.
-			rp_rom_data_view_adjust_image_height(RP_DRAG_IMAGE(page->imgBanner), img->width(), img->height(), imgStdHeight);
+			rp_rom_data_view_adjust_image_height(RP_DRAG_IMAGE(page->imgBanner),
+				info.banner->width(), info.banner->height(), imgStdHeight);
 		}
 	}
 	gtk_widget_set_visible(page->imgBanner, ok);
 
 	// Icon
-	if (imgbf & RomData::IMGBF_INT_ICON) {
-		// Get the icon.
-		const rp_image_const_ptr icon = romData->image(RomData::IMG_INT_ICON);
-		if (icon && icon->isValid()) {
-			int icon_w = -1, icon_h = -1;
-
-			// Is this an animated icon?
-			const IconAnimDataConstPtr iconAnimData = romData->iconAnimData();
-			ok = rp_drag_image_set_icon_anim_data(RP_DRAG_IMAGE(page->imgIcon), iconAnimData);
-			if (ok) {
-				// Get the size of the first animated icon frame.
-				rp_image_const_ptr img = iconAnimData->frame0();
-				assert((bool)img);
-				if (img) {
-					icon_w = img->width();
-					icon_h = img->height();
-				} else {
-					// Invalid icon frame?
-					rp_drag_image_set_icon_anim_data(RP_DRAG_IMAGE(page->imgIcon), nullptr);
-					ok = false;
-				}
-			}
-			if (!ok) {
-				// Not an animated icon, or invalid icon data.
-				// Set the static icon.
-				ok = rp_drag_image_set_rp_image(RP_DRAG_IMAGE(page->imgIcon), icon);
-				if (ok) {
-					icon_w = icon->width();
-					icon_h = icon->height();
-				}
+	ok = false;
+	const rp_image_const_ptr &icon = info.icon;
+	if (icon && icon->isValid()) {
+		int icon_w = -1, icon_h = -1;
+
+		// Is this an animated icon?
+		const IconAnimDataConstPtr &iconAnimData = info.iconAnimData;
+		ok = rp_drag_image_set_icon_anim_data(RP_DRAG_IMAGE(page->imgIcon), iconAnimData);
+		if (ok) {
+			// Get the size of the first animated icon frame.
+			rp_image_const_ptr img = iconAnimData->frame0();
+			assert((bool)img);
+			if (img) {
+				icon_w = img->width();
+				icon_h = img->height();
+			} else {
+				// Invalid icon frame?
+				rp_drag_image_set_icon_anim_data(RP_DRAG_IMAGE(page->imgIcon), nullptr);
+				ok = false;
 			}
-
+		}
+		if (!ok) {
+			// Not an animated icon, or invalid icon data.
+			// Set the static icon.
+			ok = rp_drag_image_set_rp_image(RP_DRAG_IMAGE(page->imgIcon), icon);
 			if (ok) {
-				// Adjust the icon size.
-				rp_rom_data_view_adjust_image_height(RP_DRAG_IMAGE(page->imgIcon), icon_w, icon_h, imgStdHeight);
+				icon_w = icon->width();
+				icon_h = icon->height();
 			}
 		}
+
+		if (ok) {
+			// Adjust the icon size.
+			rp_rom_data_view_adjust_image_height(RP_DRAG_IMAGE(page->imgIcon), icon_w, icon_h, imgStdHeight);
+		}
 	}
 	gtk_widget_set_visible(page->imgIcon, ok);
 
-	// Show the header row. (outer box)
+	// Show the header row.
+	gtk_widget_set_visible(page->hboxHeaderRow, true);
 	gtk_widget_set_visible(page->hboxHeaderRow_outer, true);
 
-	const bool ecksBawks = (romData->fileType() == RomData::FileType::DiscImage &&
-	                        systemName && strstr(systemName, "Xbox") != nullptr);
-	rp_drag_image_set_ecks_bawks(RP_DRAG_IMAGE(page->imgIcon), ecksBawks);
+	rp_drag_image_set_ecks_bawks(RP_DRAG_IMAGE(page->imgIcon), info.ecksBawks);
+}
+
+static void
+rp_rom_data_view_init_header_row(RpRomDataView *page)
+{
+	// Initialize the header row.
+	assert(page != nullptr);
+
+	// NOTE: romData might be nullptr in some cases.
+	const RomData *const romData = page->cxx->romData.get();
+	//assert(romData != nullptr);
+	if (!romData) {
+		// No ROM data.
+		// Hide the widgets.
+		gtk_widget_set_visible(page->hboxHeaderRow, false);
+		return;
+	}
+
+	RomDataViewHeaderInfo info;
+	rp_rom_data_view_get_header_info(romData, info);
+	rp_rom_data_view_set_header_row(page, info);
+}
+
+/**
+ * Show a placeholder in the header row while the RomData object is loading.
+ * @param page RomDataView
+ */
+static void
+rp_rom_data_view_show_loading(RpRomDataView *page)
+{
+	gtk_label_set_text(GTK_LABEL(page->lblSysInfo), C_("RomDataView", "Loading..."));
+	gtk_widget_set_visible(page->imgBanner, false);
+	gtk_widget_set_visible(page->imgIcon, false);
+	gtk_widget_set_visible(page->hboxHeaderRow, true);
+	gtk_widget_set_visible(page->hboxHeaderRow_outer, true);
 }
 
 /**
@@ -1755,21 +1880,165 @@ rp_rom_data_view_load_rom_data(RpRomDataView *page)
 		g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
 	}
 
-	// Load the specified URI.
-	page->cxx->romData = rp_gtk_open_uri(page->uri);
-	if (page->cxx->romData) {
-		page->hasCheckedAchievements = false;
+	// Load the specified URI in a worker thread.
+	rp_rom_data_view_start_loader(page, nullptr);
+
+	// Clear the timeout.
+	page->changed_idle = 0;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * RomData loader: The header row information is available.
+ * @param pLoader RomDataViewLoaderPtr (owned by this callback)
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_rom_data_view_loader_header_ready_idle(RomDataViewLoaderPtr *pLoader)
+{
+	RpRomDataView *const page = (*pLoader)->page;
+	if (page) {
+		// Not cancelled. Show the header row.
+		rp_rom_data_view_set_header_row(page, (*pLoader)->header);
+	}
+	delete pLoader;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * RomData loader: The worker thread is finished.
+ * @param pLoader RomDataViewLoaderPtr (owned by this callback)
+ * @return G_SOURCE_REMOVE
+ */
+static gboolean
+rp_rom_data_view_loader_finished_idle(RomDataViewLoaderPtr *pLoader)
+{
+	RpRomDataView *const page = (*pLoader)->page;
+	if (page) {
+		// Not cancelled, and not finished by rp_rom_data_view_is_showing_data().
+		assert(page->cxx->loader == *pLoader);
+		rp_rom_data_view_finish_loader(page);
+	}
+	delete pLoader;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * RomData loader: Worker thread.
+ * @param pLoader RomDataViewLoaderPtr (owned by this thread)
+ * @return nullptr
+ */
+static gpointer
+rp_rom_data_view_loader_thread_run(RomDataViewLoaderPtr *pLoader)
+{
+	RomDataViewLoader *const loader = pLoader->get();
 
-		// Update the display widgets.
-		// TODO: If already mapped, check achievements again.
-		// NOTE: This will clear page->changed_idle.
-		rp_rom_data_view_update_display(page);
+	// Open the RomData object, if necessary.
+	bool closeWhenDone = false;
+	if (!loader->romData && !loader->cancelled) {
+		loader->romData = rp_gtk_open_uri(loader->uri);
+		closeWhenDone = true;
+	}
+
+	if (loader->romData && !loader->cancelled) {
+		// Get the header row information first, so the
+		// header row can be shown while the fields are loading.
+		rp_rom_data_view_get_header_info(loader->romData.get(), loader->header);
+		g_idle_add(G_SOURCE_FUNC(rp_rom_data_view_loader_header_ready_idle),
+			new RomDataViewLoaderPtr(*pLoader));
+	}
 
-		// Make sure the underlying file handle is closed,
-		// since we don't need it once the RomData has been
-		// loaded by RomDataView.
-		page->cxx->romData->close();
+	if (loader->romData && !loader->cancelled) {
+		// Load the fields.
+		// NOTE: RomData::fields() loads the field data if necessary.
+		loader->romData->fields();
+
+		if (closeWhenDone) {
+			// Make sure the underlying file handle is closed,
+			// since we don't need it once the RomData has been
+			// loaded by RomDataView.
+			loader->romData->close();
+		}
+	}
+
+	// The worker thread is done with the RomData object.
+	{
+		std::lock_guard<std::mutex> lock(loader->mtx);
+		loader->done = true;
+	}
+	loader->cond.notify_all();
+
+	g_idle_add(G_SOURCE_FUNC(rp_rom_data_view_loader_finished_idle), pLoader);
+	return nullptr;
+}
 
+/**
+ * Start loading the RomData object in a worker thread.
+ * A placeholder is shown in the header row until the RomData object is loaded.
+ * @param page RomDataView
+ * @param romData Existing RomData object, or nullptr to open page->uri.
+ */
+static void
+rp_rom_data_view_start_loader(RpRomDataView *page, const RomDataPtr &romData)
+{
+	// Cancel the existing loader, if any.
+	rp_rom_data_view_cancel_loader(page);
+
+	RomDataViewLoaderPtr loader = std::make_shared<RomDataViewLoader>();
+	loader->page = page;
+	loader->uri = g_strdup(page->uri);
+	loader->romData = romData;
+	page->cxx->loader = loader;
+
+	// Show a placeholder until the header row information is available.
+	rp_rom_data_view_show_loading(page);
+
+	// NOTE: The thread is detached. It holds its own reference to the loader.
+	GThread *const thread = g_thread_new("RomDataView",
+		(GThreadFunc)rp_rom_data_view_loader_thread_run,
+		new RomDataViewLoaderPtr(std::move(loader)));
+	g_thread_unref(thread);
+}
+
+/**
+ * Cancel the RomData loader.
+ * The worker thread will discard its results once the current loading step is done.
+ * @param page RomDataView
+ */
+static void
+rp_rom_data_view_cancel_loader(RpRomDataView *page)
+{
+	RomDataViewLoaderPtr &loader = page->cxx->loader;
+	if (!loader) {
+		return;
+	}
+
+	loader->page = nullptr;
+	loader->cancelled = true;
+	loader.reset();
+}
+
+/**
+ * The RomData loader is done. Show the RomData object.
+ * NOTE: The worker thread must be done with the RomData object.
+ * @param page RomDataView
+ */
+static void
+rp_rom_data_view_finish_loader(RpRomDataView *page)
+{
+	RomDataViewLoaderPtr loader = std::move(page->cxx->loader);
+	assert((bool)loader);
+	assert(loader->done);
+	loader->page = nullptr;
+
+	page->cxx->romData = std::move(loader->romData);
+	page->hasCheckedAchievements = false;
+
+	// Update the display widgets.
+	// TODO: If already mapped, check achievements again.
+	rp_rom_data_view_update_display(page);
+
+	if (page->cxx->romData) {
 		// Send a notification for PROP_SHOWING_DATA here,
 		// since the data is now actually being shown.
 		g_object_notify_by_pspec(G_OBJECT(page), props[PROP_SHOWING_DATA]);
@@ -1780,10 +2049,6 @@ rp_rom_data_view_load_rom_data(RpRomDataView *page)
 	if (gtk_widget_get_mapped(GTK_WIDGET(page))) {
 		rp_rom_data_view_map_signal_handler(page, nullptr);
 	}
-
-	// Clear the timeout.
-	page->changed_idle = 0;
-	return G_SOURCE_REMOVE;
 }
 
 /**
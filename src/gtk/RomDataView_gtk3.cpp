@@ -24,6 +24,10 @@ using std::string;
 using std::vector;
 
 #include "PIMGTYPE.hpp"
+#include "ListDataIconLoader.hpp"
+
+// TODO: Ideal icon size? Using 32x32 for now.
+static constexpr int icon_sz = 32;
 
 static void	tree_view_realize_signal_handler    (GtkTreeView	*treeView,
 						     RpRomDataView	*page);
@@ -119,6 +123,79 @@ tree_view_realize_signal_handler(GtkTreeView	*treeView,
 	gtk_widget_set_size_request(scrolledWindow, -1, height);
 }
 
+/**
+ * An RFT_LISTDATA icon has been converted.
+ * @param target GtkListStore
+ * @param row Row index
+ * @param icon Icon, or nullptr if the icon was evicted
+ */
+static void
+listdata_icon_ready(GObject *target, guint row, PIMGTYPE icon)
+{
+	GtkListStore *const listStore = GTK_LIST_STORE(target);
+	GtkTreeIter treeIter;
+	if (gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(listStore), &treeIter, nullptr, row)) {
+		gtk_list_store_set(listStore, &treeIter, 0, icon, -1);
+	}
+}
+
+/**
+ * GtkTreeCellDataFunc for RFT_LISTDATA icons.
+ * Icons are requested from the RpListDataIconLoader if the row is visible.
+ * @param tree_column GtkTreeViewColumn
+ * @param cell GtkCellRenderer
+ * @param tree_model GtkTreeModel (GtkTreeModelSort)
+ * @param iter GtkTreeIter
+ * @param data RpListDataIconLoader
+ */
+static void
+listdata_icon_cell_data_func(GtkTreeViewColumn	*tree_column,
+			     GtkCellRenderer	*cell,
+			     GtkTreeModel	*tree_model,
+			     GtkTreeIter	*iter,
+			     gpointer		 data)
+{
+	PIMGTYPE icon = nullptr;
+	gtk_tree_model_get(tree_model, iter, 0, &icon, -1);
+	g_object_set(cell, GTK_CELL_RENDERER_PIXBUF_PROPERTY, icon, nullptr);
+	if (icon) {
+		// Icon has already been converted.
+		PIMGTYPE_unref(icon);
+		return;
+	}
+
+	// GtkTreeView calls this function for all rows when calculating
+	// row sizes, so only request the icon if the row is visible.
+	GtkTreeView *const treeView = GTK_TREE_VIEW(gtk_tree_view_column_get_tree_view(tree_column));
+	GtkTreePath *startPath = nullptr, *endPath = nullptr;
+	if (!treeView || !gtk_tree_view_get_visible_range(treeView, &startPath, &endPath)) {
+		// Not visible yet.
+		return;
+	}
+
+	GtkTreePath *const path = gtk_tree_model_get_path(tree_model, iter);
+	const bool isVisible = (gtk_tree_path_compare(path, startPath) >= 0 &&
+	                        gtk_tree_path_compare(path, endPath) <= 0);
+	gtk_tree_path_free(path);
+	gtk_tree_path_free(startPath);
+	gtk_tree_path_free(endPath);
+	if (!isVisible) {
+		return;
+	}
+
+	// Get the row index in the underlying GtkListStore.
+	// NOTE: Icons and checkboxes are mutually exclusive,
+	// so no rows were skipped when adding rows.
+	GtkTreeIter childIter;
+	gtk_tree_model_sort_convert_iter_to_child_iter(GTK_TREE_MODEL_SORT(tree_model), &childIter, iter);
+	GtkTreeModel *const childModel = gtk_tree_model_sort_get_model(GTK_TREE_MODEL_SORT(tree_model));
+	GtkTreePath *const childPath = gtk_tree_model_get_path(childModel, &childIter);
+	const int row = gtk_tree_path_get_indices(childPath)[0];
+	gtk_tree_path_free(childPath);
+
+	rp_list_data_icon_loader_request(static_cast<RpListDataIconLoader*>(data), row);
+}
+
 /**
  * Initialize a list data field.
  * @param page		[in] RomDataView object
@@ -215,14 +292,12 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 	if (hasCheckboxes) {
 		checkboxes = field.data.list_data.mxd.checkboxes;
 	}
-	unsigned int row = 0;	// for icons [TODO: Use iterator?]
 	for (const vector<string> &data_row : *list_data) {
 		// FIXME: Skip even if we don't have checkboxes?
 		// (also check other UI frontends)
 		if (hasCheckboxes && data_row.empty()) {
 			// Skip this row.
 			checkboxes >>= 1;
-			row++;
 			continue;
 		}
 
@@ -232,61 +307,9 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 			// Checkbox column
 			gtk_list_store_set(listStore, &treeIter, 0, (checkboxes & 1), -1);
 			checkboxes >>= 1;
-		} else if (hasIcons) {
-			// Icon column
-			const rp_image_const_ptr &icon = field.data.list_data.mxd.icons->at(row);
-			if (icon) {
-				PIMGTYPE pixbuf = rp_image_to_PIMGTYPE(icon);
-				if (pixbuf) {
-					// TODO: Ideal icon size? Using 32x32 for now.
-					static constexpr int icon_sz = 32;
-
-#if RP_GTK_USE_CAIRO
-					// NOTE: Assuming square icons.
-					int icon_w = icon->width();
-					int icon_h = icon->height();
-					if (icon_w > icon_sz || icon_h > icon_sz) {
-						// Instead of scaling icons down, set a device pixel ratio.
-						// This allows for higher-resolution display on high-DPI screens.
-						const float scale_x = static_cast<float>(icon_w) / static_cast<float>(icon_sz);
-						const float scale_y = static_cast<float>(icon_h) / static_cast<float>(icon_sz);
-						cairo_surface_set_device_scale(pixbuf, scale_x, scale_y);
-					} else if (icon_w > 0 && icon_h > 0) {
-						// Scale up using integer scaling, then set a device pixel ratio.
-						while (icon_w < icon_sz) {
-							icon_w += icon->width();
-							icon_h += icon->height();
-						}
-						PIMGTYPE scaled = PIMGTYPE_scale(pixbuf, icon_w, icon_h, true);
-						if (scaled) {
-							PIMGTYPE_unref(pixbuf);
-							pixbuf = scaled;
-
-							const float scale_x = static_cast<float>(icon_w) / static_cast<float>(icon_sz);
-							const float scale_y = static_cast<float>(icon_h) / static_cast<float>(icon_sz);
-							cairo_surface_set_device_scale(pixbuf, scale_x, scale_y);
-						}
-					}
-#else /* RP_GTK_USE_CAIRO */
-					// Cannot use device scale factor with GdkPixbuf.
-					// Resize the icon manually.
-					// TODO: Get the X11 dpi?
-					if (!PIMGTYPE_size_check(pixbuf, icon_sz, icon_sz)) {
-						// TODO: Use nearest-neighbor if upscaling.
-						// Also, preserve the aspect ratio.
-						PIMGTYPE scaled = PIMGTYPE_scale(pixbuf, icon_sz, icon_sz, true);
-						if (scaled) {
-							PIMGTYPE_unref(pixbuf);
-							pixbuf = scaled;
-						}
-					}
-#endif /* RP_GTK_USE_CAIRO */
-
-					gtk_list_store_set(listStore, &treeIter, 0, pixbuf, -1);
-					PIMGTYPE_unref(pixbuf);
-				}
-			}
 		}
+		// NOTE: Icons are converted on demand when the row becomes visible.
+		// See listdata_icon_cell_data_func().
 
 		if (!isMulti) {
 			int col = listStore_col_start;
@@ -326,8 +349,6 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 				col++;
 			}
 		}
-
-		row++;
 	}
 
 	// Scroll area for the GtkTreeView.
@@ -373,12 +394,23 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 	// This is prepended to column 0.
 	GtkCellRenderer *col0_renderer = nullptr;
 	const char *col0_attr_name = nullptr;
+	RpListDataIconLoader *iconLoader = nullptr;
 	if (hasCheckboxes) {
 		col0_renderer = gtk_cell_renderer_toggle_new();
 		col0_attr_name = "active";
 	} else if (hasIcons) {
 		col0_renderer = gtk_cell_renderer_pixbuf_new();
 		col0_attr_name = GTK_CELL_RENDERER_PIXBUF_PROPERTY;
+
+		// Reserve space for the icon so the row height doesn't
+		// change once the icon has been converted.
+		gtk_cell_renderer_set_fixed_size(col0_renderer, icon_sz, icon_sz);
+
+		// The icon loader is owned by the GtkTreeView.
+		iconLoader = rp_list_data_icon_loader_new(*(field.data.list_data.mxd.icons),
+			icon_sz, G_OBJECT(listStore), listdata_icon_ready);
+		g_object_set_qdata_full(G_OBJECT(treeView), RFT_LISTDATA_icon_loader_quark,
+			iconLoader, reinterpret_cast<GDestroyNotify>(rp_list_data_icon_loader_free));
 	}
 
 	// Format tables.
@@ -407,7 +439,13 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 		if (col0_renderer != nullptr) {
 			// Prepend the icon/checkbox renderer.
 			gtk_tree_view_column_pack_start(column, col0_renderer, FALSE);
-			gtk_tree_view_column_add_attribute(column, col0_renderer, col0_attr_name, 0);
+			if (hasIcons) {
+				// Icons are converted on demand.
+				gtk_tree_view_column_set_cell_data_func(column, col0_renderer,
+					listdata_icon_cell_data_func, iconLoader, nullptr);
+			} else {
+				gtk_tree_view_column_add_attribute(column, col0_renderer, col0_attr_name, 0);
+			}
 			col0_renderer = nullptr;
 		}
 
@@ -11,6 +11,7 @@
 #include "RomDataFormat.hpp"
 
 #include "ListDataItem.h"
+#include "ListDataIconLoader.hpp"
 #include "gtk4/sort_funcs.h"
 
 // Other rom-properties libraries
@@ -27,6 +28,29 @@ using std::vector;
 // TODO: Ideal icon size? Using 32x32 for now.
 static constexpr int icon_sz = 32;
 
+/**
+ * An RFT_LISTDATA icon has been converted.
+ * @param target GListStore
+ * @param row Row index
+ * @param icon Icon, or nullptr if the icon was evicted
+ */
+static void
+listdata_icon_ready(GObject *target, guint row, PIMGTYPE icon)
+{
+	GListStore *const listStore = G_LIST_STORE(target);
+	RpListDataItem *const item = RP_LIST_DATA_ITEM(g_list_model_get_item(G_LIST_MODEL(listStore), row));
+	if (!item) {
+		return;
+	}
+
+	rp_list_data_item_set_icon(item, icon);
+
+	// Replace the item with itself so the row is rebound.
+	gpointer additions[1] = { item };
+	g_list_store_splice(listStore, row, 1, additions, 1);
+	g_object_unref(item);
+}
+
 // GtkSignalListItemFactory signal handlers
 // Reference: https://blog.gtk.org/2020/09/05/a-primer-on-gtklistview/
 // NOTE: user_data is RpListDataItemCol0Type.
@@ -93,8 +117,6 @@ static void
 bind_listitem_cb(GtkListItemFactory *factory, GtkListItem *list_item, gpointer user_data)
 {
 	// TODO: Alternating row colors?
-	RP_UNUSED(factory);
-
 	GtkWidget *const widget = gtk_list_item_get_child(list_item);
 	assert(widget != nullptr);
 	if (!widget) {
@@ -152,7 +174,20 @@ bind_listitem_cb(GtkListItemFactory *factory, GtkListItem *list_item, gpointer u
 		case RP_LIST_DATA_ITEM_COL0_TYPE_ICON:
 			// Column 0 is an icon.
 			if (column == 0) {
-				gtk_picture_set_paintable(GTK_PICTURE(widget), GDK_PAINTABLE(rp_list_data_item_get_icon(item)));
+				PIMGTYPE const icon = rp_list_data_item_get_icon(item);
+				gtk_picture_set_paintable(GTK_PICTURE(widget), GDK_PAINTABLE(icon));
+				if (!icon) {
+					// Icon hasn't been converted yet.
+					// NOTE: Only visible rows are bound, so this is
+					// effectively an on-demand request.
+					RpListDataIconLoader *const iconLoader = static_cast<RpListDataIconLoader*>(
+						g_object_get_qdata(G_OBJECT(factory), RFT_LISTDATA_icon_loader_quark));
+					const guint row = GPOINTER_TO_UINT(
+						g_object_get_qdata(G_OBJECT(item), RFT_LISTDATA_row_quark));
+					if (iconLoader && row > 0) {
+						rp_list_data_icon_loader_request(iconLoader, row - 1);
+					}
+				}
 			} else {
 				const bool is_achievements = rp_list_data_item_get_column_is_achievement(item, column-1);
 				const char *text = rp_list_data_item_get_column_text(item, column-1);
@@ -273,6 +308,14 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 		GtkListItemFactory *const factory = gtk_signal_list_item_factory_new();
 		g_signal_connect(factory, "setup", G_CALLBACK(setup_listitem_cb_col0), GINT_TO_POINTER(col0_type));
 		g_signal_connect(factory, "bind", G_CALLBACK(bind_listitem_cb), GINT_TO_POINTER(0));
+		if (hasIcons) {
+			// Icons are converted on demand when bound.
+			// The icon loader is owned by the column 0 factory.
+			RpListDataIconLoader *const iconLoader = rp_list_data_icon_loader_new(
+				*(field.data.list_data.mxd.icons), 0, G_OBJECT(listStore), listdata_icon_ready);
+			g_object_set_qdata_full(G_OBJECT(factory), RFT_LISTDATA_icon_loader_quark,
+				iconLoader, reinterpret_cast<GDestroyNotify>(rp_list_data_icon_loader_free));
+		}
 
 		GtkColumnViewColumn *const column = gtk_column_view_column_new(nullptr, factory);
 		gtk_column_view_column_set_fixed_width(column, icon_sz);
@@ -396,16 +439,9 @@ rp_rom_data_view_init_listdata(RpRomDataView *page, const RomFields::Field &fiel
 			checkboxes >>= 1;
 		} else if (hasIcons) {
 			// Icon column
-			const rp_image_const_ptr &icon = field.data.list_data.mxd.icons->at(row);
-			if (icon) {
-				PIMGTYPE pixbuf = rp_image_to_PIMGTYPE(icon);
-				if (pixbuf) {
-					// NOTE: GtkPicture *can* scale the pixbuf itself.
-					// Using GtkPicture to scale it instead of scaling here.
-					rp_list_data_item_set_icon(item, pixbuf);
-					PIMGTYPE_unref(pixbuf);
-				}
-			}
+			// NOTE: Icons are converted on demand. Save the row index
+			// so bind_listitem_cb() can request the icon.
+			g_object_set_qdata(G_OBJECT(item), RFT_LISTDATA_row_quark, GUINT_TO_POINTER(row + 1));
 		}
 
 		if (!isMulti) {
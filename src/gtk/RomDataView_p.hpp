@@ -17,6 +17,7 @@
 #include "librpbase/RomData.hpp"
 
 // C++ includes
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -68,10 +69,17 @@ struct Data_ListDataMulti_t {
 };
 #endif /* GTK_CHECK_VERSION(4, 0, 0) */
 
+// Asynchronous RomData loader (defined in RomDataView.cpp)
+struct RomDataViewLoader;
+
 // C++ objects
 struct _RpRomDataViewCxx {
 	LibRpBase::RomDataPtr	romData;	// RomData
 
+	// Asynchronous RomData loader.
+	// Set while the RomData object is being loaded in a worker thread.
+	std::shared_ptr<RomDataViewLoader> loader;
+
 	struct tab {
 		GtkWidget	*vbox;		// Either parent page or a GtkVBox/GtkBox.
 		GtkWidget	*table;		// GtkTable (2.x); GtkGrid (3.x)
@@ -143,6 +151,8 @@ G_BEGIN_DECLS
 
 extern GQuark RFT_BITFIELD_value_quark;
 extern GQuark RFT_LISTDATA_rows_visible_quark;
+extern GQuark RFT_LISTDATA_icon_loader_quark;
+extern GQuark RFT_LISTDATA_row_quark;
 extern GQuark RFT_fieldIdx_quark;
 extern GQuark RFT_STRING_warning_quark;
 
@@ -20,10 +20,19 @@
 // Other rom-properties libraries
 #include "librpbase/config/Config.hpp"
 #include "librpbase/RomMetaData.hpp"
+#include "libromdata/DetectionCache.hpp"
 using namespace LibRpBase;
+using namespace LibRomData;
 
 // C++ STL classes
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 using std::array;
+using std::pair;
+using std::string;
+using std::vector;
 
 // for compatibility with older glib:
 // - g_clear_handle_id()
@@ -40,7 +49,6 @@ using std::array;
 #endif /* GTK_CHECK_VERSION(4, 0, 0) */
 
 static void rp_nautilus_info_provider_interface_init(NautilusInfoProviderInterface *iface);
-static void rp_nautilus_info_provider_dispose(GObject *object);
 static void rp_nautilus_info_provider_finalize(GObject *object);
 
 static NautilusOperationResult
@@ -50,9 +58,6 @@ rp_nautilus_info_provider_update_file_info(
 	GClosure                 *update_complete,
 	NautilusOperationHandle **handle);
 
-static gboolean
-rp_nautilus_info_provider_process(RpNautilusInfoProvider *provider);
-
 static void
 rp_nautilus_info_provider_cancel_update(
 	NautilusInfoProvider     *provider,
@@ -62,19 +67,47 @@ struct _RpNautilusInfoProviderClass {
 	GObjectClass __parent__;
 };
 
+// Maximum number of worker threads.
+static constexpr gint MAX_THREADS = 4;
+
+// Maximum number of requests per directory that can be
+// processed at the same time. This reduces seeking on
+// spinning media if multiple directories are open.
+static constexpr guint MAX_REQUESTS_PER_DIR = 2;
+
+// Directory queue
+struct dir_queue {
+	gchar *dir;	// Directory URI (also the key in dir_queues)
+	GQueue pending;	// Requests that haven't been dispatched yet (element is struct request_info*)
+	guint active;	// Number of requests being processed by worker threads
+};
+
 // Info request
 // Also used as the NautilusOperationHandle.
-// NOTE: request_info does *not* own these objects.
+// Owned by the main thread. While the request is being processed
+// by a worker thread, only the worker thread accesses the results.
 struct request_info {
-	NautilusFileInfo *file_info;
-	GClosure *update_complete;
+	RpNautilusInfoProvider *provider;	// ref'd while dispatched
+	NautilusFileInfo *file_info;	// ref'd
+	GClosure *update_complete;	// ref'd
+	gchar *uri;
+	struct dir_queue *dq;		// not owned
+
+	gint cancelled;		// Set by cancel_update() while the request is dispatched (atomic)
+	bool dispatched;	// Request has been sent to a worker thread (main thread only)
+
+	// Results (set by the worker thread)
+	bool ok;
+	bool hasDangerousPermissions;
+	vector<pair<size_t, string> > attrs;	// Custom metadata attributes (index, value)
 };
 
 struct _RpNautilusInfoProvider {
 	GObject __parent__;
 
-	GQueue request_queue;	// Request queue (element is struct request_info*)
-	guint idle_process;	// Idle function for processing
+	GThreadPool *pool;		// Worker thread pool
+	GHashTable *requests;		// All requests that haven't completed yet (set of struct request_info*)
+	GHashTable *dir_queues;		// Directory queues (key is the directory URI; value is struct dir_queue*)
 };
 
 #if !GLIB_CHECK_VERSION(2, 59, 1)
@@ -113,7 +146,6 @@ static void
 rp_nautilus_info_provider_class_init(RpNautilusInfoProviderClass *klass)
 {
 	GObjectClass *const gobject_class = G_OBJECT_CLASS(klass);
-	gobject_class->dispose = rp_nautilus_info_provider_dispose;
 	gobject_class->finalize = rp_nautilus_info_provider_finalize;
 }
 
@@ -124,9 +156,35 @@ rp_nautilus_info_provider_class_finalize(RpNautilusInfoProviderClass *klass)
 }
 
 static void
-rp_nautilus_info_provider_init(RpNautilusInfoProvider *sbr_provider)
+dir_queue_free(struct dir_queue *dq)
+{
+	// NOTE: Requests are owned by RpNautilusInfoProvider::requests.
+	g_queue_clear(&dq->pending);
+	g_free(dq->dir);
+	g_free(dq);
+}
+
+static void
+request_info_free(struct request_info *req)
 {
-	RP_UNUSED(sbr_provider);
+	g_object_unref(req->file_info);
+	g_closure_unref(req->update_complete);
+	g_free(req->uri);
+	delete req;
+}
+
+static void rp_nautilus_info_provider_worker(struct request_info *req, RpNautilusInfoProvider *provider);
+
+static void
+rp_nautilus_info_provider_init(RpNautilusInfoProvider *provider)
+{
+	provider->pool = g_thread_pool_new(
+		reinterpret_cast<GFunc>(rp_nautilus_info_provider_worker),
+		provider, MAX_THREADS, false, nullptr);
+	provider->requests = g_hash_table_new_full(nullptr, nullptr,
+		nullptr, reinterpret_cast<GDestroyNotify>(request_info_free));
+	provider->dir_queues = g_hash_table_new_full(g_str_hash, g_str_equal,
+		nullptr, reinterpret_cast<GDestroyNotify>(dir_queue_free));
 }
 
 static void
@@ -137,35 +195,50 @@ rp_nautilus_info_provider_interface_init(NautilusInfoProviderInterface *iface)
 }
 
 static void
-rp_nautilus_info_provider_dispose(GObject *object)
+rp_nautilus_info_provider_finalize(GObject *object)
 {
 	RpNautilusInfoProvider *const provider = RP_NAUTILUS_INFO_PROVIDER(object);
 
-	// Unregister timer sources.
-	g_clear_handle_id(&provider->idle_process, g_source_remove);
+	// Dispatched requests hold a reference to the provider,
+	// so the thread pool should be idle by now.
+	g_thread_pool_free(provider->pool, true, true);
 
-	// Call the superclass dispose() function.
-	G_OBJECT_CLASS(rp_nautilus_info_provider_parent_class)->dispose(object);
+	// Delete any remaining requests.
+	g_hash_table_destroy(provider->dir_queues);
+	g_hash_table_destroy(provider->requests);
+
+	// Call the superclass finalize() function.
+	G_OBJECT_CLASS(rp_nautilus_info_provider_parent_class)->finalize(object);
 }
 
+/**
+ * Dispatch pending requests from a directory queue to the thread pool.
+ * If the directory queue is empty, it will be deleted.
+ * @param provider	[in] RpNautilusInfoProvider
+ * @param dq		[in] Directory queue
+ */
 static void
-rp_nautilus_info_provider_finalize(GObject *object)
+rp_nautilus_info_provider_dispatch(RpNautilusInfoProvider *provider, struct dir_queue *dq)
 {
-	RpNautilusInfoProvider *const provider = RP_NAUTILUS_INFO_PROVIDER(object);
-
-	// Delete any remaining requests and free the queue.
-	for (GList *p = provider->request_queue.head; p != nullptr; p = p->next) {
-		if (p->data) {
-			struct request_info *const req = static_cast<struct request_info*>(p->data);
-			g_object_unref(req->file_info);
-			g_closure_unref(req->update_complete);
-			g_free(req);
+	while (dq->active < MAX_REQUESTS_PER_DIR) {
+		struct request_info *const req = static_cast<struct request_info*>(g_queue_pop_head(&dq->pending));
+		if (!req) {
+			// Nothing left in the queue.
+			break;
 		}
+
+		// The worker thread holds a reference to the provider
+		// until the request is completed on the main thread.
+		req->dispatched = true;
+		dq->active++;
+		g_object_ref(provider);
+		g_thread_pool_push(provider->pool, req, nullptr);
 	}
-	g_queue_clear(&provider->request_queue);
 
-	// Call the superclass finalize() function.
-	G_OBJECT_CLASS(rp_nautilus_info_provider_parent_class)->finalize(object);
+	if (dq->active == 0 && g_queue_is_empty(&dq->pending)) {
+		// Directory queue is no longer needed.
+		g_hash_table_remove(provider->dir_queues, dq->dir);
+	}
 }
 
 /**
@@ -189,70 +262,147 @@ rp_nautilus_info_provider_update_file_info(
 
 	RpNautilusInfoProvider *const rpp = reinterpret_cast<RpNautilusInfoProvider*>(provider);
 
+	// Get the URI.
+	// NOTE: NautilusFileInfo must only be accessed on the main thread.
+	gchar *const uri = nautilus_file_info_get_uri(file_info);
+	if (G_UNLIKELY(uri == nullptr)) {
+		// No URI...
+		return NAUTILUS_OPERATION_FAILED;
+	}
+
+	// Directory URI, for the per-directory queue.
+	const char *const slash = strrchr(uri, '/');
+	gchar *const dir = (slash) ? g_strndup(uri, slash - uri) : g_strdup(uri);
+
+	struct dir_queue *dq = static_cast<struct dir_queue*>(g_hash_table_lookup(rpp->dir_queues, dir));
+	if (dq) {
+		g_free(dir);
+	} else {
+		dq = static_cast<struct dir_queue*>(g_malloc(sizeof(struct dir_queue)));
+		dq->dir = dir;
+		g_queue_init(&dq->pending);
+		dq->active = 0;
+		g_hash_table_insert(rpp->dir_queues, dq->dir, dq);
+	}
+
 	// Put the file in the queue.
-	struct request_info *const req = static_cast<struct request_info*>(g_malloc(sizeof(struct request_info)));
+	struct request_info *const req = new struct request_info;
+	req->provider = rpp;
 	req->file_info = static_cast<NautilusFileInfo*>(g_object_ref(file_info));
 	req->update_complete = g_closure_ref(update_complete);
-	g_queue_push_tail(&rpp->request_queue, reinterpret_cast<gpointer>(req));
+	req->uri = uri;
+	req->dq = dq;
+	req->cancelled = 0;
+	req->dispatched = false;
+	req->ok = false;
+	req->hasDangerousPermissions = false;
+	g_hash_table_add(rpp->requests, req);
+	g_queue_push_tail(&dq->pending, req);
 
 	// The request is the handle.
 	*handle = reinterpret_cast<NautilusOperationHandle*>(req);
 
-	// Make sure the idle process is started.
-	// TODO: Make it multi-threaded? (needs atomic compare and/or mutex...)
-	if (rpp->idle_process == 0) {
-		rpp->idle_process = g_idle_add(G_SOURCE_FUNC(rp_nautilus_info_provider_process), provider);
-	}
-
+	// Process the request if this directory isn't busy.
+	rp_nautilus_info_provider_dispatch(rpp, dq);
 	return NAUTILUS_OPERATION_IN_PROGRESS;
 }
 
 /**
- * Process a request.
- * @param provider RpNautilusInfoProvider
- * @return True to continue processing more requests; false if we're done.
+ * A request has been processed. (Main thread)
+ * @param req Request
+ * @return G_SOURCE_REMOVE
  */
 static gboolean
-rp_nautilus_info_provider_process(RpNautilusInfoProvider *provider)
+rp_nautilus_info_provider_complete(struct request_info *req)
 {
-	// Get the next entry from the queue.
-	struct request_info *const req = static_cast<struct request_info*>(g_queue_pop_head(&provider->request_queue));
-	if (!req) {
-		// Nothing left in the queue.
-		provider->idle_process = 0;
-		return G_SOURCE_REMOVE;
-	}
+	RpNautilusInfoProvider *const provider = req->provider;
+	struct dir_queue *const dq = req->dq;
+	assert(dq->active > 0);
+	dq->active--;
+
+	// If the request was cancelled, Nautilus doesn't expect
+	// update_complete to be invoked.
+	if (!g_atomic_int_get(&req->cancelled)) {
+		if (req->ok) {
+			// Add the custom metadata properties.
+			for (const auto &attr : req->attrs) {
+				nautilus_file_info_add_string_attribute(req->file_info,
+					rp_nautilus_column_provider_column_desc_data[attr.first].name,
+					attr.second.c_str());
+			}
 
-	// Get the URI.
-	gchar *const uri = nautilus_file_info_get_uri(req->file_info);
-	if (G_UNLIKELY(uri == nullptr)) {
-		// No URI...
+			const Config *const config = Config::instance();
+			if (config->getBoolConfigOption(Config::BoolConfig::Options_ShowDangerousPermissionsOverlayIcon)) {
+				// Overlay icon is enabled.
+				// Does this RomData object have "dangerous" permissions?
+				if (req->hasDangerousPermissions) {
+					// Add the "security-medium" emblem.
+					nautilus_file_info_add_emblem(req->file_info, "security-medium");
+				}
+			}
+		}
+
+		// Finished processing this file.
 		nautilus_info_provider_update_complete_invoke(
 			req->update_complete,
 			reinterpret_cast<NautilusInfoProvider*>(provider),
 			reinterpret_cast<NautilusOperationHandle*>(req),
-			NAUTILUS_OPERATION_FAILED);
-		g_object_unref(req->file_info);
-		g_closure_unref(req->update_complete);
-		g_free(req);
-		// Continue processing the queue.
-		return G_SOURCE_CONTINUE;
+			req->ok ? NAUTILUS_OPERATION_COMPLETE : NAUTILUS_OPERATION_FAILED);
+	}
+	g_hash_table_remove(provider->requests, req);
+
+	// Process the next request from this directory.
+	rp_nautilus_info_provider_dispatch(provider, dq);
+
+	g_object_unref(provider);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Process a request. (Worker thread)
+ * @param req Request
+ * @param provider RpNautilusInfoProvider
+ */
+static void
+rp_nautilus_info_provider_worker(struct request_info *req, RpNautilusInfoProvider *provider)
+{
+	RP_UNUSED(provider);
+	if (g_atomic_int_get(&req->cancelled)) {
+		// Request was cancelled before it was started.
+		g_idle_add(G_SOURCE_FUNC(rp_nautilus_info_provider_complete), req);
+		return;
 	}
 
-	const RomDataPtr romData = rp_gtk_open_uri(uri);
-	g_free(uri);
-	if (G_UNLIKELY(!romData)) {
+	// If this is a local file, check the detection cache first.
+	// If the file hasn't changed, this only requires a stat().
+	DetectionCache::EntryPtr entry;
+	gchar *const filename = g_filename_from_uri(req->uri, nullptr, nullptr);
+	if (filename) {
+		entry = DetectionCache::lookup(filename);
+		g_free(filename);
+	}
+
+	RomDataPtr romData;
+	const RomMetaData *metaData = nullptr;
+	if (entry) {
+		if (entry->isSupported()) {
+			metaData = entry->metaData.get();
+			req->hasDangerousPermissions = entry->hasDangerousPermissions;
+		}
+	} else {
+		// Not cached. Open the URI directly.
+		romData = rp_gtk_open_uri(req->uri);
+		if (romData) {
+			metaData = romData->metaData();
+			req->hasDangerousPermissions = romData->hasDangerousPermissions();
+		}
+	}
+
+	req->ok = (romData || (entry && entry->isSupported()));
+	if (G_UNLIKELY(!req->ok)) {
 		// Unable to open the URI as a RomData object.
-		nautilus_info_provider_update_complete_invoke(
-			req->update_complete,
-			reinterpret_cast<NautilusInfoProvider*>(provider),
-			reinterpret_cast<NautilusOperationHandle*>(req),
-			NAUTILUS_OPERATION_FAILED);
-		g_object_unref(req->file_info);
-		g_closure_unref(req->update_complete);
-		g_free(req);
-		// Continue processing the queue.
-		return G_SOURCE_CONTINUE;
+		g_idle_add(G_SOURCE_FUNC(rp_nautilus_info_provider_complete), req);
+		return;
 	}
 
 	// Check for custom metadata propreties.
@@ -260,9 +410,8 @@ rp_nautilus_info_provider_process(RpNautilusInfoProvider *provider)
 	static constexpr size_t custom_property_count = static_cast<size_t>(Property::PropertyCount) - static_cast<size_t>(Property::GameID);
 #ifndef NDEBUG
 	// Sanity check (debug builds): Make sure the array is the correct size.
-	// NOTE: Don't really need to use std::call_once() for this...
-	static bool done_once = false;
-	if (!done_once) {
+	static std::once_flag once_flag;
+	std::call_once(once_flag, []() {
 		size_t actual_size = 0;
 		for (const rp_nautilus_column_provider_column_desc_data_t *p = rp_nautilus_column_provider_column_desc_data;
 		     p->name != nullptr; p++)
@@ -270,12 +419,12 @@ rp_nautilus_info_provider_process(RpNautilusInfoProvider *provider)
 			actual_size++;
 		}
 		assert(actual_size == custom_property_count);
-		done_once = true;
-	}
+	});
 #endif /* !NDEBUG */
 
 	// Custom metadata property names start at Prpoerty::GameID.
-	const RomMetaData *const metaData = romData->metaData();
+	// NOTE: NautilusFileInfo can only be updated on the main thread,
+	// so the properties are saved for now.
 	if (metaData && !metaData->empty()) {
 		for (const RomMetaData::MetaData &prop : *metaData) {
 			if (prop.name < Property::GameID) {
@@ -284,40 +433,21 @@ rp_nautilus_info_provider_process(RpNautilusInfoProvider *provider)
 
 			// Only strings are accepted for now.
 			assert(prop.type == PropertyType::String);
-			if (prop.type != PropertyType::String) {
+			if (prop.type != PropertyType::String || !prop.data.str) {
 				continue;
 			}
 
-			// Add the property.
+			// Save the property.
 			const size_t index = static_cast<size_t>(prop.name) - static_cast<size_t>(Property::GameID);
 			assert(index < custom_property_count);
 			if (index < custom_property_count) {
-				nautilus_file_info_add_string_attribute(req->file_info, rp_nautilus_column_provider_column_desc_data[index].name, prop.data.str);
+				req->attrs.emplace_back(index, prop.data.str);
 			}
 		}
 	}
 
-	const Config *const config = Config::instance();
-	if (config->getBoolConfigOption(Config::BoolConfig::Options_ShowDangerousPermissionsOverlayIcon)) {
-		// Overlay icon is enabled.
-		// Does this RomData object have "dangerous" permissions?
-		if (romData->hasDangerousPermissions()) {
-			// Add the "security-medium" emblem.
-			nautilus_file_info_add_emblem(req->file_info, "security-medium");
-		}
-	}
-
 	// Finished processing this file.
-	nautilus_info_provider_update_complete_invoke(
-		req->update_complete,
-		reinterpret_cast<NautilusInfoProvider*>(provider),
-		reinterpret_cast<NautilusOperationHandle*>(req),
-		NAUTILUS_OPERATION_COMPLETE);
-	g_object_unref(req->file_info);
-	g_closure_unref(req->update_complete);
-	g_free(req);
-	// Continue processing the queue.
-	return G_SOURCE_CONTINUE;
+	g_idle_add(G_SOURCE_FUNC(rp_nautilus_info_provider_complete), req);
 }
 
 static void
@@ -328,14 +458,27 @@ rp_nautilus_info_provider_cancel_update(
 	g_return_if_fail(RP_IS_NAUTILUS_INFO_PROVIDER(provider));
 	RpNautilusInfoProvider *const rpp = reinterpret_cast<RpNautilusInfoProvider*>(provider);
 
-	// Check if the specified handle is in the GQueue.
-	gboolean res = g_queue_remove(&rpp->request_queue, handle);
-	if (res) {
-		// Handle was in the queue and has been removed.
-		// Unreference the objects.
-		struct request_info *const req = reinterpret_cast<struct request_info*>(handle);
-		g_object_unref(req->file_info);
-		g_closure_unref(req->update_complete);
-		g_free(req);
+	// Check if the specified handle is still valid.
+	struct request_info *const req = reinterpret_cast<struct request_info*>(handle);
+	if (!g_hash_table_contains(rpp->requests, req)) {
+		// Request has already been completed.
+		return;
+	}
+
+	if (req->dispatched) {
+		// Request is being processed by a worker thread.
+		// It will be deleted once the worker thread is done.
+		g_atomic_int_set(&req->cancelled, 1);
+		return;
+	}
+
+	// Request hasn't been dispatched yet.
+	// Remove it from the directory queue and delete it.
+	struct dir_queue *const dq = req->dq;
+	g_queue_remove(&dq->pending, req);
+	g_hash_table_remove(rpp->requests, req);
+	if (dq->active == 0 && g_queue_is_empty(&dq->pending)) {
+		// Directory queue is no longer needed.
+		g_hash_table_remove(rpp->dir_queues, dq->dir);
 	}
 }
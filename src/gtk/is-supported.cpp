@@ -10,6 +10,7 @@
 
 #include <glib.h>
 #include "RpFile_gio.hpp"
+#include "librpfile/CachedFile.hpp"
 
 // Other rom-properties libraries
 #include "libromdata/RomDataFactory.hpp"
@@ -46,7 +47,8 @@ RomDataPtr rp_gtk_open_uri(const char *uri)
 		romData = RomDataFactory::create(uri);
 	} else {
 		// Not a local file. Use RpFileGio.
-		IRpFilePtr file = std::make_shared<RpFileGio>(uri);
+		// Each read is a round-trip to GVfs, so wrap it in CachedFile.
+		IRpFilePtr file = std::make_shared<CachedFile>(std::make_shared<RpFileGio>(uri));
 		if (file->isOpen()) {
 			romData = RomDataFactory::create(file);
 		}
@@ -16,9 +16,11 @@
 
 #include "glib-compat.h"	// needed for G_SOURCE_FUNC()
 #include "SpecializedThumbnailer1.h"
+#include "ThumbnailerPool1.h"
 
 // C includes
 #include <string.h>
+#include <unistd.h>	// sysconf()
 #include "stdboolx.h"
 
 // from tumbler-utils.h
@@ -68,7 +70,15 @@ static void	rp_thumbnailer_get_property	(GObject	*object,
 						 GParamSpec	*pspec);
 
 static gboolean	rp_thumbnailer_timeout		(RpThumbnailer	*thumbnailer);
-static gboolean	rp_thumbnailer_process		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_dispatch		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_check_idle	(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_update_pool_status(RpThumbnailer	*thumbnailer);
+
+// Worker thread functions.
+struct request_info;
+static void	rp_thumbnailer_worker		(struct request_info *req,
+						 RpThumbnailer	*thumbnailer);
+static gboolean	rp_thumbnailer_request_done	(struct request_info *req);
 
 // D-Bus methods.
 static gboolean	rp_thumbnailer_queue		(SpecializedThumbnailer1 *skeleton,
@@ -83,6 +93,11 @@ static gboolean	rp_thumbnailer_dequeue		(SpecializedThumbnailer1 *skeleton,
 						 guint32	 handle,
 						 RpThumbnailer	*thumbnailer);
 
+// D-Bus properties.
+static void	rp_thumbnailer_max_threads_changed(ThumbnailerPool1 *pool_skeleton,
+						 GParamSpec	*pspec,
+						 RpThumbnailer	*thumbnailer);
+
 static GParamSpec *props[PROP_LAST];
 static guint signals[SIGNAL_LAST];
 
@@ -92,23 +107,60 @@ struct _RpThumbnailerClass {
 
 #define SHUTDOWN_TIMEOUT_SECONDS 30U
 
+// Worker thread limits
+#define DEFAULT_MAX_THREADS_LIMIT 4U	// Default is the number of CPUs, up to this limit.
+#define MAX_THREADS_LIMIT 16U		// Maximum value for the MaxThreads property.
+
 // Thumbnail request information.
 struct request_info {
 	gchar *uri;
 	guint32 handle;
 	bool large;	// False for 'normal' (128x128); true for 'large' (256x256)
 	bool urgent;	// 'urgent' value
+
+	/** Processing state **/
+
+	RpThumbnailer *thumbnailer;	// Owning RpThumbnailer (ref'd while processing)
+	gint cancelled;			// Set by Dequeue() if processing (atomic)
+	gint64 queue_time;		// Time Queue() was called (monotonic, in microseconds)
+	gint64 start_time;		// Time processing started
+	gint64 end_time;		// Time processing finished
+
+	// Result (set by the worker thread)
+	const char *error_msg;		// Error message (static string), or NULL on success
+	int error_code;			// Error code for the Error signal
+	bool error_has_uri;		// Include the URI in the Error signal?
 };
 
+/**
+ * Free a request_info struct.
+ * @param req request_info
+ */
+static void
+request_info_free(struct request_info *req)
+{
+	g_free(req->uri);
+	g_free(req);
+}
+
 struct _RpThumbnailer {
 	GObject __parent__;
 	SpecializedThumbnailer1 *skeleton;
+	ThumbnailerPool1 *pool_skeleton;
 
-	GQueue request_queue;	// Request queue (element is struct request_info*)
+	GQueue request_queue;	// Pending requests (element is struct request_info*)
+	GQueue active_requests;	// Requests being processed by worker threads
+	GThreadPool *thread_pool;	// Worker thread pool
+	guint max_threads;	// Maximum number of worker threads
 	guint timeout_id;	// Shutdown timeout
-	guint idle_process;	// Idle function for processing
 	guint32 last_handle;	// Last handle value
 
+	/** Statistics (for ThumbnailerPool1) **/
+
+	guint64 completed;		// Number of completed requests
+	gint64 total_latency;		// Total latency of completed requests (microseconds)
+	gint64 total_processing_time;	// Total processing time of completed requests (microseconds)
+
 	/** Status **/
 
 	bool shutdown_emitted;	// Has the shutdown signal been emitted?
@@ -203,6 +255,40 @@ rp_thumbnailer_constructed(GObject *object)
 	g_signal_connect_object(thumbnailer->skeleton, "handle-dequeue",
 		G_CALLBACK(rp_thumbnailer_dequeue), thumbnailer, G_CONNECT_DEFAULT);
 
+	// Default number of worker threads: Number of CPUs, up to a limit.
+	// NOTE: g_get_num_processors() requires glib-2.36.
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	thumbnailer->max_threads = (cpus > 0) ? (guint)cpus : 1U;
+	if (thumbnailer->max_threads > DEFAULT_MAX_THREADS_LIMIT) {
+		thumbnailer->max_threads = DEFAULT_MAX_THREADS_LIMIT;
+	}
+
+	// Create the worker thread pool.
+	// If this fails, thumbnails will be created on the main thread.
+	thumbnailer->thread_pool = g_thread_pool_new((GFunc)rp_thumbnailer_worker,
+		thumbnailer, (gint)thumbnailer->max_threads, false, &error);
+	if (error) {
+		g_warning("Unable to create the worker thread pool: %s", error->message);
+		g_clear_error(&error);
+		thumbnailer->thread_pool = NULL;
+		thumbnailer->max_threads = 1;
+	}
+
+	// Export the thread pool status interface on the same object.
+	// NOTE: Failure here isn't fatal.
+	thumbnailer->pool_skeleton = thumbnailer_pool1_skeleton_new();
+	thumbnailer_pool1_set_max_threads(thumbnailer->pool_skeleton, thumbnailer->max_threads);
+	g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(thumbnailer->pool_skeleton),
+		thumbnailer->connection, "/com/gerbilsoft/rom_properties/SpecializedThumbnailer1", &error);
+	if (error) {
+		g_warning("Error exporting ThumbnailerPool1 on session bus: %s", error->message);
+		g_clear_error(&error);
+		g_clear_object(&thumbnailer->pool_skeleton);
+	} else {
+		g_signal_connect_object(thumbnailer->pool_skeleton, "notify::max-threads",
+			G_CALLBACK(rp_thumbnailer_max_threads_changed), thumbnailer, G_CONNECT_DEFAULT);
+	}
+
 	// Make sure we shut down after inactivity.
 	thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
 		G_SOURCE_FUNC(rp_thumbnailer_timeout), thumbnailer);
@@ -223,10 +309,21 @@ rp_thumbnailer_dispose(GObject *object)
 		// TODO: Do we call g_object_notify_by_pspec() here?
 		thumbnailer->exported = false;
 	}
+	if (thumbnailer->pool_skeleton) {
+		g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(thumbnailer->pool_skeleton));
+		g_clear_object(&thumbnailer->pool_skeleton);
+	}
+
+	// Shut down the worker thread pool.
+	// NOTE: Requests being processed hold a reference to the
+	// RpThumbnailer, so there shouldn't be any at this point.
+	if (thumbnailer->thread_pool) {
+		g_thread_pool_free(thumbnailer->thread_pool, true, true);
+		thumbnailer->thread_pool = NULL;
+	}
 
 	// Unregister timer sources.
 	g_clear_handle_id(&thumbnailer->timeout_id, g_source_remove);
-	g_clear_handle_id(&thumbnailer->idle_process, g_source_remove);
 
 	/** Properties **/
 	g_clear_object(&thumbnailer->connection);
@@ -242,14 +339,15 @@ rp_thumbnailer_finalize(GObject *object)
 	g_clear_object(&thumbnailer->skeleton);
 
 	// Delete any remaining requests and free the queue.
+	// NOTE: active_requests should be empty, since requests
+	// being processed hold a reference to the RpThumbnailer.
 	for (GList *p = thumbnailer->request_queue.head; p != NULL; p = p->next) {
 		if (p->data) {
-			struct request_info *const req = (struct request_info*)p->data;
-			g_free(req->uri);
-			g_free(req);
+			request_info_free((struct request_info*)p->data);
 		}
 	}
 	g_queue_clear(&thumbnailer->request_queue);
+	g_queue_clear(&thumbnailer->active_requests);
 
 	/** Properties **/
 	g_free(thumbnailer->cache_dir);
@@ -386,24 +484,22 @@ rp_thumbnailer_queue(SpecializedThumbnailer1 *skeleton,
 
 	// Add the URI to the queue.
 	// NOTE: Currently handling all flavors that aren't "large" as "normal".
-	struct request_info *const req = g_malloc(sizeof(struct request_info));
+	struct request_info *const req = g_malloc0(sizeof(struct request_info));
 	req->uri = g_strdup(uri);
 	req->handle = handle;
 	req->large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
 	req->urgent = urgent;
+	req->queue_time = g_get_monotonic_time();
 	if (unlikely(urgent)) {
 		g_queue_push_head(&thumbnailer->request_queue, req);
 	} else {
 		g_queue_push_tail(&thumbnailer->request_queue, req);
 	}
 
-	// Make sure the idle process is started.
-	// TODO: Make it multi-threaded? (needs atomic compare and/or mutex...)
-	if (thumbnailer->idle_process == 0) {
-		thumbnailer->idle_process = g_idle_add(G_SOURCE_FUNC(rp_thumbnailer_process), thumbnailer);
-	}
-
 	specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
+
+	// Start processing the request if a worker thread is available.
+	rp_thumbnailer_dispatch(thumbnailer);
 	return true;
 }
 
@@ -424,11 +520,83 @@ rp_thumbnailer_dequeue(SpecializedThumbnailer1 *skeleton,
 	g_dbus_async_return_val_if_fail(RP_IS_THUMBNAILER(thumbnailer), invocation, false);
 	g_dbus_async_return_val_if_fail(handle != 0, invocation, false);
 
-	// TODO
+	// Check the pending requests first.
+	bool found = false;
+	for (GList *p = thumbnailer->request_queue.head; p != NULL; p = p->next) {
+		struct request_info *const req = (struct request_info*)p->data;
+		if (req->handle == handle) {
+			// Found the request. Remove it from the queue.
+			g_queue_delete_link(&thumbnailer->request_queue, p);
+			request_info_free(req);
+			found = true;
+			break;
+		}
+	}
+
+	if (!found) {
+		// Check the requests that are being processed.
+		// rp_create_thumbnail2() can't be interrupted, but if the
+		// request is cancelled, no signals will be emitted for it.
+		for (GList *p = thumbnailer->active_requests.head; p != NULL; p = p->next) {
+			struct request_info *const req = (struct request_info*)p->data;
+			if (req->handle == handle) {
+				g_atomic_int_set(&req->cancelled, 1);
+				break;
+			}
+		}
+	}
+
 	specialized_thumbnailer1_complete_dequeue(skeleton, invocation);
+
+	rp_thumbnailer_update_pool_status(thumbnailer);
+	rp_thumbnailer_check_idle(thumbnailer);
 	return true;
 }
 
+/**
+ * The MaxThreads property was changed over D-Bus.
+ * @param pool_skeleton	[in] ThumbnailerPool1
+ * @param pspec		[in] Property specification
+ * @param thumbnailer	[in] RpThumbnailer object
+ */
+static void
+rp_thumbnailer_max_threads_changed(ThumbnailerPool1 *pool_skeleton,
+	GParamSpec *pspec,
+	RpThumbnailer *thumbnailer)
+{
+	RP_UNUSED(pspec);
+	g_return_if_fail(RP_IS_THUMBNAILER(thumbnailer));
+
+	guint max_threads = thumbnailer_pool1_get_max_threads(pool_skeleton);
+	if (max_threads < 1) {
+		max_threads = 1;
+	} else if (max_threads > MAX_THREADS_LIMIT) {
+		max_threads = MAX_THREADS_LIMIT;
+	}
+	if (!thumbnailer->thread_pool) {
+		// No thread pool. Only one thumbnail can be created at a time.
+		max_threads = 1;
+	}
+
+	if (max_threads != thumbnailer_pool1_get_max_threads(pool_skeleton)) {
+		// Value was clamped. Update the property.
+		// NOTE: This will call this function again.
+		thumbnailer_pool1_set_max_threads(pool_skeleton, max_threads);
+		return;
+	}
+	if (max_threads == thumbnailer->max_threads) {
+		// No change.
+		return;
+	}
+
+	g_debug("Setting the maximum number of worker threads to %u.", max_threads);
+	thumbnailer->max_threads = max_threads;
+	g_thread_pool_set_max_threads(thumbnailer->thread_pool, (gint)max_threads, NULL);
+
+	// If the limit was increased, more requests can be started now.
+	rp_thumbnailer_dispatch(thumbnailer);
+}
+
 /**
  * Inactivity timeout has elapsed.
  * @param thumbnailer RpThumbnailer object.
@@ -437,7 +605,9 @@ static gboolean
 rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 {
 	g_return_val_if_fail(RP_IS_THUMBNAILER(thumbnailer), false);
-	if (!g_queue_is_empty(&thumbnailer->request_queue)) {
+	if (!g_queue_is_empty(&thumbnailer->request_queue) ||
+	    !g_queue_is_empty(&thumbnailer->active_requests))
+	{
 		// Still processing stuff.
 		return G_SOURCE_CONTINUE;
 	}
@@ -451,40 +621,113 @@ rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 }
 
 /**
- * Process a thumbnail.
+ * Restart the inactivity timeout if there are no requests left.
  * @param thumbnailer RpThumbnailer object.
  */
-static gboolean
-rp_thumbnailer_process(RpThumbnailer *thumbnailer)
+static void
+rp_thumbnailer_check_idle(RpThumbnailer *thumbnailer)
+{
+	if (!g_queue_is_empty(&thumbnailer->request_queue) ||
+	    !g_queue_is_empty(&thumbnailer->active_requests))
+	{
+		// Still processing stuff.
+		return;
+	}
+
+	// Restart the inactivity timeout.
+	if (G_LIKELY(thumbnailer->timeout_id == 0) && !thumbnailer->shutdown_emitted) {
+		thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
+			G_SOURCE_FUNC(rp_thumbnailer_timeout), thumbnailer);
+	}
+}
+
+/**
+ * Update the ThumbnailerPool1 queue status properties.
+ * @param thumbnailer RpThumbnailer object.
+ */
+static void
+rp_thumbnailer_update_pool_status(RpThumbnailer *thumbnailer)
+{
+	ThumbnailerPool1 *const pool_skeleton = thumbnailer->pool_skeleton;
+	if (!pool_skeleton)
+		return;
+
+	thumbnailer_pool1_set_queue_depth(pool_skeleton, thumbnailer->request_queue.length);
+	thumbnailer_pool1_set_active_requests(pool_skeleton, thumbnailer->active_requests.length);
+}
+
+/**
+ * Start processing pending requests, up to the maximum number of worker threads.
+ * @param thumbnailer RpThumbnailer object.
+ */
+static void
+rp_thumbnailer_dispatch(RpThumbnailer *thumbnailer)
+{
+	while (thumbnailer->active_requests.length < thumbnailer->max_threads) {
+		struct request_info *const req =
+			(struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
+		if (!req) {
+			// Nothing in the queue.
+			break;
+		}
+
+		// The request holds a reference to the RpThumbnailer
+		// until rp_thumbnailer_request_done() is called.
+		req->thumbnailer = g_object_ref(thumbnailer);
+		g_queue_push_tail(&thumbnailer->active_requests, req);
+		specialized_thumbnailer1_emit_started(thumbnailer->skeleton, req->handle);
+
+		GError *error = NULL;
+		if (thumbnailer->thread_pool) {
+			g_thread_pool_push(thumbnailer->thread_pool, req, &error);
+		}
+		if (!thumbnailer->thread_pool || error) {
+			// Unable to use the thread pool.
+			// Process the request on the main thread.
+			if (error) {
+				g_warning("Unable to start a worker thread: %s", error->message);
+				g_clear_error(&error);
+			}
+			rp_thumbnailer_worker(req, thumbnailer);
+		}
+	}
+
+	rp_thumbnailer_update_pool_status(thumbnailer);
+}
+
+/**
+ * Process a thumbnail request.
+ * This function runs on a worker thread.
+ * The result is handled by rp_thumbnailer_request_done() on the main thread.
+ * @param req		[in/out] Request
+ * @param thumbnailer	[in] RpThumbnailer object
+ */
+static void
+rp_thumbnailer_worker(struct request_info *req, RpThumbnailer *thumbnailer)
 {
 	gchar *cache_dir = NULL;	// cache directory (g_strdup_printf())
 	gchar *md5_string = NULL;	// MD5 of the original filename (owned by us)
 	gchar *cache_filename = NULL;	// full cache filename (g_strdup_printf())
 	int ret;
 
-	g_return_val_if_fail(RP_IS_THUMBNAILER(thumbnailer), FALSE);
-
-	// Process one thumbnail.
-	const struct request_info *req = (struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
-	if (req == NULL) {
-		// Nothing in the queue.
-		goto cleanup;
+	// NOTE: Only the construct-only properties of RpThumbnailer
+	// may be accessed here, since this is a worker thread.
+	req->start_time = g_get_monotonic_time();
+	if (g_atomic_int_get(&req->cancelled)) {
+		// Request was cancelled before processing started.
+		goto finished;
 	}
 
 	// NOTE: cache_dir and pfn_rp_create_thumbnail2 should NOT be NULL
 	// at this point, but we're checking it anyway.
 	if (!thumbnailer->cache_dir || thumbnailer->cache_dir[0] == 0) {
 		// No cache directory...
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "Thumbnail cache directory is empty.");
+		req->error_msg = "Thumbnail cache directory is empty.";
 		goto finished;
 	}
 	if (!thumbnailer->pfn_rp_create_thumbnail2) {
 		// No thumbnailer function.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "No thumbnailer function is available.");
+		req->error_msg = "No thumbnailer function is available.";
 		goto finished;
 	}
 
@@ -495,16 +738,14 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 		thumbnailer->cache_dir, (req->large ? "large" : "normal"));
 	if (!cache_dir) {
 		// g_strdup_printf() failed.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot g_strdup_printf() the thumbnail cache directory.");
+		req->error_msg = "Cannot g_strdup_printf() the thumbnail cache directory.";
+		req->error_has_uri = true;
 		goto finished;
 	}
 
 	if (g_mkdir_with_parents(cache_dir, 0777) != 0) {
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot mkdir() the thumbnail cache directory.");
+		req->error_msg = "Cannot mkdir() the thumbnail cache directory.";
+		req->error_has_uri = true;
 		goto finished;
 	}
 
@@ -512,9 +753,8 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	md5_string = g_compute_checksum_for_data(G_CHECKSUM_MD5, (const guchar*)req->uri, strlen(req->uri));
 	if (!md5_string) {
 		// Cannot compute the checksum...
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "g_compute_checksum_for_data() failed.");
+		req->error_msg = "g_compute_checksum_for_data() failed.";
+		req->error_has_uri = true;
 		goto finished;
 	}
 
@@ -522,9 +762,8 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	cache_filename = g_strdup_printf("%s/%s.png", cache_dir, md5_string);
 	if (!cache_filename) {
 		// g_strdup_printf() failed.
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot g_strdup_printf() the thumbnail cache filename.");
+		req->error_msg = "Cannot g_strdup_printf() the thumbnail cache filename.";
+		req->error_has_uri = true;
 		goto finished;
 	}
 
@@ -533,45 +772,81 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	if (ret == 0) {
 		// Image thumbnailed successfully.
 		g_debug("rom-properties thumbnail: %s -> %s [OK]", req->uri, cache_filename);
-		specialized_thumbnailer1_emit_ready(
-			thumbnailer->skeleton, req->handle, req->uri);
 	} else {
 		// Error thumbnailing the image...
 		g_debug("rom-properties thumbnail: %s -> %s [ERR=%d]", req->uri, cache_filename, ret);
-		specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			2, "Image thumbnailing failed... (TODO: return code)");
+		req->error_msg = "Image thumbnailing failed... (TODO: return code)";
+		req->error_code = 2;
+		req->error_has_uri = true;
 	}
 
 finished:
-	// Request is finished. Emit the finished signal.
-	specialized_thumbnailer1_emit_finished(
-		thumbnailer->skeleton, req->handle);
+	req->end_time = g_get_monotonic_time();
 
-cleanup:
 	// Free allocated things.
 	g_free(cache_filename);
 	g_free(md5_string);
 	g_free(cache_dir);
 
-	// req was allocated using g_malloc() before it was
-	// added to the queue. We'll need to free it here.
-	g_free((gpointer)req);
-
-	// Return TRUE if we still have more thumbnails queued.
-	const bool isEmpty = g_queue_is_empty(&thumbnailer->request_queue);
-	if (isEmpty) {
-		// Clear the idle process.
-		// FIXME: Atomic compare and/or mutex? (assuming multi-threaded...)
-		thumbnailer->idle_process = 0;
-
-		// Restart the inactivity timeout.
-		if (G_LIKELY(thumbnailer->timeout_id == 0)) {
-			thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
-				G_SOURCE_FUNC(rp_thumbnailer_timeout), thumbnailer);
-		}
+	// Emit the D-Bus signals on the main thread.
+	g_idle_add(G_SOURCE_FUNC(rp_thumbnailer_request_done), req);
+}
+
+/**
+ * A thumbnail request has been processed.
+ * This function runs on the main thread.
+ * @param req Request
+ */
+static gboolean
+rp_thumbnailer_request_done(struct request_info *req)
+{
+	RpThumbnailer *const thumbnailer = req->thumbnailer;
+	const gint64 latency = req->end_time - req->queue_time;
+	g_queue_remove(&thumbnailer->active_requests, req);
+
+	if (g_atomic_int_get(&req->cancelled)) {
+		// Request was cancelled by Dequeue().
+		// Don't emit any signals or update the statistics.
+		goto done;
 	}
-	return !isEmpty;
+
+	if (req->error_msg) {
+		specialized_thumbnailer1_emit_error(
+			thumbnailer->skeleton, req->handle,
+			(req->error_has_uri ? req->uri : ""),
+			req->error_code, req->error_msg);
+	} else {
+		specialized_thumbnailer1_emit_ready(
+			thumbnailer->skeleton, req->handle, req->uri);
+	}
+
+	// Request is finished. Emit the finished signal.
+	specialized_thumbnailer1_emit_finished(
+		thumbnailer->skeleton, req->handle);
+
+	// Update the statistics.
+	thumbnailer->completed++;
+	thumbnailer->total_latency += latency;
+	thumbnailer->total_processing_time += req->end_time - req->start_time;
+	if (thumbnailer->pool_skeleton) {
+		ThumbnailerPool1 *const pool_skeleton = thumbnailer->pool_skeleton;
+		thumbnailer_pool1_set_completed_requests(pool_skeleton, thumbnailer->completed);
+		thumbnailer_pool1_set_last_latency(pool_skeleton, (guint)(latency / 1000));
+		thumbnailer_pool1_set_average_latency(pool_skeleton,
+			(guint)(thumbnailer->total_latency / (gint64)thumbnailer->completed / 1000));
+		thumbnailer_pool1_set_average_processing_time(pool_skeleton,
+			(guint)(thumbnailer->total_processing_time / (gint64)thumbnailer->completed / 1000));
+	}
+
+done:
+	request_info_free(req);
+
+	// Start the next request, if any.
+	rp_thumbnailer_dispatch(thumbnailer);
+	rp_thumbnailer_check_idle(thumbnailer);
+
+	g_object_unref(thumbnailer);
+	return G_SOURCE_REMOVE;
 }
 
 /**
@@ -59,8 +59,22 @@ int rpt_do_security_options(void)
 		__NR_openat2,		// Linux 5.6
 #endif /* __SNR_openat2 || __NR_openat2 */
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+
+		// LibRomData::CacheIndex [CacheManager::download()]
+		SCMP_SYS(flock),
+		SCMP_SYS(rename), SCMP_SYS(renameat),
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),	// mkstemp() [glibc-2.34]
+#endif /* __SNR_getrandom */
 		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpBase::FileSystem::isOnBadFS()
 
+		// ConfReader watches the configuration directory for changes.
+		SCMP_SYS(inotify_init1), SCMP_SYS(inotify_add_watch),
+
 		// ConfReader checks timestamps between rpcli runs.
 		// NOTE: Only seems to get triggered on PowerPC...
 		SCMP_SYS(clock_gettime), SCMP_SYS(clock_gettime64),
@@ -107,11 +121,12 @@ int rpt_do_security_options(void)
 	// - wpath: Write to ~/.cache/rom-properties/
 	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
 	// - getpw: Get user's home directory if HOME is empty.
+	// - flock: Lock the download cache index.
 	// - unix: UNIX domain sockets. (for D-Bus)
-	param.promises = "stdio rpath wpath cpath getpw unix";
+	param.promises = "stdio rpath wpath cpath getpw flock unix";
 #elif defined(HAVE_TAME)
 	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW | TAME_UNIX;
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW | TAME_FLOCK | TAME_UNIX;
 #else
 	param.dummy = 0;
 #endif
@@ -17,6 +17,7 @@ using namespace LibRpTexture;
 using LibRpBase::RomFields;
 
 // C++ STL classes
+#include <atomic>
 #include <unordered_map>
 using std::array;
 using std::set;
@@ -25,16 +26,88 @@ using std::unordered_map;
 using std::vector;
 
 // Qt includes
+#include <QtCore/QCache>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
 #include <QtGui/QPixmap>
 
 #include "RpQt.hpp"
 
+/** IconConvertTask **/
+
+/**
+ * Scale an RFT_LISTDATA icon for the specified icon size.
+ * This runs in a worker thread, so only QImage can be used here.
+ */
+class IconConvertTask : public QRunnable
+{
+public:
+	IconConvertTask(ListDataModel *model, const std::atomic<bool> &cancelled,
+			unsigned int generation, int row, const QImage &image, QSize iconSize)
+		: model(model)
+		, cancelled(cancelled)
+		, generation(generation)
+		, row(row)
+		, image(image)
+		, iconSize(iconSize)
+	{}
+
+	void run(void) final;
+
+private:
+	ListDataModel *const model;
+	const std::atomic<bool> &cancelled;
+	const unsigned int generation;
+	const int row;
+	QImage image;
+	const QSize iconSize;
+};
+
+void IconConvertTask::run(void)
+{
+	if (cancelled)
+		return;
+
+	if (!image.isNull()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+		// NOTE: Assuming square icons.
+		int icon_w = image.width();
+		int icon_h = image.height();
+		if (icon_w > iconSize.width() || icon_h > iconSize.height()) {
+			// Instead of scaling icons down, set a device pixel ratio.
+			// This allows for higher-resolution display on high-DPI screens.
+			image.setDevicePixelRatio(static_cast<qreal>(icon_w) / static_cast<qreal>(iconSize.width()));
+		} else if (icon_w > 0 && icon_h > 0) {
+			// Scale up using integer scaling, then set a device pixel ratio.
+			while (icon_w < iconSize.width()) {
+				icon_w += image.width();
+				icon_h += image.height();
+			}
+			image = image.scaled(icon_w, icon_h, Qt::KeepAspectRatio, Qt::FastTransformation);
+			image.setDevicePixelRatio(static_cast<qreal>(icon_w) / static_cast<qreal>(iconSize.width()));
+		}
+#else /* QT_VERSION < QT_VERSION_CHECK(5, 0, 0) */
+		// Do we need to resize the icon?
+		if (image.size() != iconSize) {
+			// Resize is needed.
+			image = image.scaled(iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		}
+#endif /* QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) */
+	}
+
+	// QPixmap can only be created on the GUI thread.
+	QMetaObject::invokeMethod(model, "iconConverted", Qt::QueuedConnection,
+		Q_ARG(uint, generation), Q_ARG(int, row), Q_ARG(QSize, iconSize), Q_ARG(QImage, image));
+}
+
 /** ListDataModelPrivate **/
 
 class ListDataModelPrivate
 {
 public:
 	explicit ListDataModelPrivate(ListDataModel *q);
+	~ListDataModelPrivate();
 
 protected:
 	ListDataModel *const q_ptr;
@@ -63,12 +136,26 @@ public:
 	const vector<QString> *pData;
 
 	// Icons
-	// NOTE: References to rp_image* are kept in case
-	// the icon size is changed.
-	vector<QPixmap> icons;
+	// NOTE: Icons are converted on demand when the view requests
+	// them, i.e. when a row becomes visible. Converted icons are
+	// kept in a bounded cache, keyed by row and icon size.
 	vector<rp_image_const_ptr> icons_rp;
 	QSize iconSize;
 
+	// Icon cache (key: row and icon size)
+	// Cost is 1 per icon, so maxCost is the maximum number of icons.
+	static constexpr int ICON_CACHE_MAX = 128;
+	mutable QCache<quint64, QPixmap> iconCache;
+	mutable QSet<quint64> iconsPending;
+	mutable QPixmap iconPlaceholder;
+
+	// Icon conversion thread pool
+	// The generation is incremented when the field is changed,
+	// so stale results can be discarded.
+	QThreadPool *iconThreadPool;
+	std::atomic<bool> iconCancelled;
+	unsigned int iconGeneration;
+
 	// Qt::ItemFlags
 	Qt::ItemFlags itemFlags;
 
@@ -90,9 +177,26 @@ public:
 	void clearData(void);
 
 	/**
-	 * Update the icons pixmap vector.
+	 * Get the icon cache key for the specified row and icon size.
+	 * @param row Row
+	 * @param size Icon size
+	 * @return Icon cache key
 	 */
-	void updateIconPixmaps(void);
+	static inline quint64 iconCacheKey(int row, QSize size)
+	{
+		return (static_cast<quint64>(static_cast<uint32_t>(row)) << 32) |
+		       (static_cast<quint64>(size.width() & 0xFFFF) << 16) |
+		        static_cast<quint64>(size.height() & 0xFFFF);
+	}
+
+	/**
+	 * Get the icon for the specified row.
+	 * If the icon hasn't been converted yet, a conversion is
+	 * started in the background and a placeholder is returned.
+	 * @param row Row
+	 * @return Icon, or placeholder if the icon isn't ready yet.
+	 */
+	QPixmap getIcon(int row) const;
 
 	/**
 	 * Convert a single language from RFT_LISTDATA or RFT_LISTDATA_MULTI to vector<QString>.
@@ -140,6 +244,10 @@ ListDataModelPrivate::ListDataModelPrivate(ListDataModel *q)
 	, rowCount(0)
 	, pData(nullptr)
 	, iconSize(QSize(32, 32))
+	, iconCache(ICON_CACHE_MAX)
+	, iconThreadPool(new QThreadPool())
+	, iconCancelled(false)
+	, iconGeneration(0)
 	, itemFlags(Qt::NoItemFlags)
 	, align_headers(0)
 	, align_data(0)
@@ -148,6 +256,20 @@ ListDataModelPrivate::ListDataModelPrivate(ListDataModel *q)
 	, lc('en')
 {
 	// TODO: Better default icon size?
+
+	// A single worker thread is sufficient here, since only
+	// visible rows are converted.
+	iconThreadPool->setMaxThreadCount(1);
+}
+
+ListDataModelPrivate::~ListDataModelPrivate()
+{
+	// Cancel pending icon conversions.
+	// NOTE: QThreadPool's destructor waits for running tasks.
+	// Queued iconConverted() calls are discarded when the
+	// ListDataModel is destroyed.
+	iconCancelled = true;
+	delete iconThreadPool;
 }
 
 /**
@@ -165,56 +287,48 @@ void ListDataModelPrivate::clearData(void)
 	align_data = 0;
 
 	// Clear icons.
-	icons.clear();
 	icons_rp.clear();
+	iconCache.clear();
+	iconsPending.clear();
+	iconGeneration++;
 }
 
 /**
- * Update the icons pixmap vector.
+ * Get the icon for the specified row.
+ * If the icon hasn't been converted yet, a conversion is
+ * started in the background and a placeholder is returned.
+ * @param row Row
+ * @return Icon, or placeholder if the icon isn't ready yet.
  */
-void ListDataModelPrivate::updateIconPixmaps(void)
+QPixmap ListDataModelPrivate::getIcon(int row) const
 {
-	icons.clear();
-	icons.reserve(icons_rp.size());
-
-	for (const auto &icon : icons_rp) {
-		if (!icon) {
-			icons.push_back(QPixmap());
-			continue;
-		}
+	const rp_image_const_ptr &icon = icons_rp[row];
+	if (!icon) {
+		return {};
+	}
 
-		QPixmap pixmap = QPixmap::fromImage(rpToQImage(icon));
+	const quint64 key = iconCacheKey(row, iconSize);
+	const QPixmap *const pixmap = iconCache.object(key);
+	if (pixmap) {
+		return *pixmap;
+	}
 
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-		// NOTE: Assuming square pixmaps.
-		int icon_w = icon->width();
-		int icon_h = icon->height();
-		if (icon_w > iconSize.width() || icon_h > iconSize.height()) {
-			// Instead of scaling icons down, set a device pixel ratio.
-			// This allows for higher-resolution display on high-DPI screens.
-			pixmap.setDevicePixelRatio(static_cast<qreal>(icon_w) / static_cast<qreal>(iconSize.width()));
-		} else if (icon_w > 0 && icon_h > 0) {
-			// Scale up using integer scaling, then set a device pixel ratio.
-			while (icon_w < iconSize.width()) {
-				icon_w += icon->width();
-				icon_h += icon->height();
-			}
-			pixmap = pixmap.scaled(icon_w, icon_h, Qt::KeepAspectRatio, Qt::FastTransformation);
-			
-			pixmap.setDevicePixelRatio(static_cast<qreal>(icon_w) / static_cast<qreal>(iconSize.width()));
-		}
-#else /* QT_VERSION < QT_VERSION_CHECK(5, 0, 0) */
-		// Do we need to resize the icon?
-		if (icon->width() != iconSize.width() ||
-		    icon->height() != iconSize.height())
-		{
-			// Resize is needed.
-			pixmap = pixmap.scaled(iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-		}
-#endif /* QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) */
+	if (!iconsPending.contains(key)) {
+		// Start converting the icon.
+		// NOTE: rpToQImage() may update the rp_image's QImage,
+		// so it must be called on the GUI thread.
+		iconsPending.insert(key);
+		iconThreadPool->start(new IconConvertTask(q_ptr,
+			iconCancelled, iconGeneration, row, rpToQImage(icon), iconSize));
+	}
 
-		icons.push_back(std::move(pixmap));
+	// Transparent placeholder, so the row height doesn't
+	// change once the icon has been converted.
+	if (iconPlaceholder.size() != iconSize) {
+		iconPlaceholder = QPixmap(iconSize);
+		iconPlaceholder.fill(Qt::transparent);
 	}
+	return iconPlaceholder;
 }
 
 /**
@@ -431,16 +545,16 @@ QVariant ListDataModel::data(const QModelIndex &index, int role) const
 			return (d->checkboxes & (1U << row)) ? Qt::Checked : Qt::Unchecked;
 
 		case Qt::DecorationRole:
-			if (column != 0 || d->icons.empty())
+			if (column != 0 || d->icons_rp.empty())
 				break;
-			if (row <= static_cast<int>(d->icons.size()))
-				return d->icons[row];
+			if (row < static_cast<int>(d->icons_rp.size()))
+				return d->getIcon(row);
 			break;
 
 		case RpImageRole:
-			if (column != 0 || d->icons.empty())
+			if (column != 0 || d->icons_rp.empty())
 				break;
-			if (row <= static_cast<int>(d->icons.size())) {
+			if (row < static_cast<int>(d->icons_rp.size())) {
 				// NOTE: We can't put an std::shared_ptr<> in QVariant.
 				// Pass a pointer to the std::shared_ptr<> instead.
 				if (d->icons_rp[row]) {
@@ -659,10 +773,8 @@ void ListDataModel::setField(const RomFields::Field *pField)
 
 		// NOTE 2: Since we're using shared_ptr<> now, we can just
 		// copy the entire vector over without manually iterating.
+		// Icons are converted on demand; see getIcon().
 		d->icons_rp = *(pField->data.list_data.mxd.icons);
-
-		// Update the icons pixmap vector.
-		d->updateIconPixmaps();
 	}
 
 	if (d->pData) {
@@ -755,7 +867,7 @@ void ListDataModel::setIconSize(QSize iconSize)
 
 	d->iconSize = iconSize;
 	if (!d->icons_rp.empty()) {
-		d->updateIconPixmaps();
+		// Icons will be converted for the new size on demand.
 		const QModelIndex indexFirst = createIndex(0, 0);
 		const QModelIndex indexLast = createIndex(d->rowCount-1, 0);
 		emit dataChanged(indexFirst, indexLast);
@@ -773,3 +885,30 @@ QSize ListDataModel::iconSize(void) const
 	Q_D(const ListDataModel);
 	return d->iconSize;
 }
+
+/** Private slots **/
+
+/**
+ * An icon has been converted by IconConvertTask.
+ * @param generation Icon generation
+ * @param row Row
+ * @param size Icon size
+ * @param image Converted icon
+ */
+void ListDataModel::iconConverted(uint generation, int row, QSize size, const QImage &image)
+{
+	Q_D(ListDataModel);
+	if (generation != d->iconGeneration) {
+		// Stale result from a previous field.
+		return;
+	}
+
+	const quint64 key = d->iconCacheKey(row, size);
+	d->iconsPending.remove(key);
+	d->iconCache.insert(key, new QPixmap(QPixmap::fromImage(image)));
+
+	if (size == d->iconSize && row < d->rowCount) {
+		const QModelIndex index = createIndex(row, 0);
+		emit dataChanged(index, index);
+	}
+}
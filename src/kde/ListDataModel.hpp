@@ -14,6 +14,7 @@
 // Qt includes
 #include <QtCore/QAbstractListModel>
 #include <QtCore/QSize>
+#include <QtGui/QImage>
 
 // C++ includes
 #include <set>
@@ -121,4 +122,14 @@ signals:
 	 * @param iconSize Icon size.
 	 */
 	void iconSizeChanged(QSize iconSize);
+
+private slots:
+	/**
+	 * An icon has been converted by IconConvertTask.
+	 * @param generation Icon generation
+	 * @param row Row
+	 * @param size Icon size
+	 * @param image Converted icon
+	 */
+	void iconConverted(uint generation, int row, QSize size, const QImage &image);
 };
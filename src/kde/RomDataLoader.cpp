@@ -0,0 +1,97 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (KDE)                              *
+ * RomDataLoader.cpp: Asynchronous RomData loader for RomDataView.         *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "RomDataLoader.hpp"
+
+// Other rom-properties libraries
+#include "libi18n/i18n.hpp"
+using namespace LibRpBase;
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cstring>
+
+#include "RpQt.hpp"
+
+// libfmt
+#include "rp-libfmt.h"
+
+RomDataLoader::RomDataLoader(const RomDataPtr &romData, QObject *parent)
+	: super(parent)
+	, m_romData(romData)
+	, m_cancelled(false)
+{}
+
+/**
+ * Get the header row information from a RomData object.
+ * The caller must have exclusive access to the RomData object.
+ * @param romData	[in] RomData object
+ * @param info		[out] Header row information
+ */
+void RomDataLoader::getHeaderInfo(const RomData *romData, HeaderInfo &info)
+{
+	// System name and file type
+	// TODO: System logo and/or game title?
+	const char *systemName = romData->systemName(
+		RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
+	const char *fileType = romData->fileType_string();
+	assert(systemName != nullptr);
+	assert(fileType != nullptr);
+	if (!systemName) {
+		systemName = C_("RomDataView", "(unknown system)");
+	}
+	if (!fileType) {
+		fileType = C_("RomDataView", "(unknown filetype)");
+	}
+
+	info.sysInfo = U82Q(fmt::format(
+		// tr: {0:s} == system name, {1:s} == file type
+		FRUN(C_("RomDataView", "{0:s}\n{1:s}")), systemName, fileType));
+
+	// Supported image types
+	const uint32_t imgbf = romData->supportedImageTypes();
+
+	// Banner
+	if (imgbf & RomData::IMGBF_INT_BANNER) {
+		info.banner = romData->image(RomData::IMG_INT_BANNER);
+	}
+
+	// Icon
+	if (imgbf & RomData::IMGBF_INT_ICON) {
+		info.icon = romData->image(RomData::IMG_INT_ICON);
+		if (info.icon && info.icon->isValid()) {
+			// Is this an animated icon?
+			info.iconAnimData = romData->iconAnimData();
+		}
+	}
+
+	info.ecksBawks = (romData->fileType() == RomData::FileType::DiscImage &&
+	                  strstr(systemName, "Xbox") != nullptr);
+}
+
+/**
+ * Load the RomData object.
+ */
+void RomDataLoader::run(void)
+{
+	if (!m_romData || m_cancelled) {
+		return;
+	}
+
+	// Get the header row information first, so the
+	// header row can be shown while the fields are loading.
+	getHeaderInfo(m_romData.get(), m_header);
+	emit headerReady();
+	if (m_cancelled) {
+		return;
+	}
+
+	// Load the fields.
+	// NOTE: RomData::fields() loads the field data if necessary.
+	m_romData->fields();
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (KDE)                              *
+ * RomDataLoader.hpp: Asynchronous RomData loader for RomDataView.         *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// librpbase, librptexture
+#include "librpbase/RomData.hpp"
+#include "librpbase/img/IconAnimData.hpp"
+#include "librptexture/img/rp_image.hpp"
+
+// C++ includes
+#include <atomic>
+
+// Qt includes
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+/**
+ * Asynchronous RomData loader.
+ *
+ * The RomData object's fields are loaded in a separate thread, so slow
+ * parsing and decryption (e.g. large disc images on network filesystems)
+ * doesn't block the UI. The header row information is made available
+ * first, followed by the fields.
+ *
+ * RomData objects aren't thread-safe, so the RomData object must not be
+ * accessed by anything else until QThread::finished() is emitted.
+ */
+class RomDataLoader : public QThread
+{
+	Q_OBJECT
+
+public:
+	explicit RomDataLoader(const LibRpBase::RomDataPtr &romData, QObject *parent = nullptr);
+
+private:
+	typedef QThread super;
+public:
+	Q_DISABLE_COPY(RomDataLoader)
+
+public:
+	/**
+	 * Header row information.
+	 * Copied out of the RomData object so the header row can be
+	 * shown while the RomData object is still being loaded.
+	 */
+	struct HeaderInfo {
+		QString sysInfo;				// System name and file type
+		LibRpTexture::rp_image_const_ptr banner;	// Internal banner
+		LibRpTexture::rp_image_const_ptr icon;		// Internal icon
+		LibRpBase::IconAnimDataConstPtr iconAnimData;	// Animated icon data
+		bool ecksBawks;
+
+		HeaderInfo() : ecksBawks(false) { }
+	};
+
+	/**
+	 * Get the header row information from a RomData object.
+	 * The caller must have exclusive access to the RomData object.
+	 * @param romData	[in] RomData object
+	 * @param info		[out] Header row information
+	 */
+	static void getHeaderInfo(const LibRpBase::RomData *romData, HeaderInfo &info);
+
+	/**
+	 * Get the header row information.
+	 * Only valid after headerReady() has been emitted.
+	 * @return Header row information
+	 */
+	inline const HeaderInfo &headerInfo(void) const
+	{
+		return m_header;
+	}
+
+	/**
+	 * Get the RomData object.
+	 * Only valid after QThread::finished() has been emitted.
+	 * @return RomData object
+	 */
+	inline LibRpBase::RomDataPtr romData(void) const
+	{
+		return m_romData;
+	}
+
+	/**
+	 * Cancel loading.
+	 * RomData functions can't be interrupted, so the thread
+	 * will exit once the current loading step is done.
+	 */
+	inline void cancel(void)
+	{
+		m_cancelled = true;
+	}
+
+	/**
+	 * Has loading been cancelled?
+	 * @return True if cancelled; false if not.
+	 */
+	inline bool isCancelled(void) const
+	{
+		return m_cancelled;
+	}
+
+protected:
+	/**
+	 * Load the RomData object.
+	 */
+	void run(void) final;
+
+signals:
+	/**
+	 * The header row information is available.
+	 */
+	void headerReady(void);
+
+private:
+	LibRpBase::RomDataPtr m_romData;
+	HeaderInfo m_header;
+	std::atomic<bool> m_cancelled;
+};
@@ -44,6 +44,7 @@ using std::string;
 RomDataViewPrivate::RomDataViewPrivate(RomDataView *q, const RomDataPtr &romData)
 	: q_ptr(q)
 	, romData(romData)
+	, loader(nullptr)
 	, btnOptions(nullptr)
 #ifdef HAVE_KMESSAGEWIDGET
 	, messageWidget(nullptr)
@@ -55,6 +56,7 @@ RomDataViewPrivate::RomDataViewPrivate(RomDataView *q, const RomDataPtr &romData
 
 RomDataViewPrivate::~RomDataViewPrivate()
 {
+	cancelLoader();
 	ui.lblIcon->clearRp();
 	ui.lblBanner->clearRp();
 }
@@ -166,92 +168,117 @@ void RomDataViewPrivate::initHeaderRow(void)
 		return;
 	}
 
-	// System name and file type
-	// TODO: System logo and/or game title?
-	const char *systemName = romData->systemName(
-		RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
-	const char *fileType = romData->fileType_string();
-	assert(systemName != nullptr);
-	assert(fileType != nullptr);
-	if (!systemName) {
-		systemName = C_("RomDataView", "(unknown system)");
-	}
-	if (!fileType) {
-		fileType = C_("RomDataView", "(unknown filetype)");
-	}
+	RomDataLoader::HeaderInfo info;
+	RomDataLoader::getHeaderInfo(romData.get(), info);
+	setHeaderRow(info);
+}
 
-	const QString sysInfo = U82Q(fmt::format(
-		// tr: {0:s} == system name, {1:s} == file type
-		FRUN(C_("RomDataView", "{0:s}\n{1:s}")), systemName, fileType));
-	ui.lblSysInfo->setText(sysInfo);
+/**
+ * Set the header row widgets.
+ * @param info Header row information
+ */
+void RomDataViewPrivate::setHeaderRow(const RomDataLoader::HeaderInfo &info)
+{
+	ui.lblSysInfo->setText(info.sysInfo);
 	ui.lblSysInfo->show();
 
-	// Supported image types
-	const uint32_t imgbf = romData->supportedImageTypes();
 	// FIXME: Store the standard image height somewhere else.
 	static constexpr int imgStdHeight = 32;
 	bool ok = false;
 
 	// Banner
-	if (imgbf & RomData::IMGBF_INT_BANNER) {
-		// Get the banner.
-		const rp_image_const_ptr img = romData->image(RomData::IMG_INT_BANNER);
-		if (img) {
-			ok = ui.lblBanner->setRpImage(img);
-			if (ok) {
-				// Adjust the banner size.
-				adjustImageHeight(ui.lblBanner, QSize(img->width(), img->height()), imgStdHeight);
-			}
+	const rp_image_const_ptr &img = info.banner;
+	if (img) {
+		ok = ui.lblBanner->setRpImage(img);
+		if (ok) {
+			// Adjust the banner size.
+			adjustImageHeight(ui.lblBanner, QSize(img->width(), img->height()), imgStdHeight);
 		}
 	}
 	ui.lblBanner->setVisible(ok);
 
 	// Icon
 	ok = false;
-	if (imgbf & RomData::IMGBF_INT_ICON) {
-		// Get the icon.
-		const rp_image_const_ptr icon = romData->image(RomData::IMG_INT_ICON);
-		if (icon && icon->isValid()) {
-			QSize iconSize;
-
-			// Is this an animated icon?
-			const IconAnimDataConstPtr iconAnimData = romData->iconAnimData();
-			if (iconAnimData) {
-				ok = ui.lblIcon->setIconAnimData(romData->iconAnimData());
-				if (ok) {
-					// Get the size of the first animated icon frame.
-					const int frame = iconAnimData->seq_index[0];
-					const rp_image_ptr &img = iconAnimData->frames[frame];
-					assert((bool)img);
-					if (img) {
-						iconSize = QSize(img->width(), img->height());
-					} else {
-						// Invalid icon frame?
-						ui.lblIcon->setIconAnimData(nullptr);
-						ok = false;
-					}
-				}
-			}
-			if (!ok) {
-				// Not an animated icon, or invalid icon data.
-				// Set the static icon.
-				ok = ui.lblIcon->setRpImage(icon);
-				if (ok) {
-					iconSize = QSize(icon->width(), icon->height());
+	const rp_image_const_ptr &icon = info.icon;
+	if (icon && icon->isValid()) {
+		QSize iconSize;
+
+		// Is this an animated icon?
+		const IconAnimDataConstPtr &iconAnimData = info.iconAnimData;
+		if (iconAnimData) {
+			ok = ui.lblIcon->setIconAnimData(iconAnimData);
+			if (ok) {
+				// Get the size of the first animated icon frame.
+				const int frame = iconAnimData->seq_index[0];
+				const rp_image_ptr &img = iconAnimData->frames[frame];
+				assert((bool)img);
+				if (img) {
+					iconSize = QSize(img->width(), img->height());
+				} else {
+					// Invalid icon frame?
+					ui.lblIcon->setIconAnimData(nullptr);
+					ok = false;
 				}
 			}
-
+		}
+		if (!ok) {
+			// Not an animated icon, or invalid icon data.
+			// Set the static icon.
+			ok = ui.lblIcon->setRpImage(icon);
 			if (ok) {
-				// Adjust the icon size.
-				adjustImageHeight(ui.lblIcon, iconSize, imgStdHeight);
+				iconSize = QSize(icon->width(), icon->height());
 			}
 		}
+
+		if (ok) {
+			// Adjust the icon size.
+			adjustImageHeight(ui.lblIcon, iconSize, imgStdHeight);
+		}
 	}
 	ui.lblIcon->setVisible(ok);
 
-	const bool ecksBawks = (romData->fileType() == RomData::FileType::DiscImage &&
-	                        systemName && strstr(systemName, "Xbox") != nullptr);
-	ui.lblIcon->setEcksBawks(ecksBawks);
+	ui.lblIcon->setEcksBawks(info.ecksBawks);
+}
+
+/**
+ * Show a placeholder in the header row while the RomData object is loading.
+ */
+void RomDataViewPrivate::showLoading(void)
+{
+	ui.lblSysInfo->setText(QC_("RomDataView", "Loading..."));
+	ui.lblSysInfo->show();
+	ui.lblBanner->hide();
+	ui.lblIcon->hide();
+}
+
+/**
+ * Cancel the asynchronous RomData loader, if it's running.
+ * The loader will be deleted once its thread exits.
+ */
+void RomDataViewPrivate::cancelLoader(void)
+{
+	if (!loader) {
+		return;
+	}
+
+	// Disconnect the loader's signals from RomDataView,
+	// and delete the loader once its thread exits.
+	// NOTE: If the thread has already exited, QThread::finished()
+	// won't be emitted again, so delete it now.
+	Q_Q(RomDataView);
+	QObject::disconnect(loader, nullptr, q, nullptr);
+	loader->cancel();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	QObject::connect(loader, &QThread::finished,
+			 loader, &QObject::deleteLater);
+#else /* QT_VERSION < QT_VERSION_CHECK(5, 0, 0) */
+	QObject::connect(loader, SIGNAL(finished()),
+			 loader, SLOT(deleteLater()));
+#endif /* QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) */
+	if (loader->isFinished()) {
+		loader->deleteLater();
+	}
+	loader = nullptr;
 }
 
 /**
@@ -1415,6 +1442,7 @@ RomDataPtr RomDataView::romData(void) const
 void RomDataView::setRomData(const RomDataPtr &romData)
 {
 	Q_D(RomDataView);
+	d->cancelLoader();
 	if (d->romData == romData) {
 		return;
 	}
@@ -1438,3 +1466,100 @@ void RomDataView::setRomData(const RomDataPtr &romData)
 
 	emit romDataChanged(romData);
 }
+
+/**
+ * Load a RomData object asynchronously.
+ *
+ * The RomData object's fields are loaded in a separate thread.
+ * A placeholder is shown until the header row is available, and
+ * romDataChanged() is emitted once the fields have been loaded.
+ *
+ * @param romData New RomData object
+ */
+void RomDataView::loadRomData(const RomDataPtr &romData)
+{
+	Q_D(RomDataView);
+	d->cancelLoader();
+	if (!romData) {
+		setRomData(nullptr);
+		return;
+	}
+
+	// Unload the current RomData object.
+	// NOTE: romDataChanged() will be emitted once loading is finished.
+	d->ui.lblIcon->stopAnimTimer();
+	d->ui.lblIcon->resetAnimFrame();
+	d->romData.reset();
+	d->hasCheckedAchievements = false;
+	d->initDisplayWidgets();
+	d->showLoading();
+
+	d->loader = new RomDataLoader(romData);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	connect(d->loader, &RomDataLoader::headerReady,
+		this, &RomDataView::loader_headerReady_slot);
+	connect(d->loader, &QThread::finished,
+		this, &RomDataView::loader_finished_slot);
+#else /* QT_VERSION < QT_VERSION_CHECK(5, 0, 0) */
+	connect(d->loader, SIGNAL(headerReady()),
+		this, SLOT(loader_headerReady_slot()));
+	connect(d->loader, SIGNAL(finished()),
+		this, SLOT(loader_finished_slot()));
+#endif /* QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) */
+	d->loader->start();
+}
+
+/** RomDataLoader slots **/
+
+/**
+ * RomDataLoader: The header row information is available.
+ */
+void RomDataView::loader_headerReady_slot(void)
+{
+	Q_D(RomDataView);
+	if (!d->loader || sender() != d->loader) {
+		// Signal from a cancelled loader.
+		return;
+	}
+
+	// NOTE: The header row information isn't modified after headerReady() is emitted.
+	d->setHeaderRow(d->loader->headerInfo());
+	if (isVisible()) {
+		d->ui.lblIcon->startAnimTimer();
+	}
+}
+
+/**
+ * RomDataLoader: The RomData object has been loaded.
+ */
+void RomDataView::loader_finished_slot(void)
+{
+	Q_D(RomDataView);
+	if (!d->loader || sender() != d->loader) {
+		// Signal from a cancelled loader.
+		return;
+	}
+
+	// The loader thread has exited, so the RomData object can be used now.
+	RomDataLoader *const loader = d->loader;
+	d->loader = nullptr;
+	loader->wait();
+	const RomDataPtr romData = loader->romData();
+	delete loader;
+
+	d->ui.lblIcon->stopAnimTimer();
+	d->romData = romData;
+	d->initDisplayWidgets();
+	if (d->btnOptions) {
+		// Update the "Options" menu for the new RomData object.
+		d->btnOptions->reinitMenu(romData.get());
+	}
+	if (isVisible()) {
+		d->ui.lblIcon->startAnimTimer();
+	}
+
+	// Check for "viewed" achievements on the next paint event.
+	update();
+
+	emit romDataChanged(romData);
+}
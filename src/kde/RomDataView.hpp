@@ -105,6 +105,17 @@ public slots:
 	 */
 	void setRomData(const LibRpBase::RomDataPtr &romData);
 
+	/**
+	 * Load a RomData object asynchronously.
+	 *
+	 * The RomData object's fields are loaded in a separate thread.
+	 * A placeholder is shown until the header row is available, and
+	 * romDataChanged() is emitted once the fields have been loaded.
+	 *
+	 * @param romData New RomData object
+	 */
+	void loadRomData(const LibRpBase::RomDataPtr &romData);
+
 signals:
 	/**
 	 * The RomData object has been changed.
@@ -118,4 +129,14 @@ private slots:
 	 * @param id Options ID.
 	 */
 	void btnOptions_triggered(int id);
+
+	/**
+	 * RomDataLoader: The header row information is available.
+	 */
+	void loader_headerReady_slot(void);
+
+	/**
+	 * RomDataLoader: The RomData object has been loaded.
+	 */
+	void loader_finished_slot(void);
 };
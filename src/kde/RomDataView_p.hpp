@@ -46,6 +46,9 @@ class OptionsMenuButton;
 // Data models
 class ListDataModel;
 
+// Asynchronous RomData loader
+#include "RomDataLoader.hpp"
+
 // Qt includes
 #include <QFormLayout>
 #include <QTreeView>
@@ -69,6 +72,10 @@ public:
 	// RomData object
 	LibRpBase::RomDataPtr romData;
 
+	// Asynchronous RomData loader.
+	// Set while the RomData object is being loaded in a separate thread.
+	RomDataLoader *loader;
+
 	// Tab contents
 	struct tab {
 		QVBoxLayout *vbox;
@@ -138,6 +145,23 @@ public:
 	 */
 	void initHeaderRow(void);
 
+	/**
+	 * Set the header row widgets.
+	 * @param info Header row information
+	 */
+	void setHeaderRow(const RomDataLoader::HeaderInfo &info);
+
+	/**
+	 * Show a placeholder in the header row while the RomData object is loading.
+	 */
+	void showLoading(void);
+
+	/**
+	 * Cancel the asynchronous RomData loader, if it's running.
+	 * The loader will be deleted once its thread exits.
+	 */
+	void cancelLoader(void);
+
 	/**
 	 * Clear a QLayout.
 	 * @param layout QLayout.
@@ -13,6 +13,7 @@
 
 // Other rom-properties libraries
 #include "librpbase/config/Config.hpp"
+#include "librpfile/CachedFile.hpp"
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
 using LibRpBase::Config;
@@ -173,7 +174,8 @@ IRpFilePtr openQUrl(const QUrl &url, bool isThumbnail)
 	} else {
 #ifdef HAVE_RPFILE_KIO
 		// Remote filename. Use RpFile_kio.
-		file = std::make_shared<RpFileKio>(url);
+		// Each read is a round-trip to the KIO worker, so wrap it in CachedFile.
+		file = std::make_shared<CachedFile>(std::make_shared<RpFileKio>(url));
 #else /* !HAVE_RPFILE_KIO */
 		// RpFile_kio isn't available...
 		return file;
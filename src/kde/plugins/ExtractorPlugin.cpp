@@ -31,6 +31,7 @@
 #include "librpbase/config/Config.hpp"
 #include "librpbase/RomMetaData.hpp"
 #include "librpfile/FileSystem.hpp"
+#include "libromdata/DetectionCache.hpp"
 #include "libromdata/RomDataFactory.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
@@ -179,9 +180,39 @@ QStringList ExtractorPlugin::mimetypes(void) const
 	return mimeTypes;
 }
 
-void ExtractorPlugin::extract_properties(KFileMetaData::ExtractionResult *result, RomData *romData)
+/**
+ * Add the KFileMetaData type for a RomData file type.
+ * @param result KFileMetaData::ExtractionResult
+ * @param fileType RomData file type
+ */
+static void add_file_type(KFileMetaData::ExtractionResult *result, RomData::FileType fileType)
+{
+	// NOTE: KFileMetaData has a limited set of file types as of v5.107.
+	static_assert(static_cast<size_t>(RomData::FileType::Max) == static_cast<size_t>(RomData::FileType::ConfigurationFile) + 1, "Update KFileMetaData file types!");
+	switch (fileType) {
+		default:
+			// No KFileMetaData::Type is applicable here.
+			break;
+
+		case RomData::FileType::IconFile:
+		case RomData::FileType::BannerFile:
+		case RomData::FileType::TextureFile:
+			result->addType(KFileMetaData::Type::Image);
+			break;
+
+		case RomData::FileType::ContainerFile:
+		case RomData::FileType::Bundle:
+			result->addType(KFileMetaData::Type::Archive);
+			break;
+
+		case RomData::FileType::AudioFile:
+			result->addType(KFileMetaData::Type::Audio);
+			break;
+	}
+}
+
+void ExtractorPlugin::extract_properties(KFileMetaData::ExtractionResult *result, const RomMetaData *metaData)
 {
-	const RomMetaData *const metaData = romData->metaData();
 	if (!metaData || metaData->empty()) {
 		// No metadata properties.
 		return;
@@ -338,6 +369,26 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 		// Directory: Call RomDataFactory::create() with the filename.
 		romData = RomDataFactory::create(s_local_filename);
 	} else {
+#if KCOREADDONS_VERSION >= QT_VERSION_CHECK(5, 76, 0)
+		const bool needImages = !!(flags & ExtractionResult::ExtractImageData);
+#else /* KCOREADDONS_VERSION < QT_VERSION_CHECK(5, 76, 0) */
+		static constexpr bool needImages = false;
+#endif /* KCOREADDONS_VERSION >= QT_VERSION_CHECK(5, 76, 0) */
+		if (!needImages && !s_local_filename.empty()) {
+			// Local file, and images aren't needed: Check the detection cache.
+			// If the file hasn't changed, this only requires a stat().
+			const DetectionCache::EntryPtr entry = DetectionCache::lookup(s_local_filename, attrs);
+			if (entry) {
+				if (entry->isSupported()) {
+					add_file_type(result, entry->fileType);
+					if (flags & ExtractionResult::ExtractMetaData) {
+						extract_properties(result, entry->metaData.get());
+					}
+				}
+				return;
+			}
+		}
+
 		// File: Open the file and call RomDataFactory::create() with the opened file.
 		IRpFilePtr file(openQUrl(localUrl, false));
 		if (!file) {
@@ -355,32 +406,11 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 	}
 
 	// File type
-	// NOTE: KFileMetaData has a limited set of file types as of v5.107.
-	static_assert(static_cast<size_t>(RomData::FileType::Max) == static_cast<size_t>(RomData::FileType::ConfigurationFile) + 1, "Update KFileMetaData file types!");
-	switch (romData->fileType()) {
-		default:
-			// No KFileMetaData::Type is applicable here.
-			break;
-
-		case RomData::FileType::IconFile:
-		case RomData::FileType::BannerFile:
-		case RomData::FileType::TextureFile:
-			result->addType(KFileMetaData::Type::Image);
-			break;
-
-		case RomData::FileType::ContainerFile:
-		case RomData::FileType::Bundle:
-			result->addType(KFileMetaData::Type::Archive);
-			break;
-
-		case RomData::FileType::AudioFile:
-			result->addType(KFileMetaData::Type::Audio);
-			break;
-	}
+	add_file_type(result, romData->fileType());
 
 	// Metadata properties
 	if (flags & ExtractionResult::ExtractMetaData) {
-		extract_properties(result, romData.get());
+		extract_properties(result, romData->metaData());
 	}
 
 #if KCOREADDONS_VERSION >= QT_VERSION_CHECK(5, 76, 0)
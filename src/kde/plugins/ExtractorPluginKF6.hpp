@@ -23,6 +23,7 @@
 // librpbase
 namespace LibRpBase {
 	class RomData;
+	class RomMetaData;
 }
 
 namespace RomPropertiesKDE {
@@ -45,7 +46,7 @@ public:
 	QStringList mimetypes(void) const final;
 
 private:
-	static void extract_properties(KFileMetaData::ExtractionResult *result, LibRpBase::RomData *romData);
+	static void extract_properties(KFileMetaData::ExtractionResult *result, const LibRpBase::RomMetaData *metaData);
 	static void extract_image(KFileMetaData::ExtractionResult *result, LibRpBase::RomData *romData);
 public:
 	void extract(KFileMetaData::ExtractionResult *result) final;
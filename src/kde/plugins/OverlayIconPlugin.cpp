@@ -25,10 +25,12 @@
 #  error Qt is too old!
 #endif
 
+#include "RpQt.hpp"
 #include "RpQUrl.hpp"
 
 // Other rom-properties libraries
 #include "librpbase/config/Config.hpp"
+#include "libromdata/DetectionCache.hpp"
 #include "libromdata/RomDataFactory.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
@@ -48,7 +50,7 @@ OverlayIconPlugin::OverlayIconPlugin(QObject *parent)
 
 QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 {
-	// TODO: Check for slow devices and/or cache this?
+	// TODO: Check for slow devices?
 	QStringList sl;
 
 	const Config *const config = Config::instance();
@@ -57,6 +59,22 @@ QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 		return sl;
 	}
 
+	// If this is a local file, check the detection cache first.
+	// This only requires a stat() if the file hasn't changed.
+	const QUrl localUrl = localizeQUrl(item);
+	if (localUrl.isLocalFile()) {
+		const string s_local_filename = Q2U8_StdString(localUrl.toLocalFile());
+		const DetectionCache::EntryPtr entry = DetectionCache::lookup(s_local_filename, RomDataFactory::RDA_HAS_DPOVERLAY);
+		if (entry) {
+			// If the ROM image has "dangerous" permissions,
+			// return the "security-medium" overlay icon.
+			if (entry->hasDangerousPermissions) {
+				sl += QLatin1String("security-medium");
+			}
+			return sl;
+		}
+	}
+
 	// Attempt to open the ROM file.
 	const IRpFilePtr file(openQUrl(item, true));
 	if (!file) {
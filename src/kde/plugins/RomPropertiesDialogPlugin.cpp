@@ -81,13 +81,13 @@ RomDataView *RomPropertiesDialogPlugin::createRomDataView(const KFileItem &fileI
 	}
 
 	// ROM is supported. Show the properties.
-	RomDataView *const romDataView = new RomDataView(romData, props);
+	// NOTE: The fields are loaded asynchronously, since this might
+	// take a while for e.g. large disc images on network filesystems.
+	// RomDataView will close the underlying file handle once the
+	// RomData has been loaded.
+	RomDataView *const romDataView = new RomDataView(props);
 	romDataView->setObjectName(QLatin1String("romDataView"));
-
-	// Make sure the underlying file handle is closed,
-	// since we don't need it once the RomData has been
-	// loaded by RomDataView.
-	romData->close();
+	romDataView->loadRomData(romData);
 
 	return romDataView;
 }
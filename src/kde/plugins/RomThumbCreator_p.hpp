@@ -89,6 +89,16 @@ public:
 	 */
 	QImage rescaleImgClass(const QImage &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const final;
 
+	/**
+	 * Should internal images be rescaled using rp_image::scaled()?
+	 * @return True to use rp_image::scaled(); false to use rescaleImgClass().
+	 */
+	bool useNativeScaler(void) const final
+	{
+		// Use rp_image::scaled() so thumbnails match the other frontends.
+		return true;
+	}
+
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object.
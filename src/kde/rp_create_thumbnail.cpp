@@ -140,6 +140,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail2(const char *source_file, const c
 		// Could not open the PNG writer.
 		return RPCT_ERROR_OUTPUT_FILE_FAILED;
 	}
+	pngWriter.setEncodeProfile(Config::instance()->pngEncodeProfile());
 
 	const bool doXDG = !(flags & RPCT_FLAG_NO_XDG_THUMBNAIL_METADATA);
 	kv.reserve(doXDG ? 5 : 1);
@@ -125,6 +125,7 @@ public:
 	 * @param keyIdx Encryption key index.
 	 * @return Encryption key name (in ASCII), or nullptr on error.
 	 */
+	RP_LIBROMDATA_PUBLIC
 	static const char* encryptionKeyName_static(int keyIdx);
 
 	/**
@@ -132,6 +133,7 @@ public:
 	 * @param keyIdx Encryption key index.
 	 * @return Verification data. (16 bytes)
 	 */
+	RP_LIBROMDATA_PUBLIC
 	static const uint8_t* encryptionVerifyData_static(int keyIdx);
 #endif /* ENABLE_DECRYPTION */
 
@@ -0,0 +1,1012 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * DetectionCache.cpp: Persistent RomData detection result cache.          *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "libromdata/config.libromdata.h"
+
+#include "DetectionCache.hpp"
+#include "RomDataFactory.hpp"
+
+// Other rom-properties libraries
+#include "libcachecommon/CacheDir.hpp"
+#include "librpbase/config/AboutTabText.hpp"
+#include "librpfile/FileSystem.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// C includes
+#include <fcntl.h>	// open()
+#include <sys/file.h>	// flock()
+#include <sys/mman.h>	// mmap(), munmap()
+#include <sys/stat.h>	// stat(), fstat()
+#include <unistd.h>	// close(), write(), unlink()
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <ctime>
+
+// C++ STL classes
+#include <mutex>
+#include <unordered_map>
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData { namespace DetectionCache {
+
+Entry::Entry()
+	: fileType(RomData::FileType::Unknown)
+	, hasDangerousPermissions(false)
+{}
+
+Entry::~Entry() = default;
+
+/** On-disk index format **/
+
+// The index is a single file that is memory-mapped by readers.
+// Writers never modify an existing index; instead, a new index is
+// written to a temporary file and renamed over the old one, so
+// readers never need to take a lock.
+//
+// Layout:
+// - DetectCacheHeader
+// - Hash buckets: uint32_t[bucket_count] (entry index + 1; 0 == empty)
+// - DetectCacheEntry[entry_count]
+// - Data area: uint8_t[data_size]
+//
+// All values are in host byte order, since the index is
+// never shared between systems.
+//
+// The header also has a build ID, which is a hash of the program
+// version and git version. If it doesn't match the running program,
+// the index is discarded, since a newer version may detect files
+// differently. (e.g. files that were previously unsupported)
+
+static constexpr char DETECTCACHE_MAGIC[8] = {'R','P','D','C','I','D','X','\0'};
+static constexpr uint32_t DETECTCACHE_VERSION = 2;
+static constexpr uint32_t DETECTCACHE_BYTEORDER = 0x01020304U;
+
+struct DetectCacheHeader {
+	char magic[8];		// DETECTCACHE_MAGIC
+	uint32_t version;	// DETECTCACHE_VERSION
+	uint32_t byteorder;	// DETECTCACHE_BYTEORDER
+	uint32_t entry_count;	// Number of entries
+	uint32_t bucket_count;	// Number of hash buckets (power of two)
+	uint32_t data_size;	// Size of the data area
+	uint32_t reserved;
+	uint64_t build_id;	// getBuildId()
+};
+ASSERT_STRUCT(DetectCacheHeader, 40);
+
+/**
+ * Get the build ID for the index header.
+ * This is a 64-bit FNV-1a hash of the program version,
+ * git version, and git description.
+ * @return Build ID
+ */
+static uint64_t getBuildId(void)
+{
+	static const uint64_t build_id = []() -> uint64_t {
+		uint64_t h = 0xCBF29CE484222325ULL;
+		for (const AboutTabText::ProgramInfoStringID id : {
+			AboutTabText::ProgramInfoStringID::ProgramVersion,
+			AboutTabText::ProgramInfoStringID::GitVersion,
+			AboutTabText::ProgramInfoStringID::GitDescription})
+		{
+			const char *str = AboutTabText::getProgramInfoString(id);
+			if (!str) {
+				str = "";
+			}
+			// Include the NULL terminator as a separator.
+			do {
+				h ^= static_cast<uint8_t>(*str);
+				h *= 0x100000001B3ULL;
+			} while (*str++ != '\0');
+		}
+		return h;
+	}();
+	return build_id;
+}
+
+// Entry flags
+enum DetectCacheEntryFlags : uint8_t {
+	DCEF_DANGEROUS_PERMISSIONS	= (1U << 0),
+};
+
+struct DetectCacheEntry {
+	uint64_t dev;		// st_dev
+	uint64_t ino;		// st_ino
+	uint64_t size;		// st_size
+	int64_t mtime_ns;	// st_mtim, in nanoseconds
+	uint32_t attrs;		// RomDataAttr bitfield passed to RomDataFactory::create()
+	uint32_t data_offset;	// Offset of the serialized results in the data area
+	uint32_t data_size;	// Size of the serialized results
+	uint8_t flags;		// DetectCacheEntryFlags
+	uint8_t fileType;	// RomData::FileType
+	uint16_t reserved;
+};
+ASSERT_STRUCT(DetectCacheEntry, 48);
+
+// Serialized results: (in the data area)
+// - uint8_t: Class name length (0 if not supported)
+// - char[]: Class name (not NULL-terminated)
+// - uint8_t: Metadata property count
+// - Metadata properties:
+//   - int8_t: Property
+//   - uint8_t: PropertyType
+//   - Value: Integer, UnsignedInteger: 4 bytes
+//            Timestamp, Double: 8 bytes
+//            String: uint16_t length, then the string (not NULL-terminated)
+
+// Index file limits
+static constexpr uint32_t MAX_ENTRIES = 65536;
+static constexpr uint32_t MAX_DATA_SIZE = 64U*1024*1024;
+static constexpr size_t MAX_RESULTS_SIZE = 32768;	// per file
+
+// Minimum number of pending results before the index is rewritten.
+// The actual threshold is a quarter of the current index size, so
+// rewriting the index has amortized linear cost.
+static constexpr size_t MIN_FLUSH_THRESHOLD = 64;
+// Maximum time pending results are kept in memory, in seconds.
+static constexpr time_t MAX_FLUSH_INTERVAL = 5;
+
+/** In-memory state **/
+
+/**
+ * File identity.
+ * If any of these change, the cached results are discarded.
+ */
+struct FileKey {
+	uint64_t dev;
+	uint64_t ino;
+	uint64_t size;
+	int64_t mtime_ns;
+	uint32_t attrs;
+
+	inline bool operator==(const FileKey &other) const
+	{
+		return dev == other.dev && ino == other.ino && size == other.size &&
+		       mtime_ns == other.mtime_ns && attrs == other.attrs;
+	}
+
+	inline bool operator==(const DetectCacheEntry &entry) const
+	{
+		return dev == entry.dev && ino == entry.ino && size == entry.size &&
+		       mtime_ns == entry.mtime_ns && attrs == entry.attrs;
+	}
+
+	/**
+	 * Hash function.
+	 * NOTE: This is used for the on-disk hash table,
+	 * so it must not depend on the platform.
+	 * @return Hash value
+	 */
+	uint64_t hash(void) const
+	{
+		// MurmurHash3 64-bit finalizer
+		auto mix64 = [](uint64_t x) -> uint64_t {
+			x ^= x >> 33;
+			x *= 0xFF51AFD7ED558CCDULL;
+			x ^= x >> 33;
+			x *= 0xC4CEB9FE1A85EC53ULL;
+			x ^= x >> 33;
+			return x;
+		};
+		uint64_t h = mix64(static_cast<uint64_t>(mtime_ns) ^ attrs);
+		h = mix64(h ^ size);
+		h = mix64(h ^ dev);
+		return mix64(h ^ ino);
+	}
+};
+
+struct FileKeyHash {
+	inline size_t operator()(const FileKey &key) const
+	{
+		return static_cast<size_t>(key.hash());
+	}
+};
+
+/**
+ * Detection results that haven't been written to the index yet.
+ */
+struct PendingResults {
+	uint8_t flags;		// DetectCacheEntryFlags
+	uint8_t fileType;	// RomData::FileType
+	string data;		// Serialized results
+};
+
+/**
+ * Memory-mapped index file.
+ */
+struct MappedIndex {
+	const uint8_t *map;
+	size_t size;
+
+	const uint32_t *buckets;
+	const DetectCacheEntry *entries;
+	const uint8_t *data;
+	uint32_t bucket_count;
+	uint32_t entry_count;
+	uint32_t data_size;
+
+	// Identity of the mapped index file
+	dev_t dev;
+	ino_t ino;
+	int64_t mtime_ns;
+};
+
+// Mutex protecting the in-memory state.
+// NOTE: Other processes never block readers; the index file lock
+// is only used to serialize writers.
+static std::mutex mtx;
+
+// Mutex serializing flushes within this process.
+// The index is written with only this mutex locked, so lookups
+// aren't blocked while a flush is in progress.
+// NOTE: If both are needed, lock flushMtx before mtx.
+static std::mutex flushMtx;
+
+static string indexFilename;		// Index filename
+static bool indexFilenameInit = false;	// Has indexFilename been initialized?
+static MappedIndex idx;			// Current index mapping
+typedef unordered_map<FileKey, PendingResults, FileKeyHash> PendingMap;
+static PendingMap pending;
+// Results being written by the current flush.
+// Modified only by the thread holding flushMtx, with mtx locked.
+static PendingMap flushing;
+static time_t lastFlushTime = 0;	// Time of the last flush
+static Stats cacheStats;
+
+/**
+ * Get a file's modification time in nanoseconds.
+ * @param sb struct stat
+ * @return Modification time, in nanoseconds
+ */
+static inline int64_t mtime_ns(const struct stat &sb)
+{
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+	return (static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000LL) + sb.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+	return (static_cast<int64_t>(sb.st_mtimespec.tv_sec) * 1000000000LL) + sb.st_mtimespec.tv_nsec;
+#else
+	return static_cast<int64_t>(sb.st_mtime) * 1000000000LL;
+#endif
+}
+
+/**
+ * Initialize the index filename, if it hasn't been initialized yet.
+ * Must be called with mtx locked.
+ * @return True if the cache is usable; false if not.
+ */
+static bool initIndexFilename(void)
+{
+	if (!indexFilenameInit) {
+		const string &cacheDir = LibCacheCommon::getCacheDirectory();
+		if (!cacheDir.empty()) {
+			indexFilename = cacheDir;
+			indexFilename += "/detection.idx";
+		} else {
+			indexFilename.clear();
+		}
+		indexFilenameInit = true;
+		lastFlushTime = time(nullptr);
+	}
+	return !indexFilename.empty();
+}
+
+/**
+ * Map an index file.
+ * @param filename	[in] Index filename
+ * @param mi		[out] Mapped index
+ * @return True on success; false if the index file is missing or invalid.
+ */
+static bool mapIndexFile(const string &filename, MappedIndex &mi)
+{
+	struct stat sb;
+	const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	// NOTE: The index may have been replaced since the caller
+	// checked it, so get the identity from the opened file.
+	if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode) ||
+	    sb.st_size < static_cast<off_t>(sizeof(DetectCacheHeader)))
+	{
+		close(fd);
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(sb.st_size);
+	void *const p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) {
+		return false;
+	}
+
+	// Validate the header.
+	const uint8_t *const map = static_cast<const uint8_t*>(p);
+	const DetectCacheHeader *const header = reinterpret_cast<const DetectCacheHeader*>(map);
+	const uint64_t expected_size = sizeof(DetectCacheHeader) +
+		(static_cast<uint64_t>(header->bucket_count) * sizeof(uint32_t)) +
+		(static_cast<uint64_t>(header->entry_count) * sizeof(DetectCacheEntry)) +
+		header->data_size;
+	if (memcmp(header->magic, DETECTCACHE_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->version != DETECTCACHE_VERSION ||
+	    header->byteorder != DETECTCACHE_BYTEORDER ||
+	    header->build_id != getBuildId() ||
+	    header->bucket_count == 0 ||
+	    (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+	    header->entry_count >= header->bucket_count ||
+	    expected_size != size)
+	{
+		// Invalid index file.
+		munmap(p, size);
+		return false;
+	}
+
+	mi.map = map;
+	mi.size = size;
+	mi.buckets = reinterpret_cast<const uint32_t*>(map + sizeof(DetectCacheHeader));
+	mi.entries = reinterpret_cast<const DetectCacheEntry*>(mi.buckets + header->bucket_count);
+	mi.data = reinterpret_cast<const uint8_t*>(mi.entries + header->entry_count);
+	mi.bucket_count = header->bucket_count;
+	mi.entry_count = header->entry_count;
+	mi.data_size = header->data_size;
+	mi.dev = sb.st_dev;
+	mi.ino = sb.st_ino;
+	mi.mtime_ns = mtime_ns(sb);
+	return true;
+}
+
+/**
+ * Unmap an index file.
+ * @param mi Mapped index
+ */
+static void unmapIndexFile(MappedIndex &mi)
+{
+	if (mi.map) {
+		munmap(const_cast<uint8_t*>(mi.map), mi.size);
+	}
+	mi = MappedIndex();
+}
+
+/**
+ * Unmap the index file.
+ * Must be called with mtx locked.
+ */
+static void unmapIndex(void)
+{
+	unmapIndexFile(idx);
+}
+
+/**
+ * Map the index file if it has changed since it was last mapped.
+ * Must be called with mtx locked.
+ */
+static void refreshIndex(void)
+{
+	struct stat sb;
+	if (stat(indexFilename.c_str(), &sb) != 0) {
+		// No index file.
+		unmapIndex();
+		return;
+	}
+	if (idx.map && sb.st_dev == idx.dev && sb.st_ino == idx.ino && mtime_ns(sb) == idx.mtime_ns) {
+		// Index file hasn't changed.
+		return;
+	}
+	unmapIndex();
+	mapIndexFile(indexFilename, idx);
+}
+
+/**
+ * Find an entry in the mapped index.
+ * Must be called with mtx locked.
+ * @param key File key
+ * @return Entry, or nullptr if not found.
+ */
+static const DetectCacheEntry *findInIndex(const FileKey &key)
+{
+	if (!idx.map || idx.entry_count == 0) {
+		return nullptr;
+	}
+
+	// Linear probing. entry_count < bucket_count,
+	// so there's always at least one empty bucket.
+	const uint32_t mask = idx.bucket_count - 1;
+	uint32_t b = static_cast<uint32_t>(key.hash()) & mask;
+	for (uint32_t i = 0; i < idx.bucket_count; i++, b = (b + 1) & mask) {
+		const uint32_t n = idx.buckets[b];
+		if (n == 0 || n > idx.entry_count) {
+			// Empty bucket (or invalid entry index).
+			break;
+		}
+
+		const DetectCacheEntry *const entry = &idx.entries[n - 1];
+		if (key == *entry) {
+			// Make sure the data is in bounds.
+			if (static_cast<uint64_t>(entry->data_offset) + entry->data_size > idx.data_size) {
+				break;
+			}
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Serialize detection results.
+ * @param out		[out] Serialized results
+ * @param className	[in] RomData subclass name, or nullptr if not supported
+ * @param metaData	[in,opt] Metadata properties
+ * @return True on success; false if the results are too large.
+ */
+static bool serializeResults(string &out, const char *className, const RomMetaData *metaData)
+{
+	out.clear();
+
+	const size_t classNameLen = (className ? strlen(className) : 0);
+	if (classNameLen > 255) {
+		return false;
+	}
+	out += static_cast<char>(classNameLen);
+	out.append(className ? className : "", classNameLen);
+
+	// Reserve space for the property count.
+	const size_t countPos = out.size();
+	out += '\0';
+	if (!metaData) {
+		return true;
+	}
+
+	unsigned int count = 0;
+	for (const RomMetaData::MetaData &prop : *metaData) {
+		if (count >= 255) {
+			break;
+		}
+
+		switch (prop.type) {
+			case PropertyType::Integer:
+			case PropertyType::UnsignedInteger: {
+				// NOTE: ivalue and uvalue share storage.
+				out += static_cast<char>(prop.name);
+				out += static_cast<char>(prop.type);
+				out.append(reinterpret_cast<const char*>(&prop.data.uvalue), sizeof(prop.data.uvalue));
+				break;
+			}
+			case PropertyType::Timestamp: {
+				const int64_t timestamp = static_cast<int64_t>(prop.data.timestamp);
+				out += static_cast<char>(prop.name);
+				out += static_cast<char>(prop.type);
+				out.append(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+				break;
+			}
+			case PropertyType::Double: {
+				out += static_cast<char>(prop.name);
+				out += static_cast<char>(prop.type);
+				out.append(reinterpret_cast<const char*>(&prop.data.dvalue), sizeof(prop.data.dvalue));
+				break;
+			}
+			case PropertyType::String: {
+				const size_t len = (prop.data.str ? strlen(prop.data.str) : 0);
+				if (len > 65535) {
+					return false;
+				}
+				const uint16_t len16 = static_cast<uint16_t>(len);
+				out += static_cast<char>(prop.name);
+				out += static_cast<char>(prop.type);
+				out.append(reinterpret_cast<const char*>(&len16), sizeof(len16));
+				out.append(prop.data.str ? prop.data.str : "", len);
+				break;
+			}
+			default:
+				// Unsupported property type.
+				assert(!"Unsupported RomMetaData PropertyType.");
+				continue;
+		}
+		count++;
+	}
+
+	out[countPos] = static_cast<char>(count);
+	return (out.size() <= MAX_RESULTS_SIZE);
+}
+
+/**
+ * Deserialize detection results.
+ * @param p		[in] Serialized results
+ * @param size		[in] Size of p
+ * @param flags		[in] DetectCacheEntryFlags
+ * @param fileType	[in] RomData::FileType
+ * @return Entry, or nullptr if the serialized results are invalid.
+ */
+static EntryPtr deserializeResults(const uint8_t *p, size_t size, uint8_t flags, uint8_t fileType)
+{
+	const uint8_t *const p_end = p + size;
+	if (size < 2) {
+		return nullptr;
+	}
+
+	Entry *const entry = new Entry();
+	EntryPtr entryPtr(entry);
+	entry->hasDangerousPermissions = !!(flags & DCEF_DANGEROUS_PERMISSIONS);
+	entry->fileType = (fileType < static_cast<uint8_t>(RomData::FileType::Max))
+		? static_cast<RomData::FileType>(fileType)
+		: RomData::FileType::Unknown;
+
+	const size_t classNameLen = *p++;
+	if (classNameLen + 1 > static_cast<size_t>(p_end - p)) {
+		return nullptr;
+	}
+	entry->className.assign(reinterpret_cast<const char*>(p), classNameLen);
+	p += classNameLen;
+
+	const unsigned int count = *p++;
+	if (count == 0) {
+		// No metadata properties.
+		return entryPtr;
+	}
+
+	RomMetaData *const metaData = new RomMetaData();
+	entry->metaData.reset(metaData);
+	metaData->reserve(static_cast<int>(count));
+	for (unsigned int i = 0; i < count; i++) {
+		if (p_end - p < 2) {
+			return nullptr;
+		}
+		const Property name = static_cast<Property>(static_cast<int8_t>(p[0]));
+		const PropertyType type = static_cast<PropertyType>(p[1]);
+		p += 2;
+
+		switch (type) {
+			case PropertyType::Integer:
+			case PropertyType::UnsignedInteger: {
+				uint32_t value;
+				if (p_end - p < static_cast<ptrdiff_t>(sizeof(value))) {
+					return nullptr;
+				}
+				memcpy(&value, p, sizeof(value));
+				p += sizeof(value);
+				if (type == PropertyType::Integer) {
+					metaData->addMetaData_integer(name, static_cast<int>(value));
+				} else {
+					metaData->addMetaData_uint(name, value);
+				}
+				break;
+			}
+			case PropertyType::Timestamp: {
+				int64_t timestamp;
+				if (p_end - p < static_cast<ptrdiff_t>(sizeof(timestamp))) {
+					return nullptr;
+				}
+				memcpy(&timestamp, p, sizeof(timestamp));
+				p += sizeof(timestamp);
+				metaData->addMetaData_timestamp(name, static_cast<time_t>(timestamp));
+				break;
+			}
+			case PropertyType::Double: {
+				double dvalue;
+				if (p_end - p < static_cast<ptrdiff_t>(sizeof(dvalue))) {
+					return nullptr;
+				}
+				memcpy(&dvalue, p, sizeof(dvalue));
+				p += sizeof(dvalue);
+				metaData->addMetaData_double(name, dvalue);
+				break;
+			}
+			case PropertyType::String: {
+				uint16_t len16;
+				if (p_end - p < static_cast<ptrdiff_t>(sizeof(len16))) {
+					return nullptr;
+				}
+				memcpy(&len16, p, sizeof(len16));
+				p += sizeof(len16);
+				if (p_end - p < static_cast<ptrdiff_t>(len16)) {
+					return nullptr;
+				}
+				metaData->addMetaData_string(name, string(reinterpret_cast<const char*>(p), len16));
+				p += len16;
+				break;
+			}
+			default:
+				// Invalid property type.
+				return nullptr;
+		}
+	}
+
+	return entryPtr;
+}
+
+/**
+ * Write a buffer to a file descriptor, handling partial writes.
+ * @param fd File descriptor
+ * @param buf Buffer
+ * @param size Size of buf
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int writeAll(int fd, const void *buf, size_t size)
+{
+	const uint8_t *p = static_cast<const uint8_t*>(buf);
+	while (size > 0) {
+		const ssize_t ret = write(fd, p, size);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += ret;
+		size -= static_cast<size_t>(ret);
+	}
+	return 0;
+}
+
+/**
+ * Merge detection results into the on-disk index.
+ * Must be called with flushMtx locked and mtx *unlocked*.
+ * @param indexFilename	[in] Index filename
+ * @param toWrite	[in] Detection results to write
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int writeIndex(const string &indexFilename, const PendingMap &toWrite)
+{
+	if (indexFilename.empty()) {
+		return -ENOENT;
+	}
+
+	// Make sure the cache directory exists.
+	int ret = FileSystem::rmkdir(indexFilename);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Lock out other writers while merging.
+	const string lockFilename = indexFilename + ".lock";
+	const int lockfd = open(lockFilename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (lockfd < 0) {
+		return -errno;
+	}
+	if (flock(lockfd, LOCK_EX) != 0) {
+		ret = -errno;
+		close(lockfd);
+		return ret;
+	}
+
+	// Merge with the latest version of the index.
+	// Newer results are written first; if the index is full,
+	// the oldest results are dropped.
+	// NOTE: The index is mapped separately here, since the
+	// shared mapping is protected by mtx.
+	MappedIndex cur = MappedIndex();
+	mapIndexFile(indexFilename, cur);
+	vector<DetectCacheEntry> entries;
+	string data;
+	entries.reserve(toWrite.size() + cur.entry_count);
+
+	for (const auto &p : toWrite) {
+		if (entries.size() >= MAX_ENTRIES)
+			break;
+		if (data.size() + p.second.data.size() > MAX_DATA_SIZE)
+			continue;
+
+		DetectCacheEntry entry;
+		entry.dev = p.first.dev;
+		entry.ino = p.first.ino;
+		entry.size = p.first.size;
+		entry.mtime_ns = p.first.mtime_ns;
+		entry.attrs = p.first.attrs;
+		entry.data_offset = static_cast<uint32_t>(data.size());
+		entry.data_size = static_cast<uint32_t>(p.second.data.size());
+		entry.flags = p.second.flags;
+		entry.fileType = p.second.fileType;
+		entry.reserved = 0;
+		entries.push_back(entry);
+		data += p.second.data;
+	}
+
+	for (uint32_t i = 0; i < cur.entry_count && entries.size() < MAX_ENTRIES; i++) {
+		DetectCacheEntry entry = cur.entries[i];
+		if (static_cast<uint64_t>(entry.data_offset) + entry.data_size > cur.data_size ||
+		    data.size() + entry.data_size > MAX_DATA_SIZE)
+		{
+			continue;
+		}
+
+		const FileKey key = {entry.dev, entry.ino, entry.size, entry.mtime_ns, entry.attrs};
+		if (toWrite.find(key) != toWrite.end()) {
+			// Superseded by a pending result.
+			continue;
+		}
+
+		const uint8_t *const pData = cur.data + entry.data_offset;
+		entry.data_offset = static_cast<uint32_t>(data.size());
+		data.append(reinterpret_cast<const char*>(pData), entry.data_size);
+		entries.push_back(entry);
+	}
+	unmapIndexFile(cur);
+
+	// Build the hash table. (load factor <= 0.5)
+	uint32_t bucket_count = 16;
+	while (bucket_count < entries.size() * 2) {
+		bucket_count <<= 1;
+	}
+	vector<uint32_t> buckets(bucket_count);
+	const uint32_t mask = bucket_count - 1;
+	for (size_t i = 0; i < entries.size(); i++) {
+		const DetectCacheEntry &entry = entries[i];
+		const FileKey key = {entry.dev, entry.ino, entry.size, entry.mtime_ns, entry.attrs};
+		uint32_t b = static_cast<uint32_t>(key.hash()) & mask;
+		while (buckets[b] != 0) {
+			b = (b + 1) & mask;
+		}
+		buckets[b] = static_cast<uint32_t>(i + 1);
+	}
+
+	DetectCacheHeader header;
+	memcpy(header.magic, DETECTCACHE_MAGIC, sizeof(header.magic));
+	header.version = DETECTCACHE_VERSION;
+	header.byteorder = DETECTCACHE_BYTEORDER;
+	header.entry_count = static_cast<uint32_t>(entries.size());
+	header.bucket_count = bucket_count;
+	header.data_size = static_cast<uint32_t>(data.size());
+	header.reserved = 0;
+	header.build_id = getBuildId();
+
+	// Write the new index to a temporary file, then rename it over the old index.
+	string tmpFilename = indexFilename + ".XXXXXX";
+	const int fd = mkstemp(&tmpFilename[0]);
+	if (fd < 0) {
+		ret = -errno;
+		close(lockfd);
+		return ret;
+	}
+	ret = writeAll(fd, &header, sizeof(header));
+	if (ret == 0) {
+		ret = writeAll(fd, buckets.data(), buckets.size() * sizeof(uint32_t));
+	}
+	if (ret == 0) {
+		ret = writeAll(fd, entries.data(), entries.size() * sizeof(DetectCacheEntry));
+	}
+	if (ret == 0) {
+		ret = writeAll(fd, data.data(), data.size());
+	}
+	if (close(fd) != 0 && ret == 0) {
+		ret = -errno;
+	}
+	if (ret == 0 && rename(tmpFilename.c_str(), indexFilename.c_str()) != 0) {
+		ret = -errno;
+	}
+	if (ret != 0) {
+		unlink(tmpFilename.c_str());
+	}
+	close(lockfd);
+	return ret;
+}
+
+/**
+ * Write pending detection results to the on-disk index.
+ * Must be called with flushMtx locked and mtx *unlocked*.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int flush_int(void)
+{
+	string filename;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (pending.empty()) {
+			return 0;
+		}
+
+		// Pending results are discarded even if the index can't be written,
+		// since they can be regenerated. Until then, lookup() can still
+		// find them in flushing.
+		lastFlushTime = time(nullptr);
+		assert(flushing.empty());
+		flushing.swap(pending);
+		filename = indexFilename;
+	}
+
+	// NOTE: flushing is only modified by the thread holding flushMtx,
+	// so it can be read here without locking mtx.
+	const int ret = writeIndex(filename, flushing);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	flushing.clear();
+	if (ret == 0) {
+		cacheStats.flushes++;
+		refreshIndex();
+	}
+	return ret;
+}
+
+/**
+ * Write pending results when the process exits.
+ * NOTE: Declared after the state variables so it's destroyed first.
+ */
+static struct FlushOnExit {
+	~FlushOnExit()
+	{
+		std::lock_guard<std::mutex> flushLock(flushMtx);
+		flush_int();
+		std::lock_guard<std::mutex> lock(mtx);
+		unmapIndex();
+	}
+} flushOnExit;
+
+/**
+ * Look up the detection results for a local file.
+ *
+ * If the file isn't in the cache, RomDataFactory::create() will be
+ * called and the results will be added to the cache. Otherwise,
+ * only a single stat() is needed.
+ *
+ * The cache is only used for regular files. If nullptr is returned,
+ * the caller should fall back to RomDataFactory::create().
+ *
+ * @param filename Local filename (UTF-8)
+ * @param attrs RomDataAttr bitfield (passed to RomDataFactory::create())
+ * @return Detection results, or nullptr if the cache can't be used for this file.
+ */
+EntryPtr lookup(const char *filename, unsigned int attrs)
+{
+	assert(filename != nullptr);
+	assert(filename[0] != '\0');
+	if (!filename || filename[0] == '\0') {
+		return nullptr;
+	}
+
+	struct stat sb;
+	if (stat(filename, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		// Only regular files are cached.
+		return nullptr;
+	}
+	const FileKey key = {
+		static_cast<uint64_t>(sb.st_dev),
+		static_cast<uint64_t>(sb.st_ino),
+		static_cast<uint64_t>(sb.st_size),
+		mtime_ns(sb),
+		attrs
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!initIndexFilename()) {
+			// No cache directory.
+			return nullptr;
+		}
+
+		EntryPtr entry;
+		const PendingResults *pResults = nullptr;
+		auto iter = pending.find(key);
+		if (iter != pending.end()) {
+			pResults = &iter->second;
+		} else {
+			// Check the results that are currently being written.
+			iter = flushing.find(key);
+			if (iter != flushing.end()) {
+				pResults = &iter->second;
+			}
+		}
+		if (pResults) {
+			entry = deserializeResults(reinterpret_cast<const uint8_t*>(pResults->data.data()),
+				pResults->data.size(), pResults->flags, pResults->fileType);
+		} else {
+			const DetectCacheEntry *pEntry = findInIndex(key);
+			if (!pEntry) {
+				// Another process may have updated the index.
+				refreshIndex();
+				pEntry = findInIndex(key);
+			}
+			if (pEntry) {
+				entry = deserializeResults(idx.data + pEntry->data_offset,
+					pEntry->data_size, pEntry->flags, pEntry->fileType);
+			}
+		}
+
+		if (entry) {
+			cacheStats.hits++;
+			return entry;
+		}
+	}
+
+	// Not cached. Detect the file.
+	const RomDataPtr romData = RomDataFactory::create(filename, attrs);
+
+	Entry *const entry = new Entry();
+	EntryPtr entryPtr(entry);
+	PendingResults results;
+	results.flags = 0;
+	results.fileType = 0;
+	if (romData) {
+		entry->className = romData->className();
+		entry->fileType = romData->fileType();
+		entry->hasDangerousPermissions = romData->hasDangerousPermissions();
+		const RomMetaData *const metaData = romData->metaData();
+		if (metaData && !metaData->empty()) {
+			entry->metaData.reset(new RomMetaData());
+			entry->metaData->addMetaData_metaData(metaData);
+		}
+
+		if (entry->hasDangerousPermissions) {
+			results.flags |= DCEF_DANGEROUS_PERMISSIONS;
+		}
+		results.fileType = static_cast<uint8_t>(entry->fileType);
+	}
+	const bool canCache = serializeResults(results.data,
+		(romData ? entry->className.c_str() : nullptr), entry->metaData.get());
+
+	bool doFlush;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		cacheStats.misses++;
+		if (canCache) {
+			pending[key] = std::move(results);
+		}
+		doFlush = !pending.empty() &&
+			(pending.size() >= std::max(MIN_FLUSH_THRESHOLD, static_cast<size_t>(idx.entry_count / 4)) ||
+			 time(nullptr) - lastFlushTime >= MAX_FLUSH_INTERVAL);
+	}
+
+	if (doFlush) {
+		// If another thread is already flushing, leave the
+		// results pending for the next flush.
+		std::unique_lock<std::mutex> flushLock(flushMtx, std::try_to_lock);
+		if (flushLock.owns_lock()) {
+			flush_int();
+		}
+	}
+	return entryPtr;
+}
+
+/**
+ * Write pending detection results to the on-disk index.
+ *
+ * This is done automatically once enough results are pending,
+ * and when the process exits.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int flush(void)
+{
+	std::lock_guard<std::mutex> flushLock(flushMtx);
+	return flush_int();
+}
+
+/**
+ * Get the cache statistics for this process.
+ * @return Cache statistics
+ */
+Stats stats(void)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return cacheStats;
+}
+
+/**
+ * Set the index filename.
+ *
+ * Pending results are discarded, and the current index is unmapped.
+ * This is intended for test suites; normally, the index is stored
+ * in the rom-properties cache directory.
+ *
+ * @param filename Index filename, or nullptr to use the default.
+ */
+void setIndexFilename(const char *filename)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	pending.clear();
+	unmapIndex();
+	cacheStats = Stats();
+	if (filename) {
+		indexFilename = filename;
+		indexFilenameInit = true;
+		lastFlushTime = time(nullptr);
+	} else {
+		indexFilename.clear();
+		indexFilenameInit = false;
+	}
+}
+
+} } // namespace LibRomData::DetectionCache
@@ -0,0 +1,135 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * DetectionCache.hpp: Persistent RomData detection result cache.          *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+#include "dll-macros.h"
+
+// Other rom-properties libraries
+#include "librpbase/RomData.hpp"
+#include "librpbase/RomMetaData.hpp"
+
+// C++ includes
+#include <memory>
+#include <string>
+
+// NOTE: DetectionCache is not available on Windows.
+
+namespace LibRomData { namespace DetectionCache {
+
+/**
+ * Cached RomData detection results for a single file.
+ *
+ * Results are keyed by the file's identity (device, inode, size,
+ * and modification time) and the RomDataAttr bitfield passed to
+ * RomDataFactory::create(), so if the file changes, the cached
+ * results will no longer be used.
+ */
+struct Entry {
+	std::string className;	// RomData subclass name, or empty if not supported
+	LibRpBase::RomData::FileType fileType;
+	bool hasDangerousPermissions;
+
+	// Metadata properties (may be nullptr)
+	std::unique_ptr<LibRpBase::RomMetaData> metaData;
+
+	RP_LIBROMDATA_PUBLIC
+	Entry();
+	RP_LIBROMDATA_PUBLIC
+	~Entry();
+
+	RP_DISABLE_COPY(Entry)
+
+	/**
+	 * Is this file supported by any RomData subclass?
+	 * @return True if supported; false if not.
+	 */
+	inline bool isSupported(void) const
+	{
+		return !className.empty();
+	}
+};
+typedef std::shared_ptr<const Entry> EntryPtr;
+
+/**
+ * Look up the detection results for a local file.
+ *
+ * If the file isn't in the cache, RomDataFactory::create() will be
+ * called and the results will be added to the cache. Otherwise,
+ * only a single stat() is needed.
+ *
+ * The cache is only used for regular files. If nullptr is returned,
+ * the caller should fall back to RomDataFactory::create().
+ *
+ * @param filename Local filename (UTF-8)
+ * @param attrs RomDataAttr bitfield (passed to RomDataFactory::create())
+ * @return Detection results, or nullptr if the cache can't be used for this file.
+ */
+RP_LIBROMDATA_PUBLIC
+EntryPtr lookup(const char *filename, unsigned int attrs = 0);
+
+/**
+ * Look up the detection results for a local file.
+ *
+ * If the file isn't in the cache, RomDataFactory::create() will be
+ * called and the results will be added to the cache. Otherwise,
+ * only a single stat() is needed.
+ *
+ * The cache is only used for regular files. If nullptr is returned,
+ * the caller should fall back to RomDataFactory::create().
+ *
+ * @param filename Local filename (UTF-8)
+ * @param attrs RomDataAttr bitfield (passed to RomDataFactory::create())
+ * @return Detection results, or nullptr if the cache can't be used for this file.
+ */
+static inline EntryPtr lookup(const std::string &filename, unsigned int attrs = 0)
+{
+	return lookup(filename.c_str(), attrs);
+}
+
+/**
+ * Write pending detection results to the on-disk index.
+ *
+ * This is done automatically once enough results are pending,
+ * and when the process exits.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int flush(void);
+
+/**
+ * Cache statistics.
+ */
+struct Stats {
+	unsigned int hits;	// Results found in the cache
+	unsigned int misses;	// Results that required RomDataFactory::create()
+	unsigned int flushes;	// Number of times the index was rewritten
+};
+
+/**
+ * Get the cache statistics for this process.
+ * @return Cache statistics
+ */
+RP_LIBROMDATA_PUBLIC
+Stats stats(void);
+
+/**
+ * Set the index filename.
+ *
+ * Pending results are discarded, and the current index is unmapped.
+ * This is intended for test suites; normally, the index is stored
+ * in the rom-properties cache directory.
+ *
+ * @param filename Index filename, or nullptr to use the default.
+ */
+RP_LIBROMDATA_PUBLIC
+void setIndexFilename(const char *filename);
+
+} } // namespace LibRomData::DetectionCache
@@ -295,7 +295,7 @@ int NintendoDS::doRomOp_int(int id, RomOpParams *pParams)
 					return -EIO;
 				}
 
-				static constexpr size_t UNTRIM_BLOCK_SIZE = 64U * 1024U;
+				static constexpr size_t UNTRIM_BLOCK_SIZE = 1024U * 1024U;
 				typedef array<uint8_t, UNTRIM_BLOCK_SIZE> ff_block_t;
 				unique_ptr<ff_block_t> ff_block(new ff_block_t);
 				ff_block->fill(0xFF);
@@ -313,11 +313,18 @@ int NintendoDS::doRomOp_int(int id, RomOpParams *pParams)
 					return ret;
 				}
 
+				// Preallocate the untrimmed area, if supported.
+				// NOTE: Preallocated space reads as zero, and the
+				// padding is 0xFF, so it still has to be written.
+				// This is only done to allocate the space up front.
+				d->file->preallocate(pos, next_pow2 - pos);
+
 				// If we're not aligned to the untrim block size,
 				// write a partial block.
 				const unsigned int partial = static_cast<unsigned int>(pos % UNTRIM_BLOCK_SIZE);
 				if (partial != 0) {
-					const unsigned int toWrite = UNTRIM_BLOCK_SIZE - partial;
+					const unsigned int toWrite = static_cast<unsigned int>(
+						std::min(static_cast<off64_t>(UNTRIM_BLOCK_SIZE - partial), next_pow2 - pos));
 					size_t size = d->file->write(ff_block->data(), toWrite);
 					if (size != toWrite) {
 						// Write error.
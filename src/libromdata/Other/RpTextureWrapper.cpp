@@ -396,6 +396,61 @@ int RpTextureWrapper::loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image
 	return (pImage) ? 0 : -EIO;
 }
 
+/**
+ * Get the number of mipmap levels for IMG_INT_IMAGE.
+ * @return Number of mipmap levels, or 0 if the image doesn't have mipmaps.
+ */
+int RpTextureWrapper::mipmapCount(void) const
+{
+	RP_D(const RpTextureWrapper);
+	if (!d->texture) {
+		// No texture is loaded...
+		return 0;
+	}
+
+	// NOTE: FileFormat returns -1 if the format doesn't support mipmaps.
+	const int mipmapCount = d->texture->mipmapCount();
+	return (mipmapCount > 0) ? mipmapCount : 0;
+}
+
+/**
+ * Get the dimensions of a mipmap level for IMG_INT_IMAGE
+ * without decoding it.
+ * @param mipmapLevel	[in] Mipmap level
+ * @param pBuf		[out] Two-element array for [width, height]
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpTextureWrapper::getMipmapDimensions(int mipmapLevel, int pBuf[2]) const
+{
+	assert(mipmapLevel >= 0);
+	if (mipmapLevel < 0) {
+		// mipmapLevel is out of range.
+		return -EINVAL;
+	}
+
+	RP_D(const RpTextureWrapper);
+	if (!d->texture) {
+		// No texture is loaded...
+		return -ENOENT;
+	}
+	if (mipmapLevel > 0 && mipmapLevel >= d->texture->mipmapCount()) {
+		// Specified mipmap level is out of range.
+		return -ENOENT;
+	}
+
+	int dimensions[3];
+	int ret = d->texture->getDimensions(dimensions);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Each mipmap level is half the size of the previous level,
+	// with a minimum of 1 pixel.
+	pBuf[0] = std::max(dimensions[0] >> mipmapLevel, 1);
+	pBuf[1] = std::max(dimensions[1] >> mipmapLevel, 1);
+	return 0;
+}
+
 /** Pixel format **/
 
 /**
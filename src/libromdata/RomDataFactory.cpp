@@ -435,6 +435,54 @@ static const array<RomDataFns_main_tbl_t, 3> romDataFns_tbl = {{
 	{romDataFns_footer.data(), romDataFns_footer.size()},
 }};
 
+/** Magic number dispatch index **/
+
+// Bitmask of romDataFns_magic[] indexes.
+// NOTE: Bits are in table order, so checking them from LSB to MSB
+// preserves the detection priority of romDataFns_magic[].
+typedef uint64_t magic_mask_t;
+static_assert(romDataFns_magic_count <= sizeof(magic_mask_t) * 8,
+	"romDataFns_magic[] has too many entries for magic_mask_t");
+
+struct MagicIndex_t {
+	uint32_t address;	// Address of the magic number within the header
+	unordered_map<uint32_t, magic_mask_t> map;	// Magic number -> romDataFns_magic[] bitmask
+};
+static vector<MagicIndex_t> vec_magicIndex;
+static std::once_flag once_magicIndex;
+
+/**
+ * Initialize the magic number dispatch index.
+ * Called by std::call_once().
+ */
+static void init_magicIndex(void)
+{
+	for (size_t i = 0; i < romDataFns_magic.size(); i++) {
+		const RomDataFns &fns = romDataFns_magic[i];
+		assert(fns.address % 4 == 0);
+		assert(fns.address + sizeof(uint32_t) <= (4096+256));
+
+		// Find the index for this address.
+		MagicIndex_t *pIdx = nullptr;
+		for (MagicIndex_t &idx : vec_magicIndex) {
+			if (idx.address == fns.address) {
+				pIdx = &idx;
+				break;
+			}
+		}
+		if (!pIdx) {
+			vec_magicIndex.push_back({fns.address, {}});
+			pIdx = &vec_magicIndex.back();
+		}
+
+		const magic_mask_t bit = (static_cast<magic_mask_t>(1U) << i);
+		pIdx->map[fns.size] |= bit;
+		if (fns.magic2 != 0) {
+			pIdx->map[fns.magic2] |= bit;
+		}
+	}
+}
+
 /** IDiscReader / SparseDiscReader check arrays and functions **/
 
 typedef int (*pfnIsDiscSupported)(const uint8_t *pHeader, size_t szHeader);
@@ -904,21 +952,41 @@ RomDataPtr checkISO(const IRpFilePtr &file)
 /** RomDataFactory **/
 
 /**
- * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
- *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
- *
+ * Read header data for RomData subclass detection.
+ * If the file supports zero-copy access, the file data is used directly
+ * instead of copying it into the buffer.
+ * @param file	[in] File
+ * @param info	[out] DetectInfo (header fields)
+ * @param buf	[in] Buffer to use if zero-copy access isn't available (must be 32-bit aligned)
+ * @param addr	[in] Header address
+ * @param size	[in] Header size
+ * @return Number of bytes available.
+ */
+static uint32_t readHeader(IRpFile *file, RomData::DetectInfo &info, uint8_t *buf, uint32_t addr, uint32_t size)
+{
+	info.header.addr = addr;
+
+	size_t cbAvail = 0;
+	const uint8_t *const pData = file->peek(addr, size, &cbAvail);
+	if (pData && (reinterpret_cast<uintptr_t>(pData) % sizeof(uint32_t)) == 0) {
+		// Zero-copy access is available.
+		info.header.pData = pData;
+		info.header.size = static_cast<uint32_t>(cbAvail);
+	} else {
+		info.header.pData = buf;
+		info.header.size = static_cast<uint32_t>(file->seekAndRead(addr, buf, size));
+	}
+	return info.header.size;
+}
+
+/**
+ * Create a RomData subclass for the specified ROM file. (internal function)
  * @param file ROM file.
  * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @param stats [out] Detection statistics (probes only)
  * @return RomData subclass, or nullptr if the ROM isn't supported.
  */
-RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
+static RomDataPtr create_int(const IRpFilePtr &file, unsigned int attrs, CreateStats &stats)
 {
 	RomDataPtr romData;
 
@@ -932,9 +1000,10 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 		uint8_t u8[4096+256];
 		uint32_t u32[(4096+256)/4];
 	} header;
-	info.header.addr = 0;
-	info.header.pData = header.u8;
-	info.header.size = static_cast<uint32_t>(file->seekAndRead(0, header.u8, sizeof(header.u8)));
+	// NOTE: pHeader32 points to either `header` or to the file data
+	// if the file supports zero-copy access.
+	readHeader(file.get(), info, header.u8, 0, sizeof(header.u8));
+	const uint32_t *pHeader32 = reinterpret_cast<const uint32_t*>(info.header.pData);
 	if (info.header.size == 0) {
 		// Read error.
 		return romData;
@@ -964,6 +1033,7 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 	{
 		// Dreamcast .VMI+.VMS pair.
 		// Attempt to open the other file in the pair.
+		stats.probes++;
 		romData = Private::openDreamcastVMSandVMI(file);
 		if (romData) {
 			// .VMI+.VMS pair opened.
@@ -973,9 +1043,10 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 
 	// Check for a .zip file. (AndroidAPK, J2ME)
 	static constexpr uint32_t zip_magic = 0x504B0304;	// 'PK\x03\x04'
-	if (header.u32[0] == cpu_to_be32(zip_magic)) {
+	if (info.header.size >= sizeof(uint32_t) && pHeader32[0] == cpu_to_be32(zip_magic)) {
 		// This is a .zip file.
 		// NOTE: Assigning to `romData` for named-return-value optimization.
+		stats.probes++;
 		romData = Private::openZipFile(file, attrs);
 		return romData;
 	}
@@ -984,10 +1055,12 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 	// If a sparse disc image format is detected, this will be
 	// a SparseDiscReader. Otherwise, it'll be the same as `file`.
 	bool isSparseDiscReader = false;
-	IRpFilePtr reader(Private::openIDiscReader(file, header.u32[0]));
+	IRpFilePtr reader(Private::openIDiscReader(file,
+		(info.header.size >= sizeof(uint32_t)) ? pHeader32[0] : 0));
 	if (reader) {
 		// SparseDiscReader obtained. Re-read the header.
-		info.header.size = static_cast<uint32_t>(reader->seekAndRead(0, header.u8, sizeof(header.u8)));
+		readHeader(reader.get(), info, header.u8, 0, sizeof(header.u8));
+		pHeader32 = reinterpret_cast<const uint32_t*>(info.header.pData);
 		if (info.header.size == 0) {
 			// Read error.
 			return romData;
@@ -1000,31 +1073,44 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 
 	// Check RomData subclasses that take a header at 0
 	// and definitely have a 32-bit magic number in the header.
-	for (const auto &fns : Private::romDataFns_magic) {
-		if ((fns.attrs & attrs) != attrs) {
-			// This RomData subclass doesn't have the
-			// required attributes.
-			continue;
-		}
-
-		assert(fns.address % 4 == 0);
-		assert(fns.address + sizeof(uint32_t) <= sizeof(header.u32));
-		if (fns.address + sizeof(uint32_t) > info.header.size) {
+	// The magic number index is used to get a bitmask of
+	// candidate subclasses, so only subclasses with a
+	// matching magic number are checked.
+	std::call_once(Private::once_magicIndex, Private::init_magicIndex);
+	Private::magic_mask_t magic_mask = 0;
+	for (const auto &idx : Private::vec_magicIndex) {
+		if (idx.address + sizeof(uint32_t) > info.header.size) {
 			// The header size is less than the read address of this magic number.
 			continue;
 		}
 
 		// Check the magic number.
 		// TODO: Verify alignment restrictions.
-		const uint32_t magic = be32_to_cpu(header.u32[fns.address/4]);
-		if (magic == fns.size || (fns.magic2 != 0 && fns.magic2 == magic)) {
+		const auto iter = idx.map.find(be32_to_cpu(pHeader32[idx.address/4]));
+		if (iter != idx.map.end()) {
 			// Found a matching magic number.
-			if (fns.isRomSupported(&info) >= 0) {
-				romData = fns.newRomData(reader);
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return romData;
-				}
+			magic_mask |= iter->second;
+		}
+	}
+	for (size_t i = 0; magic_mask != 0; i++, magic_mask >>= 1) {
+		if (!(magic_mask & 1)) {
+			// Magic number doesn't match.
+			continue;
+		}
+
+		const auto &fns = Private::romDataFns_magic[i];
+		if ((fns.attrs & attrs) != attrs) {
+			// This RomData subclass doesn't have the
+			// required attributes.
+			continue;
+		}
+
+		stats.probes++;
+		if (fns.isRomSupported(&info) >= 0) {
+			romData = fns.newRomData(reader);
+			if (romData->isValid()) {
+				// RomData subclass obtained.
+				return romData;
 			}
 		}
 	}
@@ -1032,6 +1118,7 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 	// Check for supported textures.
 	{
 		// TODO: RpTextureWrapper::isRomSupported()?
+		stats.probes++;
 		romData = std::make_shared<RpTextureWrapper>(reader);
 		if (romData->isValid()) {
 			// RomData subclass obtained.
@@ -1109,13 +1196,12 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 			}
 
 			// Read the header data.
-			info.header.addr = fns.address;
-			info.header.size = static_cast<uint32_t>(reader->seekAndRead(info.header.addr, header.u8, fns.size));
-			if (info.header.size != fns.size) {
+			if (readHeader(reader.get(), info, header.u8, fns.address, fns.size) != fns.size) {
 				continue;
 			}
 		}
 
+		stats.probes++;
 		if (fns.isRomSupported(&info) >= 0) {
 			if (fns.attrs & RDA_CHECK_ISO) {
 				// Check for a game-specific ISO subclass.
@@ -1181,9 +1267,9 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 		if (!readFooter) {
 			static constexpr int footer_size = 1024;
 			if (info.szFile > footer_size) {
-				info.header.addr = static_cast<uint32_t>(info.szFile - footer_size);
-				info.header.size = static_cast<uint32_t>(reader->seekAndRead(info.header.addr, header.u8, footer_size));
-				if (info.header.size == 0) {
+				if (readHeader(reader.get(), info, header.u8,
+				               static_cast<uint32_t>(info.szFile - footer_size), footer_size) == 0)
+				{
 					// Seek and/or read error.
 					return romData;
 				}
@@ -1191,6 +1277,7 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 			readFooter = true;
 		}
 
+		stats.probes++;
 		if (fns.isRomSupported(&info) >= 0) {
 			romData = fns.newRomData(reader);
 			if (romData->isValid()) {
@@ -1203,6 +1290,7 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 	// Last chance: If a SparseDiscReader is in use, check for ISO.
 	// Needed for PSP disc images, among others.
 	if (isSparseDiscReader) {
+		stats.probes++;
 		romData = Private::checkISO(reader);
 		if (romData && romData->isValid()) {
 			// RomData subclass obtained.
@@ -1215,6 +1303,33 @@ RomDataPtr create(const IRpFilePtr &file, unsigned int attrs)
 	return romData;
 }
 
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @param pStats [out,opt] Detection statistics
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomDataPtr create(const IRpFilePtr &file, unsigned int attrs, CreateStats *pStats)
+{
+	CreateStats stats;
+	RomDataPtr romData = create_int(file, attrs, stats);
+	if (pStats) {
+		stats.className = (romData ? romData->className() : nullptr);
+		*pStats = stats;
+	}
+	return romData;
+}
+
 /**
  * Create a RomData subclass for the specified ROM file.
  *
@@ -64,6 +64,20 @@ enum ATTR_FLAG_ENUM RomDataAttr {
 	RDA_CHECK_ISO		= (1U << 8),
 };
 
+/**
+ * Detection statistics for create().
+ * Used to measure the cost of RomData subclass detection.
+ */
+struct CreateStats {
+	const char *className;	// Class name of the RomData subclass, or nullptr if not supported
+	unsigned int probes;	// Number of isRomSupported() checks and constructor attempts
+
+	CreateStats()
+		: className(nullptr)
+		, probes(0)
+	{}
+};
+
 /**
  * Create a RomData subclass for the specified ROM file.
  *
@@ -77,10 +91,11 @@ enum ATTR_FLAG_ENUM RomDataAttr {
  *
  * @param file ROM file
  * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @param pStats [out,opt] Detection statistics
  * @return RomData subclass, or nullptr if the ROM isn't supported.
  */
 RP_LIBROMDATA_PUBLIC
-LibRpBase::RomDataPtr create(const LibRpFile::IRpFilePtr &file, unsigned int attrs = 0);
+LibRpBase::RomDataPtr create(const LibRpFile::IRpFilePtr &file, unsigned int attrs = 0, CreateStats *pStats = nullptr);
 
 /**
  * Create a RomData subclass for the specified ROM file.
@@ -496,7 +496,7 @@ KeyManager::VerifyResult loadNCCHKeys(u128_t pKeyOut[2],
 	// Need to return an appropriate error in this case.
 
 	// Load the two KeyX keys.
-	KeyManager::KeyData_t keyX_data[2] = {{nullptr, 0}, {nullptr, 0}};
+	KeyManager::KeyData_t keyX_data[2] = {};
 	for (unsigned int i = 0; i < 2; i++) {
 		if (!keyX_name[i]) {
 			// KeyX[1] is the same as KeyX[0];
@@ -516,7 +516,7 @@ KeyManager::VerifyResult loadNCCHKeys(u128_t pKeyOut[2],
 			if (i == 0)
 				return res;
 			// Secondary key. Ignore errors for now.
-			memset(&keyX_data[i], 0, sizeof(keyX_data[i]));
+			keyX_data[i] = KeyManager::KeyData_t();
 			keyX_name[i] = nullptr;
 		} else if (keyX_data[i].length != 16) {
 			// KeyX is the wrong length.
@@ -29,6 +29,7 @@ using namespace LibRpFile;
 #include <cstring>
 
 // C++ includes
+#include <mutex>
 using std::string;
 using std::tstring;
 using std::unique_ptr;
@@ -122,6 +123,9 @@ public:
 	};
 	AmiiboBinFileType amiiboBinFileType;
 
+	// loadIfNeeded() mutex
+	std::mutex mtxLoad;
+
 private:
 	/**
 	 * Get an amiibo-data.bin filename.
@@ -281,6 +285,8 @@ tstring AmiiboDataPrivate::getAmiiboBinFilename(AmiiboBinFileType amiiboBinFileT
  */
 int AmiiboDataPrivate::loadIfNeeded(void)
 {
+	std::lock_guard<std::mutex> mtxLocker(mtxLoad);
+
 	const time_t now = time(nullptr);
 	if (!amiibo_bin_data.empty()) {
 		// amiibo data is already loaded.
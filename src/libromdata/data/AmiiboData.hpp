@@ -44,6 +44,11 @@ public:
 	 * This automatically initializes the object and
 	 * reloads amiibo.bin if it has been modified.
 	 *
+	 * Thread safety: Loading is serialized with an internal mutex,
+	 * so lookups may be done from multiple threads. Returned strings
+	 * point into the loaded amiibo-data.bin, so they are only valid
+	 * until amiibo-data.bin is modified on disk and reloaded.
+	 *
 	 * @return AmiiboData instance.
 	 */
 	static AmiiboData *instance(void);
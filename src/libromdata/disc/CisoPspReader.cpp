@@ -76,16 +76,19 @@ public:
 	// - v2: If set, block is compressed using LZ4; otherwise, deflate.
 	rp::uvector<uint32_t> indexEntries;
 
-	// Block cache
-	rp::uvector<uint8_t> blockCache;
-	uint32_t blockCacheIdx;
-
 	uint8_t index_shift;		// Index shift value (CISO/ZISO only)
 	bool isDaxWithoutNCTable;	// Convenience variable
 
-	// Decompression buffer
-	// (Same size as blockCache.)
-	rp::uvector<uint8_t> z_buffer;
+	// Maximum compressed block size
+	uint32_t z_max_block_size;
+
+	// Compression mode for CompressedBlock::z_mode
+	enum class CompressionMode {
+		None = 0,
+		Deflate = 1,
+		LZ4 = 2,
+		LZO = 3,
+	};
 
 	// DAX: Size and NC area tables
 	rp::uvector<uint16_t> daxSizeTable;
@@ -111,9 +114,9 @@ CisoPspDlopen CisoPspReaderPrivate::dlopenHandler;
 CisoPspReaderPrivate::CisoPspReaderPrivate(CisoPspReader *q)
 	: super(q)
 	, cisoType(CisoType::Unknown)
-	, blockCacheIdx(~0U)
 	, index_shift(0)
 	, isDaxWithoutNCTable(false)
+	, z_max_block_size(0)
 {
 	// Clear the header structs.
 	memset(&header, 0, sizeof(header));
@@ -438,18 +441,18 @@ CisoPspReader::CisoPspReader(const IRpFilePtr &file)
 		}
 	}
 
-	// Initialize the block cache and decompression buffer.
+	// Maximum compressed block size.
 	// NOTE: Extra 64 bytes is for zlib, in case it needs it.
-	size_t cache_size = d->block_size + 64;
+	d->z_max_block_size = d->block_size + 64;
 	if (d->isDaxWithoutNCTable) {
 		// DAX with no NC table. Use double the block size,
 		// since zlib-compressed data can end up taking up
 		// more space than uncompressed.
-		cache_size *= 2;
+		d->z_max_block_size *= 2;
 	}
-	d->blockCache.resize(cache_size);
-	d->z_buffer.resize(cache_size);
-	d->blockCacheIdx = ~0U;
+
+	// Decompressed blocks are cached by SparseDiscReader.
+	d->useBlockCache = true;
 
 	// PSP disc images are always ISO-9660 Mode 1.
 	d->hasCdromInfo = true;
@@ -678,59 +681,28 @@ off64_t CisoPspReader::getPhysBlockAddr(uint32_t blockIdx) const
 }
 
 /**
- * Read the specified block.
- *
- * This can read either a full block or a partial block.
- * For a full block, set pos = 0 and size = block_size.
- *
- * @param blockIdx	[in] Block index.
- * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
- * @param ptr		[out] Output data buffer.
- * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
- * @return Number of bytes read, or -1 if the block index is invalid.
+ * Read the compressed data for the specified block.
+ * @param blockIdx	[in] Block index
+ * @param zblock	[out] Compressed block data
+ * @return 0 on success; negative POSIX error code on error.
  */
-int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
+int CisoPspReader::readCompressedBlock(uint32_t blockIdx, CompressedBlock &zblock)
 {
-	// Read 'size' bytes of block 'blockIdx', starting at 'pos'.
 	// NOTE: This can only be called by SparseDiscReader,
-	// so the main assertions are already checked there.
+	// so the block index has already been checked.
 	RP_D(CisoPspReader);
-	assert(pos >= 0 && pos < (int)d->block_size);
-	assert(size <= d->block_size);
-	// TODO: Make sure overflow doesn't occur.
-	assert(static_cast<off64_t>(pos + size) <= static_cast<off64_t>(d->block_size));
-	if (pos < 0 || static_cast<off64_t>(pos + size) > static_cast<off64_t>(d->block_size)) {
-		// pos+size is out of range.
-		return -1;
-	}
-
-	if (unlikely(size == 0)) {
-		// Nothing to read.
-		return 0;
-	}
-
-	if (blockIdx == d->blockCacheIdx) {
-		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
-		return static_cast<int>(size);
-	}
+	typedef CisoPspReaderPrivate::CompressionMode CompressionMode;
 
 	// Get the physical address first.
 	const uint32_t indexEntry = d->indexEntries[blockIdx];
 	uint32_t z_block_size = d->getBlockCompressedSize(blockIdx);
-	if (z_block_size == 0 || z_block_size > d->blockCache.size()) {
+	if (z_block_size == 0 || z_block_size > d->z_max_block_size) {
 		// Unable to get the block's compressed size,
 		// or the compressed size is "too big"...
 		m_lastError = EIO;
-		return 0;
+		return -EIO;
 	}
 
-	enum class CompressionMode {
-		None = 0,
-		Deflate = 1,
-		LZ4 = 2,
-		LZO = 3,
-	};
 	CompressionMode z_mode;
 	int windowBits = 0;
 
@@ -741,7 +713,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			assert(!"Unsupported CisoType.");
 			m_file.reset();
 			m_lastError = ENOTSUP;
-			return 0;
+			return -ENOTSUP;
 
 		case CisoPspReaderPrivate::CisoType::CISO:
 			// CISO uses raw deflate.
@@ -763,7 +735,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 					if (z_block_size != d->block_size) {
 						// Error...
 						m_lastError = EIO;
-						return 0;
+						return -EIO;
 					}
 				}
 			} else {
@@ -808,7 +780,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 				if (z_block_size <= 4) {
 					// Incorrect block size.
 					m_lastError = EIO;
-					return 0;
+					return -EIO;
 				}
 				physBlockAddr += 4;
 				z_block_size -= 4;
@@ -829,7 +801,7 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 					default:
 						assert(!"Unsupported JISO compression method.");
 						m_lastError = ENOTSUP;
-						return 0;
+						return -ENOTSUP;
 				}
 			}
 			break;
@@ -849,74 +821,91 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			break;
 	}
 
-	switch (z_mode) {
+	// NOTE: Uncompressed blocks may be slightly larger than the
+	// block size. They're limited to z_max_block_size, which was
+	// checked above, and only block_size bytes are used.
+	if (z_mode != CompressionMode::None) {
+		uint32_t z_max_size = d->block_size;
+		if (unlikely(d->isDaxWithoutNCTable)) {
+			// DAX without NC table can end up compressing to larger
+			// than the uncompressed size.
+			z_max_size *= 2;
+		}
+		if (z_block_size > z_max_size) {
+			// Compressed data is larger than the uncompressed block size.
+			// This is only allowed for DAX without NC table.
+			m_lastError = EIO;
+			return -EIO;
+		}
+	}
+
+	// Read the compressed data.
+	zblock.data.resize(z_block_size);
+	size_t sz_read = m_file->seekAndRead(physBlockAddr, zblock.data.data(), z_block_size);
+	if (sz_read != z_block_size) {
+		// Seek and/or read error.
+		m_lastError = m_file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
+		return -m_lastError;
+	}
+
+	zblock.blockIdx = blockIdx;
+	zblock.z_mode = static_cast<int>(z_mode);
+	zblock.z_param = windowBits;
+	return 0;
+}
+
+/**
+ * Decompress a block that was read by readCompressedBlock().
+ * @param zblock	[in] Compressed block data
+ * @param pBuf		[out] Output buffer (must be block_size bytes)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CisoPspReader::decompressBlock(const CompressedBlock &zblock, uint8_t *pBuf) const
+{
+	// NOTE: This function may be called from worker threads.
+	// Don't modify any object state here, including m_lastError.
+	RP_D(const CisoPspReader);
+	typedef CisoPspReaderPrivate::CompressionMode CompressionMode;
+	const uint32_t z_block_size = static_cast<uint32_t>(zblock.data.size());
+
+	switch (static_cast<CompressionMode>(zblock.z_mode)) {
 		default:
 			assert(!"Compression mode not supported...");
-			m_lastError = ENOTSUP;
-			return 0;
-
-		case CompressionMode::None: {
-			// Reading uncompressed data directly into the cache.
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				d->blockCacheIdx = ~0U;
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
+			return -ENOTSUP;
+
+		case CompressionMode::None:
+			// Uncompressed data.
+			// NOTE: The stored block may be larger than block_size.
+			// Only copy block_size bytes.
+			if (z_block_size >= d->block_size) {
+				memcpy(pBuf, zblock.data.data(), d->block_size);
+			} else {
+				// Short block. Zero out the rest of the block.
+				memcpy(pBuf, zblock.data.data(), z_block_size);
+				memset(&pBuf[z_block_size], 0, d->block_size - z_block_size);
 			}
-			d->blockCacheIdx = blockIdx;
 			break;
-		}
 
 		case CompressionMode::Deflate: {
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
+			const int windowBits = zblock.z_param;
 			assert(windowBits != 0);
 			if (windowBits == 0) {
-				d->blockCacheIdx = ~0U;
-				m_lastError = EINVAL;
-				return 0;
-			}
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				d->blockCacheIdx = ~0U;
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
+				return -EINVAL;
 			}
 
 			// Decompress the data.
 			z_stream strm = { };
-			strm.next_in = d->z_buffer.data();
+			strm.next_in = const_cast<uint8_t*>(zblock.data.data());
 			strm.avail_in = z_block_size;
-			strm.next_out = d->blockCache.data();
+			strm.next_out = pBuf;
 			strm.avail_out = d->block_size;
 			int ret = inflateInit2(&strm, windowBits);
 			if (ret != Z_OK) {
 				// Error initializing zlib.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+				return -EIO;
 			}
 
 			int status = inflate(&strm, Z_FULL_FLUSH);
@@ -926,102 +915,44 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			if (status != Z_STREAM_END || uncomp_size != d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+				return -EIO;
 			}
 			break;
 		}
 
 		case CompressionMode::LZ4: {
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
-
 			// Decompress the data.
 			int sz_rd = d->dlopenHandler.LZ4_decompress_safe(
-				reinterpret_cast<const char*>(d->z_buffer.data()),
-				reinterpret_cast<char*>(d->blockCache.data()),
+				reinterpret_cast<const char*>(zblock.data.data()),
+				reinterpret_cast<char*>(pBuf),
 				z_block_size, d->block_size);
 			if (sz_rd != (int)d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+				return -EIO;
 			}
 			break;
 		}
 
 		case CompressionMode::LZO: {
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
-
 			// Decompress the data.
 			// TODO: LZO in-place decompression?
 			lzo_uint dst_len = d->block_size;
 			int ret = d->dlopenHandler.lzo1x_decompress_safe(
-				d->z_buffer.data(), z_block_size,
-				d->blockCache.data(), &dst_len,
+				const_cast<uint8_t*>(zblock.data.data()), z_block_size,
+				pBuf, &dst_len,
 				nullptr);
 			if (ret != LZO_E_OK || dst_len != d->block_size) {
 				// Decompression error.
 				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+				return -EIO;
 			}
 			break;
 		}
 	}
 
-	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
-	return static_cast<int>(size);
+	// Block has been decompressed.
+	return 0;
 }
 
 } // namespace LibRomData
@@ -0,0 +1,291 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * FstPathIndex.hpp: Path lookup index for GameCube/Wii/Wii U FSTs.        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+
+// Other rom-properties libraries
+#include "librpbyteswap/byteswap_rp.h"
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+// C++ STL classes
+#include <algorithm>
+#include <vector>
+
+namespace LibRomData {
+
+/**
+ * Path lookup index for GameCube/Wii/Wii U FSTs.
+ *
+ * GameCube/Wii and Wii U FSTs use the same layout: a flat array of
+ * entries in depth-first order, where each directory's next_offset
+ * is the index *after* its last entry, followed by a string table.
+ *
+ * The index is a flat table of (parent index, name hash, entry index),
+ * sorted so all entries in a directory with the same name hash are
+ * adjacent. Path components are looked up using a binary search.
+ *
+ * Names are compared against the FST string table in place if the
+ * path component is ASCII. Otherwise, the FST's UTF-8 converted name
+ * is used.
+ *
+ * @tparam FstPrivate FST private class (must have is_dir() and entry_name())
+ * @tparam FstEntry FST entry struct
+ */
+template<typename FstPrivate, typename FstEntry>
+class FstPathIndex
+{
+public:
+	FstPathIndex()
+		: m_built(false)
+	{ }
+
+public:
+	RP_DISABLE_COPY(FstPathIndex)
+
+private:
+	struct IndexEntry {
+		uint32_t parent;	// Parent directory index
+		uint32_t hash;		// Name hash (FNV-1a of the UTF-8 name)
+		uint32_t idx;		// FST entry index
+
+		bool operator<(const IndexEntry &other) const
+		{
+			if (parent != other.parent)
+				return (parent < other.parent);
+			if (hash != other.hash)
+				return (hash < other.hash);
+			return (idx < other.idx);
+		}
+	};
+
+	std::vector<IndexEntry> m_index;
+	bool m_built;
+
+	/**
+	 * Hash a name using 32-bit FNV-1a.
+	 * @param str Name
+	 * @param len Length of name
+	 * @param pIsAscii [out] Set to true if the name is ASCII.
+	 * @return Hash
+	 */
+	static inline uint32_t hashName(const char *str, size_t len, bool *pIsAscii)
+	{
+		uint32_t hash = 0x811C9DC5U;
+		uint8_t hibits = 0;
+		for (; len > 0; str++, len--) {
+			const uint8_t chr = static_cast<uint8_t>(*str);
+			hibits |= chr;
+			hash = (hash ^ chr) * 0x01000193U;
+		}
+		*pIsAscii = !(hibits & 0x80);
+		return hash;
+	}
+
+	/**
+	 * Find the first index entry that isn't less than the specified key.
+	 *
+	 * NOTE: This is used instead of std::lower_bound(), since
+	 * _GLIBCXX_DEBUG checks that the entire range is sorted
+	 * on every call, which makes each lookup O(n).
+	 *
+	 * @param key Key
+	 * @return Index of the first entry that isn't less than the key, or m_index.size() if none.
+	 */
+	inline size_t lowerBound(const IndexEntry &key) const
+	{
+		size_t first = 0;
+		size_t count = m_index.size();
+		while (count > 0) {
+			const size_t step = count / 2;
+			if (m_index[first + step] < key) {
+				first += step + 1;
+				count -= step + 1;
+			} else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+public:
+	/**
+	 * Has the index been built?
+	 * @return True if built; false if not.
+	 */
+	inline bool isBuilt(void) const
+	{
+		return m_built;
+	}
+
+	/**
+	 * Build the index.
+	 *
+	 * The FST is walked once in index order, so corrupted
+	 * next_offset values can't cause infinite loops.
+	 *
+	 * @param d		[in] FST private class
+	 * @param entries	[in] FST entries (entries[0] is the root directory)
+	 * @param file_count	[in] Number of FST entries, including the root directory
+	 * @param string_table	[in] FST string table (NULL-terminated)
+	 * @param string_table_sz [in] Size of the FST string table
+	 */
+	void build(const FstPrivate *d, const FstEntry *entries, uint32_t file_count,
+		const char *string_table, uint32_t string_table_sz)
+	{
+		m_built = true;
+		m_index.clear();
+		if (file_count <= 1) {
+			// No entries.
+			return;
+		}
+		m_index.reserve(file_count - 1);
+
+		// Directory stack.
+		// NOTE: `end` is the index *after* the last entry in the directory.
+		struct DirRange {
+			uint32_t idx;
+			uint32_t end;
+		};
+		std::vector<DirRange> dirStack;
+		dirStack.push_back({0, file_count});
+
+		for (uint32_t idx = 1; idx < file_count; idx++) {
+			// Leave directories that end before this entry.
+			// NOTE: The root directory is never removed.
+			while (idx >= dirStack.back().end) {
+				dirStack.pop_back();
+			}
+
+			const FstEntry *const fst_entry = &entries[idx];
+			const uint32_t parent = dirStack.back().idx;
+			if (FstPrivate::is_dir(fst_entry)) {
+				// Make sure the subdirectory is within the parent directory.
+				// If it isn't, the FST is corrupted; treat it as empty.
+				uint32_t end = be32_to_cpu(fst_entry->dir.next_offset);
+				if (end <= idx) {
+					end = idx + 1;
+				} else if (end > dirStack.back().end) {
+					end = dirStack.back().end;
+				}
+				dirStack.push_back({idx, end});
+			}
+
+			// Get the entry's name from the string table.
+			const uint32_t offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
+			if (offset >= string_table_sz) {
+				// Out of range. This entry can't be found by name.
+				continue;
+			}
+			const char *name = &string_table[offset];
+			bool isAscii;
+			uint32_t hash = hashName(name, strlen(name), &isAscii);
+			if (!isAscii) {
+				// Hash the UTF-8 name instead.
+				name = d->entry_name(fst_entry);
+				if (!name) {
+					continue;
+				}
+				hash = hashName(name, strlen(name), &isAscii);
+			}
+
+			m_index.push_back({parent, hash, idx});
+		}
+
+		std::sort(m_index.begin(), m_index.end());
+	}
+
+	/**
+	 * Find a path.
+	 * The index must have been built using build().
+	 *
+	 * @param d		[in] FST private class
+	 * @param entries	[in] FST entries (entries[0] is the root directory)
+	 * @param string_table	[in] FST string table (NULL-terminated)
+	 * @param path		[in] Path (relative paths are treated as absolute)
+	 * @return FST entry index (0 for the root directory), or -1 if not found.
+	 */
+	int find(const FstPrivate *d, const FstEntry *entries, const char *string_table, const char *path) const
+	{
+		assert(m_built);
+
+		uint32_t cur_idx = 0;
+		bool is_file = false;
+		const char *p = path;
+		for (;;) {
+			// Skip slashes.
+			while (*p == '/') {
+				p++;
+			}
+			if (*p == '\0') {
+				// End of path.
+				break;
+			}
+
+			// Get the next path component.
+			const char *const component = p;
+			while (*p != '\0' && *p != '/') {
+				p++;
+			}
+			const size_t len = static_cast<size_t>(p - component);
+
+			if (is_file) {
+				// The previous path component was a file.
+				return -1;
+			}
+
+			bool isAscii;
+			IndexEntry key;
+			key.parent = cur_idx;
+			key.hash = hashName(component, len, &isAscii);
+			key.idx = 0;
+
+			auto iter = m_index.cbegin() + lowerBound(key);
+			bool found = false;
+			for (; iter != m_index.cend() && iter->parent == key.parent && iter->hash == key.hash; ++iter) {
+				const FstEntry *const fst_entry = &entries[iter->idx];
+				const char *name;
+				if (isAscii) {
+					// Compare against the string table directly.
+					// If the name isn't ASCII, it won't match.
+					const uint32_t offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
+					name = &string_table[offset];
+				} else {
+					// Compare against the UTF-8 name.
+					name = d->entry_name(fst_entry);
+					if (!name) {
+						continue;
+					}
+				}
+
+				// TODO: Is GCN/Wii/Wii U case-sensitive?
+				if (!strncmp(name, component, len) && name[len] == '\0') {
+					// Found a match.
+					cur_idx = iter->idx;
+					is_file = !FstPrivate::is_dir(fst_entry);
+					found = true;
+					break;
+				}
+			}
+
+			if (!found) {
+				// No match.
+				return -1;
+			}
+		}
+
+		return static_cast<int>(cur_idx);
+	}
+};
+
+}
@@ -57,14 +57,6 @@ public:
 	rp::uvector<uint64_t> blockPointers;
 	rp::uvector<uint32_t> hashes;
 
-	// Decompression buffer
-	// (Same size as blockCache)
-	rp::uvector<uint8_t> z_buffer;
-
-	// Block cache
-	rp::uvector<uint8_t> blockCache;
-	uint32_t blockCacheIdx;
-
 	// Starting offset of the data area
 	// This offset must be added to the blockPointers value
 	uint32_t dataOffset;
@@ -81,7 +73,6 @@ public:
 
 GczReaderPrivate::GczReaderPrivate(GczReader *q)
 	: super(q)
-	, blockCacheIdx(~0U)
 	, dataOffset(0)
 {
 	// Clear the GCZ header struct.
@@ -262,11 +253,8 @@ GczReader::GczReader(const IRpFilePtr &file)
 	}
 	d->dataOffset = static_cast<uint32_t>(pos);
 
-	// Initialize the block cache and decompression buffer.
-	// NOTE: Extra 64 bytes is for zlib, in case it needs it.
-	d->blockCache.resize(d->block_size + 64);
-	d->z_buffer.resize(d->block_size + 64);
-	d->blockCacheIdx = ~0U;
+	// Decompressed blocks are cached by SparseDiscReader.
+	d->useBlockCache = true;
 
 	// Reset the disc position.
 	d->pos = 0;
@@ -374,42 +362,16 @@ off64_t GczReader::getPhysBlockAddr(uint32_t blockIdx) const
 }
 
 /**
- * Read the specified block.
- *
- * This can read either a full block or a partial block.
- * For a full block, set pos = 0 and size = block_size.
- *
- * @param blockIdx	[in] Block index.
- * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
- * @param ptr		[out] Output data buffer.
- * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
- * @return Number of bytes read, or -1 if the block index is invalid.
+ * Read the compressed data for the specified block.
+ * @param blockIdx	[in] Block index
+ * @param zblock	[out] Compressed block data
+ * @return 0 on success; negative POSIX error code on error.
  */
-int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
+int GczReader::readCompressedBlock(uint32_t blockIdx, CompressedBlock &zblock)
 {
-	// Read 'size' bytes of block 'blockIdx', starting at 'pos'.
 	// NOTE: This can only be called by SparseDiscReader,
-	// so the main assertions are already checked there.
+	// so the block index has already been checked.
 	RP_D(GczReader);
-	assert(pos >= 0 && pos < static_cast<int>(d->block_size));
-	assert(size <= d->block_size);
-	// TODO: Make sure overflow doesn't occur.
-	assert(static_cast<off64_t>(pos + size) <= static_cast<off64_t>(d->block_size));
-	if (pos < 0 || static_cast<off64_t>(pos + size) > static_cast<off64_t>(d->block_size)) {
-		// pos+size is out of range.
-		return -1;
-	}
-
-	if (unlikely(size == 0)) {
-		// Nothing to read.
-		return 0;
-	}
-
-	if (blockIdx == d->blockCacheIdx) {
-		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
-		return static_cast<int>(size);
-	}
 
 	// NOTE: If this is the last block, then we might have
 	// a short read. We'll allow it.
@@ -422,7 +384,7 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	if (z_block_size == 0) {
 		// Unable to get the block's compressed size...
 		m_lastError = EIO;
-		return 0;
+		return -EIO;
 	}
 
 	const bool compressed = (!(blockPointer & GCZ_FLAG_BLOCK_NOT_COMPRESSED));
@@ -431,90 +393,96 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		if (z_block_size != d->block_size) {
 			// Error...
 			m_lastError = EIO;
-			return 0;
-		}
-	}
-
-	if (!compressed) {
-		// Reading uncompressed data directly into the cache.
-		if (isLastBlock) {
-			memset(d->blockCache.data(), 0, d->blockCache.size());
-		}
-
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
-		if (sz_read != z_block_size && !isLastBlock) {
-			// Seek and/or read error.
-			d->blockCacheIdx = ~0U;
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
+			return -EIO;
 		}
-		d->blockCacheIdx = blockIdx;
 	} else {
-		// Read compressed data into a temporary buffer,
-		// then decompress it.
 		if (z_block_size > d->block_size) {
 			// Compressed data is larger than the uncompressed block size...
-			d->blockCacheIdx = ~0U;
 			m_lastError = EIO;
-			return 0;
+			return -EIO;
 		}
+	}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-		if (sz_read != z_block_size) {
+	zblock.data.resize(z_block_size);
+	size_t sz_read = m_file->seekAndRead(physBlockAddr, zblock.data.data(), z_block_size);
+	if (sz_read != z_block_size) {
+		if (!compressed && isLastBlock) {
+			// Short read for the last uncompressed block.
+			// The rest of the block will be zeroed out.
+			zblock.data.resize(sz_read);
+		} else {
 			// Seek and/or read error.
-			d->blockCacheIdx = ~0U;
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
 				m_lastError = EIO;
 			}
-			return 0;
+			return -m_lastError;
 		}
+	}
 
-		// Verify the hash of the *compressed* data.
-		uint32_t hash_calc = adler32(0L, nullptr, 0);
-		hash_calc = adler32(hash_calc, d->z_buffer.data(), z_block_size);
-		if (hash_calc != le32_to_cpu(d->hashes[blockIdx])) {
-			// Hash error.
-			// TODO: Print warnings and/or more comprehensive error codes.
-			d->blockCacheIdx = ~0U;
-			m_lastError = EIO;
-			return 0;
-		}
+	zblock.blockIdx = blockIdx;
+	zblock.z_mode = (compressed ? 1 : 0);
+	zblock.z_param = 0;
+	return 0;
+}
 
-		// Decompress the data.
-		z_stream z = { };
-		z.next_in = d->z_buffer.data();
-		z.avail_in = z_block_size;
-		z.next_out = d->blockCache.data();
-		z.avail_out = d->block_size;
-		int ret = inflateInit(&z);
-		if (ret != Z_OK) {
-			// Error initializing zlib.
-			d->blockCacheIdx = ~0U;
-			m_lastError = EIO;
-			return 0;
+/**
+ * Decompress a block that was read by readCompressedBlock().
+ * @param zblock	[in] Compressed block data
+ * @param pBuf		[out] Output buffer (must be block_size bytes)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GczReader::decompressBlock(const CompressedBlock &zblock, uint8_t *pBuf) const
+{
+	// NOTE: This function may be called from worker threads.
+	// Don't modify any object state here, including m_lastError.
+	RP_D(const GczReader);
+	const uint32_t z_block_size = static_cast<uint32_t>(zblock.data.size());
+
+	if (!zblock.z_mode) {
+		// Uncompressed data.
+		assert(z_block_size <= d->block_size);
+		memcpy(pBuf, zblock.data.data(), z_block_size);
+		if (z_block_size < d->block_size) {
+			// Short block. Zero out the rest of the block.
+			memset(&pBuf[z_block_size], 0, d->block_size - z_block_size);
 		}
+		return 0;
+	}
 
-		int status = inflate(&z, Z_FULL_FLUSH);
-		const uint32_t uncomp_size = d->block_size - z.avail_out;
-		inflateEnd(&z);
+	// Verify the hash of the *compressed* data.
+	uint32_t hash_calc = adler32(0L, nullptr, 0);
+	hash_calc = adler32(hash_calc, zblock.data.data(), z_block_size);
+	if (hash_calc != le32_to_cpu(d->hashes[zblock.blockIdx])) {
+		// Hash error.
+		// TODO: Print warnings and/or more comprehensive error codes.
+		return -EIO;
+	}
 
-		if (status != Z_STREAM_END || uncomp_size != d->block_size) {
-			// Decompression error.
-			// TODO: Print warnings and/or more comprehensive error codes.
-			d->blockCacheIdx = ~0U;
-			m_lastError = EIO;
-			return 0;
-		}
+	// Decompress the data.
+	z_stream z = { };
+	z.next_in = const_cast<uint8_t*>(zblock.data.data());
+	z.avail_in = z_block_size;
+	z.next_out = pBuf;
+	z.avail_out = d->block_size;
+	int ret = inflateInit(&z);
+	if (ret != Z_OK) {
+		// Error initializing zlib.
+		return -EIO;
 	}
 
-	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
-	return static_cast<int>(size);
+	int status = inflate(&z, Z_FULL_FLUSH);
+	const uint32_t uncomp_size = d->block_size - z.avail_out;
+	inflateEnd(&z);
+
+	if (status != Z_STREAM_END || uncomp_size != d->block_size) {
+		// Decompression error.
+		// TODO: Print warnings and/or more comprehensive error codes.
+		return -EIO;
+	}
+
+	// Block has been decompressed.
+	return 0;
 }
 
 } // namespace LibRomData
@@ -63,19 +63,20 @@ protected:
 	off64_t getPhysBlockAddr(uint32_t blockIdx) const final;
 
 	/**
-	 * Read the specified block.
-	 *
-	 * This can read either a full block or a partial block.
-	 * For a full block, set pos = 0 and size = block_size.
-	 *
-	 * @param blockIdx	[in] Block index.
-	 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
-	 * @param ptr		[out] Output data buffer.
-	 * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
-	 * @return Number of bytes read, or -1 if the block index is invalid.
+	 * Read the compressed data for the specified block.
+	 * @param blockIdx	[in] Block index
+	 * @param zblock	[out] Compressed block data
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int readCompressedBlock(uint32_t blockIdx, CompressedBlock &zblock) final;
+
+	/**
+	 * Decompress a block that was read by readCompressedBlock().
+	 * @param zblock	[in] Compressed block data
+	 * @param pBuf		[out] Output buffer (must be block_size bytes)
+	 * @return 0 on success; negative POSIX error code on error.
 	 */
-	ATTR_ACCESS_SIZE(write_only, 4, 5)
-	int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+	int decompressBlock(const CompressedBlock &zblock, uint8_t *pBuf) const final;
 };
 
 } // namespace LibRomData
@@ -27,6 +27,7 @@ using namespace LibRpFile;
 // C++ STL classes
 using std::array;
 using std::unique_ptr;
+using std::vector;
 
 #include "GcnPartition_p.hpp"
 namespace LibRomData {
@@ -71,10 +72,9 @@ public:
 	static constexpr unsigned int SECTOR_SIZE_DECRYPTED = 0x7C00U;
 	static constexpr unsigned int SECTOR_SIZE_DECRYPTED_OFFSET = 0x400U;
 
-	// Decrypted sector cache.
+	// Encrypted sector layout.
 	// NOTE: Actual data starts at 0x400.
 	// Hashes and the sector IV are stored first.
-	uint32_t sector_num;				// Sector number.
 	union EncSector_t {
 		struct {
 			// NOTE: &hashes.H2[7][4], when encrypted, is the sector IV.
@@ -92,20 +92,63 @@ public:
 	};
 	ASSERT_STRUCT(EncSector_t, SECTOR_SIZE_ENCRYPTED);
 	static_assert(offsetof(EncSector_t, hashes.H2) + (7*20) + 4 == 0x3D0, "IV location is wrong");
-	EncSector_t sector_buf;	// Decrypted sector data.
 
 	// Decrypted read position. (0x7C00 bytes out of 0x8000)
 	// NOTE: Actual read position if ((cryptoMethod & CM_MASK_SECTOR) == CM_32K).
 	off64_t pos_7C00;
 
+public:
+	/** Decrypted sector cache **/
+
+	// Maximum number of sectors in the decrypted sector cache.
+	static constexpr unsigned int SECTOR_CACHE_COUNT = 8;
+	// Maximum number of sectors to read and decrypt at once
+	// when reading multiple uncached sectors.
+	static constexpr unsigned int SECTOR_BATCH_COUNT = 16;
+
+	struct SectorCacheEntry {
+		uint32_t sector_num;	// Sector number (~0U if invalid)
+		uint32_t last_used;	// Value of sectorCacheClock when this sector was last used
+		EncSector_t sector;	// Decrypted sector data
+	};
+
+	// Decrypted sector cache.
+	// Entries are allocated as needed, up to SECTOR_CACHE_COUNT.
+	vector<SectorCacheEntry> sectorCache;
+	uint32_t sectorCacheClock;
+
+	// Batched read buffer. (SECTOR_BATCH_COUNT sectors)
+	// Allocated on first use.
+	unique_ptr<EncSector_t[]> batchBuf;
+
+	// Statistics
+	WiiPartition::SectorCacheStats stats;
+
 	/**
-	 * Read and decrypt a sector.
-	 * The decrypted sector is stored in sector_buf.
-	 *
+	 * Find a sector in the decrypted sector cache.
 	 * @param sector_num Sector number. (address / 0x7C00)
+	 * @return Index in sectorCache, or -1 if not cached.
+	 */
+	int findCachedSector(uint32_t sector_num) const;
+
+	/**
+	 * Get a decrypted sector, using the sector cache if possible.
+	 * @param sector_num Sector number. (address / 0x7C00)
+	 * @return Pointer to the decrypted sector, or nullptr on error.
+	 */
+	const EncSector_t *getSector(uint32_t sector_num);
+
+	/**
+	 * Read and decrypt contiguous sectors.
+	 * The sectors are read using a single read() call,
+	 * then decrypted one after another.
+	 *
+	 * @param pSectors	[out] Output buffer (count sectors)
+	 * @param sector_num	[in] First sector number. (address / 0x7C00)
+	 * @param count		[in] Number of sectors
 	 * @return 0 on success; negative POSIX error code on error.
 	 */
-	int readSector(uint32_t sector_num);
+	int readSectors(EncSector_t *pSectors, uint32_t sector_num, unsigned int count);
 
 public:
 	/**
@@ -144,8 +187,8 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKey(WiiTicket::EncryptionKeys::Unknown)
 	, encKeyReal(WiiTicket::EncryptionKeys::Unknown)
 	, cryptoMethod(cryptoMethod)
-	, sector_num(~0)
 	, pos_7C00(-1)
+	, sectorCacheClock(0)
 {
 	// Clear data set by GcnPartition in case the
 	// partition headers can't be read.
@@ -156,6 +199,9 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	// Clear the partition header struct.
 	memset(&partitionHeader, 0, sizeof(partitionHeader));
 
+	// Clear the statistics.
+	memset(&stats, 0, sizeof(stats));
+
 	// Partition header will be read in the WiiPartition constructor.
 }
 
@@ -241,12 +287,13 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 		return verifyResult;
 	}
 
-	// readSector() needs aes_title.
+	// getSector() needs aes_title.
 	aes_title = std::move(cipher);
 
 	// Read sector 0, which contains a disc header.
-	// NOTE: readSector() doesn't check verifyResult.
-	if (readSector(0) != 0) {
+	// NOTE: getSector() doesn't check verifyResult.
+	const EncSector_t *const sector0 = getSector(0);
+	if (!sector0) {
 		// Error reading sector 0.
 		aes_title.reset();
 		verifyResult = KeyManager::VerifyResult::IAesCipherDecryptErr;
@@ -256,12 +303,12 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	// Verify that this is a Wii partition.
 	// If it isn't, the key is probably wrong.
 	const GCN_DiscHeader *const discHeader =
-		reinterpret_cast<const GCN_DiscHeader*>(sector_buf.data);
+		reinterpret_cast<const GCN_DiscHeader*>(sector0->data);
 	if (discHeader->magic_wii != cpu_to_be32(WII_MAGIC)) {
 		// Invalid disc header.
 
 		// NOTE: Debug discs may have incrementing values in update partitions.
-		if (!memcmp(sector_buf.data, incr_vals.data(), incr_vals.size())) {
+		if (!memcmp(sector0->data, incr_vals.data(), incr_vals.size())) {
 			// Found incrementing values.
 			verifyResult = KeyManager::VerifyResult::IncrementingValues;
 		} else {
@@ -285,26 +332,92 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 }
 
 /**
- * Read and decrypt a sector.
- * The decrypted sector is stored in sector_buf.
- *
+ * Find a sector in the decrypted sector cache.
  * @param sector_num Sector number. (address / 0x7C00)
- * @return 0 on success; negative POSIX error code on error.
+ * @return Index in sectorCache, or -1 if not cached.
  */
-int WiiPartitionPrivate::readSector(uint32_t sector_num)
+int WiiPartitionPrivate::findCachedSector(uint32_t sector_num) const
 {
-	if (this->sector_num == sector_num) {
+	// NOTE: The sector cache is small enough that
+	// a linear search is faster than a hash table.
+	const int count = static_cast<int>(sectorCache.size());
+	for (int i = 0; i < count; i++) {
+		if (sectorCache[i].sector_num == sector_num) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Get a decrypted sector, using the sector cache if possible.
+ * @param sector_num Sector number. (address / 0x7C00)
+ * @return Pointer to the decrypted sector, or nullptr on error.
+ */
+const WiiPartitionPrivate::EncSector_t *WiiPartitionPrivate::getSector(uint32_t sector_num)
+{
+	const int idx = findCachedSector(sector_num);
+	if (idx >= 0) {
 		// Sector is already in memory.
-		return 0;
+		stats.hits++;
+		SectorCacheEntry &entry = sectorCache[idx];
+		entry.last_used = ++sectorCacheClock;
+		return &entry.sector;
+	}
+
+	// Sector is not cached.
+	// Allocate a new entry if the cache isn't full.
+	// Otherwise, reuse the least recently used entry.
+	SectorCacheEntry *pEntry;
+	if (sectorCache.size() < SECTOR_CACHE_COUNT) {
+		if (sectorCache.empty()) {
+			// NOTE: Reserving the full cache size ensures that
+			// pointers to entries won't be invalidated.
+			sectorCache.reserve(SECTOR_CACHE_COUNT);
+		}
+		sectorCache.emplace_back();
+		pEntry = &sectorCache.back();
+	} else {
+		pEntry = &sectorCache[0];
+		for (SectorCacheEntry &entry : sectorCache) {
+			if (entry.last_used < pEntry->last_used) {
+				pEntry = &entry;
+			}
+		}
+	}
+
+	if (readSectors(&pEntry->sector, sector_num, 1) != 0) {
+		// The sector buffer may be invalid.
+		pEntry->sector_num = ~0U;
+		pEntry->last_used = 0;
+		return nullptr;
 	}
 
+	// Sector read and decrypted.
+	pEntry->sector_num = sector_num;
+	pEntry->last_used = ++sectorCacheClock;
+	return &pEntry->sector;
+}
+
+/**
+ * Read and decrypt contiguous sectors.
+ * The sectors are read using a single read() call,
+ * then decrypted one after another.
+ *
+ * @param pSectors	[out] Output buffer (count sectors)
+ * @param sector_num	[in] First sector number. (address / 0x7C00)
+ * @param count		[in] Number of sectors
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartitionPrivate::readSectors(EncSector_t *pSectors, uint32_t sector_num, unsigned int count)
+{
 	RP_Q(WiiPartition);
 	const bool isCrypted = ((cryptoMethod & WiiPartition::CM_MASK_ENCRYPTED) == WiiPartition::CM_ENCRYPTED);
 #ifndef ENABLE_DECRYPTION
 	if (isCrypted) {
 		// Decryption is disabled.
 		q->m_lastError = EIO;
-		return -1;
+		return -EIO;
 	}
 #endif /* !ENABLE_DECRYPTION */
 
@@ -314,36 +427,36 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	off64_t sector_addr = partition_offset + data_offset;
 	sector_addr += (static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
 
-	int ret = q->m_file->seek(sector_addr);
-	if (ret != 0) {
-		q->m_lastError = q->m_file->lastError();
-		return ret;
-	}
-
-	size_t sz = q->m_file->read(&sector_buf, sizeof(sector_buf));
-	if (sz != sizeof(sector_buf)) {
-		// sector_buf may be invalid.
-		this->sector_num = ~0;
+	const size_t read_sz = static_cast<size_t>(count) * SECTOR_SIZE_ENCRYPTED;
+	size_t sz = q->m_file->seekAndRead(sector_addr, pSectors, read_sz);
+	if (sz != read_sz) {
 		q->m_lastError = EIO;
-		return -1;
+		return -EIO;
 	}
+	stats.sectorsRead += count;
 
 #ifdef ENABLE_DECRYPTION
 	if (isCrypted) {
-		// Decrypt the sector.
-		if (aes_title->decrypt(sector_buf.data, sizeof(sector_buf.data),
-		    &sector_buf.hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
-		{
-			// sector_buf may be invalid.
-			this->sector_num = ~0;
-			q->m_lastError = EIO;
-			return -1;
+		// Decrypt the sectors.
+		// Each sector has its own IV, so the sectors
+		// must be decrypted separately.
+		for (unsigned int i = 0; i < count; i++) {
+			EncSector_t &sector = pSectors[i];
+			if (aes_title->decrypt(sector.data, sizeof(sector.data),
+			    &sector.hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
+			{
+				q->m_lastError = EIO;
+				return -EIO;
+			}
 		}
+		stats.sectorsDecrypted += count;
 	}
 #endif /* ENABLE_DECRYPTION */
 
-	// Sector read and decrypted.
-	this->sector_num = sector_num;
+	// Sectors read and decrypted.
+	if (count > 1) {
+		stats.batchReads++;
+	}
 	return 0;
 }
 
@@ -450,7 +563,7 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		return 0;
 	}
 
-	// TODO: Consolidate this code and optimize it.
+	// TODO: Consolidate this code.
 	size_t ret = 0;
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 
@@ -477,12 +590,16 @@ size_t WiiPartition::read(void *ptr, size_t size)
 				read_sz = static_cast<uint32_t>(size);
 			}
 
-			// Read and decrypt the sector.
+			// Read the sector.
 			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
+			const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(blockStart);
+			if (!sector) {
+				// Error reading the sector.
+				return ret;
+			}
 
 			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.fulldata[blockStartOffset], read_sz);
+			memcpy(ptr8, &sector->fulldata[blockStartOffset], read_sz);
 
 			// Starting block read.
 			size -= read_sz;
@@ -492,18 +609,26 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		}
 
 		// Read entire blocks.
-		for (; size >= WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED;
-		     size -= WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED, ptr8 += WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED,
-		     ret += WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED, d->pos_7C00 += WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED)
-		{
+		// The sectors don't have hashes, so they can be read
+		// directly into the output buffer.
+		if (size >= WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED) {
 			assert(d->pos_7C00 % WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED == 0);
+			const size_t read_sz = size - (size % WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
+			const size_t sz = m_file->seekAndRead(d->partition_offset + d->data_offset + d->pos_7C00, ptr8, read_sz);
+			d->stats.sectorsRead += (sz / WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
+			if (read_sz > WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED) {
+				d->stats.batchReads++;
+			}
 
-			// Read the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
+			size -= sz;
+			ptr8 += sz;
+			ret += sz;
+			d->pos_7C00 += sz;
+			if (sz != read_sz) {
+				// Short read.
+				m_lastError = EIO;
+				return ret;
+			}
 		}
 
 		// Check if we still have data left. (not a full block)
@@ -513,10 +638,14 @@ size_t WiiPartition::read(void *ptr, size_t size)
 			// Read the sector.
 			assert(d->pos_7C00 % WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED == 0);
 			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockEnd);
+			const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(blockEnd);
+			if (!sector) {
+				// Error reading the sector.
+				return ret;
+			}
 
 			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, size);
+			memcpy(ptr8, sector->fulldata, size);
 
 			ret += size;
 			d->pos_7C00 += size;
@@ -549,7 +678,7 @@ size_t WiiPartition::read(void *ptr, size_t size)
 #else /* !ENABLE_DECRYPTION */
 			// Decryption is not enabled.
 			m_lastError = EIO;
-			ret = 0;
+			return 0;
 #endif /* ENABLE_DECRYPTION */
 		}
 
@@ -565,10 +694,14 @@ size_t WiiPartition::read(void *ptr, size_t size)
 
 			// Read and decrypt the sector.
 			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
+			const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(blockStart);
+			if (!sector) {
+				// Error reading the sector.
+				return ret;
+			}
 
 			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.data[blockStartOffset], read_sz);
+			memcpy(ptr8, &sector->data[blockStartOffset], read_sz);
 
 			// Starting block read.
 			size -= read_sz;
@@ -578,18 +711,56 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		}
 
 		// Read entire blocks.
-		for (; size >= WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED;
-		    size -= WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED, ptr8 += WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED,
-		    ret += WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED, d->pos_7C00 += WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED)
-		{
+		while (size >= WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED) {
 			assert(d->pos_7C00 % WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED == 0);
-
-			// Read and decrypt the sector.
 			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
 
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
+			// If this sector isn't cached, check how many of the
+			// following sectors also aren't cached. These sectors
+			// will be read at once and decrypted back to back.
+			unsigned int count = 1;
+			if (d->findCachedSector(blockStart) < 0) {
+				const unsigned int max_count = static_cast<unsigned int>(std::min<size_t>(
+					size / WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED,
+					WiiPartitionPrivate::SECTOR_BATCH_COUNT));
+				while (count < max_count && d->findCachedSector(blockStart + count) < 0) {
+					count++;
+				}
+			}
+
+			if (count == 1) {
+				// Read and decrypt the sector.
+				const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(blockStart);
+				if (!sector) {
+					// Error reading the sector.
+					return ret;
+				}
+
+				// Copy data from the sector.
+				memcpy(ptr8, sector->data, WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
+			} else {
+				// Read and decrypt multiple sectors.
+				// NOTE: These sectors are not added to the sector cache.
+				if (!d->batchBuf) {
+					d->batchBuf.reset(new WiiPartitionPrivate::EncSector_t[WiiPartitionPrivate::SECTOR_BATCH_COUNT]);
+				}
+				if (d->readSectors(d->batchBuf.get(), blockStart, count) != 0) {
+					// Error reading the sectors.
+					return ret;
+				}
+
+				// Copy data from the sectors.
+				uint8_t *dest = ptr8;
+				for (unsigned int i = 0; i < count; i++, dest += WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED) {
+					memcpy(dest, d->batchBuf[i].data, WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
+				}
+			}
+
+			const size_t read_sz = static_cast<size_t>(count) * WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED;
+			size -= read_sz;
+			ptr8 += read_sz;
+			ret += read_sz;
+			d->pos_7C00 += read_sz;
 		}
 
 		// Check if we still have data left. (not a full block)
@@ -599,10 +770,14 @@ size_t WiiPartition::read(void *ptr, size_t size)
 			// Read and decrypt the sector.
 			assert(d->pos_7C00 % WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED == 0);
 			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / WiiPartitionPrivate::SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockEnd);
+			const WiiPartitionPrivate::EncSector_t *const sector = d->getSector(blockEnd);
+			if (!sector) {
+				// Error reading the sector.
+				return ret;
+			}
 
 			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, size);
+			memcpy(ptr8, sector->data, size);
 
 			ret += size;
 			d->pos_7C00 += size;
@@ -760,4 +935,14 @@ Nintendo_TitleID_BE_t WiiPartition::titleID(void) const
 	return d->partitionHeader.ticket.title_id;
 }
 
+/**
+ * Get decrypted sector cache statistics.
+ * @return Sector cache statistics
+ */
+WiiPartition::SectorCacheStats WiiPartition::sectorCacheStats(void) const
+{
+	RP_D(const WiiPartition);
+	return d->stats;
+}
+
 } // namespace LibRomData
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "librpbase/config.librpbase.h"
+#include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
 #include "GcnPartition.hpp"
 #include "../Console/wii_structs.h"
 
@@ -50,6 +51,7 @@ public:
 	 * @param partition_size	[in] Calculated partition size. Used if the size in the header is 0.
 	 * @param cryptoMethod		[in] Crypto method
 	 */
+	RP_LIBROMDATA_PUBLIC
 	WiiPartition(const LibRpBase::IDiscReaderPtr &discReader, off64_t partition_offset,
 		off64_t partition_size, CryptoMethod crypto = CM_STANDARD);
 
@@ -136,6 +138,22 @@ public:
 	 * @return Title ID. (0-0 if unavailable)
 	 */
 	Nintendo_TitleID_BE_t titleID(void) const;
+
+	// Decrypted sector cache
+
+	struct SectorCacheStats {
+		uint64_t hits;			// Number of sectors read from the sector cache
+		uint64_t sectorsRead;		// Number of sectors read from the disc image
+		uint64_t sectorsDecrypted;	// Number of sectors decrypted
+		uint64_t batchReads;		// Number of multi-sector reads
+	};
+
+	/**
+	 * Get decrypted sector cache statistics.
+	 * @return Sector cache statistics
+	 */
+	RP_LIBROMDATA_PUBLIC
+	SectorCacheStats sectorCacheStats(void) const;
 };
 
 typedef std::shared_ptr<WiiPartition> WiiPartitionPtr;
@@ -23,10 +23,10 @@ using namespace LibRpText;
 
 // C++ STL classes
 #include <unordered_map>
-#include <unordered_set>
 using std::string;
 using std::unordered_map;
-using std::unordered_set;
+
+#include "FstPathIndex.hpp"
 
 namespace LibRomData {
 
@@ -65,6 +65,9 @@ public:
 	// - Value: UTF-8 string
 	mutable unordered_map<uint32_t, string> u8_string_table;
 
+	// Path lookup index. Built on the first find_path() call.
+	mutable FstPathIndex<WiiUFstPrivate, WUP_FST_Entry> pathIndex;
+
 	/**
 	 * Check if an fst_entry is a directory.
 	 * @return True if this is a directory; false if it's a regular file.
@@ -281,133 +284,19 @@ const WUP_FST_Entry *WiiUFstPrivate::entry(int idx, const char **ppszName) const
  */
 const WUP_FST_Entry *WiiUFstPrivate::find_path(const char *path) const
 {
-	if (!path) {
-		// Invalid path.
+	if (!path || !fstEntries) {
+		// Invalid path, or no FST.
 		return nullptr;
 	}
 
-	// Get the root directory.
-	const WUP_FST_Entry *fst_entry = this->entry(0, nullptr);
-	if (!fst_entry) {
-		// Can't find the root directory.
-		return nullptr;
+	// Build the path index if it hasn't been built yet.
+	if (!pathIndex.isBuilt()) {
+		pathIndex.build(this, fstEntries, be32_to_cpu(fstEntries[0].root_dir.file_count),
+			string_table_ptr, string_table_sz);
 	}
 
-	if (!path[0] || (path[0] == '/' && !path[1])) {
-		// Empty path or "/".
-		// Return the root directory.
-		return fst_entry;
-	}
-
-	// Store the path as a temporary string.
-	string s_path;
-	if (path[0] != '/') {
-		// Prepend a slash.
-		// (Relative paths aren't supported.)
-		s_path = '/';
-	}
-	s_path.append(path);
-
-	// Remove trailing slashes.
-	while (s_path.size() > 1 && s_path[s_path.size()-1] == '/') {
-		s_path.resize(s_path.size()-1);
-	}
-	if (s_path.empty() || s_path == "/") {
-		// After removing all trailing slashes, we have the root directory.
-		return fst_entry;
-	}
-
-	// Set of directory indexes that have already been processed.
-	// Used to prevent infinite loops if the FST has weird corruption.
-	std::unordered_set<int> idx_already;
-
-	// Skip the initial slash.
-	int idx = 1;	// Ignore the root directory.
-	// NOTE: This is the index *after* the last file.
-	int last_fst_idx = be32_to_cpu(fst_entry->root_dir.file_count);
-	size_t slash_pos = 0;
-	do {
-		const size_t next_slash_pos = s_path.find('/', slash_pos + 1);
-		string path_component;
-		bool are_more_slashes = true;
-		if (next_slash_pos == string::npos) {
-			// No more slashes.
-			are_more_slashes = false;
-			path_component = s_path.substr(slash_pos + 1);
-		} else {
-			// Found another slash.
-			int sz = static_cast<int>(next_slash_pos - slash_pos - 1);
-			if (sz <= 0) {
-				// Empty path component.
-				slash_pos = next_slash_pos;
-				continue;
-			}
-			path_component = s_path.substr(slash_pos + 1, static_cast<size_t>(sz));
-		}
-
-		if (path_component.empty()) {
-			// Empty path component.
-			slash_pos = next_slash_pos;
-			continue;
-		}
-
-		// Search this directory for a matching path component.
-		idx_already.clear();
-		bool found = false;
-		for (; idx < last_fst_idx; idx++) {
-			auto iter = idx_already.find(idx);
-			if (iter != idx_already.end()) {
-				// Something is wrong! We've already iterated over this directory.
-				return nullptr;
-			}
-			idx_already.insert(idx);
-
-			const char *pName;
-			fst_entry = this->entry(idx, &pName);
-			if (!fst_entry) {
-				// Invalid path.
-				return nullptr;
-			}
-
-			// TODO: Is Wii U case-sensitive?
-			if (pName && !strcmp(path_component.c_str(), pName)) {
-				// Found a match.
-				found = true;
-				break;
-			}
-
-			// If this is a directory, skip it.
-			if (is_dir(fst_entry)) {
-				// NOTE: next_offset is the index *after* the
-				// last entry in the subdirectory, so we have to
-				// subtract 1 for proper enumeration.
-				idx = be32_to_cpu(fst_entry->dir.next_offset) - 1;
-			}
-		}
-
-		if (!found) {
-			// No match.
-			return nullptr;
-		}
-
-		if (is_dir(fst_entry)) {
-			// Directory. Save the last_fst_idx.
-			last_fst_idx = be32_to_cpu(fst_entry->dir.next_offset);
-			idx++;
-		} else {
-			// File: Make sure there's no more slashes.
-			if (are_more_slashes) {
-				// More slashes. Not a match.
-				return nullptr;
-			}
-		}
-
-		// Next slash.
-		slash_pos = next_slash_pos;
-	} while (slash_pos != string::npos);
-
-	// Found the directory entry.
-	return fst_entry;
+	const int idx = pathIndex.find(this, fstEntries, string_table_ptr, path);
+	return (idx >= 0) ? &fstEntries[idx] : nullptr;
 }
 
 /** WiiUFst **/
@@ -0,0 +1,868 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheIndex.cpp: Download cache index with size-bounded LRU eviction.    *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "libromdata/config.libromdata.h"
+#include "CacheIndex.hpp"
+
+// Other rom-properties libraries
+#include "libcachecommon/CacheDir.hpp"
+#include "librpbase/config/Config.hpp"
+#include "librpfile/FileSystem.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+#ifndef _WIN32
+// C includes
+#  include <dirent.h>	// opendir(), readdir()
+#  include <fcntl.h>	// open(), fstatat()
+#  include <sys/file.h>	// flock()
+#  include <sys/stat.h>	// stat(), fstat()
+#  include <unistd.h>	// close(), read(), write(), unlink()
+#endif /* !_WIN32 */
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+// C++ STL classes
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData { namespace CacheIndex {
+
+#ifndef _WIN32
+
+/** On-disk index format **/
+
+// The index is a single file in the cache directory.
+// Writers never modify an existing index; instead, a new index is
+// written to a temporary file and renamed over the old one, so the
+// header can always be read without taking a lock.
+//
+// Layout:
+// - CacheIndexHeader
+// - Entries, sorted by last access time (oldest first):
+//   - CacheIndexEntry
+//   - char[path_len]: Path relative to the cache directory (not NULL-terminated)
+//
+// All values are in host byte order, since the index is
+// never shared between systems.
+
+static constexpr char CACHEINDEX_MAGIC[8] = {'R','P','C','A','I','D','X','\0'};
+static constexpr uint32_t CACHEINDEX_VERSION = 1;
+static constexpr uint32_t CACHEINDEX_BYTEORDER = 0x01020304U;
+
+struct CacheIndexHeader {
+	char magic[8];		// CACHEINDEX_MAGIC
+	uint32_t version;	// CACHEINDEX_VERSION
+	uint32_t byteorder;	// CACHEINDEX_BYTEORDER
+	uint32_t entry_count;	// Number of entries
+	uint32_t reserved;
+	uint64_t total_size;	// Total size of all entries, in bytes
+};
+ASSERT_STRUCT(CacheIndexHeader, 32);
+
+struct CacheIndexEntry {
+	uint64_t size;		// File size, in bytes
+	int64_t atime;		// Last access time (Unix time)
+	uint32_t path_len;	// Length of the relative path
+	uint32_t reserved;
+};
+ASSERT_STRUCT(CacheIndexEntry, 24);
+
+// Index file limits
+static constexpr uint32_t MAX_ENTRIES = 1048576;
+static constexpr uint32_t MAX_PATH_LEN = 1024;
+static constexpr unsigned int MAX_SCAN_DEPTH = 8;
+
+// Number of pending accesses before the index is rewritten.
+static constexpr size_t FLUSH_THRESHOLD = 64;
+// Maximum time pending accesses are kept in memory, in seconds.
+static constexpr time_t MAX_FLUSH_INTERVAL = 5;
+
+// Maximum number of files deleted by automatic eviction per flush.
+// Eviction is incremental so no single access has to pay for
+// shrinking a cache that's far over its limit.
+static constexpr unsigned int MAX_EVICTIONS_PER_FLUSH = 256;
+
+/** In-memory state **/
+
+/**
+ * Index entry.
+ */
+struct IndexEntry {
+	string path;		// Path relative to the cache directory
+	uint64_t size;		// File size, in bytes
+	int64_t atime;		// Last access time (Unix time)
+	bool pinned;		// Accessed in this flush; never evicted
+};
+
+/**
+ * Access that hasn't been written to the index yet.
+ */
+struct PendingAccess {
+	uint64_t size;
+	int64_t atime;
+};
+
+/**
+ * Batch of pending accesses to be written to the index.
+ * The batch is taken with mtx locked, then written with mtx
+ * unlocked so other threads aren't blocked on disk I/O.
+ */
+struct FlushBatch {
+	string cacheDir;	// Cache directory (no trailing slash)
+	uint64_t sizeLimit;	// Size limit, in bytes (0 for unlimited)
+	unordered_map<string, PendingAccess> accesses;
+};
+
+// Mutex protecting the in-memory state.
+// NOTE: The index file lock is used to serialize writers,
+// both within this process and between processes.
+static std::mutex mtx;
+
+static string cacheDir;			// Cache directory (no trailing slash)
+static bool cacheDirInit = false;	// Has cacheDir been initialized?
+static bool sizeLimitOverride = false;	// Was the size limit set by setCacheDirectory()?
+static uint64_t sizeLimit = 0;		// Size limit, in bytes (0 for unlimited)
+static unordered_map<string, PendingAccess> pending;
+static time_t lastFlushTime = 0;	// Time of the last flush
+static Stats cacheStats;
+
+/**
+ * Initialize the cache directory, if it hasn't been initialized yet.
+ * Must be called with mtx locked.
+ * @return True if the cache directory is usable; false if not.
+ */
+static bool initCacheDir(void)
+{
+	if (!cacheDirInit) {
+		cacheDir = LibCacheCommon::getCacheDirectory();
+		while (!cacheDir.empty() && cacheDir.back() == '/') {
+			cacheDir.resize(cacheDir.size() - 1);
+		}
+		cacheDirInit = true;
+		lastFlushTime = time(nullptr);
+	}
+	return !cacheDir.empty();
+}
+
+/**
+ * Get the configured size limit, in bytes.
+ * NOTE: Must *not* be called with mtx locked, since this may
+ * load the configuration file.
+ * @return Size limit, in bytes (0 for unlimited)
+ */
+static uint64_t configSizeLimit(void)
+{
+	const Config *const config = Config::instance();
+	return static_cast<uint64_t>(config->cacheSizeLimit()) * 1024U * 1024U;
+}
+
+/**
+ * Is a relative path safe to use for deleting files?
+ * @param path Relative path
+ * @return True if safe; false if not.
+ */
+static bool isSafeRelativePath(const string &path)
+{
+	if (path.empty() || path.size() > MAX_PATH_LEN || path[0] == '/') {
+		return false;
+	}
+	// Don't allow ".." path components.
+	size_t pos = 0;
+	while (pos < path.size()) {
+		size_t slash = path.find('/', pos);
+		if (slash == string::npos) {
+			slash = path.size();
+		}
+		if (slash - pos == 2 && path[pos] == '.' && path[pos+1] == '.') {
+			return false;
+		}
+		pos = slash + 1;
+	}
+	return true;
+}
+
+/**
+ * Write a buffer to a file descriptor, handling partial writes.
+ * @param fd File descriptor
+ * @param buf Buffer
+ * @param size Size of buf
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int writeAll(int fd, const void *buf, size_t size)
+{
+	const uint8_t *p = static_cast<const uint8_t*>(buf);
+	while (size > 0) {
+		const ssize_t ret = write(fd, p, size);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += ret;
+		size -= static_cast<size_t>(ret);
+	}
+	return 0;
+}
+
+/**
+ * Read the on-disk index.
+ * Must be called with the index file lock held.
+ * Invalid or missing index files are treated as empty.
+ * @param dir		[in] Cache directory
+ * @param entries	[out] Index entries
+ */
+static void readIndex(const string &dir, vector<IndexEntry> &entries)
+{
+	entries.clear();
+	const string indexFilename = dir + "/cache.idx";
+	const int fd = open(indexFilename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat sb;
+	if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode) ||
+	    sb.st_size < static_cast<off_t>(sizeof(CacheIndexHeader)) ||
+	    sb.st_size > static_cast<off_t>(MAX_ENTRIES * (sizeof(CacheIndexEntry) + MAX_PATH_LEN)))
+	{
+		close(fd);
+		return;
+	}
+
+	string buf;
+	buf.resize(static_cast<size_t>(sb.st_size));
+	size_t pos = 0;
+	while (pos < buf.size()) {
+		const ssize_t ret = read(fd, &buf[pos], buf.size() - pos);
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		} else if (ret <= 0) {
+			break;
+		}
+		pos += static_cast<size_t>(ret);
+	}
+	close(fd);
+	if (pos != buf.size()) {
+		return;
+	}
+
+	CacheIndexHeader header;
+	memcpy(&header, buf.data(), sizeof(header));
+	if (memcmp(header.magic, CACHEINDEX_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != CACHEINDEX_VERSION ||
+	    header.byteorder != CACHEINDEX_BYTEORDER ||
+	    header.entry_count > MAX_ENTRIES)
+	{
+		// Invalid index file.
+		return;
+	}
+
+	entries.reserve(header.entry_count);
+	pos = sizeof(header);
+	for (uint32_t i = 0; i < header.entry_count; i++) {
+		CacheIndexEntry entry;
+		if (buf.size() - pos < sizeof(entry)) {
+			break;
+		}
+		memcpy(&entry, &buf[pos], sizeof(entry));
+		pos += sizeof(entry);
+		if (entry.path_len > MAX_PATH_LEN || buf.size() - pos < entry.path_len) {
+			break;
+		}
+
+		IndexEntry ie;
+		ie.path.assign(&buf[pos], entry.path_len);
+		pos += entry.path_len;
+		if (!isSafeRelativePath(ie.path)) {
+			continue;
+		}
+		ie.size = entry.size;
+		ie.atime = entry.atime;
+		ie.pinned = false;
+		entries.push_back(std::move(ie));
+	}
+}
+
+/**
+ * Write the on-disk index.
+ * Must be called with the index file lock held.
+ * @param dir		[in] Cache directory
+ * @param entries	[in] Index entries (sorted by last access time)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int writeIndex(const string &dir, const vector<IndexEntry> &entries)
+{
+	CacheIndexHeader header;
+	memcpy(header.magic, CACHEINDEX_MAGIC, sizeof(header.magic));
+	header.version = CACHEINDEX_VERSION;
+	header.byteorder = CACHEINDEX_BYTEORDER;
+	header.entry_count = static_cast<uint32_t>(entries.size());
+	header.reserved = 0;
+	header.total_size = 0;
+
+	string buf;
+	buf.resize(sizeof(header));
+	for (const IndexEntry &ie : entries) {
+		CacheIndexEntry entry;
+		entry.size = ie.size;
+		entry.atime = ie.atime;
+		entry.path_len = static_cast<uint32_t>(ie.path.size());
+		entry.reserved = 0;
+		buf.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		buf += ie.path;
+		header.total_size += ie.size;
+	}
+	memcpy(&buf[0], &header, sizeof(header));
+
+	// Write the new index to a temporary file, then rename it over the old index.
+	const string indexFilename = dir + "/cache.idx";
+	string tmpFilename = indexFilename + ".XXXXXX";
+	const int fd = mkstemp(&tmpFilename[0]);
+	if (fd < 0) {
+		return -errno;
+	}
+	int ret = writeAll(fd, buf.data(), buf.size());
+	if (close(fd) != 0 && ret == 0) {
+		ret = -errno;
+	}
+	if (ret == 0 && rename(tmpFilename.c_str(), indexFilename.c_str()) != 0) {
+		ret = -errno;
+	}
+	if (ret != 0) {
+		unlink(tmpFilename.c_str());
+	}
+	return ret;
+}
+
+/**
+ * Lock the index file to serialize writers.
+ * Must *not* be called with mtx locked.
+ * @param dir		[in] Cache directory
+ * @return Lock file descriptor on success; negative POSIX error code on error.
+ */
+static int lockIndex(const string &dir)
+{
+	// Make sure the cache directory exists.
+	const string lockFilename = dir + "/cache.idx.lock";
+	int ret = FileSystem::rmkdir(lockFilename);
+	if (ret != 0) {
+		return ret;
+	}
+
+	const int lockfd = open(lockFilename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (lockfd < 0) {
+		return -errno;
+	}
+	if (flock(lockfd, LOCK_EX) != 0) {
+		ret = -errno;
+		close(lockfd);
+		return ret;
+	}
+	return lockfd;
+}
+
+/**
+ * Take the pending accesses as a batch to be written by update_int().
+ * Must be called with mtx locked.
+ *
+ * Pending accesses are discarded even if the index can't be written.
+ *
+ * @param batch		[out] Flush batch
+ */
+static void takeBatch_int(FlushBatch &batch)
+{
+	lastFlushTime = time(nullptr);
+	batch.cacheDir = cacheDir;
+	batch.sizeLimit = sizeLimit;
+	batch.accesses.clear();
+	batch.accesses.swap(pending);
+}
+
+/**
+ * Merge a batch of accesses into the on-disk index, and delete
+ * least-recently used files if the cache is over the limit.
+ * Must *not* be called with mtx locked.
+ *
+ * @param batch		[in] Flush batch from takeBatch_int()
+ * @param pTrimSize	[in,opt] If set, trim the cache to this size with no eviction limit.
+ * @return Number of files deleted on success; negative POSIX error code on error.
+ */
+static int update_int(FlushBatch &batch, const uint64_t *pTrimSize)
+{
+	if (batch.cacheDir.empty()) {
+		return -ENOENT;
+	}
+
+	const int lockfd = lockIndex(batch.cacheDir);
+	if (lockfd < 0) {
+		return lockfd;
+	}
+
+	// Merge with the latest version of the index.
+	// NOTE: Another thread may have written a newer batch after
+	// this one was taken, so keep the newer access time.
+	unordered_map<string, PendingAccess> &toWrite = batch.accesses;
+	vector<IndexEntry> entries;
+	readIndex(batch.cacheDir, entries);
+	entries.erase(std::remove_if(entries.begin(), entries.end(),
+		[&toWrite](const IndexEntry &ie) {
+			// Superseded by a pending access?
+			auto iter = toWrite.find(ie.path);
+			if (iter == toWrite.end()) {
+				return false;
+			}
+			if (iter->second.atime < ie.atime) {
+				iter->second.size = ie.size;
+				iter->second.atime = ie.atime;
+			}
+			return true;
+		}), entries.end());
+	for (auto &p : toWrite) {
+		if (entries.size() >= MAX_ENTRIES)
+			break;
+		entries.push_back({p.first, p.second.size, p.second.atime, true});
+	}
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const IndexEntry &a, const IndexEntry &b) {
+			return a.atime < b.atime;
+		});
+
+	uint64_t totalSize = 0;
+	for (const IndexEntry &ie : entries) {
+		totalSize += ie.size;
+	}
+
+	// Evict least-recently used files if the cache is over the limit.
+	// Automatic eviction trims to 90% of the limit so it doesn't
+	// have to run again on the next flush.
+	uint64_t limit, target;
+	unsigned int maxEvictions;
+	if (pTrimSize) {
+		limit = *pTrimSize;
+		target = limit;
+		maxEvictions = ~0U;
+	} else {
+		limit = batch.sizeLimit;
+		target = limit - (limit / 10);
+		maxEvictions = MAX_EVICTIONS_PER_FLUSH;
+	}
+
+	int evicted = 0;
+	if ((limit != 0 || pTrimSize) && totalSize > limit) {
+		string filename;
+		size_t i;
+		for (i = 0; i < entries.size() && totalSize > target &&
+		     static_cast<unsigned int>(evicted) < maxEvictions; i++)
+		{
+			IndexEntry &ie = entries[i];
+			if (ie.pinned && !pTrimSize) {
+				// Don't delete files that were just accessed.
+				continue;
+			}
+
+			filename = batch.cacheDir;
+			filename += '/';
+			filename += ie.path;
+			if (unlink(filename.c_str()) == 0) {
+				evicted++;
+			} else if (errno != ENOENT) {
+				// Unable to delete the file. Keep it in the index.
+				continue;
+			}
+			totalSize -= ie.size;
+			ie.path.clear();
+		}
+		entries.erase(std::remove_if(entries.begin(), entries.begin() + i,
+			[](const IndexEntry &ie) { return ie.path.empty(); }),
+			entries.begin() + i);
+	}
+
+	int ret = writeIndex(batch.cacheDir, entries);
+	close(lockfd);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	cacheStats.evictions += evicted;
+	if (ret == 0) {
+		cacheStats.flushes++;
+		ret = evicted;
+	}
+	return ret;
+}
+
+/**
+ * Write pending accesses when the process exits.
+ * NOTE: Declared after the state variables so it's destroyed first.
+ */
+static struct FlushOnExit {
+	~FlushOnExit()
+	{
+		FlushBatch batch;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (pending.empty()) {
+				return;
+			}
+			takeBatch_int(batch);
+		}
+		update_int(batch, nullptr);
+	}
+} flushOnExit;
+
+/**
+ * Record an access to a file in the download cache.
+ * The file's current size is used, so this should be called
+ * after the file has been downloaded.
+ *
+ * @param cache_filename Absolute path to the cached file
+ */
+void touch(const char *cache_filename)
+{
+	assert(cache_filename != nullptr);
+	if (!cache_filename || cache_filename[0] == '\0') {
+		return;
+	}
+
+	struct stat sb;
+	if (stat(cache_filename, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		// Only regular files are indexed.
+		return;
+	}
+
+	// NOTE: Getting the size limit here instead of in update_int(),
+	// since the configuration may have been unloaded by the time
+	// pending accesses are written on exit.
+	const uint64_t newSizeLimit = configSizeLimit();
+
+	FlushBatch batch;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!initCacheDir()) {
+			// No cache directory.
+			return;
+		}
+		if (!sizeLimitOverride) {
+			sizeLimit = newSizeLimit;
+		}
+
+		// Get the path relative to the cache directory.
+		const size_t cacheDirLen = cacheDir.size();
+		if (strncmp(cache_filename, cacheDir.c_str(), cacheDirLen) != 0 ||
+		    cache_filename[cacheDirLen] != '/')
+		{
+			// Not in the cache directory.
+			return;
+		}
+		string path(&cache_filename[cacheDirLen + 1]);
+		if (!isSafeRelativePath(path)) {
+			return;
+		}
+
+		PendingAccess &access = pending[std::move(path)];
+		access.size = static_cast<uint64_t>(sb.st_size);
+		access.atime = static_cast<int64_t>(time(nullptr));
+		cacheStats.touches++;
+
+		if (pending.size() < FLUSH_THRESHOLD &&
+		    time(nullptr) - lastFlushTime < MAX_FLUSH_INTERVAL)
+		{
+			// Not time to flush yet.
+			return;
+		}
+		takeBatch_int(batch);
+	}
+
+	// Write the batch without holding mtx.
+	update_int(batch, nullptr);
+}
+
+/**
+ * Write pending accesses to the on-disk index, and delete
+ * least-recently used files if the cache is over its size limit.
+ *
+ * This is done automatically once enough accesses are pending,
+ * and when the process exits.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int flush(void)
+{
+	FlushBatch batch;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (pending.empty()) {
+			return 0;
+		}
+		takeBatch_int(batch);
+	}
+	const int ret = update_int(batch, nullptr);
+	return (ret < 0 ? ret : 0);
+}
+
+/**
+ * Get the current cache usage.
+ * Pending accesses are written first. Only the index header is read.
+ *
+ * @param usage	[out] Cache usage
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int getUsage(Usage &usage)
+{
+	usage.totalSize = 0;
+	usage.fileCount = 0;
+
+	FlushBatch batch;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!initCacheDir()) {
+			return -ENOENT;
+		}
+		takeBatch_int(batch);
+	}
+	if (!batch.accesses.empty()) {
+		update_int(batch, nullptr);
+	}
+
+	const string indexFilename = batch.cacheDir + "/cache.idx";
+	const int fd = open(indexFilename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return -errno;
+	}
+	CacheIndexHeader header;
+	const ssize_t size = read(fd, &header, sizeof(header));
+	close(fd);
+	if (size != static_cast<ssize_t>(sizeof(header)) ||
+	    memcmp(header.magic, CACHEINDEX_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != CACHEINDEX_VERSION ||
+	    header.byteorder != CACHEINDEX_BYTEORDER)
+	{
+		// Invalid index file.
+		return -EIO;
+	}
+
+	usage.totalSize = header.total_size;
+	usage.fileCount = header.entry_count;
+	return 0;
+}
+
+/**
+ * Delete least-recently used files until the cache is at most maxSize bytes.
+ * Unlike automatic eviction, there is no limit on the number of files deleted.
+ *
+ * @param maxSize	[in] Maximum cache size, in bytes
+ * @return Number of files deleted on success; negative POSIX error code on error.
+ */
+int trim(uint64_t maxSize)
+{
+	FlushBatch batch;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!initCacheDir()) {
+			return -ENOENT;
+		}
+		takeBatch_int(batch);
+	}
+	return update_int(batch, &maxSize);
+}
+
+/**
+ * Recursively scan a cache subdirectory.
+ * @param entries	[in/out] Index entries
+ * @param path		[in] Absolute path of the directory
+ * @param relPath	[in] Path relative to the cache directory
+ * @param depth		[in] Current depth
+ */
+static void scanDirectory(vector<IndexEntry> &entries, const string &path, const string &relPath, unsigned int depth)
+{
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		return;
+	}
+
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr && entries.size() < MAX_ENTRIES) {
+		if (dirent->d_name[0] == '.') {
+			// Skip ".", "..", and hidden files.
+			continue;
+		}
+
+		struct stat sb;
+		if (fstatat(dirfd(pdir), dirent->d_name, &sb, AT_SYMLINK_NOFOLLOW) != 0) {
+			continue;
+		}
+
+		string entryRelPath = relPath;
+		if (!entryRelPath.empty()) {
+			entryRelPath += '/';
+		}
+		entryRelPath += dirent->d_name;
+
+		if (S_ISDIR(sb.st_mode)) {
+			if (depth < MAX_SCAN_DEPTH) {
+				scanDirectory(entries, path + '/' + dirent->d_name, entryRelPath, depth + 1);
+			}
+		} else if (S_ISREG(sb.st_mode) && depth > 0 && isSafeRelativePath(entryRelPath)) {
+			// NOTE: Files in the top-level directory are index files, not downloads.
+			entries.push_back({std::move(entryRelPath),
+				static_cast<uint64_t>(sb.st_size),
+				static_cast<int64_t>(sb.st_mtime), false});
+		}
+	}
+	closedir(pdir);
+}
+
+/**
+ * Rebuild the index by scanning the cache directory.
+ *
+ * This is only needed for caches that were populated before the
+ * index existed, or if the index was deleted. Last access times
+ * are initialized using the files' modification times.
+ *
+ * @return Number of files indexed on success; negative POSIX error code on error.
+ */
+int rebuild(void)
+{
+	FlushBatch batch;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (!initCacheDir()) {
+			return -ENOENT;
+		}
+		takeBatch_int(batch);
+	}
+
+	const int lockfd = lockIndex(batch.cacheDir);
+	if (lockfd < 0) {
+		return lockfd;
+	}
+
+	vector<IndexEntry> entries;
+	scanDirectory(entries, batch.cacheDir, string(), 0);
+
+	// Pending accesses have more accurate access times.
+	for (IndexEntry &ie : entries) {
+		auto iter = batch.accesses.find(ie.path);
+		if (iter != batch.accesses.end()) {
+			ie.size = iter->second.size;
+			ie.atime = iter->second.atime;
+		}
+	}
+
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const IndexEntry &a, const IndexEntry &b) {
+			return a.atime < b.atime;
+		});
+	int ret = writeIndex(batch.cacheDir, entries);
+	close(lockfd);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	if (ret == 0) {
+		cacheStats.flushes++;
+		ret = static_cast<int>(entries.size());
+	}
+	return ret;
+}
+
+/**
+ * Get the cache index statistics for this process.
+ * @return Cache index statistics
+ */
+Stats stats(void)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return cacheStats;
+}
+
+/**
+ * Set the cache directory and size limit.
+ *
+ * Pending accesses are discarded. This is intended for test suites;
+ * normally, the rom-properties cache directory and the configured
+ * size limit are used.
+ *
+ * @param cacheDir	[in] Cache directory, or nullptr to use the default.
+ * @param sizeLimit	[in] Size limit in bytes (0 for unlimited); ignored if cacheDir is nullptr.
+ */
+void setCacheDirectory(const char *cacheDir, uint64_t sizeLimit)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	pending.clear();
+	cacheStats = Stats();
+	if (cacheDir) {
+		CacheIndex::cacheDir = cacheDir;
+		while (!CacheIndex::cacheDir.empty() && CacheIndex::cacheDir.back() == '/') {
+			CacheIndex::cacheDir.resize(CacheIndex::cacheDir.size() - 1);
+		}
+		cacheDirInit = true;
+		sizeLimitOverride = true;
+		CacheIndex::sizeLimit = sizeLimit;
+		lastFlushTime = time(nullptr);
+	} else {
+		CacheIndex::cacheDir.clear();
+		cacheDirInit = false;
+		sizeLimitOverride = false;
+		CacheIndex::sizeLimit = 0;
+	}
+}
+
+#else /* _WIN32 */
+
+// TODO: Windows implementation.
+// rp-download writes to the cache with a low integrity level,
+// so the index would need to be handled by rp-download.
+
+void touch(const char *cache_filename)
+{
+	RP_UNUSED(cache_filename);
+}
+
+int flush(void)
+{
+	return 0;
+}
+
+int getUsage(Usage &usage)
+{
+	usage.totalSize = 0;
+	usage.fileCount = 0;
+	return -ENOTSUP;
+}
+
+int trim(uint64_t maxSize)
+{
+	RP_UNUSED(maxSize);
+	return -ENOTSUP;
+}
+
+int rebuild(void)
+{
+	return -ENOTSUP;
+}
+
+Stats stats(void)
+{
+	return Stats();
+}
+
+void setCacheDirectory(const char *cacheDir, uint64_t sizeLimit)
+{
+	RP_UNUSED(cacheDir);
+	RP_UNUSED(sizeLimit);
+}
+
+#endif /* !_WIN32 */
+
+} } // namespace LibRomData::CacheIndex
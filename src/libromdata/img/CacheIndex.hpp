@@ -0,0 +1,137 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheIndex.hpp: Download cache index with size-bounded LRU eviction.    *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+#include "dll-macros.h"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// C++ includes
+#include <string>
+
+namespace LibRomData { namespace CacheIndex {
+
+/**
+ * The cache index records the size and last access time of each
+ * file in the download cache, so the total cache size can be
+ * determined and the least-recently used files can be deleted
+ * without scanning the cache directory.
+ *
+ * Accesses are kept in memory and merged into the on-disk index
+ * in batches. If the cache is larger than the configured limit
+ * (Config::cacheSizeLimit()) when the index is written, the
+ * least-recently used files are deleted.
+ */
+
+/**
+ * Record an access to a file in the download cache.
+ * The file's current size is used, so this should be called
+ * after the file has been downloaded.
+ *
+ * @param cache_filename Absolute path to the cached file
+ */
+RP_LIBROMDATA_PUBLIC
+void touch(const char *cache_filename);
+
+/**
+ * Record an access to a file in the download cache.
+ * The file's current size is used, so this should be called
+ * after the file has been downloaded.
+ *
+ * @param cache_filename Absolute path to the cached file
+ */
+static inline void touch(const std::string &cache_filename)
+{
+	touch(cache_filename.c_str());
+}
+
+/**
+ * Write pending accesses to the on-disk index, and delete
+ * least-recently used files if the cache is over its size limit.
+ *
+ * This is done automatically once enough accesses are pending,
+ * and when the process exits.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int flush(void);
+
+/**
+ * Cache usage.
+ */
+struct Usage {
+	uint64_t totalSize;	// Total size of all indexed files, in bytes
+	uint32_t fileCount;	// Number of indexed files
+};
+
+/**
+ * Get the current cache usage.
+ * Pending accesses are written first. Only the index header is read.
+ *
+ * @param usage	[out] Cache usage
+ * @return 0 on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int getUsage(Usage &usage);
+
+/**
+ * Delete least-recently used files until the cache is at most maxSize bytes.
+ * Unlike automatic eviction, there is no limit on the number of files deleted.
+ *
+ * @param maxSize	[in] Maximum cache size, in bytes
+ * @return Number of files deleted on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int trim(uint64_t maxSize);
+
+/**
+ * Rebuild the index by scanning the cache directory.
+ *
+ * This is only needed for caches that were populated before the
+ * index existed, or if the index was deleted. Last access times
+ * are initialized using the files' modification times.
+ *
+ * @return Number of files indexed on success; negative POSIX error code on error.
+ */
+RP_LIBROMDATA_PUBLIC
+int rebuild(void);
+
+/**
+ * Cache index statistics.
+ */
+struct Stats {
+	unsigned int touches;	// Number of recorded accesses
+	unsigned int flushes;	// Number of times the index was rewritten
+	unsigned int evictions;	// Number of files deleted by eviction
+};
+
+/**
+ * Get the cache index statistics for this process.
+ * @return Cache index statistics
+ */
+RP_LIBROMDATA_PUBLIC
+Stats stats(void);
+
+/**
+ * Set the cache directory and size limit.
+ *
+ * Pending accesses are discarded. This is intended for test suites;
+ * normally, the rom-properties cache directory and the configured
+ * size limit are used.
+ *
+ * @param cacheDir	[in] Cache directory, or nullptr to use the default.
+ * @param sizeLimit	[in] Size limit in bytes (0 for unlimited); ignored if cacheDir is nullptr.
+ */
+RP_LIBROMDATA_PUBLIC
+void setCacheDirectory(const char *cacheDir, uint64_t sizeLimit = 0);
+
+} } // namespace LibRomData::CacheIndex
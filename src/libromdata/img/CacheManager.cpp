@@ -8,6 +8,7 @@
 
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
+#include "CacheIndex.hpp"
 
 // moved from librpthreads to libromdata
 #include "semaphore/Semaphore.hpp"
@@ -128,6 +129,7 @@ string CacheManager::download(const char *cache_key)
 			} else if (filesize > 0) {
 				// File is larger than 0 bytes, which indicates
 				// it was cached successfully.
+				CacheIndex::touch(cache_filename);
 				return cache_filename;
 			}
 		} else if (ret != -ENOENT) {
@@ -157,6 +159,7 @@ string CacheManager::download(const char *cache_key)
 	}
 
 	// rp-download has successfully downloaded the file.
+	CacheIndex::touch(cache_filename);
 	return cache_filename;
 }
 
@@ -178,6 +181,8 @@ string CacheManager::findInCache(const char *cache_key)
 	if (FileSystem::access(cache_filename.c_str(), R_OK) != 0) {
 		// Unable to read the cache file.
 		cache_filename.clear();
+	} else {
+		CacheIndex::touch(cache_filename);
 	}
 	return cache_filename;
 }
@@ -113,12 +113,44 @@ public:
 		return findInCache(cache_key.c_str());
 	}
 
+#ifndef _WIN32
+public:
+	/** Persistent rp-download helpers (POSIX only) **/
+
+	/**
+	 * Set the rp-download executable.
+	 *
+	 * Idle persistent helpers are stopped, and persistent mode is
+	 * re-enabled if it was disabled. This is intended for test suites;
+	 * normally, rp-download is run from the libexec directory.
+	 *
+	 * @param filename rp-download executable, or nullptr to use the default.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	static void setRpDownloadExe(const char *filename);
+
+	struct HelperStats {
+		unsigned int spawned;	// Helpers started
+		unsigned int reused;	// Requests handled by an idle helper
+		unsigned int exited;	// Idle helpers that exited on their own
+		unsigned int idle;	// Helpers that are currently idle
+	};
+
+	/**
+	 * Get the persistent rp-download helper statistics for this process.
+	 * @return Helper statistics
+	 */
+	RP_LIBROMDATA_PUBLIC
+	static HelperStats helperStats(void);
+#endif /* !_WIN32 */
+
 protected:
 	/**
 	 * Execute rp-download.
 	 * @param filtered_cache_key Filtered cache key.
 	 * @return 0 on success; negative POSIX error code on error.
 	 */
+	RP_LIBROMDATA_PUBLIC
 	int execRpDownload(const std::string &filteredCacheKey);
 
 protected:
@@ -11,6 +11,9 @@
 
 // OS-specific includes
 #include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -18,38 +21,55 @@
 #  include <spawn.h>
 #endif /* HAVE_POSIX_SPAWN */
 
+// C includes (C++ namespace)
+#include <cstdlib>
+#include <ctime>
+
 // C++ includes
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <vector>
 using std::array;
 using std::string;
+using std::vector;
+
+#ifndef MSG_NOSIGNAL
+// macOS doesn't have MSG_NOSIGNAL. SO_NOSIGPIPE is used instead.
+#  define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
 
 namespace LibRomData {
 
+// TODO: Mac OS X path. (bundle?)
+static constexpr char rp_download_exe_default[] = DIR_INSTALL_LIBEXEC "/rp-download";
+
+// Maximum time to wait for a download, in milliseconds.
+// TODO: User-configurable timeout?
+static constexpr int RP_DOWNLOAD_TIMEOUT = 10*1000;
+
 /**
- * Execute rp-download. (POSIX version)
- * @param filteredCacheKey Filtered cache key.
- * @return 0 on success; negative POSIX error code on error.
+ * Minimal environment for rp-download.
  */
-int CacheManager::execRpDownload(const string &filteredCacheKey)
-{
-	// TODO: Mac OS X path. (bundle?)
- 	static constexpr char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
+struct RpDownloadEnv {
+	string s_env;
+	array<const char*, 5> envp;
+};
 
-	// Parameters.
-	const std::array<const char*, 3> argv = {{
-		rp_download_exe,
-		filteredCacheKey.c_str(),
-		nullptr
-	}};
-
-	// Define a minimal environment for cURL.
-	// This will include http_proxy and https_proxy if the proxy URL is set.
+/**
+ * Build a minimal environment for cURL.
+ * This will include http_proxy and https_proxy if the proxy URL is set.
+ * @param env		[out] RpDownloadEnv
+ * @param proxyUrl	[in] Proxy URL (empty for the system default)
+ */
+static void buildRpDownloadEnv(RpDownloadEnv &env, const string &proxyUrl)
+{
 	// TODO: Separate proxies for http and https?
-	// TODO: Only build this once?
 	array<int, 5> pos = {{-1, -1, -1, -1, -1}};
 	int count = 0;
-	std::string s_env;
+	string &s_env = env.s_env;
+	s_env.clear();
 	s_env.reserve(1024);
 
 	// We want the HOME and USER variables.
@@ -69,7 +89,7 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		s_env += envtmp;
 		s_env += '\0';
 	}
-	if (m_proxyUrl.empty()) {
+	if (proxyUrl.empty()) {
 		// Proxy URL is empty. Get the URLs from the environment.
 		envtmp = getenv("http_proxy");
 		if (envtmp && envtmp[0] != '\0') {
@@ -88,37 +108,62 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	} else {
 		// Proxy URL is set. Use it.
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "http_proxy=" + m_proxyUrl;
+		s_env += "http_proxy=";
+		s_env += proxyUrl;
+		s_env += '\0';
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "https_proxy=" + m_proxyUrl;
+		s_env += "https_proxy=";
+		s_env += proxyUrl;
+		s_env += '\0';
 	}
 
 	// Build envp.
-	array<const char*, 5> envp = {{nullptr, nullptr, nullptr, nullptr, nullptr}};
+	// NOTE: Only 4 variables can be set, so the last entry is always nullptr.
+	env.envp.fill(nullptr);
 	unsigned int envp_idx = 0;
 	for (unsigned int i = 0; i < 5; i++) {
 		if (pos[i] >= 0) {
-			envp[envp_idx++] = &s_env[pos[i]];
+			env.envp[envp_idx++] = &s_env[pos[i]];
 		}
 	}
+}
 
+/**
+ * Spawn an rp-download process.
+ * @param pPid		[out] Process ID
+ * @param exe		[in] rp-download executable
+ * @param argv		[in] Arguments
+ * @param envp		[in] Environment
+ * @param stdio_fd	[in] If >= 0, file descriptor to use as the child's stdin and stdout.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int spawnRpDownload(pid_t *pPid, const char *exe, const char *const *argv, const char *const *envp, int stdio_fd)
+{
 	// TODO: Maybe we should close file handles...
 #ifdef HAVE_POSIX_SPAWN
 	// posix_spawn()
+	posix_spawn_file_actions_t file_actions;
+	posix_spawn_file_actions_t *p_file_actions = nullptr;
+	if (stdio_fd >= 0) {
+		posix_spawn_file_actions_init(&file_actions);
+		posix_spawn_file_actions_adddup2(&file_actions, stdio_fd, STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&file_actions, stdio_fd, STDOUT_FILENO);
+		p_file_actions = &file_actions;
+	}
+
 	errno = 0;
-	pid_t pid;
-	int ret = posix_spawn(&pid, rp_download_exe,
-		nullptr,	// file_actions
+	int ret = posix_spawn(pPid, exe,
+		p_file_actions,
 		nullptr,	// attrp
-		(char *const *)argv.data(),
-		(char *const *)envp.data());
+		(char *const *)argv,
+		(char *const *)envp);
+	if (p_file_actions) {
+		posix_spawn_file_actions_destroy(p_file_actions);
+	}
 	if (ret != 0) {
 		// Error creating the child process.
-		int err = errno;
-		if (err == 0) {
-			err = EIO;
-		}
-		return -err;
+		// NOTE: posix_spawn() returns the error code.
+		return -ret;
 	}
 #else /* !HAVE_POSIX_SPAWN */
 	// fork()/execve().
@@ -126,13 +171,20 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	pid_t pid = fork();
 	if (pid == 0) {
 		// Child process.
-		int ret = execve(rp_download_exe, (char *const *)argv.data(), (char *const *)envp.data());
+		if (stdio_fd >= 0) {
+			if (dup2(stdio_fd, STDIN_FILENO) < 0 ||
+			    dup2(stdio_fd, STDOUT_FILENO) < 0)
+			{
+				_exit(EXIT_FAILURE);
+			}
+		}
+		int ret = execve(exe, (char *const *)argv, (char *const *)envp);
 		if (ret != 0) {
 			// execve() failed.
-			exit(EXIT_FAILURE);
+			_exit(EXIT_FAILURE);
 		}
 		assert(!"Shouldn't get here...");
-		exit(EXIT_FAILURE);
+		_exit(EXIT_FAILURE);
 	} else if (pid == -1) {
 		// fork() failed.
 		int err = errno;
@@ -141,16 +193,340 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		}
 		return -err;
 	}
+	*pPid = pid;
 #endif /* HAVE_POSIX_SPAWN */
 
+	return 0;
+}
+
+/** Persistent rp-download helpers **/
+// rp-download is started in persistent mode ("-s") and kept running
+// between downloads, which allows it to reuse its HTTP connections.
+// Requests and responses are sent over a UNIX socket connected to
+// rp-download's stdin and stdout. See rp-download/RequestServer.hpp.
+
+namespace {
+
+struct RpDownloadHelper {
+	pid_t pid;
+	pid_t parent_pid;	// Process that started rp-download
+	int fd;			// Socket connected to rp-download's stdin/stdout
+	string proxyUrl;	// Proxy URL rp-download was started with
+};
+
+// Idle helpers.
+// NOTE: CacheManager::m_dlsem limits the number of simultaneous
+// downloads, which also limits the number of helpers.
+std::mutex helpers_mutex;
+vector<RpDownloadHelper> idle_helpers;
+
+// rp-download executable. (empty for the default)
+// Protected by helpers_mutex.
+string rp_download_exe;
+
+// Set if persistent mode doesn't work, e.g. if the installed
+// rp-download is too old. One-shot mode is used in that case.
+std::atomic<bool> persistent_disabled(false);
+
+// Helper statistics
+std::atomic<unsigned int> stats_spawned(0);
+std::atomic<unsigned int> stats_reused(0);
+std::atomic<unsigned int> stats_exited(0);
+
+/**
+ * Stops idle helpers when libromdata is unloaded or the program exits.
+ * rp-download exits on its own after its idle timeout, but it would
+ * remain a zombie until the next download, which might never happen.
+ * NOTE: Must be defined after idle_helpers so it's destroyed first.
+ */
+struct IdleHelperReaper {
+	~IdleHelperReaper();
+};
+IdleHelperReaper idle_helper_reaper;
+
+} // anonymous namespace
+
+/**
+ * Stop a persistent rp-download helper.
+ * @param helper Helper
+ */
+static void stopHelper(RpDownloadHelper &helper)
+{
+	// Closing the socket makes rp-download exit once the current
+	// request is finished. SIGTERM makes sure it doesn't linger.
+	close(helper.fd);
+	if (helper.parent_pid == getpid()) {
+		// NOTE: If this is a fork()'d child process, the helper
+		// belongs to the parent process, so leave it alone.
+		kill(helper.pid, SIGTERM);
+		int wstatus = 0;
+		waitpid(helper.pid, &wstatus, 0);
+	}
+	helper.fd = -1;
+	helper.pid = -1;
+}
+
+/**
+ * Stop all idle rp-download helpers.
+ */
+static void stopIdleHelpers(void)
+{
+	vector<RpDownloadHelper> helpers;
+	{
+		std::lock_guard<std::mutex> lock(helpers_mutex);
+		helpers.swap(idle_helpers);
+	}
+	for (RpDownloadHelper &helper : helpers) {
+		stopHelper(helper);
+	}
+}
+
+IdleHelperReaper::~IdleHelperReaper()
+{
+	stopIdleHelpers();
+}
+
+/**
+ * Start a persistent rp-download helper.
+ * @param helper	[out] Helper
+ * @param exe		[in] rp-download executable
+ * @param proxyUrl	[in] Proxy URL
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int startHelper(RpDownloadHelper &helper, const string &exe, const string &proxyUrl)
+{
+	int sv[2];
+#ifdef SOCK_CLOEXEC
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+		const int err = errno;
+		return (err != 0 ? -err : -EIO);
+	}
+#else /* !SOCK_CLOEXEC */
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+		const int err = errno;
+		return (err != 0 ? -err : -EIO);
+	}
+	fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+	fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+#endif /* SOCK_CLOEXEC */
+#ifdef SO_NOSIGPIPE
+	const int one = 1;
+	setsockopt(sv[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif /* SO_NOSIGPIPE */
+
+	const array<const char*, 3> argv = {{
+		exe.c_str(),
+		"-s",
+		nullptr
+	}};
+	RpDownloadEnv env;
+	buildRpDownloadEnv(env, proxyUrl);
+
+	// NOTE: dup2() clears FD_CLOEXEC on the child's stdin/stdout.
+	pid_t pid = -1;
+	const int ret = spawnRpDownload(&pid, exe.c_str(), argv.data(), env.envp.data(), sv[1]);
+	close(sv[1]);
+	if (ret != 0) {
+		close(sv[0]);
+		return ret;
+	}
+
+	helper.pid = pid;
+	helper.parent_pid = getpid();
+	helper.fd = sv[0];
+	helper.proxyUrl = proxyUrl;
+	stats_spawned++;
+	return 0;
+}
+
+/**
+ * Send a request to a persistent rp-download helper and wait for the response.
+ * @param helper	[in] Helper
+ * @param cacheKey	[in] Cache key
+ * @return 0 if downloaded; 1 if rp-download failed; negative POSIX error code if the helper isn't usable.
+ */
+static int sendHelperRequest(const RpDownloadHelper &helper, const string &cacheKey)
+{
+	string request;
+	request.reserve(cacheKey.size() + 1);
+	request = cacheKey;
+	request += '\n';
+
+	const char *p = request.data();
+	size_t size = request.size();
+	while (size > 0) {
+		const ssize_t n = send(helper.fd, p, size, MSG_NOSIGNAL);
+		if (n < 0) {
+			const int err = errno;
+			if (err == EINTR) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+		p += n;
+		size -= static_cast<size_t>(n);
+	}
+
+	// Wait for the response: "%d %s\n"
+	string response;
+	struct timespec ts_start;
+	clock_gettime(CLOCK_MONOTONIC, &ts_start);
+	for (;;) {
+		struct timespec ts_now;
+		clock_gettime(CLOCK_MONOTONIC, &ts_now);
+		const long elapsed = ((ts_now.tv_sec - ts_start.tv_sec) * 1000) +
+		                     ((ts_now.tv_nsec - ts_start.tv_nsec) / 1000000);
+		if (elapsed >= RP_DOWNLOAD_TIMEOUT) {
+			return -ETIMEDOUT;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = helper.fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, static_cast<int>(RP_DOWNLOAD_TIMEOUT - elapsed));
+		if (ret == 0) {
+			return -ETIMEDOUT;
+		} else if (ret < 0) {
+			const int err = errno;
+			if (err == EINTR) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+
+		char buf[256];
+		const ssize_t n = recv(helper.fd, buf, sizeof(buf), 0);
+		if (n == 0) {
+			// rp-download exited.
+			return -EPIPE;
+		} else if (n < 0) {
+			const int err = errno;
+			if (err == EINTR) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+		response.append(buf, static_cast<size_t>(n));
+
+		const size_t nl = response.find('\n');
+		if (nl == string::npos) {
+			continue;
+		}
+
+		// Only one request is sent at a time, so the
+		// response must be for this cache key.
+		const size_t sp = response.find(' ');
+		if (nl != response.size() - 1 || sp == string::npos || sp > nl ||
+		    response.compare(sp + 1, nl - sp - 1, cacheKey) != 0)
+		{
+			// Invalid response.
+			return -EIO;
+		}
+		return (response[0] == '0' && sp == 1) ? 0 : 1;
+	}
+}
+
+/**
+ * Execute rp-download using a persistent helper.
+ * @param cacheKey	[in] Cache key
+ * @param exe		[in] rp-download executable
+ * @param proxyUrl	[in] Proxy URL
+ * @return 0 on success; 1 if rp-download failed; negative POSIX error code if persistent mode isn't usable.
+ */
+static int execRpDownload_persistent(const string &cacheKey, const string &exe, const string &proxyUrl)
+{
+	// Try an idle helper first. If it exited in the meantime,
+	// e.g. due to its idle timeout, start a new helper.
+	for (;;) {
+		RpDownloadHelper helper;
+		helper.pid = -1;
+		helper.parent_pid = -1;
+		helper.fd = -1;
+		bool isNew = false;
+
+		{
+			std::lock_guard<std::mutex> lock(helpers_mutex);
+			while (!idle_helpers.empty()) {
+				RpDownloadHelper idle = std::move(idle_helpers.back());
+				idle_helpers.pop_back();
+
+				int wstatus = 0;
+				if (waitpid(idle.pid, &wstatus, WNOHANG) != 0) {
+					// Helper has exited. (already reaped)
+					close(idle.fd);
+					stats_exited++;
+					continue;
+				} else if (idle.proxyUrl != proxyUrl) {
+					// Proxy URL has changed.
+					stopHelper(idle);
+					continue;
+				}
+				helper = std::move(idle);
+				break;
+			}
+		}
+
+		if (helper.pid < 0) {
+			int ret = startHelper(helper, exe, proxyUrl);
+			if (ret != 0) {
+				return ret;
+			}
+			isNew = true;
+		} else {
+			stats_reused++;
+		}
+
+		int ret = sendHelperRequest(helper, cacheKey);
+		if (ret >= 0) {
+			// Request completed. Keep the helper for later.
+			std::lock_guard<std::mutex> lock(helpers_mutex);
+			idle_helpers.emplace_back(std::move(helper));
+			return ret;
+		}
+
+		stopHelper(helper);
+		if (ret == -ETIMEDOUT) {
+			// Download took too long.
+			return 1;
+		} else if (isNew) {
+			// A new helper didn't work.
+			return ret;
+		}
+	}
+}
+
+/**
+ * Execute rp-download in one-shot mode.
+ * @param cacheKey	[in] Cache key
+ * @param exe		[in] rp-download executable
+ * @param proxyUrl	[in] Proxy URL
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int execRpDownload_oneshot(const string &cacheKey, const string &exe, const string &proxyUrl)
+{
+	// Parameters.
+	const array<const char*, 3> argv = {{
+		exe.c_str(),
+		cacheKey.c_str(),
+		nullptr
+	}};
+	RpDownloadEnv env;
+	buildRpDownloadEnv(env, proxyUrl);
+
+	pid_t pid = -1;
+	int ret = spawnRpDownload(&pid, exe.c_str(), argv.data(), env.envp.data(), -1);
+	if (ret != 0) {
+		return ret;
+	}
+
 	// Parent process.
 	// Wait up to 10 seconds for the process to exit.
-	// TODO: User-configurable timeout?
 	// TODO: Report errors somewhere.
 	bool ok = false;	// rp-download terminated successfully.
 	bool waited = false;	// waitpid() was successful.
 	int wstatus = 0;
-	for (unsigned int i = 10*4; i > 0; i--) {
+	for (unsigned int i = (RP_DOWNLOAD_TIMEOUT / 250); i > 0; i--) {
 		pid_t wpid = waitpid(pid, &wstatus, WNOHANG);
 		if (wpid == pid) {
 			// Process has changed state.
@@ -194,4 +570,78 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return 0;
 }
 
+/**
+ * Execute rp-download. (POSIX version)
+ * @param filteredCacheKey Filtered cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownload(const string &filteredCacheKey)
+{
+	// Cache keys are sent to persistent helpers one per line.
+	if (filteredCacheKey.empty() ||
+	    filteredCacheKey.find_first_of("\r\n") != string::npos)
+	{
+		return -EINVAL;
+	}
+
+	string exe;
+	{
+		std::lock_guard<std::mutex> lock(helpers_mutex);
+		exe = (!rp_download_exe.empty() ? rp_download_exe : rp_download_exe_default);
+	}
+
+	if (!persistent_disabled.load(std::memory_order_relaxed)) {
+		const int ret = execRpDownload_persistent(filteredCacheKey, exe, m_proxyUrl);
+		if (ret >= 0) {
+			// rp-download handled the request.
+			return (ret == 0 ? 0 : -EIO);
+		}
+
+		// Persistent mode isn't working. Use one-shot mode from now on.
+		persistent_disabled.store(true, std::memory_order_relaxed);
+	}
+
+	return execRpDownload_oneshot(filteredCacheKey, exe, m_proxyUrl);
+}
+
+/**
+ * Set the rp-download executable.
+ *
+ * Idle persistent helpers are stopped, and persistent mode is
+ * re-enabled if it was disabled. This is intended for test suites;
+ * normally, rp-download is run from the libexec directory.
+ *
+ * @param filename rp-download executable, or nullptr to use the default.
+ */
+void CacheManager::setRpDownloadExe(const char *filename)
+{
+	{
+		std::lock_guard<std::mutex> lock(helpers_mutex);
+		if (filename) {
+			rp_download_exe = filename;
+		} else {
+			rp_download_exe.clear();
+		}
+	}
+
+	stopIdleHelpers();
+	persistent_disabled.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * Get the persistent rp-download helper statistics for this process.
+ * @return Helper statistics
+ */
+CacheManager::HelperStats CacheManager::helperStats(void)
+{
+	HelperStats stats;
+	stats.spawned = stats_spawned.load();
+	stats.reused = stats_reused.load();
+	stats.exited = stats_exited.load();
+
+	std::lock_guard<std::mutex> lock(helpers_mutex);
+	stats.idle = static_cast<unsigned int>(idle_helpers.size());
+	return stats;
+}
+
 } // namespace LibRomData
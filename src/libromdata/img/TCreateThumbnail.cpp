@@ -34,27 +34,74 @@
 #include <cstring>
 
 // C++ STL classes
+#include <algorithm>
 using std::array;
 
 namespace LibRomData {
 
 /**
- * Get an internal image.
+ * Select the smallest IMG_INT_IMAGE mipmap level that is
+ * at least as large as the requested size.
+ * @param romData	[in] RomData object
+ * @param reqSize	[in] Requested image size (single dimension; assuming square image)
+ * @return Mipmap level, or 0 to use the full image.
+ */
+template<typename ImgClass>
+int TCreateThumbnail<ImgClass>::selectMipmapLevel(const LibRpBase::RomDataPtr &romData, int reqSize)
+{
+	using LibRpBase::RomData;
+
+	if (reqSize <= 0) {
+		// Full size was requested.
+		return 0;
+	}
+
+	// Don't use mipmaps if the image has to be rescaled to
+	// specific dimensions, since that needs the full image.
+	const uint32_t imgpf = romData->imgpf(RomData::IMG_INT_IMAGE);
+	if (imgpf & (RomData::IMGPF_RESCALE_RFT_DIMENSIONS_2 | RomData::IMGPF_RESCALE_ASPECT_8to7)) {
+		return 0;
+	}
+
+	// The thumbnail is scaled to fit within reqSize x reqSize,
+	// so the larger dimension must be at least reqSize.
+	const int mipmapCount = romData->mipmapCount();
+	int mipmapLevel = 0;
+	for (int i = 1; i < mipmapCount; i++) {
+		int dimensions[2];
+		if (romData->getMipmapDimensions(i, dimensions) != 0) {
+			break;
+		}
+		if (std::max(dimensions[0], dimensions[1]) < reqSize) {
+			// Too small.
+			break;
+		}
+		mipmapLevel = i;
+	}
+	return mipmapLevel;
+}
+
+/**
+ * Get an internal image as an rp_image.
+ *
+ * This is the same as getInternalImage(), except the image
+ * is not converted to ImgClass.
+ *
  * @param romData	[in] RomData object
  * @param imageType	[in] Image type
+ * @param reqSize	[in] Requested image size (0 for full size)
  * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
  * @param sBIT		[out,opt] sBIT metadata
- * @return Internal image, or null ImgClass on error.
+ * @return Internal image, or nullptr on error.
  */
 template<typename ImgClass>
-ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
+LibRpTexture::rp_image_const_ptr TCreateThumbnail<ImgClass>::getInternalRpImage(
 	const LibRpBase::RomDataPtr &romData,
 	LibRpBase::RomData::ImageType imageType,
+	int reqSize,
 	ImgSize *pOutSize,
 	LibRpTexture::rp_image::sBIT_t *sBIT)
 {
-	ImgClass ret_img = getNullImgClass();
-
 	using LibRpBase::RomData;
 	using LibRpTexture::rp_image_const_ptr;
 
@@ -64,19 +111,90 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		if (sBIT) {
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return ret_img;
+		return {};
 	}
 
-	const rp_image_const_ptr image = romData->image(imageType);
+	// If the image has mipmaps, use the smallest mipmap level
+	// that's large enough for the requested size.
+	rp_image_const_ptr image;
+	int fullDimensions[2] = {0, 0};
+	if (imageType == RomData::IMG_INT_IMAGE) {
+		const int mipmapLevel = selectMipmapLevel(romData, reqSize);
+		if (mipmapLevel > 0 && romData->getMipmapDimensions(0, fullDimensions) == 0) {
+			image = romData->mipmap(mipmapLevel);
+			if (image && std::max(image->width(), image->height()) < reqSize) {
+				// Mipmap is smaller than expected.
+				image.reset();
+			}
+		}
+	}
+	if (!image) {
+		image = romData->image(imageType);
+		fullDimensions[0] = 0;
+		fullDimensions[1] = 0;
+	}
 	if (!image) {
 		// No image.
 		if (sBIT) {
 			memset(sBIT, 0, sizeof(*sBIT));
 		}
-		return ret_img;
+		return image;
 	}
 
-	// TODO: Multiple internal image sizes. [add reqSize]
+	if (pOutSize) {
+		if (fullDimensions[0] > 0 && fullDimensions[1] > 0) {
+			// A mipmap was used. Report the full image size.
+			pOutSize->width = fullDimensions[0];
+			pOutSize->height = fullDimensions[1];
+		} else {
+			pOutSize->width = image->width();
+			pOutSize->height = image->height();
+		}
+	}
+	if (sBIT) {
+		// Get the sBIT metadata.
+		if (image->get_sBIT(sBIT) != 0) {
+			// No sBIT metadata.
+			// Clear the struct.
+			memset(sBIT, 0, sizeof(*sBIT));
+		}
+	}
+
+	return image;
+}
+
+/**
+ * Get an internal image.
+ *
+ * If reqSize is non-zero and the image has mipmaps, the smallest
+ * mipmap level that is at least as large as the requested size
+ * will be decoded instead of the full image. pOutSize will still
+ * be set to the full image size.
+ *
+ * @param romData	[in] RomData object
+ * @param imageType	[in] Image type
+ * @param reqSize	[in] Requested image size (0 for full size)
+ * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
+ * @param sBIT		[out,opt] sBIT metadata
+ * @return Internal image, or null ImgClass on error.
+ */
+template<typename ImgClass>
+ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
+	const LibRpBase::RomDataPtr &romData,
+	LibRpBase::RomData::ImageType imageType,
+	int reqSize,
+	ImgSize *pOutSize,
+	LibRpTexture::rp_image::sBIT_t *sBIT)
+{
+	ImgClass ret_img = getNullImgClass();
+
+	ImgSize fullSize;
+	const LibRpTexture::rp_image_const_ptr image =
+		getInternalRpImage(romData, imageType, reqSize, &fullSize, sBIT);
+	if (!image) {
+		// No image.
+		return ret_img;
+	}
 
 	// Convert the rp_image to ImgClass.
 	ret_img = rpImageToImgClass(image);
@@ -89,13 +207,14 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 			// Hence, we have to get the size from ret_img.
 			// TODO: Check for errors?
 			getImgClassSize(ret_img, pOutSize);
-		}
-		if (sBIT) {
-			// Get the sBIT metadata.
-			if (image->get_sBIT(sBIT) != 0) {
-				// No sBIT metadata.
-				// Clear the struct.
-				memset(sBIT, 0, sizeof(*sBIT));
+
+			if (fullSize.width != image->width() || fullSize.height != image->height()) {
+				// A mipmap was used. Report the size the full image
+				// would have had, scaled the same way as the mipmap.
+				pOutSize->width = static_cast<int>(
+					(static_cast<int64_t>(pOutSize->width) * fullSize.width) / image->width());
+				pOutSize->height = static_cast<int>(
+					(static_cast<int64_t>(pOutSize->height) * fullSize.height) / image->height());
 			}
 		}
 	} else {
@@ -286,6 +405,11 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 	uint32_t imgbf = romData->supportedImageTypes();
 	uint32_t imgpf = 0;
 
+	// If using rp_image::scaled(), internal images are kept
+	// as rp_image until all rescaling is done.
+	const bool nativeScaler = useNativeScaler();
+	LibRpTexture::rp_image_const_ptr rpImg;
+
 	// Get the image priority.
 	const Config *const config = Config::instance();
 	Config::ImgTypePrio_t imgTypePrio;
@@ -311,11 +435,15 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 		// Check for an icon first.
 		// TODO: Define "small sizes" somewhere. (DPI independence?)
 		if (imgbf & RomData::IMGBF_INT_ICON) {
-			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT);
+			if (nativeScaler) {
+				rpImg = getInternalRpImage(romData, RomData::IMG_INT_ICON, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
+			} else {
+				pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
+			}
 			imgpf = romData->imgpf(RomData::IMG_INT_ICON);
 			imgbf &= ~RomData::IMGBF_INT_ICON;
 
-			if (isImgClassValid(pOutParams->retImg)) {
+			if (rpImg || isImgClassValid(pOutParams->retImg)) {
 				// Image retrieved.
 				// TODO: Better method than goto?
 				goto skip_image_check;
@@ -343,7 +471,11 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 		// This image may be present.
 		if (imgType <= RomData::IMG_INT_MAX) {
 			// Internal image.
-			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT);
+			if (nativeScaler) {
+				rpImg = getInternalRpImage(romData, imgType, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
+			} else {
+				pOutParams->retImg = getInternalImage(romData, imgType, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
+			}
 			imgpf = romData->imgpf(imgType);
 		} else {
 			// External image.
@@ -351,7 +483,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 			imgpf = romData->imgpf(imgType);
 		}
 
-		if (isImgClassValid(pOutParams->retImg)) {
+		if (rpImg || isImgClassValid(pOutParams->retImg)) {
 			// Image retrieved.
 			break;
 		}
@@ -362,7 +494,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 		imgbf &= ~bf;
 	}
 
-	if (!isImgClassValid(pOutParams->retImg)) {
+	if (!rpImg && !isImgClassValid(pOutParams->retImg)) {
 		// No image.
 		return RPCT_ERROR_SOURCE_FILE_NO_IMAGE;
 	}
@@ -370,11 +502,39 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const LibRpBase::RomDataPtr &romDat
 skip_image_check:
 	if (pOutParams->fullSize.width <= 0 || pOutParams->fullSize.height <= 0) {
 		// Image size is invalid.
-		freeImgClass(pOutParams->retImg);
-		pOutParams->retImg = getNullImgClass();
+		if (!rpImg) {
+			freeImgClass(pOutParams->retImg);
+			pOutParams->retImg = getNullImgClass();
+		}
 		return RPCT_ERROR_CANNOT_OPEN_SOURCE_FILE;
 	}
 
+	// Rescale the image using either rp_image::scaled() or rescaleImgClass().
+	auto rescaleImage = [this, &rpImg, pOutParams](ImgSize sz, ScalingMethod method) -> bool {
+		if (rpImg) {
+			// NOTE: Bilinear is requested for non-integer rescaling
+			// and downscaling, so use area averaging instead to reduce
+			// aliasing. (Area averaging uses bilinear for upscaling.)
+			LibRpTexture::rp_image_const_ptr scaled_img = rpImg->scaled(sz.width, sz.height,
+				(method == ScalingMethod::Bilinear)
+					? LibRpTexture::rp_image::ScaleMethod::Area
+					: LibRpTexture::rp_image::ScaleMethod::Nearest);
+			if (!scaled_img) {
+				return false;
+			}
+			rpImg = std::move(scaled_img);
+			return true;
+		}
+
+		ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, sz, method);
+		if (!isImgClassValid(scaled_img)) {
+			return false;
+		}
+		freeImgClass(pOutParams->retImg);
+		pOutParams->retImg = scaled_img;
+		return true;
+	};
+
 	if (imgpf & RomData::IMGPF_RESCALE_RFT_DIMENSIONS_2) {
 		// Find the second RFT_DIMENSIONS field.
 		const RomFields *const fields = romData->fields();
@@ -398,10 +558,7 @@ skip_image_check:
 				field[1]->data.dimensions[0],
 				field[1]->data.dimensions[1],
 			};
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescaleSize);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
+			if (rescaleImage(rescaleSize, ScalingMethod::Nearest)) {
 				pOutParams->fullSize = rescaleSize;
 
 				// Disable nearest-neighbor scaling, since we already lost
@@ -426,10 +583,7 @@ skip_image_check:
 		}
 		if (scaleW != 0) {
 			const ImgSize newFullSize = {scaleW, pOutParams->fullSize.height};
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, newFullSize, ScalingMethod::Bilinear);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
+			if (rescaleImage(newFullSize, ScalingMethod::Bilinear)) {
 				pOutParams->fullSize.width = scaleW;
 
 				// Disable nearest-neighbor scaling, since we already lost
@@ -487,10 +641,7 @@ skip_image_check:
 			// may result in 0x0, which is no good. If this happens,
 			// skip the rescaling entirely.
 			if (rescale_sz.width > 0 && rescale_sz.height > 0) {
-				ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescale_sz);
-				if (isImgClassValid(scaled_img)) {
-					freeImgClass(pOutParams->retImg);
-					pOutParams->retImg = scaled_img;
+				if (rescaleImage(rescale_sz, ScalingMethod::Nearest)) {
 					thumbSize = rescale_sz;
 				}
 			}
@@ -508,14 +659,21 @@ skip_image_check:
 		// may result in 0x0, which is no good. If this happens,
 		// skip the rescaling entirely.
 		if (rescale_sz.width > 0 && rescale_sz.height > 0) {
-			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, rescale_sz, ScalingMethod::Bilinear);
-			if (isImgClassValid(scaled_img)) {
-				freeImgClass(pOutParams->retImg);
-				pOutParams->retImg = scaled_img;
+			if (rescaleImage(rescale_sz, ScalingMethod::Bilinear)) {
 				thumbSize = rescale_sz;
 			}
 		}
 	}
+
+	if (rpImg) {
+		// Convert the rp_image to ImgClass.
+		pOutParams->retImg = rpImageToImgClass(rpImg);
+		if (!isImgClassValid(pOutParams->retImg)) {
+			pOutParams->retImg = getNullImgClass();
+			return RPCT_ERROR_SOURCE_FILE_NO_IMAGE;
+		}
+	}
+
 	// Image retrieved successfully.
 	pOutParams->thumbSize = thumbSize;
 	return RPCT_SUCCESS;
@@ -128,16 +128,52 @@ public:
 		int height;
 	};
 
+	/**
+	 * Select the smallest IMG_INT_IMAGE mipmap level that is
+	 * at least as large as the requested size.
+	 * @param romData	[in] RomData object
+	 * @param reqSize	[in] Requested image size (single dimension; assuming square image)
+	 * @return Mipmap level, or 0 to use the full image.
+	 */
+	static int selectMipmapLevel(const LibRpBase::RomDataPtr &romData, int reqSize);
+
 	/**
 	 * Get an internal image.
+	 *
+	 * If reqSize is non-zero and the image has mipmaps, the smallest
+	 * mipmap level that is at least as large as the requested size
+	 * will be decoded instead of the full image. pOutSize will still
+	 * be set to the full image size.
+	 *
 	 * @param romData	[in] RomData object
 	 * @param imageType	[in] Image type
+	 * @param reqSize	[in] Requested image size (0 for full size)
 	 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
 	 * @param sBIT		[out,opt] sBIT metadata
 	 * @return Internal image, or null ImgClass on error.
 	 */
 	ImgClass getInternalImage(const LibRpBase::RomDataPtr &romData,
 		LibRpBase::RomData::ImageType imageType,
+		int reqSize = 0,
+		ImgSize *pOutSize = nullptr,
+		LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
+
+	/**
+	 * Get an internal image as an rp_image.
+	 *
+	 * This is the same as getInternalImage(), except the image
+	 * is not converted to ImgClass.
+	 *
+	 * @param romData	[in] RomData object
+	 * @param imageType	[in] Image type
+	 * @param reqSize	[in] Requested image size (0 for full size)
+	 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size
+	 * @param sBIT		[out,opt] sBIT metadata
+	 * @return Internal image, or nullptr on error.
+	 */
+	static LibRpTexture::rp_image_const_ptr getInternalRpImage(const LibRpBase::RomDataPtr &romData,
+		LibRpBase::RomData::ImageType imageType,
+		int reqSize = 0,
 		ImgSize *pOutSize = nullptr,
 		LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
 
@@ -248,6 +284,24 @@ protected:
 	 */
 	virtual ImgClass rescaleImgClass(ConstRefImgClass imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const = 0;
 
+	/**
+	 * Should internal images be rescaled using rp_image::scaled()?
+	 *
+	 * If true, internal images are kept as rp_image until all
+	 * rescaling is done, and are then converted to ImgClass.
+	 * This avoids the toolkit's scaler, so thumbnails will be
+	 * identical across frontends.
+	 *
+	 * External images always use rescaleImgClass().
+	 *
+	 * @return True to use rp_image::scaled(); false to use rescaleImgClass().
+	 */
+	virtual bool useNativeScaler(void) const
+	{
+		// Default is to use rescaleImgClass().
+		return false;
+	}
+
 	/**
 	 * Get the size of the specified ImgClass.
 	 * @param imgClass	[in] ImgClass object
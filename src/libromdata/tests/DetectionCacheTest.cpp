@@ -0,0 +1,303 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * DetectionCacheTest.cpp: DetectionCache test.                            *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// libromdata
+#include "DetectionCache.hpp"
+#include "RomDataFactory.hpp"
+#include "Handheld/lnx_structs.h"
+using namespace LibRpBase;
+
+// Other rom-properties libraries
+#include "librpbyteswap/byteswap_rp.h"
+
+// C includes
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class DetectionCacheTest : public ::testing::Test
+{
+protected:
+	void SetUp(void) override;
+	void TearDown(void) override;
+
+public:
+	/**
+	 * Write a file.
+	 * @param filename Filename
+	 * @param data Data
+	 */
+	static void writeFile(const string &filename, const vector<uint8_t> &data);
+
+	/**
+	 * Create an Atari Lynx ROM image.
+	 * @param cartname Cartridge name
+	 * @return ROM image
+	 */
+	static vector<uint8_t> makeLynxRom(const char *cartname);
+
+public:
+	string m_tmpDir;	// Temporary directory
+	string m_indexFilename;	// Index filename
+	vector<string> m_files;	// Files to delete
+};
+
+void DetectionCacheTest::SetUp(void)
+{
+	m_tmpDir = ::testing::TempDir();
+	if (m_tmpDir.empty() || m_tmpDir[m_tmpDir.size()-1] != '/') {
+		m_tmpDir += '/';
+	}
+	m_tmpDir += "rp-DetectionCacheTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(&m_tmpDir[0]));
+
+	m_indexFilename = m_tmpDir + "/detection.idx";
+	DetectionCache::setIndexFilename(m_indexFilename.c_str());
+}
+
+void DetectionCacheTest::TearDown(void)
+{
+	DetectionCache::setIndexFilename(nullptr);
+	for (const string &filename : m_files) {
+		unlink(filename.c_str());
+	}
+	unlink(m_indexFilename.c_str());
+	unlink((m_indexFilename + ".lock").c_str());
+	rmdir(m_tmpDir.c_str());
+}
+
+/**
+ * Write a file.
+ * @param filename Filename
+ * @param data Data
+ */
+void DetectionCacheTest::writeFile(const string &filename, const vector<uint8_t> &data)
+{
+	FILE *const f = fopen(filename.c_str(), "wb");
+	ASSERT_NE(nullptr, f);
+	EXPECT_EQ(data.size(), fwrite(data.data(), 1, data.size(), f));
+	fclose(f);
+}
+
+/**
+ * Create an Atari Lynx ROM image.
+ * @param cartname Cartridge name
+ * @return ROM image
+ */
+vector<uint8_t> DetectionCacheTest::makeLynxRom(const char *cartname)
+{
+	vector<uint8_t> rom(sizeof(Lynx_RomHeader) + 4096);
+	Lynx_RomHeader *const romHeader = reinterpret_cast<Lynx_RomHeader*>(rom.data());
+	romHeader->magic = cpu_to_be32(LYNX_MAGIC);
+	romHeader->page_size_bank0 = cpu_to_le16(256);
+	romHeader->version = cpu_to_le16(1);
+	memcpy(romHeader->cartname, cartname, std::min(strlen(cartname), sizeof(romHeader->cartname)));
+	memcpy(romHeader->manufname, "rom-properties", 14);
+	return rom;
+}
+
+/**
+ * Directories aren't cached.
+ */
+TEST_F(DetectionCacheTest, directoryNotCached)
+{
+	EXPECT_EQ(nullptr, DetectionCache::lookup(m_tmpDir));
+}
+
+/**
+ * Unsupported files are cached as unsupported.
+ */
+TEST_F(DetectionCacheTest, unsupportedFile)
+{
+	const string filename = m_tmpDir + "/unsupported.bin";
+	m_files.push_back(filename);
+	writeFile(filename, vector<uint8_t>(1024, 0xA5));
+
+	DetectionCache::EntryPtr entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_FALSE(entry->isSupported());
+
+	// Second lookup should be a cache hit.
+	entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_FALSE(entry->isSupported());
+
+	const DetectionCache::Stats stats = DetectionCache::stats();
+	EXPECT_EQ(1U, stats.misses);
+	EXPECT_EQ(1U, stats.hits);
+}
+
+/**
+ * Results are written to the index and can be read back
+ * by a new instance without calling RomDataFactory::create().
+ */
+TEST_F(DetectionCacheTest, indexRoundTrip)
+{
+	const string filename = m_tmpDir + "/test.lnx";
+	m_files.push_back(filename);
+	writeFile(filename, makeLynxRom("DetectionCache Test"));
+
+	// Get the expected results directly from RomDataFactory.
+	const RomDataPtr romData = RomDataFactory::create(filename);
+	ASSERT_NE(nullptr, romData);
+	const RomMetaData *const expectedMetaData = romData->metaData();
+	ASSERT_NE(nullptr, expectedMetaData);
+
+	DetectionCache::EntryPtr entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(string(romData->className()), entry->className);
+	EXPECT_EQ(0, DetectionCache::flush());
+	EXPECT_EQ(1U, DetectionCache::stats().flushes);
+
+	// Reload the index. This discards the in-memory state.
+	DetectionCache::setIndexFilename(m_indexFilename.c_str());
+	entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(1U, DetectionCache::stats().hits);
+	EXPECT_EQ(0U, DetectionCache::stats().misses);
+
+	EXPECT_TRUE(entry->isSupported());
+	EXPECT_EQ(string(romData->className()), entry->className);
+	EXPECT_EQ(romData->fileType(), entry->fileType);
+	EXPECT_EQ(romData->hasDangerousPermissions(), entry->hasDangerousPermissions);
+
+	// Compare the metadata properties.
+	ASSERT_NE(nullptr, entry->metaData);
+	ASSERT_EQ(expectedMetaData->count(), entry->metaData->count());
+	for (const RomMetaData::MetaData &prop : *expectedMetaData) {
+		const RomMetaData::MetaData *const cachedProp = entry->metaData->get(prop.name);
+		ASSERT_NE(nullptr, cachedProp);
+		ASSERT_EQ(prop.type, cachedProp->type);
+		if (prop.type == PropertyType::String) {
+			EXPECT_STREQ(prop.data.str, cachedProp->data.str);
+		} else {
+			EXPECT_EQ(prop.data.iptrvalue, cachedProp->data.iptrvalue);
+		}
+	}
+}
+
+/**
+ * Modifying a file invalidates its cached results.
+ */
+TEST_F(DetectionCacheTest, fileModified)
+{
+	const string filename = m_tmpDir + "/modified.lnx";
+	m_files.push_back(filename);
+	writeFile(filename, makeLynxRom("Original"));
+
+	DetectionCache::EntryPtr entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_TRUE(entry->isSupported());
+	EXPECT_EQ(0, DetectionCache::flush());
+
+	// Change the modification time.
+	struct timespec times[2];
+	times[0].tv_sec = 0;
+	times[0].tv_nsec = UTIME_OMIT;
+	times[1].tv_sec = 1000000000;
+	times[1].tv_nsec = 123456789;
+	ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, 0));
+	entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(2U, DetectionCache::stats().misses);
+
+	// Replace the file with an unsupported file.
+	writeFile(filename, vector<uint8_t>(1024, 0));
+	entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_FALSE(entry->isSupported());
+	EXPECT_EQ(3U, DetectionCache::stats().misses);
+	EXPECT_EQ(0U, DetectionCache::stats().hits);
+}
+
+/**
+ * The index is discarded if it was written by a different build.
+ */
+TEST_F(DetectionCacheTest, buildIdMismatch)
+{
+	const string filename = m_tmpDir + "/build.bin";
+	m_files.push_back(filename);
+	writeFile(filename, vector<uint8_t>(1024, 0x5A));
+
+	DetectionCache::EntryPtr entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_FALSE(entry->isSupported());
+	EXPECT_EQ(0, DetectionCache::flush());
+
+	// Change the build ID in the index header.
+	// NOTE: The build ID is at offset 32.
+	const int fd = open(m_indexFilename.c_str(), O_RDWR);
+	ASSERT_GE(fd, 0);
+	uint64_t build_id = 0;
+	EXPECT_EQ(static_cast<ssize_t>(sizeof(build_id)), pread(fd, &build_id, sizeof(build_id), 32));
+	build_id = ~build_id;
+	EXPECT_EQ(static_cast<ssize_t>(sizeof(build_id)), pwrite(fd, &build_id, sizeof(build_id), 32));
+	close(fd);
+
+	// Reload the index. The cached result should not be used.
+	DetectionCache::setIndexFilename(m_indexFilename.c_str());
+	entry = DetectionCache::lookup(filename);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(0U, DetectionCache::stats().hits);
+	EXPECT_EQ(1U, DetectionCache::stats().misses);
+}
+
+/**
+ * Different RomDataAttr values are cached separately.
+ */
+TEST_F(DetectionCacheTest, attrsAreKeyed)
+{
+	const string filename = m_tmpDir + "/attrs.lnx";
+	m_files.push_back(filename);
+	writeFile(filename, makeLynxRom("Attrs"));
+
+	DetectionCache::EntryPtr entry = DetectionCache::lookup(filename, 0);
+	ASSERT_NE(nullptr, entry);
+	entry = DetectionCache::lookup(filename, RomDataFactory::RDA_HAS_METADATA);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(2U, DetectionCache::stats().misses);
+
+	entry = DetectionCache::lookup(filename, RomDataFactory::RDA_HAS_METADATA);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(1U, DetectionCache::stats().hits);
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_FILE_WRITE;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRomData test suite: DetectionCache tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
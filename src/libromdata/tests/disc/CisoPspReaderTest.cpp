@@ -0,0 +1,439 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CisoPspReaderTest.cpp: CisoPspReader parallel decompression test.       *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// zlib
+#include <zlib.h>
+
+// Other rom-properties libraries
+#include "librpbyteswap/byteswap_rp.h"
+#include "librpfile/VectorFile.hpp"
+using namespace LibRpFile;
+
+// libromdata
+#include "disc/CisoPspReader.hpp"
+#include "disc/ciso_psp_structs.h"
+using namespace LibRpBase;
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+using std::array;
+using std::vector;
+
+// libfmt
+#include "rp-libfmt.h"
+
+namespace LibRomData { namespace Tests {
+
+class CisoPspReaderTest : public ::testing::Test
+{
+protected:
+	CisoPspReaderTest()
+	{
+		if (m_pool.empty()) {
+			initBlockPool();
+		}
+	}
+
+public:
+	// Block size
+	static constexpr unsigned int BLOCK_SIZE = 2048;
+
+	// Number of distinct blocks in the synthetic image
+	static constexpr unsigned int POOL_SIZE = 256;
+
+	// Synthetic image sizes
+	static constexpr off64_t TEST_IMAGE_SIZE = 16LL * 1024 * 1024;
+	static constexpr off64_t BENCHMARK_IMAGE_SIZE = 1024LL * 1024 * 1024;
+
+	// Read size for benchmarks
+	static constexpr size_t BENCHMARK_READ_SIZE = 4U * 1024 * 1024;
+
+	struct PoolBlock {
+		array<uint8_t, BLOCK_SIZE> data;	// Uncompressed data
+		vector<uint8_t> z_data;			// Compressed data (empty if stored uncompressed)
+	};
+
+	// Block pool (shared between tests)
+	static vector<PoolBlock> m_pool;
+
+	/**
+	 * Get the pool index for a block in the synthetic image.
+	 * @param blockIdx Block index
+	 * @return Pool index
+	 */
+	static inline unsigned int poolIndex(uint32_t blockIdx)
+	{
+		return (blockIdx * 2654435761U) >> 24;
+	}
+
+	/**
+	 * Initialize the block pool.
+	 * Blocks contain a repeating pattern with some pseudo-random
+	 * bytes, which compresses roughly 5:1 with deflate.
+	 */
+	static void initBlockPool(void);
+
+	/**
+	 * Create a synthetic CISO v1 image.
+	 * @param size Uncompressed image size (must be a multiple of BLOCK_SIZE)
+	 * @return Synthetic image
+	 */
+	static IRpFilePtr createCisoImage(off64_t size);
+
+	/**
+	 * Verify data read from a synthetic image.
+	 * @param pBuf	[in] Data buffer
+	 * @param pos	[in] Starting position in the image
+	 * @param size	[in] Data size
+	 * @return True if the data matches; false if not.
+	 */
+	static bool checkData(const uint8_t *pBuf, off64_t pos, size_t size);
+
+	/**
+	 * Open a synthetic image using CisoPspReader.
+	 * @param file		[in] Synthetic image
+	 * @param threads	[in] Number of decompression threads
+	 * @return CisoPspReader
+	 */
+	static IDiscReaderPtr openReader(const IRpFilePtr &file, unsigned int threads);
+};
+
+vector<CisoPspReaderTest::PoolBlock> CisoPspReaderTest::m_pool;
+
+/**
+ * Initialize the block pool.
+ * Blocks contain a repeating pattern with some pseudo-random
+ * bytes, which compresses roughly 5:1 with deflate.
+ */
+void CisoPspReaderTest::initBlockPool(void)
+{
+	m_pool.resize(POOL_SIZE);
+	uint32_t lcg = 0x12345678U;
+	for (unsigned int i = 0; i < POOL_SIZE; i++) {
+		PoolBlock &block = m_pool[i];
+		for (unsigned int j = 0; j < BLOCK_SIZE; j++) {
+			if ((j % 32) < 2) {
+				lcg = (lcg * 1103515245U) + 12345U;
+				block.data[j] = static_cast<uint8_t>(lcg >> 16);
+			} else {
+				block.data[j] = static_cast<uint8_t>('A' + (j % 32) + (i % 8));
+			}
+		}
+
+		if ((i % 16) == 15) {
+			// Store this block uncompressed.
+			continue;
+		}
+
+		// Compress the block using raw deflate.
+		z_stream strm = { };
+		int ret = deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+		ASSERT_EQ(Z_OK, ret);
+		block.z_data.resize(deflateBound(&strm, BLOCK_SIZE));
+		strm.next_in = block.data.data();
+		strm.avail_in = BLOCK_SIZE;
+		strm.next_out = block.z_data.data();
+		strm.avail_out = static_cast<uInt>(block.z_data.size());
+		ret = deflate(&strm, Z_FINISH);
+		ASSERT_EQ(Z_STREAM_END, ret);
+		block.z_data.resize(strm.total_out);
+		deflateEnd(&strm);
+		ASSERT_LT(block.z_data.size(), BLOCK_SIZE);
+	}
+}
+
+/**
+ * Create a synthetic CISO v1 image.
+ * @param size Uncompressed image size (must be a multiple of BLOCK_SIZE)
+ * @return Synthetic image
+ */
+IRpFilePtr CisoPspReaderTest::createCisoImage(off64_t size)
+{
+	const uint32_t num_blocks = static_cast<uint32_t>(size / BLOCK_SIZE);
+	const size_t index_size = (num_blocks + 1) * sizeof(uint32_t);
+
+	std::shared_ptr<VectorFile> file = std::make_shared<VectorFile>();
+	vector<uint8_t> &vec = file->vector();
+	vec.reserve(sizeof(CisoPspHeader) + index_size + ((size_t)num_blocks * (BLOCK_SIZE / 5)));
+	vec.resize(sizeof(CisoPspHeader) + index_size);
+
+	CisoPspHeader *const header = reinterpret_cast<CisoPspHeader*>(vec.data());
+	header->magic = cpu_to_be32(CISO_MAGIC);
+	header->header_size = cpu_to_le32(sizeof(CisoPspHeader));
+	header->uncompressed_size = cpu_to_le64(size);
+	header->block_size = cpu_to_le32(BLOCK_SIZE);
+	header->version = 1;
+	header->index_shift = 0;
+
+	for (uint32_t i = 0; i < num_blocks; i++) {
+		const PoolBlock &block = m_pool[poolIndex(i)];
+		uint32_t indexEntry = static_cast<uint32_t>(vec.size());
+		if (block.z_data.empty()) {
+			indexEntry |= CISO_PSP_V0_NOT_COMPRESSED;
+			vec.insert(vec.end(), block.data.cbegin(), block.data.cend());
+		} else {
+			vec.insert(vec.end(), block.z_data.cbegin(), block.z_data.cend());
+		}
+		// NOTE: vec.data() may have changed.
+		uint32_t *const pIndex = reinterpret_cast<uint32_t*>(&vec[sizeof(CisoPspHeader)]);
+		pIndex[i] = cpu_to_le32(indexEntry);
+	}
+	uint32_t *const pIndex = reinterpret_cast<uint32_t*>(&vec[sizeof(CisoPspHeader)]);
+	pIndex[num_blocks] = cpu_to_le32(static_cast<uint32_t>(vec.size()));
+
+	return file;
+}
+
+/**
+ * Verify data read from a synthetic image.
+ * @param pBuf	[in] Data buffer
+ * @param pos	[in] Starting position in the image
+ * @param size	[in] Data size
+ * @return True if the data matches; false if not.
+ */
+bool CisoPspReaderTest::checkData(const uint8_t *pBuf, off64_t pos, size_t size)
+{
+	while (size > 0) {
+		const uint32_t blockIdx = static_cast<uint32_t>(pos / BLOCK_SIZE);
+		const unsigned int blockPos = static_cast<unsigned int>(pos % BLOCK_SIZE);
+		const size_t sz = std::min(size, static_cast<size_t>(BLOCK_SIZE - blockPos));
+		if (memcmp(pBuf, &m_pool[poolIndex(blockIdx)].data[blockPos], sz) != 0) {
+			return false;
+		}
+		pBuf += sz;
+		pos += sz;
+		size -= sz;
+	}
+	return true;
+}
+
+/**
+ * Open a synthetic image using CisoPspReader.
+ * @param file		[in] Synthetic image
+ * @param threads	[in] Number of decompression threads
+ * @return CisoPspReader
+ */
+IDiscReaderPtr CisoPspReaderTest::openReader(const IRpFilePtr &file, unsigned int threads)
+{
+	// NOTE: Only some CisoPspReader functions are exported, so the
+	// reader must be accessed using the IDiscReader virtual functions.
+	SparseDiscReader *const sparseReader = new CisoPspReader(file);
+	sparseReader->setDecompressionThreads(threads);
+	return IDiscReaderPtr(static_cast<IDiscReader*>(sparseReader));
+}
+
+/**
+ * Read the entire image using 1, 2, and 4 threads.
+ */
+TEST_F(CisoPspReaderTest, readAll)
+{
+	IRpFilePtr file = createCisoImage(TEST_IMAGE_SIZE);
+	vector<uint8_t> buf(TEST_IMAGE_SIZE);
+
+	for (unsigned int threads : {1U, 2U, 4U}) {
+		const IDiscReaderPtr reader = openReader(file, threads);
+		ASSERT_TRUE(reader->isOpen());
+		ASSERT_EQ(TEST_IMAGE_SIZE, reader->size());
+
+		memset(buf.data(), 0xCC, buf.size());
+		EXPECT_EQ(buf.size(), reader->read(buf.data(), buf.size())) << "threads == " << threads;
+		EXPECT_TRUE(checkData(buf.data(), 0, buf.size())) << "threads == " << threads;
+	}
+}
+
+/**
+ * Read unaligned ranges, with some blocks already in the block cache.
+ */
+TEST_F(CisoPspReaderTest, readUnaligned)
+{
+	IRpFilePtr file = createCisoImage(TEST_IMAGE_SIZE);
+	vector<uint8_t> buf(1024 * 1024 + 4096);
+
+	for (unsigned int threads : {1U, 4U}) {
+		const IDiscReaderPtr reader = openReader(file, threads);
+		ASSERT_TRUE(reader->isOpen());
+
+		// Read a few blocks to put them in the block cache.
+		ASSERT_EQ(0, reader->seek(BLOCK_SIZE * 100 + 7, IRpFile::SeekWhence::Set));
+		EXPECT_EQ(BLOCK_SIZE * 3U, reader->read(buf.data(), BLOCK_SIZE * 3));
+		EXPECT_TRUE(checkData(buf.data(), BLOCK_SIZE * 100 + 7, BLOCK_SIZE * 3));
+
+		// Large unaligned read that overlaps the cached blocks.
+		const off64_t pos = BLOCK_SIZE * 90 + 1000;
+		ASSERT_EQ(0, reader->seek(pos, IRpFile::SeekWhence::Set));
+		memset(buf.data(), 0xCC, buf.size());
+		EXPECT_EQ(buf.size(), reader->read(buf.data(), buf.size())) << "threads == " << threads;
+		EXPECT_TRUE(checkData(buf.data(), pos, buf.size())) << "threads == " << threads;
+		EXPECT_EQ(pos + static_cast<off64_t>(buf.size()), reader->tell());
+
+		// Short read at the end of the image.
+		ASSERT_EQ(0, reader->seek(TEST_IMAGE_SIZE - 300000, IRpFile::SeekWhence::Set));
+		EXPECT_EQ(300000U, reader->read(buf.data(), buf.size())) << "threads == " << threads;
+		EXPECT_TRUE(checkData(buf.data(), TEST_IMAGE_SIZE - 300000, 300000)) << "threads == " << threads;
+	}
+}
+
+/**
+ * Check the LRU block cache: hit/miss counts and eviction order.
+ */
+TEST_F(CisoPspReaderTest, blockCache)
+{
+	static constexpr unsigned int CACHE_BLOCKS = 4;
+	IRpFilePtr file = createCisoImage(BLOCK_SIZE * 64);
+	const IDiscReaderPtr reader = openReader(file, 1);
+	ASSERT_TRUE(reader->isOpen());
+	SparseDiscReader *const sparseReader = static_cast<SparseDiscReader*>(reader.get());
+	sparseReader->setBlockCacheSize(BLOCK_SIZE * CACHE_BLOCKS);
+
+	SparseDiscReader::BlockCacheStats stats = sparseReader->blockCacheStats();
+	EXPECT_EQ(0U, stats.hits);
+	EXPECT_EQ(0U, stats.misses);
+	EXPECT_EQ(0U, stats.size);
+	EXPECT_EQ(BLOCK_SIZE * CACHE_BLOCKS, stats.maxSize);
+
+	// Read a single block and verify the data.
+	array<uint8_t, BLOCK_SIZE> buf;
+	auto readBlock = [&reader, &buf](uint32_t blockIdx) {
+		ASSERT_EQ(0, reader->seek(static_cast<off64_t>(blockIdx) * BLOCK_SIZE, IRpFile::SeekWhence::Set));
+		memset(buf.data(), 0xCC, buf.size());
+		ASSERT_EQ(buf.size(), reader->read(buf.data(), buf.size())) << "block " << blockIdx;
+		EXPECT_TRUE(checkData(buf.data(), static_cast<off64_t>(blockIdx) * BLOCK_SIZE, buf.size())) << "block " << blockIdx;
+	};
+	auto checkStats = [sparseReader](uint64_t hits, uint64_t misses, unsigned int blocks) {
+		const SparseDiscReader::BlockCacheStats stats = sparseReader->blockCacheStats();
+		EXPECT_EQ(hits, stats.hits);
+		EXPECT_EQ(misses, stats.misses);
+		EXPECT_EQ(static_cast<size_t>(BLOCK_SIZE) * blocks, stats.size);
+	};
+
+	// Fill the cache.
+	for (uint32_t i = 0; i < CACHE_BLOCKS; i++) {
+		ASSERT_NO_FATAL_FAILURE(readBlock(i));
+	}
+	checkStats(0, 4, 4);
+
+	// Read block 0 again. This makes it the most recently used block.
+	// LRU order, most recent first: 0, 3, 2, 1
+	ASSERT_NO_FATAL_FAILURE(readBlock(0));
+	checkStats(1, 4, 4);
+
+	// A partial read within a cached block is also a hit.
+	ASSERT_EQ(0, reader->seek(50, IRpFile::SeekWhence::Set));
+	ASSERT_EQ(100U, reader->read(buf.data(), 100));
+	EXPECT_TRUE(checkData(buf.data(), 50, 100));
+	checkStats(2, 4, 4);
+
+	// Block 4 evicts block 1, the least recently used block.
+	// LRU order: 4, 0, 3, 2
+	ASSERT_NO_FATAL_FAILURE(readBlock(4));
+	checkStats(2, 5, 4);
+
+	// Blocks 0, 2, and 3 are still cached.
+	// LRU order: 3, 2, 0, 4
+	ASSERT_NO_FATAL_FAILURE(readBlock(0));
+	ASSERT_NO_FATAL_FAILURE(readBlock(2));
+	ASSERT_NO_FATAL_FAILURE(readBlock(3));
+	checkStats(5, 5, 4);
+
+	// Block 1 was evicted, and now evicts block 4.
+	// LRU order: 1, 3, 2, 0
+	ASSERT_NO_FATAL_FAILURE(readBlock(1));
+	checkStats(5, 6, 4);
+
+	// Block 4 was evicted, and now evicts block 0.
+	// LRU order: 4, 1, 3, 2
+	ASSERT_NO_FATAL_FAILURE(readBlock(4));
+	checkStats(5, 7, 4);
+	ASSERT_NO_FATAL_FAILURE(readBlock(0));
+	checkStats(5, 8, 4);
+
+	// Shrinking the cache keeps the most recently used block.
+	sparseReader->setBlockCacheSize(0);
+	stats = sparseReader->blockCacheStats();
+	EXPECT_EQ(0U, stats.maxSize);
+	checkStats(5, 8, 1);
+	ASSERT_NO_FATAL_FAILURE(readBlock(0));
+	checkStats(6, 8, 1);
+	ASSERT_NO_FATAL_FAILURE(readBlock(3));
+	checkStats(6, 9, 1);
+	ASSERT_NO_FATAL_FAILURE(readBlock(0));
+	checkStats(6, 10, 1);
+}
+
+/**
+ * Benchmark: Read a 1 GiB image end to end using 1..N threads.
+ */
+TEST_F(CisoPspReaderTest, read_benchmark)
+{
+	IRpFilePtr file = createCisoImage(BENCHMARK_IMAGE_SIZE);
+	fmt::print(FSTR("Synthetic image: {:d} MiB uncompressed, {:d} MiB compressed\n"),
+		BENCHMARK_IMAGE_SIZE / (1024 * 1024), file->size() / (1024 * 1024));
+
+	const unsigned int maxThreads = std::max(4U, std::thread::hardware_concurrency());
+	vector<uint8_t> buf(BENCHMARK_READ_SIZE);
+	uLong crc_1t = 0;
+
+	for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+		const IDiscReaderPtr reader = openReader(file, threads);
+		ASSERT_TRUE(reader->isOpen());
+
+		uLong crc = crc32(0L, nullptr, 0);
+		off64_t total = 0;
+		std::chrono::steady_clock::duration elapsed{};
+		for (;;) {
+			const auto start = std::chrono::steady_clock::now();
+			const size_t size = reader->read(buf.data(), buf.size());
+			elapsed += std::chrono::steady_clock::now() - start;
+			if (size == 0)
+				break;
+			crc = crc32(crc, buf.data(), static_cast<uInt>(size));
+			total += size;
+		}
+		EXPECT_EQ(BENCHMARK_IMAGE_SIZE, total);
+		if (threads == 1) {
+			crc_1t = crc;
+		} else {
+			EXPECT_EQ(crc_1t, crc) << "threads == " << threads;
+		}
+
+		const double secs = std::chrono::duration<double>(elapsed).count();
+		fmt::print(FSTR("{:2d} thread(s): {:8.1f} MB/s\n"), threads,
+			(secs > 0) ? (static_cast<double>(total) / 1000000.0 / secs) : 0.0);
+	}
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = 0;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRomData test suite: CisoPspReader tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
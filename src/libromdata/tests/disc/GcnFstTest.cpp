@@ -145,6 +145,13 @@ public:
 	 */
 	void checkNoDuplicateFilenames(const char *subdir);
 
+	/**
+	 * Recursively check that find_file() returns the same
+	 * information as readdir() for all files in a subdirectory.
+	 * @param subdir Subdirectory path.
+	 */
+	void checkFindFile(const string &subdir);
+
 public:
 	/** Test case parameters **/
 
@@ -382,6 +389,55 @@ void GcnFstTest::checkNoDuplicateFilenames(const char *subdir)
 	m_fst->closedir(dirp);
 }
 
+/**
+ * Recursively check that find_file() returns the same
+ * information as readdir() for all files in a subdirectory.
+ * @param subdir Subdirectory path.
+ */
+void GcnFstTest::checkFindFile(const string &subdir)
+{
+	IFst::Dir *dirp = m_fst->opendir(subdir.c_str());
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	vector<string> subdirs;
+	const IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		string path = subdir;
+		if (path.empty() || path[path.size()-1] != '/') {
+			path += '/';
+		}
+		path += dirent->name;
+
+		IFst::DirEnt find_dirent;
+		EXPECT_EQ(0, m_fst->find_file(path.c_str(), &find_dirent)) <<
+			"find_file() failed for '" << path << "'.";
+		EXPECT_EQ(dirent->type, find_dirent.type) << "path: " << path;
+		EXPECT_EQ(dirent->offset, find_dirent.offset) << "path: " << path;
+		EXPECT_EQ(dirent->size, find_dirent.size) << "path: " << path;
+		EXPECT_STREQ(dirent->name, find_dirent.name) << "path: " << path;
+
+		if (dirent->type == DT_DIR) {
+			subdirs.push_back(std::move(path));
+		} else {
+			// Files can't have subdirectories.
+			path += "/x";
+			EXPECT_EQ(-ENOENT, m_fst->find_file(path.c_str(), &find_dirent)) << "path: " << path;
+		}
+
+		// Next entry.
+		dirent = m_fst->readdir(dirp);
+	}
+
+	// End of directory.
+	m_fst->closedir(dirp);
+
+	// Check subdirectories.
+	for (const string &p : subdirs) {
+		ASSERT_NO_FATAL_FAILURE(checkFindFile(p));
+	}
+}
+
 /**
  * Verify that '/' is collapsed correctly.
  */
@@ -406,6 +462,20 @@ TEST_P(GcnFstTest, NoDuplicateFilenames)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Make sure find_file() finds all files and directories.
+ */
+TEST_P(GcnFstTest, FindFile)
+{
+	ASSERT_NO_FATAL_FAILURE(checkFindFile("/"));
+
+	// Paths that don't exist.
+	IFst::DirEnt dirent;
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this-file-does-not-exist", &dirent));
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this-dir-does-not-exist/file", &dirent));
+	EXPECT_FALSE(m_fst->hasErrors());
+}
+
 /**
  * Print the FST directory structure and compare it to a known-good version.
  */
@@ -0,0 +1,478 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WiiPartitionTest.cpp: WiiPartition sector cache test.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// Other rom-properties libraries
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpbyteswap/byteswap_rp.h"
+#include "librpfile/VectorFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// libromdata
+#include "disc/WiiPartition.hpp"
+#include "Console/gcn_structs.h"
+#include "Console/wii_structs.h"
+#include "Console/WiiTicket.hpp"
+
+// C includes (C++ namespace)
+#include <cstddef>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class WiiPartitionTest : public ::testing::Test
+{
+public:
+	// Sector sizes
+	static constexpr unsigned int SECTOR_SIZE_ENCRYPTED = 0x8000U;
+	static constexpr unsigned int SECTOR_SIZE_DECRYPTED = 0x7C00U;
+	static constexpr unsigned int SECTOR_SIZE_HASHES = 0x400U;
+
+	// Number of sectors in the synthetic partition
+	static constexpr unsigned int NUM_SECTORS = 64;
+
+	// Data offset, relative to the partition header
+	static constexpr unsigned int DATA_OFFSET = 0x8000U;
+
+	/**
+	 * Get the expected data byte at the specified partition position.
+	 * @param pos Partition position
+	 * @return Data byte
+	 */
+	static inline uint8_t dataByte(off64_t pos)
+	{
+		const uint32_t pos32 = static_cast<uint32_t>(pos);
+		return static_cast<uint8_t>((pos32 * 2654435761U) >> 24);
+	}
+
+	/**
+	 * Create a synthetic unencrypted Wii partition.
+	 * @param cryptoMethod Crypto method (CM_NASOS or CM_RVTH)
+	 * @return Synthetic partition
+	 */
+	static IRpFilePtr createPartition(WiiPartition::CryptoMethod cryptoMethod);
+
+#ifdef ENABLE_DECRYPTION
+	/**
+	 * Create a synthetic encrypted Wii partition.
+	 *
+	 * IAesCipher can't encrypt, so the sector data is generated
+	 * as ciphertext, and the expected plaintext is obtained by
+	 * decrypting it with the title key.
+	 *
+	 * @param commonKey	[in] Wii common key
+	 * @param plainData	[out] Expected decrypted data
+	 * @return Synthetic partition, or nullptr on error.
+	 */
+	static IRpFilePtr createEncryptedPartition(const KeyManager::KeyData_t &commonKey, vector<uint8_t> &plainData);
+#endif /* ENABLE_DECRYPTION */
+
+	/**
+	 * Verify data read from a synthetic partition.
+	 * @param pBuf	[in] Data buffer
+	 * @param pos	[in] Starting position in the partition
+	 * @param size	[in] Data size
+	 * @return True if the data matches; false if not.
+	 */
+	static bool checkData(const uint8_t *pBuf, off64_t pos, size_t size);
+
+	/**
+	 * Open a synthetic partition using WiiPartition.
+	 * @param pPartition	[out] WiiPartition (owned by the returned IDiscReaderPtr)
+	 * @param file		[in] Synthetic partition
+	 * @param cryptoMethod	[in] Crypto method
+	 * @return WiiPartition
+	 */
+	static IDiscReaderPtr openPartition(WiiPartition **pPartition, const IRpFilePtr &file,
+		WiiPartition::CryptoMethod cryptoMethod);
+};
+
+/**
+ * Create a synthetic unencrypted Wii partition.
+ * @param cryptoMethod Crypto method (CM_NASOS or CM_RVTH)
+ * @return Synthetic partition
+ */
+IRpFilePtr WiiPartitionTest::createPartition(WiiPartition::CryptoMethod cryptoMethod)
+{
+	const bool hasHashes = ((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_1K_31K);
+	const unsigned int data_sector_size = (hasHashes ? SECTOR_SIZE_DECRYPTED : SECTOR_SIZE_ENCRYPTED);
+
+	std::shared_ptr<VectorFile> file = std::make_shared<VectorFile>();
+	vector<uint8_t> &vec = file->vector();
+	vec.resize(DATA_OFFSET + (NUM_SECTORS * SECTOR_SIZE_ENCRYPTED));
+
+	RVL_PartitionHeader *const partitionHeader = reinterpret_cast<RVL_PartitionHeader*>(vec.data());
+	partitionHeader->ticket.signature_type = cpu_to_be32(RVL_CERT_SIGTYPE_RSA2048_SHA1);
+	partitionHeader->data_offset.val = cpu_to_be32(DATA_OFFSET >> 2);
+	partitionHeader->data_size.val = cpu_to_be32((NUM_SECTORS * SECTOR_SIZE_ENCRYPTED) >> 2);
+
+	off64_t pos = 0;
+	uint8_t *p = &vec[DATA_OFFSET];
+	for (unsigned int sector = 0; sector < NUM_SECTORS; sector++) {
+		if (hasHashes) {
+			// Dummy hashes. These should never be returned by read().
+			memset(p, 0xEE, SECTOR_SIZE_HASHES);
+			p += SECTOR_SIZE_HASHES;
+		}
+		for (unsigned int i = 0; i < data_sector_size; i++, pos++) {
+			*p++ = dataByte(pos);
+		}
+	}
+
+	return file;
+}
+
+#ifdef ENABLE_DECRYPTION
+/**
+ * Create a synthetic encrypted Wii partition.
+ *
+ * IAesCipher can't encrypt, so the sector data is generated
+ * as ciphertext, and the expected plaintext is obtained by
+ * decrypting it with the title key.
+ *
+ * @param commonKey	[in] Wii common key
+ * @param plainData	[out] Expected decrypted data
+ * @return Synthetic partition, or nullptr on error.
+ */
+IRpFilePtr WiiPartitionTest::createEncryptedPartition(const KeyManager::KeyData_t &commonKey, vector<uint8_t> &plainData)
+{
+	std::shared_ptr<VectorFile> file = std::make_shared<VectorFile>();
+	vector<uint8_t> &vec = file->vector();
+	vec.resize(DATA_OFFSET + (NUM_SECTORS * SECTOR_SIZE_ENCRYPTED));
+
+	// The ticket issuer determines the common key. (CA00000001-XS00000003: rvl-common)
+	RVL_PartitionHeader *const partitionHeader = reinterpret_cast<RVL_PartitionHeader*>(vec.data());
+	RVL_Ticket &ticket = partitionHeader->ticket;
+	ticket.signature_type = cpu_to_be32(RVL_CERT_SIGTYPE_RSA2048_SHA1);
+	strcpy(ticket.signature_issuer, "Root-CA00000001-XS00000003");
+	ticket.ticket_format_version = 0;
+	ticket.title_id.hi = cpu_to_be32(0x00010000);
+	ticket.title_id.lo = cpu_to_be32(0x52535054);	// "RSPT"
+	for (unsigned int i = 0; i < sizeof(ticket.enc_title_key); i++) {
+		ticket.enc_title_key[i] = static_cast<uint8_t>(0x10 + i);
+	}
+	partitionHeader->data_offset.val = cpu_to_be32(DATA_OFFSET >> 2);
+	partitionHeader->data_size.val = cpu_to_be32((NUM_SECTORS * SECTOR_SIZE_ENCRYPTED) >> 2);
+
+	// Decrypt the title key the same way WiiTicket does.
+	// The title ID is used as the IV.
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	if (!cipher || !cipher->isInit() ||
+	    cipher->setKey(commonKey.key, commonKey.length) != 0 ||
+	    cipher->setChainingMode(IAesCipher::ChainingMode::CBC) != 0)
+	{
+		return nullptr;
+	}
+	uint8_t iv[16];
+	memcpy(iv, ticket.title_id.u8, 8);
+	memset(&iv[8], 0, 8);
+	uint8_t title_key[16];
+	memcpy(title_key, ticket.enc_title_key, sizeof(title_key));
+	if (cipher->decrypt(title_key, sizeof(title_key), iv, sizeof(iv)) != sizeof(title_key)) {
+		return nullptr;
+	}
+	if (cipher->setKey(title_key, sizeof(title_key)) != 0) {
+		return nullptr;
+	}
+
+	// Encrypted sector data, including the hashes.
+	uint8_t *p = &vec[DATA_OFFSET];
+	for (unsigned int i = 0; i < NUM_SECTORS * SECTOR_SIZE_ENCRYPTED; i++) {
+		p[i] = dataByte(i);
+	}
+
+	// WiiPartition checks for the Wii magic number in sector 0.
+	// In CBC mode, plaintext block 1 is D(C1) ^ C0, so adjust
+	// the bytes in C0 that correspond to the magic number.
+	uint8_t *const sector0 = &vec[DATA_OFFSET + SECTOR_SIZE_HASHES];
+	uint8_t block1[16];
+	memcpy(block1, &sector0[16], sizeof(block1));
+	memset(iv, 0, sizeof(iv));
+	if (cipher->decrypt(block1, sizeof(block1), iv, sizeof(iv)) != sizeof(block1)) {
+		return nullptr;
+	}
+	const uint32_t magic_wii = cpu_to_be32(WII_MAGIC);
+	const uint8_t *const pMagic = reinterpret_cast<const uint8_t*>(&magic_wii);
+	static_assert(offsetof(GCN_DiscHeader, magic_wii) == 16 + 8, "GCN_DiscHeader::magic_wii is in the wrong place");
+	for (unsigned int i = 0; i < 4; i++) {
+		sector0[8 + i] = block1[8 + i] ^ pMagic[i];
+	}
+
+	// Decrypt the sectors to get the expected data.
+	// Each sector's IV is stored in the encrypted hash block.
+	plainData.resize(NUM_SECTORS * SECTOR_SIZE_DECRYPTED);
+	uint8_t *dest = plainData.data();
+	for (unsigned int sector = 0; sector < NUM_SECTORS; sector++, p += SECTOR_SIZE_ENCRYPTED) {
+		memcpy(dest, &p[SECTOR_SIZE_HASHES], SECTOR_SIZE_DECRYPTED);
+		if (cipher->decrypt(dest, SECTOR_SIZE_DECRYPTED, &p[0x3D0], 16) != SECTOR_SIZE_DECRYPTED) {
+			return nullptr;
+		}
+		dest += SECTOR_SIZE_DECRYPTED;
+	}
+
+	return file;
+}
+#endif /* ENABLE_DECRYPTION */
+
+/**
+ * Verify data read from a synthetic partition.
+ * @param pBuf	[in] Data buffer
+ * @param pos	[in] Starting position in the partition
+ * @param size	[in] Data size
+ * @return True if the data matches; false if not.
+ */
+bool WiiPartitionTest::checkData(const uint8_t *pBuf, off64_t pos, size_t size)
+{
+	for (; size > 0; pBuf++, pos++, size--) {
+		if (*pBuf != dataByte(pos)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Open a synthetic partition using WiiPartition.
+ * @param pPartition	[out] WiiPartition (owned by the returned IDiscReaderPtr)
+ * @param file		[in] Synthetic partition
+ * @param cryptoMethod	[in] Crypto method
+ * @return WiiPartition
+ */
+IDiscReaderPtr WiiPartitionTest::openPartition(WiiPartition **pPartition, const IRpFilePtr &file,
+	WiiPartition::CryptoMethod cryptoMethod)
+{
+	// NOTE: Only some WiiPartition functions are exported, so the
+	// partition must be accessed using the IDiscReader virtual functions.
+	const IDiscReaderPtr discReader = std::make_shared<DiscReader>(file);
+	WiiPartition *const partition = new WiiPartition(discReader, 0, file->size(), cryptoMethod);
+	*pPartition = partition;
+	return IDiscReaderPtr(static_cast<IDiscReader*>(partition));
+}
+
+/**
+ * Read an entire NASOS partition, then read it again using unaligned ranges.
+ */
+TEST_F(WiiPartitionTest, readNASOS)
+{
+	static constexpr size_t DATA_SIZE = NUM_SECTORS * SECTOR_SIZE_DECRYPTED;
+	const IRpFilePtr file = createPartition(WiiPartition::CM_NASOS);
+	WiiPartition *wiiPartition = nullptr;
+	const IDiscReaderPtr partition = openPartition(&wiiPartition, file, WiiPartition::CM_NASOS);
+	ASSERT_TRUE(partition->isOpen());
+
+	// Read the entire partition.
+	vector<uint8_t> buf(DATA_SIZE);
+	ASSERT_EQ(0, partition->seek(0, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(buf.size(), partition->read(buf.data(), buf.size()));
+	EXPECT_TRUE(checkData(buf.data(), 0, buf.size()));
+
+	// Unaligned reads of various sizes.
+	for (size_t size : {1U, 100U, 0x7C00U, 0x7C01U, 0x10000U, 0x40000U}) {
+		const off64_t pos = (SECTOR_SIZE_DECRYPTED * 3) + 123;
+		ASSERT_EQ(0, partition->seek(pos, IRpFile::SeekWhence::Set));
+		memset(buf.data(), 0xCC, size);
+		EXPECT_EQ(size, partition->read(buf.data(), size)) << "size == " << size;
+		EXPECT_TRUE(checkData(buf.data(), pos, size)) << "size == " << size;
+		EXPECT_EQ(pos + static_cast<off64_t>(size), partition->tell());
+	}
+
+	// Reading past the end of the sector data results in a short read.
+	ASSERT_EQ(0, partition->seek(DATA_SIZE - 1000, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(1000U, partition->read(buf.data(), 0x20000));
+	EXPECT_TRUE(checkData(buf.data(), DATA_SIZE - 1000, 1000));
+
+	// Partition is unencrypted, so nothing should have been decrypted.
+	EXPECT_EQ(0U, wiiPartition->sectorCacheStats().sectorsDecrypted);
+}
+
+/**
+ * Verify the sector cache and batched reads using the statistics.
+ */
+TEST_F(WiiPartitionTest, sectorCacheStats)
+{
+	const IRpFilePtr file = createPartition(WiiPartition::CM_NASOS);
+	WiiPartition *wiiPartition = nullptr;
+	const IDiscReaderPtr partition = openPartition(&wiiPartition, file, WiiPartition::CM_NASOS);
+	ASSERT_TRUE(partition->isOpen());
+
+	// Read sectors 4-7: Partial sector 4, full sectors 5 and 6
+	// (batched), and partial sector 7.
+	vector<uint8_t> buf(SECTOR_SIZE_DECRYPTED * 3);
+	const off64_t pos = (SECTOR_SIZE_DECRYPTED * 4) + 100;
+	ASSERT_EQ(0, partition->seek(pos, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(buf.size(), partition->read(buf.data(), buf.size()));
+	EXPECT_TRUE(checkData(buf.data(), pos, buf.size()));
+
+	WiiPartition::SectorCacheStats stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(0U, stats.hits);
+	EXPECT_EQ(4U, stats.sectorsRead);
+	EXPECT_EQ(1U, stats.batchReads);
+
+	// Read the same range again. Sectors 4 and 7 are cached.
+	// Sectors 5 and 6 were read using a batched read, so they
+	// aren't cached and will be read again.
+	ASSERT_EQ(0, partition->seek(pos, IRpFile::SeekWhence::Set));
+	memset(buf.data(), 0xCC, buf.size());
+	EXPECT_EQ(buf.size(), partition->read(buf.data(), buf.size()));
+	EXPECT_TRUE(checkData(buf.data(), pos, buf.size()));
+
+	stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(2U, stats.hits);
+	EXPECT_EQ(6U, stats.sectorsRead);
+	EXPECT_EQ(2U, stats.batchReads);
+
+	// Small reads within sectors 4 and 7 should use the cache.
+	ASSERT_EQ(0, partition->seek(SECTOR_SIZE_DECRYPTED * 4, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(16U, partition->read(buf.data(), 16));
+	EXPECT_TRUE(checkData(buf.data(), SECTOR_SIZE_DECRYPTED * 4, 16));
+	ASSERT_EQ(0, partition->seek(SECTOR_SIZE_DECRYPTED * 7 + 500, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(16U, partition->read(buf.data(), 16));
+	EXPECT_TRUE(checkData(buf.data(), SECTOR_SIZE_DECRYPTED * 7 + 500, 16));
+
+	stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(4U, stats.hits);
+	EXPECT_EQ(6U, stats.sectorsRead);
+
+	// Read more sectors than the sector cache can hold, one at a time,
+	// then read them again in reverse order. Only the most recently
+	// used sectors should still be cached.
+	for (unsigned int sector = 16; sector < 32; sector++) {
+		ASSERT_EQ(0, partition->seek(SECTOR_SIZE_DECRYPTED * sector, IRpFile::SeekWhence::Set));
+		EXPECT_EQ(16U, partition->read(buf.data(), 16));
+	}
+	stats = wiiPartition->sectorCacheStats();
+	const uint64_t hits_before = stats.hits;
+	const uint64_t sectorsRead_before = stats.sectorsRead;
+	for (unsigned int sector = 31; sector >= 16; sector--) {
+		ASSERT_EQ(0, partition->seek(SECTOR_SIZE_DECRYPTED * sector, IRpFile::SeekWhence::Set));
+		EXPECT_EQ(16U, partition->read(buf.data(), 16));
+		EXPECT_TRUE(checkData(buf.data(), SECTOR_SIZE_DECRYPTED * sector, 16));
+	}
+	stats = wiiPartition->sectorCacheStats();
+	EXPECT_GT(stats.hits, hits_before);
+	EXPECT_LT(stats.sectorsRead - sectorsRead_before, 16U);
+	EXPECT_EQ(0U, stats.sectorsDecrypted);
+}
+
+/**
+ * Read an RVT-H partition. (32K sectors with no hashes)
+ */
+TEST_F(WiiPartitionTest, readRVTH)
+{
+	static constexpr size_t DATA_SIZE = NUM_SECTORS * SECTOR_SIZE_ENCRYPTED;
+	const IRpFilePtr file = createPartition(WiiPartition::CM_RVTH);
+	WiiPartition *wiiPartition = nullptr;
+	const IDiscReaderPtr partition = openPartition(&wiiPartition, file, WiiPartition::CM_RVTH);
+	ASSERT_TRUE(partition->isOpen());
+
+	// Unaligned read spanning multiple sectors.
+	vector<uint8_t> buf(DATA_SIZE);
+	const off64_t pos = SECTOR_SIZE_ENCRYPTED + 321;
+	const size_t size = (SECTOR_SIZE_ENCRYPTED * 10) + 1000;
+	ASSERT_EQ(0, partition->seek(pos, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(size, partition->read(buf.data(), size));
+	EXPECT_TRUE(checkData(buf.data(), pos, size));
+
+	// The full sectors should have been read directly.
+	const WiiPartition::SectorCacheStats stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(11U, stats.sectorsRead);
+	EXPECT_EQ(1U, stats.batchReads);
+
+	// Read the entire partition.
+	ASSERT_EQ(0, partition->seek(0, IRpFile::SeekWhence::Set));
+	memset(buf.data(), 0xCC, buf.size());
+	EXPECT_EQ(buf.size() - 1, partition->read(buf.data(), buf.size() - 1));
+	EXPECT_TRUE(checkData(buf.data(), 0, buf.size() - 1));
+}
+
+#ifdef ENABLE_DECRYPTION
+/**
+ * Read an encrypted partition using batched decryption.
+ * This requires the Wii common key in keys.conf.
+ */
+TEST_F(WiiPartitionTest, readEncrypted)
+{
+	static constexpr size_t DATA_SIZE = NUM_SECTORS * SECTOR_SIZE_DECRYPTED;
+	static constexpr int keyIdx = static_cast<int>(WiiTicket::EncryptionKeys::Key_RVL_Common);
+
+	KeyManager::KeyData_t keyData;
+	const KeyManager::VerifyResult res = KeyManager::instance()->getAndVerify(
+		WiiTicket::encryptionKeyName_static(keyIdx), &keyData,
+		WiiTicket::encryptionVerifyData_static(keyIdx), 16);
+	if (res != KeyManager::VerifyResult::OK) {
+		GTEST_SKIP() << "Wii common key is not available: " << KeyManager::verifyResultToString(res);
+	}
+
+	vector<uint8_t> plainData;
+	const IRpFilePtr file = createEncryptedPartition(keyData, plainData);
+	ASSERT_TRUE((bool)file);
+	ASSERT_EQ(DATA_SIZE, plainData.size());
+	WiiPartition *wiiPartition = nullptr;
+	const IDiscReaderPtr partition = openPartition(&wiiPartition, file, WiiPartition::CM_STANDARD);
+	ASSERT_TRUE(partition->isOpen());
+
+	// Read the entire partition. Sector 0 is cached by initDecryption();
+	// the rest are read in batches of up to 16 sectors.
+	vector<uint8_t> buf(DATA_SIZE);
+	ASSERT_EQ(0, partition->seek(0, IRpFile::SeekWhence::Set));
+	EXPECT_EQ(buf.size(), partition->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(plainData.data(), buf.data(), buf.size()));
+
+	WiiPartition::SectorCacheStats stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(NUM_SECTORS, stats.sectorsRead);
+	EXPECT_EQ(NUM_SECTORS, stats.sectorsDecrypted);
+	EXPECT_EQ(4U, stats.batchReads);
+
+	// Unaligned reads that cross batch boundaries.
+	for (unsigned int start : {1U, 15U, 16U, 31U, 40U}) {
+		const off64_t pos = (SECTOR_SIZE_DECRYPTED * start) + 1234;
+		const size_t size = std::min<size_t>(SECTOR_SIZE_DECRYPTED * 20, DATA_SIZE - pos);
+		ASSERT_EQ(0, partition->seek(pos, IRpFile::SeekWhence::Set));
+		memset(buf.data(), 0xCC, size);
+		EXPECT_EQ(size, partition->read(buf.data(), size)) << "start == " << start;
+		EXPECT_EQ(0, memcmp(&plainData[pos], buf.data(), size)) << "start == " << start;
+	}
+
+	// Every sector that was read should have been decrypted.
+	stats = wiiPartition->sectorCacheStats();
+	EXPECT_EQ(stats.sectorsRead, stats.sectorsDecrypted);
+	EXPECT_GT(stats.batchReads, 4U);
+}
+#endif /* ENABLE_DECRYPTION */
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = 0;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRomData test suite: WiiPartition tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
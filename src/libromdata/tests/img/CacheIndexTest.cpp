@@ -0,0 +1,304 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CacheIndexTest.cpp: CacheIndex test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// libromdata
+#include "img/CacheIndex.hpp"
+
+// C includes
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <string>
+using std::string;
+
+namespace LibRomData { namespace Tests {
+
+class CacheIndexTest : public ::testing::Test
+{
+protected:
+	void SetUp(void) override;
+	void TearDown(void) override;
+
+public:
+	/**
+	 * Recursively delete a directory.
+	 * @param path Directory
+	 */
+	static void removeAll(const string &path);
+
+	/**
+	 * Create a cache file.
+	 * @param relPath Path relative to the cache directory
+	 * @param size File size
+	 * @param mtime Modification time
+	 */
+	void createFile(const string &relPath, size_t size, time_t mtime = 0);
+
+	/**
+	 * Check if a cache file exists.
+	 * @param relPath Path relative to the cache directory
+	 * @return True if it exists; false if not.
+	 */
+	bool exists(const string &relPath) const
+	{
+		return access((m_tmpDir + '/' + relPath).c_str(), F_OK) == 0;
+	}
+
+	/**
+	 * Create eight 200-byte files with increasing modification times,
+	 * then rebuild the index.
+	 * The oldest file is "sub/file0.png".
+	 */
+	void createEightFiles(void);
+
+public:
+	string m_tmpDir;	// Temporary directory
+};
+
+void CacheIndexTest::SetUp(void)
+{
+	m_tmpDir = ::testing::TempDir();
+	if (m_tmpDir.empty() || m_tmpDir[m_tmpDir.size()-1] != '/') {
+		m_tmpDir += '/';
+	}
+	m_tmpDir += "rp-CacheIndexTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(&m_tmpDir[0]));
+	ASSERT_EQ(0, mkdir((m_tmpDir + "/sub").c_str(), 0700));
+
+	CacheIndex::setCacheDirectory(m_tmpDir.c_str());
+}
+
+void CacheIndexTest::TearDown(void)
+{
+	CacheIndex::setCacheDirectory(nullptr);
+	removeAll(m_tmpDir);
+}
+
+/**
+ * Recursively delete a directory.
+ * @param path Directory
+ */
+void CacheIndexTest::removeAll(const string &path)
+{
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		return;
+	}
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		if (!strcmp(dirent->d_name, ".") || !strcmp(dirent->d_name, "..")) {
+			continue;
+		}
+		const string fullpath = path + '/' + dirent->d_name;
+		struct stat sb;
+		if (lstat(fullpath.c_str(), &sb) == 0 && S_ISDIR(sb.st_mode)) {
+			removeAll(fullpath);
+		} else {
+			unlink(fullpath.c_str());
+		}
+	}
+	closedir(pdir);
+	rmdir(path.c_str());
+}
+
+/**
+ * Create a cache file.
+ * @param relPath Path relative to the cache directory
+ * @param size File size
+ * @param mtime Modification time
+ */
+void CacheIndexTest::createFile(const string &relPath, size_t size, time_t mtime)
+{
+	const string filename = m_tmpDir + '/' + relPath;
+	FILE *const f = fopen(filename.c_str(), "wb");
+	ASSERT_NE(nullptr, f);
+	const string data(size, 'x');
+	EXPECT_EQ(size, fwrite(data.data(), 1, size, f));
+	fclose(f);
+
+	if (mtime != 0) {
+		struct timespec times[2];
+		times[0].tv_sec = mtime;
+		times[0].tv_nsec = 0;
+		times[1].tv_sec = mtime;
+		times[1].tv_nsec = 0;
+		ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, 0));
+	}
+}
+
+/**
+ * Create eight 200-byte files with increasing modification times,
+ * then rebuild the index.
+ * The oldest file is "sub/file0.png".
+ */
+void CacheIndexTest::createEightFiles(void)
+{
+	for (int i = 0; i < 8; i++) {
+		createFile("sub/file" + std::to_string(i) + ".png", 200, 1000000000 + i);
+	}
+	ASSERT_EQ(8, CacheIndex::rebuild());
+}
+
+/**
+ * Accesses are recorded, and the usage is read from the index.
+ */
+TEST_F(CacheIndexTest, touchAndUsage)
+{
+	createFile("sub/a.png", 100);
+	createFile("sub/b.png", 200);
+	CacheIndex::touch(m_tmpDir + "/sub/a.png");
+	CacheIndex::touch(m_tmpDir + "/sub/b.png");
+	CacheIndex::touch(m_tmpDir + "/sub/a.png");
+
+	// Files outside of the cache directory and missing files are ignored.
+	CacheIndex::touch(m_tmpDir + "-other/sub/a.png");
+	CacheIndex::touch(m_tmpDir + "/sub/missing.png");
+	EXPECT_EQ(3U, CacheIndex::stats().touches);
+
+	CacheIndex::Usage usage;
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(300U, usage.totalSize);
+	EXPECT_EQ(2U, usage.fileCount);
+	EXPECT_EQ(1U, CacheIndex::stats().flushes);
+
+	// A new instance reads the same index.
+	CacheIndex::setCacheDirectory(m_tmpDir.c_str());
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(300U, usage.totalSize);
+	EXPECT_EQ(2U, usage.fileCount);
+	EXPECT_EQ(0U, CacheIndex::stats().flushes);
+}
+
+/**
+ * getUsage() fails if there's no index.
+ */
+TEST_F(CacheIndexTest, noIndex)
+{
+	CacheIndex::Usage usage;
+	EXPECT_EQ(-ENOENT, CacheIndex::getUsage(usage));
+	EXPECT_EQ(0U, usage.totalSize);
+	EXPECT_EQ(0U, usage.fileCount);
+}
+
+/**
+ * rebuild() indexes files in subdirectories, but not
+ * files in the top-level cache directory.
+ */
+TEST_F(CacheIndexTest, rebuild)
+{
+	createFile("sub/a.png", 100);
+	createFile("toplevel.idx", 1000);
+	ASSERT_EQ(0, mkdir((m_tmpDir + "/sub/deeper").c_str(), 0700));
+	createFile("sub/deeper/b.jpg", 50);
+
+	EXPECT_EQ(2, CacheIndex::rebuild());
+	CacheIndex::Usage usage;
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(150U, usage.totalSize);
+	EXPECT_EQ(2U, usage.fileCount);
+}
+
+/**
+ * If the cache is over its size limit when the index is written,
+ * the least-recently used files are deleted until the cache is
+ * at 90% of the limit. Files that were just accessed are kept.
+ */
+TEST_F(CacheIndexTest, lruEviction)
+{
+	CacheIndex::setCacheDirectory(m_tmpDir.c_str(), 1000);
+	createEightFiles();
+
+	// Access the oldest file, making it the newest.
+	CacheIndex::touch(m_tmpDir + "/sub/file0.png");
+	EXPECT_EQ(0, CacheIndex::flush());
+	EXPECT_EQ(4U, CacheIndex::stats().evictions);
+
+	EXPECT_TRUE(exists("sub/file0.png"));
+	for (int i = 1; i <= 4; i++) {
+		EXPECT_FALSE(exists("sub/file" + std::to_string(i) + ".png")) << "file" << i;
+	}
+	for (int i = 5; i < 8; i++) {
+		EXPECT_TRUE(exists("sub/file" + std::to_string(i) + ".png")) << "file" << i;
+	}
+
+	CacheIndex::Usage usage;
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(800U, usage.totalSize);
+	EXPECT_EQ(4U, usage.fileCount);
+}
+
+/**
+ * trim() deletes least-recently used files until the cache fits.
+ */
+TEST_F(CacheIndexTest, trim)
+{
+	createEightFiles();
+
+	EXPECT_EQ(6, CacheIndex::trim(400));
+	for (int i = 0; i < 6; i++) {
+		EXPECT_FALSE(exists("sub/file" + std::to_string(i) + ".png")) << "file" << i;
+	}
+	EXPECT_TRUE(exists("sub/file6.png"));
+	EXPECT_TRUE(exists("sub/file7.png"));
+
+	CacheIndex::Usage usage;
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(400U, usage.totalSize);
+	EXPECT_EQ(2U, usage.fileCount);
+
+	// Trimming again doesn't delete anything.
+	EXPECT_EQ(0, CacheIndex::trim(400));
+}
+
+/**
+ * Files that were deleted by something else are dropped from the index.
+ */
+TEST_F(CacheIndexTest, missingFileDropped)
+{
+	createEightFiles();
+	ASSERT_EQ(0, unlink((m_tmpDir + "/sub/file0.png").c_str()));
+
+	// file0 is already gone, so only file1 is actually deleted.
+	EXPECT_EQ(1, CacheIndex::trim(1200));
+	EXPECT_FALSE(exists("sub/file1.png"));
+	EXPECT_TRUE(exists("sub/file2.png"));
+
+	CacheIndex::Usage usage;
+	ASSERT_EQ(0, CacheIndex::getUsage(usage));
+	EXPECT_EQ(1200U, usage.totalSize);
+	EXPECT_EQ(6U, usage.fileCount);
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_FILE_WRITE;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRomData test suite: CacheIndex tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
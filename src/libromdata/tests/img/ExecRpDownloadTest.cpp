@@ -0,0 +1,234 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * ExecRpDownloadTest.cpp: Persistent rp-download helper pool test.        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// libromdata
+#include "img/CacheManager.hpp"
+
+// C includes
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes
+#include <chrono>
+#include <string>
+#include <thread>
+using std::string;
+
+namespace LibRomData { namespace Tests {
+
+// Idle timeout for the stand-in helper, in milliseconds.
+// rp-download uses 30 seconds, which is too long for a test.
+static constexpr int HELPER_IDLE_TIMEOUT = 500;
+
+/**
+ * Stand-in for rp-download's persistent mode.
+ * The test executable runs this if it's started with "-s".
+ * Each request is answered with "0 [cache key]".
+ * @return Exit code
+ */
+static int runStandInHelper(void)
+{
+	string request;
+	for (;;) {
+		struct pollfd pfd;
+		pfd.fd = STDIN_FILENO;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		const int ret = poll(&pfd, 1, HELPER_IDLE_TIMEOUT);
+		if (ret == 0) {
+			// Idle timeout.
+			return EXIT_SUCCESS;
+		} else if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return EXIT_FAILURE;
+		}
+
+		char buf[256];
+		const ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+		if (n == 0) {
+			// The socket was closed.
+			return EXIT_SUCCESS;
+		} else if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return EXIT_FAILURE;
+		}
+		request.append(buf, static_cast<size_t>(n));
+
+		size_t nl;
+		while ((nl = request.find('\n')) != string::npos) {
+			const string response = "0 " + request.substr(0, nl + 1);
+			if (write(STDOUT_FILENO, response.data(), response.size()) != static_cast<ssize_t>(response.size())) {
+				return EXIT_FAILURE;
+			}
+			request.erase(0, nl + 1);
+		}
+	}
+}
+
+/**
+ * CacheManager subclass that allows calling execRpDownload() directly.
+ */
+class TestCacheManager : public CacheManager
+{
+public:
+	using CacheManager::execRpDownload;
+};
+
+class ExecRpDownloadTest : public ::testing::Test
+{
+protected:
+	void SetUp(void) override;
+	void TearDown(void) override;
+
+public:
+	/**
+	 * Check that this process doesn't have any zombie child processes.
+	 * NOTE: If a zombie is found, it will be reaped.
+	 * @return True if no zombies were found; false if a zombie was found.
+	 */
+	static bool noZombies(void);
+
+public:
+	TestCacheManager m_cache;
+};
+
+void ExecRpDownloadTest::SetUp(void)
+{
+	// The test executable is used as the rp-download helper.
+	// NOTE: This also stops any idle helpers from previous tests.
+	CacheManager::setRpDownloadExe("/proc/self/exe");
+	ASSERT_EQ(0U, CacheManager::helperStats().idle);
+}
+
+void ExecRpDownloadTest::TearDown(void)
+{
+	CacheManager::setRpDownloadExe(nullptr);
+}
+
+/**
+ * Check that this process doesn't have any zombie child processes.
+ * NOTE: If a zombie is found, it will be reaped.
+ * @return True if no zombies were found; false if a zombie was found.
+ */
+bool ExecRpDownloadTest::noZombies(void)
+{
+	int wstatus = 0;
+	return (waitpid(-1, &wstatus, WNOHANG) <= 0);
+}
+
+/**
+ * The first request starts a helper, and the next request reuses it.
+ */
+TEST_F(ExecRpDownloadTest, spawnAndReuse)
+{
+	const CacheManager::HelperStats before = CacheManager::helperStats();
+
+	EXPECT_EQ(0, m_cache.execRpDownload("test/spawn.png"));
+	CacheManager::HelperStats stats = CacheManager::helperStats();
+	EXPECT_EQ(before.spawned + 1, stats.spawned);
+	EXPECT_EQ(before.reused, stats.reused);
+	EXPECT_EQ(1U, stats.idle);
+
+	EXPECT_EQ(0, m_cache.execRpDownload("test/reuse1.png"));
+	EXPECT_EQ(0, m_cache.execRpDownload("test/reuse2.png"));
+	stats = CacheManager::helperStats();
+	EXPECT_EQ(before.spawned + 1, stats.spawned);
+	EXPECT_EQ(before.reused + 2, stats.reused);
+	EXPECT_EQ(before.exited, stats.exited);
+	EXPECT_EQ(1U, stats.idle);
+}
+
+/**
+ * If an idle helper exits due to its idle timeout,
+ * it's reaped, and a new helper is started.
+ */
+TEST_F(ExecRpDownloadTest, respawnAfterIdleExit)
+{
+	const CacheManager::HelperStats before = CacheManager::helperStats();
+
+	EXPECT_EQ(0, m_cache.execRpDownload("test/first.png"));
+	EXPECT_EQ(before.spawned + 1, CacheManager::helperStats().spawned);
+
+	// Wait for the helper to exit.
+	std::this_thread::sleep_for(std::chrono::milliseconds(HELPER_IDLE_TIMEOUT * 4));
+
+	EXPECT_EQ(0, m_cache.execRpDownload("test/second.png"));
+	const CacheManager::HelperStats stats = CacheManager::helperStats();
+	EXPECT_EQ(before.spawned + 2, stats.spawned);
+	EXPECT_EQ(before.reused, stats.reused);
+	EXPECT_EQ(before.exited + 1, stats.exited);
+	EXPECT_EQ(1U, stats.idle);
+
+	// The first helper must have been reaped.
+	EXPECT_TRUE(noZombies());
+}
+
+/**
+ * Idle helpers are stopped and reaped when the pool is reset.
+ * This uses the same code path as unloading libromdata.
+ */
+TEST_F(ExecRpDownloadTest, stopIdleHelpers)
+{
+	EXPECT_EQ(0, m_cache.execRpDownload("test/stop.png"));
+	EXPECT_EQ(1U, CacheManager::helperStats().idle);
+
+	CacheManager::setRpDownloadExe(nullptr);
+	EXPECT_EQ(0U, CacheManager::helperStats().idle);
+
+	// No child processes should remain, not even zombies.
+	int wstatus = 0;
+	errno = 0;
+	EXPECT_EQ(-1, waitpid(-1, &wstatus, WNOHANG));
+	EXPECT_EQ(ECHILD, errno);
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_SPAWN;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	if (argc >= 2) {
+		if (!strcmp(argv[1], "-s")) {
+			// Started as a persistent rp-download helper.
+			return LibRomData::Tests::runStandInHelper();
+		} else if (argv[1][0] != '-') {
+			// Started as a one-shot rp-download.
+			// This shouldn't happen, and the test suite
+			// shouldn't be run recursively.
+			return EXIT_FAILURE;
+		}
+	}
+
+	fputs("LibRomData test suite: ExecRpDownload tests.\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
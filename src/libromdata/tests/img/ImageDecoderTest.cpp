@@ -32,16 +32,19 @@
 // librpbase, librpfile
 #include "common.h"
 #include "librpbase/img/RpPng.hpp"
+#include "librpbase/img/RpPngWriter.hpp"
 #include "librpbase/RomData.hpp"
 #include "librpbase/RomFields.hpp"
 #include "libromdata/Other/RpTextureWrapper.hpp"
 #include "librpfile/MemFile.hpp"
 #include "librpfile/RpFile.hpp"
 #include "librpfile/FileSystem.hpp"
+#include "librpfile/VectorFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 
 // librptexture
+#include "librptexture/decoder/ImageDecoder_common.hpp"
 #include "librptexture/img/rp_image.hpp"
 #ifdef _WIN32
 // rp_image backend registration.
@@ -52,6 +55,9 @@ using namespace LibRpTexture;
 // RomDataFactory to load test files.
 #include "RomDataFactory.hpp"
 
+// TCreateThumbnail for mipmap selection.
+#include "img/TCreateThumbnail.cpp"
+
 // C includes (C++ namespace)
 #include "ctypex.h"
 #include <cstdint>
@@ -59,7 +65,9 @@ using namespace LibRpTexture;
 #include <cstring>
 
 // C++ includes
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -168,6 +176,15 @@ public:
 	// Number of iterations for benchmarks.
 	static constexpr unsigned int BENCHMARK_ITERATIONS = 1000;
 	static constexpr unsigned int BENCHMARK_ITERATIONS_BC7 = 100;
+	static constexpr unsigned int BENCHMARK_ITERATIONS_SCALING = 20;
+	static constexpr unsigned int BENCHMARK_ITERATIONS_PNG = 20;
+
+	// Minimum image size for the decoder scaling benchmark.
+	static constexpr int SCALING_MIN_PIXELS = 256*256;
+
+	// Maximum image size for the PNG encoder test.
+	// Larger images take too long to encode using the Smallest profile.
+	static constexpr int PNG_ENCODE_TEST_MAX_PIXELS = 128*128;
 
 public:
 	// Image buffers
@@ -210,6 +227,40 @@ public:
 	 * Internal benchmark function.
 	 */
 	void decodeBenchmark_internal(void);
+
+	/**
+	 * Internal decoder scaling benchmark function.
+	 * Decodes the image using 1, 2, 4, ... threads.
+	 */
+	void decodeScalingBenchmark_internal(void);
+
+	/**
+	 * Internal mipmap selection test function.
+	 * Checks that TCreateThumbnail selects the smallest
+	 * mipmap level that's large enough for a thumbnail.
+	 */
+	void mipmapSelectionTest_internal(void);
+
+	/**
+	 * Encode an rp_image as PNG using the specified encoder profile.
+	 * @param img		[in] rp_image
+	 * @param profile	[in] PNG encoder profile
+	 * @return VectorFile containing the PNG image
+	 */
+	static shared_ptr<VectorFile> encodePng(const rp_image_const_ptr &img, Config::PngEncodeProfile profile);
+
+	/**
+	 * Internal PNG encoder test function.
+	 * Encodes the decoded image with each encoder profile,
+	 * then reloads it and compares it to the decoded image.
+	 */
+	void pngEncodeTest_internal(void);
+
+	/**
+	 * Internal PNG encoder benchmark function.
+	 * Compares encoding time and file size for each encoder profile.
+	 */
+	void pngEncodeBenchmark_internal(void);
 };
 
 /**
@@ -314,6 +365,10 @@ void ImageDecoderTest::TearDown(void)
 		gzclose_r(m_gzDds);
 		m_gzDds = nullptr;
 	}
+
+	// decodeScalingBenchmark changes the thread count.
+	// Restore the default here in case it failed partway through.
+	ImageDecoder::setMaxThreads(0);
 }
 
 /**
@@ -446,6 +501,15 @@ void ImageDecoderTest::decodeTest_internal(void)
 		EXPECT_EQ(img_dds.get(), img_base.get()) << "Mipmap level 0 is *not* the same object as the base image.";
 	}
 
+	// Mipmap dimensions should match the decoded mipmap.
+	// (Used by TCreateThumbnail to select a mipmap without decoding it.)
+	if (mode.mipmapLevel >= 0 && mode.mipmapLevel < m_romData->mipmapCount()) {
+		int dimensions[2];
+		EXPECT_EQ(0, m_romData->getMipmapDimensions(mode.mipmapLevel, dimensions));
+		EXPECT_EQ(img_dds->width(), dimensions[0]) << "Mipmap width doesn't match getMipmapDimensions().";
+		EXPECT_EQ(img_dds->height(), dimensions[1]) << "Mipmap height doesn't match getMipmapDimensions().";
+	}
+
 	// Verify the pixel format.
 	if (!mode.expected_pixel_format.empty()) {
 		// This must be RpTextureWrapper.
@@ -567,6 +631,340 @@ TEST_P(ImageDecoderTest, decodeBenchmark)
 	ASSERT_NO_FATAL_FAILURE(decodeBenchmark_internal());
 }
 
+/**
+ * Internal decoder scaling benchmark function.
+ * Decodes the image using 1, 2, 4, ... threads.
+ */
+void ImageDecoderTest::decodeScalingBenchmark_internal(void)
+{
+	// Parameterized test.
+	const ImageDecoderTest_mode &mode = GetParam();
+	if (mode.mipmapLevel > 0) {
+		// Only test the full image.
+		return;
+	}
+
+	// Open the image as an IRpFile.
+	m_f_dds = std::make_shared<MemFile>(m_dds_buf.data(), m_dds_buf.size());
+	ASSERT_TRUE(m_f_dds->isOpen()) << "Could not create MemFile for the DDS image.";
+	m_f_dds->setFilename(mode.dds_gz_filename);
+
+	// Small images are always decoded on a single thread.
+	m_romData = RomDataFactory::create(m_f_dds);
+	ASSERT_TRUE((bool)m_romData) << "Could not load the DDS image.";
+	rp_image_const_ptr img_dds = m_romData->image(mode.imgType);
+	ASSERT_TRUE(img_dds != nullptr) << "Could not load the DDS image as rp_image.";
+	const int width = img_dds->width();
+	const int height = img_dds->height();
+	img_dds.reset();
+	m_romData.reset();
+	if (width * height < SCALING_MIN_PIXELS) {
+		return;
+	}
+
+	fmt::print(FSTR("{:s} ({:d}x{:d}):\n"), mode.dds_gz_filename, width, height);
+	const int maxThreads = ImageDecoder::maxThreads();
+	unsigned int elapsed_us_1 = 0;
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		ImageDecoder::setMaxThreads(threads);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = BENCHMARK_ITERATIONS_SCALING; i > 0; i--) {
+			m_romData = RomDataFactory::create(m_f_dds);
+			ASSERT_TRUE((bool)m_romData) << "Could not load the DDS image.";
+			img_dds = m_romData->image(mode.imgType);
+			ASSERT_TRUE(img_dds != nullptr) << "Could not load the DDS image as rp_image.";
+			img_dds.reset();
+			m_romData.reset();
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const unsigned int elapsed_us = static_cast<unsigned int>(
+			std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+		if (threads == 1) {
+			elapsed_us_1 = elapsed_us;
+		}
+		fmt::print(FSTR("- {:2d} thread(s): {:8d} us (speedup: {:.2f}x)\n"),
+			threads, elapsed_us,
+			(elapsed_us > 0) ? (static_cast<double>(elapsed_us_1) / elapsed_us) : 0.0);
+	}
+}
+
+/**
+ * Benchmark decoder scaling with multiple threads.
+ */
+TEST_P(ImageDecoderTest, decodeScalingBenchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(decodeScalingBenchmark_internal());
+}
+
+/**
+ * TCreateThumbnail implementation using rp_image.
+ * Used to test mipmap selection.
+ */
+class RpImageCreateThumbnail final : public TCreateThumbnail<rp_image_const_ptr>
+{
+public:
+	RpImageCreateThumbnail() = default;
+
+private:
+	typedef TCreateThumbnail<rp_image_const_ptr> super;
+public:
+	RP_DISABLE_COPY(RpImageCreateThumbnail)
+
+protected:
+	/** TCreateThumbnail functions **/
+
+	rp_image_const_ptr rpImageToImgClass(const rp_image_const_ptr &img) const final
+	{
+		return img;
+	}
+
+	bool isImgClassValid(const rp_image_const_ptr &imgClass) const final
+	{
+		return (imgClass && imgClass->isValid());
+	}
+
+	rp_image_const_ptr getNullImgClass(void) const final
+	{
+		return {};
+	}
+
+	void freeImgClass(rp_image_const_ptr &imgClass) const final
+	{
+		imgClass.reset();
+	}
+
+	rp_image_const_ptr rescaleImgClass(const rp_image_const_ptr &imgClass, ImgSize sz, ScalingMethod method = ScalingMethod::Nearest) const final
+	{
+		return imgClass->scaled(sz.width, sz.height,
+			(method == ScalingMethod::Bilinear)
+				? rp_image::ScaleMethod::Area
+				: rp_image::ScaleMethod::Nearest);
+	}
+
+	bool useNativeScaler(void) const final
+	{
+		return true;
+	}
+
+	int getImgClassSize(const rp_image_const_ptr &imgClass, ImgSize *pOutSize) const final
+	{
+		pOutSize->width = imgClass->width();
+		pOutSize->height = imgClass->height();
+		return 0;
+	}
+
+	string proxyForUrl(const char *url) const final
+	{
+		RP_UNUSED(url);
+		return {};
+	}
+};
+
+/**
+ * Internal mipmap selection test function.
+ * Checks that TCreateThumbnail selects the smallest
+ * mipmap level that's large enough for a thumbnail.
+ */
+void ImageDecoderTest::mipmapSelectionTest_internal(void)
+{
+	// Parameterized test.
+	const ImageDecoderTest_mode &mode = GetParam();
+	if (mode.mipmapLevel != 0) {
+		// Only run this once per mipmapped texture.
+		return;
+	}
+
+	// Open the image as an IRpFile.
+	m_f_dds = std::make_shared<MemFile>(m_dds_buf.data(), m_dds_buf.size());
+	ASSERT_TRUE(m_f_dds->isOpen()) << "Could not create MemFile for the DDS image.";
+	m_f_dds->setFilename(mode.dds_gz_filename);
+
+	m_romData = RomDataFactory::create(m_f_dds);
+	ASSERT_TRUE((bool)m_romData) << "Could not load the DDS image.";
+	const int mipmapCount = m_romData->mipmapCount();
+	if (mipmapCount <= 1) {
+		// No mipmaps.
+		return;
+	}
+
+	int fullDimensions[2];
+	ASSERT_EQ(0, m_romData->getMipmapDimensions(0, fullDimensions));
+
+	// Full size, or larger than the full image: Use the full image.
+	EXPECT_EQ(0, RpImageCreateThumbnail::selectMipmapLevel(m_romData, 0));
+	EXPECT_EQ(0, RpImageCreateThumbnail::selectMipmapLevel(m_romData,
+		std::max(fullDimensions[0], fullDimensions[1]) * 2));
+
+	// Requesting the exact size of a mipmap level should select that level.
+	// Requesting one pixel more should select the next larger level.
+	for (int i = 1; i < mipmapCount; i++) {
+		int dimensions[2];
+		ASSERT_EQ(0, m_romData->getMipmapDimensions(i, dimensions));
+		const int size = std::max(dimensions[0], dimensions[1]);
+		EXPECT_EQ(i, RpImageCreateThumbnail::selectMipmapLevel(m_romData, size)) << "reqSize == " << size;
+		EXPECT_EQ(i - 1, RpImageCreateThumbnail::selectMipmapLevel(m_romData, size + 1)) << "reqSize == " << (size + 1);
+	}
+
+	// getInternalRpImage() should return the mipmap level 1 image,
+	// not the full image, but report the full image size.
+	int dimensions1[2];
+	ASSERT_EQ(0, m_romData->getMipmapDimensions(1, dimensions1));
+	const int reqSize = std::max(dimensions1[0], dimensions1[1]);
+	const rp_image_const_ptr mipmap1 = m_romData->mipmap(1);
+	ASSERT_TRUE((bool)mipmap1) << "Could not load mipmap level 1.";
+
+	RpImageCreateThumbnail::ImgSize outSize = {0, 0};
+	const rp_image_const_ptr intImage = RpImageCreateThumbnail::getInternalRpImage(
+		m_romData, RomData::IMG_INT_IMAGE, reqSize, &outSize);
+	EXPECT_EQ(mipmap1.get(), intImage.get()) << "getInternalRpImage() did not use mipmap level 1.";
+	EXPECT_EQ(fullDimensions[0], outSize.width);
+	EXPECT_EQ(fullDimensions[1], outSize.height);
+
+	// getThumbnail() should return mipmap level 1 without rescaling it.
+	RpImageCreateThumbnail createThumbnail;
+	RpImageCreateThumbnail::GetThumbnailOutParams_t outParams;
+	ASSERT_EQ(RPCT_SUCCESS, createThumbnail.getThumbnail(m_romData, reqSize, &outParams));
+	ASSERT_TRUE((bool)outParams.retImg);
+	EXPECT_EQ(fullDimensions[0], outParams.fullSize.width);
+	EXPECT_EQ(fullDimensions[1], outParams.fullSize.height);
+	EXPECT_EQ(dimensions1[0], outParams.thumbSize.width);
+	EXPECT_EQ(dimensions1[1], outParams.thumbSize.height);
+	ASSERT_EQ(dimensions1[0], outParams.retImg->width());
+	ASSERT_EQ(dimensions1[1], outParams.retImg->height());
+	ASSERT_NO_FATAL_FAILURE(Compare_RpImage(mipmap1.get(), outParams.retImg.get()));
+}
+
+/**
+ * Test mipmap selection for thumbnails.
+ */
+TEST_P(ImageDecoderTest, mipmapSelectionTest)
+{
+	ASSERT_NO_FATAL_FAILURE(mipmapSelectionTest_internal());
+}
+
+/**
+ * Encode an rp_image as PNG using the specified encoder profile.
+ * @param img		[in] rp_image
+ * @param profile	[in] PNG encoder profile
+ * @return VectorFile containing the PNG image
+ */
+shared_ptr<VectorFile> ImageDecoderTest::encodePng(const rp_image_const_ptr &img, Config::PngEncodeProfile profile)
+{
+	shared_ptr<VectorFile> f_png = std::make_shared<VectorFile>();
+	RpPngWriter pngWriter(f_png, img);
+	if (!pngWriter.isOpen()) {
+		return {};
+	}
+	pngWriter.setEncodeProfile(profile);
+	if (pngWriter.write_IHDR() != 0 || pngWriter.write_IDAT() != 0) {
+		return {};
+	}
+	pngWriter.close();
+	return f_png;
+}
+
+/**
+ * Internal PNG encoder test function.
+ * Encodes the decoded image with each encoder profile,
+ * then reloads it and compares it to the decoded image.
+ */
+void ImageDecoderTest::pngEncodeTest_internal(void)
+{
+	// Parameterized test.
+	const ImageDecoderTest_mode &mode = GetParam();
+	if (mode.mipmapLevel > 0) {
+		// Only test the full image.
+		return;
+	}
+
+	// Open the image as an IRpFile.
+	m_f_dds = std::make_shared<MemFile>(m_dds_buf.data(), m_dds_buf.size());
+	ASSERT_TRUE(m_f_dds->isOpen()) << "Could not create MemFile for the DDS image.";
+	m_f_dds->setFilename(mode.dds_gz_filename);
+
+	m_romData = RomDataFactory::create(m_f_dds);
+	ASSERT_TRUE((bool)m_romData) << "Could not load the DDS image.";
+	const rp_image_const_ptr img_dds = m_romData->image(mode.imgType);
+	ASSERT_TRUE(img_dds != nullptr) << "Could not load the DDS image as rp_image.";
+	if (img_dds->width() * img_dds->height() > PNG_ENCODE_TEST_MAX_PIXELS) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < static_cast<unsigned int>(Config::PngEncodeProfile::Max); i++) {
+		const Config::PngEncodeProfile profile = static_cast<Config::PngEncodeProfile>(i);
+		shared_ptr<VectorFile> f_png = encodePng(img_dds, profile);
+		ASSERT_TRUE((bool)f_png) << "Could not encode the PNG image using profile "
+			<< Config::pngEncodeProfileToConfSetting(profile);
+
+		f_png->rewind();
+		const rp_image_const_ptr img_png = RpPng::load(f_png);
+		ASSERT_TRUE(img_png != nullptr) << "Could not reload the PNG image encoded using profile "
+			<< Config::pngEncodeProfileToConfSetting(profile);
+		ASSERT_NO_FATAL_FAILURE(Compare_RpImage(img_dds.get(), img_png.get()));
+	}
+}
+
+/**
+ * Test the PNG encoder profiles.
+ */
+TEST_P(ImageDecoderTest, pngEncodeTest)
+{
+	ASSERT_NO_FATAL_FAILURE(pngEncodeTest_internal());
+}
+
+/**
+ * Internal PNG encoder benchmark function.
+ * Compares encoding time and file size for each encoder profile.
+ */
+void ImageDecoderTest::pngEncodeBenchmark_internal(void)
+{
+	// Parameterized test.
+	const ImageDecoderTest_mode &mode = GetParam();
+	if (mode.mipmapLevel > 0) {
+		// Only test the full image.
+		return;
+	}
+
+	// Open the image as an IRpFile.
+	m_f_dds = std::make_shared<MemFile>(m_dds_buf.data(), m_dds_buf.size());
+	ASSERT_TRUE(m_f_dds->isOpen()) << "Could not create MemFile for the DDS image.";
+	m_f_dds->setFilename(mode.dds_gz_filename);
+
+	m_romData = RomDataFactory::create(m_f_dds);
+	ASSERT_TRUE((bool)m_romData) << "Could not load the DDS image.";
+	const rp_image_const_ptr img_dds = m_romData->image(mode.imgType);
+	ASSERT_TRUE(img_dds != nullptr) << "Could not load the DDS image as rp_image.";
+
+	fmt::print(FSTR("{:s} ({:d}x{:d}):\n"), mode.dds_gz_filename, img_dds->width(), img_dds->height());
+	for (unsigned int i = 0; i < static_cast<unsigned int>(Config::PngEncodeProfile::Max); i++) {
+		const Config::PngEncodeProfile profile = static_cast<Config::PngEncodeProfile>(i);
+		off64_t png_size = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned int j = BENCHMARK_ITERATIONS_PNG; j > 0; j--) {
+			shared_ptr<VectorFile> f_png = encodePng(img_dds, profile);
+			ASSERT_TRUE((bool)f_png) << "Could not encode the PNG image.";
+			png_size = f_png->size();
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const unsigned int elapsed_us = static_cast<unsigned int>(
+			std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+		fmt::print(FSTR("- {:<8s}: {:8d} us; {:8d} bytes\n"),
+			Config::pngEncodeProfileToConfSetting(profile), elapsed_us, png_size);
+	}
+}
+
+/**
+ * Benchmark the PNG encoder profiles.
+ */
+TEST_P(ImageDecoderTest, pngEncodeBenchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(pngEncodeBenchmark_internal());
+}
+
 /**
  * Test case suffix generator.
  * @param info Test parameter information.
@@ -20,9 +20,11 @@ using namespace LibRpFile;
 
 // C includes (C++ namespace)
 #include <cassert>
+#include <cstring>
 
 // C++ STL classes
 #include <array>
+#include <mutex>
 #include <unordered_map>
 using std::array;
 using std::string;
@@ -112,6 +114,11 @@ public:
 	unordered_map<Achievements::ID, AchData_t, EnumClassHash> mapAchData;
 	bool loaded;	// Have achievements been loaded from disk?
 
+	// Achievement data mutex
+	// NOTE: RomData subclasses may call unlock() from worker threads,
+	// e.g. when rpcli is running in batch mode.
+	mutable std::mutex mtxAch;
+
 	// Achievements filename and magic number
 	static const char ACH_BIN_MAGIC[];
 	static const char ACH_BIN_FILENAME[];
@@ -798,6 +805,7 @@ int Achievements::unlock(ID id, int bit)
 
 	// Make sure achievements have been loaded.
 	RP_D(Achievements);
+	std::unique_lock<std::mutex> mtxLocker(d->mtxAch);
 	if (!d->loaded) {
 		d->load();
 	}
@@ -869,6 +877,7 @@ int Achievements::unlock(ID id, int bit)
 
 	// Save the achievement data.
 	d->save();
+	mtxLocker.unlock();
 
 	if (unlocked) {
 		// Achievement unlocked!
@@ -898,6 +907,7 @@ time_t Achievements::isUnlocked(ID id) const
 
 	// Make sure achievements have been loaded.
 	RP_D(const Achievements);
+	std::lock_guard<std::mutex> mtxLocker(d->mtxAch);
 	if (!d->loaded) {
 		const_cast<AchievementsPrivate*>(d)->load();
 	}
@@ -39,6 +39,11 @@ public:
 	 * This automatically initializes the object and
 	 * reloads the achievements data if it has been modified.
 	 *
+	 * Thread safety: unlock() and isUnlocked() are serialized
+	 * with an internal mutex, so they may be called from
+	 * multiple worker threads. The notification function
+	 * is called without the mutex held.
+	 *
 	 * @return Achievements instance.
 	 */
 	RP_LIBROMDATA_PUBLIC
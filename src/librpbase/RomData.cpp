@@ -923,6 +923,32 @@ int RomData::loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_pt
 	return -ENOENT;
 }
 
+/**
+ * Get the number of mipmap levels for IMG_INT_IMAGE.
+ * @return Number of mipmap levels, or 0 if the image doesn't have mipmaps.
+ */
+int RomData::mipmapCount(void) const
+{
+	// No mipmaps are supported by the base class.
+	return 0;
+}
+
+/**
+ * Get the dimensions of a mipmap level for IMG_INT_IMAGE
+ * without decoding it.
+ * @param mipmapLevel	[in] Mipmap level
+ * @param pBuf		[out] Two-element array for [width, height]
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomData::getMipmapDimensions(int mipmapLevel, int pBuf[2]) const
+{
+	RP_UNUSED(mipmapLevel);
+	RP_UNUSED(pBuf);
+
+	// No mipmaps are supported by the base class.
+	return -ENOENT;
+}
+
 /**
  * Load metadata properties.
  * Called by RomData::metaData() if the metadata hasn't been loaded yet.
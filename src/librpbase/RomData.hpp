@@ -469,6 +469,21 @@ public:
 	 */
 	virtual int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage);
 
+	/**
+	 * Get the number of mipmap levels for IMG_INT_IMAGE.
+	 * @return Number of mipmap levels, or 0 if the image doesn't have mipmaps.
+	 */
+	virtual int mipmapCount(void) const;
+
+	/**
+	 * Get the dimensions of a mipmap level for IMG_INT_IMAGE
+	 * without decoding it.
+	 * @param mipmapLevel	[in] Mipmap level
+	 * @param pBuf		[out] Two-element array for [width, height]
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	virtual int getMipmapDimensions(int mipmapLevel, int pBuf[2]) const;
+
 public:
 	/**
 	 * Get the ROM Fields object.
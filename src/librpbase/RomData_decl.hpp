@@ -374,7 +374,24 @@ public: \
 	 * @return 0 on success; negative POSIX error code on error. \
 	 */ \
 	RP_LIBROMDATA_LOCAL \
-	int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage) final;
+	int loadInternalMipmap(int mipmapLevel, LibRpTexture::rp_image_const_ptr &pImage) final; \
+	\
+	/** \
+	 * Get the number of mipmap levels for IMG_INT_IMAGE. \
+	 * @return Number of mipmap levels, or 0 if the image doesn't have mipmaps. \
+	 */ \
+	RP_LIBROMDATA_LOCAL \
+	int mipmapCount(void) const final; \
+	\
+	/** \
+	 * Get the dimensions of a mipmap level for IMG_INT_IMAGE \
+	 * without decoding it. \
+	 * @param mipmapLevel	[in] Mipmap level \
+	 * @param pBuf		[out] Two-element array for [width, height] \
+	 * @return 0 on success; negative POSIX error code on error. \
+	 */ \
+	RP_LIBROMDATA_LOCAL \
+	int getMipmapDimensions(int mipmapLevel, int pBuf[2]) const final;
 
 /**
  * RomData subclass function declaration for obtaining URLs for external images.
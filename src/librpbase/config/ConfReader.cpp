@@ -9,6 +9,9 @@
 #include "ConfReader.hpp"
 #include "ConfReader_p.hpp"
 
+// C includes (C++ namespace)
+#include <cstring>
+
 // Other rom-properties libraries
 #include "librpfile/FileSystem.hpp"
 using namespace LibRpFile;
@@ -18,6 +21,10 @@ using namespace LibRpFile;
 // for U82T_s()
 #  include "librptext/wchar.hpp"
 #endif
+#ifdef HAVE_INOTIFY_INIT1
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif /* HAVE_INOTIFY_INIT1 */
 
 namespace LibRpBase {
 
@@ -28,8 +35,95 @@ ConfReaderPrivate::ConfReaderPrivate(const char *filename)
 	, conf_mtime(0)
 	, conf_last_checked(0)
 	, conf_was_found(false)
+#ifdef HAVE_INOTIFY_INIT1
+	, inotify_fd(-1)
+#endif /* HAVE_INOTIFY_INIT1 */
 { }
 
+ConfReaderPrivate::~ConfReaderPrivate()
+{
+#ifdef HAVE_INOTIFY_INIT1
+	const int fd = inotify_fd.exchange(-1);
+	if (fd >= 0) {
+		::close(fd);
+	}
+#endif /* HAVE_INOTIFY_INIT1 */
+}
+
+#ifdef HAVE_INOTIFY_INIT1
+/**
+ * Start watching the configuration directory using inotify.
+ * NOTE: mtxLoad must be held.
+ * @param dir Configuration directory
+ */
+void ConfReaderPrivate::initInotify(const std::string &dir)
+{
+	assert(inotify_fd.load() < 0);
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		// inotify is not available. Check the mtime instead.
+		return;
+	}
+
+	// NOTE: Watching the directory instead of the file, since
+	// the file might not exist yet, and editors usually replace
+	// the file by renaming a temporary file.
+	const int wd = inotify_add_watch(fd, dir.c_str(),
+		IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+	if (wd < 0) {
+		// Unable to watch the directory. Check the mtime instead.
+		::close(fd);
+		return;
+	}
+
+	inotify_fd.store(fd);
+}
+
+/**
+ * Check for inotify events on the configuration file.
+ * If the watch is lost, inotify is closed and the mtime
+ * will be checked instead.
+ * @return True if the configuration file has changed; false if not.
+ */
+bool ConfReaderPrivate::checkInotify(void)
+{
+	const int fd = inotify_fd.load();
+	if (fd < 0) {
+		// Not watching anything.
+		return false;
+	}
+
+	bool changed = false;
+	bool lost = false;
+	alignas(struct inotify_event) char buf[4096];
+	ssize_t len;
+	while ((len = ::read(fd, buf, sizeof(buf))) > 0) {
+		for (const char *p = buf; p < buf + len; ) {
+			const struct inotify_event *const ev = reinterpret_cast<const struct inotify_event*>(p);
+			if (ev->mask & IN_Q_OVERFLOW) {
+				// Events were dropped. Assume the file has changed.
+				changed = true;
+			} else if (ev->mask & IN_IGNORED) {
+				// Directory was removed or unmounted.
+				changed = true;
+				lost = true;
+			} else if (ev->len > 0 && !strcmp(ev->name, conf_rel_filename)) {
+				changed = true;
+			}
+			p += sizeof(struct inotify_event) + ev->len;
+		}
+	}
+
+	if (lost) {
+		// Watch was lost. Check the mtime from now on.
+		if (inotify_fd.exchange(-1) == fd) {
+			::close(fd);
+		}
+	}
+	return changed;
+}
+#endif /* HAVE_INOTIFY_INIT1 */
+
 /**
  * Process a configuration line.
  * Static function; used by inih as a C-style callback function.
@@ -74,7 +168,7 @@ ConfReader::~ConfReader()
 bool ConfReader::isLoaded(void) const
 {
 	RP_D(const ConfReader);
-	return d->conf_was_found;
+	return d->conf_was_found.load(std::memory_order_acquire);
 }
 
 /**
@@ -91,30 +185,50 @@ int ConfReader::load(bool force)
 {
 	RP_D(ConfReader);
 
-	if (!force && d->conf_was_found) {
+	// Set if inotify reported a change, so the mtime doesn't need to be checked.
+	bool inotify_changed = false;
+
+	if (!force && d->conf_was_found.load(std::memory_order_acquire)) {
 		// Have we checked the timestamp recently?
+		// If not, only one thread needs to check it; other threads
+		// will continue using the current configuration snapshot.
 		// TODO: Define the threshold somewhere.
 		const time_t now = time(nullptr);
-		if (llabs(now - d->conf_last_checked) < 2) {
+		time_t last_checked = d->conf_last_checked.load(std::memory_order_relaxed);
+		if (llabs(now - last_checked) < 2 ||
+		    !d->conf_last_checked.compare_exchange_strong(last_checked, now, std::memory_order_relaxed))
+		{
 			// We checked it recently. Assume it's up to date.
 			return 0;
 		}
-		d->conf_last_checked = now;
 
-		// Check if the keys.conf timestamp has changed.
-		// Initial check. (fast path)
-		time_t mtime;
-		int ret = FileSystem::get_mtime(d->conf_filename, &mtime);
-		if (ret != 0) {
-			// Failed to retrieve the mtime.
-			// Leave everything as-is.
-			// TODO: Proper error code?
-			return -EIO;
-		}
+#ifdef HAVE_INOTIFY_INIT1
+		if (d->inotify_fd.load() >= 0) {
+			// Check for inotify events instead of stat()'ing the file.
+			if (!d->checkInotify()) {
+				// File has not changed.
+				// NOTE: If the watch was lost, the mtime will be checked next time.
+				return 0;
+			}
+			inotify_changed = true;
+		} else
+#endif /* HAVE_INOTIFY_INIT1 */
+		{
+			// Check if the keys.conf timestamp has changed.
+			// Initial check. (fast path)
+			time_t mtime;
+			int ret = FileSystem::get_mtime(d->conf_filename, &mtime);
+			if (ret != 0) {
+				// Failed to retrieve the mtime.
+				// Leave everything as-is.
+				// TODO: Proper error code?
+				return -EIO;
+			}
 
-		if (mtime == d->conf_mtime) {
-			// Timestamp has not changed.
-			return 0;
+			if (mtime == d->conf_mtime.load(std::memory_order_relaxed)) {
+				// Timestamp has not changed.
+				return 0;
+			}
 		}
 	}
 
@@ -128,12 +242,16 @@ int ConfReader::load(bool force)
 		// Get the configuration filename.
 		d->conf_filename = FileSystem::getConfigDirectory();
 		if (!d->conf_filename.empty()) {
+#ifdef HAVE_INOTIFY_INIT1
+			// Watch the configuration directory for changes.
+			d->initInotify(d->conf_filename);
+#endif /* HAVE_INOTIFY_INIT1 */
 			if (d->conf_filename.at(d->conf_filename.size()-1) != DIR_SEP_CHR) {
 				d->conf_filename += DIR_SEP_CHR;
 			}
 			d->conf_filename += d->conf_rel_filename;
 		}
-	} else if (!force && d->conf_was_found) {
+	} else if (!force && !inotify_changed && d->conf_was_found.load(std::memory_order_relaxed)) {
 		// Check if the keys.conf timestamp has changed.
 		// NOTE: Second check once the mutex is locked.
 		time_t mtime;
@@ -145,13 +263,15 @@ int ConfReader::load(bool force)
 			return -EIO;
 		}
 
-		if (mtime == d->conf_mtime) {
+		if (mtime == d->conf_mtime.load(std::memory_order_relaxed)) {
 			// Timestamp has not changed.
 			return 0;
 		}
 	}
 
-	// Reset the configuration to the default values.
+	// Start loading a new configuration with the default values.
+	// The current configuration remains available to readers until
+	// the new configuration is published.
 	d->reset();
 
 	// Parse the configuration file.
@@ -179,7 +299,8 @@ int ConfReader::load(bool force)
 #endif /* _WIN32 */
 	if (ret != 0) {
 		// Error parsing the INI file.
-		d->reset();
+		// Revert to the default values.
+		d->publish(false);
 		if (ret == -2)
 			return -ENOMEM;
 		return -EIO;
@@ -189,16 +310,16 @@ int ConfReader::load(bool force)
 	// TODO: Combine with earlier check?
 	time_t mtime;
 	ret = FileSystem::get_mtime(d->conf_filename, &mtime);
-	if (ret == 0) {
-		d->conf_mtime = mtime;
-	} else {
+	if (ret != 0) {
 		// mtime error...
 		// TODO: What do we do here?
-		d->conf_mtime = 0;
+		mtime = 0;
 	}
+	d->conf_mtime.store(mtime, std::memory_order_relaxed);
 
-	// Keys loaded.
-	d->conf_was_found = true;
+	// Keys loaded. Publish the new configuration.
+	d->publish(true);
+	d->conf_was_found.store(true, std::memory_order_release);
 	return 0;
 }
 
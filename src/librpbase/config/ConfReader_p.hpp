@@ -14,12 +14,121 @@
 // INI parser
 #include "ini.h"
 
+// C includes (C++ namespace)
+#include <cassert>
+
 // C++ includes
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 
+// std::atomic<std::shared_ptr> is C++20. Older versions have to use
+// the std::atomic_load() and std::atomic_store() overloads, which
+// are deprecated in C++20.
+#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
+#  define CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR 1
+#endif
+
 namespace LibRpBase {
 
+/**
+ * Immutable configuration snapshot.
+ *
+ * The current snapshot is published using an atomic shared_ptr,
+ * so readers don't need to take any locks. load() parses the
+ * configuration into a separate snapshot, which is published
+ * once it's complete.
+ *
+ * Readers hold a reference to the snapshot while using it, and
+ * ImgTypePrio_t and KeyData_t hold a reference for as long as the
+ * caller keeps them, so replaced snapshots are freed once the last
+ * reader is done with them.
+ *
+ * @tparam T Configuration data. (Default constructor must set the default values.)
+ */
+template<typename T>
+class ConfSnapshot
+{
+public:
+	ConfSnapshot()
+		: m_current(std::make_shared<const T>())
+		, m_isDefault(true)
+	{ }
+
+	RP_DISABLE_COPY(ConfSnapshot)
+
+public:
+	/**
+	 * Get the current snapshot.
+	 * @return Current snapshot
+	 */
+	inline std::shared_ptr<const T> get(void) const
+	{
+#ifdef CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR
+		return m_current.load(std::memory_order_acquire);
+#else /* !CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+		return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+#endif /* CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+	}
+
+	/**
+	 * Get the snapshot that's being loaded.
+	 * NOTE: mtxLoad must be held.
+	 * @return Snapshot being loaded
+	 */
+	inline T *loading(void)
+	{
+		assert((bool)m_loading);
+		return m_loading.get();
+	}
+
+	/**
+	 * Start loading a new snapshot with the default values.
+	 * NOTE: mtxLoad must be held.
+	 */
+	inline void reset(void)
+	{
+		m_loading.reset(new T());
+	}
+
+	/**
+	 * Publish the snapshot that's being loaded.
+	 * NOTE: mtxLoad must be held.
+	 * @param loaded True if the configuration was loaded; false to revert to the default values.
+	 */
+	void publish(bool loaded)
+	{
+		if (!loaded) {
+			// Revert to the default values.
+			if (m_isDefault) {
+				// Already using the default values.
+				m_loading.reset();
+				return;
+			}
+			m_loading.reset(new T());
+		}
+
+		assert((bool)m_loading);
+		std::shared_ptr<const T> snapshot(m_loading.release());
+#ifdef CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR
+		m_current.store(std::move(snapshot), std::memory_order_release);
+#else /* !CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+		std::atomic_store_explicit(&m_current, std::move(snapshot), std::memory_order_release);
+#endif /* CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+		m_isDefault = !loaded;
+	}
+
+private:
+#ifdef CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR
+	std::atomic<std::shared_ptr<const T> > m_current;
+#else /* !CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+	std::shared_ptr<const T> m_current;
+#endif /* CONFSNAPSHOT_HAS_ATOMIC_SHARED_PTR */
+	std::unique_ptr<T> m_loading;
+	bool m_isDefault;
+};
+
 class ConfReader;
 class NOVTABLE ConfReaderPrivate
 {
@@ -29,13 +138,14 @@ public:
 	 * @param filename Configuration filename. Relative to ~/.config/rom-properties
 	 */
 	explicit ConfReaderPrivate(const char *filename);
-	virtual ~ConfReaderPrivate() = default;
+	virtual ~ConfReaderPrivate();
 
 public:
 	RP_DISABLE_COPY(ConfReaderPrivate)
 
 public:
 	// load() mutex
+	// NOTE: Only used for loading. Readers use the published snapshot.
 	std::mutex mtxLoad;
 
 	// Configuration filename.
@@ -43,16 +153,45 @@ public:
 	std::string conf_filename;		// alloc()'d in load()
 
 	// rom-properties.conf status.
-	time_t conf_mtime;
-	time_t conf_last_checked;
-	bool conf_was_found;
+	std::atomic<time_t> conf_mtime;
+	std::atomic<time_t> conf_last_checked;
+	std::atomic<bool> conf_was_found;
+
+#ifdef HAVE_INOTIFY_INIT1
+	// inotify watch on the configuration directory. (-1 if not watching)
+	std::atomic<int> inotify_fd;
+
+	/**
+	 * Start watching the configuration directory using inotify.
+	 * NOTE: mtxLoad must be held.
+	 * @param dir Configuration directory
+	 */
+	void initInotify(const std::string &dir);
+
+	/**
+	 * Check for inotify events on the configuration file.
+	 * If the watch is lost, inotify is closed and the mtime
+	 * will be checked instead.
+	 * @return True if the configuration file has changed; false if not.
+	 */
+	bool checkInotify(void);
+#endif /* HAVE_INOTIFY_INIT1 */
 
 public:
 	/**
-	 * Reset the configuration to the default values.
+	 * Start loading a new configuration with the default values.
+	 * NOTE: mtxLoad must be held.
 	 */
 	virtual void reset(void) = 0;
 
+	/**
+	 * Publish the configuration that was loaded by processConfigLine().
+	 * Readers will see the new configuration on their next access.
+	 * NOTE: mtxLoad must be held.
+	 * @param loaded True if the configuration was loaded; false to revert to the default values.
+	 */
+	virtual void publish(bool loaded) = 0;
+
 	/**
 	 * Process a configuration line.
 	 * Static function; used by inih as a C-style callback function.
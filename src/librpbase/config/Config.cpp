@@ -45,10 +45,19 @@ public:
 
 public:
 	/**
-	 * Reset the configuration to the default values.
+	 * Start loading a new configuration with the default values.
+	 * NOTE: mtxLoad must be held.
 	 */
 	void reset(void) final;
 
+	/**
+	 * Publish the configuration that was loaded by processConfigLine().
+	 * Readers will see the new configuration on their next access.
+	 * NOTE: mtxLoad must be held.
+	 * @param loaded True if the configuration was loaded; false to revert to the default values.
+	 */
+	void publish(bool loaded) final;
+
 	/**
 	 * Process a configuration line.
 	 * Virtual function; must be reimplemented by subclasses.
@@ -71,46 +80,63 @@ public:
 	 */
 	static const array<uint8_t, 8> defImgTypePrio;
 
-	// Image type priority data.
-	// Managed as a single block in order to reduce
-	// memory allocations.
-	rp::uvector<uint8_t> vImgTypePrio;
-
-	/**
-	 * Map of RomData subclass names to vImgTypePrio indexes.
-	 * - Key: RomData subclass name.
-	 * - Value: vImgTypePrio information.
-	 *   - High byte: Data length.
-	 *   - Low 3 bytes: Data offset.
-	 */
-	unordered_map<string, uint32_t> mapImgTypePrio;
-
 	// PAL language codes for GameTDB (NULL-terminated array)
 	// NOTE: 'au' is technically not a language code, but
 	// GameTDB handles it as a separate language.
 	static const array<uint32_t, 9+1> pal_lc;
 
-	// Download options
-	uint32_t palLanguageForGameTDB;
-	bool extImgDownloadEnabled;
-	bool useIntIconForSmallSizes;
-	bool storeFileOriginInfo;
-
-	// Image bandwidth options
-	Config::ImgBandwidth imgBandwidthUnmetered;
-	Config::ImgBandwidth imgBandwidthMetered;
-	// Compatibility with older settings
-	bool isNewBandwidthOptionSet;
-	bool downloadHighResScans;
-
-	// DMG title screen mode [index is ROM type]
-	array<Config::DMG_TitleScreen_Mode, static_cast<size_t>(Config::DMG_TitleScreen_Mode::Max)> dmgTSMode;
-
-	// Other options
-	bool showDangerousPermissionsOverlayIcon;
-	bool enableThumbnailOnNetworkFS;
-	bool showXAttrView;
-	bool thumbnailDirectoryPackages;
+	/**
+	 * Configuration data.
+	 * This is an immutable snapshot once it's been published.
+	 */
+	struct Data {
+		Data();
+
+		// Image type priority data.
+		// Managed as a single block in order to reduce
+		// memory allocations.
+		rp::uvector<uint8_t> vImgTypePrio;
+
+		/**
+		 * Map of RomData subclass names to vImgTypePrio indexes.
+		 * - Key: RomData subclass name.
+		 * - Value: vImgTypePrio information.
+		 *   - High byte: Data length.
+		 *   - Low 3 bytes: Data offset.
+		 */
+		unordered_map<string, uint32_t> mapImgTypePrio;
+
+		// Download options
+		uint32_t palLanguageForGameTDB;
+		bool extImgDownloadEnabled;
+		bool useIntIconForSmallSizes;
+		bool storeFileOriginInfo;
+
+		// Image bandwidth options
+		Config::ImgBandwidth imgBandwidthUnmetered;
+		Config::ImgBandwidth imgBandwidthMetered;
+		// Compatibility with older settings
+		bool isNewBandwidthOptionSet;
+		bool downloadHighResScans;
+
+		// Download cache size limit, in MiB (0 for unlimited)
+		uint32_t cacheSizeLimit;
+
+		// DMG title screen mode [index is ROM type]
+		array<Config::DMG_TitleScreen_Mode, static_cast<size_t>(Config::DMG_TitleScreen_Mode::Max)> dmgTSMode;
+
+		// Thumbnail options
+		Config::PngEncodeProfile pngEncodeProfile;
+
+		// Other options
+		bool showDangerousPermissionsOverlayIcon;
+		bool enableThumbnailOnNetworkFS;
+		bool showXAttrView;
+		bool thumbnailDirectoryPackages;
+	};
+
+	// Configuration snapshot
+	ConfSnapshot<Data> data;
 
 public:
 	/** Default values **/
@@ -125,9 +151,15 @@ public:
 	static constexpr Config::ImgBandwidth imgBandwidthUnmetered_default = Config::ImgBandwidth::HighRes;
 	static constexpr Config::ImgBandwidth imgBandwidthMetered_default = Config::ImgBandwidth::NormalRes;
 
+	// Download cache size limit, in MiB
+	static constexpr uint32_t cacheSizeLimit_default = 1024;
+
 	// DMG title screen mode [index is ROM type]
 	static const array<Config::DMG_TitleScreen_Mode, static_cast<size_t>(Config::DMG_TitleScreen_Mode::Max)> dmgTSMode_default;
 
+	// Thumbnail options
+	static constexpr Config::PngEncodeProfile pngEncodeProfile_default = Config::PngEncodeProfile::Balanced;
+
 	// Other options
 	static constexpr bool showDangerousPermissionsOverlayIcon_default = true;
 	static constexpr bool enableThumbnailOnNetworkFS_default = false;
@@ -174,8 +206,15 @@ const array<Config::DMG_TitleScreen_Mode, static_cast<size_t>(Config::DMG_TitleS
 
 ConfigPrivate::ConfigPrivate()
 	: super("rom-properties.conf")
+{ }
+
+/**
+ * Configuration data.
+ * Initialized to the default values.
+ */
+ConfigPrivate::Data::Data()
 	// Download options
-	, palLanguageForGameTDB(palLanguageForGameTDB_default)
+	: palLanguageForGameTDB(palLanguageForGameTDB_default)
 	, extImgDownloadEnabled(extImgDownloadEnabled_default)
 	, useIntIconForSmallSizes(useIntIconForSmallSizes_default)
 	, storeFileOriginInfo(storeFileOriginInfo_default)
@@ -185,6 +224,12 @@ ConfigPrivate::ConfigPrivate()
 	// Compatibility with older settings
 	, isNewBandwidthOptionSet(false)
 	, downloadHighResScans(true)
+	// Download cache size limit
+	, cacheSizeLimit(cacheSizeLimit_default)
+	// DMG title screen mode
+	, dmgTSMode(dmgTSMode_default)
+	// Thumbnail options
+	, pngEncodeProfile(pngEncodeProfile_default)
 	// Overlay icon
 	, showDangerousPermissionsOverlayIcon(showDangerousPermissionsOverlayIcon_default)
 	// Enable thumbnailing and metadata on network FS
@@ -194,49 +239,32 @@ ConfigPrivate::ConfigPrivate()
 	// Thumbnail directory packages (e.g. Wii U)
 	, thumbnailDirectoryPackages(thumbnailDirectoryPackages_default)
 {
-	// NOTE: Configuration is also initialized in the reset() function.
-	dmgTSMode = dmgTSMode_default;
-}
-
-/**
- * Reset the configuration to the default values.
- */
-void ConfigPrivate::reset(void)
-{
-	// Clear the image type priorities vector and map.
-	vImgTypePrio.clear();
-	mapImgTypePrio.clear();
-
 	// Reserve 1 KB for the image type priorities store.
 	vImgTypePrio.reserve(1024);
 #ifdef HAVE_UNORDERED_MAP_RESERVE
 	// Reserve 16 entries for the map.
 	mapImgTypePrio.reserve(16);
 #endif
+}
 
-	// Download options
-	extImgDownloadEnabled = extImgDownloadEnabled_default;
-	useIntIconForSmallSizes = useIntIconForSmallSizes_default;
-	storeFileOriginInfo = storeFileOriginInfo_default;
-
-	// Image bandwidth options
-	imgBandwidthUnmetered = imgBandwidthUnmetered_default;
-	imgBandwidthMetered = imgBandwidthMetered_default;
-	// Compatibility with older settings
-	isNewBandwidthOptionSet = false;
-	downloadHighResScans = true;
-
-	// DMG title screen mode
-	dmgTSMode = dmgTSMode_default;
+/**
+ * Start loading a new configuration with the default values.
+ * NOTE: mtxLoad must be held.
+ */
+void ConfigPrivate::reset(void)
+{
+	data.reset();
+}
 
-	// Overlay icon
-	showDangerousPermissionsOverlayIcon = showDangerousPermissionsOverlayIcon_default;
-	// Enable thumbnail and metadata on network FS
-	enableThumbnailOnNetworkFS = enableThumbnailOnNetworkFS_default;
-	// Show the Extended Attributes tab
-	showXAttrView = showXAttrView_default;
-	// Thumbnail directory packages (e.g. Wii U)
-	thumbnailDirectoryPackages = thumbnailDirectoryPackages_default;
+/**
+ * Publish the configuration that was loaded by processConfigLine().
+ * Readers will see the new configuration on their next access.
+ * NOTE: mtxLoad must be held.
+ * @param loaded True if the configuration was loaded; false to revert to the default values.
+ */
+void ConfigPrivate::publish(bool loaded)
+{
+	data.publish(loaded);
 }
 
 /**
@@ -251,6 +279,7 @@ void ConfigPrivate::reset(void)
 int ConfigPrivate::processConfigLine(const char *section, const char *name, const char *value)
 {
 	// NOTE: Invalid lines are ignored, so we're always returning 1.
+	Data *const ld = data.loading();
 
 	// Verify that the parameters are valid.
 	if (!section || section[0] == 0 ||
@@ -268,29 +297,38 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 		Config::ImgBandwidth *ibParam = nullptr;
 
 		if (!strcasecmp(name, "ExtImageDownload")) {
-			bParam = &extImgDownloadEnabled;
+			bParam = &ld->extImgDownloadEnabled;
 		} else if (!strcasecmp(name, "UseIntIconForSmallSizes")) {
-			bParam = &useIntIconForSmallSizes;
+			bParam = &ld->useIntIconForSmallSizes;
 		} else if (!strcasecmp(name, "StoreFileOriginInfo")) {
-			bParam = &storeFileOriginInfo;
+			bParam = &ld->storeFileOriginInfo;
 		} else if (!strcasecmp(name, "PalLanguageForGameTDB")) {
 			// PAL language. Parse the language code.
 			// NOTE: Converting to lowercase.
 			// TODO: Only allow valid language codes?
-			palLanguageForGameTDB = 0;
+			ld->palLanguageForGameTDB = 0;
 			for (unsigned int i = 0; i < 4 && *value != '\0'; i++, value++) {
-				palLanguageForGameTDB <<= 8;
-				palLanguageForGameTDB |= TOLOWER(*value);
+				ld->palLanguageForGameTDB <<= 8;
+				ld->palLanguageForGameTDB |= TOLOWER(*value);
+			}
+			return 1;
+		} else if (!strcasecmp(name, "CacheSizeLimit")) {
+			// Download cache size limit, in MiB.
+			// 0 means unlimited.
+			char *endptr = nullptr;
+			const unsigned long ulValue = strtoul(value, &endptr, 10);
+			if (endptr != value && *endptr == '\0' && ulValue <= UINT32_MAX) {
+				ld->cacheSizeLimit = static_cast<uint32_t>(ulValue);
 			}
 			return 1;
 		} else if (!strcasecmp(name, "ImgBandwidthUnmetered")) {
-			isNewBandwidthOptionSet = true;
-			ibParam = &imgBandwidthUnmetered;
+			ld->isNewBandwidthOptionSet = true;
+			ibParam = &ld->imgBandwidthUnmetered;
 		} else if (!strcasecmp(name, "ImgBandwidthMetered")) {
-			isNewBandwidthOptionSet = true;
-			ibParam = &imgBandwidthMetered;
+			ld->isNewBandwidthOptionSet = true;
+			ibParam = &ld->imgBandwidthMetered;
 		} else if (!strcasecmp(name, "DownloadHighResScans")) {
-			bParam = &downloadHighResScans;
+			bParam = &ld->downloadHighResScans;
 		} else {
 			// Invalid option.
 			return 1;
@@ -351,18 +389,32 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			return 1;
 		}
 
-		dmgTSMode[static_cast<size_t>(dmg_key)] = dmg_value;
+		ld->dmgTSMode[static_cast<size_t>(dmg_key)] = dmg_value;
 	} else if (!strcasecmp(section, "Options")) {
 		// Options.
+		if (!strcasecmp(name, "PngEncodeProfile")) {
+			// PNG encoder profile for thumbnails.
+			if (!strcasecmp(value, "Fastest")) {
+				ld->pngEncodeProfile = Config::PngEncodeProfile::Fastest;
+			} else if (!strcasecmp(value, "Balanced")) {
+				ld->pngEncodeProfile = Config::PngEncodeProfile::Balanced;
+			} else if (!strcasecmp(value, "Smallest")) {
+				ld->pngEncodeProfile = Config::PngEncodeProfile::Smallest;
+			} else {
+				// TODO: Show a warning or something?
+			}
+			return 1;
+		}
+
 		bool *bParam;
 		if (!strcasecmp(name, "ShowDangerousPermissionsOverlayIcon")) {
-			bParam = &showDangerousPermissionsOverlayIcon;
+			bParam = &ld->showDangerousPermissionsOverlayIcon;
 		} else if (!strcasecmp(name, "EnableThumbnailOnNetworkFS")) {
-			bParam = &enableThumbnailOnNetworkFS;
+			bParam = &ld->enableThumbnailOnNetworkFS;
 		} else if (!strcasecmp(name, "ShowXAttrView")) {
-			bParam = &showXAttrView;
+			bParam = &ld->showXAttrView;
 		} else if (!strcasecmp(name, "ThumbnailDirectoryPackages")) {
-			bParam = &thumbnailDirectoryPackages;
+			bParam = &ld->thumbnailDirectoryPackages;
 		} else {
 			// Invalid option.
 			return 1;
@@ -394,7 +446,7 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 		}
 
 		// Parse the comma-separated values.
-		const size_t vStartPos = vImgTypePrio.size();
+		const size_t vStartPos = ld->vImgTypePrio.size();
 		unsigned int count = 0;	// Number of image types.
 		uint32_t imgbf = 0;	// Image type bitfield to prevent duplicates.
 		while (*pos) {
@@ -414,7 +466,7 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			// for this system are disabled.
 			if (count == 0 && len == 2 && !strncasecmp(pos, "no", 2)) {
 				// Thumbnails are disabled.
-				vImgTypePrio.push_back((uint8_t)RomData::IMG_DISABLED);
+				ld->vImgTypePrio.push_back((uint8_t)RomData::IMG_DISABLED);
 				count = 1;
 				break;
 			}
@@ -500,7 +552,7 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 				// Too many image types...
 				break;
 			}
-			vImgTypePrio.push_back(static_cast<uint8_t>(imgType));
+			ld->vImgTypePrio.push_back(static_cast<uint8_t>(imgType));
 			count++;
 
 			if (!comma)
@@ -519,7 +571,7 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			// Add the class name information to the map.
 			uint32_t keyIdx = static_cast<uint32_t>(vStartPos);
 			keyIdx |= (count << 24);
-			mapImgTypePrio.emplace(className_lower, keyIdx);
+			ld->mapImgTypePrio.emplace(className_lower, keyIdx);
 		}
 	}
 
@@ -572,15 +624,17 @@ Config::ImgTypeResult Config::getImgTypePrio(const char *className, ImgTypePrio_
 
 	// Find the class name in the map.
 	RP_D(const Config);
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
 	string className_lower(className);
 	std::transform(className_lower.begin(), className_lower.end(), className_lower.begin(),
 		[](char c) noexcept -> char { return std::tolower(c); });
-	auto iter = d->mapImgTypePrio.find(className_lower);
-	if (iter == d->mapImgTypePrio.end()) {
+	auto iter = cd->mapImgTypePrio.find(className_lower);
+	if (iter == cd->mapImgTypePrio.end()) {
 		// Class name not found.
 		// Use the global defaults.
 		imgTypePrio->imgTypes = d->defImgTypePrio.data();
 		imgTypePrio->length = d->defImgTypePrio.size();
+		imgTypePrio->owner.reset();
 		return ImgTypeResult::SuccessDefaults;
 	}
 
@@ -590,23 +644,24 @@ Config::ImgTypeResult Config::getImgTypePrio(const char *className, ImgTypePrio_
 	const uint32_t idx = (keyIdx & 0xFFFFFF);
 	const uint8_t len = ((keyIdx >> 24) & 0xFF);
 	assert(len > 0);
-	assert(idx < d->vImgTypePrio.size());
-	assert(idx + len <= d->vImgTypePrio.size());
-	if (len == 0 || idx >= d->vImgTypePrio.size() || idx + len > d->vImgTypePrio.size()) {
+	assert(idx < cd->vImgTypePrio.size());
+	assert(idx + len <= cd->vImgTypePrio.size());
+	if (len == 0 || idx >= cd->vImgTypePrio.size() || idx + len > cd->vImgTypePrio.size()) {
 		// Entry is invalid...
 		// TODO: Force a configuration reload?
 		return ImgTypeResult::ErrorMapCorrupted;
 	}
 
 	// Is the first entry RomData::IMG_DISABLED?
-	if (d->vImgTypePrio[idx] == static_cast<uint8_t>(RomData::IMG_DISABLED)) {
+	if (cd->vImgTypePrio[idx] == static_cast<uint8_t>(RomData::IMG_DISABLED)) {
 		// Thumbnails are disabled for this class.
 		return ImgTypeResult::Disabled;
 	}
 
 	// Return the starting address and length.
-	imgTypePrio->imgTypes = &d->vImgTypePrio[idx];
+	imgTypePrio->imgTypes = &cd->vImgTypePrio[idx];
 	imgTypePrio->length = len;
+	imgTypePrio->owner = cd;
 	return ImgTypeResult::Success;
 }
 
@@ -622,6 +677,7 @@ void Config::getDefImgTypePrio(ImgTypePrio_t *imgTypePrio)
 	if (imgTypePrio) {
 		imgTypePrio->imgTypes = ConfigPrivate::defImgTypePrio.data();
 		imgTypePrio->length = ConfigPrivate::defImgTypePrio.size();
+		imgTypePrio->owner.reset();
 	}
 }
 
@@ -643,7 +699,8 @@ const uint32_t *Config::get_all_pal_lcs(void)
 uint32_t Config::palLanguageForGameTDB(void) const
 {
 	RP_D(const Config);
-	return d->palLanguageForGameTDB;
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	return cd->palLanguageForGameTDB;
 }
 
 /* Image bandwidth settings */
@@ -656,13 +713,14 @@ uint32_t Config::palLanguageForGameTDB(void) const
 Config::ImgBandwidth Config::imgBandwidthUnmetered(void) const
 {
 	RP_D(const Config);
-	if (d->isNewBandwidthOptionSet) {
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	if (cd->isNewBandwidthOptionSet) {
 		// New options are set.
-		return d->imgBandwidthUnmetered;
+		return cd->imgBandwidthUnmetered;
 	} else {
 		// New options are *not* set.
 		// Use the old option to select between high-res and normal-res.
-		return (d->downloadHighResScans) ? ImgBandwidth::HighRes : ImgBandwidth::NormalRes;
+		return (cd->downloadHighResScans) ? ImgBandwidth::HighRes : ImgBandwidth::NormalRes;
 	}
 }
 
@@ -674,9 +732,10 @@ Config::ImgBandwidth Config::imgBandwidthUnmetered(void) const
 Config::ImgBandwidth Config::imgBandwidthMetered(void) const
 {
 	RP_D(const Config);
-	if (d->isNewBandwidthOptionSet) {
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	if (cd->isNewBandwidthOptionSet) {
 		// New options are set.
-		return d->imgBandwidthMetered;
+		return cd->imgBandwidthMetered;
 	} else {
 		// New options are *not* set.
 		// Default to normal resolution for metered connections.
@@ -702,6 +761,18 @@ const char *Config::imgBandwidthToConfSetting(Config::ImgBandwidth imgbw)
 	}
 }
 
+/**
+ * Maximum size of the download cache, in MiB.
+ * Least-recently used files are deleted once the cache exceeds this size.
+ * @return Maximum cache size, in MiB (0 for unlimited)
+ */
+uint32_t Config::cacheSizeLimit(void) const
+{
+	RP_D(const Config);
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	return cd->cacheSizeLimit;
+}
+
 /** DMG title screen mode **/
 
 /**
@@ -721,7 +792,39 @@ Config::DMG_TitleScreen_Mode Config::dmgTitleScreenMode(DMG_TitleScreen_Mode rom
 	}
 
 	RP_D(const Config);
-	return d->dmgTSMode[static_cast<size_t>(romType)];
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	return cd->dmgTSMode[static_cast<size_t>(romType)];
+}
+
+/** Thumbnail options **/
+
+/**
+ * PNG encoder profile for thumbnails.
+ * @return PNG encoder profile
+ */
+Config::PngEncodeProfile Config::pngEncodeProfile(void) const
+{
+	RP_D(const Config);
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
+	return cd->pngEncodeProfile;
+}
+
+/**
+ * Convert Config::PngEncodeProfile to a configuration setting string.
+ * @param profile Config::PngEncodeProfile
+ * @return Configuration setting string (If the profile is invalid, defaults to "Balanced".)
+ */
+const char *Config::pngEncodeProfileToConfSetting(Config::PngEncodeProfile profile)
+{
+	switch (profile) {
+		case Config::PngEncodeProfile::Fastest:
+			return "Fastest";
+		case Config::PngEncodeProfile::Smallest:
+			return "Smallest";
+		case Config::PngEncodeProfile::Balanced:
+		default:
+			return "Balanced";
+	}
 }
 
 /** Boolean configuration options **/
@@ -734,6 +837,7 @@ Config::DMG_TitleScreen_Mode Config::dmgTitleScreenMode(DMG_TitleScreen_Mode rom
 bool Config::getBoolConfigOption(BoolConfig option) const
 {
 	RP_D(const Config);
+	const std::shared_ptr<const ConfigPrivate::Data> cd = d->data.get();
 
 	switch (option) {
 		default:
@@ -741,20 +845,20 @@ bool Config::getBoolConfigOption(BoolConfig option) const
 			return false;
 
 		case BoolConfig::Downloads_ExtImgDownloadEnabled:
-			return d->extImgDownloadEnabled;
+			return cd->extImgDownloadEnabled;
 		case BoolConfig::Downloads_UseIntIconForSmallSizes:
-			return d->useIntIconForSmallSizes;
+			return cd->useIntIconForSmallSizes;
 		case BoolConfig::Downloads_StoreFileOriginInfo:
-			return d->storeFileOriginInfo;
+			return cd->storeFileOriginInfo;
 
 		case BoolConfig::Options_ShowDangerousPermissionsOverlayIcon:
-			return d->showDangerousPermissionsOverlayIcon;
+			return cd->showDangerousPermissionsOverlayIcon;
 		case BoolConfig::Options_EnableThumbnailOnNetworkFS:
-			return d->enableThumbnailOnNetworkFS;
+			return cd->enableThumbnailOnNetworkFS;
 		case BoolConfig::Options_ShowXAttrView:
-			return d->showXAttrView;
+			return cd->showXAttrView;
 		case BoolConfig::Options_ThumbnailDirectoryPackages:
-			return d->thumbnailDirectoryPackages;
+			return cd->thumbnailDirectoryPackages;
 	}
 }
 
@@ -770,6 +874,8 @@ T Config::name##_default(void) \
 DEFAULT_VALUE_IMPL(uint32_t, palLanguageForGameTDB)
 DEFAULT_VALUE_IMPL(Config::ImgBandwidth, imgBandwidthUnmetered)
 DEFAULT_VALUE_IMPL(Config::ImgBandwidth, imgBandwidthMetered)
+DEFAULT_VALUE_IMPL(uint32_t, cacheSizeLimit)
+DEFAULT_VALUE_IMPL(Config::PngEncodeProfile, pngEncodeProfile)
 
 Config::DMG_TitleScreen_Mode Config::dmgTitleScreenMode_default(DMG_TitleScreen_Mode romType)
 {
@@ -13,6 +13,9 @@
 // C includes (C++ namespace)
 #include <cstdint>
 
+// C++ includes
+#include <memory>
+
 namespace LibRpBase {
 
 class RP_LIBROMDATA_PUBLIC Config : public ConfReader
@@ -39,6 +42,15 @@ public:
 	 * This automatically initializes the object and
 	 * reloads the configuration if it has been modified.
 	 *
+	 * Thread safety: The parsed configuration is an immutable
+	 * snapshot. Reloading builds a new snapshot and publishes it
+	 * atomically, so instance() and the getters may be called from
+	 * any thread, and each getter sees either the old values or the
+	 * new values, never a mix. Separate getter calls may see
+	 * different snapshots if the configuration is reloaded between
+	 * them. Data returned by reference, e.g. ImgTypePrio_t, keeps
+	 * its snapshot alive until it's destroyed.
+	 *
 	 * @return Config instance.
 	 */
 	static Config *instance(void);
@@ -50,6 +62,7 @@ public:
 	struct ImgTypePrio_t {
 		const uint8_t *imgTypes;	// Image types
 		size_t length;			// Length of imgTypes array
+		std::shared_ptr<const void> owner;	// Keeps imgTypes valid if the configuration is reloaded
 	};
 
 	// TODO: Function to get image type priority for a specified class.
@@ -76,6 +89,8 @@ public:
 	/**
 	 * Get the image type priority data for the specified class name.
 	 * NOTE: Call load() before using this function.
+	 * NOTE: The returned data remains valid as long as imgTypePrio exists,
+	 * even if the configuration is reloaded.
 	 * @param className	[in] Class name. (ASCII)
 	 * @param imgTypePrio	[out] Image type priority data.
 	 * @return ImgTypeResult
@@ -125,6 +140,13 @@ public:
 	 */
 	static const char *imgBandwidthToConfSetting(Config::ImgBandwidth imgbw);
 
+	/**
+	 * Maximum size of the download cache, in MiB.
+	 * Least-recently used files are deleted once the cache exceeds this size.
+	 * @return Maximum cache size, in MiB (0 for unlimited)
+	 */
+	uint32_t cacheSizeLimit(void) const;
+
 	/** DMG title screen mode **/
 
 	enum class DMG_TitleScreen_Mode : uint8_t {
@@ -142,6 +164,29 @@ public:
 	 */
 	DMG_TitleScreen_Mode dmgTitleScreenMode(DMG_TitleScreen_Mode romType) const;
 
+	/** Thumbnail options **/
+
+	enum class PngEncodeProfile : uint8_t {
+		Fastest,	// zlib level 1 (RLE), Sub filter (no filtering for paletted images)
+		Balanced,	// zlib default level, no filtering
+		Smallest,	// zlib level 9, adaptive filtering
+
+		Max
+	};
+
+	/**
+	 * PNG encoder profile for thumbnails.
+	 * @return PNG encoder profile
+	 */
+	PngEncodeProfile pngEncodeProfile(void) const;
+
+	/**
+	 * Convert Config::PngEncodeProfile to a configuration setting string.
+	 * @param profile Config::PngEncodeProfile
+	 * @return Configuration setting string (If the profile is invalid, defaults to "Balanced".)
+	 */
+	static const char *pngEncodeProfileToConfSetting(Config::PngEncodeProfile profile);
+
 	/** Boolean configuration options **/
 
 	enum class BoolConfig {
@@ -191,6 +236,12 @@ public:
 	 */
 	static ImgBandwidth imgBandwidthMetered_default(void);
 
+	/**
+	 * Maximum size of the download cache, in MiB. (default value)
+	 * @return Maximum cache size, in MiB (0 for unlimited)
+	 */
+	static uint32_t cacheSizeLimit_default(void);
+
 	/** DMG title screen mode **/
 
 	/**
@@ -200,6 +251,14 @@ public:
 	 */
 	static DMG_TitleScreen_Mode dmgTitleScreenMode_default(DMG_TitleScreen_Mode romType);
 
+	/** Thumbnail options **/
+
+	/**
+	 * PNG encoder profile for thumbnails. (default value)
+	 * @return PNG encoder profile
+	 */
+	static PngEncodeProfile pngEncodeProfile_default(void);
+
 	/** Boolean configuration options **/
 
 	/**
@@ -0,0 +1,475 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesArmCE.cpp: AES decryption class using ARMv8 Crypto Extensions.       *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.librpbase.h"
+
+#include "AesArmCE.hpp"
+#include "AesKeyExpansion.hpp"
+
+// librpbyteswap, librpcpuid
+#include "librpbyteswap/byteswap_rp.h"
+#include "librpcpuid/cpuflags_arm.h"
+
+// ARM NEON and Crypto Extensions intrinsics
+#include <arm_neon.h>
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ STL classes
+#include <array>
+using std::array;
+
+namespace LibRpBase {
+
+class AesArmCEPrivate
+{
+public:
+	AesArmCEPrivate();
+	~AesArmCEPrivate() = default;
+
+public:
+	RP_DISABLE_COPY(AesArmCEPrivate)
+
+public:
+	static constexpr unsigned int AES_BLOCK_SIZE = 16;
+	static constexpr unsigned int MAX_ROUNDS = AesKeyExpansion::MAX_ROUNDS;
+
+	// Round keys
+	// Decryption keys are for the Equivalent Inverse Cipher.
+	array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> enc_keys;
+	array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> dec_keys;
+	unsigned int rounds;	// 0 if no key has been set
+
+	// CBC: Initialization vector
+	// CTR: Counter
+	array<uint8_t, 16> iv;
+
+	IAesCipher::ChainingMode chainingMode;
+
+public:
+	/**
+	 * Load the round keys into registers.
+	 * @param k	[out] Round keys
+	 * @param src	[in] Round key array
+	 */
+	inline void loadKeys(uint8x16_t *k, const array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> &src) const
+	{
+		for (unsigned int i = 0; i <= rounds; i++) {
+			k[i] = vld1q_u8(&src[i * AES_BLOCK_SIZE]);
+		}
+	}
+
+	/**
+	 * Decrypt data using ECB.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void decryptECB(uint8_t *RESTRICT pData, size_t blocks) const;
+
+	/**
+	 * Decrypt data using CBC.
+	 * The IV is updated for the next call.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void decryptCBC(uint8_t *RESTRICT pData, size_t blocks);
+
+	/**
+	 * Decrypt data using CTR.
+	 * The counter is updated for the next call.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void cryptCTR(uint8_t *RESTRICT pData, size_t blocks);
+};
+
+/** AesArmCEPrivate **/
+
+AesArmCEPrivate::AesArmCEPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::ChainingMode::ECB)
+{
+	// Clear the keys.
+	enc_keys.fill(0);
+	dec_keys.fill(0);
+	iv.fill(0);
+}
+
+/**
+ * Decrypt one block.
+ *
+ * AESD performs AddRoundKey before InvShiftRows and InvSubBytes,
+ * so the last round key is applied separately.
+ *
+ * @param x	[in] Cipher text
+ * @param k	[in] Decryption round keys
+ * @param rounds	[in] Number of rounds
+ * @return Plain text
+ */
+static RP_FORCEINLINE uint8x16_t armce_decrypt1(uint8x16_t x, const uint8x16_t *k, unsigned int rounds)
+{
+	for (unsigned int i = 0; i < rounds - 1; i++) {
+		x = vaesimcq_u8(vaesdq_u8(x, k[i]));
+	}
+	x = vaesdq_u8(x, k[rounds - 1]);
+	return veorq_u8(x, k[rounds]);
+}
+
+/**
+ * Decrypt four blocks.
+ * The blocks are interleaved in order to hide the
+ * AESD/AESIMC latency.
+ * @param x	[in/out] Blocks
+ * @param k	[in] Decryption round keys
+ * @param rounds	[in] Number of rounds
+ */
+static RP_FORCEINLINE void armce_decrypt4(uint8x16_t x[4], const uint8x16_t *k, unsigned int rounds)
+{
+	for (unsigned int i = 0; i < rounds - 1; i++) {
+		x[0] = vaesimcq_u8(vaesdq_u8(x[0], k[i]));
+		x[1] = vaesimcq_u8(vaesdq_u8(x[1], k[i]));
+		x[2] = vaesimcq_u8(vaesdq_u8(x[2], k[i]));
+		x[3] = vaesimcq_u8(vaesdq_u8(x[3], k[i]));
+	}
+	x[0] = veorq_u8(vaesdq_u8(x[0], k[rounds - 1]), k[rounds]);
+	x[1] = veorq_u8(vaesdq_u8(x[1], k[rounds - 1]), k[rounds]);
+	x[2] = veorq_u8(vaesdq_u8(x[2], k[rounds - 1]), k[rounds]);
+	x[3] = veorq_u8(vaesdq_u8(x[3], k[rounds - 1]), k[rounds]);
+}
+
+/**
+ * Encrypt one block.
+ *
+ * AESE performs AddRoundKey before ShiftRows and SubBytes,
+ * so the last round key is applied separately.
+ *
+ * @param x	[in] Plain text
+ * @param k	[in] Encryption round keys
+ * @param rounds	[in] Number of rounds
+ * @return Cipher text
+ */
+static RP_FORCEINLINE uint8x16_t armce_encrypt1(uint8x16_t x, const uint8x16_t *k, unsigned int rounds)
+{
+	for (unsigned int i = 0; i < rounds - 1; i++) {
+		x = vaesmcq_u8(vaeseq_u8(x, k[i]));
+	}
+	x = vaeseq_u8(x, k[rounds - 1]);
+	return veorq_u8(x, k[rounds]);
+}
+
+/**
+ * Encrypt four blocks.
+ * The blocks are interleaved in order to hide the
+ * AESE/AESMC latency.
+ * @param x	[in/out] Blocks
+ * @param k	[in] Encryption round keys
+ * @param rounds	[in] Number of rounds
+ */
+static RP_FORCEINLINE void armce_encrypt4(uint8x16_t x[4], const uint8x16_t *k, unsigned int rounds)
+{
+	for (unsigned int i = 0; i < rounds - 1; i++) {
+		x[0] = vaesmcq_u8(vaeseq_u8(x[0], k[i]));
+		x[1] = vaesmcq_u8(vaeseq_u8(x[1], k[i]));
+		x[2] = vaesmcq_u8(vaeseq_u8(x[2], k[i]));
+		x[3] = vaesmcq_u8(vaeseq_u8(x[3], k[i]));
+	}
+	x[0] = veorq_u8(vaeseq_u8(x[0], k[rounds - 1]), k[rounds]);
+	x[1] = veorq_u8(vaeseq_u8(x[1], k[rounds - 1]), k[rounds]);
+	x[2] = veorq_u8(vaeseq_u8(x[2], k[rounds - 1]), k[rounds]);
+	x[3] = veorq_u8(vaeseq_u8(x[3], k[rounds - 1]), k[rounds]);
+}
+
+/**
+ * Decrypt data using ECB.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesArmCEPrivate::decryptECB(uint8_t *RESTRICT pData, size_t blocks) const
+{
+	uint8x16_t k[MAX_ROUNDS + 1];
+	loadKeys(k, dec_keys);
+	const unsigned int nr = rounds;
+
+	uint8_t *p = pData;
+	for (; blocks >= 4; blocks -= 4, p += 4 * AES_BLOCK_SIZE) {
+		uint8x16_t x[4];
+		x[0] = vld1q_u8(&p[0]);
+		x[1] = vld1q_u8(&p[16]);
+		x[2] = vld1q_u8(&p[32]);
+		x[3] = vld1q_u8(&p[48]);
+		armce_decrypt4(x, k, nr);
+		vst1q_u8(&p[0], x[0]);
+		vst1q_u8(&p[16], x[1]);
+		vst1q_u8(&p[32], x[2]);
+		vst1q_u8(&p[48], x[3]);
+	}
+	for (; blocks > 0; blocks--, p += AES_BLOCK_SIZE) {
+		vst1q_u8(p, armce_decrypt1(vld1q_u8(p), k, nr));
+	}
+}
+
+/**
+ * Decrypt data using CBC.
+ * The IV is updated for the next call.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesArmCEPrivate::decryptCBC(uint8_t *RESTRICT pData, size_t blocks)
+{
+	uint8x16_t k[MAX_ROUNDS + 1];
+	loadKeys(k, dec_keys);
+	const unsigned int nr = rounds;
+
+	// CBC decryption doesn't depend on the previous block's
+	// plain text, so multiple blocks can be decrypted at once.
+	uint8x16_t prev = vld1q_u8(iv.data());
+	uint8_t *p = pData;
+	for (; blocks >= 4; blocks -= 4, p += 4 * AES_BLOCK_SIZE) {
+		const uint8x16_t c0 = vld1q_u8(&p[0]);
+		const uint8x16_t c1 = vld1q_u8(&p[16]);
+		const uint8x16_t c2 = vld1q_u8(&p[32]);
+		const uint8x16_t c3 = vld1q_u8(&p[48]);
+		uint8x16_t x[4] = {c0, c1, c2, c3};
+		armce_decrypt4(x, k, nr);
+		vst1q_u8(&p[0], veorq_u8(x[0], prev));
+		vst1q_u8(&p[16], veorq_u8(x[1], c0));
+		vst1q_u8(&p[32], veorq_u8(x[2], c1));
+		vst1q_u8(&p[48], veorq_u8(x[3], c2));
+		prev = c3;
+	}
+	for (; blocks > 0; blocks--, p += AES_BLOCK_SIZE) {
+		const uint8x16_t c = vld1q_u8(p);
+		vst1q_u8(p, veorq_u8(armce_decrypt1(c, k, nr), prev));
+		prev = c;
+	}
+
+	// Save the IV for the next call.
+	vst1q_u8(iv.data(), prev);
+}
+
+/**
+ * Decrypt data using CTR.
+ * The counter is updated for the next call.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesArmCEPrivate::cryptCTR(uint8_t *RESTRICT pData, size_t blocks)
+{
+	uint8x16_t k[MAX_ROUNDS + 1];
+	loadKeys(k, enc_keys);
+	const unsigned int nr = rounds;
+
+	// The counter is a 128-bit big-endian value. (Same as Nettle's ctr_crypt().)
+	uint64_t ctr_hi, ctr_lo;
+	memcpy(&ctr_hi, &iv[0], sizeof(ctr_hi));
+	memcpy(&ctr_lo, &iv[8], sizeof(ctr_lo));
+	ctr_hi = be64_to_cpu(ctr_hi);
+	ctr_lo = be64_to_cpu(ctr_lo);
+
+	// Get the next counter block, then increment the counter.
+	auto next_ctr = [&ctr_hi, &ctr_lo]() -> uint8x16_t {
+		const uint8x16_t ctr = vreinterpretq_u8_u64(vcombine_u64(
+			vcreate_u64(cpu_to_be64(ctr_hi)),
+			vcreate_u64(cpu_to_be64(ctr_lo))));
+		if (++ctr_lo == 0) {
+			ctr_hi++;
+		}
+		return ctr;
+	};
+
+	uint8_t *p = pData;
+	for (; blocks >= 4; blocks -= 4, p += 4 * AES_BLOCK_SIZE) {
+		uint8x16_t x[4];
+		x[0] = next_ctr();
+		x[1] = next_ctr();
+		x[2] = next_ctr();
+		x[3] = next_ctr();
+		armce_encrypt4(x, k, nr);
+		vst1q_u8(&p[0], veorq_u8(x[0], vld1q_u8(&p[0])));
+		vst1q_u8(&p[16], veorq_u8(x[1], vld1q_u8(&p[16])));
+		vst1q_u8(&p[32], veorq_u8(x[2], vld1q_u8(&p[32])));
+		vst1q_u8(&p[48], veorq_u8(x[3], vld1q_u8(&p[48])));
+	}
+	for (; blocks > 0; blocks--, p += AES_BLOCK_SIZE) {
+		const uint8x16_t x = armce_encrypt1(next_ctr(), k, nr);
+		vst1q_u8(p, veorq_u8(x, vld1q_u8(p)));
+	}
+
+	// Save the counter for the next call.
+	ctr_hi = cpu_to_be64(ctr_hi);
+	ctr_lo = cpu_to_be64(ctr_lo);
+	memcpy(&iv[0], &ctr_hi, sizeof(ctr_hi));
+	memcpy(&iv[8], &ctr_lo, sizeof(ctr_lo));
+}
+
+/** AesArmCE **/
+
+AesArmCE::AesArmCE()
+	: d_ptr(new AesArmCEPrivate())
+{ }
+
+AesArmCE::~AesArmCE()
+{
+	delete d_ptr;
+}
+
+/**
+ * Are the ARMv8 Crypto Extensions usable on this system?
+ * @return True if the CPU supports the ARMv8 AES instructions.
+ */
+bool AesArmCE::isUsable(void)
+{
+	return !!RP_CPU_arm_HasAES();
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name
+ */
+const char *AesArmCE::name(void) const
+{
+	return "ARMv8 Crypto Extensions";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesArmCE::isInit(void) const
+{
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param pKey	[in] Key data
+ * @param size	[in] Size of pKey, in bytes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesArmCE::setKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!pKey || !(size == 16 || size == 24 || size == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		// The AES instructions are not supported on this CPU.
+		return -ENOTSUP;
+	}
+
+	RP_D(AesArmCE);
+	const unsigned int rounds = AesKeyExpansion::expandEncryptKey(d->enc_keys.data(), pKey, size);
+	assert(rounds != 0);
+	if (rounds == 0) {
+		return -EINVAL;
+	}
+
+	// Decryption keys for the Equivalent Inverse Cipher:
+	// Reverse the encryption keys and apply InvMixColumns()
+	// to all of them except the first and last.
+	static constexpr unsigned int BS = AesArmCEPrivate::AES_BLOCK_SIZE;
+	const uint8_t *const ek = d->enc_keys.data();
+	uint8_t *const dk = d->dec_keys.data();
+	vst1q_u8(&dk[0], vld1q_u8(&ek[rounds * BS]));
+	for (unsigned int i = 1; i < rounds; i++) {
+		vst1q_u8(&dk[i * BS], vaesimcq_u8(vld1q_u8(&ek[(rounds - i) * BS])));
+	}
+	vst1q_u8(&dk[rounds * BS], vld1q_u8(&ek[0]));
+
+	d->rounds = rounds;
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesArmCE::setChainingMode(ChainingMode mode)
+{
+	if (mode < ChainingMode::ECB || mode >= ChainingMode::Max) {
+		return -EINVAL;
+	}
+
+	RP_D(AesArmCE);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param pIV	[in] IV/counter data
+ * @param size	[in] Size of pIV, in bytes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesArmCE::setIV(const uint8_t *RESTRICT pIV, size_t size)
+{
+	RP_D(AesArmCE);
+	if (!pIV || size != d->iv.size() ||
+	    d->chainingMode < ChainingMode::CBC || d->chainingMode >= ChainingMode::Max)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv.data(), pIV, d->iv.size());
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * Key and IV/counter must be set before calling this function.
+ *
+ * @param pData	[in/out] Data block
+ * @param size	[in] Length of data block (Must be a multiple of 16)
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+size_t AesArmCE::decrypt(uint8_t *RESTRICT pData, size_t size)
+{
+	if (!pData || size == 0 || (size % AesArmCEPrivate::AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesArmCE);
+	assert(d->rounds != 0);
+	if (d->rounds == 0) {
+		// No key has been set.
+		return 0;
+	}
+
+	const size_t blocks = size / AesArmCEPrivate::AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case ChainingMode::ECB:
+			d->decryptECB(pData, blocks);
+			break;
+		case ChainingMode::CBC:
+			d->decryptCBC(pData, blocks);
+			break;
+		case ChainingMode::CTR:
+			// NOTE: CTR uses the *encrypt* function, even for decryption.
+			d->cryptCTR(pData, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return size;
+}
+
+}
@@ -10,6 +10,7 @@
 
 #include "config.librpbase.h"
 #include "dll-macros.h"
+#include "librpcpuid/cpu_dispatch.h"
 
 namespace LibRpBase {
 
@@ -27,6 +28,7 @@ namespace AesCipherFactory
  *
  * @return IAesCipher class, or nullptr if decryption isn't supported
  */
+RP_LIBROMDATA_PUBLIC
 IAesCipher *create(void);
 
 enum class Implementation {
@@ -37,6 +39,12 @@ enum class Implementation {
 #ifdef HAVE_NETTLE
 	Nettle,
 #endif /* HAVE_NETTLE */
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+	AesNI,
+#endif /* RP_CPU_I386 || RP_CPU_AMD64 */
+#ifdef RP_CPU_ARM64
+	ArmCE,
+#endif /* RP_CPU_ARM64 */
 };
 
 /**
@@ -0,0 +1,102 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesKeyExpansion.hpp: AES key expansion for hardware AES backends.       *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common.h"
+
+// C includes (C++ namespace)
+#include <cstdint>
+#include <cstring>
+
+namespace LibRpBase { namespace AesKeyExpansion {
+
+// Maximum number of rounds. (AES-256)
+static constexpr unsigned int MAX_ROUNDS = 14;
+
+/**
+ * Expand an AES key into the encryption round keys. (FIPS-197, section 5.2)
+ *
+ * The round keys are stored as consecutive 16-byte blocks in
+ * the same byte order as the AES state, so they can be loaded
+ * directly by AES-NI and ARMv8 Crypto Extensions.
+ *
+ * The decryption round keys for the Equivalent Inverse Cipher
+ * are derived from these using InvMixColumns(), which is done
+ * by the hardware backend.
+ *
+ * @param rk	[out] Round keys [16 * (MAX_ROUNDS + 1) bytes]
+ * @param pKey	[in] Key data
+ * @param size	[in] Size of pKey, in bytes (16, 24, or 32)
+ * @return Number of rounds (10, 12, or 14), or 0 if the key size is invalid.
+ */
+static inline unsigned int expandEncryptKey(uint8_t *RESTRICT rk, const uint8_t *RESTRICT pKey, size_t size)
+{
+	static const uint8_t sbox[256] = {
+		0x63,0x7C,0x77,0x7B,0xF2,0x6B,0x6F,0xC5,0x30,0x01,0x67,0x2B,0xFE,0xD7,0xAB,0x76,
+		0xCA,0x82,0xC9,0x7D,0xFA,0x59,0x47,0xF0,0xAD,0xD4,0xA2,0xAF,0x9C,0xA4,0x72,0xC0,
+		0xB7,0xFD,0x93,0x26,0x36,0x3F,0xF7,0xCC,0x34,0xA5,0xE5,0xF1,0x71,0xD8,0x31,0x15,
+		0x04,0xC7,0x23,0xC3,0x18,0x96,0x05,0x9A,0x07,0x12,0x80,0xE2,0xEB,0x27,0xB2,0x75,
+		0x09,0x83,0x2C,0x1A,0x1B,0x6E,0x5A,0xA0,0x52,0x3B,0xD6,0xB3,0x29,0xE3,0x2F,0x84,
+		0x53,0xD1,0x00,0xED,0x20,0xFC,0xB1,0x5B,0x6A,0xCB,0xBE,0x39,0x4A,0x4C,0x58,0xCF,
+		0xD0,0xEF,0xAA,0xFB,0x43,0x4D,0x33,0x85,0x45,0xF9,0x02,0x7F,0x50,0x3C,0x9F,0xA8,
+		0x51,0xA3,0x40,0x8F,0x92,0x9D,0x38,0xF5,0xBC,0xB6,0xDA,0x21,0x10,0xFF,0xF3,0xD2,
+		0xCD,0x0C,0x13,0xEC,0x5F,0x97,0x44,0x17,0xC4,0xA7,0x7E,0x3D,0x64,0x5D,0x19,0x73,
+		0x60,0x81,0x4F,0xDC,0x22,0x2A,0x90,0x88,0x46,0xEE,0xB8,0x14,0xDE,0x5E,0x0B,0xDB,
+		0xE0,0x32,0x3A,0x0A,0x49,0x06,0x24,0x5C,0xC2,0xD3,0xAC,0x62,0x91,0x95,0xE4,0x79,
+		0xE7,0xC8,0x37,0x6D,0x8D,0xD5,0x4E,0xA9,0x6C,0x56,0xF4,0xEA,0x65,0x7A,0xAE,0x08,
+		0xBA,0x78,0x25,0x2E,0x1C,0xA6,0xB4,0xC6,0xE8,0xDD,0x74,0x1F,0x4B,0xBD,0x8B,0x8A,
+		0x70,0x3E,0xB5,0x66,0x48,0x03,0xF6,0x0E,0x61,0x35,0x57,0xB9,0x86,0xC1,0x1D,0x9E,
+		0xE1,0xF8,0x98,0x11,0x69,0xD9,0x8E,0x94,0x9B,0x1E,0x87,0xE9,0xCE,0x55,0x28,0xDF,
+		0x8C,0xA1,0x89,0x0D,0xBF,0xE6,0x42,0x68,0x41,0x99,0x2D,0x0F,0xB0,0x54,0xBB,0x16,
+	};
+
+	if (!(size == 16 || size == 24 || size == 32)) {
+		return 0;
+	}
+
+	const unsigned int Nk = static_cast<unsigned int>(size / 4);
+	const unsigned int Nr = Nk + 6;
+	const unsigned int total_words = 4 * (Nr + 1);
+
+	// The first Nk words are the key itself.
+	memcpy(rk, pKey, size);
+
+	uint8_t rcon = 0x01;
+	for (unsigned int i = Nk; i < total_words; i++) {
+		const uint8_t *const prev = &rk[(i - 1) * 4];
+		uint8_t temp[4] = {prev[0], prev[1], prev[2], prev[3]};
+
+		if (i % Nk == 0) {
+			// temp = SubWord(RotWord(temp)) ^ Rcon[i/Nk]
+			const uint8_t t0 = temp[0];
+			temp[0] = sbox[temp[1]] ^ rcon;
+			temp[1] = sbox[temp[2]];
+			temp[2] = sbox[temp[3]];
+			temp[3] = sbox[t0];
+			// xtime(rcon)
+			rcon = static_cast<uint8_t>((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0x00));
+		} else if (Nk > 6 && i % Nk == 4) {
+			// AES-256: temp = SubWord(temp)
+			for (uint8_t &b : temp) {
+				b = sbox[b];
+			}
+		}
+
+		const uint8_t *const src = &rk[(i - Nk) * 4];
+		uint8_t *const dest = &rk[i * 4];
+		dest[0] = src[0] ^ temp[0];
+		dest[1] = src[1] ^ temp[1];
+		dest[2] = src[2] ^ temp[2];
+		dest[3] = src[3] ^ temp[3];
+	}
+
+	return Nr;
+}
+
+} }
@@ -0,0 +1,530 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.cpp: AES decryption class using Intel AES-NI.                     *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.librpbase.h"
+
+#include "AesNI.hpp"
+#include "AesKeyExpansion.hpp"
+
+// librpbyteswap, librpcpuid
+#include "librpbyteswap/byteswap_rp.h"
+#include "librpcpuid/cpuflags_x86.h"
+
+// AES-NI intrinsics
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ STL classes
+#include <array>
+using std::array;
+
+namespace LibRpBase {
+
+class AesNIPrivate
+{
+public:
+	AesNIPrivate();
+	~AesNIPrivate() = default;
+
+public:
+	RP_DISABLE_COPY(AesNIPrivate)
+
+public:
+	static constexpr unsigned int AES_BLOCK_SIZE = 16;
+	static constexpr unsigned int MAX_ROUNDS = AesKeyExpansion::MAX_ROUNDS;
+
+	// Number of blocks to process at once.
+	// NOTE: i386 only has 8 XMM registers, so some of the
+	// blocks will be spilled, but this is still faster
+	// than waiting on the AESDEC/AESENC latency.
+	static constexpr unsigned int LANES = 8;
+
+	// Round keys
+	// Decryption keys are for the Equivalent Inverse Cipher.
+	alignas(16) array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> enc_keys;
+	alignas(16) array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> dec_keys;
+	unsigned int rounds;	// 0 if no key has been set
+
+	// CBC: Initialization vector
+	// CTR: Counter
+	array<uint8_t, 16> iv;
+
+	IAesCipher::ChainingMode chainingMode;
+
+public:
+	/**
+	 * Load the round keys into registers.
+	 * @param k	[out] Round keys
+	 * @param src	[in] Round key array
+	 */
+	inline void loadKeys(__m128i *k, const array<uint8_t, AES_BLOCK_SIZE * (MAX_ROUNDS + 1)> &src) const
+	{
+		for (unsigned int i = 0; i <= rounds; i++) {
+			k[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(&src[i * AES_BLOCK_SIZE]));
+		}
+	}
+
+	/**
+	 * Decrypt data using ECB.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void decryptECB(uint8_t *RESTRICT pData, size_t blocks) const;
+
+	/**
+	 * Decrypt data using CBC.
+	 * The IV is updated for the next call.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void decryptCBC(uint8_t *RESTRICT pData, size_t blocks);
+
+	/**
+	 * Decrypt data using CTR.
+	 * The counter is updated for the next call.
+	 * @param pData	[in/out] Data
+	 * @param blocks	[in] Number of 16-byte blocks
+	 */
+	void cryptCTR(uint8_t *RESTRICT pData, size_t blocks);
+};
+
+/** AesNIPrivate **/
+
+AesNIPrivate::AesNIPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::ChainingMode::ECB)
+{
+	// Clear the keys.
+	enc_keys.fill(0);
+	dec_keys.fill(0);
+	iv.fill(0);
+}
+
+/**
+ * Decrypt one block.
+ * @param x	[in] Cipher text
+ * @param k	[in] Decryption round keys
+ * @param rounds	[in] Number of rounds
+ * @return Plain text
+ */
+static RP_FORCEINLINE __m128i aesni_decrypt1(__m128i x, const __m128i *k, unsigned int rounds)
+{
+	x = _mm_xor_si128(x, k[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		x = _mm_aesdec_si128(x, k[i]);
+	}
+	return _mm_aesdeclast_si128(x, k[rounds]);
+}
+
+/**
+ * Decrypt eight blocks.
+ * The blocks are interleaved in order to hide the
+ * AESDEC latency.
+ * @param x	[in/out] Blocks
+ * @param k	[in] Decryption round keys
+ * @param rounds	[in] Number of rounds
+ */
+static RP_FORCEINLINE void aesni_decrypt8(__m128i x[8], const __m128i *k, unsigned int rounds)
+{
+	x[0] = _mm_xor_si128(x[0], k[0]);
+	x[1] = _mm_xor_si128(x[1], k[0]);
+	x[2] = _mm_xor_si128(x[2], k[0]);
+	x[3] = _mm_xor_si128(x[3], k[0]);
+	x[4] = _mm_xor_si128(x[4], k[0]);
+	x[5] = _mm_xor_si128(x[5], k[0]);
+	x[6] = _mm_xor_si128(x[6], k[0]);
+	x[7] = _mm_xor_si128(x[7], k[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		x[0] = _mm_aesdec_si128(x[0], k[i]);
+		x[1] = _mm_aesdec_si128(x[1], k[i]);
+		x[2] = _mm_aesdec_si128(x[2], k[i]);
+		x[3] = _mm_aesdec_si128(x[3], k[i]);
+		x[4] = _mm_aesdec_si128(x[4], k[i]);
+		x[5] = _mm_aesdec_si128(x[5], k[i]);
+		x[6] = _mm_aesdec_si128(x[6], k[i]);
+		x[7] = _mm_aesdec_si128(x[7], k[i]);
+	}
+	x[0] = _mm_aesdeclast_si128(x[0], k[rounds]);
+	x[1] = _mm_aesdeclast_si128(x[1], k[rounds]);
+	x[2] = _mm_aesdeclast_si128(x[2], k[rounds]);
+	x[3] = _mm_aesdeclast_si128(x[3], k[rounds]);
+	x[4] = _mm_aesdeclast_si128(x[4], k[rounds]);
+	x[5] = _mm_aesdeclast_si128(x[5], k[rounds]);
+	x[6] = _mm_aesdeclast_si128(x[6], k[rounds]);
+	x[7] = _mm_aesdeclast_si128(x[7], k[rounds]);
+}
+
+/**
+ * Encrypt one block.
+ * @param x	[in] Plain text
+ * @param k	[in] Encryption round keys
+ * @param rounds	[in] Number of rounds
+ * @return Cipher text
+ */
+static RP_FORCEINLINE __m128i aesni_encrypt1(__m128i x, const __m128i *k, unsigned int rounds)
+{
+	x = _mm_xor_si128(x, k[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		x = _mm_aesenc_si128(x, k[i]);
+	}
+	return _mm_aesenclast_si128(x, k[rounds]);
+}
+
+/**
+ * Encrypt eight blocks.
+ * The blocks are interleaved in order to hide the
+ * AESENC latency.
+ * @param x	[in/out] Blocks
+ * @param k	[in] Encryption round keys
+ * @param rounds	[in] Number of rounds
+ */
+static RP_FORCEINLINE void aesni_encrypt8(__m128i x[8], const __m128i *k, unsigned int rounds)
+{
+	x[0] = _mm_xor_si128(x[0], k[0]);
+	x[1] = _mm_xor_si128(x[1], k[0]);
+	x[2] = _mm_xor_si128(x[2], k[0]);
+	x[3] = _mm_xor_si128(x[3], k[0]);
+	x[4] = _mm_xor_si128(x[4], k[0]);
+	x[5] = _mm_xor_si128(x[5], k[0]);
+	x[6] = _mm_xor_si128(x[6], k[0]);
+	x[7] = _mm_xor_si128(x[7], k[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		x[0] = _mm_aesenc_si128(x[0], k[i]);
+		x[1] = _mm_aesenc_si128(x[1], k[i]);
+		x[2] = _mm_aesenc_si128(x[2], k[i]);
+		x[3] = _mm_aesenc_si128(x[3], k[i]);
+		x[4] = _mm_aesenc_si128(x[4], k[i]);
+		x[5] = _mm_aesenc_si128(x[5], k[i]);
+		x[6] = _mm_aesenc_si128(x[6], k[i]);
+		x[7] = _mm_aesenc_si128(x[7], k[i]);
+	}
+	x[0] = _mm_aesenclast_si128(x[0], k[rounds]);
+	x[1] = _mm_aesenclast_si128(x[1], k[rounds]);
+	x[2] = _mm_aesenclast_si128(x[2], k[rounds]);
+	x[3] = _mm_aesenclast_si128(x[3], k[rounds]);
+	x[4] = _mm_aesenclast_si128(x[4], k[rounds]);
+	x[5] = _mm_aesenclast_si128(x[5], k[rounds]);
+	x[6] = _mm_aesenclast_si128(x[6], k[rounds]);
+	x[7] = _mm_aesenclast_si128(x[7], k[rounds]);
+}
+
+/**
+ * Decrypt data using ECB.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesNIPrivate::decryptECB(uint8_t *RESTRICT pData, size_t blocks) const
+{
+	__m128i k[MAX_ROUNDS + 1];
+	loadKeys(k, dec_keys);
+	const unsigned int nr = rounds;
+
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= LANES; blocks -= LANES, p += LANES) {
+		__m128i x[LANES];
+		x[0] = _mm_loadu_si128(&p[0]);
+		x[1] = _mm_loadu_si128(&p[1]);
+		x[2] = _mm_loadu_si128(&p[2]);
+		x[3] = _mm_loadu_si128(&p[3]);
+		x[4] = _mm_loadu_si128(&p[4]);
+		x[5] = _mm_loadu_si128(&p[5]);
+		x[6] = _mm_loadu_si128(&p[6]);
+		x[7] = _mm_loadu_si128(&p[7]);
+		aesni_decrypt8(x, k, nr);
+		_mm_storeu_si128(&p[0], x[0]);
+		_mm_storeu_si128(&p[1], x[1]);
+		_mm_storeu_si128(&p[2], x[2]);
+		_mm_storeu_si128(&p[3], x[3]);
+		_mm_storeu_si128(&p[4], x[4]);
+		_mm_storeu_si128(&p[5], x[5]);
+		_mm_storeu_si128(&p[6], x[6]);
+		_mm_storeu_si128(&p[7], x[7]);
+	}
+	for (; blocks > 0; blocks--, p++) {
+		_mm_storeu_si128(p, aesni_decrypt1(_mm_loadu_si128(p), k, nr));
+	}
+}
+
+/**
+ * Decrypt data using CBC.
+ * The IV is updated for the next call.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesNIPrivate::decryptCBC(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i k[MAX_ROUNDS + 1];
+	loadKeys(k, dec_keys);
+	const unsigned int nr = rounds;
+
+	// CBC decryption doesn't depend on the previous block's
+	// plain text, so multiple blocks can be decrypted at once.
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv.data()));
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= LANES; blocks -= LANES, p += LANES) {
+		__m128i c[LANES];
+		c[0] = _mm_loadu_si128(&p[0]);
+		c[1] = _mm_loadu_si128(&p[1]);
+		c[2] = _mm_loadu_si128(&p[2]);
+		c[3] = _mm_loadu_si128(&p[3]);
+		c[4] = _mm_loadu_si128(&p[4]);
+		c[5] = _mm_loadu_si128(&p[5]);
+		c[6] = _mm_loadu_si128(&p[6]);
+		c[7] = _mm_loadu_si128(&p[7]);
+		__m128i x[LANES] = {c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]};
+		aesni_decrypt8(x, k, nr);
+		_mm_storeu_si128(&p[0], _mm_xor_si128(x[0], prev));
+		_mm_storeu_si128(&p[1], _mm_xor_si128(x[1], c[0]));
+		_mm_storeu_si128(&p[2], _mm_xor_si128(x[2], c[1]));
+		_mm_storeu_si128(&p[3], _mm_xor_si128(x[3], c[2]));
+		_mm_storeu_si128(&p[4], _mm_xor_si128(x[4], c[3]));
+		_mm_storeu_si128(&p[5], _mm_xor_si128(x[5], c[4]));
+		_mm_storeu_si128(&p[6], _mm_xor_si128(x[6], c[5]));
+		_mm_storeu_si128(&p[7], _mm_xor_si128(x[7], c[6]));
+		prev = c[LANES - 1];
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i c = _mm_loadu_si128(p);
+		_mm_storeu_si128(p, _mm_xor_si128(aesni_decrypt1(c, k, nr), prev));
+		prev = c;
+	}
+
+	// Save the IV for the next call.
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv.data()), prev);
+}
+
+/**
+ * Decrypt data using CTR.
+ * The counter is updated for the next call.
+ * @param pData	[in/out] Data
+ * @param blocks	[in] Number of 16-byte blocks
+ */
+void AesNIPrivate::cryptCTR(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i k[MAX_ROUNDS + 1];
+	loadKeys(k, enc_keys);
+	const unsigned int nr = rounds;
+
+	// The counter is a 128-bit big-endian value. (Same as Nettle's ctr_crypt().)
+	uint64_t ctr_hi, ctr_lo;
+	memcpy(&ctr_hi, &iv[0], sizeof(ctr_hi));
+	memcpy(&ctr_lo, &iv[8], sizeof(ctr_lo));
+	ctr_hi = be64_to_cpu(ctr_hi);
+	ctr_lo = be64_to_cpu(ctr_lo);
+
+	// Get the next counter block, then increment the counter.
+	auto next_ctr = [&ctr_hi, &ctr_lo]() -> __m128i {
+		const __m128i ctr = _mm_set_epi64x(
+			static_cast<long long>(cpu_to_be64(ctr_lo)),
+			static_cast<long long>(cpu_to_be64(ctr_hi)));
+		if (++ctr_lo == 0) {
+			ctr_hi++;
+		}
+		return ctr;
+	};
+
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= LANES; blocks -= LANES, p += LANES) {
+		__m128i x[LANES];
+		x[0] = next_ctr();
+		x[1] = next_ctr();
+		x[2] = next_ctr();
+		x[3] = next_ctr();
+		x[4] = next_ctr();
+		x[5] = next_ctr();
+		x[6] = next_ctr();
+		x[7] = next_ctr();
+		aesni_encrypt8(x, k, nr);
+		_mm_storeu_si128(&p[0], _mm_xor_si128(x[0], _mm_loadu_si128(&p[0])));
+		_mm_storeu_si128(&p[1], _mm_xor_si128(x[1], _mm_loadu_si128(&p[1])));
+		_mm_storeu_si128(&p[2], _mm_xor_si128(x[2], _mm_loadu_si128(&p[2])));
+		_mm_storeu_si128(&p[3], _mm_xor_si128(x[3], _mm_loadu_si128(&p[3])));
+		_mm_storeu_si128(&p[4], _mm_xor_si128(x[4], _mm_loadu_si128(&p[4])));
+		_mm_storeu_si128(&p[5], _mm_xor_si128(x[5], _mm_loadu_si128(&p[5])));
+		_mm_storeu_si128(&p[6], _mm_xor_si128(x[6], _mm_loadu_si128(&p[6])));
+		_mm_storeu_si128(&p[7], _mm_xor_si128(x[7], _mm_loadu_si128(&p[7])));
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i x = aesni_encrypt1(next_ctr(), k, nr);
+		_mm_storeu_si128(p, _mm_xor_si128(x, _mm_loadu_si128(p)));
+	}
+
+	// Save the counter for the next call.
+	ctr_hi = cpu_to_be64(ctr_hi);
+	ctr_lo = cpu_to_be64(ctr_lo);
+	memcpy(&iv[0], &ctr_hi, sizeof(ctr_hi));
+	memcpy(&iv[8], &ctr_lo, sizeof(ctr_lo));
+}
+
+/** AesNI **/
+
+AesNI::AesNI()
+	: d_ptr(new AesNIPrivate())
+{ }
+
+AesNI::~AesNI()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is AES-NI usable on this system?
+ * @return True if the CPU supports AES-NI.
+ */
+bool AesNI::isUsable(void)
+{
+	return !!RP_CPU_x86_HasAES();
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name
+ */
+const char *AesNI::name(void) const
+{
+	return "Intel AES-NI";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesNI::isInit(void) const
+{
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param pKey	[in] Key data
+ * @param size	[in] Size of pKey, in bytes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!pKey || !(size == 16 || size == 24 || size == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		// AES-NI is not supported on this CPU.
+		return -ENOTSUP;
+	}
+
+	RP_D(AesNI);
+	const unsigned int rounds = AesKeyExpansion::expandEncryptKey(d->enc_keys.data(), pKey, size);
+	assert(rounds != 0);
+	if (rounds == 0) {
+		return -EINVAL;
+	}
+
+	// Decryption keys for the Equivalent Inverse Cipher:
+	// Reverse the encryption keys and apply InvMixColumns()
+	// to all of them except the first and last.
+	const __m128i *const ek = reinterpret_cast<const __m128i*>(d->enc_keys.data());
+	__m128i *const dk = reinterpret_cast<__m128i*>(d->dec_keys.data());
+	dk[0] = _mm_load_si128(&ek[rounds]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		dk[i] = _mm_aesimc_si128(_mm_load_si128(&ek[rounds - i]));
+	}
+	dk[rounds] = _mm_load_si128(&ek[0]);
+
+	d->rounds = rounds;
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setChainingMode(ChainingMode mode)
+{
+	if (mode < ChainingMode::ECB || mode >= ChainingMode::Max) {
+		return -EINVAL;
+	}
+
+	RP_D(AesNI);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param pIV	[in] IV/counter data
+ * @param size	[in] Size of pIV, in bytes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setIV(const uint8_t *RESTRICT pIV, size_t size)
+{
+	RP_D(AesNI);
+	if (!pIV || size != d->iv.size() ||
+	    d->chainingMode < ChainingMode::CBC || d->chainingMode >= ChainingMode::Max)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv.data(), pIV, d->iv.size());
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * Key and IV/counter must be set before calling this function.
+ *
+ * @param pData	[in/out] Data block
+ * @param size	[in] Length of data block (Must be a multiple of 16)
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+size_t AesNI::decrypt(uint8_t *RESTRICT pData, size_t size)
+{
+	if (!pData || size == 0 || (size % AesNIPrivate::AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesNI);
+	assert(d->rounds != 0);
+	if (d->rounds == 0) {
+		// No key has been set.
+		return 0;
+	}
+
+	const size_t blocks = size / AesNIPrivate::AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case ChainingMode::ECB:
+			d->decryptECB(pData, blocks);
+			break;
+		case ChainingMode::CBC:
+			d->decryptCBC(pData, blocks);
+			break;
+		case ChainingMode::CTR:
+			// NOTE: CTR uses the *encrypt* function, even for decryption.
+			d->cryptCTR(pData, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return size;
+}
+
+}
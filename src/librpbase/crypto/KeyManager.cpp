@@ -59,10 +59,19 @@ public:
 
 public:
 	/**
-	 * Reset the configuration to the default values.
+	 * Start loading a new configuration with the default values.
+	 * NOTE: mtxLoad must be held.
 	 */
 	void reset(void) final;
 
+	/**
+	 * Publish the configuration that was loaded by processConfigLine().
+	 * Readers will see the new configuration on their next access.
+	 * NOTE: mtxLoad must be held.
+	 * @param loaded True if the configuration was loaded; false to revert to the default values.
+	 */
+	void publish(bool loaded) final;
+
 	/**
 	 * Process a configuration line.
 	 * Virtual function; must be reimplemented by subclasses.
@@ -76,27 +85,38 @@ public:
 
 public:
 #ifdef ENABLE_DECRYPTION
-	// Encryption key data.
-	// Managed as a single block in order to reduce
-	// memory allocations.
-	rp::uvector<uint8_t> vKeys;
-
-	/**
-	 * Map of key names to vKeys indexes.
-	 * - Key: Key name
-	 * - Value: vKeys information
-	 *   - High byte: Key length
-	 *   - Low 3 bytes: Key index
-	 */
-	unordered_map<string, uint32_t> mapKeyNames;
-
 	/**
-	 * Map of invalid key names to errors.
-	 * These are stored for better error reporting.
-	 * - Key: Key name
-	 * - Value: Verification result
+	 * Key data.
+	 * This is an immutable snapshot once it's been published.
 	 */
-	unordered_map<string, KeyManager::VerifyResult> mapInvalidKeyNames;
+	struct Data {
+		Data();
+
+		// Encryption key data.
+		// Managed as a single block in order to reduce
+		// memory allocations.
+		rp::uvector<uint8_t> vKeys;
+
+		/**
+		 * Map of key names to vKeys indexes.
+		 * - Key: Key name
+		 * - Value: vKeys information
+		 *   - High byte: Key length
+		 *   - Low 3 bytes: Key index
+		 */
+		unordered_map<string, uint32_t> mapKeyNames;
+
+		/**
+		 * Map of invalid key names to errors.
+		 * These are stored for better error reporting.
+		 * - Key: Key name
+		 * - Value: Verification result
+		 */
+		unordered_map<string, KeyManager::VerifyResult> mapInvalidKeyNames;
+	};
+
+	// Key data snapshot
+	ConfSnapshot<Data> data;
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -120,17 +140,13 @@ KeyManagerPrivate::KeyManagerPrivate()
 	: super("keys.conf")
 { }
 
+#ifdef ENABLE_DECRYPTION
 /**
- * Reset the configuration to the default values.
+ * Key data.
+ * Initialized with no keys.
  */
-void KeyManagerPrivate::reset(void)
+KeyManagerPrivate::Data::Data()
 {
-#ifdef ENABLE_DECRYPTION
-	// Clear the loaded keys.
-	vKeys.clear();
-	mapKeyNames.clear();
-	mapInvalidKeyNames.clear();
-
 	// Reserve 1 KB for the key store.
 	vKeys.reserve(1024);
 #ifdef HAVE_UNORDERED_MAP_RESERVE
@@ -138,7 +154,34 @@ void KeyManagerPrivate::reset(void)
 	// NOTE: Not reserving entries for invalid key names.
 	mapKeyNames.reserve(64);
 #endif
+}
+#endif /* ENABLE_DECRYPTION */
+
+/**
+ * Start loading a new configuration with the default values.
+ * NOTE: mtxLoad must be held.
+ */
+void KeyManagerPrivate::reset(void)
+{
+#ifdef ENABLE_DECRYPTION
+	data.reset();
+#else /* !ENABLE_DECRYPTION */
+	assert(!"Should not be called in no-decryption builds.");
+#endif /* ENABLE_DECRYPTION */
+}
+
+/**
+ * Publish the configuration that was loaded by processConfigLine().
+ * Readers will see the new configuration on their next access.
+ * NOTE: mtxLoad must be held.
+ * @param loaded True if the configuration was loaded; false to revert to the default values.
+ */
+void KeyManagerPrivate::publish(bool loaded)
+{
+#ifdef ENABLE_DECRYPTION
+	data.publish(loaded);
 #else /* !ENABLE_DECRYPTION */
+	RP_UNUSED(loaded);
 	assert(!"Should not be called in no-decryption builds.");
 #endif /* ENABLE_DECRYPTION */
 }
@@ -156,6 +199,7 @@ int KeyManagerPrivate::processConfigLine(const char *section, const char *name,
 {
 #ifdef ENABLE_DECRYPTION
 	// NOTE: Invalid lines are ignored, so we're always returning 1.
+	Data *const ld = data.loading();
 
 	// Are we in the "Keys" section?
 	if (!section || strcasecmp(section, "Keys") != 0) {
@@ -188,16 +232,16 @@ int KeyManagerPrivate::processConfigLine(const char *section, const char *name,
 	uint8_t len = static_cast<uint8_t>(value_len / 2);
 
 	// Parse the value.
-	const uint32_t vKeys_start_pos = static_cast<uint32_t>(vKeys.size());
+	const uint32_t vKeys_start_pos = static_cast<uint32_t>(ld->vKeys.size());
 	const uint32_t vKeys_pos = vKeys_start_pos;	// FIXME: Not needed?
 	if (len > 0) {
 		// Reserve space for half of the key string.
 		// Key string is ASCII hex, so two characters make up one byte.
-		vKeys.resize(vKeys.size() + len);
-		int ret = KeyManager::hexStringToBytes(value, &vKeys[vKeys_pos], len);
+		ld->vKeys.resize(ld->vKeys.size() + len);
+		int ret = KeyManager::hexStringToBytes(value, &ld->vKeys[vKeys_pos], len);
 		if (ret != 0) {
 			// Invalid character(s) encountered.
-			vKeys.resize(vKeys_start_pos);
+			ld->vKeys.resize(vKeys_start_pos);
 			return 1;
 		}
 	}
@@ -207,11 +251,11 @@ int KeyManagerPrivate::processConfigLine(const char *section, const char *name,
 		char buf[2];
 		buf[0] = value[value_len-1];
 		buf[1] = '0';
-		vKeys.resize(vKeys.size() + 2);
-		int ret = KeyManager::hexStringToBytes(buf, &vKeys[vKeys_pos+len], 1);
+		ld->vKeys.resize(ld->vKeys.size() + 2);
+		int ret = KeyManager::hexStringToBytes(buf, &ld->vKeys[vKeys_pos+len], 1);
 		if (ret != 0) {
 			// Invalid character(s) encountered.
-			vKeys.resize(vKeys_start_pos);
+			ld->vKeys.resize(vKeys_start_pos);
 			return 1;
 		}
 		// Add the extra byte.
@@ -221,7 +265,7 @@ int KeyManagerPrivate::processConfigLine(const char *section, const char *name,
 	// Value parsed successfully.
 	uint32_t keyIdx = vKeys_start_pos;
 	keyIdx |= (len << 24);
-	mapKeyNames.emplace(name, keyIdx);
+	ld->mapKeyNames.emplace(name, keyIdx);
 	return 1;
 #else /* !ENABLE_DECRYPTION */
 	RP_UNUSED(section);
@@ -315,11 +359,12 @@ KeyManager::VerifyResult KeyManager::get(const char *keyName, KeyData_t *pKeyDat
 
 	// Attempt to get the key from the map.
 	RP_D(const KeyManager);
-	auto iter = d->mapKeyNames.find(keyName);
-	if (iter == d->mapKeyNames.end()) {
+	const std::shared_ptr<const KeyManagerPrivate::Data> kd = d->data.get();
+	auto iter = kd->mapKeyNames.find(keyName);
+	if (iter == kd->mapKeyNames.end()) {
 		// Key was not parsed. Figure out why.
-		auto iter2 = d->mapInvalidKeyNames.find(keyName);
-		if (iter2 != d->mapInvalidKeyNames.end()) {
+		auto iter2 = kd->mapInvalidKeyNames.find(keyName);
+		if (iter2 != kd->mapInvalidKeyNames.end()) {
 			// An error occurred when parsing the key.
 			return iter2->second;
 		}
@@ -334,15 +379,16 @@ KeyManager::VerifyResult KeyManager::get(const char *keyName, KeyData_t *pKeyDat
 	const uint8_t len = ((keyIdx >> 24) & 0xFF);
 
 	// Make sure the key index is valid.
-	assert(idx + len <= d->vKeys.size());
-	if (idx + len > d->vKeys.size()) {
+	assert(idx + len <= kd->vKeys.size());
+	if (idx + len > kd->vKeys.size()) {
 		// Should not happen...
 		return VerifyResult::KeyDBError;
 	}
 
 	if (pKeyData) {
-		pKeyData->key = d->vKeys.data() + idx;
+		pKeyData->key = kd->vKeys.data() + idx;
 		pKeyData->length = len;
+		pKeyData->owner = kd;
 	}
 	return VerifyResult::OK;
 }
@@ -375,7 +421,7 @@ KeyManager::VerifyResult KeyManager::getAndVerify(const char *keyName, KeyData_t
 	}
 
 	// Temporary KeyData_t in case pKeyData is nullptr.
-	KeyData_t tmp_key_data = {nullptr, 0};
+	KeyData_t tmp_key_data = {};
 	if (!pKeyData) {
 		pKeyData = &tmp_key_data;
 	}
@@ -15,6 +15,9 @@
 // C includes (C++ namespace)
 #include <cstdint>
 
+// C++ includes
+#include <memory>
+
 namespace LibRpBase {
 
 class KeyManager : public ConfReader
@@ -67,6 +70,11 @@ public:
 public:
 	/**
 	 * Get the KeyManager instance.
+	 *
+	 * Thread safety: Same as Config. get() and getAndVerify() read
+	 * an immutable snapshot of keys.conf, and KeyData_t keeps its
+	 * snapshot alive if keys.conf is reloaded.
+	 *
 	 * @return KeyManager instance
 	 */
 	RP_LIBROMDATA_PUBLIC
@@ -77,10 +85,13 @@ public:
 	struct KeyData_t {
 		const uint8_t *key;	// Key data
 		size_t length;		// Key length
+		std::shared_ptr<const void> owner;	// Keeps key valid if keys.conf is reloaded
 	};
 
 	/**
 	 * Get an encryption key.
+	 * NOTE: The returned key data remains valid as long as pKeyData exists,
+	 * even if keys.conf is reloaded.
 	 * @param keyName	[in]  Encryption key name
 	 * @param pKeyData	[out,opt] Key data struct (If nullptr, key will be checked but not loaded.)
 	 * @return VerifyResult.
@@ -10,11 +10,12 @@
 
 #pragma once
 
+#include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
 #include "IDiscReader.hpp"
 
 namespace LibRpBase {
 
-class DiscReader final : public IDiscReader
+class RP_LIBROMDATA_PUBLIC DiscReader final : public IDiscReader
 {
 public:
 	/**
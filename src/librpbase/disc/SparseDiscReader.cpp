@@ -15,8 +15,13 @@ using namespace LibRpFile;
 
 // C includes (C++ namespace)
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 
+// C++ includes
+#include <algorithm>
+#include <system_error>
+
 namespace LibRpBase {
 
 /** SparseDiscReaderPrivate **/
@@ -26,6 +31,14 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, useBlockCache(false)
+	, blockCacheMaxBytes(DEFAULT_BLOCK_CACHE_SIZE)
+	, blockCacheHits(0)
+	, blockCacheMisses(0)
+	, decompThreads(0)
+	, parThreads(0)
+	, parJob(nullptr)
+	, parQuit(false)
 {
 	// NOTE: Can't check q->m_file here.
 
@@ -39,6 +52,331 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	cdromSectorInfo.subchannel_size = 0;
 }
 
+SparseDiscReaderPrivate::~SparseDiscReaderPrivate()
+{
+	stopWorkers();
+}
+
+/**
+ * Get a decompressed block, using the block cache if possible.
+ * If the block isn't cached, SparseDiscReader::readCompressedBlock()
+ * and SparseDiscReader::decompressBlock() are called.
+ * @param blockIdx	[in] Block index
+ * @return Pointer to the decompressed block (block_size bytes), or nullptr on error.
+ */
+const uint8_t *SparseDiscReaderPrivate::getCachedBlock(uint32_t blockIdx)
+{
+	auto iter = blockCacheMap.find(blockIdx);
+	if (iter != blockCacheMap.end()) {
+		// Block is cached. Move it to the front of the LRU list.
+		blockCacheHits++;
+		if (iter->second != blockCache.begin()) {
+			blockCache.splice(blockCache.begin(), blockCache, iter->second);
+		}
+		return blockCache.front().data.data();
+	}
+
+	// Block is not cached.
+	blockCacheMisses++;
+	trimBlockCache(1);
+
+	// Reuse the least recently used entry if we're at the size limit.
+	// Otherwise, allocate a new entry.
+	if (!blockCache.empty() &&
+	    (blockCache.size() + 1) * block_size > blockCacheMaxBytes)
+	{
+		blockCacheMap.erase(blockCache.back().blockIdx);
+		blockCache.splice(blockCache.begin(), blockCache, std::prev(blockCache.end()));
+	} else {
+		blockCache.emplace_front();
+		blockCache.front().data.resize(block_size);
+	}
+
+	BlockCacheEntry &entry = blockCache.front();
+	RP_Q(SparseDiscReader);
+	int ret = q->readCompressedBlock(blockIdx, zblock);
+	if (ret == 0) {
+		ret = q->decompressBlock(zblock, entry.data.data());
+		if (ret != 0) {
+			q->m_lastError = -ret;
+		}
+	}
+	if (ret != 0) {
+		// Error reading or decompressing the block.
+		// Move the entry to the back so it will be reused first.
+		blockCache.splice(blockCache.end(), blockCache, blockCache.begin());
+		blockCache.back().blockIdx = ~0U;
+		return nullptr;
+	}
+
+	entry.blockIdx = blockIdx;
+	blockCacheMap.emplace(blockIdx, blockCache.begin());
+	return entry.data.data();
+}
+
+/**
+ * Evict blocks until the block cache is within the size limit.
+ * At least one block is always kept.
+ * @param reserve Number of blocks to reserve space for
+ */
+void SparseDiscReaderPrivate::trimBlockCache(size_t reserve)
+{
+	while (blockCache.size() > 1 &&
+	       (blockCache.size() + reserve) * block_size > blockCacheMaxBytes)
+	{
+		BlockCacheEntry &entry = blockCache.back();
+		if (entry.blockIdx != ~0U) {
+			blockCacheMap.erase(entry.blockIdx);
+		}
+		blockCache.pop_back();
+	}
+}
+
+/**
+ * Get the number of threads to use for parallel decompression.
+ * @return Number of threads (1 if parallel decompression is disabled)
+ */
+unsigned int SparseDiscReaderPrivate::getDecompThreads(void) const
+{
+	if (!useBlockCache) {
+		// Blocks aren't compressed.
+		return 1;
+	} else if (decompThreads != 0) {
+		return decompThreads;
+	}
+
+	// Automatic: Use the number of CPUs, up to a maximum.
+	// NOTE: hardware_concurrency() may return 0 if unknown.
+	const unsigned int cpus = std::thread::hardware_concurrency();
+	return (cpus > 1) ? std::min(cpus, MAX_DECOMP_THREADS_AUTO) : 1;
+}
+
+/**
+ * Worker thread function for parallel decompression.
+ */
+void SparseDiscReaderPrivate::parallelWorker(void)
+{
+	RP_Q(SparseDiscReader);
+	std::unique_lock<std::mutex> lock(parMtx);
+	for (;;) {
+		parCv.wait(lock, [this]() {
+			return parQuit || (parJob && parJob->nextChunk < parJob->chunksRead);
+		});
+		if (parQuit) {
+			break;
+		}
+
+		ParallelJob &job = *parJob;
+		ParallelChunk &chunk = parChunks[job.nextChunk % job.slots];
+		job.nextChunk++;
+		lock.unlock();
+
+		const size_t blockSize = block_size;
+		uint32_t i;
+		int ret = 0;
+		for (i = 0; i < chunk.count; i++) {
+			const SparseDiscReader::CompressedBlock &zb = chunk.zblocks[i];
+			if (zb.blockIdx == ~0U) {
+				// Block was copied from the block cache.
+				continue;
+			}
+			ret = q->decompressBlock(zb, &job.pBuf[(chunk.first + i) * blockSize]);
+			if (ret != 0)
+				break;
+		}
+
+		lock.lock();
+		if (i < chunk.count && chunk.first + i < job.errBlock) {
+			job.errBlock = chunk.first + i;
+			job.err = ret;
+		}
+		chunk.busy = false;
+		job.chunksDone++;
+		parCv.notify_all();
+	}
+}
+
+/**
+ * Start the worker threads if they aren't running already.
+ * If the number of threads has changed, the workers are restarted.
+ * @param threads Number of worker threads
+ * @return True if at least one worker thread is running; false if not.
+ */
+bool SparseDiscReaderPrivate::startWorkers(unsigned int threads)
+{
+	if (parThreads == threads) {
+		// Workers were already started.
+		return !parWorkers.empty();
+	}
+
+	stopWorkers();
+	parThreads = threads;
+	parWorkers.reserve(threads);
+	try {
+		for (unsigned int i = 0; i < threads; i++) {
+			parWorkers.emplace_back(&SparseDiscReaderPrivate::parallelWorker, this);
+		}
+	} catch (const std::system_error&) {
+		// Unable to start a thread.
+		// If no threads were started, the caller will fall back to
+		// single-threaded decompression.
+	}
+	return !parWorkers.empty();
+}
+
+/**
+ * Stop the worker threads.
+ * Must not be called while a parallel read is in progress.
+ */
+void SparseDiscReaderPrivate::stopWorkers(void)
+{
+	assert(parJob == nullptr);
+	if (!parWorkers.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(parMtx);
+			parQuit = true;
+			parCv.notify_all();
+		}
+		for (std::thread &thread : parWorkers) {
+			thread.join();
+		}
+		parWorkers.clear();
+		parQuit = false;
+	}
+	parThreads = 0;
+}
+
+/**
+ * Read full blocks using parallel decompression.
+ *
+ * Compressed data is read on the calling thread, and blocks are
+ * decompressed directly into the output buffer by worker threads.
+ * Cached blocks are copied from the block cache. Newly-decompressed
+ * blocks are *not* added to the block cache.
+ *
+ * @param blockIdx	[in] First block index
+ * @param count		[in] Number of blocks
+ * @param pBuf		[out] Output buffer (must be count * block_size bytes)
+ * @param threads	[in] Number of worker threads
+ * @param blocksRead	[out] Number of blocks read successfully, starting at blockIdx
+ * @return 0 on success; negative POSIX error code on error.
+ *         (-EAGAIN if the read is too small or no threads could be started)
+ */
+int SparseDiscReaderPrivate::readBlocksParallel(uint32_t blockIdx, uint32_t count, uint8_t *pBuf,
+	unsigned int threads, uint32_t &blocksRead)
+{
+	assert(useBlockCache);
+	assert(threads > 1);
+	assert(count > 0);
+	blocksRead = 0;
+
+	// Blocks are grouped into chunks to reduce synchronization overhead.
+	const uint32_t blocksPerChunk = std::max(1U,
+		static_cast<unsigned int>(PARALLEL_CHUNK_SIZE / block_size));
+	const uint32_t chunkCount = (count + blocksPerChunk - 1) / blocksPerChunk;
+	if (chunkCount < 2) {
+		// Only one chunk. Decompressing it on a worker thread
+		// wouldn't be any faster than doing it on this thread.
+		return -EAGAIN;
+	}
+	if (!startWorkers(threads)) {
+		// No worker threads.
+		return -EAGAIN;
+	}
+
+	// Twice as many chunk slots as threads are allocated so the calling
+	// thread can read ahead while the worker threads are decompressing.
+	const unsigned int slots = std::min(static_cast<unsigned int>(parWorkers.size()) * 2, chunkCount);
+	if (parChunks.size() < slots) {
+		parChunks.resize(slots);
+	}
+	for (ParallelChunk &chunk : parChunks) {
+		if (chunk.zblocks.size() < blocksPerChunk) {
+			chunk.zblocks.resize(blocksPerChunk);
+		}
+		chunk.busy = false;
+	}
+
+	ParallelJob job;
+	job.pBuf = pBuf;
+	job.slots = slots;
+	job.chunksRead = 0;
+	job.nextChunk = 0;
+	job.chunksDone = 0;
+	job.errBlock = count;
+	job.err = 0;
+	{
+		std::lock_guard<std::mutex> lock(parMtx);
+		parJob = &job;
+	}
+
+	// Read the compressed data on this thread.
+	RP_Q(SparseDiscReader);
+	const size_t blockSize = block_size;
+	for (uint32_t c = 0; c < chunkCount; c++) {
+		ParallelChunk &chunk = parChunks[c % slots];
+		{
+			// Wait for the chunk slot to be available.
+			std::unique_lock<std::mutex> lock(parMtx);
+			parCv.wait(lock, [&chunk]() { return !chunk.busy; });
+			if (job.errBlock < count) {
+				// A block failed to decompress.
+				break;
+			}
+		}
+
+		chunk.first = c * blocksPerChunk;
+		chunk.count = std::min(blocksPerChunk, count - chunk.first);
+
+		uint32_t i;
+		int ret = 0;
+		for (i = 0; i < chunk.count; i++) {
+			const uint32_t curBlockIdx = blockIdx + chunk.first + i;
+			SparseDiscReader::CompressedBlock &zb = chunk.zblocks[i];
+
+			auto iter = blockCacheMap.find(curBlockIdx);
+			if (iter != blockCacheMap.end()) {
+				// Block is cached.
+				blockCacheHits++;
+				memcpy(&pBuf[(chunk.first + i) * blockSize], iter->second->data.data(), blockSize);
+				zb.blockIdx = ~0U;
+				continue;
+			}
+
+			blockCacheMisses++;
+			ret = q->readCompressedBlock(curBlockIdx, zb);
+			if (ret != 0)
+				break;
+		}
+
+		std::lock_guard<std::mutex> lock(parMtx);
+		if (i < chunk.count) {
+			// Read error. Decompress the blocks that were read successfully.
+			if (chunk.first + i < job.errBlock) {
+				job.errBlock = chunk.first + i;
+				job.err = ret;
+			}
+			chunk.count = i;
+		}
+		chunk.busy = true;
+		job.chunksRead++;
+		parCv.notify_all();
+		if (job.errBlock < count)
+			break;
+	}
+
+	// Wait for the worker threads to finish decompressing.
+	// NOTE: The workers are left running for the next read.
+	{
+		std::unique_lock<std::mutex> lock(parMtx);
+		parCv.wait(lock, [&job]() { return job.chunksDone == job.chunksRead; });
+		parJob = nullptr;
+	}
+
+	blocksRead = job.errBlock;
+	return job.err;
+}
+
 /** SparseDiscReader **/
 
 SparseDiscReader::SparseDiscReader(SparseDiscReaderPrivate *d, const IRpFilePtr &file)
@@ -113,6 +451,32 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 	}
 
 	// Read entire blocks.
+	if (size >= d->PARALLEL_MIN_SIZE && size >= block_size * 2) {
+		// Large read. Use parallel decompression if possible.
+		const unsigned int threads = d->getDecompThreads();
+		if (threads > 1) {
+			const size_t count64 = size / block_size;
+			const uint32_t count = (count64 > UINT32_MAX)
+				? UINT32_MAX : static_cast<uint32_t>(count64);
+			const uint32_t blockIdx = static_cast<uint32_t>(d->pos / block_size);
+
+			uint32_t blocksRead = 0;
+			int pret = d->readBlocksParallel(blockIdx, count, ptr8, threads, blocksRead);
+			if (pret != -EAGAIN) {
+				const size_t sz_read = static_cast<size_t>(blocksRead) * block_size;
+				size -= sz_read;
+				ptr8 += sz_read;
+				ret += sz_read;
+				d->pos += sz_read;
+				if (pret != 0) {
+					// Error reading the data.
+					m_lastError = -pret;
+					return ret;
+				}
+			}
+		}
+	}
+
 	for (; size >= block_size;
 	    size -= block_size, ptr8 += block_size,
 	    ret += block_size, d->pos += block_size)
@@ -230,6 +594,65 @@ const CdromSectorInfo *SparseDiscReader::cdromSectorInfo(void) const
 	return (d->hasCdromInfo) ? &d->cdromSectorInfo : nullptr;
 }
 
+// Decompressed block cache
+
+/**
+ * Set the maximum size of the decompressed block cache.
+ * At least one block is always cached, regardless of this setting.
+ * This has no effect on subclasses that don't decompress blocks.
+ * @param size Maximum size, in bytes
+ */
+void SparseDiscReader::setBlockCacheSize(size_t size)
+{
+	RP_D(SparseDiscReader);
+	d->blockCacheMaxBytes = size;
+	d->trimBlockCache();
+}
+
+/**
+ * Get decompressed block cache statistics.
+ * @return Block cache statistics
+ */
+SparseDiscReader::BlockCacheStats SparseDiscReader::blockCacheStats(void) const
+{
+	RP_D(const SparseDiscReader);
+	BlockCacheStats stats;
+	stats.hits = d->blockCacheHits;
+	stats.misses = d->blockCacheMisses;
+	stats.size = d->blockCache.size() * d->block_size;
+	stats.maxSize = d->blockCacheMaxBytes;
+	return stats;
+}
+
+// Parallel decompression
+
+/**
+ * Set the number of threads to use for parallel decompression.
+ *
+ * Large reads that span multiple compressed blocks will read the
+ * compressed data on the calling thread, and decompress the blocks
+ * using a pool of worker threads.
+ *
+ * This has no effect on subclasses that don't decompress blocks.
+ *
+ * @param threads Number of threads (0 for automatic; 1 to disable parallel decompression)
+ */
+void SparseDiscReader::setDecompressionThreads(unsigned int threads)
+{
+	RP_D(SparseDiscReader);
+	d->decompThreads = threads;
+}
+
+/**
+ * Get the number of threads to use for parallel decompression.
+ * @return Number of threads (1 if parallel decompression is disabled)
+ */
+unsigned int SparseDiscReader::decompressionThreads(void) const
+{
+	RP_D(const SparseDiscReader);
+	return d->getDecompThreads();
+}
+
 /** SparseDiscReader **/
 
 /**
@@ -264,6 +687,20 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t si
 		return 0;
 	}
 
+	if (d->useBlockCache) {
+		// Compressed blocks. Use the block cache.
+		const uint8_t *const pBlock = d->getCachedBlock(blockIdx);
+		if (!pBlock) {
+			// Error decompressing the block.
+			if (m_lastError == 0) {
+				m_lastError = EIO;
+			}
+			return 0;
+		}
+		memcpy(ptr, &pBlock[pos], size);
+		return static_cast<int>(size);
+	}
+
 	// Get the physical address first.
 	const off64_t physBlockAddr = getPhysBlockAddr(blockIdx);
 	assert(physBlockAddr >= 0);
@@ -284,4 +721,48 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t si
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read the compressed data for the specified block.
+ *
+ * Subclasses that use compressed blocks should implement this and
+ * decompressBlock(), and set d->useBlockCache in their constructors.
+ * The default readBlock() implementation will then call these
+ * functions if the block isn't in the block cache.
+ *
+ * This function is always called on the thread that called read().
+ *
+ * @param blockIdx	[in] Block index
+ * @param zblock	[out] Compressed block data
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int SparseDiscReader::readCompressedBlock(uint32_t blockIdx, CompressedBlock &zblock)
+{
+	// Not implemented by default.
+	RP_UNUSED(blockIdx);
+	RP_UNUSED(zblock);
+	assert(!"readCompressedBlock() is not implemented by this subclass.");
+	m_lastError = ENOTSUP;
+	return -ENOTSUP;
+}
+
+/**
+ * Decompress a block that was read by readCompressedBlock().
+ *
+ * NOTE: This function may be called from multiple worker threads
+ * at the same time, so it must not modify the object or access
+ * the underlying file.
+ *
+ * @param zblock	[in] Compressed block data
+ * @param pBuf		[out] Output buffer (must be block_size bytes)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int SparseDiscReader::decompressBlock(const CompressedBlock &zblock, uint8_t *pBuf) const
+{
+	// Not implemented by default.
+	RP_UNUSED(zblock);
+	RP_UNUSED(pBuf);
+	assert(!"decompressBlock() is not implemented by this subclass.");
+	return -ENOTSUP;
+}
+
 }
@@ -11,6 +11,10 @@
 
 #include "IDiscReader.hpp"
 #include "cdrom_structs.h"
+#include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
+
+// Uninitialized vector class
+#include "uvector.h"
 
 namespace LibRpBase {
 
@@ -73,6 +77,54 @@ public:
 	 */
 	const CdromSectorInfo *cdromSectorInfo(void) const;
 
+	// Decompressed block cache
+
+	/**
+	 * Set the maximum size of the decompressed block cache.
+	 * At least one block is always cached, regardless of this setting.
+	 * This has no effect on subclasses that don't decompress blocks.
+	 * @param size Maximum size, in bytes
+	 */
+	RP_LIBROMDATA_PUBLIC
+	void setBlockCacheSize(size_t size);
+
+	struct BlockCacheStats {
+		uint64_t hits;		// Number of block cache hits
+		uint64_t misses;	// Number of block cache misses (blocks decompressed)
+		size_t size;		// Current size of the block cache, in bytes
+		size_t maxSize;		// Maximum size of the block cache, in bytes
+	};
+
+	/**
+	 * Get decompressed block cache statistics.
+	 * @return Block cache statistics
+	 */
+	RP_LIBROMDATA_PUBLIC
+	BlockCacheStats blockCacheStats(void) const;
+
+	// Parallel decompression
+
+	/**
+	 * Set the number of threads to use for parallel decompression.
+	 *
+	 * Large reads that span multiple compressed blocks will read the
+	 * compressed data on the calling thread, and decompress the blocks
+	 * using a pool of worker threads.
+	 *
+	 * This has no effect on subclasses that don't decompress blocks.
+	 *
+	 * @param threads Number of threads (0 for automatic; 1 to disable parallel decompression)
+	 */
+	RP_LIBROMDATA_PUBLIC
+	void setDecompressionThreads(unsigned int threads);
+
+	/**
+	 * Get the number of threads to use for parallel decompression.
+	 * @return Number of threads (1 if parallel decompression is disabled)
+	 */
+	RP_LIBROMDATA_PUBLIC
+	unsigned int decompressionThreads(void) const;
+
 protected:
 	/** Virtual functions for SparseDiscReader subclasses **/
 
@@ -107,6 +159,51 @@ protected:
 	 */
 	ATTR_ACCESS_SIZE(write_only, 4, 5)
 	virtual int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size);
+
+	/**
+	 * Compressed block data, as read by readCompressedBlock().
+	 */
+	struct CompressedBlock {
+		uint32_t blockIdx;		// Block index (~0U if unused)
+		int z_mode;			// Compression mode (subclass-specific)
+		int z_param;			// Compression parameter (subclass-specific)
+		rp::uvector<uint8_t> data;	// Compressed data
+
+		CompressedBlock()
+			: blockIdx(~0U)
+			, z_mode(0)
+			, z_param(0)
+		{}
+	};
+
+	/**
+	 * Read the compressed data for the specified block.
+	 *
+	 * Subclasses that use compressed blocks should implement this and
+	 * decompressBlock(), and set d->useBlockCache in their constructors.
+	 * The default readBlock() implementation will then call these
+	 * functions if the block isn't in the block cache.
+	 *
+	 * This function is always called on the thread that called read().
+	 *
+	 * @param blockIdx	[in] Block index
+	 * @param zblock	[out] Compressed block data
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	virtual int readCompressedBlock(uint32_t blockIdx, CompressedBlock &zblock);
+
+	/**
+	 * Decompress a block that was read by readCompressedBlock().
+	 *
+	 * NOTE: This function may be called from multiple worker threads
+	 * at the same time, so it must not modify the object or access
+	 * the underlying file.
+	 *
+	 * @param zblock	[in] Compressed block data
+	 * @param pBuf		[out] Output buffer (must be block_size bytes)
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	virtual int decompressBlock(const CompressedBlock &zblock, uint8_t *pBuf) const;
 };
 
 }
@@ -12,6 +12,7 @@
 
 #include "common.h"
 #include "cdrom_structs.h"
+#include "SparseDiscReader.hpp"
 
 // Other rom-properties libraries [for convenience for SparseDiscReader subclasses]
 #include "bitstuff.h"
@@ -27,6 +28,17 @@
 // C++ includes [for convenience for SparseDiscReader subclasses]
 #include <array>
 
+// C++ includes
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Uninitialized vector class
+#include "uvector.h"
+
 namespace LibRpBase {
 
 class SparseDiscReader;
@@ -35,7 +47,7 @@ class SparseDiscReaderPrivate
 protected:
 	explicit SparseDiscReaderPrivate(SparseDiscReader *q);
 public:
-	virtual ~SparseDiscReaderPrivate() = default;
+	virtual ~SparseDiscReaderPrivate();
 
 protected:
 	friend class SparseDiscReader;
@@ -51,6 +63,136 @@ public:
 	// CD-ROM specific information
 	bool hasCdromInfo;
 	CdromSectorInfo cdromSectorInfo;
+
+public:
+	/** Decompressed block cache **/
+
+	// Default block cache size, in bytes.
+	static constexpr size_t DEFAULT_BLOCK_CACHE_SIZE = 1024U * 1024U;
+
+	// Set to true by subclasses that implement readCompressedBlock()
+	// and decompressBlock().
+	// If false, the block cache is not used.
+	bool useBlockCache;
+
+	struct BlockCacheEntry {
+		uint32_t blockIdx;
+		rp::uvector<uint8_t> data;	// Decompressed block (block_size bytes)
+	};
+
+	// LRU list. Most recently used block is at the front.
+	typedef std::list<BlockCacheEntry> BlockCacheList;
+	BlockCacheList blockCache;
+	std::unordered_map<uint32_t, BlockCacheList::iterator> blockCacheMap;
+
+	size_t blockCacheMaxBytes;	// Maximum size of the block cache, in bytes
+	uint64_t blockCacheHits;	// Number of block cache hits
+	uint64_t blockCacheMisses;	// Number of block cache misses
+
+	// Compressed data for getCachedBlock()
+	SparseDiscReader::CompressedBlock zblock;
+
+	/**
+	 * Get a decompressed block, using the block cache if possible.
+	 * If the block isn't cached, SparseDiscReader::readCompressedBlock()
+	 * and SparseDiscReader::decompressBlock() are called.
+	 * @param blockIdx	[in] Block index
+	 * @return Pointer to the decompressed block (block_size bytes), or nullptr on error.
+	 */
+	const uint8_t *getCachedBlock(uint32_t blockIdx);
+
+	/**
+	 * Evict blocks until the block cache is within the size limit.
+	 * At least one block is always kept.
+	 * @param reserve Number of blocks to reserve space for
+	 */
+	void trimBlockCache(size_t reserve = 0);
+
+public:
+	/** Parallel decompression **/
+
+	// Maximum number of threads to use if decompThreads == 0.
+	static constexpr unsigned int MAX_DECOMP_THREADS_AUTO = 4;
+	// Minimum read size for parallel decompression, in bytes.
+	static constexpr size_t PARALLEL_MIN_SIZE = 128U * 1024U;
+	// Amount of data decompressed by a worker thread at once, in bytes.
+	static constexpr size_t PARALLEL_CHUNK_SIZE = 64U * 1024U;
+
+	unsigned int decompThreads;	// Number of threads (0 == automatic)
+
+	/**
+	 * Get the number of threads to use for parallel decompression.
+	 * @return Number of threads (1 if parallel decompression is disabled)
+	 */
+	unsigned int getDecompThreads(void) const;
+
+	// Chunk of blocks for parallel decompression.
+	struct ParallelChunk {
+		std::vector<SparseDiscReader::CompressedBlock> zblocks;
+		uint32_t first;	// First block, relative to the start of the read
+		uint32_t count;	// Number of blocks in this chunk
+		bool busy;	// True if this chunk is waiting to be decompressed
+	};
+	// Chunk slots. (Reused between reads to reduce allocations.)
+	std::vector<ParallelChunk> parChunks;
+
+	// State for the current parallel read. (protected by parMtx)
+	struct ParallelJob {
+		uint8_t *pBuf;		// Output buffer
+		unsigned int slots;	// Number of chunk slots in use
+		uint32_t chunksRead;	// Number of chunks read by the calling thread
+		uint32_t nextChunk;	// Next chunk to decompress
+		uint32_t chunksDone;	// Number of chunks decompressed
+		uint32_t errBlock;	// First block that failed (relative to the start of the read)
+		int err;		// Error code for errBlock
+	};
+
+	// Worker thread pool. The threads are started on the first
+	// parallel read and reused for subsequent reads.
+	std::vector<std::thread> parWorkers;
+	unsigned int parThreads;	// Number of threads requested for parWorkers
+	std::mutex parMtx;
+	std::condition_variable parCv;
+	ParallelJob *parJob;		// Current parallel read, or nullptr if idle
+	bool parQuit;			// Set to stop the worker threads
+
+	/**
+	 * Worker thread function for parallel decompression.
+	 */
+	void parallelWorker(void);
+
+	/**
+	 * Start the worker threads if they aren't running already.
+	 * If the number of threads has changed, the workers are restarted.
+	 * @param threads Number of worker threads
+	 * @return True if at least one worker thread is running; false if not.
+	 */
+	bool startWorkers(unsigned int threads);
+
+	/**
+	 * Stop the worker threads.
+	 * Must not be called while a parallel read is in progress.
+	 */
+	void stopWorkers(void);
+
+	/**
+	 * Read full blocks using parallel decompression.
+	 *
+	 * Compressed data is read on the calling thread, and blocks are
+	 * decompressed directly into the output buffer by worker threads.
+	 * Cached blocks are copied from the block cache. Newly-decompressed
+	 * blocks are *not* added to the block cache.
+	 *
+	 * @param blockIdx	[in] First block index
+	 * @param count		[in] Number of blocks
+	 * @param pBuf		[out] Output buffer (must be count * block_size bytes)
+	 * @param threads	[in] Number of worker threads
+	 * @param blocksRead	[out] Number of blocks read successfully, starting at blockIdx
+	 * @return 0 on success; negative POSIX error code on error.
+	 *         (-EAGAIN if the read is too small or no threads could be started)
+	 */
+	int readBlocksParallel(uint32_t blockIdx, uint32_t count, uint8_t *pBuf,
+		unsigned int threads, uint32_t &blocksRead);
 };
 
 }
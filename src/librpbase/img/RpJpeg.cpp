@@ -606,8 +606,8 @@ rp_image_ptr load(IRpFile *file)
 
 		// Set the sBIT metadata.
 		if (cinfo.out_color_space == JCS_GRAYSCALE) {
-			// NOTE: Setting the grayscale value, though we're
-			// not saving grayscale PNGs at the moment.
+			// NOTE: Setting the grayscale value so
+			// RpPngWriter will save a grayscale PNG.
 			static const rp_image::sBIT_t sBIT = {8,8,8,8,0};
 			img->set_sBIT(sBIT);
 		} else {
@@ -155,6 +155,10 @@ public:
 
 	// Current state
 	bool IHDR_written;
+	bool write_gray;	// Writing an ARGB32 image as grayscale
+
+	// PNG encoder profile
+	Config::PngEncodeProfile encodeProfile;
 
 	// Open file reference
 	IRpFilePtr file;
@@ -260,6 +264,13 @@ public:
 	// Close the PNG image.
 	void close(void);
 
+	/**
+	 * Set the zlib compression and PNG filter parameters
+	 * for the selected encoder profile.
+	 * @param color_type PNG color type
+	 */
+	void set_compression_params(int color_type);
+
 public:
 	/** I/O functions **/
 
@@ -329,7 +340,8 @@ public:
 
 RpPngWriterPrivate::RpPngWriterPrivate(const IRpFilePtr &theFile, int width, int height, rp_image::Format format)
 	: lastError(0)
-	, imageTag(ImageTag::Invalid), IHDR_written(false)
+	, imageTag(ImageTag::Invalid), IHDR_written(false), write_gray(false)
+	, encodeProfile(Config::PngEncodeProfile::Balanced)
 	, file(theFile), png_ptr(nullptr), info_ptr(nullptr)
 {
 	if (!file || !file->isOpen() || width <= 0 || height <= 0 ||
@@ -398,7 +410,8 @@ RpPngWriterPrivate::RpPngWriterPrivate(const IRpFilePtr &theFile, int width, int
 
 RpPngWriterPrivate::RpPngWriterPrivate(const IRpFilePtr &theFile, const rp_image_const_ptr &img)
 	: lastError(0)
-	, imageTag(ImageTag::Invalid), IHDR_written(false)
+	, imageTag(ImageTag::Invalid), IHDR_written(false), write_gray(false)
+	, encodeProfile(Config::PngEncodeProfile::Balanced)
 	, file(theFile), png_ptr(nullptr), info_ptr(nullptr)
 {
 	if (!file || !file->isOpen() || !img || !img->isValid()) {
@@ -459,7 +472,8 @@ RpPngWriterPrivate::RpPngWriterPrivate(const IRpFilePtr &theFile, const rp_image
 
 RpPngWriterPrivate::RpPngWriterPrivate(const IRpFilePtr &theFile, const IconAnimDataConstPtr &iconAnimData)
 	: lastError(0)
-	, imageTag(ImageTag::Invalid), IHDR_written(false)
+	, imageTag(ImageTag::Invalid), IHDR_written(false), write_gray(false)
+	, encodeProfile(Config::PngEncodeProfile::Balanced)
 	, file(theFile), png_ptr(nullptr), info_ptr(nullptr)
 {
 	if (!file || !file->isOpen() || !iconAnimData || iconAnimData->seq_count <= 0) {
@@ -602,6 +616,45 @@ void RpPngWriterPrivate::close(void)
 	}
 }
 
+/**
+ * Set the zlib compression and PNG filter parameters
+ * for the selected encoder profile.
+ * @param color_type PNG color type
+ */
+void RpPngWriterPrivate::set_compression_params(int color_type)
+{
+	// NOTE: Filtering usually doesn't help with paletted images.
+	const bool is_palette = (color_type == PNG_COLOR_TYPE_PALETTE);
+
+	switch (encodeProfile) {
+		case Config::PngEncodeProfile::Fastest:
+			// zlib level 1. With stock zlib, use the RLE strategy,
+			// which is faster than level 1 and usually compresses
+			// better with the Sub filter. zlib-ng's level 1 is
+			// already a dedicated fast deflate implementation.
+			png_set_filter(png_ptr, 0, (is_palette ? PNG_FILTER_NONE : PNG_FILTER_SUB));
+			png_set_compression_level(png_ptr, 1);
+#if defined(Z_RLE) && !defined(ZLIBNG_VERSION)
+			png_set_compression_strategy(png_ptr, Z_RLE);
+#endif /* defined(Z_RLE) && !defined(ZLIBNG_VERSION) */
+			break;
+
+		case Config::PngEncodeProfile::Balanced:
+		default:
+			// zlib default compression level with no filtering.
+			png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
+			png_set_compression_level(png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+			break;
+
+		case Config::PngEncodeProfile::Smallest:
+			// zlib level 9 with adaptive filtering.
+			png_set_filter(png_ptr, 0, (is_palette ? PNG_FILTER_NONE : PNG_ALL_FILTERS));
+			png_set_compression_level(png_ptr, 9);
+			png_set_compression_mem_level(png_ptr, 9);
+			break;
+	}
+}
+
 /**
  * libpng I/O write handler for IRpFile.
  * @param png_ptr	[in] PNG pointer.
@@ -715,6 +768,13 @@ int RpPngWriterPrivate::write_IDAT(const png_byte *const *row_pointers, bool is_
 		return -lastError;
 	}
 
+	// Grayscale row buffer.
+	// NOTE: Must be allocated before setjmp().
+	unique_ptr<png_byte[]> gray_row;
+	if (write_gray) {
+		gray_row.reset(new png_byte[cache.width * (cache.skip_alpha ? 1 : 2)]);
+	}
+
 #ifdef PNG_SETJMP_SUPPORTED
 	// WARNING: Do NOT initialize any C++ objects past this point!
 	if (setjmp(png_jmpbuf(png_ptr))) {
@@ -723,6 +783,29 @@ int RpPngWriterPrivate::write_IDAT(const png_byte *const *row_pointers, bool is_
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
 
+	if (write_gray) {
+		// Convert each row to grayscale.
+		// sBIT indicates that R == G == B, so the green channel is used.
+		// NOTE: Green is in the same position for ARGB and ABGR.
+		const int width = cache.width;
+		for (int y = 0; y < cache.height; y++) {
+			const uint32_t *src = reinterpret_cast<const uint32_t*>(row_pointers[y]);
+			png_byte *dest = gray_row.get();
+			if (cache.skip_alpha) {
+				for (int x = width; x > 0; x--, src++, dest++) {
+					*dest = static_cast<png_byte>(*src >> 8);
+				}
+			} else {
+				for (int x = width; x > 0; x--, src++, dest += 2) {
+					dest[0] = static_cast<png_byte>(*src >> 8);
+					dest[1] = static_cast<png_byte>(*src >> 24);
+				}
+			}
+			png_write_row(png_ptr, gray_row.get());
+		}
+		return 0;
+	}
+
 #if SYS_BYTEORDER == SYS_LIL_ENDIAN
 	if (!is_abgr) {
 		png_set_bgr(png_ptr);
@@ -1151,9 +1234,46 @@ void RpPngWriter::close(void)
 	d->close();
 }
 
+/**
+ * Set the PNG encoder profile.
+ * This must be called before write_IHDR().
+ *
+ * The default profile is Balanced, which uses zlib's
+ * default compression level with no filtering.
+ *
+ * @param profile PNG encoder profile
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriter::setEncodeProfile(Config::PngEncodeProfile profile)
+{
+	RP_D(RpPngWriter);
+	assert(profile >= Config::PngEncodeProfile::Fastest);
+	assert(profile <  Config::PngEncodeProfile::Max);
+	if (profile < Config::PngEncodeProfile::Fastest ||
+	    profile >= Config::PngEncodeProfile::Max)
+	{
+		// Invalid profile.
+		return -EINVAL;
+	}
+
+	assert(!d->IHDR_written);
+	if (unlikely(d->IHDR_written)) {
+		// IHDR has already been written.
+		d->lastError = EEXIST;
+		return -EEXIST;
+	}
+
+	d->encodeProfile = profile;
+	return 0;
+}
+
 /**
  * Write the PNG IHDR.
  * This must be called before writing any other image data.
+ *
+ * ARGB32 images with an sBIT gray value will be written
+ * as grayscale if they aren't animated.
+ *
  * @return 0 on success; negative POSIX error code on error.
  */
 int RpPngWriter::write_IHDR(void)
@@ -1192,21 +1312,25 @@ int RpPngWriter::write_IHDR(void)
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
 
-	// Initialize compression parameters.
-	// TODO: Customizable?
-	png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
-	png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
-
 	// Write the PNG header.
 	switch (d->cache.format) {
 		case rp_image::Format::ARGB32: {
-			// TODO: Use PNG_COLOR_TYPE_GRAY and/or PNG_COLOR_TYPE_GRAY_ALPHA
-			// if sBIT.gray > 0?
 #ifdef PNG_sBIT_SUPPORTED
-			const int color_type = (d->cache.skip_alpha ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA);
+			// If sBIT has a gray value, the image is grayscale.
+			// NOTE: Not supported for APNG, since png_write_image()
+			// is used for each frame.
+			d->write_gray = (d->cache.has_sBIT && d->cache.sBIT.gray > 0 &&
+				d->imageTag != RpPngWriterPrivate::ImageTag::IconAnimData);
+			int color_type;
+			if (d->write_gray) {
+				color_type = (d->cache.skip_alpha ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_GRAY_ALPHA);
+			} else {
+				color_type = (d->cache.skip_alpha ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA);
+			}
 #else /* !PNG_sBIT_SUPPORTED */
 			static constexpr int color_type = PNG_COLOR_TYPE_RGB_ALPHA;
 #endif /* PNG_sBIT_SUPPORTED */
+			d->set_compression_params(color_type);
 			png_set_IHDR(d->png_ptr, d->info_ptr,
 					d->cache.width, d->cache.height, 8,
 					color_type,
@@ -1217,6 +1341,7 @@ int RpPngWriter::write_IHDR(void)
 		}
 
 		case rp_image::Format::CI8:
+			d->set_compression_params(PNG_COLOR_TYPE_PALETTE);
 			png_set_IHDR(d->png_ptr, d->info_ptr,
 					d->cache.width, d->cache.height, 8,
 					PNG_COLOR_TYPE_PALETTE,
@@ -12,6 +12,7 @@
 #include "dll-macros.h"	// for RP_LIBROMDATA_PUBLIC
 
 // Other rom-properties libraries
+#include "../config/Config.hpp"
 #include "../img/IconAnimData.hpp"
 #include "librpfile/IRpFile.hpp"
 #include "librptexture/img/rp_image.hpp"
@@ -235,9 +236,25 @@ public:
 	 */
 	void close(void);
 
+	/**
+	 * Set the PNG encoder profile.
+	 * This must be called before write_IHDR().
+	 *
+	 * The default profile is Balanced, which uses zlib's
+	 * default compression level with no filtering.
+	 *
+	 * @param profile PNG encoder profile
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int setEncodeProfile(Config::PngEncodeProfile profile);
+
 	/**
 	 * Write the PNG IHDR.
 	 * This must be called before writing any other image data.
+	 *
+	 * ARGB32 images with an sBIT gray value will be written
+	 * as grayscale if they aren't animated.
+	 *
 	 * @return 0 on success; negative POSIX error code on error.
 	 */
 	int write_IHDR(void);
@@ -0,0 +1,330 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * AesCipherCompareTest.cpp: Compare hardware AES against the default      *
+ * AesCipher implementation.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// AesCipher
+#include "../crypto/IAesCipher.hpp"
+#include "../crypto/AesCipherFactory.hpp"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+using std::array;
+using std::string;
+using std::unique_ptr;
+
+// libfmt
+#include "rp-libfmt.h"
+
+// Uninitialized vector class
+#include "uvector.h"
+
+// Hardware AES implementation
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+#  define AES_HW_IMPLEMENTATION AesNI
+#elif defined(RP_CPU_ARM64)
+#  define AES_HW_IMPLEMENTATION ArmCE
+#endif
+
+// Reference AES implementation
+#if defined(_WIN32)
+#  define AES_REF_IMPLEMENTATION CAPI
+#elif defined(HAVE_NETTLE)
+#  define AES_REF_IMPLEMENTATION Nettle
+#endif
+
+#if defined(AES_HW_IMPLEMENTATION) && defined(AES_REF_IMPLEMENTATION)
+
+namespace LibRpBase { namespace Tests {
+
+struct AesCipherCompareTest_mode
+{
+	IAesCipher::ChainingMode chainingMode;
+	size_t key_len;
+
+	AesCipherCompareTest_mode(IAesCipher::ChainingMode chainingMode, size_t key_len)
+		: chainingMode(chainingMode)
+		, key_len(key_len)
+	{ }
+};
+
+/**
+ * Get a chaining mode name.
+ * @param chainingMode Chaining mode
+ * @return Chaining mode name
+ */
+static const char *chainingModeName(IAesCipher::ChainingMode chainingMode)
+{
+	switch (chainingMode) {
+		case IAesCipher::ChainingMode::ECB:
+			return "ECB";
+		case IAesCipher::ChainingMode::CBC:
+			return "CBC";
+		case IAesCipher::ChainingMode::CTR:
+			return "CTR";
+		default:
+			return "UNK";
+	}
+}
+
+/**
+ * Formatting function for AesCipherCompareTest_mode.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const AesCipherCompareTest_mode& mode)
+{
+	return os << "AES-" << (mode.key_len * 8) << "-" << chainingModeName(mode.chainingMode);
+};
+
+class AesCipherCompareTest : public ::testing::TestWithParam<AesCipherCompareTest_mode>
+{
+protected:
+	void SetUp(void) final;
+
+public:
+	// Ciphers
+	unique_ptr<IAesCipher> m_hw;	// Hardware implementation
+	unique_ptr<IAesCipher> m_ref;	// Reference implementation
+
+	// Key, IV/counter, and cipher text
+	array<uint8_t, 32> m_key;
+	array<uint8_t, 16> m_iv;
+	rp::uvector<uint8_t> m_cipherText;
+
+	// Buffer size: One Wii disc sector's worth of data, plus
+	// three extra blocks so the single-block tail is tested.
+	static constexpr size_t BUF_SIZE = 0x7C00 + (3 * 16);
+
+	// Number of iterations for benchmarks.
+	static constexpr unsigned int BENCHMARK_ITERATIONS = 10000U;
+
+	/**
+	 * Initialize a cipher with the current test parameters.
+	 * @param cipher	[in] Cipher
+	 * @param iv		[in] IV/counter
+	 */
+	void initCipher(IAesCipher *cipher, const array<uint8_t, 16> &iv);
+
+	/**
+	 * Decrypt the cipher text using both implementations and compare the results.
+	 * @param iv		[in] IV/counter
+	 * @param chunk_sizes	[in] Chunk sizes, in 16-byte blocks (0-terminated; nullptr for the whole buffer)
+	 */
+	void compareTest(const array<uint8_t, 16> &iv, const unsigned int *chunk_sizes);
+
+	/**
+	 * Run a decryption benchmark.
+	 * @param cipher	[in] Cipher
+	 */
+	void decryptBenchmark(IAesCipher *cipher);
+
+public:
+	/**
+	 * Test case suffix generator.
+	 * @param info Test parameter information.
+	 * @return Test case suffix.
+	 */
+	static string test_case_suffix_generator(const ::testing::TestParamInfo<AesCipherCompareTest_mode> &info);
+};
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string AesCipherCompareTest::test_case_suffix_generator(const ::testing::TestParamInfo<AesCipherCompareTest_mode> &info)
+{
+	return fmt::format(FSTR("AES_{:d}_{:s}"), (info.param.key_len * 8), chainingModeName(info.param.chainingMode));
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void AesCipherCompareTest::SetUp(void)
+{
+	m_ref.reset(AesCipherFactory::create(AesCipherFactory::Implementation::AES_REF_IMPLEMENTATION));
+	ASSERT_TRUE((bool)m_ref);
+	ASSERT_TRUE(m_ref->isInit());
+
+	m_hw.reset(AesCipherFactory::create(AesCipherFactory::Implementation::AES_HW_IMPLEMENTATION));
+	ASSERT_TRUE((bool)m_hw);
+	if (!m_hw->isInit()) {
+		GTEST_SKIP() << "*** " << m_hw->name() << " is not supported on this CPU.";
+	}
+
+	// Generate a pseudo-random key, IV, and cipher text.
+	// A fixed LCG is used so the results are reproducible.
+	uint32_t seed = 0x12345678U;
+	auto next_byte = [&seed]() -> uint8_t {
+		seed = (seed * 1103515245U) + 12345U;
+		return static_cast<uint8_t>(seed >> 16);
+	};
+
+	for (uint8_t &p : m_key) {
+		p = next_byte();
+	}
+	for (uint8_t &p : m_iv) {
+		p = next_byte();
+	}
+	m_cipherText.resize(BUF_SIZE);
+	for (uint8_t &p : m_cipherText) {
+		p = next_byte();
+	}
+}
+
+/**
+ * Initialize a cipher with the current test parameters.
+ * @param cipher	[in] Cipher
+ * @param iv		[in] IV/counter
+ */
+void AesCipherCompareTest::initCipher(IAesCipher *cipher, const array<uint8_t, 16> &iv)
+{
+	const AesCipherCompareTest_mode &mode = GetParam();
+	ASSERT_EQ(0, cipher->setKey(m_key.data(), mode.key_len));
+	ASSERT_EQ(0, cipher->setChainingMode(mode.chainingMode));
+	if (mode.chainingMode != IAesCipher::ChainingMode::ECB) {
+		ASSERT_EQ(0, cipher->setIV(iv.data(), iv.size()));
+	}
+}
+
+/**
+ * Decrypt the cipher text using both implementations and compare the results.
+ * @param iv		[in] IV/counter
+ * @param chunk_sizes	[in] Chunk sizes, in 16-byte blocks (0-terminated; nullptr for the whole buffer)
+ */
+void AesCipherCompareTest::compareTest(const array<uint8_t, 16> &iv, const unsigned int *chunk_sizes)
+{
+	ASSERT_NO_FATAL_FAILURE(initCipher(m_ref.get(), iv));
+	ASSERT_NO_FATAL_FAILURE(initCipher(m_hw.get(), iv));
+
+	// Reference implementation: Decrypt everything at once.
+	rp::uvector<uint8_t> buf_ref(m_cipherText);
+	ASSERT_EQ(buf_ref.size(), m_ref->decrypt(buf_ref.data(), buf_ref.size()));
+
+	// Hardware implementation: Decrypt using the specified chunk sizes.
+	rp::uvector<uint8_t> buf_hw(m_cipherText);
+	if (!chunk_sizes) {
+		ASSERT_EQ(buf_hw.size(), m_hw->decrypt(buf_hw.data(), buf_hw.size()));
+	} else {
+		const unsigned int *p_chunk = chunk_sizes;
+		for (size_t pos = 0; pos < buf_hw.size(); ) {
+			if (*p_chunk == 0) {
+				// Restart the chunk size list.
+				p_chunk = chunk_sizes;
+			}
+			const size_t len = std::min(static_cast<size_t>(*p_chunk++) * 16U, buf_hw.size() - pos);
+			ASSERT_EQ(len, m_hw->decrypt(&buf_hw[pos], len));
+			pos += len;
+		}
+	}
+
+	// Compare the results.
+	for (size_t i = 0; i < buf_ref.size(); i += 16) {
+		ASSERT_EQ(0, memcmp(&buf_ref[i], &buf_hw[i], 16)) << "Mismatch in block " << (i / 16);
+	}
+}
+
+/**
+ * Run a decryption benchmark.
+ * @param cipher	[in] Cipher
+ */
+void AesCipherCompareTest::decryptBenchmark(IAesCipher *cipher)
+{
+	ASSERT_NO_FATAL_FAILURE(initCipher(cipher, m_iv));
+
+	rp::uvector<uint8_t> buf(m_cipherText);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(buf.size(), cipher->decrypt(buf.data(), buf.size()));
+	}
+}
+
+/**
+ * Compare the hardware implementation to the reference implementation.
+ * The entire buffer is decrypted at once.
+ */
+TEST_P(AesCipherCompareTest, compareTest_wholeBuffer)
+{
+	ASSERT_NO_FATAL_FAILURE(compareTest(m_iv, nullptr));
+}
+
+/**
+ * Compare the hardware implementation to the reference implementation.
+ * The buffer is decrypted in chunks of varying sizes in order to
+ * test IV/counter chaining between the multi-block and single-block paths.
+ */
+TEST_P(AesCipherCompareTest, compareTest_chunked)
+{
+	static const unsigned int chunk_sizes[] = {1, 2, 3, 4, 5, 7, 8, 13, 64, 0};
+	ASSERT_NO_FATAL_FAILURE(compareTest(m_iv, chunk_sizes));
+}
+
+/**
+ * Compare the hardware implementation to the reference implementation.
+ * The IV/counter is set such that the low 64 bits of the counter
+ * overflow in the middle of a multi-block group.
+ */
+TEST_P(AesCipherCompareTest, compareTest_counterCarry64)
+{
+	array<uint8_t, 16> iv = m_iv;
+	memset(&iv[8], 0xFF, 8);
+	iv[15] = 0xFE;
+	ASSERT_NO_FATAL_FAILURE(compareTest(iv, nullptr));
+}
+
+/**
+ * Compare the hardware implementation to the reference implementation.
+ * The IV/counter is set such that the entire 128-bit counter wraps around.
+ */
+TEST_P(AesCipherCompareTest, compareTest_counterWrap128)
+{
+	array<uint8_t, 16> iv;
+	iv.fill(0xFF);
+	iv[15] = 0xFD;
+	ASSERT_NO_FATAL_FAILURE(compareTest(iv, nullptr));
+}
+
+/**
+ * Benchmark the reference implementation.
+ */
+TEST_P(AesCipherCompareTest, ref_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(decryptBenchmark(m_ref.get()));
+}
+
+/**
+ * Benchmark the hardware implementation.
+ */
+TEST_P(AesCipherCompareTest, hw_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(decryptBenchmark(m_hw.get()));
+}
+
+INSTANTIATE_TEST_SUITE_P(AesCipherCompareTest, AesCipherCompareTest,
+	::testing::Values(
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::ECB, 16),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::ECB, 24),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::ECB, 32),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CBC, 16),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CBC, 24),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CBC, 32),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CTR, 16),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CTR, 24),
+		AesCipherCompareTest_mode(IAesCipher::ChainingMode::CTR, 32))
+	, AesCipherCompareTest::test_case_suffix_generator);
+
+} }
+
+#endif /* AES_HW_IMPLEMENTATION && AES_REF_IMPLEMENTATION */
@@ -691,6 +691,12 @@ AesDecryptTestSet(CAPI_NG, false)
 #ifdef HAVE_NETTLE
 AesDecryptTestSet(Nettle, true)
 #endif /* HAVE_NETTLE */
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+AesDecryptTestSet(AesNI, false)
+#endif /* RP_CPU_I386 || RP_CPU_AMD64 */
+#ifdef RP_CPU_ARM64
+AesDecryptTestSet(ArmCE, false)
+#endif /* RP_CPU_ARM64 */
 
 } }
 
@@ -0,0 +1,257 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CachedFileTest.cpp: CachedFile class test.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// librpfile
+#include "librpfile/CachedFile.hpp"
+#include "librpfile/MemFile.hpp"
+using namespace LibRpFile;
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::vector;
+
+// libfmt
+#include "rp-libfmt.h"
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * IRpFile wrapper that counts reads, to simulate a remote file.
+ */
+class CountingFile final : public IRpFile
+{
+public:
+	explicit CountingFile(const IRpFilePtr &file)
+		: m_file(file)
+		, reads(0)
+		, shortRead(0)
+	{}
+
+	bool isOpen(void) const final { return m_file->isOpen(); }
+	void close(void) final { m_file->close(); }
+	size_t read(void *ptr, size_t size) final
+	{
+		reads++;
+		if (shortRead > 0 && size > shortRead) {
+			// Simulate a short read.
+			size = shortRead;
+			shortRead = 0;
+		}
+		return m_file->read(ptr, size);
+	}
+	size_t write(const void *ptr, size_t size) final { return m_file->write(ptr, size); }
+	int seek(off64_t pos, SeekWhence whence) final { return m_file->seek(pos, whence); }
+	off64_t tell(void) final { return m_file->tell(); }
+	off64_t size(void) final { return m_file->size(); }
+
+private:
+	IRpFilePtr m_file;
+public:
+	unsigned int reads;
+	size_t shortRead;	// If non-zero, the next read() is truncated to this size.
+};
+
+class CachedFileTest : public ::testing::Test
+{
+protected:
+	// Test file size (1 MiB + 1234 bytes, so the last block is short)
+	static constexpr size_t TEST_FILE_SIZE = (1024U * 1024U) + 1234U;
+
+	CachedFileTest()
+		: m_data(TEST_FILE_SIZE)
+	{
+		// Fill the test file with a predictable pattern.
+		uint32_t seed = 0x12345678;
+		for (uint8_t &p : m_data) {
+			seed = (seed * 1103515245U) + 12345U;
+			p = static_cast<uint8_t>(seed >> 16);
+		}
+	}
+
+	void SetUp(void) final
+	{
+		m_memFile = std::make_shared<CountingFile>(std::make_shared<MemFile>(m_data.data(), m_data.size()));
+		m_cachedFile = std::make_shared<CachedFile>(m_memFile, 4096, 8);
+		ASSERT_TRUE(m_cachedFile->isOpen());
+	}
+
+	void TearDown(void) final
+	{
+		m_cachedFile.reset();
+		m_memFile.reset();
+	}
+
+protected:
+	vector<uint8_t> m_data;
+	std::shared_ptr<CountingFile> m_memFile;
+	CachedFilePtr m_cachedFile;
+};
+
+/**
+ * Basic file properties.
+ */
+TEST_F(CachedFileTest, fileProperties)
+{
+	EXPECT_EQ(static_cast<off64_t>(TEST_FILE_SIZE), m_cachedFile->size());
+	EXPECT_EQ(0, m_cachedFile->tell());
+
+	EXPECT_EQ(0, m_cachedFile->seek(-16, IRpFile::SeekWhence::End));
+	EXPECT_EQ(static_cast<off64_t>(TEST_FILE_SIZE - 16), m_cachedFile->tell());
+
+	// Reading past EOF should be truncated.
+	uint8_t buf[64];
+	EXPECT_EQ(16U, m_cachedFile->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[TEST_FILE_SIZE - 16], 16));
+	EXPECT_EQ(0U, m_cachedFile->read(buf, sizeof(buf)));
+
+	// Writing is not supported.
+	EXPECT_EQ(0U, m_cachedFile->write(buf, sizeof(buf)));
+	EXPECT_EQ(EBADF, m_cachedFile->lastError());
+}
+
+/**
+ * Small reads within the same block should only read from the underlying file once.
+ */
+TEST_F(CachedFileTest, headerProbes)
+{
+	static const unsigned int offsets[] = {0, 0x100, 0x20, 0x400, 0x1C, 0x0, 0x800, 0x200};
+	uint8_t buf[32];
+	for (unsigned int offset : offsets) {
+		ASSERT_EQ(sizeof(buf), m_cachedFile->seekAndRead(offset, buf, sizeof(buf)));
+		EXPECT_EQ(0, memcmp(buf, &m_data[offset], sizeof(buf)));
+	}
+
+	EXPECT_EQ(1U, m_memFile->reads);
+	EXPECT_EQ(1U, m_cachedFile->stats().fileReads);
+	EXPECT_EQ(7U, m_cachedFile->roundTripsSaved());
+}
+
+/**
+ * Reads that cross block boundaries.
+ */
+TEST_F(CachedFileTest, unalignedReads)
+{
+	uint8_t buf[10000];
+	static const off64_t offsets[] = {4000, 12345, 0, 8190, TEST_FILE_SIZE - 5000};
+	for (off64_t offset : offsets) {
+		const size_t size = std::min(sizeof(buf), static_cast<size_t>(TEST_FILE_SIZE - offset));
+		ASSERT_EQ(size, m_cachedFile->seekAndRead(offset, buf, size));
+		EXPECT_EQ(0, memcmp(buf, &m_data[offset], size)) << "offset == " << offset;
+	}
+}
+
+/**
+ * Sequential reads should enable read-ahead.
+ */
+TEST_F(CachedFileTest, sequentialReadAhead)
+{
+	uint8_t buf[1024];
+	vector<uint8_t> out;
+	out.reserve(TEST_FILE_SIZE);
+
+	m_cachedFile->rewind();
+	size_t size;
+	while ((size = m_cachedFile->read(buf, sizeof(buf))) > 0) {
+		out.insert(out.end(), buf, buf + size);
+	}
+	ASSERT_EQ(m_data.size(), out.size());
+	EXPECT_EQ(0, memcmp(m_data.data(), out.data(), out.size()));
+
+	// Without read-ahead, there would be one read per 4 KiB block.
+	// With read-ahead, each read fetches up to 4 blocks. (half of the cache)
+	const unsigned int blocks = static_cast<unsigned int>((TEST_FILE_SIZE + 4095) / 4096);
+	EXPECT_LE(m_memFile->reads, (blocks / 4) + 2);
+	EXPECT_GT(m_cachedFile->stats().readAhead, 0U);
+}
+
+/**
+ * Reads larger than half of the cache should bypass the cache.
+ */
+TEST_F(CachedFileTest, largeRead)
+{
+	vector<uint8_t> buf(65536);
+	ASSERT_EQ(buf.size(), m_cachedFile->seekAndRead(100, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[100], buf.size()));
+	EXPECT_EQ(1U, m_memFile->reads);
+	EXPECT_EQ(0U, m_cachedFile->stats().misses);
+}
+
+/**
+ * Incomplete blocks from short reads should not be cached.
+ */
+TEST_F(CachedFileTest, shortRead)
+{
+	m_memFile->shortRead = 100;
+
+	uint8_t buf[32];
+	ASSERT_EQ(sizeof(buf), m_cachedFile->seekAndRead(0, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[0], sizeof(buf)));
+	EXPECT_EQ(1U, m_memFile->reads);
+
+	// This is past the end of the short read, so the block must be read again.
+	ASSERT_EQ(sizeof(buf), m_cachedFile->seekAndRead(200, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[200], sizeof(buf)));
+	EXPECT_EQ(2U, m_memFile->reads);
+
+	// The full block should be cached now.
+	ASSERT_EQ(sizeof(buf), m_cachedFile->seekAndRead(80, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[80], sizeof(buf)));
+	EXPECT_EQ(2U, m_memFile->reads);
+}
+
+/**
+ * The cache should be bounded.
+ */
+TEST_F(CachedFileTest, eviction)
+{
+	// Read one byte from 16 different blocks.
+	// Only the last 8 should be cached.
+	uint8_t b;
+	for (unsigned int i = 0; i < 16; i++) {
+		ASSERT_EQ(1U, m_cachedFile->seekAndRead(i * 8192, &b, 1));
+		EXPECT_EQ(m_data[i * 8192], b);
+	}
+	EXPECT_EQ(16U, m_memFile->reads);
+
+	// Most recent block: Cached.
+	ASSERT_EQ(1U, m_cachedFile->seekAndRead(15 * 8192, &b, 1));
+	EXPECT_EQ(16U, m_memFile->reads);
+
+	// First block: Evicted.
+	ASSERT_EQ(1U, m_cachedFile->seekAndRead(0, &b, 1));
+	EXPECT_EQ(17U, m_memFile->reads);
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = 0;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fmt::print(stderr, FSTR("LibRpBase test suite: CachedFile tests.\n\n"));
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
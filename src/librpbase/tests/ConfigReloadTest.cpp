@@ -0,0 +1,328 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * ConfigReloadTest.cpp: Config reload test.                               *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/config/Config.hpp"
+
+// C includes
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+
+// C++ includes
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+using std::string;
+using std::vector;
+
+// libfmt
+#include "rp-libfmt.h"
+
+namespace LibRpBase { namespace Tests {
+
+class ConfigReloadTest : public ::testing::Test
+{
+protected:
+	static void SetUpTestSuite(void);
+	static void TearDownTestSuite(void);
+
+public:
+	/**
+	 * Write rom-properties.conf.
+	 * The file is written to a temporary file and renamed
+	 * so the Config object never sees a partial file.
+	 * @param second If true, write the second configuration.
+	 */
+	static void writeConfig(bool second);
+
+	/**
+	 * Wait until ConfReader checks for changes again.
+	 * load(false) only checks for changes every 2 seconds.
+	 */
+	static void waitForCheckInterval(void);
+
+	/**
+	 * Check image type priority data.
+	 * @param imgTypePrio Image type priority data
+	 * @return True if it matches either test configuration; false if not.
+	 */
+	static bool checkImgTypePrio(const Config::ImgTypePrio_t &imgTypePrio);
+
+public:
+	static time_t ms_mtime;		// mtime for the next rom-properties.conf
+	static string ms_tmpDir;	// Temporary directory
+	static string ms_confDir;	// rom-properties configuration directory
+	static string ms_confFilename;	// rom-properties.conf
+};
+
+time_t ConfigReloadTest::ms_mtime = 1000000000;
+string ConfigReloadTest::ms_tmpDir;
+string ConfigReloadTest::ms_confDir;
+string ConfigReloadTest::ms_confFilename;
+
+void ConfigReloadTest::SetUpTestSuite(void)
+{
+	ms_tmpDir = ::testing::TempDir();
+	if (ms_tmpDir.empty() || ms_tmpDir[ms_tmpDir.size()-1] != '/') {
+		ms_tmpDir += '/';
+	}
+	ms_tmpDir += "rp-ConfigReloadTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(&ms_tmpDir[0]));
+
+	ms_confDir = ms_tmpDir + "/rom-properties";
+	ASSERT_EQ(0, mkdir(ms_confDir.c_str(), 0700));
+	ms_confFilename = ms_confDir + "/rom-properties.conf";
+	writeConfig(false);
+
+	// NOTE: The configuration directory is determined on first use,
+	// so this must be set before calling Config::instance().
+	ASSERT_EQ(0, setenv("XDG_CONFIG_HOME", ms_tmpDir.c_str(), 1));
+}
+
+void ConfigReloadTest::TearDownTestSuite(void)
+{
+	unlink(ms_confFilename.c_str());
+	unlink((ms_confFilename + ".tmp").c_str());
+	rmdir(ms_confDir.c_str());
+	rmdir(ms_tmpDir.c_str());
+}
+
+/**
+ * Write rom-properties.conf.
+ * The file is written to a temporary file and renamed
+ * so the Config object never sees a partial file.
+ * @param second If true, write the second configuration.
+ */
+void ConfigReloadTest::writeConfig(bool second)
+{
+	const string tmpFilename = ms_confFilename + ".tmp";
+	FILE *f = fopen(tmpFilename.c_str(), "w");
+	ASSERT_NE(nullptr, f);
+	if (!second) {
+		fputs("[Downloads]\n"
+		      "CacheSizeLimit=100\n"
+		      "[ImageTypes]\n"
+		      "GameCube=ExtCover,IntIcon\n", f);
+	} else {
+		fputs("[Downloads]\n"
+		      "CacheSizeLimit=200\n"
+		      "[ImageTypes]\n"
+		      "GameCube=IntIcon\n", f);
+	}
+	fclose(f);
+
+	// Use a different mtime for each file in case inotify
+	// isn't available and the mtime is checked instead.
+	struct timespec times[2];
+	times[0].tv_sec = 0;
+	times[0].tv_nsec = UTIME_OMIT;
+	times[1].tv_sec = ms_mtime;
+	times[1].tv_nsec = 0;
+	ms_mtime += 10;
+	ASSERT_EQ(0, utimensat(AT_FDCWD, tmpFilename.c_str(), times, 0));
+
+	ASSERT_EQ(0, rename(tmpFilename.c_str(), ms_confFilename.c_str()));
+}
+
+/**
+ * Wait until ConfReader checks for changes again.
+ * load(false) only checks for changes every 2 seconds.
+ */
+void ConfigReloadTest::waitForCheckInterval(void)
+{
+	std::this_thread::sleep_for(std::chrono::seconds(3));
+}
+
+/**
+ * Check image type priority data.
+ * @param imgTypePrio Image type priority data
+ * @return True if it matches either test configuration; false if not.
+ */
+bool ConfigReloadTest::checkImgTypePrio(const Config::ImgTypePrio_t &imgTypePrio)
+{
+	switch (imgTypePrio.length) {
+		case 2:
+			return (imgTypePrio.imgTypes[0] == RomData::IMG_EXT_COVER &&
+			        imgTypePrio.imgTypes[1] == RomData::IMG_INT_ICON);
+		case 1:
+			return (imgTypePrio.imgTypes[0] == RomData::IMG_INT_ICON);
+		default:
+			return false;
+	}
+}
+
+/**
+ * Image type priority data must remain valid after a reload.
+ */
+TEST_F(ConfigReloadTest, imgTypePrioOutlivesReload)
+{
+	writeConfig(false);
+	Config *const config = Config::instance();
+	ASSERT_EQ(0, config->load(true));
+
+	Config::ImgTypePrio_t imgTypePrio;
+	ASSERT_EQ(Config::ImgTypeResult::Success, config->getImgTypePrio("GameCube", &imgTypePrio));
+	ASSERT_EQ(2U, imgTypePrio.length);
+	EXPECT_EQ(100U, config->cacheSizeLimit());
+
+	// Reload with the second configuration.
+	writeConfig(true);
+	ASSERT_EQ(0, config->load(true));
+	EXPECT_EQ(200U, config->cacheSizeLimit());
+
+	Config::ImgTypePrio_t newImgTypePrio;
+	ASSERT_EQ(Config::ImgTypeResult::Success, config->getImgTypePrio("GameCube", &newImgTypePrio));
+	ASSERT_EQ(1U, newImgTypePrio.length);
+	EXPECT_EQ(RomData::IMG_INT_ICON, newImgTypePrio.imgTypes[0]);
+
+	// The original data should still be intact.
+	ASSERT_EQ(2U, imgTypePrio.length);
+	EXPECT_EQ(RomData::IMG_EXT_COVER, imgTypePrio.imgTypes[0]);
+	EXPECT_EQ(RomData::IMG_INT_ICON, imgTypePrio.imgTypes[1]);
+}
+
+/**
+ * Reload the configuration while other threads are reading it.
+ * Run this under ThreadSanitizer or AddressSanitizer to check for
+ * data races and use-after-free errors.
+ */
+TEST_F(ConfigReloadTest, reloadWhileReading)
+{
+	static constexpr unsigned int THREAD_COUNT = 4;
+	static constexpr unsigned int RELOAD_COUNT = 200;
+
+	writeConfig(false);
+	Config *const config = Config::instance();
+	ASSERT_EQ(0, config->load(true));
+
+	std::atomic<bool> stop(false);
+	std::atomic<unsigned int> errors(0);
+	std::atomic<unsigned int> reads(0);
+
+	vector<std::thread> threads;
+	threads.reserve(THREAD_COUNT);
+	for (unsigned int i = 0; i < THREAD_COUNT; i++) {
+		threads.emplace_back([config, &stop, &errors, &reads]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				Config::ImgTypePrio_t imgTypePrio;
+				if (config->getImgTypePrio("GameCube", &imgTypePrio) != Config::ImgTypeResult::Success ||
+				    !checkImgTypePrio(imgTypePrio))
+				{
+					errors++;
+				}
+
+				const uint32_t cacheSizeLimit = config->cacheSizeLimit();
+				if (cacheSizeLimit != 100 && cacheSizeLimit != 200) {
+					errors++;
+				}
+
+				// Make sure the data is still valid after yielding.
+				std::this_thread::yield();
+				if (!checkImgTypePrio(imgTypePrio)) {
+					errors++;
+				}
+				reads++;
+			}
+		});
+	}
+
+	// Wait for the reader threads to start.
+	while (reads.load() < THREAD_COUNT) {
+		std::this_thread::yield();
+	}
+
+	for (unsigned int i = 0; i < RELOAD_COUNT; i++) {
+		writeConfig(i & 1);
+		EXPECT_EQ(0, config->load(true));
+	}
+
+	stop = true;
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(0U, errors.load());
+}
+
+/**
+ * Replacing rom-properties.conf is detected by load(false),
+ * but only after the check interval has passed.
+ */
+TEST_F(ConfigReloadTest, reloadOnChange)
+{
+	writeConfig(false);
+	ASSERT_EQ(0, Config::instance()->load(true));
+
+	// Start a new check interval.
+	waitForCheckInterval();
+	EXPECT_EQ(100U, Config::instance()->cacheSizeLimit());
+
+	// Replace the file. This won't be noticed until the
+	// check interval has passed.
+	writeConfig(true);
+	EXPECT_EQ(100U, Config::instance()->cacheSizeLimit());
+
+	waitForCheckInterval();
+	EXPECT_EQ(200U, Config::instance()->cacheSizeLimit());
+}
+
+/**
+ * If the configuration directory is removed, the inotify watch is lost,
+ * and ConfReader checks the mtime instead.
+ * NOTE: This must be the last test, since the watch can't be restored.
+ */
+TEST_F(ConfigReloadTest, reloadAfterWatchLost)
+{
+	writeConfig(true);
+	ASSERT_EQ(0, Config::instance()->load(true));
+	EXPECT_EQ(200U, Config::instance()->cacheSizeLimit());
+
+	// Remove and recreate the configuration directory.
+	ASSERT_EQ(0, unlink(ms_confFilename.c_str()));
+	ASSERT_EQ(0, rmdir(ms_confDir.c_str()));
+	ASSERT_EQ(0, mkdir(ms_confDir.c_str(), 0700));
+	writeConfig(false);
+
+	waitForCheckInterval();
+	EXPECT_EQ(100U, Config::instance()->cacheSizeLimit());
+
+	// The watch is gone, so this change is detected using the mtime.
+	writeConfig(true);
+	waitForCheckInterval();
+	EXPECT_EQ(200U, Config::instance()->cacheSizeLimit());
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_FILE_WRITE;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fmt::print(stderr, FSTR("LibRpBase test suite: Config reload tests.\n\n"));
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,382 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CopyToTest.cpp: IRpFile::copyTo() and RpFile fast path tests.           *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// librpfile
+#include "librpfile/MemFile.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/VectorFile.hpp"
+using namespace LibRpFile;
+
+// C includes
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// libfmt
+#include "rp-libfmt.h"
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * IRpFile wrapper that fails writes after a certain number of bytes,
+ * to simulate a full disk.
+ */
+class ShortWriteFile final : public IRpFile
+{
+public:
+	explicit ShortWriteFile(size_t limit)
+		: m_file(std::make_shared<VectorFile>())
+		, m_limit(limit)
+	{
+		m_isWritable = true;
+	}
+
+	bool isOpen(void) const final { return m_file->isOpen(); }
+	void close(void) final { m_file->close(); }
+	size_t read(void *ptr, size_t size) final { return m_file->read(ptr, size); }
+	size_t write(const void *ptr, size_t size) final
+	{
+		const size_t avail = m_limit - static_cast<size_t>(m_file->size());
+		if (size > avail) {
+			// Simulate a short write.
+			size = avail;
+			m_lastError = ENOSPC;
+		}
+		return m_file->write(ptr, size);
+	}
+	int seek(off64_t pos, SeekWhence whence) final { return m_file->seek(pos, whence); }
+	off64_t tell(void) final { return m_file->tell(); }
+	off64_t size(void) final { return m_file->size(); }
+
+	const std::vector<uint8_t> &vector(void) const { return m_file->vector(); }
+
+private:
+	std::shared_ptr<VectorFile> m_file;
+	size_t m_limit;
+};
+
+class CopyToTest : public ::testing::Test
+{
+protected:
+	void SetUp(void) override;
+	void TearDown(void) override;
+
+public:
+	/**
+	 * Create test data with a predictable pattern.
+	 * @param size Size
+	 * @return Test data
+	 */
+	static vector<uint8_t> makeData(size_t size);
+
+	/**
+	 * Read an entire file.
+	 * @param filename Filename
+	 * @return File contents
+	 */
+	static vector<uint8_t> readFile(const string &filename);
+
+public:
+	// Larger than the 4 MiB pipelined copy threshold,
+	// and not a multiple of the 1 MiB buffer size.
+	static constexpr size_t LARGE_SIZE = (5U * 1024U * 1024U) + 1234U;
+	// Smaller than the pipelined copy threshold.
+	static constexpr size_t SMALL_SIZE = (64U * 1024U) + 123U;
+
+	string m_tmpDir;	// Temporary directory
+	vector<string> m_files;	// Files to delete
+};
+
+void CopyToTest::SetUp(void)
+{
+	m_tmpDir = ::testing::TempDir();
+	if (m_tmpDir.empty() || m_tmpDir[m_tmpDir.size()-1] != '/') {
+		m_tmpDir += '/';
+	}
+	m_tmpDir += "rp-CopyToTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(&m_tmpDir[0]));
+}
+
+void CopyToTest::TearDown(void)
+{
+	for (const string &filename : m_files) {
+		unlink(filename.c_str());
+	}
+	rmdir(m_tmpDir.c_str());
+}
+
+/**
+ * Create test data with a predictable pattern.
+ * @param size Size
+ * @return Test data
+ */
+vector<uint8_t> CopyToTest::makeData(size_t size)
+{
+	vector<uint8_t> data(size);
+	uint32_t seed = 0x12345678;
+	for (uint8_t &p : data) {
+		seed = (seed * 1103515245U) + 12345U;
+		p = static_cast<uint8_t>(seed >> 16);
+	}
+	return data;
+}
+
+/**
+ * Read an entire file.
+ * @param filename Filename
+ * @return File contents
+ */
+vector<uint8_t> CopyToTest::readFile(const string &filename)
+{
+	vector<uint8_t> data;
+	FILE *const f = fopen(filename.c_str(), "rb");
+	if (!f) {
+		return data;
+	}
+	uint8_t buf[65536];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.insert(data.end(), buf, buf + size);
+	}
+	fclose(f);
+	return data;
+}
+
+/**
+ * RpFile to RpFile copy using copyToDirect().
+ */
+TEST_F(CopyToTest, rpFileDirectCopy)
+{
+	static constexpr off64_t SRC_OFFSET = 100;
+	static constexpr char header[] = "HEADER";
+	const vector<uint8_t> data = makeData(LARGE_SIZE);
+
+	const string srcFilename = m_tmpDir + "/src.bin";
+	const string destFilename = m_tmpDir + "/dest.bin";
+	m_files.push_back(srcFilename);
+	m_files.push_back(destFilename);
+
+	{
+		IRpFilePtr srcFile = std::make_shared<RpFile>(srcFilename, RpFile::FM_CREATE_WRITE);
+		ASSERT_TRUE(srcFile->isOpen());
+		ASSERT_EQ(data.size(), srcFile->write(data.data(), data.size()));
+	}
+
+	IRpFilePtr srcFile = std::make_shared<RpFile>(srcFilename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(srcFile->isOpen());
+	IRpFilePtr destFile = std::make_shared<RpFile>(destFilename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(destFile->isOpen());
+
+	// Write a header first to make sure the destination's
+	// buffered data is flushed before the direct copy.
+	ASSERT_EQ(sizeof(header), destFile->write(header, sizeof(header)));
+	ASSERT_EQ(0, srcFile->seek(SRC_OFFSET, IRpFile::SeekWhence::Set));
+
+	const off64_t size = static_cast<off64_t>(data.size()) - SRC_OFFSET;
+	off64_t cbCopied = -1;
+	ASSERT_EQ(0, srcFile->copyToDirect(destFile.get(), size, &cbCopied));
+	EXPECT_EQ(size, cbCopied);
+
+	// Both file positions should be advanced.
+	EXPECT_EQ(SRC_OFFSET + size, srcFile->tell());
+	EXPECT_EQ(static_cast<off64_t>(sizeof(header)) + size, destFile->tell());
+
+	// Data written after the direct copy must end up after the copied data.
+	ASSERT_EQ(sizeof(header), destFile->write(header, sizeof(header)));
+	destFile->close();
+
+	vector<uint8_t> expected(header, header + sizeof(header));
+	expected.insert(expected.end(), data.begin() + SRC_OFFSET, data.end());
+	expected.insert(expected.end(), header, header + sizeof(header));
+	const vector<uint8_t> actual = readFile(destFilename);
+	ASSERT_EQ(expected.size(), actual.size());
+	EXPECT_TRUE(expected == actual);
+}
+
+/**
+ * RpFile to RpFile copy past the end of the source file.
+ * The available data should be copied, and the short read reported.
+ */
+TEST_F(CopyToTest, rpFileDirectCopyPastEOF)
+{
+	const vector<uint8_t> data = makeData(SMALL_SIZE);
+
+	const string srcFilename = m_tmpDir + "/src.bin";
+	const string destFilename = m_tmpDir + "/dest.bin";
+	m_files.push_back(srcFilename);
+	m_files.push_back(destFilename);
+
+	{
+		IRpFilePtr srcFile = std::make_shared<RpFile>(srcFilename, RpFile::FM_CREATE_WRITE);
+		ASSERT_TRUE(srcFile->isOpen());
+		ASSERT_EQ(data.size(), srcFile->write(data.data(), data.size()));
+	}
+
+	IRpFilePtr srcFile = std::make_shared<RpFile>(srcFilename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(srcFile->isOpen());
+	IRpFilePtr destFile = std::make_shared<RpFile>(destFilename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(destFile->isOpen());
+
+	off64_t cbRead = -1, cbWritten = -1;
+	EXPECT_EQ(-EIO, srcFile->copyTo(destFile.get(), data.size() * 2, &cbRead, &cbWritten));
+	EXPECT_EQ(static_cast<off64_t>(data.size()), cbRead);
+	EXPECT_EQ(static_cast<off64_t>(data.size()), cbWritten);
+	destFile->close();
+
+	EXPECT_TRUE(data == readFile(destFilename));
+}
+
+/**
+ * MemFile to RpFile copy using the pipelined path.
+ */
+TEST_F(CopyToTest, memFilePipelinedCopy)
+{
+	const vector<uint8_t> data = makeData(LARGE_SIZE);
+	const std::shared_ptr<MemFile> srcFile = std::make_shared<MemFile>(data.data(), data.size());
+
+	const string destFilename = m_tmpDir + "/dest.bin";
+	m_files.push_back(destFilename);
+	IRpFilePtr destFile = std::make_shared<RpFile>(destFilename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(destFile->isOpen());
+
+	off64_t cbRead = -1, cbWritten = -1;
+	ASSERT_EQ(0, srcFile->copyTo(destFile.get(), data.size(), &cbRead, &cbWritten));
+	EXPECT_EQ(static_cast<off64_t>(data.size()), cbRead);
+	EXPECT_EQ(static_cast<off64_t>(data.size()), cbWritten);
+	EXPECT_EQ(static_cast<off64_t>(data.size()), srcFile->tell());
+	EXPECT_EQ(static_cast<off64_t>(data.size()), destFile->tell());
+	destFile->close();
+
+	const vector<uint8_t> actual = readFile(destFilename);
+	ASSERT_EQ(data.size(), actual.size());
+	EXPECT_TRUE(data == actual);
+}
+
+/**
+ * Short reads are reported as errors, and the data that
+ * was read is still written. (buffered and pipelined)
+ */
+TEST_F(CopyToTest, shortRead)
+{
+	for (const size_t size : {SMALL_SIZE, LARGE_SIZE}) {
+		const vector<uint8_t> data = makeData(size);
+		const std::shared_ptr<MemFile> srcFile = std::make_shared<MemFile>(data.data(), data.size());
+		const std::shared_ptr<VectorFile> destFile = std::make_shared<VectorFile>();
+
+		off64_t cbRead = -1, cbWritten = -1;
+		EXPECT_EQ(-EIO, srcFile->copyTo(destFile.get(), size + (2U * 1024U * 1024U), &cbRead, &cbWritten)) << "size == " << size;
+		EXPECT_EQ(static_cast<off64_t>(size), cbRead) << "size == " << size;
+		EXPECT_EQ(static_cast<off64_t>(size), cbWritten) << "size == " << size;
+		EXPECT_TRUE(data == destFile->vector()) << "size == " << size;
+	}
+}
+
+/**
+ * Short writes are reported using the destination's error code. (buffered and pipelined)
+ */
+TEST_F(CopyToTest, shortWrite)
+{
+	for (const size_t size : {SMALL_SIZE, LARGE_SIZE}) {
+		const vector<uint8_t> data = makeData(size);
+		const std::shared_ptr<MemFile> srcFile = std::make_shared<MemFile>(data.data(), data.size());
+		const size_t limit = size / 2;
+		const std::shared_ptr<ShortWriteFile> destFile = std::make_shared<ShortWriteFile>(limit);
+
+		off64_t cbRead = -1, cbWritten = -1;
+		EXPECT_EQ(-ENOSPC, srcFile->copyTo(destFile.get(), size, &cbRead, &cbWritten)) << "size == " << size;
+		EXPECT_EQ(static_cast<off64_t>(limit), cbWritten) << "size == " << size;
+		EXPECT_GE(cbRead, cbWritten) << "size == " << size;
+		EXPECT_LE(cbRead, static_cast<off64_t>(size)) << "size == " << size;
+
+		ASSERT_EQ(limit, destFile->vector().size()) << "size == " << size;
+		EXPECT_TRUE(std::equal(data.begin(), data.begin() + limit, destFile->vector().begin())) << "size == " << size;
+	}
+}
+
+/**
+ * Preallocate space in a new file.
+ */
+TEST_F(CopyToTest, preallocate)
+{
+	static constexpr off64_t PREALLOC_SIZE = 1024 * 1024;
+
+	const string filename = m_tmpDir + "/prealloc.bin";
+	m_files.push_back(filename);
+	IRpFilePtr file = std::make_shared<RpFile>(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+
+	const int ret = file->preallocate(0, PREALLOC_SIZE);
+	if (ret == -ENOTSUP || ret == -EOPNOTSUPP) {
+		GTEST_SKIP() << "preallocate() is not supported on this file system.";
+	}
+	ASSERT_EQ(0, ret);
+
+	// The file size must not change.
+	EXPECT_EQ(0, file->size());
+	struct stat sb;
+	ASSERT_EQ(0, stat(filename.c_str(), &sb));
+	EXPECT_EQ(0, sb.st_size);
+	EXPECT_GE(static_cast<off64_t>(sb.st_blocks) * 512, PREALLOC_SIZE);
+
+	// Writing data still works normally.
+	const vector<uint8_t> data = makeData(SMALL_SIZE);
+	ASSERT_EQ(data.size(), file->write(data.data(), data.size()));
+	file->close();
+	EXPECT_TRUE(data == readFile(filename));
+}
+
+/**
+ * preallocate() fails on read-only files.
+ */
+TEST_F(CopyToTest, preallocateReadOnly)
+{
+	const string filename = m_tmpDir + "/readonly.bin";
+	m_files.push_back(filename);
+	{
+		IRpFilePtr file = std::make_shared<RpFile>(filename, RpFile::FM_CREATE_WRITE);
+		ASSERT_TRUE(file->isOpen());
+	}
+
+	IRpFilePtr file = std::make_shared<RpFile>(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	EXPECT_EQ(-EBADF, file->preallocate(0, 4096));
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_FILE_WRITE;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fmt::print(stderr, FSTR("LibRpBase test suite: IRpFile::copyTo() tests.\n\n"));
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
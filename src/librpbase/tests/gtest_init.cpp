@@ -108,6 +108,9 @@ static constexpr int16_t syscall_wl_base[] = {
 	// TODO: Restrict connect() to AF_UNIX.
 	SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
 
+	// LibRpBase::ConfReader watches the configuration directory for changes.
+	SCMP_SYS(inotify_init1), SCMP_SYS(inotify_add_watch),
+
 	// for posix_fadvise()
 	SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),
 	SCMP_SYS(arm_fadvise64_64),	// CPU-specific syscall for Linux on 32-bit ARM
@@ -264,6 +267,82 @@ static constexpr int16_t syscall_wl_gtk[] = {
 	SCMP_SYS(time),
 };
 
+// for tests that create and modify files
+static constexpr int16_t syscall_wl_file_write[] = {
+	SCMP_SYS(mkdir),
+	SCMP_SYS(rename), SCMP_SYS(renameat), SCMP_SYS(renameat2),
+	SCMP_SYS(unlink), SCMP_SYS(unlinkat),
+	SCMP_SYS(flock),
+	SCMP_SYS(getrandom),	// mkstemp()
+	SCMP_SYS(utimensat),
+
+	SCMP_SYS(rmdir),	// to remove temporary directories
+
+	// ConfigReloadTest waits for ConfReader's check interval.
+	SCMP_SYS(nanosleep), SCMP_SYS(clock_nanosleep),
+#if defined(__SNR_clock_nanosleep_time64) || defined(__NR_clock_nanosleep_time64)
+	SCMP_SYS(clock_nanosleep_time64),
+#endif /* __SNR_clock_nanosleep_time64 || __NR_clock_nanosleep_time64 */
+
+	// RpFile::copyToDirect(), RpFile::preallocate()
+	SCMP_SYS(copy_file_range),
+	SCMP_SYS(sendfile), SCMP_SYS(sendfile64),
+	SCMP_SYS(fallocate),
+};
+
+// for tests that use TCP sockets on localhost (e.g. a local HTTP server)
+static constexpr int16_t syscall_wl_network[] = {
+	// Sockets
+	SCMP_SYS(socket), SCMP_SYS(socketcall),
+	SCMP_SYS(bind), SCMP_SYS(listen),
+	SCMP_SYS(accept), SCMP_SYS(accept4),
+	SCMP_SYS(getsockname), SCMP_SYS(getpeername),
+	SCMP_SYS(getsockopt), SCMP_SYS(setsockopt),
+	SCMP_SYS(recvfrom), SCMP_SYS(shutdown),
+	SCMP_SYS(socketpair),
+	SCMP_SYS(poll), SCMP_SYS(ppoll),
+
+	// cURL
+	SCMP_SYS(eventfd2), SCMP_SYS(pipe2),
+	SCMP_SYS(getuid), SCMP_SYS(geteuid),
+	SCMP_SYS(madvise), SCMP_SYS(mremap),
+	SCMP_SYS(prctl), SCMP_SYS(rt_sigprocmask),
+	SCMP_SYS(sysinfo), SCMP_SYS(uname),
+	SCMP_SYS(statfs), SCMP_SYS(fstatfs), SCMP_SYS(fstatfs64),
+#ifdef __SNR_getrandom
+	SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+};
+
+// for tests that spawn child processes (e.g. ExecRpDownloadTest)
+// NOTE: The child process inherits the seccomp filter.
+static constexpr int16_t syscall_wl_spawn[] = {
+	// posix_spawn(), waitpid(), kill()
+	SCMP_SYS(clone), SCMP_SYS(fork), SCMP_SYS(vfork),
+	SCMP_SYS(execve),
+	SCMP_SYS(wait4), SCMP_SYS(waitpid),
+	SCMP_SYS(kill),
+	SCMP_SYS(dup2), SCMP_SYS(dup3),
+
+	// Communication with the child process
+	SCMP_SYS(socketpair), SCMP_SYS(socketcall),
+	SCMP_SYS(recvfrom),
+	SCMP_SYS(poll), SCMP_SYS(ppoll),
+	SCMP_SYS(nanosleep), SCMP_SYS(clock_nanosleep),
+#if defined(__SNR_clock_nanosleep_time64) || defined(__NR_clock_nanosleep_time64)
+	SCMP_SYS(clock_nanosleep_time64),
+#endif /* __SNR_clock_nanosleep_time64 || __NR_clock_nanosleep_time64 */
+
+	// Child process startup
+	SCMP_SYS(arch_prctl), SCMP_SYS(prctl),
+	SCMP_SYS(pread64), SCMP_SYS(seccomp),
+	SCMP_SYS(set_tid_address), SCMP_SYS(set_robust_list),
+	SCMP_SYS(prlimit64), SCMP_SYS(getrlimit),
+#ifdef __SNR_getrandom
+	SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+};
+
 #endif /* HAVE_SECCOMP */
 
 extern "C" int gtest_main(int argc, TCHAR *argv[]);
@@ -302,24 +381,54 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		param.socket_unix = true;
 	}
 
+	if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_FILE_WRITE) {
+		// Add file writing syscalls.
+		syscall_wl.insert(syscall_wl.end(), syscall_wl_file_write, &syscall_wl_file_write[ARRAY_SIZE(syscall_wl_file_write)]);
+	}
+
+	if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_NETWORK) {
+		// Add network syscalls.
+		syscall_wl.insert(syscall_wl.end(), syscall_wl_network, &syscall_wl_network[ARRAY_SIZE(syscall_wl_network)]);
+	}
+
+	if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_SPAWN) {
+		// Add process spawning syscalls.
+		syscall_wl.insert(syscall_wl.end(), syscall_wl_spawn, &syscall_wl_spawn[ARRAY_SIZE(syscall_wl_spawn)]);
+	}
+
 	// End of syscalls.
 	syscall_wl.push_back(-1);
 	param.syscall_wl = syscall_wl.data();
 	param.threading = true;		// FIXME: Only if OpenMP is enabled?
-	param.socket_tcp_udp = false;
+	param.socket_tcp_udp = !!(rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_NETWORK);
 #elif defined(HAVE_PLEDGE)
 	// Promises:
 	// - stdio: General stdio functionality.
 	// - rpath: Read test cases.
 	// - unix: UNIX domain sockets. (only if building Qt or GTK tests)
-	if (rp_gtest_syscall_set & (RP_GTEST_SYSCALL_SET_QT | RP_GTEST_SYSCALL_SET_GTK)) {
+	// - wpath cpath flock: Create and modify files. (only if needed)
+	// - inet: TCP sockets. (only if needed)
+	// - proc exec: Spawn child processes. (only if needed)
+	if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_SPAWN) {
+		param.promises = "stdio rpath proc exec";
+	} else if (rp_gtest_syscall_set & (RP_GTEST_SYSCALL_SET_QT | RP_GTEST_SYSCALL_SET_GTK)) {
 		param.promises = "stdio rpath unix";
+	} else if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_FILE_WRITE) {
+		param.promises = "stdio rpath wpath cpath flock";
+	} else if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_NETWORK) {
+		param.promises = "stdio rpath inet";
 	} else {
 		param.promises = "stdio rpath";
 	}
 #elif defined(HAVE_TAME)
-	if (rp_gtest_syscall_set & (RP_GTEST_SYSCALL_SET_QT | RP_GTEST_SYSCALL_SET_GTK)) {
+	if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_SPAWN) {
+		param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_PROC | TAME_EXEC;
+	} else if (rp_gtest_syscall_set & (RP_GTEST_SYSCALL_SET_QT | RP_GTEST_SYSCALL_SET_GTK)) {
 		param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_UNIX;
+	} else if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_FILE_WRITE) {
+		param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH;
+	} else if (rp_gtest_syscall_set & RP_GTEST_SYSCALL_SET_NETWORK) {
+		param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_INET;
 	} else {
 		param.tame_flags = TAME_STDIO | TAME_RPATH;
 	}
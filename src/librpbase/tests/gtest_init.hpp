@@ -30,6 +30,9 @@ typedef enum ATTR_FLAG_ENUM {
 	RP_GTEST_SYSCALL_SET_GTEST_DEATH_TEST	= (1U << 0),
 	RP_GTEST_SYSCALL_SET_QT			= (1U << 1),
 	RP_GTEST_SYSCALL_SET_GTK		= (1U << 2),
+	RP_GTEST_SYSCALL_SET_FILE_WRITE		= (1U << 3),
+	RP_GTEST_SYSCALL_SET_NETWORK		= (1U << 4),
+	RP_GTEST_SYSCALL_SET_SPAWN		= (1U << 5),
 } RP_GTest_Syscall_Set_e;
 
 #endif /* HAVE_SECCOMP */
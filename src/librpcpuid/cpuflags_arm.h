@@ -71,6 +71,7 @@ static RP_FORCEINLINE int RP_CPU_arm_Has##flag(void) \
 #endif /* RP_CPU_ARM64 */
 
 CPU_FLAG_ARM_CHECK_arm32only(NEON)
+CPU_FLAG_ARM_CHECK(AES)
 
 #endif /* RP_CPU_ARM || RP_CPU_ARM64 */
 
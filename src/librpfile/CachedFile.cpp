@@ -0,0 +1,377 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * CachedFile.cpp: Block-caching wrapper for slow IRpFile backends.        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "CachedFile.hpp"
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+using std::vector;
+
+// CachedFile isn't used by libromdata directly,
+// so use some linker hax to force linkage.
+extern "C" {
+	extern unsigned char RP_LibRpFile_CachedFile_ForceLinkage;
+	unsigned char RP_LibRpFile_CachedFile_ForceLinkage;
+}
+
+namespace LibRpFile {
+
+/**
+ * Wrap an IRpFile with a block cache.
+ * The resulting IRpFile is read-only.
+ *
+ * This is intended for IRpFile backends where each read is a
+ * round-trip to a remote server, e.g. KIO and GVfs. Reads are
+ * aligned to the block size, recently-used blocks are kept in
+ * memory, and sequential reads enable read-ahead.
+ *
+ * @param file		[in] Underlying file
+ * @param blockSize	[in] Block size, in bytes (must be a power of two)
+ * @param maxBlocks	[in] Maximum number of blocks to keep in memory
+ */
+CachedFile::CachedFile(const IRpFilePtr &file, unsigned int blockSize, unsigned int maxBlocks)
+	: m_file(file)
+	, m_fileSize(0)
+	, m_pos(0)
+	, m_blockSize(blockSize)
+	, m_maxBlocks(maxBlocks)
+	, m_lastReadEnd(-1)
+	, m_readAhead(0)
+	, m_stats{}
+{
+	assert(blockSize != 0 && (blockSize & (blockSize - 1)) == 0);
+	assert(maxBlocks >= 2);
+	if (m_blockSize == 0 || (m_blockSize & (m_blockSize - 1)) != 0) {
+		m_blockSize = DEFAULT_BLOCK_SIZE;
+	}
+	if (m_maxBlocks < 2) {
+		m_maxBlocks = 2;
+	}
+
+	assert((bool)file);
+	if (!file || !file->isOpen()) {
+		// No file...
+		m_lastError = (file ? file->lastError() : EBADF);
+		if (m_lastError == 0) {
+			m_lastError = EBADF;
+		}
+		m_file.reset();
+		return;
+	}
+
+	m_fileSize = file->size();
+	if (m_fileSize < 0) {
+		// Unable to get the file size.
+		m_lastError = file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
+		m_file.reset();
+		m_fileSize = 0;
+		return;
+	}
+
+	m_isCompressed = file->isCompressed();
+	m_fileType = file->fileType();
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool CachedFile::isOpen(void) const
+{
+	return (bool)m_file;
+}
+
+/**
+ * Close the file.
+ */
+void CachedFile::close(void)
+{
+	m_file.reset();
+	m_blocks.clear();
+	m_blockMap.clear();
+
+	m_fileSize = 0;
+	m_pos = 0;
+	m_lastReadEnd = -1;
+	m_readAhead = 0;
+}
+
+/**
+ * Read data directly from the underlying file.
+ * @param pos	[in] File position
+ * @param ptr	[out] Output data buffer
+ * @param size	[in] Amount of data to read, in bytes
+ * @return Number of bytes read.
+ */
+size_t CachedFile::readDirect(off64_t pos, void *ptr, size_t size)
+{
+	m_stats.fileReads++;
+	const size_t sz_read = m_file->seekAndRead(pos, ptr, size);
+	m_stats.fileBytes += sz_read;
+	if (sz_read != size) {
+		m_lastError = m_file->lastError();
+	}
+	return sz_read;
+}
+
+/**
+ * Get a block, reading it from the underlying file if it isn't cached.
+ * If the block isn't cached, this block and any uncached blocks up to
+ * lastIndex (plus read-ahead) are read using a single read.
+ * @param index		[in] Block index
+ * @param lastIndex	[in] Last block index needed by the current read()
+ * @return Block, or nullptr on error.
+ */
+const CachedFile::Block *CachedFile::getBlock(uint64_t index, uint64_t lastIndex)
+{
+	auto iter = m_blockMap.find(index);
+	if (iter != m_blockMap.end()) {
+		// Block is cached. Move it to the front of the LRU list.
+		m_stats.hits++;
+		m_blocks.splice(m_blocks.begin(), m_blocks, iter->second);
+		return &(*iter->second);
+	}
+
+	// Block is not cached.
+	// Read this block and any following uncached blocks that are
+	// needed by the current read(), plus read-ahead, at once.
+	// No more than half of the cache is replaced by a single read.
+	const uint64_t fileBlocks = (static_cast<uint64_t>(m_fileSize) + m_blockSize - 1) / m_blockSize;
+	const uint64_t maxFetch = m_maxBlocks / 2;
+	uint64_t endIndex = index;	// exclusive
+	do {
+		endIndex++;
+	} while (endIndex < fileBlocks &&
+	         endIndex <= lastIndex + m_readAhead &&
+	         (endIndex - index) < maxFetch &&
+	         m_blockMap.find(endIndex) == m_blockMap.end());
+
+	const off64_t pos = static_cast<off64_t>(index * m_blockSize);
+	off64_t end = static_cast<off64_t>(endIndex * m_blockSize);
+	if (end > m_fileSize) {
+		end = m_fileSize;
+	}
+	if (pos >= end) {
+		// Past EOF.
+		return nullptr;
+	}
+
+	vector<uint8_t> buf(static_cast<size_t>(end - pos));
+	const size_t sz_read = readDirect(pos, buf.data(), buf.size());
+	if (sz_read == 0) {
+		// Read error.
+		return nullptr;
+	}
+
+	// If the read was short, the last block is incomplete.
+	// Don't cache it, since the rest of the block might be
+	// readable later.
+	uint64_t readBlocks = (sz_read + m_blockSize - 1) / m_blockSize;
+	const size_t lastOffset = static_cast<size_t>((readBlocks - 1) * m_blockSize);
+	const off64_t lastExpected = std::min(static_cast<off64_t>(m_blockSize), m_fileSize - (pos + static_cast<off64_t>(lastOffset)));
+	if (static_cast<off64_t>(sz_read - lastOffset) < lastExpected) {
+		readBlocks--;
+		if (readBlocks == 0) {
+			// The requested block is incomplete.
+			// Return it without caching it.
+			m_stats.misses++;
+			m_partialBlock.index = index;
+			m_partialBlock.data.assign(buf.data(), buf.data() + sz_read);
+			return &m_partialBlock;
+		}
+	}
+
+	// Split the data into blocks.
+	// Blocks are inserted in reverse order so the requested
+	// block ends up at the front of the LRU list.
+	for (uint64_t i = readBlocks; i > 0; i--) {
+		const size_t offset = static_cast<size_t>((i - 1) * m_blockSize);
+		const size_t len = std::min(static_cast<size_t>(m_blockSize), sz_read - offset);
+
+		m_blocks.emplace_front();
+		Block &block = m_blocks.front();
+		block.index = index + (i - 1);
+		block.data.assign(buf.data() + offset, buf.data() + offset + len);
+		m_blockMap.emplace(block.index, m_blocks.begin());
+	}
+
+	m_stats.misses++;
+	if (readBlocks > (lastIndex - index + 1)) {
+		m_stats.readAhead += readBlocks - (lastIndex - index + 1);
+	}
+
+	// Evict the least-recently used blocks.
+	while (m_blocks.size() > m_maxBlocks) {
+		m_blockMap.erase(m_blocks.back().index);
+		m_blocks.pop_back();
+	}
+
+	return &m_blocks.front();
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CachedFile::read(void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	m_stats.reads++;
+	if (unlikely(size == 0) || m_pos >= m_fileSize) {
+		// Not reading anything...
+		return 0;
+	}
+	if (static_cast<off64_t>(size) > m_fileSize - m_pos) {
+		size = static_cast<size_t>(m_fileSize - m_pos);
+	}
+
+	// Adaptive read-ahead: If this read continues the previous read,
+	// double the read-ahead window. Otherwise, disable read-ahead.
+	if (m_pos == m_lastReadEnd) {
+		m_readAhead = (m_readAhead == 0) ? 1 : std::min(m_readAhead * 2, MAX_READAHEAD_BLOCKS);
+	} else {
+		m_readAhead = 0;
+	}
+
+	if (size > static_cast<size_t>(m_maxBlocks / 2) * m_blockSize) {
+		// Read is too large for the cache. Read it directly.
+		const size_t sz_read = readDirect(m_pos, ptr, size);
+		m_pos += sz_read;
+		m_lastReadEnd = m_pos;
+		return sz_read;
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	const uint64_t lastIndex = static_cast<uint64_t>(m_pos + size - 1) / m_blockSize;
+	size_t total = 0;
+	while (size > 0) {
+		const uint64_t index = static_cast<uint64_t>(m_pos) / m_blockSize;
+		const size_t offset = static_cast<size_t>(m_pos & (m_blockSize - 1));
+
+		const Block *const block = getBlock(index, lastIndex);
+		if (!block || offset >= block->data.size()) {
+			// Read error or short read.
+			break;
+		}
+
+		const size_t len = std::min(size, block->data.size() - offset);
+		memcpy(ptr8, &block->data[offset], len);
+		ptr8 += len;
+		size -= len;
+		total += len;
+		m_pos += len;
+
+		if (block->data.size() < m_blockSize && offset + len >= block->data.size()) {
+			// End of a short block: either EOF or a short read.
+			break;
+		}
+	}
+
+	m_lastReadEnd = m_pos;
+	return total;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for CachedFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t CachedFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for CachedFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos		[in] File position
+ * @param whence	[in] Where to seek from
+ * @return 0 on success; -1 on error.
+ */
+int CachedFile::seek(off64_t pos, SeekWhence whence)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	// NOTE: The underlying file is only seeked when reading.
+	pos = adjust_file_pos_for_whence(pos, whence, m_pos, m_fileSize);
+	m_pos = constrain_file_pos(pos, m_fileSize);
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t CachedFile::tell(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_pos;
+}
+
+/** File properties **/
+
+/**
+ * Get the file size.
+ * NOTE: The file size is retrieved once, when the file is opened.
+ * @return File size, or negative on error.
+ */
+off64_t CachedFile::size(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_fileSize;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be nullptr if the filename is not available.)
+ */
+const char *CachedFile::filename(void) const
+{
+	return (m_file) ? m_file->filename() : nullptr;
+}
+
+/**
+ * Get the file modification time.
+ * @return File modification time, or -1 if not available.
+ */
+time_t CachedFile::mtime(void)
+{
+	return (m_file) ? m_file->mtime() : -1;
+}
+
+}
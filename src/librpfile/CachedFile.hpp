@@ -0,0 +1,202 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * CachedFile.hpp: Block-caching wrapper for slow IRpFile backends.        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "IRpFile.hpp"
+
+// C++ includes
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace LibRpFile {
+
+class RP_LIBROMDATA_PUBLIC CachedFile final : public IRpFile
+{
+public:
+	/**
+	 * Wrap an IRpFile with a block cache.
+	 * The resulting IRpFile is read-only.
+	 *
+	 * This is intended for IRpFile backends where each read is a
+	 * round-trip to a remote server, e.g. KIO and GVfs. Reads are
+	 * aligned to the block size, recently-used blocks are kept in
+	 * memory, and sequential reads enable read-ahead.
+	 *
+	 * @param file		[in] Underlying file
+	 * @param blockSize	[in] Block size, in bytes (must be a power of two)
+	 * @param maxBlocks	[in] Maximum number of blocks to keep in memory
+	 */
+	explicit CachedFile(const IRpFilePtr &file,
+		unsigned int blockSize = DEFAULT_BLOCK_SIZE,
+		unsigned int maxBlocks = DEFAULT_MAX_BLOCKS);
+
+private:
+	typedef IRpFile super;
+public:
+	RP_DISABLE_COPY(CachedFile)
+
+public:
+	// Default block size (64 KiB)
+	static constexpr unsigned int DEFAULT_BLOCK_SIZE = 64U * 1024U;
+	// Default maximum number of cached blocks (2 MiB with 64 KiB blocks)
+	static constexpr unsigned int DEFAULT_MAX_BLOCKS = 32;
+	// Maximum number of blocks to read ahead for sequential reads
+	static constexpr unsigned int MAX_READAHEAD_BLOCKS = 8;
+
+public:
+	/**
+	 * Is the file open?
+	 * This usually only returns false if an error occurred.
+	 * @return True if the file is open; false if it isn't.
+	 */
+	bool isOpen(void) const final;
+
+	/**
+	 * Close the file.
+	 */
+	void close(void) final;
+
+	/**
+	 * Read data from the file.
+	 * @param ptr Output data buffer.
+	 * @param size Amount of data to read, in bytes.
+	 * @return Number of bytes read.
+	 */
+	ATTR_ACCESS_SIZE(write_only, 2, 3)
+	size_t read(void *ptr, size_t size) final;
+
+	/**
+	 * Write data to the file.
+	 * (NOTE: Not valid for CachedFile; this will always return 0.)
+	 * @param ptr Input data buffer.
+	 * @param size Amount of data to read, in bytes.
+	 * @return Number of bytes written.
+	 */
+	ATTR_ACCESS_SIZE(read_only, 2, 3)
+	size_t write(const void *ptr, size_t size) final;
+
+	/**
+	 * Set the file position.
+	 * @param pos		[in] File position
+	 * @param whence	[in] Where to seek from
+	 * @return 0 on success; -1 on error.
+	 */
+	int seek(off64_t pos, SeekWhence whence) final;
+
+	/**
+	 * Get the file position.
+	 * @return File position, or -1 on error.
+	 */
+	off64_t tell(void) final;
+
+public:
+	/** File properties **/
+
+	/**
+	 * Get the file size.
+	 * NOTE: The file size is retrieved once, when the file is opened.
+	 * @return File size, or negative on error.
+	 */
+	off64_t size(void) final;
+
+	/**
+	 * Get the filename.
+	 * @return Filename. (May be nullptr if the filename is not available.)
+	 */
+	const char *filename(void) const final;
+
+	/**
+	 * Get the file modification time.
+	 * @return File modification time, or -1 if not available.
+	 */
+	time_t mtime(void) final;
+
+public:
+	/** Statistics **/
+
+	struct Stats {
+		uint64_t reads;		// Number of read() calls
+		uint64_t hits;		// Number of blocks read from the cache
+		uint64_t misses;	// Number of blocks read from the underlying file
+		uint64_t readAhead;	// Number of blocks read ahead
+		uint64_t fileReads;	// Number of reads from the underlying file
+		uint64_t fileBytes;	// Number of bytes read from the underlying file
+	};
+
+	/**
+	 * Get the cache statistics.
+	 * @return Cache statistics
+	 */
+	inline const Stats &stats(void) const
+	{
+		return m_stats;
+	}
+
+	/**
+	 * Get the number of round-trips to the underlying file that were
+	 * saved by the cache, i.e. read() calls that didn't need a read
+	 * from the underlying file.
+	 * @return Number of round-trips saved
+	 */
+	inline uint64_t roundTripsSaved(void) const
+	{
+		return (m_stats.reads > m_stats.fileReads)
+			? (m_stats.reads - m_stats.fileReads)
+			: 0;
+	}
+
+private:
+	struct Block {
+		uint64_t index;			// Block index
+		std::vector<uint8_t> data;	// Block data (may be short at EOF)
+	};
+
+	/**
+	 * Get a block, reading it from the underlying file if it isn't cached.
+	 * If the block isn't cached, this block and any uncached blocks up to
+	 * lastIndex (plus read-ahead) are read using a single read.
+	 * @param index		[in] Block index
+	 * @param lastIndex	[in] Last block index needed by the current read()
+	 * @return Block, or nullptr on error.
+	 */
+	const Block *getBlock(uint64_t index, uint64_t lastIndex);
+
+	/**
+	 * Read data directly from the underlying file.
+	 * @param pos	[in] File position
+	 * @param ptr	[out] Output data buffer
+	 * @param size	[in] Amount of data to read, in bytes
+	 * @return Number of bytes read.
+	 */
+	size_t readDirect(off64_t pos, void *ptr, size_t size);
+
+private:
+	IRpFilePtr m_file;
+	off64_t m_fileSize;
+	off64_t m_pos;
+
+	unsigned int m_blockSize;
+	unsigned int m_maxBlocks;
+
+	// Block cache (most-recently used first)
+	std::list<Block> m_blocks;
+	std::unordered_map<uint64_t, std::list<Block>::iterator> m_blockMap;
+	Block m_partialBlock;	// Incomplete block from a short read (not cached)
+
+	// Read-ahead
+	off64_t m_lastReadEnd;		// End of the previous read(), or -1
+	unsigned int m_readAhead;	// Current number of read-ahead blocks
+
+	Stats m_stats;
+};
+
+typedef std::shared_ptr<CachedFile> CachedFilePtr;
+
+}
@@ -8,11 +8,197 @@
 
 #include "IRpFile.hpp"
 
+// C includes (C++ namespace)
+#include <cassert>
+
 // C++ STL classes
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+using std::array;
 using std::unique_ptr;
 
 namespace LibRpFile {
 
+namespace {
+
+// Buffer size for copyTo()
+constexpr size_t COPYTO_BUFFER_SIZE = 1024U * 1024U;
+// Minimum size for copyTo_pipelined()
+constexpr size_t COPYTO_PIPELINE_MIN_SIZE = 4U * COPYTO_BUFFER_SIZE;
+
+/**
+ * Copy data from one IRpFile to another IRpFile using a single buffer.
+ * @param pSrcFile	[in] Source IRpFile
+ * @param pDestFile	[in] Destination IRpFile
+ * @param size		[in] Number of bytes to copy
+ * @param cbReadTotal	[in/out] Total number of bytes read
+ * @param cbWrittenTotal [in/out] Total number of bytes written
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int copyTo_buffered(IRpFile *pSrcFile, IRpFile *pDestFile, off64_t size,
+	off64_t &cbReadTotal, off64_t &cbWrittenTotal)
+{
+	const size_t buf_size = static_cast<size_t>(std::min(size, static_cast<off64_t>(COPYTO_BUFFER_SIZE)));
+	unique_ptr<uint8_t[]> buf(new uint8_t[buf_size]);
+
+	while (size > 0) {
+		int ret = 0;
+		const size_t toRead = static_cast<size_t>(std::min(size, static_cast<off64_t>(buf_size)));
+		const size_t cbRead = pSrcFile->read(buf.get(), toRead);
+		cbReadTotal += cbRead;
+		if (cbRead != toRead) {
+			// Short read. We'll continue with a final write.
+			ret = -pSrcFile->lastError();
+			if (ret == 0) {
+				ret = -EIO;
+			}
+		}
+
+		if (cbRead > 0) {
+			const size_t cbWritten = pDestFile->write(buf.get(), cbRead);
+			cbWrittenTotal += cbWritten;
+			if (cbWritten != cbRead) {
+				// Short write.
+				ret = -pDestFile->lastError();
+				if (ret == 0) {
+					ret = -EIO;
+				}
+			}
+		}
+
+		if (ret != 0) {
+			return ret;
+		}
+		size -= cbRead;
+	}
+
+	return 0;
+}
+
+/**
+ * Copy data from one IRpFile to another IRpFile using two buffers.
+ * Each buffer is written on a separate thread while the next buffer
+ * is being read on the calling thread.
+ * @param pSrcFile	[in] Source IRpFile
+ * @param pDestFile	[in] Destination IRpFile
+ * @param size		[in] Number of bytes to copy
+ * @param cbReadTotal	[in/out] Total number of bytes read
+ * @param cbWrittenTotal [in/out] Total number of bytes written
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int copyTo_pipelined(IRpFile *pSrcFile, IRpFile *pDestFile, off64_t size,
+	off64_t &cbReadTotal, off64_t &cbWrittenTotal)
+{
+	struct Buffer {
+		unique_ptr<uint8_t[]> data;
+		size_t len;	// Amount of data in the buffer
+		bool full;	// True if the buffer is waiting to be written
+	};
+	array<Buffer, 2> bufs;
+	for (Buffer &buf : bufs) {
+		buf.data.reset(new uint8_t[COPYTO_BUFFER_SIZE]);
+		buf.len = 0;
+		buf.full = false;
+	}
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool readDone = false;	// Set when the calling thread is done reading
+	int writeErr = 0;	// Set by the writer thread on error
+
+	// Writer thread. Buffers are written in the order they're filled.
+	auto writer = [&]() {
+		for (unsigned int i = 0;; i ^= 1) {
+			Buffer &buf = bufs[i];
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cv.wait(lock, [&] { return buf.full || readDone; });
+				if (!buf.full) {
+					// No more data.
+					break;
+				}
+			}
+
+			const size_t cbWritten = pDestFile->write(buf.data.get(), buf.len);
+
+			std::lock_guard<std::mutex> lock(mtx);
+			cbWrittenTotal += cbWritten;
+			buf.full = false;
+			if (cbWritten != buf.len) {
+				// Short write.
+				writeErr = -pDestFile->lastError();
+				if (writeErr == 0) {
+					writeErr = -EIO;
+				}
+				cv.notify_all();
+				break;
+			}
+			cv.notify_all();
+		}
+	};
+
+	std::thread writerThread;
+	try {
+		writerThread = std::thread(writer);
+	} catch (const std::system_error&) {
+		// Unable to start a thread.
+		return copyTo_buffered(pSrcFile, pDestFile, size, cbReadTotal, cbWrittenTotal);
+	}
+
+	// Read the data on this thread.
+	int ret = 0;
+	for (unsigned int i = 0; size > 0; i ^= 1) {
+		Buffer &buf = bufs[i];
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			cv.wait(lock, [&] { return !buf.full || writeErr != 0; });
+			if (writeErr != 0) {
+				break;
+			}
+		}
+
+		const size_t toRead = static_cast<size_t>(std::min(size, static_cast<off64_t>(COPYTO_BUFFER_SIZE)));
+		const size_t cbRead = pSrcFile->read(buf.data.get(), toRead);
+		cbReadTotal += cbRead;
+		if (cbRead != toRead) {
+			// Short read. We'll continue with a final write.
+			ret = -pSrcFile->lastError();
+			if (ret == 0) {
+				ret = -EIO;
+			}
+			size = 0;
+		} else {
+			size -= cbRead;
+		}
+
+		if (cbRead > 0) {
+			std::lock_guard<std::mutex> lock(mtx);
+			buf.len = cbRead;
+			buf.full = true;
+			cv.notify_all();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		readDone = true;
+		cv.notify_all();
+	}
+	writerThread.join();
+
+	if (writeErr != 0) {
+		// Write errors take precedence over read errors.
+		ret = writeErr;
+	}
+	return ret;
+}
+
+}
+
 IRpFile::IRpFile()
 	: m_lastError(0)
 	, m_isWritable(false)
@@ -25,6 +211,12 @@ IRpFile::IRpFile()
 /**
  * Copy data from this IRpFile to another IRpFile.
  * Read/write positions must be set before calling this function.
+ *
+ * copyToDirect() is used if both files support it. Otherwise,
+ * large copies write each block on a separate thread while the
+ * next block is being read, so the source and destination files
+ * must not share an underlying file.
+ *
  * @param pDestFile	[in] Destination IRpFile.
  * @param size		[in] Number of bytes to copy.
  * @param pcbRead	[out,opt] Number of bytes read.
@@ -43,37 +235,23 @@ int IRpFile::copyTo(IRpFile *pDestFile, off64_t size,
 	off64_t cbReadTotal = 0;
 	off64_t cbWrittenTotal = 0;
 
-	// Read buffer
-	static constexpr size_t COPYTO_BUFFER_SIZE = 64U * 1024U;
-	unique_ptr<uint8_t[]> buf(new uint8_t[COPYTO_BUFFER_SIZE]);
-
-	// Copy the data.
-	for (; size > 0; size -= COPYTO_BUFFER_SIZE) {
-		const size_t cbRead = this->read(buf.get(), COPYTO_BUFFER_SIZE);
-		cbReadTotal += cbRead;
-		if (cbRead != COPYTO_BUFFER_SIZE &&
-		    (size < static_cast<off64_t>(COPYTO_BUFFER_SIZE) && cbRead != static_cast<size_t>(size)))
-		{
-			// Short read. We'll continue with a final write.
-			ret = -this->m_lastError;
-			if (ret == 0) {
-				ret = -EIO;
-			}
-			size = 0;
-			if (cbRead == 0)
-				break;
-		}
+	if (size > 0) {
+		// Attempt to copy the data directly.
+		// NOTE: If the direct copy fails partway through, the rest of
+		// the data is copied using the buffered path, which will report
+		// the error if it occurs again.
+		off64_t cbCopied = 0;
+		this->copyToDirect(pDestFile, size, &cbCopied);
+		assert(cbCopied >= 0 && cbCopied <= size);
+		cbReadTotal = cbCopied;
+		cbWrittenTotal = cbCopied;
+		size -= cbCopied;
+	}
 
-		const size_t cbWritten = pDestFile->write(buf.get(), cbRead);
-		cbWrittenTotal += cbWritten;
-		if (cbWritten != cbRead) {
-			// Short write.
-			ret = -pDestFile->m_lastError;
-			if (ret == 0) {
-				ret = -EIO;
-			}
-			break;
-		}
+	if (size >= static_cast<off64_t>(COPYTO_PIPELINE_MIN_SIZE)) {
+		ret = copyTo_pipelined(this, pDestFile, size, cbReadTotal, cbWrittenTotal);
+	} else if (size > 0) {
+		ret = copyTo_buffered(this, pDestFile, size, cbReadTotal, cbWrittenTotal);
 	}
 
 	if (pcbRead) {
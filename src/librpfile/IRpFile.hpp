@@ -235,6 +235,65 @@ public:
 		return -ENOTSUP;
 	}
 
+	/**
+	 * Get a read-only pointer to the file data at the specified address,
+	 * if this file supports zero-copy access. (e.g. memory-mapped files)
+	 *
+	 * The returned pointer is borrowed from this IRpFile, and it's only
+	 * valid until the file is closed, made writable, or destroyed.
+	 * The file position is not changed.
+	 *
+	 * @param pos		[in] Requested address
+	 * @param size		[in] Requested size, in bytes
+	 * @param pcbAvail	[out] Number of bytes available at the returned pointer (may be less than size at EOF)
+	 * @return Pointer to the file data, or nullptr if zero-copy access isn't available.
+	 */
+	virtual const uint8_t *peek(off64_t pos, size_t size, size_t *pcbAvail)
+	{
+		RP_UNUSED(pos);
+		RP_UNUSED(size);
+		RP_UNUSED(pcbAvail);
+		return nullptr;
+	}
+
+	/**
+	 * Copy data from this IRpFile to another IRpFile without using
+	 * an intermediate buffer, if supported by both files.
+	 * (e.g. reflinks, copy_file_range(), or sendfile())
+	 *
+	 * This is called by copyTo(). It usually shouldn't be called directly.
+	 * Read/write positions must be set before calling this function,
+	 * and both positions are advanced by the number of bytes copied.
+	 *
+	 * @param pDestFile	[in] Destination IRpFile
+	 * @param size		[in] Number of bytes to copy
+	 * @param pcbCopied	[out] Number of bytes copied (may be less than size at EOF)
+	 * @return 0 on success; -ENOTSUP if not supported for these files; other negative POSIX error code on error.
+	 */
+	virtual int copyToDirect(IRpFile *pDestFile, off64_t size, off64_t *pcbCopied)
+	{
+		RP_UNUSED(pDestFile);
+		RP_UNUSED(size);
+		*pcbCopied = 0;
+		return -ENOTSUP;
+	}
+
+	/**
+	 * Preallocate disk space for part of the file.
+	 * The file size and contents are not changed.
+	 * This is only a hint; the space will still be
+	 * allocated when the data is written.
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Number of bytes to preallocate
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	virtual int preallocate(off64_t pos, off64_t size)
+	{
+		RP_UNUSED(pos);
+		RP_UNUSED(size);
+		return -ENOTSUP;
+	}
+
 public:
 	/** Convenience functions implemented for all IRpFile subclasses **/
 
@@ -277,6 +336,12 @@ public:
 	/**
 	 * Copy data from this IRpFile to another IRpFile.
 	 * Read/write positions must be set before calling this function.
+	 *
+	 * copyToDirect() is used if both files support it. Otherwise,
+	 * large copies write each block on a separate thread while the
+	 * next block is being read, so the source and destination files
+	 * must not share an underlying file.
+	 *
 	 * @param pDestFile	[in] Destination IRpFile.
 	 * @param size		[in] Number of bytes to copy.
 	 * @param pcbRead	[out,opt] Number of bytes read.
@@ -119,6 +119,32 @@ public:
 		return m_filename;
 	}
 
+public:
+	/** Extra functions **/
+
+	/**
+	 * Get a read-only pointer to the file data at the specified address.
+	 *
+	 * The returned pointer is borrowed from this MemFile, and it's only
+	 * valid until the file is closed or destroyed.
+	 * The file position is not changed.
+	 *
+	 * @param pos		[in] Requested address
+	 * @param size		[in] Requested size, in bytes
+	 * @param pcbAvail	[out] Number of bytes available at the returned pointer (may be less than size at EOF)
+	 * @return Pointer to the file data, or nullptr on error.
+	 */
+	const uint8_t *peek(off64_t pos, size_t size, size_t *pcbAvail) final
+	{
+		if (!m_buf || pos < 0 || static_cast<uint64_t>(pos) >= m_size) {
+			return nullptr;
+		}
+
+		const size_t avail = m_size - static_cast<size_t>(pos);
+		*pcbAvail = (size < avail) ? size : avail;
+		return static_cast<const uint8_t*>(m_buf) + pos;
+	}
+
 public:
 	/** MemFile functions **/
 
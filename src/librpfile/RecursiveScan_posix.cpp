@@ -37,7 +37,7 @@ namespace LibRpFile {
 
 /**
  * Recursively scan a directory for cache files to delete.
- * This finds *.png, *.jpg, *.jxl, and "version.txt".
+ * This finds *.png, *.jpg, *.jxl, "version.txt", and cache index files.
  *
  * POSIX implementation: Uses readdir().
  *
@@ -159,8 +159,14 @@ int recursiveScan(const TCHAR *path, forward_list<pair<tstring, uint8_t> > &rlis
 				return -EIO;
 			}
 
+			// Cache index files can be deleted.
+			if (len > 9 && !strcasecmp(&dirent->d_name[len-9], ".idx.lock")) {
+				goto isok;
+			}
+
 			const char *pExt = &dirent->d_name[len-4];
-			if (strcasecmp(pExt, ".png") != 0 &&
+			if (strcasecmp(pExt, ".idx") != 0 &&
+			    strcasecmp(pExt, ".png") != 0 &&
 			    strcasecmp(pExt, ".jpg") != 0 &&
 			    strcasecmp(pExt, ".jxl") != 0 &&
 			    strcasecmp(dirent->d_name, "version.txt") != 0)
@@ -53,6 +53,8 @@ public:
 		// Extras.
 		FM_GZIP_DECOMPRESS = 4,	// Transparent gzip decompression. (read-only!)
 		FM_OPEN_READ_GZ = FM_READ | FM_GZIP_DECOMPRESS,
+		FM_MMAP = 8,		// Allow zero-copy reads using peek(). (read-only; not on Windows)
+		FM_OPEN_READ_GZ_MMAP = FM_OPEN_READ_GZ | FM_MMAP,
 	};
 
 	/**
@@ -205,6 +207,52 @@ public:
 	 */
 	int makeWritable(void) final;
 
+#ifndef _WIN32
+	/**
+	 * Get a read-only pointer to the file data at the specified address,
+	 * if this file supports zero-copy access.
+	 *
+	 * This requires FM_MMAP, and is only available for uncompressed
+	 * regular files that are opened as read-only.
+	 *
+	 * The returned pointer is borrowed from this RpFile, and it's only
+	 * valid until the file is closed, made writable, or destroyed.
+	 * The file position is not changed.
+	 *
+	 * @param pos		[in] Requested address
+	 * @param size		[in] Requested size, in bytes
+	 * @param pcbAvail	[out] Number of bytes available at the returned pointer (may be less than size at EOF)
+	 * @return Pointer to the file data, or nullptr if zero-copy access isn't available.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	const uint8_t *peek(off64_t pos, size_t size, size_t *pcbAvail) final;
+
+	/**
+	 * Copy data from this RpFile to another RpFile without using
+	 * an intermediate buffer.
+	 *
+	 * Reflinks (FICLONERANGE) are tried first, followed by copy_file_range()
+	 * and sendfile(). Both files must be uncompressed regular files.
+	 *
+	 * @param pDestFile	[in] Destination IRpFile
+	 * @param size		[in] Number of bytes to copy
+	 * @param pcbCopied	[out] Number of bytes copied (may be less than size at EOF)
+	 * @return 0 on success; -ENOTSUP if not supported for these files; other negative POSIX error code on error.
+	 */
+	int copyToDirect(IRpFile *pDestFile, off64_t size, off64_t *pcbCopied) final;
+
+	/**
+	 * Preallocate disk space for part of the file.
+	 * The file size and contents are not changed.
+	 * This is only a hint; the space will still be
+	 * allocated when the data is written.
+	 * @param pos	[in] Starting position
+	 * @param size	[in] Number of bytes to preallocate
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int preallocate(off64_t pos, off64_t size) final;
+#endif /* !_WIN32 */
+
 public:
 	/** Device file functions **/
 
@@ -84,6 +84,20 @@ public:
 	gzFile gzfd;		// Used for transparent gzip decompression.
 	off64_t gzsz;		// Uncompressed file size.
 
+#ifndef _WIN32
+	// pread() mode: Used for uncompressed regular files opened as read-only.
+	// The stdio file position is not used in this mode.
+	off64_t pos;		// Current file position
+	off64_t fileSize;	// File size (cached on open)
+	bool usePread;		// True if pread() mode is active
+
+	// Read-only memory map for peek(). (FM_MMAP only)
+	// Mapped on the first call to peek().
+	bool mapFailed;		// True if mmap() failed; don't try again.
+	size_t mapSize;		// Size of the memory map
+	void *pMap;		// Memory map
+#endif /* !_WIN32 */
+
 public:
 	// Device information struct.
 	// Only used if the underlying file
@@ -187,6 +201,21 @@ public:
 	 */
 	int reOpenFile(void);
 
+#ifndef _WIN32
+	/**
+	 * Enable pread() mode if this is an uncompressed regular file
+	 * that was opened as read-only.
+	 *
+	 * INTERNAL FUNCTION. Call this after gzip detection.
+	 */
+	void initPreadMode(void);
+
+	/**
+	 * Unmap the memory map, if it's mapped.
+	 */
+	void unmap(void);
+#endif /* !_WIN32 */
+
 public:
 	/**
 	 * Read one sector into the sector cache.
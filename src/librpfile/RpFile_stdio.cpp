@@ -23,11 +23,19 @@
 
 // C includes
 #include <fcntl.h>	// fcntl(), F_GETFD, F_SETFD
+#include <sys/mman.h>	// mmap(), munmap()
 #include <sys/stat.h>	// stat(), statx()
-#include <unistd.h>	// ftruncate()
+#include <unistd.h>	// ftruncate(), pread(), copy_file_range()
 #include "tcharx.h"
 
+#ifdef __linux__
+#  include <linux/fs.h>		// FICLONERANGE
+#  include <sys/ioctl.h>	// ioctl()
+#  include <sys/sendfile.h>	// sendfile()
+#endif /* __linux__ */
+
 // C++ STL classes
+#include <algorithm>
 using std::string;
 
 namespace LibRpFile {
@@ -37,6 +45,8 @@ namespace LibRpFile {
 RpFilePrivate::RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode mode)
 	: q_ptr(q), file(nullptr)
 	, mode(mode), gzfd(nullptr), gzsz(-1)
+	, pos(0), fileSize(-1), usePread(false)
+	, mapFailed(false), mapSize(0), pMap(nullptr)
 {
 	assert(filename != nullptr);
 	this->filename.assign(filename);
@@ -44,6 +54,7 @@ RpFilePrivate::RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode m
 
 RpFilePrivate::~RpFilePrivate()
 {
+	unmap();
 	if (gzfd != nullptr) {
 		gzclose_r(gzfd);
 	}
@@ -233,6 +244,45 @@ int RpFilePrivate::reOpenFile(void)
 	return 0;
 }
 
+/**
+ * Enable pread() mode if this is an uncompressed regular file
+ * that was opened as read-only.
+ *
+ * INTERNAL FUNCTION. Call this after gzip detection.
+ */
+void RpFilePrivate::initPreadMode(void)
+{
+	RP_Q(const RpFile);
+	usePread = false;
+	if (!file || gzfd || devInfo || (mode & RpFile::FM_WRITE) ||
+	    q->fileType() != DT_REG)
+	{
+		return;
+	}
+
+	// Cache the file size. Read-only files are assumed to not
+	// change size while they're open.
+	struct stat sb;
+	if (fstat(fileno(file), &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		return;
+	}
+	fileSize = sb.st_size;
+	pos = 0;
+	usePread = true;
+}
+
+/**
+ * Unmap the memory map, if it's mapped.
+ */
+void RpFilePrivate::unmap(void)
+{
+	if (pMap) {
+		munmap(pMap, mapSize);
+		pMap = nullptr;
+		mapSize = 0;
+	}
+}
+
 /** RpFile **/
 
 /**
@@ -264,7 +314,7 @@ RpFile::RpFile(const char *filename, FileMode mode)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	const bool tryGzip = (d->mode == FM_OPEN_READ_GZ);
+	const bool tryGzip = ((d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ);
 	if (tryGzip) { do {
 		uint16_t gzmagic;
 		size_t size = fread(&gzmagic, 1, sizeof(gzmagic), d->file);
@@ -315,6 +365,9 @@ RpFile::RpFile(const char *filename, FileMode mode)
 		::rewind(d->file);
 		::fflush(d->file);
 	}
+
+	// Use pread() for uncompressed read-only files.
+	d->initPreadMode();
 }
 
 /**
@@ -358,6 +411,9 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
+	d->unmap();
+	d->usePread = false;
+
 	if (d->gzfd != nullptr) {
 		gzclose_r(d->gzfd);
 		d->gzfd = nullptr;
@@ -387,6 +443,31 @@ size_t RpFile::read(void *ptr, size_t size)
 		return d->readUsingBlocks(ptr, size);
 	}
 
+	if (d->usePread) {
+		// pread() mode. Loop in case of short reads.
+		uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+		size_t ret = 0;
+		while (size > 0) {
+			const ssize_t sret = pread(fileno(d->file), ptr8, size, d->pos);
+			if (sret < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				// An error occurred.
+				m_lastError = errno;
+				break;
+			} else if (sret == 0) {
+				// End of file.
+				break;
+			}
+			ptr8 += sret;
+			size -= sret;
+			ret += sret;
+			d->pos += sret;
+		}
+		return ret;
+	}
+
 	size_t ret;
 	if (d->gzfd != nullptr) {
 		int iret = gzread(d->gzfd, ptr, size);
@@ -452,6 +533,15 @@ int RpFile::seek(off64_t pos, SeekWhence whence)
 		pos = adjust_file_pos_for_whence(pos, whence, d->devInfo->device_pos, d->devInfo->device_size);
 		d->devInfo->device_pos = constrain_file_pos(pos, d->devInfo->device_size);
 		return 0;
+	} else if (d->usePread) {
+		// pread() mode. Seeking past EOF is allowed, as with fseeko().
+		pos = adjust_file_pos_for_whence(pos, whence, d->pos, d->fileSize);
+		if (pos < 0) {
+			m_lastError = EINVAL;
+			return -1;
+		}
+		d->pos = pos;
+		return 0;
 	}
 
 	int ret;
@@ -489,7 +579,9 @@ off64_t RpFile::tell(void)
 		return -1;
 	}
 
-	if (d->gzfd != nullptr) {
+	if (d->usePread) {
+		return d->pos;
+	} else if (d->gzfd != nullptr) {
 		return static_cast<off64_t>(gztell(d->gzfd));
 	}
 	return ftello(d->file);
@@ -586,6 +678,9 @@ off64_t RpFile::size(void)
 		// gzipped files have the uncompressed size stored
 		// at the end of the stream.
 		return d->gzsz;
+	} else if (d->usePread) {
+		// pread() mode. Use the cached file size.
+		return d->fileSize;
 	}
 
 	// Save the current position.
@@ -667,7 +762,16 @@ int RpFile::makeWritable(void)
 	}
 
 	RP_D(RpFile);
-	off64_t prev_pos = ftello(d->file);
+	off64_t prev_pos;
+	if (d->usePread) {
+		// Switching to stdio. Borrowed pointers from peek()
+		// are no longer valid.
+		prev_pos = d->pos;
+		d->unmap();
+		d->usePread = false;
+	} else {
+		prev_pos = ftello(d->file);
+	}
 	fclose(d->file);
 	d->file = d->fopen_cloexec(d->filename.c_str(), RpFile::FM_OPEN_WRITE);
 	if (d->file) {
@@ -689,4 +793,240 @@ int RpFile::makeWritable(void)
 	return 0;
 }
 
+/**
+ * Get a read-only pointer to the file data at the specified address,
+ * if this file supports zero-copy access.
+ *
+ * This requires FM_MMAP, and is only available for uncompressed
+ * regular files that are opened as read-only.
+ *
+ * The returned pointer is borrowed from this RpFile, and it's only
+ * valid until the file is closed, made writable, or destroyed.
+ * The file position is not changed.
+ *
+ * @param pos		[in] Requested address
+ * @param size		[in] Requested size, in bytes
+ * @param pcbAvail	[out] Number of bytes available at the returned pointer (may be less than size at EOF)
+ * @return Pointer to the file data, or nullptr if zero-copy access isn't available.
+ */
+const uint8_t *RpFile::peek(off64_t pos, size_t size, size_t *pcbAvail)
+{
+	RP_D(RpFile);
+	assert(pcbAvail != nullptr);
+	if (!d->usePread || !(d->mode & FM_MMAP) || d->mapFailed) {
+		return nullptr;
+	} else if (pos < 0 || pos >= d->fileSize) {
+		return nullptr;
+	}
+
+	if (!d->pMap) {
+		// Map the entire file.
+		// NOTE: Files larger than the address space can't be mapped.
+		if (d->fileSize <= 0 || static_cast<uint64_t>(d->fileSize) > SIZE_MAX) {
+			d->mapFailed = true;
+			return nullptr;
+		}
+		const size_t mapSize = static_cast<size_t>(d->fileSize);
+		void *const pMap = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fileno(d->file), 0);
+		if (pMap == MAP_FAILED) {
+			d->mapFailed = true;
+			return nullptr;
+		}
+		d->pMap = pMap;
+		d->mapSize = mapSize;
+	}
+
+	const size_t avail = d->mapSize - static_cast<size_t>(pos);
+	*pcbAvail = (size < avail) ? size : avail;
+	return static_cast<const uint8_t*>(d->pMap) + pos;
+}
+
+/**
+ * Copy data from this RpFile to another RpFile without using
+ * an intermediate buffer.
+ *
+ * Reflinks (FICLONERANGE) are tried first, followed by copy_file_range()
+ * and sendfile(). Both files must be uncompressed regular files.
+ *
+ * @param pDestFile	[in] Destination IRpFile
+ * @param size		[in] Number of bytes to copy
+ * @param pcbCopied	[out] Number of bytes copied (may be less than size at EOF)
+ * @return 0 on success; -ENOTSUP if not supported for these files; other negative POSIX error code on error.
+ */
+int RpFile::copyToDirect(IRpFile *pDestFile, off64_t size, off64_t *pcbCopied)
+{
+	RP_D(RpFile);
+	assert(pcbCopied != nullptr);
+	*pcbCopied = 0;
+
+	RpFile *const pDestRpFile = dynamic_cast<RpFile*>(pDestFile);
+	if (!pDestRpFile || pDestRpFile == this) {
+		return -ENOTSUP;
+	}
+	RpFilePrivate *const dd = pDestRpFile->d_ptr;
+	if (!d->file || d->gzfd || d->devInfo ||
+	    !dd->file || dd->gzfd || dd->devInfo || !(dd->mode & FM_WRITE))
+	{
+		// Not supported for compressed files or devices.
+		return -ENOTSUP;
+	}
+
+	const int src_fd = fileno(d->file);
+	const int dest_fd = fileno(dd->file);
+
+	// Clamp the size to the source file.
+	off64_t src_pos = (d->usePread ? d->pos : ftello(d->file));
+	struct stat sb;
+	if (src_pos < 0 || fstat(src_fd, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		return -ENOTSUP;
+	}
+	if (src_pos >= sb.st_size) {
+		// Nothing to copy.
+		return 0;
+	} else if (size > sb.st_size - src_pos) {
+		size = sb.st_size - src_pos;
+	}
+
+	// Flush the destination file's stdio buffer so the
+	// data is written in the correct order.
+	if (fflush(dd->file) != 0) {
+		pDestRpFile->m_lastError = errno;
+		return -errno;
+	}
+	off64_t dest_pos = ftello(dd->file);
+	if (dest_pos < 0) {
+		return -ENOTSUP;
+	}
+
+	int ret = -ENOTSUP;
+	off64_t cbCopied = 0;
+
+#if defined(__linux__) && defined(FICLONERANGE)
+	// Try creating a reflink. (btrfs, XFS, bcachefs)
+	// NOTE: Offsets must be block-aligned, except if the
+	// range ends at the end of the source file.
+	struct file_clone_range fcr;
+	fcr.src_fd = src_fd;
+	fcr.src_offset = static_cast<uint64_t>(src_pos);
+	fcr.src_length = static_cast<uint64_t>(size);
+	fcr.dest_offset = static_cast<uint64_t>(dest_pos);
+	if (ioctl(dest_fd, FICLONERANGE, &fcr) == 0) {
+		cbCopied = size;
+		ret = 0;
+	}
+#endif /* __linux__ && FICLONERANGE */
+
+#ifdef HAVE_COPY_FILE_RANGE
+	if (ret == -ENOTSUP) {
+		// Try copy_file_range().
+		loff_t off_in = src_pos;
+		loff_t off_out = dest_pos;
+		while (cbCopied < size) {
+			const size_t toCopy = static_cast<size_t>(
+				std::min(size - cbCopied, static_cast<off64_t>(0x40000000)));
+			const ssize_t sret = copy_file_range(src_fd, &off_in, dest_fd, &off_out, toCopy, 0);
+			if (sret < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (cbCopied == 0 && (errno == EXDEV || errno == EINVAL ||
+				    errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF))
+				{
+					// copy_file_range() isn't supported for these files.
+					break;
+				}
+				// An error occurred.
+				pDestRpFile->m_lastError = errno;
+				ret = -errno;
+				break;
+			} else if (sret == 0) {
+				// End of file.
+				ret = 0;
+				break;
+			}
+			cbCopied += sret;
+			ret = 0;
+		}
+	}
+#endif /* HAVE_COPY_FILE_RANGE */
+
+#ifdef __linux__
+	if (ret == -ENOTSUP) {
+		// Try sendfile().
+		// NOTE: sendfile() writes to the destination's file offset.
+		off_t off_in = src_pos;
+		if (lseek(dest_fd, dest_pos, SEEK_SET) == dest_pos) {
+			while (cbCopied < size) {
+				const size_t toCopy = static_cast<size_t>(
+					std::min(size - cbCopied, static_cast<off64_t>(0x40000000)));
+				const ssize_t sret = sendfile(dest_fd, src_fd, &off_in, toCopy);
+				if (sret < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					if (cbCopied == 0 && (errno == EINVAL || errno == ENOSYS)) {
+						// sendfile() isn't supported for these files.
+						break;
+					}
+					// An error occurred.
+					pDestRpFile->m_lastError = errno;
+					ret = -errno;
+					break;
+				} else if (sret == 0) {
+					// End of file.
+					ret = 0;
+					break;
+				}
+				cbCopied += sret;
+				ret = 0;
+			}
+		}
+	}
+#endif /* __linux__ */
+
+	// Update the file positions.
+	src_pos += cbCopied;
+	dest_pos += cbCopied;
+	if (d->usePread) {
+		d->pos = src_pos;
+	} else {
+		fseeko(d->file, src_pos, SEEK_SET);
+	}
+	fseeko(dd->file, dest_pos, SEEK_SET);
+
+	*pcbCopied = cbCopied;
+	return ret;
+}
+
+/**
+ * Preallocate disk space for part of the file.
+ * The file size and contents are not changed.
+ * This is only a hint; the space will still be
+ * allocated when the data is written.
+ * @param pos	[in] Starting position
+ * @param size	[in] Number of bytes to preallocate
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::preallocate(off64_t pos, off64_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || !(d->mode & FM_WRITE)) {
+		m_lastError = EBADF;
+		return -EBADF;
+	} else if (d->devInfo) {
+		return -ENOTSUP;
+	}
+
+#ifdef __linux__
+	if (fallocate(fileno(d->file), FALLOC_FL_KEEP_SIZE, pos, size) != 0) {
+		return -errno;
+	}
+	return 0;
+#else /* !__linux__ */
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return -ENOTSUP;
+#endif /* __linux__ */
+}
+
 } // namespace LibRpFile
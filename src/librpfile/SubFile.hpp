@@ -149,6 +149,48 @@ public:
 		return m_length;
 	}
 
+public:
+	/** Extra functions **/
+
+	/**
+	 * Get a read-only pointer to the file data at the specified address,
+	 * if the underlying file supports zero-copy access.
+	 * @param pos		[in] Requested address
+	 * @param size		[in] Requested size, in bytes
+	 * @param pcbAvail	[out] Number of bytes available at the returned pointer (may be less than size at EOF)
+	 * @return Pointer to the file data, or nullptr if zero-copy access isn't available.
+	 */
+	const uint8_t *peek(off64_t pos, size_t size, size_t *pcbAvail) final
+	{
+		if (!m_file || pos < 0 || pos >= m_length) {
+			return nullptr;
+		}
+
+		if (static_cast<off64_t>(size) > m_length - pos) {
+			size = static_cast<size_t>(m_length - pos);
+		}
+		return m_file->peek(pos + m_offset, size, pcbAvail);
+	}
+
+	/**
+	 * Copy data from this SubFile to another IRpFile without using
+	 * an intermediate buffer, if supported by the underlying file.
+	 * @param pDestFile	[in] Destination IRpFile
+	 * @param size		[in] Number of bytes to copy
+	 * @param pcbCopied	[out] Number of bytes copied (may be less than size at EOF)
+	 * @return 0 on success; -ENOTSUP if not supported for these files; other negative POSIX error code on error.
+	 */
+	int copyToDirect(IRpFile *pDestFile, off64_t size, off64_t *pcbCopied) final
+	{
+		if (!m_file) {
+			*pcbCopied = 0;
+			return -ENOTSUP;
+		}
+
+		// NOTE: Not enforcing length bounds.
+		return m_file->copyToDirect(pDestFile, size, pcbCopied);
+	}
+
 protected:
 	LibRpFile::IRpFilePtr m_file;
 	off64_t m_offset;
@@ -314,7 +314,7 @@ RpFile::RpFile(const wchar_t *filenameW, FileMode mode)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	const bool tryGzip = (!d->devInfo && d->mode == FM_OPEN_READ_GZ);
+	const bool tryGzip = (!d->devInfo && (d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ);
 	if (tryGzip) { do {
 #if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
 		// Delay load verification.
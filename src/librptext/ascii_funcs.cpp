@@ -0,0 +1,111 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptext)                        *
+ * ascii_funcs.cpp: ASCII run detection for text conversion functions.     *
+ * Standard version using regular C++ code.                                *
+ *                                                                         *
+ * Copyright (c) 2009-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ascii_funcs.hpp"
+
+// librpbyteswap
+#include "librpbyteswap/byteswap_rp.h"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+namespace LibRpText {
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_cpp(const char *str, size_t len)
+{
+	size_t i = 0;
+	for (; i < len; i++) {
+		if (static_cast<uint8_t>(str[i]) & 0x80)
+			break;
+	}
+	return i;
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16LE string to a UTF-8 buffer.
+ * Standard version using regular C++ code.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_cpp(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	size_t i = 0;
+	for (; i < len; i++) {
+		const char16_t ch16 = le16_to_cpu(wcs[i]);
+		if (ch16 >= 0x80)
+			break;
+		dest[i] = static_cast<char>(ch16);
+	}
+	return i;
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16BE string to a UTF-8 buffer.
+ * Standard version using regular C++ code.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16be_ascii_to_utf8_cpp(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	size_t i = 0;
+	for (; i < len; i++) {
+		const char16_t ch16 = be16_to_cpu(wcs[i]);
+		if (ch16 >= 0x80)
+			break;
+		dest[i] = static_cast<char>(ch16);
+	}
+	return i;
+}
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_cpp(const char *str, size_t len)
+{
+	size_t i = 0;
+	for (; i < len; i++) {
+		if (str[i] == '\r' || str[i] == '\n')
+			break;
+	}
+	return i;
+}
+
+/**
+ * Get the number of trailing spaces in a string.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_cpp(const char *str, size_t len)
+{
+	size_t count = 0;
+	for (; len > 0; len--, count++) {
+		if (str[len-1] != ' ')
+			break;
+	}
+	return count;
+}
+
+}
@@ -0,0 +1,431 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptext)                        *
+ * ascii_funcs.hpp: ASCII run detection for text conversion functions.     *
+ *                                                                         *
+ * Copyright (c) 2009-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "config.librptext.h"
+#include "common.h"
+#include "librpcpuid/cpu_dispatch.h"
+
+// C includes (C++ namespace)
+#include <cstddef>
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif /* _MSC_VER */
+
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+#  include "librpcpuid/cpuflags_x86.h"
+#  define ASCIIFUNCS_HAS_SSE2 1
+#  define ASCIIFUNCS_HAS_AVX2 1
+#elif defined(HAVE_ARM_NEON_H) && defined(RP_CPU_ARM64)
+// NOTE: The NEON versions use horizontal min/max, which is arm64-only.
+#  include "librpcpuid/cpuflags_arm.h"
+#  define ASCIIFUNCS_HAS_NEON 1
+#  define ASCIIFUNCS_ALWAYS_HAS_NEON 1
+#endif
+#ifdef RP_CPU_AMD64
+#  define ASCIIFUNCS_ALWAYS_HAS_SSE2 1
+#endif
+
+// These functions are used by the text conversion functions to handle
+// runs of ASCII text, which are usually most of the string, several
+// characters at a time. Each function returns the exact length of the
+// run, so the caller only needs to handle the character after the run.
+
+namespace LibRpText {
+
+/**
+ * Get the index of the lowest set bit in a movemask result.
+ * @param mask Mask (must not be 0)
+ * @return Index of the lowest set bit
+ */
+static inline unsigned int mask_ctz(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else /* !_MSC_VER */
+	return __builtin_ctz(mask);
+#endif /* _MSC_VER */
+}
+
+/**
+ * Get the index of the highest set bit in a movemask result.
+ * @param mask Mask (must not be 0)
+ * @return Index of the highest set bit
+ */
+static inline unsigned int mask_bsr(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else /* !_MSC_VER */
+	return 31U ^ __builtin_clz(mask);
+#endif /* _MSC_VER */
+}
+
+/** ascii_span(): Get the number of leading ASCII (U+0000-U+007F) bytes. **/
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_cpp(const char *str, size_t len);
+
+#ifdef ASCIIFUNCS_HAS_SSE2
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_sse2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_SSE2 */
+
+#ifdef ASCIIFUNCS_HAS_AVX2
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_avx2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_AVX2 */
+
+#ifdef ASCIIFUNCS_HAS_NEON
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_neon(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_NEON */
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+static inline size_t ascii_span(const char *str, size_t len)
+{
+#if defined(ASCIIFUNCS_ALWAYS_HAS_NEON)
+	return ascii_span_neon(str, len);
+#else
+#  ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return ascii_span_avx2(str, len);
+	} else
+#  endif /* ASCIIFUNCS_HAS_AVX2 */
+#  if defined(ASCIIFUNCS_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return ascii_span_sse2(str, len);
+	}
+#  else /* !ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#    ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		return ascii_span_sse2(str, len);
+	} else
+#    endif /* ASCIIFUNCS_HAS_SSE2 */
+	{
+		return ascii_span_cpp(str, len);
+	}
+#  endif /* ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#endif /* ASCIIFUNCS_ALWAYS_HAS_NEON */
+}
+
+/** utf16(le|be)_ascii_to_utf8(): Copy leading ASCII characters from UTF-16 to UTF-8. **/
+
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * Standard version using regular C++ code.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE or UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_cpp(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+size_t utf16be_ascii_to_utf8_cpp(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+
+#ifdef ASCIIFUNCS_HAS_SSE2
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * SSE2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE or UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_sse2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+size_t utf16be_ascii_to_utf8_sse2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+#endif /* ASCIIFUNCS_HAS_SSE2 */
+
+#ifdef ASCIIFUNCS_HAS_AVX2
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * AVX2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE or UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_avx2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+size_t utf16be_ascii_to_utf8_avx2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+#endif /* ASCIIFUNCS_HAS_AVX2 */
+
+#ifdef ASCIIFUNCS_HAS_NEON
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * NEON-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE or UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_neon(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+size_t utf16be_ascii_to_utf8_neon(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+#endif /* ASCIIFUNCS_HAS_NEON */
+
+/**
+ * Copy the leading ASCII characters from a UTF-16LE string to a UTF-8 buffer.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+static inline size_t utf16le_ascii_to_utf8(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+#if defined(ASCIIFUNCS_ALWAYS_HAS_NEON)
+	return utf16le_ascii_to_utf8_neon(dest, wcs, len);
+#else
+#  ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return utf16le_ascii_to_utf8_avx2(dest, wcs, len);
+	} else
+#  endif /* ASCIIFUNCS_HAS_AVX2 */
+#  if defined(ASCIIFUNCS_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return utf16le_ascii_to_utf8_sse2(dest, wcs, len);
+	}
+#  else /* !ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#    ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		return utf16le_ascii_to_utf8_sse2(dest, wcs, len);
+	} else
+#    endif /* ASCIIFUNCS_HAS_SSE2 */
+	{
+		return utf16le_ascii_to_utf8_cpp(dest, wcs, len);
+	}
+#  endif /* ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#endif /* ASCIIFUNCS_ALWAYS_HAS_NEON */
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16BE string to a UTF-8 buffer.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+static inline size_t utf16be_ascii_to_utf8(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+#if defined(ASCIIFUNCS_ALWAYS_HAS_NEON)
+	return utf16be_ascii_to_utf8_neon(dest, wcs, len);
+#else
+#  ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return utf16be_ascii_to_utf8_avx2(dest, wcs, len);
+	} else
+#  endif /* ASCIIFUNCS_HAS_AVX2 */
+#  if defined(ASCIIFUNCS_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return utf16be_ascii_to_utf8_sse2(dest, wcs, len);
+	}
+#  else /* !ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#    ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		return utf16be_ascii_to_utf8_sse2(dest, wcs, len);
+	} else
+#    endif /* ASCIIFUNCS_HAS_SSE2 */
+	{
+		return utf16be_ascii_to_utf8_cpp(dest, wcs, len);
+	}
+#  endif /* ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#endif /* ASCIIFUNCS_ALWAYS_HAS_NEON */
+}
+
+/** crlf_span(): Get the number of leading bytes that aren't '\r' or '\n'. **/
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_cpp(const char *str, size_t len);
+
+#ifdef ASCIIFUNCS_HAS_SSE2
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_sse2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_SSE2 */
+
+#ifdef ASCIIFUNCS_HAS_AVX2
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_avx2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_AVX2 */
+
+#ifdef ASCIIFUNCS_HAS_NEON
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_neon(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_NEON */
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+static inline size_t crlf_span(const char *str, size_t len)
+{
+#if defined(ASCIIFUNCS_ALWAYS_HAS_NEON)
+	return crlf_span_neon(str, len);
+#else
+#  ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return crlf_span_avx2(str, len);
+	} else
+#  endif /* ASCIIFUNCS_HAS_AVX2 */
+#  if defined(ASCIIFUNCS_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return crlf_span_sse2(str, len);
+	}
+#  else /* !ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#    ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		return crlf_span_sse2(str, len);
+	} else
+#    endif /* ASCIIFUNCS_HAS_SSE2 */
+	{
+		return crlf_span_cpp(str, len);
+	}
+#  endif /* ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#endif /* ASCIIFUNCS_ALWAYS_HAS_NEON */
+}
+
+/** trailing_spaces(): Get the number of trailing spaces. **/
+
+/**
+ * Get the number of trailing spaces in a string.
+ * Standard version using regular C++ code.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_cpp(const char *str, size_t len);
+
+#ifdef ASCIIFUNCS_HAS_SSE2
+/**
+ * Get the number of trailing spaces in a string.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_sse2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_SSE2 */
+
+#ifdef ASCIIFUNCS_HAS_AVX2
+/**
+ * Get the number of trailing spaces in a string.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_avx2(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_AVX2 */
+
+#ifdef ASCIIFUNCS_HAS_NEON
+/**
+ * Get the number of trailing spaces in a string.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_neon(const char *str, size_t len);
+#endif /* ASCIIFUNCS_HAS_NEON */
+
+/**
+ * Get the number of trailing spaces in a string.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+static inline size_t trailing_spaces(const char *str, size_t len)
+{
+#if defined(ASCIIFUNCS_ALWAYS_HAS_NEON)
+	return trailing_spaces_neon(str, len);
+#else
+#  ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return trailing_spaces_avx2(str, len);
+	} else
+#  endif /* ASCIIFUNCS_HAS_AVX2 */
+#  if defined(ASCIIFUNCS_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return trailing_spaces_sse2(str, len);
+	}
+#  else /* !ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#    ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		return trailing_spaces_sse2(str, len);
+	} else
+#    endif /* ASCIIFUNCS_HAS_SSE2 */
+	{
+		return trailing_spaces_cpp(str, len);
+	}
+#  endif /* ASCIIFUNCS_ALWAYS_HAS_SSE2 */
+#endif /* ASCIIFUNCS_ALWAYS_HAS_NEON */
+}
+
+}
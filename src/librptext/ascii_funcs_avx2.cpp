@@ -0,0 +1,169 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptext)                        *
+ * ascii_funcs_avx2.cpp: ASCII run detection for text conversion functions.*
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2009-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ascii_funcs.hpp"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// AVX2 intrinsics
+#include <immintrin.h>
+
+// NOTE: Strings are usually short, so the SSE2 versions
+// are used for anything left over after the 32-byte blocks.
+
+namespace LibRpText {
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_avx2(const char *str, size_t len)
+{
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		const __m256i ymm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&str[i]));
+		const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(ymm));
+		if (mask != 0) {
+			// Found a non-ASCII byte.
+			return i + mask_ctz(mask);
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + ascii_span_sse2(&str[i], len - i);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * AVX2-optimized version.
+ * @tparam BigEndian True for UTF-16BE; false for UTF-16LE
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16 string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+template<bool BigEndian>
+static inline size_t T_utf16_ascii_to_utf8_avx2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	const __m256i mask_non_ascii = _mm256_set1_epi16(static_cast<int16_t>(0xFF80));
+
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		__m256i ymm0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&wcs[i]));
+		__m256i ymm1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&wcs[i+16]));
+		if (BigEndian) {
+			ymm0 = _mm256_or_si256(_mm256_slli_epi16(ymm0, 8), _mm256_srli_epi16(ymm0, 8));
+			ymm1 = _mm256_or_si256(_mm256_slli_epi16(ymm1, 8), _mm256_srli_epi16(ymm1, 8));
+		}
+
+		// All 32 characters must be ASCII.
+		if (!_mm256_testz_si256(_mm256_or_si256(ymm0, ymm1), mask_non_ascii)) {
+			// Found a non-ASCII character.
+			break;
+		}
+
+		// NOTE: _mm256_packus_epi16() packs each 128-bit lane separately,
+		// so the 64-bit blocks have to be put back in order.
+		const __m256i packed = _mm256_packus_epi16(ymm0, ymm1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[i]),
+			_mm256_permute4x64_epi64(packed, 0xD8));
+	}
+
+	// Copy the remaining characters.
+	if (BigEndian) {
+		return i + utf16be_ascii_to_utf8_sse2(&dest[i], &wcs[i], len - i);
+	} else {
+		return i + utf16le_ascii_to_utf8_sse2(&dest[i], &wcs[i], len - i);
+	}
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16LE string to a UTF-8 buffer.
+ * AVX2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_avx2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_avx2<false>(dest, wcs, len);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16BE string to a UTF-8 buffer.
+ * AVX2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16be_ascii_to_utf8_avx2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_avx2<true>(dest, wcs, len);
+}
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_avx2(const char *str, size_t len)
+{
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i lf = _mm256_set1_epi8('\n');
+
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		const __m256i ymm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&str[i]));
+		const __m256i is_crlf = _mm256_or_si256(_mm256_cmpeq_epi8(ymm, cr), _mm256_cmpeq_epi8(ymm, lf));
+		const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(is_crlf));
+		if (mask != 0) {
+			// Found '\r' or '\n'.
+			return i + mask_ctz(mask);
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + crlf_span_sse2(&str[i], len - i);
+}
+
+/**
+ * Get the number of trailing spaces in a string.
+ * AVX2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_avx2(const char *str, size_t len)
+{
+	const __m256i spaces = _mm256_set1_epi8(' ');
+
+	size_t count = 0;
+	for (; len >= 32; len -= 32, count += 32) {
+		const __m256i ymm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&str[len-32]));
+		const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ymm, spaces)));
+		if (mask != 0xFFFFFFFFU) {
+			// Found a non-space character.
+			// The highest clear bit is the last non-space character.
+			return count + (31 - mask_bsr(~mask));
+		}
+	}
+
+	// Check the remaining bytes.
+	return count + trailing_spaces_sse2(str, len);
+}
+
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptext)                        *
+ * ascii_funcs_neon.cpp: ASCII run detection for text conversion functions.*
+ * ARM NEON-optimized version.                                             *
+ *                                                                         *
+ * Copyright (c) 2009-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ascii_funcs.hpp"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// ARM NEON intrinsics
+#include <arm_neon.h>
+
+// NOTE: These functions use vmaxvq/vminvq, which are only available on arm64.
+// If a block has a character that ends the run, the C++ version is used
+// to find its exact position.
+
+namespace LibRpText {
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_neon(const char *str, size_t len)
+{
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(&str[i]));
+		if (vmaxvq_u8(v) >= 0x80) {
+			// Found a non-ASCII byte.
+			break;
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + ascii_span_cpp(&str[i], len - i);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * NEON-optimized version.
+ * @tparam BigEndian True for UTF-16BE; false for UTF-16LE
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16 string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+template<bool BigEndian>
+static inline size_t T_utf16_ascii_to_utf8_neon(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		uint16x8_t v0 = vld1q_u16(reinterpret_cast<const uint16_t*>(&wcs[i]));
+		uint16x8_t v1 = vld1q_u16(reinterpret_cast<const uint16_t*>(&wcs[i+8]));
+		if (BigEndian) {
+			v0 = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v0)));
+			v1 = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v1)));
+		}
+
+		// All 16 characters must be ASCII.
+		if (vmaxvq_u16(vorrq_u16(v0, v1)) >= 0x80) {
+			// Found a non-ASCII character.
+			break;
+		}
+		vst1q_u8(reinterpret_cast<uint8_t*>(&dest[i]), vcombine_u8(vmovn_u16(v0), vmovn_u16(v1)));
+	}
+
+	// Copy the remaining characters.
+	if (BigEndian) {
+		return i + utf16be_ascii_to_utf8_cpp(&dest[i], &wcs[i], len - i);
+	} else {
+		return i + utf16le_ascii_to_utf8_cpp(&dest[i], &wcs[i], len - i);
+	}
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16LE string to a UTF-8 buffer.
+ * NEON-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_neon(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_neon<false>(dest, wcs, len);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16BE string to a UTF-8 buffer.
+ * NEON-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16be_ascii_to_utf8_neon(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_neon<true>(dest, wcs, len);
+}
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_neon(const char *str, size_t len)
+{
+	const uint8x16_t cr = vdupq_n_u8('\r');
+	const uint8x16_t lf = vdupq_n_u8('\n');
+
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(&str[i]));
+		if (vmaxvq_u8(vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, lf))) != 0) {
+			// Found '\r' or '\n'.
+			break;
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + crlf_span_cpp(&str[i], len - i);
+}
+
+/**
+ * Get the number of trailing spaces in a string.
+ * NEON-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_neon(const char *str, size_t len)
+{
+	const uint8x16_t spaces = vdupq_n_u8(' ');
+
+	size_t count = 0;
+	for (; len >= 16; len -= 16, count += 16) {
+		const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(&str[len-16]));
+		if (vminvq_u8(vceqq_u8(v, spaces)) == 0) {
+			// Found a non-space character.
+			break;
+		}
+	}
+
+	// Check the remaining bytes.
+	// NOTE: If a non-space character was found, it's in the last 16 bytes,
+	// so trailing_spaces_cpp() will stop there.
+	return count + trailing_spaces_cpp(str, len);
+}
+
+}
@@ -0,0 +1,163 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptext)                        *
+ * ascii_funcs_sse2.cpp: ASCII run detection for text conversion functions.*
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2009-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ascii_funcs.hpp"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// SSE2 intrinsics
+#include <emmintrin.h>
+
+namespace LibRpText {
+
+/**
+ * Get the number of leading ASCII bytes in a string.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading ASCII bytes
+ */
+size_t ascii_span_sse2(const char *str, size_t len)
+{
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const __m128i xmm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&str[i]));
+		const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(xmm));
+		if (mask != 0) {
+			// Found a non-ASCII byte.
+			return i + mask_ctz(mask);
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + ascii_span_cpp(&str[i], len - i);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16 string to a UTF-8 buffer.
+ * SSE2-optimized version.
+ * @tparam BigEndian True for UTF-16BE; false for UTF-16LE
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16 string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+template<bool BigEndian>
+static inline size_t T_utf16_ascii_to_utf8_sse2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	const __m128i mask_non_ascii = _mm_set1_epi16(static_cast<int16_t>(0xFF80));
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		__m128i xmm0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&wcs[i]));
+		__m128i xmm1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&wcs[i+8]));
+		if (BigEndian) {
+			xmm0 = _mm_or_si128(_mm_slli_epi16(xmm0, 8), _mm_srli_epi16(xmm0, 8));
+			xmm1 = _mm_or_si128(_mm_slli_epi16(xmm1, 8), _mm_srli_epi16(xmm1, 8));
+		}
+
+		// All 16 characters must be ASCII.
+		const __m128i non_ascii = _mm_and_si128(_mm_or_si128(xmm0, xmm1), mask_non_ascii);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, zero)) != 0xFFFF) {
+			// Found a non-ASCII character.
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i]), _mm_packus_epi16(xmm0, xmm1));
+	}
+
+	// Copy the remaining characters.
+	if (BigEndian) {
+		return i + utf16be_ascii_to_utf8_cpp(&dest[i], &wcs[i], len - i);
+	} else {
+		return i + utf16le_ascii_to_utf8_cpp(&dest[i], &wcs[i], len - i);
+	}
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16LE string to a UTF-8 buffer.
+ * SSE2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16LE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16le_ascii_to_utf8_sse2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_sse2<false>(dest, wcs, len);
+}
+
+/**
+ * Copy the leading ASCII characters from a UTF-16BE string to a UTF-8 buffer.
+ * SSE2-optimized version.
+ * @param dest	[out] UTF-8 buffer (must have room for len bytes)
+ * @param wcs	[in] UTF-16BE string
+ * @param len	[in] Length of wcs, in characters
+ * @return Number of characters copied
+ */
+size_t utf16be_ascii_to_utf8_sse2(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len)
+{
+	return T_utf16_ascii_to_utf8_sse2<true>(dest, wcs, len);
+}
+
+/**
+ * Get the number of leading bytes in a string that aren't '\r' or '\n'.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of leading bytes that aren't '\r' or '\n'
+ */
+size_t crlf_span_sse2(const char *str, size_t len)
+{
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const __m128i xmm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&str[i]));
+		const __m128i is_crlf = _mm_or_si128(_mm_cmpeq_epi8(xmm, cr), _mm_cmpeq_epi8(xmm, lf));
+		const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(is_crlf));
+		if (mask != 0) {
+			// Found '\r' or '\n'.
+			return i + mask_ctz(mask);
+		}
+	}
+
+	// Check the remaining bytes.
+	return i + crlf_span_cpp(&str[i], len - i);
+}
+
+/**
+ * Get the number of trailing spaces in a string.
+ * SSE2-optimized version.
+ * @param str	[in] String
+ * @param len	[in] Length of str, in bytes
+ * @return Number of trailing spaces
+ */
+size_t trailing_spaces_sse2(const char *str, size_t len)
+{
+	const __m128i spaces = _mm_set1_epi8(' ');
+
+	size_t count = 0;
+	for (; len >= 16; len -= 16, count += 16) {
+		const __m128i xmm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&str[len-16]));
+		const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(xmm, spaces)));
+		if (mask != 0xFFFF) {
+			// Found a non-space character.
+			// The highest clear bit is the last non-space character.
+			return count + (15 - mask_bsr(~mask & 0xFFFF));
+		}
+	}
+
+	// Check the remaining bytes.
+	return count + trailing_spaces_cpp(str, len);
+}
+
+}
@@ -7,6 +7,7 @@
  ***************************************************************************/
 
 #include "conversion.hpp"
+#include "ascii_funcs.hpp"
 
 // Other rom-properties libraries
 #include "librpbyteswap/byteswap_rp.h"
@@ -132,14 +133,8 @@ void trimEnd(string &str)
 {
 	// NOTE: No str.empty() check because that's usually never the case here.
 	// TODO: Check for U+3000? (UTF-8: "\xE3\x80\x80")
-	size_t sz = str.size();
-	const auto iter_rend = str.rend();
-	for (auto iter = str.rbegin(); iter != iter_rend; ++iter) {
-		if (*iter != ' ')
-			break;
-		sz--;
-	}
-	str.resize(sz);
+	const size_t sz = str.size();
+	str.resize(sz - trailing_spaces(str.data(), sz));
 }
 
 /**
@@ -152,17 +147,12 @@ void trimEnd(char *str)
 	// TODO: Check for U+3000? (UTF-8: "\xE3\x80\x80")
 	if (unlikely(!str || str[0] == '\0'))
 		return;
-	size_t sz = strlen(str);
-	for (char *p = &str[sz-1]; sz > 0; p--) {
-		if (*p != ' ')
-			break;
-		sz--;
-	}
+	const size_t sz = strlen(str);
 
 	// NULL out the trailing spaces.
 	// NOTE: If no trailing spaces were found, then
 	// this will simply overwrite the existing NULL terminator.
-	str[sz] = '\0';
+	str[sz - trailing_spaces(str, sz)] = '\0';
 }
 
 /**
@@ -174,7 +164,6 @@ void trimEnd(char *str)
  */
 std::string dos2unix(const char *str_dos, int len, int *lf_count)
 {
-	// TODO: Optimize this!
 	string str_unix;
 	if (len < 0) {
 		len = static_cast<int>(strlen(str_dos));
@@ -182,45 +171,31 @@ std::string dos2unix(const char *str_dos, int len, int *lf_count)
 	str_unix.reserve(len);
 
 	int lf = 0;
-	for (; len > 1; str_dos++, len--) {
-		switch (str_dos[0]) {
-			case '\r':
-				// Handle all '\r' characters as newlines,
-				// even if a '\n' isn't found after it.
-				str_unix += '\n';
-				lf++;
-				if (str_dos[1] == '\n') {
-					// Skip the '\n' after the '\r'.
-					str_dos++;
-					len--;
-				}
-				break;
-			case '\n':
-				// Standalone '\n'. Count it.
-				str_unix += '\n';
-				lf++;
-				break;
-			default:
-				// Other character. Add it.
-				str_unix += *str_dos;
-				break;
+	const char *p = str_dos;
+	const char *const p_end = str_dos + len;
+	while (p < p_end) {
+		// Copy everything up to the next newline.
+		const size_t run_len = crlf_span(p, static_cast<size_t>(p_end - p));
+		str_unix.append(p, run_len);
+		p += run_len;
+		if (p >= p_end)
+			break;
+
+		// Handle all '\r' characters as newlines,
+		// even if a '\n' isn't found after it.
+		// Standalone '\n' characters are counted, too.
+		str_unix += '\n';
+		lf++;
+		if (p[0] == '\r' && p + 1 < p_end && p[1] == '\n') {
+			// Skip the '\n' after the '\r'.
+			p++;
 		}
+		p++;
 	}
 
-	// Check the last character.
-	switch (*str_dos) {
-		case '\0':
-			// End of string
-			break;
-		case '\r':
-			// '\r'; assume it's a newline.
-			str_unix += '\n';
-			lf++;
-			break;
-		default:
-			// Some other character.
-			str_unix += *str_dos;
-			break;
+	if (len > 0 && str_dos[len-1] == '\0') {
+		// Don't include a NULL terminator at the end of the string.
+		str_unix.pop_back();
 	}
 
 	if (lf_count) {
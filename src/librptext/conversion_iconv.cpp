@@ -9,6 +9,7 @@
 #include "config.librptext.h"
 #include "conversion.hpp"
 #include "NULL-check.hpp"
+#include "ascii_funcs.hpp"
 
 #if defined(_WIN32)
 #  error conversion_iconv.cpp is not supported on Windows.
@@ -17,7 +18,7 @@
 #endif
 
 // Determine the system encodings.
-#include "librpbyteswap/byteorder.h"
+#include "librpbyteswap/byteswap_rp.h"
 #if SYS_BYTEORDER == SYS_BIG_ENDIAN
 static const char RP_ICONV_UTF16_ENCODING[] = "UTF-16BE";
 #else
@@ -39,9 +40,13 @@ static const char RP_ICONV_UTF16_ENCODING[] = "UTF-16LE";
 
 // C includes (C++ namespace)
 #include <cassert>
+#include <cstring>
 
 // C++ STL classes
+#include <algorithm>
+#include <array>
 #include <vector>
+using std::array;
 using std::string;
 using std::u16string;
 using std::vector;
@@ -51,6 +56,85 @@ using std::vector;
 
 namespace LibRpText {
 
+/** iconv descriptor cache **/
+
+/**
+ * Cache of open iconv descriptors.
+ *
+ * iconv_open() has to look up (and possibly load) a conversion module
+ * every time it's called, so recently-used descriptors are kept open.
+ * iconv descriptors can't be shared between threads, so each thread
+ * has its own cache.
+ */
+class IconvCache
+{
+public:
+	IconvCache() = default;
+	~IconvCache()
+	{
+		for (const Entry &entry : m_entries) {
+			iconv_close(entry.cd);
+		}
+	}
+
+private:
+	RP_DISABLE_COPY(IconvCache)
+
+private:
+	struct Entry {
+		string dest_charset;
+		string src_charset;
+		iconv_t cd;
+	};
+
+	// Maximum number of open descriptors per thread
+	static constexpr size_t MAX_ENTRIES = 8;
+
+	// Open descriptors, with the most recently used first.
+	std::vector<Entry> m_entries;
+
+public:
+	/**
+	 * Get an iconv descriptor.
+	 * The descriptor is owned by the cache and must not be closed.
+	 * @param dest_charset	[in] Destination character set
+	 * @param src_charset	[in] Source character set
+	 * @return iconv descriptor in the initial shift state, or (iconv_t)(-1) on error.
+	 */
+	iconv_t get(const char *dest_charset, const char *src_charset)
+	{
+		for (auto iter = m_entries.begin(); iter != m_entries.end(); ++iter) {
+			if (iter->dest_charset == dest_charset && iter->src_charset == src_charset) {
+				// Found a cached descriptor.
+				// Move it to the front and reset its shift state.
+				std::rotate(m_entries.begin(), iter, iter + 1);
+				iconv_t cd = m_entries.front().cd;
+				iconv(cd, nullptr, nullptr, nullptr, nullptr);
+				return cd;
+			}
+		}
+
+		// Not cached. Open a new descriptor.
+		iconv_t cd = iconv_open(dest_charset, src_charset);
+		if (cd == (iconv_t)(-1)) {
+			// Error opening iconv.
+			return cd;
+		}
+
+		if (m_entries.size() >= MAX_ENTRIES) {
+			// Close the least recently used descriptor.
+			iconv_close(m_entries.back().cd);
+			m_entries.pop_back();
+		} else if (m_entries.empty()) {
+			m_entries.reserve(MAX_ENTRIES);
+		}
+		m_entries.insert(m_entries.begin(), {dest_charset, src_charset, cd});
+		return cd;
+	}
+};
+
+static thread_local IconvCache iconvCache;
+
 /** OS-specific text conversion functions. **/
 
 /**
@@ -82,7 +166,8 @@ static char *rp_iconv(const char *src, int len,
 	// * http://www.delorie.com/gnu/docs/glibc/libc_101.html
 	// * http://www.codase.com/search/call?name=iconv
 
-	// Open an iconv descriptor.
+	// Get an iconv descriptor.
+	// NOTE: The descriptor is owned by iconvCache.
 	iconv_t cd;
 #if defined(__linux__) || defined(HAVE_ICONV_LIBICONV)
 	// glibc/libiconv: Append "//IGNORE" to the source character set
@@ -91,13 +176,13 @@ static char *rp_iconv(const char *src, int len,
 	if (ignoreErr) {
 		char tmpsrc[32];
 		snprintf(tmpsrc, sizeof(tmpsrc), "%s//IGNORE", src_charset);
-		cd = iconv_open(dest_charset, tmpsrc);
+		cd = iconvCache.get(dest_charset, tmpsrc);
 	} else {
 		// Not ignoring errors.
-		cd = iconv_open(dest_charset, src_charset);
+		cd = iconvCache.get(dest_charset, src_charset);
 	}
 #else
-	cd = iconv_open(dest_charset, src_charset);
+	cd = iconvCache.get(dest_charset, src_charset);
 #endif
 
 	if (cd == (iconv_t)(-1)) {
@@ -144,9 +229,6 @@ static char *rp_iconv(const char *src, int len,
 		}
 	}
 
-	// Close the iconv descriptor.
-	iconv_close(cd);
-
 	if (success) {
 		// The string was converted successfully.
 
@@ -165,6 +247,231 @@ static char *rp_iconv(const char *src, int len,
 	return nullptr;
 }
 
+/** Table-driven conversion functions **/
+
+// Upper halves of 8-bit code pages. (0x80-0xFF)
+// - Index: 8-bit character minus 0x80.
+// - Value: 16-bit UTF-16 codepoint.
+// Characters that aren't defined in the code page are 0x0000.
+// These are converted using iconv in order to get the same
+// error handling as before.
+
+// cp1252
+static constexpr array<char16_t, 128> cp1252_hi_lkup = {{
+	// 0x80
+	0x20AC, 0x0000, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+	0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x0000, 0x017D, 0x0000,
+	// 0x90
+	0x0000, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+	0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x0000, 0x017E, 0x0178,
+	// 0xA0
+	0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7,
+	0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF,
+	// 0xB0
+	0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7,
+	0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF,
+	// 0xC0
+	0x00C0, 0x00C1, 0x00C2, 0x00C3, 0x00C4, 0x00C5, 0x00C6, 0x00C7,
+	0x00C8, 0x00C9, 0x00CA, 0x00CB, 0x00CC, 0x00CD, 0x00CE, 0x00CF,
+	// 0xD0
+	0x00D0, 0x00D1, 0x00D2, 0x00D3, 0x00D4, 0x00D5, 0x00D6, 0x00D7,
+	0x00D8, 0x00D9, 0x00DA, 0x00DB, 0x00DC, 0x00DD, 0x00DE, 0x00DF,
+	// 0xE0
+	0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7,
+	0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
+	// 0xF0
+	0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7,
+	0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF,
+}};
+
+// cp437
+static constexpr array<char16_t, 128> cp437_hi_lkup = {{
+	// 0x80
+	0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+	0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+	// 0x90
+	0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+	0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+	// 0xA0
+	0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+	0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+	// 0xB0
+	0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+	0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+	// 0xC0
+	0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+	0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+	// 0xD0
+	0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+	0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+	// 0xE0
+	0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+	0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+	// 0xF0
+	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+	0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0,
+}};
+
+/**
+ * Write a UTF-16 BMP character as UTF-8.
+ * @param dest	[out] UTF-8 buffer (must have room for 3 bytes)
+ * @param ch16	[in] UTF-16 character (must not be a surrogate)
+ * @return Pointer to the byte after the UTF-8 character
+ */
+static inline char *write_bmp_as_utf8(char *dest, char16_t ch16)
+{
+	if (ch16 < 0x0080) {
+		*dest++ = static_cast<char>(ch16);
+	} else if (ch16 < 0x0800) {
+		*dest++ = static_cast<char>(0xC0 | (ch16 >> 6));
+		*dest++ = static_cast<char>(0x80 | (ch16 & 0x3F));
+	} else {
+		*dest++ = static_cast<char>(0xE0 | (ch16 >> 12));
+		*dest++ = static_cast<char>(0x80 | ((ch16 >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (ch16 & 0x3F));
+	}
+	return dest;
+}
+
+/**
+ * Convert 8-bit text to UTF-8 without using iconv, if possible.
+ *
+ * Supported code pages:
+ * - cp1252 (and CP_ACP), cp437, Latin-1: All defined characters.
+ * - Shift-JIS (cp932): ASCII and half-width katakana.
+ * - UTF-8: ASCII.
+ *
+ * If any other characters are present, nothing is converted,
+ * and the caller should use iconv.
+ *
+ * @param s_utf8	[out] UTF-8 string
+ * @param cp		[in] Code page number
+ * @param str		[in] 8-bit text
+ * @param len		[in] Length of str, in bytes (NULL terminator already checked)
+ * @return True if the text was converted; false if iconv must be used.
+ */
+static bool fast_cpN_to_utf8(string &s_utf8, unsigned int cp, const char *str, int len)
+{
+	const array<char16_t, 128> *hi_lkup = nullptr;
+	switch (cp) {
+		case CP_ACP:
+		case 1252:
+			hi_lkup = &cp1252_hi_lkup;
+			break;
+		case 437:
+			hi_lkup = &cp437_hi_lkup;
+			break;
+		case CP_LATIN1:
+		case CP_SJIS:
+		case CP_UTF8:
+			break;
+		default:
+			// Not supported.
+			return false;
+	}
+
+	// Each character is at most 3 bytes in UTF-8.
+	s_utf8.resize(static_cast<size_t>(len) * 3);
+	char *dest = &s_utf8[0];
+	const char *p = str;
+	const char *const p_end = str + len;
+	while (p < p_end) {
+		// ASCII is the same in all supported code pages.
+		const size_t ascii_len = ascii_span(p, static_cast<size_t>(p_end - p));
+		memcpy(dest, p, ascii_len);
+		dest += ascii_len;
+		p += ascii_len;
+		if (p >= p_end)
+			break;
+
+		const uint8_t chr = static_cast<uint8_t>(*p++);
+		char16_t ch16;
+		if (hi_lkup) {
+			ch16 = (*hi_lkup)[chr - 0x80];
+		} else if (cp == CP_LATIN1) {
+			ch16 = chr;
+		} else if (cp == CP_SJIS && chr >= 0xA1 && chr <= 0xDF) {
+			// Half-width katakana
+			ch16 = 0xFF61 + (chr - 0xA1);
+		} else {
+			// Multi-byte character.
+			ch16 = 0;
+		}
+
+		if (ch16 == 0) {
+			// Not supported here.
+			s_utf8.clear();
+			return false;
+		}
+		dest = write_bmp_as_utf8(dest, ch16);
+	}
+
+	s_utf8.resize(static_cast<size_t>(dest - s_utf8.data()));
+	return true;
+}
+
+/**
+ * Convert UTF-16 text to UTF-8 without using iconv, if possible.
+ *
+ * If the text has unpaired surrogates, nothing is converted,
+ * and the caller should use iconv.
+ *
+ * @tparam BigEndian True for UTF-16BE; false for UTF-16LE
+ * @param s_utf8	[out] UTF-8 string
+ * @param wcs		[in] UTF-16 text
+ * @param len		[in] Length of wcs, in characters (NULL terminator already checked)
+ * @return True if the text was converted; false if iconv must be used.
+ */
+template<bool BigEndian>
+static bool fast_utf16_to_utf8(string &s_utf8, const char16_t *wcs, int len)
+{
+	// Each UTF-16 code unit is at most 3 bytes in UTF-8.
+	// (Surrogate pairs are 4 bytes for 2 code units.)
+	s_utf8.resize(static_cast<size_t>(len) * 3);
+	char *dest = &s_utf8[0];
+	const char16_t *const wcs_end = wcs + len;
+	while (wcs < wcs_end) {
+		// Copy the ASCII characters.
+		const size_t ascii_len = (BigEndian)
+			? utf16be_ascii_to_utf8(dest, wcs, static_cast<size_t>(wcs_end - wcs))
+			: utf16le_ascii_to_utf8(dest, wcs, static_cast<size_t>(wcs_end - wcs));
+		dest += ascii_len;
+		wcs += ascii_len;
+		if (wcs >= wcs_end)
+			break;
+
+		const char16_t ch16 = (BigEndian ? be16_to_cpu(*wcs) : le16_to_cpu(*wcs));
+		wcs++;
+		if (ch16 < 0xD800 || ch16 >= 0xE000) {
+			dest = write_bmp_as_utf8(dest, ch16);
+			continue;
+		}
+
+		// Surrogate pair.
+		if (ch16 >= 0xDC00 || wcs >= wcs_end) {
+			// Unpaired surrogate.
+			s_utf8.clear();
+			return false;
+		}
+		const char16_t ch16_lo = (BigEndian ? be16_to_cpu(*wcs) : le16_to_cpu(*wcs));
+		if (ch16_lo < 0xDC00 || ch16_lo >= 0xE000) {
+			// Unpaired surrogate.
+			s_utf8.clear();
+			return false;
+		}
+		wcs++;
+
+		const char32_t ch32 = 0x10000 + (((ch16 & 0x3FF) << 10) | (ch16_lo & 0x3FF));
+		*dest++ = static_cast<char>(0xF0 | (ch32 >> 18));
+		*dest++ = static_cast<char>(0x80 | ((ch32 >> 12) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | ((ch32 >> 6) & 0x3F));
+		*dest++ = static_cast<char>(0x80 | (ch32 & 0x3F));
+	}
+
+	s_utf8.resize(static_cast<size_t>(dest - s_utf8.data()));
+	return true;
+}
+
 /** Generic code page functions **/
 
 /**
@@ -354,6 +661,14 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 		return cpRP_to_utf8(static_cast<CpRp>(cp), str, len);
 	}
 
+	if (!(flags & TEXTCONV_FLAG_JIS_X_0208)) {
+		// Try the table-driven conversion first.
+		string s_utf8;
+		if (fast_cpN_to_utf8(s_utf8, cp, str, check_NULL_terminator(str, len))) {
+			return s_utf8;
+		}
+	}
+
 	return T_cpN_to_unicode<char>("UTF-8", cp, str, len, flags);
 }
 
@@ -441,16 +756,24 @@ string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
  * Convert 16-bit Unicode text to UTF-8.
  * Trailing NULL bytes will be removed.
  * [INTERNAL VERSION, called by utf16(le|be)_to_utf8().]
- * @param src_encoding [in] Source encoding
+ * @tparam BigEndian True for UTF-16BE; false for UTF-16LE
  * @param wcs	[in] 16-bit Unicode text
  * @param len	[in] Length of wcs, in characters (-1 for NULL-terminated string)
  * @return UTF-8 string
  */
-static string INT_utf16_to_utf8(const char *src_encoding, const char16_t *wcs, int len)
+template<bool BigEndian>
+static string INT_utf16_to_utf8(const char16_t *wcs, int len)
 {
 	string s_ret;
 	len = check_NULL_terminator(wcs, len);
 
+	// Try the direct conversion first.
+	if (fast_utf16_to_utf8<BigEndian>(s_ret, wcs, len)) {
+		return s_ret;
+	}
+
+	const char *const src_encoding = (BigEndian ? "UTF-16BE" : "UTF-16LE");
+
 	// Attempt to convert the text from UTF-16LE to UTF-8.
 	char *const mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), src_encoding, "UTF-8"));
 	if (mbs) {
@@ -469,7 +792,7 @@ static string INT_utf16_to_utf8(const char *src_encoding, const char16_t *wcs, i
  */
 string utf16le_to_utf8(const char16_t *wcs, int len)
 {
-	return INT_utf16_to_utf8("UTF-16LE", wcs, len);
+	return INT_utf16_to_utf8<false>(wcs, len);
 }
 
 /**
@@ -481,7 +804,7 @@ string utf16le_to_utf8(const char16_t *wcs, int len)
  */
 string utf16be_to_utf8(const char16_t *wcs, int len)
 {
-	return INT_utf16_to_utf8("UTF-16BE", wcs, len);
+	return INT_utf16_to_utf8<true>(wcs, len);
 }
 
 /**
@@ -532,6 +855,7 @@ std::string utf16_to_cp1252(const char16_t *wcs, int len)
 		}
 
 		s_ret.assign(mbs);
+		free(mbs);
 		return s_ret;
 	}
 
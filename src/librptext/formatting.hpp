@@ -74,6 +74,7 @@ enum class BinaryUnitDialect {
  * @param dialect
  * @return Formatted file size.
  */
+RP_LIBROMDATA_PUBLIC
 std::string formatFileSize(off64_t fileSize, BinaryUnitDialect dialect = BinaryUnitDialect::DefaultBinaryDialect);
 
 /**
@@ -14,7 +14,8 @@
 #include "../formatting.hpp"
 #include "../fourCC.hpp"
 #include "../utf8_funcs.hpp"
-#include "librpbyteswap/byteorder.h"
+#include "../ascii_funcs.hpp"
+#include "librpbyteswap/byteswap_rp.h"
 using namespace LibRpText;
 
 // C includes (C++ namespace)
@@ -29,6 +30,7 @@ using namespace LibRpText;
 // C++ includes
 #include <array>
 #include <string>
+#include <vector>
 using std::array;
 using std::string;
 using std::u16string;
@@ -376,6 +378,43 @@ TEST_F(TextFuncsTest, cp1252_sjis_to_utf8_japanese)
 	EXPECT_EQ(C8(sjis_utf8_data), str);
 }
 
+/**
+ * Test cp1252_sjis_to_utf8() with half-width katakana.
+ */
+TEST_F(TextFuncsTest, cp1252_sjis_to_utf8_katakana)
+{
+	// "ｶﾞﾝﾀﾞﾑ 1"
+	static const char sjis_in[] = "\xB6\xDE\xDD\xC0\xDE\xD1 1";
+	static const char utf8_out[] =
+		"\xEF\xBD\xB6\xEF\xBE\x9E\xEF\xBE\x9D"
+		"\xEF\xBE\x80\xEF\xBE\x9E\xEF\xBE\x91 1";
+
+	string str = cp1252_sjis_to_utf8(sjis_in, -1);
+	EXPECT_EQ(utf8_out, str);
+}
+
+/** Code Page 437 **/
+
+/**
+ * Test cpN_to_utf8() with cp437.
+ */
+TEST_F(TextFuncsTest, cp437_to_utf8)
+{
+	// "╔═╗ Çß½ ░"
+	static const char cp437_in[] = "\xC9\xCD\xBB \x80\xE1\xAB \xB0";
+	static const char utf8_out[] =
+		"\xE2\x95\x94\xE2\x95\x90\xE2\x95\x97 "
+		"\xC3\x87\xC3\x9F\xC2\xBD \xE2\x96\x91";
+
+	string str = cpN_to_utf8(437, cp437_in, -1);
+	EXPECT_EQ(utf8_out, str);
+
+	// Test with explicit length and extra NULLs.
+	// The extra NULLs should be trimmed.
+	str = cpN_to_utf8(437, cp437_in, static_cast<int>(sizeof(cp437_in)));
+	EXPECT_EQ(utf8_out, str);
+}
+
 /** UTF-8 to UTF-16 and vice-versa **/
 
 /**
@@ -430,6 +469,23 @@ TEST_F(TextFuncsTest, utf16le_to_utf8)
 	EXPECT_EQ(C8(utf8_data), str);
 }
 
+/**
+ * Test utf16le_to_utf8() with an unpaired surrogate.
+ * The conversion should fail, resulting in an empty string.
+ */
+TEST_F(TextFuncsTest, utf16le_to_utf8_unpaired_surrogate)
+{
+	static const char16_t utf16_in[] = {
+		cpu_to_le16('A'), cpu_to_le16(0xD83D), cpu_to_le16('B'), 0
+	};
+	string str = utf16le_to_utf8(utf16_in, -1);
+	EXPECT_TRUE(str.empty());
+
+	// High surrogate at the end of the string.
+	str = utf16le_to_utf8(utf16_in, 2);
+	EXPECT_TRUE(str.empty());
+}
+
 /**
  * Test utf16be_to_utf8() with regular text and special characters.
  */
@@ -1266,6 +1322,175 @@ TEST_F(TextFuncsTest, dos2unix)
 	EXPECT_EQ(3, lf_count);
 }
 
+/**
+ * Test trimEnd().
+ */
+TEST_F(TextFuncsTest, trimEnd)
+{
+	// Spaces only; other whitespace isn't trimmed.
+	string str = "SUPER MARIO BROS.   ";
+	trimEnd(str);
+	EXPECT_EQ("SUPER MARIO BROS.", str);
+
+	str = "SUPER MARIO BROS.\t ";
+	trimEnd(str);
+	EXPECT_EQ("SUPER MARIO BROS.\t", str);
+
+	// All spaces, longer than a SIMD block.
+	str.assign(67, ' ');
+	trimEnd(str);
+	EXPECT_EQ("", str);
+
+	// Spaces across multiple SIMD blocks.
+	str = "ZELDA";
+	str.append(70, ' ');
+	trimEnd(str);
+	EXPECT_EQ("ZELDA", str);
+
+	// Empty string
+	str.clear();
+	trimEnd(str);
+	EXPECT_EQ("", str);
+
+	// char* version
+	char buf[80];
+	memset(buf, ' ', sizeof(buf)-1);
+	memcpy(buf, "METROID", 7);
+	buf[sizeof(buf)-1] = '\0';
+	trimEnd(buf);
+	EXPECT_STREQ("METROID", buf);
+}
+
+/**
+ * Test dos2unix() with long strings and embedded NULLs.
+ */
+TEST_F(TextFuncsTest, dos2unix_long)
+{
+	int lf_count = 0;
+
+	// Newlines on both sides of SIMD block boundaries.
+	string str_dos, expected;
+	for (unsigned int i = 0; i < 20; i++) {
+		str_dos.append(i, 'x');
+		str_dos += "\r\n";
+		expected.append(i, 'x');
+		expected += '\n';
+	}
+	EXPECT_EQ(expected, dos2unix(str_dos, &lf_count));
+	EXPECT_EQ(20, lf_count);
+
+	// "\r\r\n" is two newlines.
+	lf_count = 0;
+	EXPECT_EQ("a\n\nb", dos2unix("a\r\r\nb", -1, &lf_count));
+	EXPECT_EQ(2, lf_count);
+
+	// Embedded NULLs are kept, but a trailing NULL is removed.
+	static constexpr char test_nul[] = "a\r\n\0b\0";
+	lf_count = 0;
+	EXPECT_EQ(string("a\n\0b", 4), dos2unix(test_nul, static_cast<int>(sizeof(test_nul) - 1), &lf_count));
+	EXPECT_EQ(1, lf_count);
+}
+
+/** ASCII run functions **/
+
+/**
+ * Test the ASCII run functions.
+ * All available CPU-specific versions must match the standard version.
+ */
+TEST_F(TextFuncsTest, ascii_funcs)
+{
+	// Test buffer, with room for multiple SIMD blocks.
+	static constexpr size_t BUF_SIZE = 100;
+	char buf[BUF_SIZE];
+	char16_t wbuf_le[BUF_SIZE], wbuf_be[BUF_SIZE];
+	char out_cpp[BUF_SIZE], out_simd[BUF_SIZE];
+
+	typedef size_t (*span_fn)(const char *str, size_t len);
+	typedef size_t (*wcs_fn)(char *RESTRICT dest, const char16_t *RESTRICT wcs, size_t len);
+	struct funcs_t {
+		const char *name;
+		span_fn ascii_span;
+		wcs_fn utf16le_ascii_to_utf8;
+		wcs_fn utf16be_ascii_to_utf8;
+		span_fn crlf_span;
+		span_fn trailing_spaces;
+	};
+	std::vector<funcs_t> funcs;
+#ifdef ASCIIFUNCS_HAS_SSE2
+	if (RP_CPU_x86_HasSSE2()) {
+		funcs.push_back({"sse2", ascii_span_sse2, utf16le_ascii_to_utf8_sse2,
+			utf16be_ascii_to_utf8_sse2, crlf_span_sse2, trailing_spaces_sse2});
+	}
+#endif /* ASCIIFUNCS_HAS_SSE2 */
+#ifdef ASCIIFUNCS_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		funcs.push_back({"avx2", ascii_span_avx2, utf16le_ascii_to_utf8_avx2,
+			utf16be_ascii_to_utf8_avx2, crlf_span_avx2, trailing_spaces_avx2});
+	}
+#endif /* ASCIIFUNCS_HAS_AVX2 */
+#ifdef ASCIIFUNCS_HAS_NEON
+	funcs.push_back({"neon", ascii_span_neon, utf16le_ascii_to_utf8_neon,
+		utf16be_ascii_to_utf8_neon, crlf_span_neon, trailing_spaces_neon});
+#endif /* ASCIIFUNCS_HAS_NEON */
+	if (funcs.empty()) {
+		GTEST_SKIP() << "No CPU-specific versions are available on this system.";
+	}
+
+	// Place a "stop" character at every position for every length.
+	for (size_t len = 0; len <= BUF_SIZE; len++) {
+		for (size_t pos = 0; pos <= len; pos++) {
+			for (size_t i = 0; i < BUF_SIZE; i++) {
+				buf[i] = 'A' + (i % 26);
+				wbuf_le[i] = cpu_to_le16(static_cast<char16_t>(buf[i]));
+				wbuf_be[i] = cpu_to_be16(static_cast<char16_t>(buf[i]));
+			}
+			if (pos < len) {
+				buf[pos] = '\x80';
+				wbuf_le[pos] = cpu_to_le16(0x0100);
+				wbuf_be[pos] = cpu_to_be16(0x0080);
+			}
+
+			const size_t ascii_cpp = ascii_span_cpp(buf, len);
+			const size_t wcs_le_cpp = utf16le_ascii_to_utf8_cpp(out_cpp, wbuf_le, len);
+			const size_t wcs_be_cpp = utf16be_ascii_to_utf8_cpp(out_cpp, wbuf_be, len);
+			ASSERT_EQ(pos, ascii_cpp);
+			ASSERT_EQ(pos, wcs_le_cpp);
+			ASSERT_EQ(pos, wcs_be_cpp);
+
+			for (const funcs_t &f : funcs) {
+				ASSERT_EQ(ascii_cpp, f.ascii_span(buf, len)) << f.name << ": len == " << len;
+				memset(out_simd, 0, sizeof(out_simd));
+				ASSERT_EQ(wcs_le_cpp, f.utf16le_ascii_to_utf8(out_simd, wbuf_le, len)) << f.name << ": len == " << len;
+				ASSERT_EQ(0, memcmp(out_cpp, out_simd, wcs_le_cpp)) << f.name << ": len == " << len;
+				memset(out_simd, 0, sizeof(out_simd));
+				ASSERT_EQ(wcs_be_cpp, f.utf16be_ascii_to_utf8(out_simd, wbuf_be, len)) << f.name << ": len == " << len;
+				ASSERT_EQ(0, memcmp(out_cpp, out_simd, wcs_be_cpp)) << f.name << ": len == " << len;
+			}
+
+			// crlf_span(): Alternate between '\r' and '\n'.
+			if (pos < len) {
+				buf[pos] = (pos & 1) ? '\n' : '\r';
+			}
+			const size_t crlf_cpp = crlf_span_cpp(buf, len);
+			ASSERT_EQ(pos, crlf_cpp);
+			for (const funcs_t &f : funcs) {
+				ASSERT_EQ(crlf_cpp, f.crlf_span(buf, len)) << f.name << ": len == " << len;
+			}
+
+			// trailing_spaces(): Spaces after pos.
+			memset(buf, ' ', BUF_SIZE);
+			if (pos > 0) {
+				buf[pos - 1] = 'X';
+			}
+			const size_t spaces_cpp = trailing_spaces_cpp(buf, len);
+			ASSERT_EQ(len - pos, spaces_cpp);
+			for (const funcs_t &f : funcs) {
+				ASSERT_EQ(spaces_cpp, f.trailing_spaces(buf, len)) << f.name << ": len == " << len;
+			}
+		}
+	}
+}
+
 /** Audio functions **/
 
 /**
@@ -1389,6 +1614,127 @@ TEST_F(TextFuncsTest, fourCCtoString_string)
 	}
 }
 
+/** Benchmarks **/
+
+// Number of iterations for benchmarks
+static constexpr unsigned int BENCHMARK_ITERATIONS = 1000000;
+
+/**
+ * Benchmark cp1252_sjis_to_utf8() with ASCII text.
+ */
+TEST_F(TextFuncsTest, cp1252_sjis_to_utf8_ascii_benchmark)
+{
+	static const char str_in[] = "SUPER MARIO BROS. 3 (USA) (Rev 1)";
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		string str = cp1252_sjis_to_utf8(str_in, static_cast<int>(sizeof(str_in)));
+	}
+}
+
+/**
+ * Benchmark cp1252_sjis_to_utf8() with Japanese text.
+ * This uses iconv.
+ */
+TEST_F(TextFuncsTest, cp1252_sjis_to_utf8_japanese_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		string str = cp1252_sjis_to_utf8(C8(sjis_data), static_cast<int>(sjis_data.size()));
+	}
+}
+
+/**
+ * Benchmark cp1252_to_utf8().
+ */
+TEST_F(TextFuncsTest, cp1252_to_utf8_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		string str = cp1252_to_utf8(C8(cp1252_data), static_cast<int>(cp1252_data.size()));
+	}
+}
+
+/**
+ * Benchmark utf16le_to_utf8().
+ */
+TEST_F(TextFuncsTest, utf16le_to_utf8_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		string str = utf16le_to_utf8(C16(utf16le_data), C16_ARRAY_SIZE_I(utf16_data));
+	}
+}
+
+// Game titles for benchmarks.
+// Most titles are ASCII, with the occasional accented or Japanese title.
+static const char16_t *const titles_utf16[] = {
+	u"SUPER MARIO BROS. 3",
+	u"The Legend of Zelda: A Link to the Past",
+	u"Pokémon Emerald Version",
+	u"METROID PRIME",
+	u"Super Smash Bros. Melee",
+	u"スーパーマリオブラザーズ",
+	u"Sonic the Hedgehog 2                    ",
+	u"Animal Crossing: New Leaf",
+	u"Mario Kart Wii",
+	u"ゼルダの伝説 時のオカリナ",
+	u"Metroid Dread",
+	u"Xenoblade Chronicles 3                  ",
+};
+
+/**
+ * Benchmark utf16_to_utf8() with game titles.
+ */
+TEST_F(TextFuncsTest, utf16_to_utf8_titles_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS / ARRAY_SIZE(titles_utf16); i > 0; i--) {
+		for (const char16_t *title : titles_utf16) {
+			string str = utf16_to_utf8(title, -1);
+		}
+	}
+}
+
+/**
+ * Benchmark latin1_to_utf8() and trimEnd() with game titles.
+ */
+TEST_F(TextFuncsTest, latin1_to_utf8_titles_benchmark)
+{
+	// Convert the titles to Latin-1 first.
+	// Japanese titles are skipped.
+	std::vector<string> titles_latin1;
+	for (const char16_t *title : titles_utf16) {
+		string str;
+		for (; *title != 0; title++) {
+			if (*title >= 0x100) {
+				str.clear();
+				break;
+			}
+			str += static_cast<char>(*title);
+		}
+		if (!str.empty()) {
+			titles_latin1.push_back(std::move(str));
+		}
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS / titles_latin1.size(); i > 0; i--) {
+		for (const string &title : titles_latin1) {
+			string str = latin1_to_utf8(title.data(), static_cast<int>(title.size()));
+			trimEnd(str);
+		}
+	}
+}
+
+/**
+ * Benchmark dos2unix().
+ */
+TEST_F(TextFuncsTest, dos2unix_benchmark)
+{
+	static const char str_in[] =
+		"This is a long description for a game.\r\n"
+		"It has multiple lines, like most descriptions do.\r\n"
+		"\r\n"
+		"Most of the text is between the newlines.\r\n";
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		string str = dos2unix(str_in, static_cast<int>(sizeof(str_in) - 1));
+	}
+}
+
 } }
 
 #ifdef HAVE_SECCOMP
@@ -8,6 +8,7 @@
 
 #include "ImageDecoder_ASTC.hpp"
 #include "basisu_astc_decomp.h"
+#include "ImageDecoder_p.hpp"
 
 // librptexture
 #include "img/rp_image.hpp"
@@ -106,7 +107,7 @@ rp_image_ptr fromASTC(int width, int height,
 #  else
 #    define SHARED_OMP5(x)
 #  endif
-#pragma omp parallel for default(none) shared(img_buf, bErr) SHARED_OMP5(pDestBits) firstprivate(block_x, block_y, tilesX, tilesY, bytesPerTileRow, stride_px)
+#pragma omp parallel for default(none) shared(img_buf, bErr) SHARED_OMP5(pDestBits) firstprivate(block_x, block_y, tilesX, tilesY, bytesPerTileRow, stride_px) schedule(dynamic) num_threads(maxThreads()) if(static_cast<unsigned int>(tilesX * tilesY) >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 #endif /* _OPENMP */
 	for (int y = 0; y < tilesY; y++) {
 		const uint8_t *pSrc = &img_buf[y * bytesPerTileRow];
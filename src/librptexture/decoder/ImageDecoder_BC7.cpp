@@ -688,7 +688,7 @@ rp_image_ptr fromBC7(int width, int height,
 	bool bErr = false;
 #endif /* _OPENMP */
 
-#pragma omp parallel for default(none) shared(img_buf, img, bErr) firstprivate(tilesX, tilesY, bytesPerTileRow)
+#pragma omp parallel for default(none) shared(img_buf, img, bErr) firstprivate(tilesX, tilesY, bytesPerTileRow) schedule(dynamic) num_threads(maxThreads()) if(static_cast<unsigned int>(tilesX * tilesY) >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (int y = 0; y < tilesY; y++) {
 		// BC7 has eight block modes with varying properties, including
 		// bitfields of different lengths. As such, the only guaranteed
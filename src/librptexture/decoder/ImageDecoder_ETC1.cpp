@@ -639,7 +639,7 @@ rp_image_ptr fromETC1(int width, int height,
 		return img;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
+	const etc1_block *const etc1_tiles = reinterpret_cast<const etc1_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -648,7 +648,9 @@ rp_image_ptr fromETC1(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(etc1_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc1_block *etc1_src = &etc1_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC1 RGB block.
 		decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
@@ -708,7 +710,7 @@ rp_image_ptr fromETC2_RGB(int width, int height,
 		return img;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
+	const etc1_block *const etc1_tiles = reinterpret_cast<const etc1_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -717,7 +719,9 @@ rp_image_ptr fromETC2_RGB(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(etc1_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc1_block *etc1_src = &etc1_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC2 RGB block.
 		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
@@ -820,7 +824,7 @@ rp_image_ptr fromETC2_RGBA(int width, int height,
 		return img;
 	}
 
-	const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(img_buf);
+	const etc2_rgba_block *const etc2_tiles = reinterpret_cast<const etc2_rgba_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -829,7 +833,9 @@ rp_image_ptr fromETC2_RGBA(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(etc2_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc2_rgba_block *etc2_src = &etc2_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
 		// Decode the ETC2 RGB block.
 		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
@@ -893,7 +899,7 @@ rp_image_ptr fromETC2_RGB_A1(int width, int height,
 		return img;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
+	const etc1_block *const etc1_tiles = reinterpret_cast<const etc1_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -902,7 +908,9 @@ rp_image_ptr fromETC2_RGB_A1(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(etc1_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc1_block *etc1_src = &etc1_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
 		// Decode the ETC2 RGB block.
 		decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
@@ -962,7 +970,7 @@ rp_image_ptr fromEAC_R11(int width, int height,
 		return img;
 	}
 
-	const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf);
+	const etc2_alpha *const eac_blocks = reinterpret_cast<const etc2_alpha*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -974,7 +982,9 @@ rp_image_ptr fromEAC_R11(int width, int height,
 	array<uint32_t, 4*4> tileBuf;
 	tileBuf.fill(0xFF000000U);
 
+#pragma omp parallel for default(none) shared(img) firstprivate(eac_blocks, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc2_alpha *eac_block = &eac_blocks[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, eac_block++) {
 		// Decode the EAC R11 block.
 		decodeBlock_EAC(tileBuf, eac_block, ARGB32_BYTE_OFFSET_R);
@@ -1035,7 +1045,7 @@ rp_image_ptr fromEAC_RG11(int width, int height,
 		return img;
 	}
 
-	const etc2_alpha *eac_block = reinterpret_cast<const etc2_alpha*>(img_buf);
+	const etc2_alpha *const eac_blocks = reinterpret_cast<const etc2_alpha*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -1047,7 +1057,9 @@ rp_image_ptr fromEAC_RG11(int width, int height,
 	array<uint32_t, 4*4> tileBuf;
 	tileBuf.fill(0xFF000000U);
 
+#pragma omp parallel for default(none) shared(img) firstprivate(eac_blocks, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const etc2_alpha *eac_block = &eac_blocks[y * tilesX * 2];
 	for (unsigned int x = 0; x < tilesX; x++, eac_block += 2) {
 		// Decode the EAC R11 block.
 		decodeBlock_EAC(tileBuf, &eac_block[0], ARGB32_BYTE_OFFSET_R);
@@ -89,8 +89,8 @@ rp_image_ptr fromGcn16(PixelFormat px_format,
 	static const rp_image::sBIT_t sBIT_5A3 = {5,5,5,0,4};
 	static const rp_image::sBIT_t sBIT_565 = {5,6,5,0,0};
 
-	// NOTE: For IA8, setting the grayscale value, though we're
-	// not saving grayscale PNGs at the moment.
+	// NOTE: For IA8, setting the grayscale value so
+	// RpPngWriter will save a grayscale PNG.
 	static const rp_image::sBIT_t sBIT_IA8 = {8,8,8,8,8};
 
 	switch (px_format) {
@@ -91,8 +91,8 @@ rp_image_ptr fromLinearMono(int width, int height,
 	}
 
 	// Set the sBIT metadata.
-	// NOTE: Setting the grayscale value, though we're
-	// not saving grayscale PNGs at the moment.
+	// NOTE: RpPngWriter only uses the grayscale value for ARGB32
+	// images. This is CI8, so it's still saved as a paletted PNG.
 	static const rp_image::sBIT_t sBIT = {1,1,1,1,0};
 	img->set_sBIT(sBIT);
 
@@ -182,8 +182,8 @@ rp_image_ptr fromLinearGray2bpp(int width, int height,
 	}
 
 	// Set the sBIT metadata.
-	// NOTE: Setting the grayscale value, though we're
-	// not saving grayscale PNGs at the moment.
+	// NOTE: RpPngWriter only uses the grayscale value for ARGB32
+	// images. This is CI8, so it's still saved as a paletted PNG.
 	static const rp_image::sBIT_t sBIT = {2,2,2,2,0};
 	img->set_sBIT(sBIT);
 
@@ -289,8 +289,8 @@ rp_image_ptr fromLinearMono_WinIcon(int width, int height,
 	}
 
 	// Set the sBIT metadata.
-	// NOTE: Setting the grayscale value, though we're
-	// not saving grayscale PNGs at the moment.
+	// NOTE: RpPngWriter only uses the grayscale value for ARGB32
+	// images. This is CI8, so it's still saved as a paletted PNG.
 	// TODO: Don't set alpha if the icon mask doesn't have any set bits?
 	static const rp_image::sBIT_t sBIT = {1,1,1,1,1};
 	img->set_sBIT(sBIT);
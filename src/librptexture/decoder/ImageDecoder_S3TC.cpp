@@ -7,7 +7,7 @@
  ***************************************************************************/
 
 #include "ImageDecoder_S3TC.hpp"
-#include "ImageDecoder_p.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
 
 #include "PixelConversion.hpp"
 using namespace LibRpTexture::PixelConversion;
@@ -29,24 +29,6 @@ using std::array;
 
 namespace LibRpTexture { namespace ImageDecoder {
 
-// DXT1 block format.
-struct dxt1_block {
-	uint16_t color[2];	// Colors 0 and 1, in RGB565 format.
-	uint32_t indexes;	// Two-bit color indexes.
-};
-ASSERT_STRUCT(dxt1_block, 8);
-
-// DXT5 alpha+codes struct.
-// Also used by BC4/BC5 for color channels.
-union dxt5_alpha {
-	struct {
-		uint8_t values[2];	// Alpha values.
-		uint8_t codes[6];	// Alpha operation codes. (48-bit unsigned; 3-bit per pixel)
-	};
-	uint64_t u64;	// Access the 48-bit code value directly. (Requires shifting.)
-};
-ASSERT_STRUCT(dxt5_alpha, 8);
-
 /**
  * Extract the 48-bit code value from dxt5_alpha.
  * @param data dxt5_alpha.
@@ -60,13 +42,6 @@ static RP_FORCEINLINE uint64_t extract48(const dxt5_alpha *RESTRICT data)
 	return le64_to_cpu(data->u64) >> 16;
 }
 
-// decode_DXTn_tile_color_palette flags.
-enum ATTR_FLAG_ENUM DXTn_Palette_Flags {
-	DXTn_PALETTE_BIG_ENDIAN		= (1U << 0),
-	DXTn_PALETTE_COLOR3_ALPHA	= (1U << 1),	// GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
-	DXTn_PALETTE_COLOR0_GT_COLOR1	= (1U << 2),	// Assume color0 > color1. (DXT2/DXT3)
-};
-
 /**
  * Decode a DXTn tile color palette. (S3TC version)
  * @tparam flags Flags. (See DXTn_Palette_Flags)
@@ -315,7 +290,7 @@ static rp_image_ptr T_fromDXT1(int width, int height,
 		return img;
 	}
 
-	const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(img_buf);
+	const dxt1_block *const dxt1_tiles = reinterpret_cast<const dxt1_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -324,7 +299,9 @@ static rp_image_ptr T_fromDXT1(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(dxt1_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const dxt1_block *dxt1_src = &dxt1_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, dxt1_src++) {
 		// Decode the DXT1 tile palette.
 		argb32_t pal[4];
@@ -364,7 +341,7 @@ static rp_image_ptr T_fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image_ptr fromDXT1(int width, int height,
+rp_image_ptr fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz)
 {
 	return T_fromDXT1<0>(width, height, img_buf, img_siz);
@@ -380,7 +357,7 @@ rp_image_ptr fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image_ptr fromDXT1_A1(int width, int height,
+rp_image_ptr fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz)
 {
 	return T_fromDXT1<DXTn_PALETTE_COLOR3_ALPHA>(width, height, img_buf, img_siz);
@@ -459,7 +436,7 @@ rp_image_ptr fromDXT3(int width, int height,
 		dxt1_block colors;	// DXT1-style color block.
 	};
 	ASSERT_STRUCT(dxt3_block, 16);
-	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf);
+	const dxt3_block *const dxt3_tiles = reinterpret_cast<const dxt3_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -468,7 +445,9 @@ rp_image_ptr fromDXT3(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(dxt3_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const dxt3_block *dxt3_src = &dxt3_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, dxt3_src++) {
 		// Decode the DXT3 tile palette.
 		argb32_t pal[4];
@@ -541,7 +520,7 @@ rp_image_ptr fromDXT4(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image_ptr fromDXT5(int width, int height,
+rp_image_ptr fromDXT5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz)
 {
 	rp_image_ptr img;
@@ -572,13 +551,7 @@ rp_image_ptr fromDXT5(int width, int height,
 		return img;
 	}
 
-	// DXT5 block format.
-	struct dxt5_block {
-		dxt5_alpha alpha;
-		dxt1_block colors;	// DXT1-style color block.
-	};
-	ASSERT_STRUCT(dxt5_block, 16);
-	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf);
+	const dxt5_block *const dxt5_tiles = reinterpret_cast<const dxt5_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -587,7 +560,9 @@ rp_image_ptr fromDXT5(int width, int height,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+#pragma omp parallel for default(none) shared(img) firstprivate(dxt5_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const dxt5_block *dxt5_src = &dxt5_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, dxt5_src++) {
 		// Decode the DXT5 tile palette.
 		argb32_t pal[4];
@@ -634,7 +609,7 @@ rp_image_ptr fromDXT5(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image_ptr fromBC4(int width, int height,
+rp_image_ptr fromBC4_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz)
 {
 	rp_image_ptr img;
@@ -665,12 +640,7 @@ rp_image_ptr fromBC4(int width, int height,
 		return img;
 	}
 
-	// BC4 block format.
-	struct bc4_block {
-		dxt5_alpha red;
-	};
-	ASSERT_STRUCT(bc4_block, 8);
-	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf);
+	const bc4_block *const bc4_tiles = reinterpret_cast<const bc4_block*>(img_buf);
 
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
@@ -680,7 +650,9 @@ rp_image_ptr fromBC4(int width, int height,
 	array<uint32_t, 4*4> tileBuf;
 
 	// S3TC version.
+#pragma omp parallel for default(none) shared(img) firstprivate(bc4_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const bc4_block *bc4_src = &bc4_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, bc4_src++) {
 		// BC4 colors are determined using DXT5-style alpha interpolation.
 
@@ -727,7 +699,7 @@ rp_image_ptr fromBC4(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image_ptr fromBC5(int width, int height,
+rp_image_ptr fromBC5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz)
 {
 	rp_image_ptr img;
@@ -758,23 +730,19 @@ rp_image_ptr fromBC5(int width, int height,
 		return img;
 	}
 
-	// BC5 block format.
-	struct bc5_block {
-		dxt5_alpha red;
-		dxt5_alpha green;
-	};
-	ASSERT_STRUCT(bc5_block, 16);
-	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
+	const bc5_block *const bc5_tiles = reinterpret_cast<const bc5_block*>(img_buf);
 
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
 
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
 	// S3TC version.
+#pragma omp parallel for default(none) shared(img) firstprivate(bc5_tiles, tilesX, tilesY, tileBuf) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
 	for (unsigned int y = 0; y < tilesY; y++) {
+	const bc5_block *bc5_src = &bc5_tiles[y * tilesX];
 	for (unsigned int x = 0; x < tilesX; x++, bc5_src++) {
 		// BC5 colors are determined using DXT5-style alpha interpolation.
 
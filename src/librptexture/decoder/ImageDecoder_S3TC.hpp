@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librptexture)                     *
  * ImageDecoder_S3TC.hpp: Image decoding functions: S3TC                   *
  *                                                                         *
- * Copyright (c) 2016-2023 by David Korth.                                 *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -30,6 +30,7 @@ rp_image_ptr fromDXT1_GCN(int width, int height,
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as black.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -38,12 +39,106 @@ rp_image_ptr fromDXT1_GCN(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image_ptr fromDXT1(int width, int height,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image_ptr fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+#if defined(IMAGEDECODER_ALWAYS_HAS_NEON) && defined(RP_CPU_ARM64)
+	return fromDXT1_neon(width, height, img_buf, img_siz);
+#else /* !(IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64) */
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return fromDXT1_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_x86_HasSSSE3()) {
+		return fromDXT1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#  if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+	if (RP_CPU_arm_HasNEON()) {
+		return fromDXT1_neon(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+	{
+		return fromDXT1_cpp(width, height, img_buf, img_siz);
+	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64 */
+}
+
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as fully transparent.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -52,9 +147,102 @@ rp_image_ptr fromDXT1(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image_ptr fromDXT1_A1(int width, int height,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_A1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT1_A1_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image_ptr fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+#if defined(IMAGEDECODER_ALWAYS_HAS_NEON) && defined(RP_CPU_ARM64)
+	return fromDXT1_A1_neon(width, height, img_buf, img_siz);
+#else /* !(IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64) */
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return fromDXT1_A1_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_x86_HasSSSE3()) {
+		return fromDXT1_A1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#  if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+	if (RP_CPU_arm_HasNEON()) {
+		return fromDXT1_A1_neon(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+	{
+		return fromDXT1_A1_cpp(width, height, img_buf, img_siz);
+	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64 */
+}
+
 /**
  * Convert a DXT2 image to rp_image.
  * @param width Image width.
@@ -93,6 +281,8 @@ rp_image_ptr fromDXT4(int width, int height,
 
 /**
  * Convert a DXT5 image to rp_image.
+ * Standard version using regular C++ code.
+ *
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT5 image buffer.
@@ -100,9 +290,168 @@ rp_image_ptr fromDXT4(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image_ptr fromDXT5(int width, int height,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a DXT5 image to rp_image.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT5_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Convert a DXT5 image to rp_image.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromDXT5_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+/**
+ * Convert a DXT5 image to rp_image.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image_ptr fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+#if defined(IMAGEDECODER_ALWAYS_HAS_NEON) && defined(RP_CPU_ARM64)
+	return fromDXT5_neon(width, height, img_buf, img_siz);
+#else /* !(IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64) */
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return fromDXT5_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_x86_HasSSSE3()) {
+		return fromDXT5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#  if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+	if (RP_CPU_arm_HasNEON()) {
+		return fromDXT5_neon(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+	{
+		return fromDXT5_cpp(width, height, img_buf, img_siz);
+	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64 */
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * Standard version using regular C++ code.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC4_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC4_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC4_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
 /**
  * Convert a BC4 (ATI1) image to rp_image.
  * Color component is Red.
@@ -110,26 +459,144 @@ rp_image_ptr fromDXT5(int width, int height,
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image_ptr fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+#if defined(IMAGEDECODER_ALWAYS_HAS_NEON) && defined(RP_CPU_ARM64)
+	return fromBC4_neon(width, height, img_buf, img_siz);
+#else /* !(IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64) */
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return fromBC4_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_x86_HasSSSE3()) {
+		return fromBC4_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#  if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+	if (RP_CPU_arm_HasNEON()) {
+		return fromBC4_neon(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+	{
+		return fromBC4_cpp(width, height, img_buf, img_siz);
+	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64 */
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * Standard version using regular C++ code.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image_ptr fromBC4(int width, int height,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
 /**
  * Convert a BC5 (ATI2) image to rp_image.
  * Color components are Red and Green.
+ * SSSE3-optimized version.
  *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf BC4 image buffer.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image_ptr fromBC5(int width, int height,
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC5_avx2(int width, int height,
 	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+RP_LIBROMDATA_PUBLIC
+rp_image_ptr fromBC5_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image_ptr fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+#if defined(IMAGEDECODER_ALWAYS_HAS_NEON) && defined(RP_CPU_ARM64)
+	return fromBC5_neon(width, height, img_buf, img_siz);
+#else /* !(IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64) */
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_x86_HasAVX2()) {
+		return fromBC5_avx2(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_x86_HasSSSE3()) {
+		return fromBC5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#  if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+	if (RP_CPU_arm_HasNEON()) {
+		return fromBC5_neon(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+	{
+		return fromBC5_cpp(width, height, img_buf, img_siz);
+	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_NEON && RP_CPU_ARM64 */
+}
 
 /**
  * Convert a Red image to Luminance.
@@ -0,0 +1,395 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC_avx2.cpp: Image decoding functions: S3TC              *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ImageDecoder_S3TC.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
+
+// AVX2 intrinsics
+#include <immintrin.h>
+
+// This is the same algorithm as the SSSE3 version, but two horizontally
+// adjacent tiles are decoded at once: the low 128-bit lane has the left
+// tile, and the high 128-bit lane has the right tile. Since the tiles are
+// adjacent, each row of the tile pair can be written with a single store.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Combine two 128-bit vectors.
+ * @param lo Low 128 bits
+ * @param hi High 128 bits
+ * @return 256-bit vector
+ */
+static inline __m256i combine_si128(__m128i lo, __m128i hi)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/**
+ * Broadcast a 128-bit constant to both lanes.
+ * @param x 128-bit constant
+ * @return 256-bit vector
+ */
+static inline __m256i bcast(__m128i x)
+{
+	return combine_si128(x, x);
+}
+
+/**
+ * Decode two DXTn tile color palettes. (S3TC version)
+ * @tparam flags Flags. (See DXTn_Palette_Flags; DXTn_PALETTE_BIG_ENDIAN is not supported.)
+ * @param src_a	[in] DXT1 block for the low lane.
+ * @param src_b	[in] DXT1 block for the high lane.
+ * @return Four ARGB32 palette entries per lane.
+ */
+template<unsigned int flags>
+static inline __m256i decode_DXTn_tile_color_palette_avx2(const dxt1_block *RESTRICT src_a, const dxt1_block *RESTRICT src_b)
+{
+	const uint16_t c0a = le16_to_cpu(src_a->color[0]);
+	const uint16_t c1a = le16_to_cpu(src_a->color[1]);
+	const uint16_t c0b = le16_to_cpu(src_b->color[0]);
+	const uint16_t c1b = le16_to_cpu(src_b->color[1]);
+
+	// Convert the first two colors from RGB565.
+	__m256i w = combine_si128(
+		_mm_setr_epi16(c0a, c0a, c0a, 0, c1a, c1a, c1a, 0),
+		_mm_setr_epi16(c0b, c0b, c0b, 0, c1b, c1b, c1b, 0));
+	w = _mm256_and_si256(w, bcast(_mm_setr_epi16(0x001F, 0x07E0, 0xF800, 0, 0x001F, 0x07E0, 0xF800, 0)));
+	w = _mm256_mullo_epi16(w, bcast(_mm_setr_epi16(1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0)));
+	w = _mm256_or_si256(_mm256_srli_epi16(w, 8), _mm256_mulhi_epu16(w, bcast(_mm_setr_epi16(8, 4, 8, 0, 8, 4, 8, 0))));
+	w = _mm256_or_si256(w, bcast(_mm_setr_epi16(0, 0, 0, 0xFF, 0, 0, 0, 0xFF)));
+
+	// Swap color0 and color1.
+	const __m256i w_swap = _mm256_shuffle_epi32(w, _MM_SHUFFLE(1,0,3,2));
+
+	// color0 > color1: ((2*c0)+c1)/3, ((2*c1)+c0)/3
+	__m256i pal23 = _mm256_add_epi16(_mm256_add_epi16(w, w), w_swap);
+	pal23 = _mm256_srli_epi16(_mm256_mulhi_epu16(pal23, _mm256_set1_epi16(static_cast<int16_t>(0xAAAB))), 1);
+
+	if (!(flags & DXTn_PALETTE_COLOR0_GT_COLOR1)) {
+		// color0 <= color1: (c0+c1)/2, then black or transparent.
+		__m256i pal23_le = _mm256_srli_epi16(_mm256_add_epi16(w, w_swap), 1);
+		pal23_le = _mm256_blend_epi32(pal23_le, _mm256_setzero_si256(), 0xCC);
+		if (!(flags & DXTn_PALETTE_COLOR3_ALPHA)) {
+			pal23_le = _mm256_or_si256(pal23_le, bcast(_mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 0xFF)));
+		}
+
+		const __m256i gt = combine_si128(
+			_mm_set1_epi16(c0a > c1a ? -1 : 0),
+			_mm_set1_epi16(c0b > c1b ? -1 : 0));
+		pal23 = _mm256_blendv_epi8(pal23_le, pal23, gt);
+	}
+
+	return _mm256_packus_epi16(w, pal23);
+}
+
+/**
+ * Convert DXTn 2-bit color indexes to byte offsets within the palette.
+ * @param indexes_a 2-bit color indexes for the low lane.
+ * @param indexes_b 2-bit color indexes for the high lane.
+ * @return One byte per pixel, multiplied by 4.
+ */
+static inline __m256i expand_DXTn_indexes_avx2(uint32_t indexes_a, uint32_t indexes_b)
+{
+	const __m256i x = _mm256_setr_epi32(static_cast<int>(indexes_a), 0, 0, 0, static_cast<int>(indexes_b), 0, 0, 0);
+	const __m256i mask = _mm256_set1_epi8(3);
+	const __m256i i0 = _mm256_and_si256(x, mask);
+	const __m256i i1 = _mm256_and_si256(_mm256_srli_epi16(x, 2), mask);
+	const __m256i i2 = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask);
+	const __m256i i3 = _mm256_and_si256(_mm256_srli_epi16(x, 6), mask);
+
+	const __m256i idx = _mm256_unpacklo_epi16(_mm256_unpacklo_epi8(i0, i1), _mm256_unpacklo_epi8(i2, i3));
+	return _mm256_slli_epi16(idx, 2);
+}
+
+/**
+ * Decode 16 DXT5-style 3-bit alpha codes for two tiles.
+ * Also used for BC4/BC5 color channels.
+ * @param src_a	[in] DXT5 alpha block for the low lane.
+ * @param src_b	[in] DXT5 alpha block for the high lane.
+ * @return One alpha value per pixel.
+ */
+static inline __m256i decode_DXT5_alpha_avx2(const dxt5_alpha *RESTRICT src_a, const dxt5_alpha *RESTRICT src_b)
+{
+	const __m256i va0 = combine_si128(
+		_mm_set1_epi16(src_a->values[0]), _mm_set1_epi16(src_b->values[0]));
+	const __m256i va1 = combine_si128(
+		_mm_set1_epi16(src_a->values[1]), _mm_set1_epi16(src_b->values[1]));
+
+	// alpha0 > alpha1: 8-value palette
+	__m256i pal7 = _mm256_add_epi16(
+		_mm256_mullo_epi16(va0, bcast(_mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1))),
+		_mm256_mullo_epi16(va1, bcast(_mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6))));
+	pal7 = _mm256_mulhi_epu16(pal7, _mm256_set1_epi16(9363));
+
+	// alpha0 <= alpha1: 6-value palette, plus 0 and 255
+	__m256i pal5 = _mm256_add_epi16(
+		_mm256_mullo_epi16(va0, bcast(_mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0))),
+		_mm256_mullo_epi16(va1, bcast(_mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0))));
+	pal5 = _mm256_mulhi_epu16(pal5, _mm256_set1_epi16(13108));
+	pal5 = _mm256_or_si256(pal5, bcast(_mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255)));
+
+	// Select the palette.
+	__m256i pal = _mm256_blendv_epi8(pal5, pal7, _mm256_cmpgt_epi16(va0, va1));
+	pal = _mm256_packus_epi16(pal, pal);
+
+	// Extract the 3-bit codes.
+	const __m256i blk = combine_si128(
+		_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_a)),
+		_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_b)));
+	const __m256i code_mul = bcast(_mm_setr_epi16(1 << 13, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8));
+	__m256i codes_lo = _mm256_shuffle_epi8(blk, bcast(_mm_setr_epi8(2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5)));
+	__m256i codes_hi = _mm256_shuffle_epi8(blk, bcast(_mm_setr_epi8(5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,8, 7,8)));
+	codes_lo = _mm256_srli_epi16(_mm256_mullo_epi16(codes_lo, code_mul), 13);
+	codes_hi = _mm256_srli_epi16(_mm256_mullo_epi16(codes_hi, code_mul), 13);
+
+	return _mm256_shuffle_epi8(pal, _mm256_packus_epi16(codes_lo, codes_hi));
+}
+
+// Byte selectors for row 0. Add (row * 4) for the other rows.
+// NOTE: 0x80 + 12 still has the high bit set, so zeroed bytes stay zeroed.
+#define ROW_SEL_COLOR	bcast(_mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3))
+#define ROW_SEL_B3	bcast(_mm_setr_epi8(-128,-128,-128,0, -128,-128,-128,1, -128,-128,-128,2, -128,-128,-128,3))
+#define ROW_SEL_B2	bcast(_mm_setr_epi8(-128,-128,0,-128, -128,-128,1,-128, -128,-128,2,-128, -128,-128,3,-128))
+#define ROW_SEL_B1	bcast(_mm_setr_epi8(-128,0,-128,-128, -128,1,-128,-128, -128,2,-128,-128, -128,3,-128,-128))
+
+/**
+ * Look up four pixels per lane from DXTn color palettes.
+ * @param pal	[in] Color palettes
+ * @param idx4	[in] Expanded color indexes (from expand_DXTn_indexes_avx2())
+ * @param row4	[in] Row number, multiplied by 4 (set1_epi8)
+ * @return Four ARGB32 pixels per lane
+ */
+static inline __m256i lookup_DXTn_row_avx2(__m256i pal, __m256i idx4, __m256i row4)
+{
+	__m256i ctrl = _mm256_shuffle_epi8(idx4, _mm256_add_epi8(ROW_SEL_COLOR, row4));
+	ctrl = _mm256_or_si256(ctrl, bcast(_mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3)));
+	return _mm256_shuffle_epi8(pal, ctrl);
+}
+
+/**
+ * Decode two horizontally adjacent DXT1 tiles.
+ * @tparam flags decode_DXTn_tile_color_palette_avx2<>() flags.
+ * @param rows	[out] Four rows of eight pixels
+ * @param src_a	[in] Left tile
+ * @param src_b	[in] Right tile
+ */
+template<unsigned int flags>
+static inline void decodeTilePair_DXT1_avx2(__m256i rows[4],
+	const dxt1_block *RESTRICT src_a, const dxt1_block *RESTRICT src_b)
+{
+	const __m256i pal = decode_DXTn_tile_color_palette_avx2<flags>(src_a, src_b);
+	const __m256i idx4 = expand_DXTn_indexes_avx2(
+		le32_to_cpu(src_a->indexes), le32_to_cpu(src_b->indexes));
+
+	for (int row = 0; row < 4; row++) {
+		const __m256i row4 = _mm256_set1_epi8(static_cast<char>(row * 4));
+		rows[row] = lookup_DXTn_row_avx2(pal, idx4, row4);
+	}
+}
+
+/**
+ * Decode two horizontally adjacent DXT5 tiles.
+ * @param rows	[out] Four rows of eight pixels
+ * @param src_a	[in] Left tile
+ * @param src_b	[in] Right tile
+ */
+static inline void decodeTilePair_DXT5_avx2(__m256i rows[4],
+	const dxt5_block *RESTRICT src_a, const dxt5_block *RESTRICT src_b)
+{
+	const __m256i pal = decode_DXTn_tile_color_palette_avx2<0>(&src_a->colors, &src_b->colors);
+	const __m256i idx4 = expand_DXTn_indexes_avx2(
+		le32_to_cpu(src_a->colors.indexes), le32_to_cpu(src_b->colors.indexes));
+	const __m256i alpha = decode_DXT5_alpha_avx2(&src_a->alpha, &src_b->alpha);
+	const __m256i rgb_mask = _mm256_set1_epi32(0x00FFFFFF);
+
+	for (int row = 0; row < 4; row++) {
+		const __m256i row4 = _mm256_set1_epi8(static_cast<char>(row * 4));
+		const __m256i px = _mm256_and_si256(lookup_DXTn_row_avx2(pal, idx4, row4), rgb_mask);
+		rows[row] = _mm256_or_si256(px, _mm256_shuffle_epi8(alpha, _mm256_add_epi8(ROW_SEL_B3, row4)));
+	}
+}
+
+/**
+ * Decode two horizontally adjacent BC4 tiles.
+ * @param rows	[out] Four rows of eight pixels
+ * @param src_a	[in] Left tile
+ * @param src_b	[in] Right tile
+ */
+static inline void decodeTilePair_BC4_avx2(__m256i rows[4],
+	const bc4_block *RESTRICT src_a, const bc4_block *RESTRICT src_b)
+{
+	const __m256i red = decode_DXT5_alpha_avx2(&src_a->red, &src_b->red);
+	const __m256i opaque_black = _mm256_set1_epi32(static_cast<int>(0xFF000000U));
+
+	for (int row = 0; row < 4; row++) {
+		const __m256i row4 = _mm256_set1_epi8(static_cast<char>(row * 4));
+		rows[row] = _mm256_or_si256(opaque_black,
+			_mm256_shuffle_epi8(red, _mm256_add_epi8(ROW_SEL_B2, row4)));
+	}
+}
+
+/**
+ * Decode two horizontally adjacent BC5 tiles.
+ * @param rows	[out] Four rows of eight pixels
+ * @param src_a	[in] Left tile
+ * @param src_b	[in] Right tile
+ */
+static inline void decodeTilePair_BC5_avx2(__m256i rows[4],
+	const bc5_block *RESTRICT src_a, const bc5_block *RESTRICT src_b)
+{
+	const __m256i red = decode_DXT5_alpha_avx2(&src_a->red, &src_b->red);
+	const __m256i green = decode_DXT5_alpha_avx2(&src_a->green, &src_b->green);
+	const __m256i opaque_black = _mm256_set1_epi32(static_cast<int>(0xFF000000U));
+
+	for (int row = 0; row < 4; row++) {
+		const __m256i row4 = _mm256_set1_epi8(static_cast<char>(row * 4));
+		__m256i px = _mm256_or_si256(opaque_black,
+			_mm256_shuffle_epi8(red, _mm256_add_epi8(ROW_SEL_B2, row4)));
+		rows[row] = _mm256_or_si256(px,
+			_mm256_shuffle_epi8(green, _mm256_add_epi8(ROW_SEL_B1, row4)));
+	}
+}
+
+/**
+ * Decode a row of tiles, two tiles at a time.
+ * @tparam block_t Block type
+ * @tparam decodeTilePair Tile pair decoder function
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] Blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+template<typename block_t, void (*decodeTilePair)(__m256i rows[4], const block_t *RESTRICT src_a, const block_t *RESTRICT src_b)>
+static void T_decodeTileRow_avx2(uint32_t *RESTRICT pDest, int stride_px,
+	const block_t *RESTRICT src, unsigned int tilesX)
+{
+	__m256i rows[4];
+
+	unsigned int x;
+	for (x = 0; x + 1 < tilesX; x += 2, src += 2, pDest += 8) {
+		decodeTilePair(rows, &src[0], &src[1]);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pRow), rows[row]);
+		}
+	}
+
+	if (x < tilesX) {
+		// Odd number of tiles. Decode the last tile in both lanes,
+		// and only store the low lane.
+		decodeTilePair(rows, src, src);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow), _mm256_castsi256_si128(rows[row]));
+		}
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, T_decodeTileRow_avx2<dxt1_block, decodeTilePair_DXT1_avx2<0> > >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_A1_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, T_decodeTileRow_avx2<dxt1_block, decodeTilePair_DXT1_avx2<DXTn_PALETTE_COLOR3_ALPHA> > >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT5_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return T_fromS3TC_tileRows<dxt5_block, T_decodeTileRow_avx2<dxt5_block, decodeTilePair_DXT5_avx2> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC4_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	return T_fromS3TC_tileRows<bc4_block, T_decodeTileRow_avx2<bc4_block, decodeTilePair_BC4_avx2> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * AVX2-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC5_avx2(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,8,1,0,0};
+	return T_fromS3TC_tileRows<bc5_block, T_decodeTileRow_avx2<bc5_block, decodeTilePair_BC5_avx2> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+} }
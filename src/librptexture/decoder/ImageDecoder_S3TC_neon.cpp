@@ -0,0 +1,379 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC_neon.cpp: Image decoding functions: S3TC              *
+ * NEON-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ImageDecoder_S3TC.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
+
+// ARM NEON intrinsics
+#include "arm_neon_aligned.h"
+
+// C++ STL classes
+using std::array;
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// FIXME: arm64 only! (uses vqtbl1q_u8 and vmull_high_u16)
+
+// RGB565 to ARGB32 conversion
+static const array<uint16_t, 8> rgb565_mask = {{0x001F, 0x07E0, 0xF800, 0, 0x001F, 0x07E0, 0xF800, 0}};
+static const array<int16_t, 8> rgb565_shl = {{11, 5, 0, 0, 11, 5, 0, 0}};
+static const array<int16_t, 8> rgb565_shr = {{-13, -14, -13, -16, -13, -14, -13, -16}};
+static const array<uint16_t, 8> rgb565_alpha = {{0, 0, 0, 0xFF, 0, 0, 0, 0xFF}};
+static const array<uint16_t, 4> color3_black = {{0, 0, 0, 0xFF}};
+
+// DXTn color index expansion
+static const array<uint8_t, 16> idx_sel = {{0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3}};
+static const array<int8_t, 16> idx_shr = {{0,-2,-4,-6, 0,-2,-4,-6, 0,-2,-4,-6, 0,-2,-4,-6}};
+static const array<uint8_t, 16> px_bytes = {{0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3}};
+
+// DXT5 alpha palette weights
+static const array<uint16_t, 8> alpha7_w0 = {{7, 0, 6, 5, 4, 3, 2, 1}};
+static const array<uint16_t, 8> alpha7_w1 = {{0, 7, 1, 2, 3, 4, 5, 6}};
+static const array<uint16_t, 8> alpha5_w0 = {{5, 0, 4, 3, 2, 1, 0, 0}};
+static const array<uint16_t, 8> alpha5_w1 = {{0, 5, 1, 2, 3, 4, 0, 0}};
+static const array<uint16_t, 8> alpha5_or = {{0, 0, 0, 0, 0, 0, 0, 255}};
+
+// DXT5 3-bit code extraction
+static const array<uint8_t, 16> code_sel_lo = {{2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5}};
+static const array<uint8_t, 16> code_sel_hi = {{5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,8, 7,8}};
+static const array<int16_t, 8> code_shr = {{0, -3, -6, -1, -4, -7, -2, -5}};
+
+// Byte selectors for row 0. Add (row * 4) for the other rows.
+// NOTE: vqtbl1q_u8() returns 0 for out-of-range indexes.
+static const array<uint8_t, 16> row_sel_b3 = {{0x80,0x80,0x80,0, 0x80,0x80,0x80,1, 0x80,0x80,0x80,2, 0x80,0x80,0x80,3}};
+static const array<uint8_t, 16> row_sel_b2 = {{0x80,0x80,0,0x80, 0x80,0x80,1,0x80, 0x80,0x80,2,0x80, 0x80,0x80,3,0x80}};
+static const array<uint8_t, 16> row_sel_b1 = {{0x80,0,0x80,0x80, 0x80,1,0x80,0x80, 0x80,2,0x80,0x80, 0x80,3,0x80,0x80}};
+
+/**
+ * Unsigned 16-bit multiply, returning the high 16 bits.
+ * @param a Vector
+ * @param b Multiplier
+ * @return (a * b) >> 16
+ */
+static inline uint16x8_t mulhi_u16(uint16x8_t a, uint16_t b)
+{
+	const uint32x4_t lo = vmull_u16(vget_low_u16(a), vdup_n_u16(b));
+	const uint32x4_t hi = vmull_high_u16(a, vdupq_n_u16(b));
+	return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+/**
+ * Decode a DXTn tile color palette. (S3TC version)
+ * @tparam flags Flags. (See DXTn_Palette_Flags; DXTn_PALETTE_BIG_ENDIAN is not supported.)
+ * @param dxt1_src	[in] DXT1 block.
+ * @return Four ARGB32 palette entries.
+ */
+template<unsigned int flags>
+static inline uint8x16_t decode_DXTn_tile_color_palette_neon(const dxt1_block *RESTRICT dxt1_src)
+{
+	const uint16_t c0 = le16_to_cpu(dxt1_src->color[0]);
+	const uint16_t c1 = le16_to_cpu(dxt1_src->color[1]);
+
+	// Convert the first two colors from RGB565.
+	uint16x8_t w = vcombine_u16(vdup_n_u16(c0), vdup_n_u16(c1));
+	w = vandq_u16(w, vld1q_u16(rgb565_mask.data()));
+	w = vshlq_u16(w, vld1q_s16(rgb565_shl.data()));
+	w = vorrq_u16(vshrq_n_u16(w, 8), vshlq_u16(w, vld1q_s16(rgb565_shr.data())));
+	w = vorrq_u16(w, vld1q_u16(rgb565_alpha.data()));
+
+	// Swap color0 and color1.
+	const uint16x8_t w_swap = vextq_u16(w, w, 4);
+
+	uint16x8_t pal23;
+	if ((flags & DXTn_PALETTE_COLOR0_GT_COLOR1) || (c0 > c1)) {
+		// color0 > color1: ((2*c0)+c1)/3, ((2*c1)+c0)/3
+		// NOTE: x/3 == (x * 0xAAAB) >> 17 for all values used here.
+		pal23 = vaddq_u16(vaddq_u16(w, w), w_swap);
+		pal23 = vshrq_n_u16(mulhi_u16(pal23, 0xAAAB), 1);
+	} else {
+		// color0 <= color1: (c0+c1)/2, then black or transparent.
+		const uint16x4_t pal2 = vget_low_u16(vhaddq_u16(w, w_swap));
+		const uint16x4_t pal3 = (flags & DXTn_PALETTE_COLOR3_ALPHA)
+			? vdup_n_u16(0)
+			: vld1_u16(color3_black.data());
+		pal23 = vcombine_u16(pal2, pal3);
+	}
+
+	return vcombine_u8(vqmovn_u16(w), vqmovn_u16(pal23));
+}
+
+/**
+ * Convert DXTn 2-bit color indexes to byte offsets within the palette.
+ * @param indexes 2-bit color indexes.
+ * @return One byte per pixel, multiplied by 4.
+ */
+static inline uint8x16_t expand_DXTn_indexes_neon(uint32_t indexes)
+{
+	// Each byte of indexes has the four pixels for one row.
+	uint8x16_t idx = vqtbl1q_u8(vreinterpretq_u8_u32(vdupq_n_u32(indexes)), vld1q_u8(idx_sel.data()));
+	idx = vandq_u8(vshlq_u8(idx, vld1q_s8(idx_shr.data())), vdupq_n_u8(3));
+	return vshlq_n_u8(idx, 2);
+}
+
+/**
+ * Decode 16 DXT5-style 3-bit alpha codes.
+ * Also used for BC4/BC5 color channels.
+ * @param alpha_src	[in] DXT5 alpha block.
+ * @return One alpha value per pixel.
+ */
+static inline uint8x16_t decode_DXT5_alpha_neon(const dxt5_alpha *RESTRICT alpha_src)
+{
+	const uint16x8_t va0 = vdupq_n_u16(alpha_src->values[0]);
+	const uint16x8_t va1 = vdupq_n_u16(alpha_src->values[1]);
+
+	// alpha0 > alpha1: 8-value palette
+	// NOTE: x/7 == (x * 9363) >> 16 for all values used here.
+	uint16x8_t pal7 = vmlaq_u16(vmulq_u16(va0, vld1q_u16(alpha7_w0.data())), va1, vld1q_u16(alpha7_w1.data()));
+	pal7 = mulhi_u16(pal7, 9363);
+
+	// alpha0 <= alpha1: 6-value palette, plus 0 and 255
+	// NOTE: x/5 == (x * 13108) >> 16 for all values used here.
+	uint16x8_t pal5 = vmlaq_u16(vmulq_u16(va0, vld1q_u16(alpha5_w0.data())), va1, vld1q_u16(alpha5_w1.data()));
+	pal5 = vorrq_u16(mulhi_u16(pal5, 13108), vld1q_u16(alpha5_or.data()));
+
+	// Select the palette.
+	const uint8x8_t pal = vqmovn_u16(vbslq_u16(vcgtq_u16(va0, va1), pal7, pal5));
+
+	// Extract the 3-bit codes.
+	const uint8x16_t blk = vcombine_u8(vld1_u8(reinterpret_cast<const uint8_t*>(alpha_src)), vdup_n_u8(0));
+	const int16x8_t shr = vld1q_s16(code_shr.data());
+	const uint16x8_t mask = vdupq_n_u16(7);
+	uint16x8_t codes_lo = vreinterpretq_u16_u8(vqtbl1q_u8(blk, vld1q_u8(code_sel_lo.data())));
+	uint16x8_t codes_hi = vreinterpretq_u16_u8(vqtbl1q_u8(blk, vld1q_u8(code_sel_hi.data())));
+	codes_lo = vandq_u16(vshlq_u16(codes_lo, shr), mask);
+	codes_hi = vandq_u16(vshlq_u16(codes_hi, shr), mask);
+
+	const uint8x16_t codes = vcombine_u8(vmovn_u16(codes_lo), vmovn_u16(codes_hi));
+	return vqtbl1q_u8(vcombine_u8(pal, pal), codes);
+}
+
+/**
+ * Look up four pixels from a DXTn color palette.
+ * @param pal	[in] Color palette
+ * @param idx4	[in] Expanded color indexes (from expand_DXTn_indexes_neon())
+ * @param row	[in] Row number
+ * @return Four ARGB32 pixels
+ */
+static inline uint8x16_t lookup_DXTn_row_neon(uint8x16_t pal, uint8x16_t idx4, int row)
+{
+	const uint8x16_t sel = vaddq_u8(vld1q_u8(idx_sel.data()), vdupq_n_u8(static_cast<uint8_t>(row * 4)));
+	const uint8x16_t ctrl = vorrq_u8(vqtbl1q_u8(idx4, sel), vld1q_u8(px_bytes.data()));
+	return vqtbl1q_u8(pal, ctrl);
+}
+
+/**
+ * Place one byte per pixel into a specific ARGB32 byte.
+ * @param v	[in] One byte per pixel
+ * @param sel	[in] Byte selector for row 0
+ * @param row	[in] Row number
+ * @return Four ARGB32 pixels
+ */
+static inline uint8x16_t spread_row_neon(uint8x16_t v, const array<uint8_t, 16> &sel, int row)
+{
+	return vqtbl1q_u8(v, vaddq_u8(vld1q_u8(sel.data()), vdupq_n_u8(static_cast<uint8_t>(row * 4))));
+}
+
+/**
+ * Decode a row of DXT1 tiles.
+ * @tparam flags decode_DXTn_tile_color_palette_neon<>() flags.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] DXT1 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+template<unsigned int flags>
+static void decodeTileRow_DXT1_neon(uint32_t *RESTRICT pDest, int stride_px,
+	const dxt1_block *RESTRICT src, unsigned int tilesX)
+{
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const uint8x16_t pal = decode_DXTn_tile_color_palette_neon<flags>(src);
+		const uint8x16_t idx4 = expand_DXTn_indexes_neon(le32_to_cpu(src->indexes));
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			vst1q_u32(pRow, vreinterpretq_u32_u8(lookup_DXTn_row_neon(pal, idx4, row)));
+		}
+	}
+}
+
+/**
+ * Decode a row of DXT5 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] DXT5 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_DXT5_neon(uint32_t *RESTRICT pDest, int stride_px,
+	const dxt5_block *RESTRICT src, unsigned int tilesX)
+{
+	const uint32x4_t rgb_mask = vdupq_n_u32(0x00FFFFFF);
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const uint8x16_t pal = decode_DXTn_tile_color_palette_neon<0>(&src->colors);
+		const uint8x16_t idx4 = expand_DXTn_indexes_neon(le32_to_cpu(src->colors.indexes));
+		const uint8x16_t alpha = decode_DXT5_alpha_neon(&src->alpha);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			uint32x4_t px = vandq_u32(vreinterpretq_u32_u8(lookup_DXTn_row_neon(pal, idx4, row)), rgb_mask);
+			px = vorrq_u32(px, vreinterpretq_u32_u8(spread_row_neon(alpha, row_sel_b3, row)));
+			vst1q_u32(pRow, px);
+		}
+	}
+}
+
+/**
+ * Decode a row of BC4 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] BC4 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_BC4_neon(uint32_t *RESTRICT pDest, int stride_px,
+	const bc4_block *RESTRICT src, unsigned int tilesX)
+{
+	const uint32x4_t opaque_black = vdupq_n_u32(0xFF000000U);
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const uint8x16_t red = decode_DXT5_alpha_neon(&src->red);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			const uint32x4_t px = vorrq_u32(opaque_black,
+				vreinterpretq_u32_u8(spread_row_neon(red, row_sel_b2, row)));
+			vst1q_u32(pRow, px);
+		}
+	}
+}
+
+/**
+ * Decode a row of BC5 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] BC5 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_BC5_neon(uint32_t *RESTRICT pDest, int stride_px,
+	const bc5_block *RESTRICT src, unsigned int tilesX)
+{
+	const uint32x4_t opaque_black = vdupq_n_u32(0xFF000000U);
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const uint8x16_t red = decode_DXT5_alpha_neon(&src->red);
+		const uint8x16_t green = decode_DXT5_alpha_neon(&src->green);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			uint32x4_t px = vorrq_u32(opaque_black,
+				vreinterpretq_u32_u8(spread_row_neon(red, row_sel_b2, row)));
+			px = vorrq_u32(px, vreinterpretq_u32_u8(spread_row_neon(green, row_sel_b1, row)));
+			vst1q_u32(pRow, px);
+		}
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, decodeTileRow_DXT1_neon<0> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_A1_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, decodeTileRow_DXT1_neon<DXTn_PALETTE_COLOR3_ALPHA> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT5_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return T_fromS3TC_tileRows<dxt5_block, decodeTileRow_DXT5_neon>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC4_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	return T_fromS3TC_tileRows<bc4_block, decodeTileRow_BC4_neon>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * NEON-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC5_neon(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,8,1,0,0};
+	return T_fromS3TC_tileRows<bc5_block, decodeTileRow_BC5_neon>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+} }
@@ -0,0 +1,136 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC_p.hpp: Image decoding functions: S3TC (PRIVATE)       *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "ImageDecoder_common.hpp"
+#include "ImageDecoder_p.hpp"
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// DXT1 block format.
+struct dxt1_block {
+	uint16_t color[2];	// Colors 0 and 1, in RGB565 format.
+	uint32_t indexes;	// Two-bit color indexes.
+};
+ASSERT_STRUCT(dxt1_block, 8);
+
+// DXT5 alpha+codes struct.
+// Also used by BC4/BC5 for color channels.
+union dxt5_alpha {
+	struct {
+		uint8_t values[2];	// Alpha values.
+		uint8_t codes[6];	// Alpha operation codes. (48-bit unsigned; 3-bit per pixel)
+	};
+	uint64_t u64;	// Access the 48-bit code value directly. (Requires shifting.)
+};
+ASSERT_STRUCT(dxt5_alpha, 8);
+
+// DXT5 block format.
+struct dxt5_block {
+	dxt5_alpha alpha;
+	dxt1_block colors;	// DXT1-style color block.
+};
+ASSERT_STRUCT(dxt5_block, 16);
+
+// BC4 block format.
+struct bc4_block {
+	dxt5_alpha red;
+};
+ASSERT_STRUCT(bc4_block, 8);
+
+// BC5 block format.
+struct bc5_block {
+	dxt5_alpha red;
+	dxt5_alpha green;
+};
+ASSERT_STRUCT(bc5_block, 16);
+
+// decode_DXTn_tile_color_palette flags.
+enum ATTR_FLAG_ENUM DXTn_Palette_Flags {
+	DXTn_PALETTE_BIG_ENDIAN		= (1U << 0),
+	DXTn_PALETTE_COLOR3_ALPHA	= (1U << 1),	// GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+	DXTn_PALETTE_COLOR0_GT_COLOR1	= (1U << 2),	// Assume color0 > color1. (DXT2/DXT3)
+};
+
+/**
+ * Decode an S3TC image using a tile row decoder function.
+ * Used by the SIMD-optimized decoders, which write tiles
+ * directly to the rp_image instead of using BlitTile().
+ *
+ * Each call to decodeTileRow() decodes one row of tiles.
+ * (4 pixel rows)
+ *
+ * @tparam block_t	[in] Block type
+ * @tparam decodeTileRow [in] Tile row decoder function
+ * @param width		[in] Image width
+ * @param height	[in] Image height
+ * @param img_buf	[in] Image buffer
+ * @param img_siz	[in] Size of image data [must be >= (tiles * sizeof(block_t))]
+ * @param sBIT		[in] sBIT metadata
+ * @return rp_image, or nullptr on error.
+ */
+template<typename block_t, void (*decodeTileRow)(uint32_t *RESTRICT pDest, int stride_px,
+	const block_t *RESTRICT src, unsigned int tilesX)>
+static inline rp_image_ptr T_fromS3TC_tileRows(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz,
+	const rp_image::sBIT_t &sBIT)
+{
+	rp_image_ptr img;
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// S3TC uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	const size_t expected_size = static_cast<size_t>(tilesX) * static_cast<size_t>(tilesY) * sizeof(block_t);
+	assert(img_siz >= expected_size);
+	if (!img_buf || width <= 0 || height <= 0 || img_siz < expected_size) {
+		return img;
+	}
+
+	// Create an rp_image.
+	img = std::make_shared<rp_image>(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img.reset();
+		return img;
+	}
+
+	const block_t *const blocks = reinterpret_cast<const block_t*>(img_buf);
+	uint32_t *const pBits = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+#pragma omp parallel for default(none) firstprivate(blocks, pBits, stride_px, tilesX, tilesY) schedule(dynamic) num_threads(maxThreads()) if(tilesX * tilesY >= ImageDecoderPrivate::MT_DECODE_MIN_TILES)
+	for (unsigned int y = 0; y < tilesY; y++) {
+		decodeTileRow(&pBits[y * 4 * stride_px], stride_px, &blocks[y * tilesX], tilesX);
+	}
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
@@ -0,0 +1,352 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC_ssse3.cpp: Image decoding functions: S3TC             *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ImageDecoder_S3TC.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
+
+// SSSE3 intrinsics
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Decode a DXTn tile color palette. (S3TC version)
+ * @tparam flags Flags. (See DXTn_Palette_Flags; DXTn_PALETTE_BIG_ENDIAN is not supported.)
+ * @param dxt1_src	[in] DXT1 block.
+ * @return Four ARGB32 palette entries.
+ */
+template<unsigned int flags>
+static inline __m128i decode_DXTn_tile_color_palette_ssse3(const dxt1_block *RESTRICT dxt1_src)
+{
+	const uint16_t c0 = le16_to_cpu(dxt1_src->color[0]);
+	const uint16_t c1 = le16_to_cpu(dxt1_src->color[1]);
+
+	// Convert the first two colors from RGB565.
+	// Each component is shifted to the top of its 16-bit lane, then:
+	// - rshift by 8 to get the high bits
+	// - mulhi to replicate the high bits into the low bits
+	__m128i w = _mm_setr_epi16(c0, c0, c0, 0, c1, c1, c1, 0);
+	w = _mm_and_si128(w, _mm_setr_epi16(0x001F, 0x07E0, 0xF800, 0, 0x001F, 0x07E0, 0xF800, 0));
+	w = _mm_mullo_epi16(w, _mm_setr_epi16(1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0));
+	w = _mm_or_si128(_mm_srli_epi16(w, 8), _mm_mulhi_epu16(w, _mm_setr_epi16(8, 4, 8, 0, 8, 4, 8, 0)));
+	w = _mm_or_si128(w, _mm_setr_epi16(0, 0, 0, 0xFF, 0, 0, 0, 0xFF));
+
+	// Swap color0 and color1.
+	const __m128i w_swap = _mm_shuffle_epi32(w, _MM_SHUFFLE(1,0,3,2));
+
+	// color0 > color1: ((2*c0)+c1)/3, ((2*c1)+c0)/3
+	// NOTE: x/3 == (x * 0xAAAB) >> 17 for all values used here.
+	__m128i pal23_gt = _mm_add_epi16(_mm_add_epi16(w, w), w_swap);
+	pal23_gt = _mm_srli_epi16(_mm_mulhi_epu16(pal23_gt, _mm_set1_epi16(static_cast<int16_t>(0xAAAB))), 1);
+
+	__m128i pal23;
+	if ((flags & DXTn_PALETTE_COLOR0_GT_COLOR1) || (c0 > c1)) {
+		pal23 = pal23_gt;
+	} else {
+		// color0 <= color1: (c0+c1)/2, then black or transparent.
+		pal23 = _mm_srli_epi16(_mm_add_epi16(w, w_swap), 1);
+		pal23 = _mm_unpacklo_epi64(pal23, _mm_setzero_si128());
+		if (!(flags & DXTn_PALETTE_COLOR3_ALPHA)) {
+			pal23 = _mm_or_si128(pal23, _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 0xFF));
+		}
+	}
+
+	return _mm_packus_epi16(w, pal23);
+}
+
+/**
+ * Convert DXTn 2-bit color indexes to byte offsets within the palette.
+ * @param indexes 2-bit color indexes.
+ * @return One byte per pixel, multiplied by 4.
+ */
+static inline __m128i expand_DXTn_indexes_ssse3(uint32_t indexes)
+{
+	// Each byte of indexes has the four pixels for one row.
+	const __m128i x = _mm_cvtsi32_si128(static_cast<int>(indexes));
+	const __m128i mask = _mm_set1_epi8(3);
+	const __m128i i0 = _mm_and_si128(x, mask);
+	const __m128i i1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+	const __m128i i2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+	const __m128i i3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+
+	const __m128i idx = _mm_unpacklo_epi16(_mm_unpacklo_epi8(i0, i1), _mm_unpacklo_epi8(i2, i3));
+	return _mm_slli_epi16(idx, 2);
+}
+
+/**
+ * Decode 16 DXT5-style 3-bit alpha codes.
+ * Also used for BC4/BC5 color channels.
+ * @param alpha_src	[in] DXT5 alpha block.
+ * @return One alpha value per pixel.
+ */
+static inline __m128i decode_DXT5_alpha_ssse3(const dxt5_alpha *RESTRICT alpha_src)
+{
+	const unsigned int a0 = alpha_src->values[0];
+	const unsigned int a1 = alpha_src->values[1];
+	const __m128i va0 = _mm_set1_epi16(static_cast<int16_t>(a0));
+	const __m128i va1 = _mm_set1_epi16(static_cast<int16_t>(a1));
+
+	// alpha0 > alpha1: 8-value palette
+	// NOTE: x/7 == (x * 9363) >> 16 for all values used here.
+	__m128i pal7 = _mm_add_epi16(
+		_mm_mullo_epi16(va0, _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1)),
+		_mm_mullo_epi16(va1, _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6)));
+	pal7 = _mm_mulhi_epu16(pal7, _mm_set1_epi16(9363));
+
+	// alpha0 <= alpha1: 6-value palette, plus 0 and 255
+	// NOTE: x/5 == (x * 13108) >> 16 for all values used here.
+	__m128i pal5 = _mm_add_epi16(
+		_mm_mullo_epi16(va0, _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0)),
+		_mm_mullo_epi16(va1, _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0)));
+	pal5 = _mm_mulhi_epu16(pal5, _mm_set1_epi16(13108));
+	pal5 = _mm_or_si128(pal5, _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+
+	// Select the palette. (values are 8-bit, so signed comparison is fine)
+	const __m128i gt = _mm_cmpgt_epi16(va0, va1);
+	__m128i pal = _mm_or_si128(_mm_and_si128(gt, pal7), _mm_andnot_si128(gt, pal5));
+	pal = _mm_packus_epi16(pal, pal);
+
+	// Extract the 3-bit codes.
+	// Each 16-bit lane gets the two bytes containing its code,
+	// then mullo shifts the code to the top of the lane.
+	const __m128i blk = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(alpha_src));
+	const __m128i code_mul = _mm_setr_epi16(1 << 13, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8);
+	__m128i codes_lo = _mm_shuffle_epi8(blk, _mm_setr_epi8(2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5));
+	__m128i codes_hi = _mm_shuffle_epi8(blk, _mm_setr_epi8(5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,8, 7,8));
+	codes_lo = _mm_srli_epi16(_mm_mullo_epi16(codes_lo, code_mul), 13);
+	codes_hi = _mm_srli_epi16(_mm_mullo_epi16(codes_hi, code_mul), 13);
+
+	return _mm_shuffle_epi8(pal, _mm_packus_epi16(codes_lo, codes_hi));
+}
+
+// Byte selectors for row 0. Add (row * 4) for the other rows.
+// NOTE: 0x80 + 12 still has the high bit set, so zeroed bytes stay zeroed.
+#define ROW_SEL_COLOR	_mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3)
+#define ROW_SEL_B3	_mm_setr_epi8(-128,-128,-128,0, -128,-128,-128,1, -128,-128,-128,2, -128,-128,-128,3)
+#define ROW_SEL_B2	_mm_setr_epi8(-128,-128,0,-128, -128,-128,1,-128, -128,-128,2,-128, -128,-128,3,-128)
+#define ROW_SEL_B1	_mm_setr_epi8(-128,0,-128,-128, -128,1,-128,-128, -128,2,-128,-128, -128,3,-128,-128)
+
+/**
+ * Look up four pixels from a DXTn color palette.
+ * @param pal	[in] Color palette
+ * @param idx4	[in] Expanded color indexes (from expand_DXTn_indexes_ssse3())
+ * @param row4	[in] Row number, multiplied by 4 (set1_epi8)
+ * @return Four ARGB32 pixels
+ */
+static inline __m128i lookup_DXTn_row_ssse3(__m128i pal, __m128i idx4, __m128i row4)
+{
+	__m128i ctrl = _mm_shuffle_epi8(idx4, _mm_add_epi8(ROW_SEL_COLOR, row4));
+	ctrl = _mm_or_si128(ctrl, _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3));
+	return _mm_shuffle_epi8(pal, ctrl);
+}
+
+/**
+ * Decode a row of DXT1 tiles.
+ * @tparam flags decode_DXTn_tile_color_palette_ssse3<>() flags.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] DXT1 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+template<unsigned int flags>
+static void decodeTileRow_DXT1_ssse3(uint32_t *RESTRICT pDest, int stride_px,
+	const dxt1_block *RESTRICT src, unsigned int tilesX)
+{
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const __m128i pal = decode_DXTn_tile_color_palette_ssse3<flags>(src);
+		const __m128i idx4 = expand_DXTn_indexes_ssse3(le32_to_cpu(src->indexes));
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			const __m128i row4 = _mm_set1_epi8(static_cast<char>(row * 4));
+			const __m128i px = lookup_DXTn_row_ssse3(pal, idx4, row4);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow), px);
+		}
+	}
+}
+
+/**
+ * Decode a row of DXT5 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] DXT5 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_DXT5_ssse3(uint32_t *RESTRICT pDest, int stride_px,
+	const dxt5_block *RESTRICT src, unsigned int tilesX)
+{
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const __m128i pal = decode_DXTn_tile_color_palette_ssse3<0>(&src->colors);
+		const __m128i idx4 = expand_DXTn_indexes_ssse3(le32_to_cpu(src->colors.indexes));
+		const __m128i alpha = decode_DXT5_alpha_ssse3(&src->alpha);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			const __m128i row4 = _mm_set1_epi8(static_cast<char>(row * 4));
+			__m128i px = _mm_and_si128(lookup_DXTn_row_ssse3(pal, idx4, row4), rgb_mask);
+			px = _mm_or_si128(px, _mm_shuffle_epi8(alpha, _mm_add_epi8(ROW_SEL_B3, row4)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow), px);
+		}
+	}
+}
+
+/**
+ * Decode a row of BC4 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] BC4 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_BC4_ssse3(uint32_t *RESTRICT pDest, int stride_px,
+	const bc4_block *RESTRICT src, unsigned int tilesX)
+{
+	const __m128i opaque_black = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const __m128i red = decode_DXT5_alpha_ssse3(&src->red);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			const __m128i row4 = _mm_set1_epi8(static_cast<char>(row * 4));
+			const __m128i px = _mm_or_si128(opaque_black,
+				_mm_shuffle_epi8(red, _mm_add_epi8(ROW_SEL_B2, row4)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow), px);
+		}
+	}
+}
+
+/**
+ * Decode a row of BC5 tiles.
+ * @param pDest		[out] Destination image (top-left pixel of the tile row)
+ * @param stride_px	[in] Destination stride, in pixels
+ * @param src		[in] BC5 blocks
+ * @param tilesX	[in] Number of tiles in the row
+ */
+static void decodeTileRow_BC5_ssse3(uint32_t *RESTRICT pDest, int stride_px,
+	const bc5_block *RESTRICT src, unsigned int tilesX)
+{
+	const __m128i opaque_black = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+
+	for (unsigned int x = 0; x < tilesX; x++, src++, pDest += 4) {
+		const __m128i red = decode_DXT5_alpha_ssse3(&src->red);
+		const __m128i green = decode_DXT5_alpha_ssse3(&src->green);
+
+		uint32_t *pRow = pDest;
+		for (int row = 0; row < 4; row++, pRow += stride_px) {
+			const __m128i row4 = _mm_set1_epi8(static_cast<char>(row * 4));
+			__m128i px = _mm_or_si128(opaque_black,
+				_mm_shuffle_epi8(red, _mm_add_epi8(ROW_SEL_B2, row4)));
+			px = _mm_or_si128(px, _mm_shuffle_epi8(green, _mm_add_epi8(ROW_SEL_B1, row4)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow), px);
+		}
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, decodeTileRow_DXT1_ssse3<0> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromS3TC_tileRows<dxt1_block, decodeTileRow_DXT1_ssse3<DXTn_PALETTE_COLOR3_ALPHA> >(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return T_fromS3TC_tileRows<dxt5_block, decodeTileRow_DXT5_ssse3>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	return T_fromS3TC_tileRows<bc4_block, decodeTileRow_BC4_ssse3>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image_ptr fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz)
+{
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,8,1,0,0};
+	return T_fromS3TC_tileRows<bc5_block, decodeTileRow_BC5_ssse3>(
+		width, height, img_buf, img_siz, sBIT);
+}
+
+} }
@@ -0,0 +1,57 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_common.cpp: Common image decoder functions.                *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ImageDecoder_common.hpp"
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif /* _OPENMP */
+
+// C includes (C++ namespace)
+#include <cassert>
+
+// C++ STL classes
+#include <atomic>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// Maximum number of threads for block-compressed texture decoding.
+// 0 == use the OpenMP default.
+static std::atomic<int> s_maxThreads(0);
+
+/**
+ * Set the maximum number of threads to use when decoding
+ * block-compressed textures. (S3TC, BC4/BC5, BC7, ETC1/ETC2/EAC, ASTC)
+ *
+ * Tile rows are only decoded in parallel if the image is large enough,
+ * and if OpenMP support is enabled.
+ *
+ * @param maxThreads Maximum number of threads (0 for default; 1 to disable multithreading)
+ */
+void setMaxThreads(int maxThreads)
+{
+	assert(maxThreads >= 0);
+	s_maxThreads.store((maxThreads >= 0) ? maxThreads : 0, std::memory_order_relaxed);
+}
+
+/**
+ * Get the maximum number of threads to use when decoding
+ * block-compressed textures.
+ * @return Maximum number of threads (always 1 if OpenMP support is disabled)
+ */
+int maxThreads(void)
+{
+#ifdef _OPENMP
+	const int maxThreads = s_maxThreads.load(std::memory_order_relaxed);
+	return (maxThreads > 0) ? maxThreads : omp_get_max_threads();
+#else /* !_OPENMP */
+	return 1;
+#endif /* _OPENMP */
+}
+
+} }
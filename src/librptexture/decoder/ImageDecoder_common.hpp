@@ -29,6 +29,7 @@
 #  include "librpcpuid/cpuflags_x86.h"
 #  define IMAGEDECODER_HAS_SSE2 1
 #  define IMAGEDECODER_HAS_SSSE3 1
+#  define IMAGEDECODER_HAS_AVX2 1
 #elif defined(HAVE_ARM_NEON_H)
 #  if defined(RP_CPU_ARM) || defined(RP_CPU_ARM64)
 #    include "librpcpuid/cpuflags_arm.h"
@@ -156,4 +157,24 @@ enum class PixelFormat : uint8_t {
 #endif
 };
 
+/**
+ * Set the maximum number of threads to use when decoding
+ * block-compressed textures. (S3TC, BC4/BC5, BC7, ETC1/ETC2/EAC, ASTC)
+ *
+ * Tile rows are only decoded in parallel if the image is large enough,
+ * and if OpenMP support is enabled.
+ *
+ * @param maxThreads Maximum number of threads (0 for default; 1 to disable multithreading)
+ */
+RP_LIBROMDATA_PUBLIC
+void setMaxThreads(int maxThreads);
+
+/**
+ * Get the maximum number of threads to use when decoding
+ * block-compressed textures.
+ * @return Maximum number of threads (always 1 if OpenMP support is disabled)
+ */
+RP_LIBROMDATA_PUBLIC
+int maxThreads(void);
+
 } }
@@ -24,6 +24,14 @@
 
 namespace LibRpTexture { namespace ImageDecoderPrivate {
 
+/**
+ * Minimum number of tiles for multithreaded decoding.
+ * Tile rows of smaller images are decoded on a single thread,
+ * since the OpenMP thread team overhead would outweigh the benefit.
+ * (default is 4,096 tiles; 256x256 for 4x4 tiles)
+ */
+static constexpr unsigned int MT_DECODE_MIN_TILES = (256 * 256) / (4 * 4);
+
 /**
  * Blit a tile to an rp_image. (pixel*)
  * NOTE: No bounds checking is done.
@@ -484,8 +484,8 @@ rp_image_const_ptr PalmOS_Tbmp_Private::loadTbmp(void)
 					palette_4bpp.data(), palette_4bpp.size() * sizeof(uint32_t), rowBytes);
 			if (img) {
 				// Set the sBIT metadata.
-				// NOTE: Setting the grayscale value, though we're
-				// not saving grayscale PNGs at the moment.
+				// NOTE: RpPngWriter only uses the grayscale value for ARGB32
+				// images. This is CI8, so it's still saved as a paletted PNG.
 				static const rp_image::sBIT_t sBIT = {4,4,4,4,0};
 				img->set_sBIT(sBIT);
 			}
@@ -212,6 +212,7 @@ public:
 	 * @param i Line number.
 	 * @return Line of image data, or nullptr if i is out of range.
 	 */
+	RP_LIBROMDATA_PUBLIC
 	void *scanLine(int i);
 
 	/**
@@ -233,6 +234,7 @@ public:
 	 * Get the image palette.
 	 * @return Pointer to image palette, or nullptr if not a paletted image.
 	 */
+	RP_LIBROMDATA_PUBLIC
 	uint32_t *palette(void);
 
 	/**
@@ -381,6 +383,81 @@ public:
 		Alignment alignment = AlignDefault,
 		uint32_t bgColor = 0x00000000) const;
 
+	/**
+	 * Scaling methods for scaled().
+	 */
+	enum class ScaleMethod : uint8_t {
+		Nearest,	// Nearest-neighbor
+		Bilinear,	// Bilinear interpolation (2x2 source pixels)
+		Area,		// Area averaging (box filter); bilinear when upscaling
+	};
+
+	/**
+	 * Scale the rp_image.
+	 * Standard version using regular C++ code.
+	 *
+	 * A new ARGB32 rp_image will be created with the specified
+	 * dimensions. CI8 images will be converted to ARGB32.
+	 *
+	 * Bilinear and Area filtering is done on premultiplied
+	 * pixels using fixed-point math, so the result is the same
+	 * for all CPU-optimized versions.
+	 *
+	 * @param width New width
+	 * @param height New height
+	 * @param method Scaling method
+	 * @return New rp_image with a scaled version of the original, or nullptr on error.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	std::shared_ptr<rp_image> scaled_cpp(int width, int height, ScaleMethod method = ScaleMethod::Area) const;
+
+#ifdef RP_IMAGE_HAS_SSE2
+	/**
+	 * Scale the rp_image.
+	 * SSE2-optimized version.
+	 *
+	 * A new ARGB32 rp_image will be created with the specified
+	 * dimensions. CI8 images will be converted to ARGB32.
+	 *
+	 * @param width New width
+	 * @param height New height
+	 * @param method Scaling method
+	 * @return New rp_image with a scaled version of the original, or nullptr on error.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	std::shared_ptr<rp_image> scaled_sse2(int width, int height, ScaleMethod method = ScaleMethod::Area) const;
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+	/**
+	 * Scale the rp_image.
+	 * NEON-optimized version.
+	 *
+	 * A new ARGB32 rp_image will be created with the specified
+	 * dimensions. CI8 images will be converted to ARGB32.
+	 *
+	 * @param width New width
+	 * @param height New height
+	 * @param method Scaling method
+	 * @return New rp_image with a scaled version of the original, or nullptr on error.
+	 */
+	RP_LIBROMDATA_PUBLIC
+	std::shared_ptr<rp_image> scaled_neon(int width, int height, ScaleMethod method = ScaleMethod::Area) const;
+#endif /* RP_IMAGE_HAS_NEON */
+
+	/**
+	 * Scale the rp_image.
+	 *
+	 * A new ARGB32 rp_image will be created with the specified
+	 * dimensions. CI8 images will be converted to ARGB32.
+	 *
+	 * @param width New width
+	 * @param height New height
+	 * @param method Scaling method
+	 * @return New rp_image with a scaled version of the original, or nullptr on error.
+	 */
+	inline std::shared_ptr<rp_image> scaled(int width, int height, ScaleMethod method = ScaleMethod::Area) const;
+
 	/**
 	 * Un-premultiply this image.
 	 * Standard version using regular C++ code.
@@ -568,6 +645,41 @@ public:
 typedef std::shared_ptr<rp_image> rp_image_ptr;
 typedef std::shared_ptr<const rp_image> rp_image_const_ptr;
 
+/**
+ * Scale the rp_image.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param method Scaling method
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+inline rp_image_ptr rp_image::scaled(int width, int height, ScaleMethod method) const
+{
+#if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
+	// amd64 always has SSE2.
+	return scaled_sse2(width, height, method);
+#elif defined(RP_IMAGE_ALWAYS_HAS_NEON)
+	return scaled_neon(width, height, method);
+#else
+#  if defined(RP_IMAGE_HAS_SSE2)
+	if (RP_CPU_x86_HasSSE2()) {
+		return scaled_sse2(width, height, method);
+	} else
+#  endif /* RP_IMAGE_HAS_SSE2 */
+#  ifdef RP_IMAGE_HAS_NEON
+	if (RP_CPU_arm_HasNEON()) {
+		return scaled_neon(width, height, method);
+	} else
+#  endif /* RP_IMAGE_HAS_NEON */
+	{
+		return scaled_cpp(width, height, method);
+	}
+#endif
+}
+
 /**
  * Un-premultiply this image.
  *
@@ -9,11 +9,20 @@
 #include "rp_image.hpp"
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
+#include "rp_image_scale_p.hpp"
 
 // C includes (C++ namespace)
+#include <cassert>
 #include <cmath>
 #include <cstring>
 
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <vector>
+using std::array;
+using std::vector;
+
 // Other rom-properties libraries
 #include "librpbyteswap/byteswap_rp.h"
 
@@ -1087,3 +1096,372 @@ int rp_image::unswizzle_AExp(void)
 }
 
 }
+
+/** Scaling functions **/
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/**
+ * Calculate the filter contributions for a single axis.
+ * @param contrib	[out] Filter contributions
+ * @param src_len	[in] Source length
+ * @param dest_len	[in] Destination length
+ * @param method	[in] Scaling method (Bilinear or Area)
+ */
+void calc_contrib(Contrib &contrib, int src_len, int dest_len, rp_image::ScaleMethod method)
+{
+	assert(src_len > 0);
+	assert(dest_len > 0);
+	assert(method == rp_image::ScaleMethod::Bilinear || method == rp_image::ScaleMethod::Area);
+
+	static constexpr int64_t ONE = (1 << WEIGHT_BITS);
+
+	contrib.taps.resize(dest_len);
+	contrib.weights.clear();
+	contrib.max_count = 1;
+
+	// NOTE: Using integer math only so the weights are identical
+	// on all systems, regardless of floating-point behavior.
+	if (method == rp_image::ScaleMethod::Area && dest_len < src_len) {
+		// Area averaging.
+		// In units of (1/dest_len) source pixels, destination pixel i
+		// covers [i*src_len, (i+1)*src_len), and source pixel j
+		// covers [j*dest_len, (j+1)*dest_len).
+		contrib.weights.reserve(dest_len * ((src_len / dest_len) + 2));
+		for (int i = 0; i < dest_len; i++) {
+			const int64_t d_start = static_cast<int64_t>(i) * src_len;
+			const int64_t d_end = d_start + src_len;
+			const int start = static_cast<int>(d_start / dest_len);
+			const int end = static_cast<int>((d_end - 1) / dest_len);
+
+			Contrib::Tap &tap = contrib.taps[i];
+			tap.start = start;
+			tap.count = end - start + 1;
+			tap.offset = static_cast<int>(contrib.weights.size());
+			if (tap.count > contrib.max_count) {
+				contrib.max_count = tap.count;
+			}
+
+			// Distribute the weights using the cumulative coverage
+			// so the sum is always exactly ONE.
+			int64_t covered = 0;
+			int64_t prev_w = 0;
+			for (int j = start; j <= end; j++) {
+				const int64_t s_start = static_cast<int64_t>(j) * dest_len;
+				const int64_t s_end = s_start + dest_len;
+				covered += std::min(s_end, d_end) - std::max(s_start, d_start);
+				const int64_t cur_w = ((covered * ONE) + (src_len / 2)) / src_len;
+				contrib.weights.push_back(static_cast<int16_t>(cur_w - prev_w));
+				prev_w = cur_w;
+			}
+		}
+		return;
+	}
+
+	// Bilinear interpolation.
+	// Source position for destination pixel i, sampling at pixel centers:
+	// ((2*i + 1) * src_len - dest_len) / (2 * dest_len)
+	contrib.weights.reserve(dest_len * 2);
+	const int64_t den = static_cast<int64_t>(dest_len) * 2;
+	for (int i = 0; i < dest_len; i++) {
+		const int64_t num = ((static_cast<int64_t>(i) * 2) + 1) * src_len - dest_len;
+
+		Contrib::Tap &tap = contrib.taps[i];
+		tap.offset = static_cast<int>(contrib.weights.size());
+
+		int64_t w1 = 0;
+		if (num <= 0) {
+			tap.start = 0;
+		} else {
+			tap.start = static_cast<int>(num / den);
+			if (tap.start >= src_len - 1) {
+				tap.start = src_len - 1;
+			} else {
+				w1 = (((num % den) * ONE) + (den / 2)) / den;
+			}
+		}
+
+		if (w1 == 0) {
+			tap.count = 1;
+			contrib.weights.push_back(static_cast<int16_t>(ONE));
+		} else if (w1 == ONE) {
+			tap.start++;
+			tap.count = 1;
+			contrib.weights.push_back(static_cast<int16_t>(ONE));
+		} else {
+			tap.count = 2;
+			contrib.weights.push_back(static_cast<int16_t>(ONE - w1));
+			contrib.weights.push_back(static_cast<int16_t>(w1));
+			contrib.max_count = 2;
+		}
+	}
+}
+
+/**
+ * Premultiplication kernel.
+ * Standard version using regular C++ code.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param src		[in] Source row (ARGB32)
+ * @param width		[in] Width of each row, in pixels
+ */
+void premultiply_row_cpp(uint32_t *dest, const uint32_t *src, int width)
+{
+	for (; width > 0; width--, dest++, src++) {
+		*dest = premultiply_pixel_scale(*src);
+	}
+}
+
+/**
+ * Horizontal scaling kernel.
+ * Standard version using regular C++ code.
+ *
+ * @param dest		[out] Destination row (contrib.taps.size() * 4 values)
+ * @param src		[in] Source row
+ * @param contrib	[in] Horizontal filter contributions
+ */
+void scale_h_cpp(int16_t *dest, const uint32_t *src, const Contrib &contrib)
+{
+	static constexpr int32_t ROUND = (1 << (H_SHIFT - 1));
+	const uint8_t *const src8 = reinterpret_cast<const uint8_t*>(src);
+	const int16_t *const weights = contrib.weights.data();
+
+	for (const Contrib::Tap &tap : contrib.taps) {
+		const uint8_t *p = &src8[tap.start * 4];
+		const int16_t *w = &weights[tap.offset];
+		array<int32_t, 4> acc = {{0, 0, 0, 0}};
+		for (int k = tap.count; k > 0; k--, p += 4, w++) {
+			acc[0] += p[0] * *w;
+			acc[1] += p[1] * *w;
+			acc[2] += p[2] * *w;
+			acc[3] += p[3] * *w;
+		}
+		dest[0] = static_cast<int16_t>((acc[0] + ROUND) >> H_SHIFT);
+		dest[1] = static_cast<int16_t>((acc[1] + ROUND) >> H_SHIFT);
+		dest[2] = static_cast<int16_t>((acc[2] + ROUND) >> H_SHIFT);
+		dest[3] = static_cast<int16_t>((acc[3] + ROUND) >> H_SHIFT);
+		dest += 4;
+	}
+}
+
+/**
+ * Vertical scaling kernel.
+ * Standard version using regular C++ code.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param rows		[in] Horizontally-scaled source rows
+ * @param weights	[in] Weights for each source row
+ * @param count		[in] Number of source rows
+ * @param width		[in] Width of each row, in pixels
+ */
+void scale_v_cpp(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width)
+{
+	static constexpr int32_t ROUND = (1 << (V_SHIFT - 1));
+	uint8_t *const dest8 = reinterpret_cast<uint8_t*>(dest);
+
+	const int values = width * 4;
+	for (int i = 0; i < values; i++) {
+		int32_t acc = 0;
+		for (int k = 0; k < count; k++) {
+			acc += rows[k][i] * weights[k];
+		}
+		acc = (acc + ROUND) >> V_SHIFT;
+		dest8[i] = static_cast<uint8_t>(acc > 255 ? 255 : acc);
+	}
+}
+
+/**
+ * Scale an rp_image using nearest-neighbor.
+ * No filtering is done, so the image doesn't need to be premultiplied.
+ * @param img		[in] Source image
+ * @param width		[in] New width
+ * @param height	[in] New height
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+static rp_image_ptr scale_image_nearest(const rp_image *img, int width, int height)
+{
+	rp_image_ptr dest_img = std::make_shared<rp_image>(width, height, rp_image::Format::ARGB32);
+	if (!dest_img->isValid()) {
+		dest_img.reset();
+		return dest_img;
+	}
+
+	const int src_width = img->width();
+	const int src_height = img->height();
+
+	// Source column for each destination column.
+	vector<int> src_x(width);
+	for (int x = 0; x < width; x++) {
+		src_x[x] = static_cast<int>(((static_cast<int64_t>(x) * 2 + 1) * src_width) / (static_cast<int64_t>(width) * 2));
+	}
+
+	// CI8 palette
+	array<uint32_t, 256> palette;
+	const bool is_CI8 = (img->format() == rp_image::Format::CI8);
+	if (is_CI8) {
+		palette.fill(0);
+		const unsigned int palette_len = std::min(img->palette_len(), 256U);
+		std::copy(img->palette(), img->palette() + palette_len, palette.begin());
+	}
+
+	for (int y = 0; y < height; y++) {
+		const int sy = static_cast<int>(((static_cast<int64_t>(y) * 2 + 1) * src_height) / (static_cast<int64_t>(height) * 2));
+		uint32_t *dest = static_cast<uint32_t*>(dest_img->scanLine(y));
+		if (is_CI8) {
+			const uint8_t *const src = static_cast<const uint8_t*>(img->scanLine(sy));
+			for (int x = 0; x < width; x++) {
+				dest[x] = palette[src[src_x[x]]];
+			}
+		} else {
+			const uint32_t *const src = static_cast<const uint32_t*>(img->scanLine(sy));
+			for (int x = 0; x < width; x++) {
+				dest[x] = src[src_x[x]];
+			}
+		}
+	}
+
+	return dest_img;
+}
+
+/**
+ * Scale an rp_image using the specified kernels.
+ * @param img		[in] Source image
+ * @param width		[in] New width
+ * @param height	[in] New height
+ * @param method	[in] Scaling method
+ * @param kernels	[in] Scaling kernels
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr scale_image(const rp_image *img, int width, int height, rp_image::ScaleMethod method,
+	const Kernels &kernels)
+{
+	rp_image_ptr dest_img;
+
+	// NOTE: No assertions here; invalid sizes are a runtime error.
+	if (width <= 0 || height <= 0 || !img->isValid()) {
+		// Cannot scale the image.
+		return dest_img;
+	}
+
+	const rp_image::Format format = img->format();
+	if (format != rp_image::Format::ARGB32 && format != rp_image::Format::CI8) {
+		// Unsupported format.
+		return dest_img;
+	}
+
+	const int src_width = img->width();
+	const int src_height = img->height();
+	if (width == src_width && height == src_height) {
+		// No scaling is necessary.
+		dest_img = img->dup_ARGB32();
+		return dest_img;
+	}
+
+	if (method == rp_image::ScaleMethod::Nearest) {
+		dest_img = scale_image_nearest(img, width, height);
+	} else {
+		dest_img = std::make_shared<rp_image>(width, height, rp_image::Format::ARGB32);
+		if (!dest_img->isValid()) {
+			dest_img.reset();
+			return dest_img;
+		}
+
+		Contrib h_contrib, v_contrib;
+		calc_contrib(h_contrib, src_width, width, method);
+		calc_contrib(v_contrib, src_height, height, method);
+
+		// Premultiplied CI8 palette
+		array<uint32_t, 256> palette;
+		const bool is_CI8 = (format == rp_image::Format::CI8);
+		if (is_CI8) {
+			palette.fill(0);
+			const unsigned int palette_len = std::min(img->palette_len(), 256U);
+			const uint32_t *const src_pal = img->palette();
+			for (unsigned int i = 0; i < palette_len; i++) {
+				palette[i] = premultiply_pixel_scale(src_pal[i]);
+			}
+		}
+
+		// Horizontally-scaled rows are stored in a ring buffer.
+		// Vertical filter windows are monotonic, so rows that
+		// fall out of the window are never needed again.
+		const int ring_len = v_contrib.max_count;
+		const size_t inter_stride = static_cast<size_t>(width) * 4;
+		vector<int16_t> inter(inter_stride * ring_len);
+		vector<uint32_t> src_row(src_width);
+		vector<const int16_t*> rows(ring_len);
+
+		int next_row = 0;
+		for (int y = 0; y < height; y++) {
+			const Contrib::Tap &tap = v_contrib.taps[y];
+			if (next_row < tap.start) {
+				next_row = tap.start;
+			}
+			for (; next_row < tap.start + tap.count; next_row++) {
+				// Premultiply the source row.
+				if (is_CI8) {
+					const uint8_t *const src = static_cast<const uint8_t*>(img->scanLine(next_row));
+					for (int x = 0; x < src_width; x++) {
+						src_row[x] = palette[src[x]];
+					}
+				} else {
+					kernels.premultiply_row(src_row.data(),
+						static_cast<const uint32_t*>(img->scanLine(next_row)), src_width);
+				}
+				kernels.scale_h(&inter[(next_row % ring_len) * inter_stride], src_row.data(), h_contrib);
+			}
+
+			for (int k = 0; k < tap.count; k++) {
+				rows[k] = &inter[((tap.start + k) % ring_len) * inter_stride];
+			}
+			kernels.scale_v(static_cast<uint32_t*>(dest_img->scanLine(y)), rows.data(),
+				&v_contrib.weights[tap.offset], tap.count, width);
+		}
+
+		dest_img->un_premultiply();
+	}
+
+	if (!dest_img) {
+		return dest_img;
+	}
+
+	// Copy sBIT if it's set.
+	rp_image::sBIT_t sBIT;
+	if (img->get_sBIT(&sBIT) == 0) {
+		dest_img->set_sBIT(sBIT);
+	}
+
+	return dest_img;
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * Standard version using regular C++ code.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * Bilinear and Area filtering is done on premultiplied
+ * pixels using fixed-point math, so the result is the same
+ * for all CPU-optimized versions.
+ *
+ * @param width New width
+ * @param height New height
+ * @param method Scaling method
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_cpp(int width, int height, ScaleMethod method) const
+{
+	static const RpImageScale::Kernels kernels = {
+		RpImageScale::premultiply_row_cpp,
+		RpImageScale::scale_h_cpp,
+		RpImageScale::scale_v_cpp,
+	};
+	return RpImageScale::scale_image(this, width, height, method, kernels);
+}
+
+}
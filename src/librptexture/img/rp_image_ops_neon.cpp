@@ -10,6 +10,7 @@
 #include "rp_image.hpp"
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
+#include "rp_image_scale_p.hpp"
 
 // Other rom-properties libraries
 #include "librpbyteswap/byteswap_rp.h"
@@ -267,3 +268,150 @@ int rp_image::swizzle_neon(const char *swz_spec)
 }
 
 }
+
+/** Scaling functions **/
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/**
+ * Premultiplication kernel.
+ * NEON-optimized version.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param src		[in] Source row (ARGB32)
+ * @param width		[in] Width of each row, in pixels
+ */
+void premultiply_row_neon(uint32_t *dest, const uint32_t *src, int width)
+{
+	const uint32x4_t alpha_mask = vdupq_n_u32(0xFF000000);
+
+	// Process four pixels per iteration.
+	// Same formula as premultiply_pixel(), applied to all channels:
+	// t = c * a; c = (t + (t >> 8) + 0x80) >> 8
+	// Alpha == 0 results in 0, as required by premultiply_pixel_scale().
+	for (; width >= 4; width -= 4, dest += 4, src += 4) {
+		const uint32x4_t px = vld1q_u32(src);
+
+		// Replicate alpha into all four bytes of each pixel.
+		const uint8x16_t a8 = vreinterpretq_u8_u32(vmulq_n_u32(vshrq_n_u32(px, 24), 0x01010101));
+		const uint8x16_t c8 = vreinterpretq_u8_u32(px);
+
+		uint16x8_t t_lo = vmull_u8(vget_low_u8(c8), vget_low_u8(a8));
+		uint16x8_t t_hi = vmull_u8(vget_high_u8(c8), vget_high_u8(a8));
+		t_lo = vsraq_n_u16(t_lo, t_lo, 8);
+		t_hi = vsraq_n_u16(t_hi, t_hi, 8);
+		const uint32x4_t res = vreinterpretq_u32_u8(
+			vcombine_u8(vrshrn_n_u16(t_lo, 8), vrshrn_n_u16(t_hi, 8)));
+
+		// Restore the original alpha channel.
+		vst1q_u32(dest, vbslq_u32(alpha_mask, px, res));
+	}
+
+	// Remaining pixels.
+	for (; width > 0; width--, dest++, src++) {
+		*dest = premultiply_pixel_scale(*src);
+	}
+}
+
+/**
+ * Horizontal scaling kernel.
+ * NEON-optimized version.
+ *
+ * @param dest		[out] Destination row (contrib.taps.size() * 4 values)
+ * @param src		[in] Source row
+ * @param contrib	[in] Horizontal filter contributions
+ */
+void scale_h_neon(int16_t *dest, const uint32_t *src, const Contrib &contrib)
+{
+	const int16_t *const weights = contrib.weights.data();
+
+	for (const Contrib::Tap &tap : contrib.taps) {
+		const uint32_t *p = &src[tap.start];
+		const int16_t *w = &weights[tap.offset];
+		int32x4_t acc = vdupq_n_s32(0);
+
+		for (int k = tap.count; k > 0; k--, p++, w++) {
+			const uint8x8_t px8 = vreinterpret_u8_u32(vld1_dup_u32(p));
+			const int16x4_t px16 = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(px8)));
+			acc = vmlal_n_s16(acc, px16, *w);
+		}
+
+		// NOTE: vrshrq_n_s32() rounds the same way as the C++ version.
+		vst1_s16(dest, vmovn_s32(vrshrq_n_s32(acc, H_SHIFT)));
+		dest += 4;
+	}
+}
+
+/**
+ * Vertical scaling kernel.
+ * NEON-optimized version.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param rows		[in] Horizontally-scaled source rows
+ * @param weights	[in] Weights for each source row
+ * @param count		[in] Number of source rows
+ * @param width		[in] Width of each row, in pixels
+ */
+void scale_v_neon(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width)
+{
+	uint8_t *dest8 = reinterpret_cast<uint8_t*>(dest);
+
+	// Process two pixels (eight values) per iteration.
+	const int values = width * 4;
+	int i = 0;
+	for (; i + 8 <= values; i += 8, dest8 += 8) {
+		int32x4_t acc_lo = vdupq_n_s32(0);
+		int32x4_t acc_hi = vdupq_n_s32(0);
+
+		for (int k = 0; k < count; k++) {
+			const int16x8_t v = vld1q_s16(&rows[k][i]);
+			acc_lo = vmlal_n_s16(acc_lo, vget_low_s16(v), weights[k]);
+			acc_hi = vmlal_n_s16(acc_hi, vget_high_s16(v), weights[k]);
+		}
+
+		const uint16x8_t px16 = vcombine_u16(
+			vqmovun_s32(vrshrq_n_s32(acc_lo, V_SHIFT)),
+			vqmovun_s32(vrshrq_n_s32(acc_hi, V_SHIFT)));
+		vst1_u8(dest8, vqmovn_u16(px16));
+	}
+
+	if (i < values) {
+		// Last pixel. (four values)
+		int32x4_t acc = vdupq_n_s32(0);
+		for (int k = 0; k < count; k++) {
+			acc = vmlal_n_s16(acc, vld1_s16(&rows[k][i]), weights[k]);
+		}
+
+		const uint16x4_t px16 = vqmovun_s32(vrshrq_n_s32(acc, V_SHIFT));
+		const uint8x8_t px8 = vqmovn_u16(vcombine_u16(px16, px16));
+		vst1_lane_u32(reinterpret_cast<uint32_t*>(dest8), vreinterpret_u32_u8(px8), 0);
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * NEON-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param method Scaling method
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_neon(int width, int height, ScaleMethod method) const
+{
+	static const RpImageScale::Kernels kernels = {
+		RpImageScale::premultiply_row_neon,
+		RpImageScale::scale_h_neon,
+		RpImageScale::scale_v_neon,
+	};
+	return RpImageScale::scale_image(this, width, height, method, kernels);
+}
+
+}
@@ -10,6 +10,7 @@
 #include "rp_image.hpp"
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
+#include "rp_image_scale_p.hpp"
 
 // SSE2 intrinsics
 #include <emmintrin.h>
@@ -88,3 +89,196 @@ int rp_image::apply_chroma_key_sse2(uint32_t key)
 }
 
 }
+
+/** Scaling functions **/
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/**
+ * Premultiplication kernel.
+ * SSE2-optimized version.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param src		[in] Source row (ARGB32)
+ * @param width		[in] Width of each row, in pixels
+ */
+void premultiply_row_sse2(uint32_t *dest, const uint32_t *src, int width)
+{
+	const __m128i xmm_zero = _mm_setzero_si128();
+	const __m128i xmm_round = _mm_set1_epi16(0x80);
+	const __m128i xmm_alpha_mask = _mm_set1_epi32(0xFF000000);
+
+	// Process four pixels per iteration.
+	// Same formula as premultiply_pixel(), applied to all channels:
+	// t = c * a; c = (t + (t >> 8) + 0x80) >> 8
+	// Alpha == 0 results in 0, as required by premultiply_pixel_scale().
+	for (; width >= 4; width -= 4, dest += 4, src += 4) {
+		const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+		__m128i px_lo = _mm_unpacklo_epi8(px, xmm_zero);
+		__m128i px_hi = _mm_unpackhi_epi8(px, xmm_zero);
+		__m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px_lo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+		__m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px_hi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+
+		px_lo = _mm_mullo_epi16(px_lo, a_lo);
+		px_hi = _mm_mullo_epi16(px_hi, a_hi);
+		px_lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(px_lo, _mm_srli_epi16(px_lo, 8)), xmm_round), 8);
+		px_hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(px_hi, _mm_srli_epi16(px_hi, 8)), xmm_round), 8);
+
+		// Restore the original alpha channel.
+		__m128i res = _mm_packus_epi16(px_lo, px_hi);
+		res = _mm_or_si128(_mm_andnot_si128(xmm_alpha_mask, res), _mm_and_si128(xmm_alpha_mask, px));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), res);
+	}
+
+	// Remaining pixels.
+	for (; width > 0; width--, dest++, src++) {
+		*dest = premultiply_pixel_scale(*src);
+	}
+}
+
+/**
+ * Horizontal scaling kernel.
+ * SSE2-optimized version.
+ *
+ * @param dest		[out] Destination row (contrib.taps.size() * 4 values)
+ * @param src		[in] Source row
+ * @param contrib	[in] Horizontal filter contributions
+ */
+void scale_h_sse2(int16_t *dest, const uint32_t *src, const Contrib &contrib)
+{
+	const int16_t *const weights = contrib.weights.data();
+	const __m128i xmm_zero = _mm_setzero_si128();
+	const __m128i xmm_round = _mm_set1_epi32(1 << (H_SHIFT - 1));
+
+	for (const Contrib::Tap &tap : contrib.taps) {
+		const uint32_t *p = &src[tap.start];
+		const int16_t *w = &weights[tap.offset];
+		__m128i xmm_acc = _mm_setzero_si128();
+
+		// Process two source pixels per iteration.
+		// pmaddwd needs the channels interleaved: [B0 B1 G0 G1 R0 R1 A0 A1]
+		int k = tap.count;
+		for (; k > 1; k -= 2, p += 2, w += 2) {
+			__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+			px = _mm_unpacklo_epi8(px, xmm_zero);
+			px = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+			const __m128i xmm_w = _mm_set1_epi32(
+				static_cast<uint16_t>(w[0]) | (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16));
+			xmm_acc = _mm_add_epi32(xmm_acc, _mm_madd_epi16(px, xmm_w));
+		}
+		if (k == 1) {
+			// Last source pixel.
+			__m128i px = _mm_cvtsi32_si128(static_cast<int>(*p));
+			px = _mm_unpacklo_epi8(px, xmm_zero);
+			px = _mm_unpacklo_epi16(px, xmm_zero);
+			xmm_acc = _mm_add_epi32(xmm_acc, _mm_madd_epi16(px, _mm_set1_epi32(static_cast<uint16_t>(w[0]))));
+		}
+
+		xmm_acc = _mm_srai_epi32(_mm_add_epi32(xmm_acc, xmm_round), H_SHIFT);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_packs_epi32(xmm_acc, xmm_acc));
+		dest += 4;
+	}
+}
+
+/**
+ * Multiply-accumulate eight values from two rows.
+ * @param xmm_lo	[in,out] Accumulator for values 0-3
+ * @param xmm_hi	[in,out] Accumulator for values 4-7
+ * @param a		[in] Values from the first row
+ * @param b		[in] Values from the second row
+ * @param xmm_w		[in] Weights: [w_a w_b] x4
+ */
+static inline void madd_rows(__m128i &xmm_lo, __m128i &xmm_hi, __m128i a, __m128i b, __m128i xmm_w)
+{
+	xmm_lo = _mm_add_epi32(xmm_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), xmm_w));
+	xmm_hi = _mm_add_epi32(xmm_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), xmm_w));
+}
+
+/**
+ * Vertical scaling kernel.
+ * SSE2-optimized version.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param rows		[in] Horizontally-scaled source rows
+ * @param weights	[in] Weights for each source row
+ * @param count		[in] Number of source rows
+ * @param width		[in] Width of each row, in pixels
+ */
+void scale_v_sse2(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width)
+{
+	const __m128i xmm_zero = _mm_setzero_si128();
+	const __m128i xmm_round = _mm_set1_epi32(1 << (V_SHIFT - 1));
+
+	// Source rows are processed in pairs for pmaddwd.
+	const int pairs = count / 2;
+
+	// Process two pixels (eight values) per iteration.
+	const int values = width * 4;
+	int i = 0;
+	for (; i + 8 <= values; i += 8, dest += 2) {
+		__m128i xmm_lo = _mm_setzero_si128();
+		__m128i xmm_hi = _mm_setzero_si128();
+
+		for (int k = 0; k < pairs; k++) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rows[k*2][i]));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rows[k*2+1][i]));
+			const __m128i xmm_w = _mm_set1_epi32(
+				static_cast<uint16_t>(weights[k*2]) | (static_cast<uint32_t>(static_cast<uint16_t>(weights[k*2+1])) << 16));
+			madd_rows(xmm_lo, xmm_hi, a, b, xmm_w);
+		}
+		if (count & 1) {
+			// Last source row.
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rows[count-1][i]));
+			madd_rows(xmm_lo, xmm_hi, a, xmm_zero, _mm_set1_epi32(static_cast<uint16_t>(weights[count-1])));
+		}
+
+		xmm_lo = _mm_srai_epi32(_mm_add_epi32(xmm_lo, xmm_round), V_SHIFT);
+		xmm_hi = _mm_srai_epi32(_mm_add_epi32(xmm_hi, xmm_round), V_SHIFT);
+		const __m128i px = _mm_packs_epi32(xmm_lo, xmm_hi);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(px, px));
+	}
+
+	if (i < values) {
+		// Last pixel. (four values)
+		__m128i xmm_lo = _mm_setzero_si128();
+		__m128i xmm_hi = _mm_setzero_si128();
+
+		for (int k = 0; k < count; k++) {
+			const __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&rows[k][i]));
+			madd_rows(xmm_lo, xmm_hi, a, xmm_zero, _mm_set1_epi32(static_cast<uint16_t>(weights[k])));
+		}
+
+		xmm_lo = _mm_srai_epi32(_mm_add_epi32(xmm_lo, xmm_round), V_SHIFT);
+		const __m128i px = _mm_packs_epi32(xmm_lo, xmm_lo);
+		*dest = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(px, px)));
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * SSE2-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. CI8 images will be converted to ARGB32.
+ *
+ * @param width New width
+ * @param height New height
+ * @param method Scaling method
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr rp_image::scaled_sse2(int width, int height, ScaleMethod method) const
+{
+	static const RpImageScale::Kernels kernels = {
+		RpImageScale::premultiply_row_sse2,
+		RpImageScale::scale_h_sse2,
+		RpImageScale::scale_v_sse2,
+	};
+	return RpImageScale::scale_image(this, width, height, method, kernels);
+}
+
+}
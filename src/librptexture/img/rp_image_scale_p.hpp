@@ -0,0 +1,137 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_p.hpp: Image class. (scaling functions) (Private)        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "rp_image.hpp"
+
+// C++ includes
+#include <vector>
+
+namespace LibRpTexture { namespace RpImageScale {
+
+// Fixed-point precision of the filter weights.
+// The weights for each destination pixel add up to (1 << WEIGHT_BITS).
+// NOTE: Must fit in a signed 16-bit integer for SSE2 pmaddwd.
+static constexpr int WEIGHT_BITS = 14;
+
+// Fractional bits kept in the horizontally-scaled intermediate rows.
+// Intermediate values are at most (255 << INTER_BITS), which must
+// fit in a signed 16-bit integer.
+static constexpr int INTER_BITS = 7;
+
+// Right shifts for each pass.
+static constexpr int H_SHIFT = WEIGHT_BITS - INTER_BITS;
+static constexpr int V_SHIFT = WEIGHT_BITS + INTER_BITS;
+
+/**
+ * Filter contributions for a single axis.
+ */
+struct Contrib {
+	struct Tap {
+		int start;	// First source pixel
+		int count;	// Number of source pixels
+		int offset;	// Offset into weights[]
+	};
+	std::vector<Tap> taps;		// One entry per destination pixel
+	std::vector<int16_t> weights;	// Fixed-point weights
+	int max_count;			// Largest Tap::count
+};
+
+/**
+ * Calculate the filter contributions for a single axis.
+ * @param contrib	[out] Filter contributions
+ * @param src_len	[in] Source length
+ * @param dest_len	[in] Destination length
+ * @param method	[in] Scaling method (Bilinear or Area)
+ */
+void calc_contrib(Contrib &contrib, int src_len, int dest_len, rp_image::ScaleMethod method);
+
+/**
+ * Premultiply a pixel for scaling.
+ * Unlike rp_image::premultiply_pixel(), fully-transparent
+ * pixels are set to 0 so their color doesn't bleed into
+ * neighboring pixels.
+ * @param px	[in] ARGB32 pixel to premultiply.
+ * @return Premultiplied pixel.
+ */
+static inline uint32_t premultiply_pixel_scale(uint32_t px)
+{
+	return likely((px >> 24) != 0) ? rp_image::premultiply_pixel(px) : 0;
+}
+
+/**
+ * Premultiplication kernel.
+ * Fully-transparent pixels are set to 0.
+ *
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param src		[in] Source row (ARGB32)
+ * @param width		[in] Width of each row, in pixels
+ */
+typedef void (*premultiply_row_fn_t)(uint32_t *dest, const uint32_t *src, int width);
+
+/**
+ * Horizontal scaling kernel.
+ * Source pixels must be premultiplied ARGB32.
+ * Each destination pixel is stored as four int16_t values,
+ * in the same byte order as the source pixels.
+ *
+ * @param dest		[out] Destination row (contrib.taps.size() * 4 values)
+ * @param src		[in] Source row
+ * @param contrib	[in] Horizontal filter contributions
+ */
+typedef void (*scale_h_fn_t)(int16_t *dest, const uint32_t *src, const Contrib &contrib);
+
+/**
+ * Vertical scaling kernel.
+ * @param dest		[out] Destination row (premultiplied ARGB32)
+ * @param rows		[in] Horizontally-scaled source rows
+ * @param weights	[in] Weights for each source row
+ * @param count		[in] Number of source rows
+ * @param width		[in] Width of each row, in pixels
+ */
+typedef void (*scale_v_fn_t)(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width);
+
+/**
+ * Scaling kernels for a specific instruction set.
+ */
+struct Kernels {
+	premultiply_row_fn_t premultiply_row;
+	scale_h_fn_t scale_h;
+	scale_v_fn_t scale_v;
+};
+
+void premultiply_row_cpp(uint32_t *dest, const uint32_t *src, int width);
+void scale_h_cpp(int16_t *dest, const uint32_t *src, const Contrib &contrib);
+void scale_v_cpp(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width);
+
+#ifdef RP_IMAGE_HAS_SSE2
+void premultiply_row_sse2(uint32_t *dest, const uint32_t *src, int width);
+void scale_h_sse2(int16_t *dest, const uint32_t *src, const Contrib &contrib);
+void scale_v_sse2(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width);
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+void premultiply_row_neon(uint32_t *dest, const uint32_t *src, int width);
+void scale_h_neon(int16_t *dest, const uint32_t *src, const Contrib &contrib);
+void scale_v_neon(uint32_t *dest, const int16_t *const *rows, const int16_t *weights, int count, int width);
+#endif /* RP_IMAGE_HAS_NEON */
+
+/**
+ * Scale an rp_image using the specified kernels.
+ * @param img		[in] Source image
+ * @param width		[in] New width
+ * @param height	[in] New height
+ * @param method	[in] Scaling method
+ * @param kernels	[in] Scaling kernels
+ * @return New rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image_ptr scale_image(const rp_image *img, int width, int height, rp_image::ScaleMethod method,
+	const Kernels &kernels);
+
+} }
@@ -0,0 +1,411 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderS3TCTest.cpp: S3TC image decoding tests.                    *
+ * Includes CPU optimization tests where available.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+#include "common.h"
+
+// librpbyteswap
+#include "librpbyteswap/byteswap_rp.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder_S3TC.hpp"
+#ifdef _WIN32
+// rp_image backend registration.
+#  include "librptexture/img/RpGdiplusBackend.hpp"
+#endif /* _WIN32 */
+using namespace LibRpTexture;
+
+// C includes (C++ namespace)
+#include <cstdint>
+#include <cstring>
+
+// C++ includes
+#include <string>
+using std::string;
+
+// libfmt
+#include "rp-libfmt.h"
+
+// Uninitialized vector class
+#include "uvector.h"
+
+namespace LibRpTexture { namespace Tests {
+
+// S3TC decoding function
+typedef rp_image_ptr (*S3TC_decode_fn)(int width, int height,
+	const uint8_t *RESTRICT img_buf, size_t img_siz);
+
+struct ImageDecoderS3TCTest_mode
+{
+	const char *name;	// Format name
+	unsigned int block_size;	// Block size, in bytes
+
+	S3TC_decode_fn fn_cpp;		// Standard version
+	S3TC_decode_fn fn_ssse3;	// SSSE3-optimized version (or nullptr)
+	S3TC_decode_fn fn_avx2;		// AVX2-optimized version (or nullptr)
+	S3TC_decode_fn fn_neon;		// NEON-optimized version (or nullptr)
+	S3TC_decode_fn fn_dispatch;	// Dispatch function
+
+	int width;	// Image width
+	int height;	// Image height
+};
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+#  define FN_SSSE3(fn) ImageDecoder::fn##_ssse3
+#else /* !IMAGEDECODER_HAS_SSSE3 */
+#  define FN_SSSE3(fn) nullptr
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_AVX2
+#  define FN_AVX2(fn) ImageDecoder::fn##_avx2
+#else /* !IMAGEDECODER_HAS_AVX2 */
+#  define FN_AVX2(fn) nullptr
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+#  define FN_NEON(fn) ImageDecoder::fn##_neon
+#else /* !(IMAGEDECODER_HAS_NEON && RP_CPU_ARM64) */
+#  define FN_NEON(fn) nullptr
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+#define S3TC_MODE(fn, block_size, width, height) \
+	ImageDecoderS3TCTest_mode{#fn, block_size, \
+		ImageDecoder::fn##_cpp, FN_SSSE3(fn), FN_AVX2(fn), FN_NEON(fn), \
+		ImageDecoder::fn, width, height}
+
+class ImageDecoderS3TCTest : public ::testing::TestWithParam<ImageDecoderS3TCTest_mode>
+{
+protected:
+	ImageDecoderS3TCTest()
+		: ::testing::TestWithParam<ImageDecoderS3TCTest_mode>()
+	{
+#ifdef _WIN32
+		// Register RpGdiplusBackend.
+		// TODO: Static initializer somewhere?
+		rp_image::setBackendCreatorFn(RpGdiplusBackend::creator_fn);
+#endif /* _WIN32 */
+	}
+
+	void SetUp(void) final;
+
+public:
+	/**
+	 * Compare an rp_image to the image decoded by the standard version.
+	 * @param img	[in] rp_image
+	 */
+	void Compare_RpImage(const rp_image *img);
+
+	/**
+	 * Run a decoding test.
+	 * @param fn Decoding function
+	 */
+	void decodeTest(S3TC_decode_fn fn);
+
+	/**
+	 * Run a decoding benchmark.
+	 * @param fn Decoding function
+	 */
+	void decodeBenchmark(S3TC_decode_fn fn);
+
+	// Number of iterations for benchmarks.
+	static constexpr unsigned int BENCHMARK_ITERATIONS = 10000U;
+
+public:
+	// Image data
+	rp::uvector<uint8_t> m_img_buf;
+
+	// Image decoded using the standard version
+	rp_image_ptr m_img_cpp;
+
+public:
+	/**
+	 * Test case suffix generator.
+	 * @param info Test parameter information.
+	 * @return Test case suffix.
+	 */
+	static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderS3TCTest_mode> &info);
+};
+
+/**
+ * Formatting function for ImageDecoderS3TCTest.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const ImageDecoderS3TCTest_mode& mode)
+{
+	return os << fmt::format(FSTR("{:s}_{:d}x{:d}"), mode.name, mode.width, mode.height);
+};
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderS3TCTest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderS3TCTest_mode> &info)
+{
+	return fmt::format(FSTR("{:s}_{:d}x{:d}"), info.param.name, info.param.width, info.param.height);
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderS3TCTest::SetUp(void)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	// Generate pseudo-random image data.
+	// A fixed LCG is used so the results are reproducible.
+	const unsigned int tilesX = (mode.width + 3) / 4;
+	const unsigned int tilesY = (mode.height + 3) / 4;
+	const unsigned int tiles = tilesX * tilesY;
+	m_img_buf.resize(tiles * mode.block_size);
+
+	uint32_t seed = 0x12345678U;
+	for (uint8_t &p : m_img_buf) {
+		seed = (seed * 1103515245U) + 12345U;
+		p = static_cast<uint8_t>(seed >> 16);
+	}
+
+	// Make sure some of the "equal" palette cases are tested.
+	// - 8-byte blocks: DXT1 color0 == color1, or BC4 alpha0 == alpha1
+	// - 16-byte blocks: DXT5 alpha0 == alpha1 and color0 == color1,
+	//   or BC5 red0 == red1 and green0 == green1
+	for (unsigned int i = 0; i < tiles; i += 7) {
+		uint8_t *const block = &m_img_buf[i * mode.block_size];
+		if (mode.block_size == 8) {
+			block[1] = block[0];
+			block[2] = block[0];
+			block[3] = block[0];
+		} else {
+			block[1] = block[0];
+			block[9] = block[8];
+			block[10] = block[8];
+			block[11] = block[8];
+		}
+	}
+
+	// Decode the image using the standard version.
+	m_img_cpp = mode.fn_cpp(mode.width, mode.height, m_img_buf.data(), m_img_buf.size());
+	ASSERT_TRUE((bool)m_img_cpp);
+	ASSERT_EQ(mode.width, m_img_cpp->width());
+	ASSERT_EQ(mode.height, m_img_cpp->height());
+}
+
+/**
+ * Compare an rp_image to the image decoded by the standard version.
+ * @param img	[in] rp_image
+ */
+void ImageDecoderS3TCTest::Compare_RpImage(const rp_image *img)
+{
+	const rp_image *const img_cpp = m_img_cpp.get();
+	ASSERT_EQ(img_cpp->width(), img->width());
+	ASSERT_EQ(img_cpp->height(), img->height());
+	ASSERT_EQ(img_cpp->format(), img->format());
+
+	// Compare the sBIT metadata.
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	ASSERT_EQ(0, img_cpp->get_sBIT(&sBIT_expected));
+	ASSERT_EQ(0, img->get_sBIT(&sBIT_actual));
+	EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+
+	const int width = img->width();
+	const int height = img->height();
+	for (int y = 0; y < height; y++) {
+		const uint32_t *px_expected = static_cast<const uint32_t*>(img_cpp->scanLine(y));
+		const uint32_t *px_actual = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < width; x++, px_expected++, px_actual++) {
+			if (*px_expected != *px_actual) {
+				fmt::print("ERR: ({:d},{:d}): expected {:0>8X}, got {:0>8X}\n",
+					x, y, *px_expected, *px_actual);
+			}
+			ASSERT_EQ(*px_expected, *px_actual);
+		}
+	}
+}
+
+/**
+ * Run a decoding test.
+ * @param fn Decoding function
+ */
+void ImageDecoderS3TCTest::decodeTest(S3TC_decode_fn fn)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+	rp_image_ptr img = fn(mode.width, mode.height, m_img_buf.data(), m_img_buf.size());
+	ASSERT_TRUE((bool)img);
+	ASSERT_NO_FATAL_FAILURE(Compare_RpImage(img.get()));
+}
+
+/**
+ * Run a decoding benchmark.
+ * @param fn Decoding function
+ */
+void ImageDecoderS3TCTest::decodeBenchmark(S3TC_decode_fn fn)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image_ptr img = fn(mode.width, mode.height, m_img_buf.data(), m_img_buf.size());
+		ASSERT_TRUE((bool)img);
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::fromS3TC*() functions. (Standard version)
+ */
+TEST_P(ImageDecoderS3TCTest, cpp_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(decodeBenchmark(GetParam().fn_cpp));
+}
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Test the S3TC decoding functions. (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, ssse3_test)
+{
+	if (!RP_CPU_x86_HasSSSE3()) {
+		GTEST_SKIP() << "*** SSSE3 is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeTest(GetParam().fn_ssse3));
+}
+
+/**
+ * Benchmark the S3TC decoding functions. (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, ssse3_benchmark)
+{
+	if (!RP_CPU_x86_HasSSSE3()) {
+		GTEST_SKIP() << "*** SSSE3 is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeBenchmark(GetParam().fn_ssse3));
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the S3TC decoding functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, avx2_test)
+{
+	if (!RP_CPU_x86_HasAVX2()) {
+		GTEST_SKIP() << "*** AVX2 is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeTest(GetParam().fn_avx2));
+}
+
+/**
+ * Benchmark the S3TC decoding functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, avx2_benchmark)
+{
+	if (!RP_CPU_x86_HasAVX2()) {
+		GTEST_SKIP() << "*** AVX2 is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeBenchmark(GetParam().fn_avx2));
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(IMAGEDECODER_HAS_NEON) && defined(RP_CPU_ARM64)
+/**
+ * Test the S3TC decoding functions. (NEON-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, neon_test)
+{
+	if (!RP_CPU_arm_HasNEON()) {
+		GTEST_SKIP() << "*** NEON is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeTest(GetParam().fn_neon));
+}
+
+/**
+ * Benchmark the S3TC decoding functions. (NEON-optimized version)
+ */
+TEST_P(ImageDecoderS3TCTest, neon_benchmark)
+{
+	if (!RP_CPU_arm_HasNEON()) {
+		GTEST_SKIP() << "*** NEON is not supported on this CPU.";
+	}
+	ASSERT_NO_FATAL_FAILURE(decodeBenchmark(GetParam().fn_neon));
+}
+#endif /* IMAGEDECODER_HAS_NEON && RP_CPU_ARM64 */
+
+/**
+ * Test the S3TC decoding dispatch functions.
+ */
+TEST_P(ImageDecoderS3TCTest, dispatch_test)
+{
+	ASSERT_NO_FATAL_FAILURE(decodeTest(GetParam().fn_dispatch));
+}
+
+/**
+ * Benchmark the S3TC decoding dispatch functions.
+ */
+TEST_P(ImageDecoderS3TCTest, dispatch_benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(decodeBenchmark(GetParam().fn_dispatch));
+}
+
+// Test cases.
+// - 128x128: Even number of tiles per row.
+// - 36x20: Odd number of tiles per row.
+// - 62x34: Partial tiles. (physical size is 64x36)
+INSTANTIATE_TEST_SUITE_P(fromDXT1, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_MODE(fromDXT1, 8, 128, 128),
+		S3TC_MODE(fromDXT1, 8, 36, 20),
+		S3TC_MODE(fromDXT1, 8, 62, 34))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(fromDXT1_A1, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_MODE(fromDXT1_A1, 8, 128, 128),
+		S3TC_MODE(fromDXT1_A1, 8, 36, 20),
+		S3TC_MODE(fromDXT1_A1, 8, 62, 34))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(fromDXT5, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_MODE(fromDXT5, 16, 128, 128),
+		S3TC_MODE(fromDXT5, 16, 36, 20),
+		S3TC_MODE(fromDXT5, 16, 62, 34))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(fromBC4, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_MODE(fromBC4, 8, 128, 128),
+		S3TC_MODE(fromBC4, 8, 36, 20),
+		S3TC_MODE(fromBC4, 8, 62, 34))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(fromBC5, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_MODE(fromBC5, 16, 128, 128),
+		S3TC_MODE(fromBC5, 16, 36, 20),
+		S3TC_MODE(fromBC5, 16, 62, 34))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = 0;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpTexture test suite: ImageDecoder S3TC tests.\n\n", stderr);
+	fmt::print(stderr, FSTR("Benchmark iterations: {:d}\n"),
+		LibRpTexture::Tests::ImageDecoderS3TCTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,357 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * RpImageScaleTest.cpp: Test rp_image::scaled().                          *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#ifdef _WIN32
+// rp_image backend registration.
+#  include "librptexture/img/RpGdiplusBackend.hpp"
+#endif /* _WIN32 */
+using namespace LibRpTexture;
+
+// C includes (C++ namespace)
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes
+#include <array>
+#include <memory>
+using std::array;
+
+// libfmt
+#include "rp-libfmt.h"
+
+namespace LibRpTexture { namespace Tests {
+
+class RpImageScaleTest : public ::testing::Test
+{
+protected:
+	RpImageScaleTest()
+	{
+#ifdef _WIN32
+		// Register RpGdiplusBackend.
+		// TODO: Static initializer somewhere?
+		rp_image::setBackendCreatorFn(RpGdiplusBackend::creator_fn);
+#endif /* _WIN32 */
+	}
+
+public:
+	// Number of iterations for benchmarks
+	static constexpr unsigned int BENCHMARK_ITERATIONS = 100U;
+
+	/**
+	 * Create an ARGB32 image filled with pseudo-random data.
+	 * @param width Width
+	 * @param height Height
+	 * @param seed Random seed
+	 * @return ARGB32 image
+	 */
+	static rp_image_ptr createRandomImage(int width, int height, uint32_t seed);
+
+	/**
+	 * Compare two ARGB32 images.
+	 * @param expected Expected image
+	 * @param actual Actual image
+	 */
+	static void compareImages(const rp_image_const_ptr &expected, const rp_image_const_ptr &actual);
+
+	static const array<rp_image::ScaleMethod, 3> scaleMethods;
+};
+
+const array<rp_image::ScaleMethod, 3> RpImageScaleTest::scaleMethods = {{
+	rp_image::ScaleMethod::Nearest,
+	rp_image::ScaleMethod::Bilinear,
+	rp_image::ScaleMethod::Area,
+}};
+
+/**
+ * Create an ARGB32 image filled with pseudo-random data.
+ * @param width Width
+ * @param height Height
+ * @param seed Random seed
+ * @return ARGB32 image
+ */
+rp_image_ptr RpImageScaleTest::createRandomImage(int width, int height, uint32_t seed)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(width, height, rp_image::Format::ARGB32);
+	for (int y = 0; y < height; y++) {
+		uint32_t *px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < width; x++) {
+			// xorshift32
+			seed ^= (seed << 13);
+			seed ^= (seed >> 17);
+			seed ^= (seed << 5);
+			px[x] = seed;
+		}
+	}
+	return img;
+}
+
+/**
+ * Compare two ARGB32 images.
+ * @param expected Expected image
+ * @param actual Actual image
+ */
+void RpImageScaleTest::compareImages(const rp_image_const_ptr &expected, const rp_image_const_ptr &actual)
+{
+	ASSERT_TRUE((bool)expected);
+	ASSERT_TRUE((bool)actual);
+	ASSERT_EQ(expected->width(), actual->width());
+	ASSERT_EQ(expected->height(), actual->height());
+	ASSERT_EQ(rp_image::Format::ARGB32, expected->format());
+	ASSERT_EQ(rp_image::Format::ARGB32, actual->format());
+
+	for (int y = 0; y < expected->height(); y++) {
+		const uint32_t *const px_expected = static_cast<const uint32_t*>(expected->scanLine(y));
+		const uint32_t *const px_actual = static_cast<const uint32_t*>(actual->scanLine(y));
+		for (int x = 0; x < expected->width(); x++) {
+			ASSERT_EQ(px_expected[x], px_actual[x]) << "Pixel (" << x << ", " << y << ") differs.";
+		}
+	}
+}
+
+/**
+ * Nearest-neighbor upscaling should duplicate pixels.
+ */
+TEST_F(RpImageScaleTest, nearestUpscale)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(2, 2, rp_image::Format::ARGB32);
+	static const uint32_t src_px[2][2] = {
+		{0xFF112233, 0x80445566},
+		{0x00778899, 0xFFAABBCC},
+	};
+	for (int y = 0; y < 2; y++) {
+		memcpy(img->scanLine(y), src_px[y], sizeof(src_px[y]));
+	}
+
+	const rp_image_ptr scaled = img->scaled(4, 4, rp_image::ScaleMethod::Nearest);
+	ASSERT_TRUE((bool)scaled);
+	ASSERT_EQ(4, scaled->width());
+	ASSERT_EQ(4, scaled->height());
+	for (int y = 0; y < 4; y++) {
+		const uint32_t *const px = static_cast<const uint32_t*>(scaled->scanLine(y));
+		for (int x = 0; x < 4; x++) {
+			EXPECT_EQ(src_px[y / 2][x / 2], px[x]);
+		}
+	}
+}
+
+/**
+ * Area averaging with an integer ratio should be a box filter.
+ */
+TEST_F(RpImageScaleTest, areaDownscaleBox)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(4, 2, rp_image::Format::ARGB32);
+	static const uint32_t src_px[2][4] = {
+		{0xFF000000, 0xFF102030, 0xFFFFFFFF, 0xFF808080},
+		{0xFF040404, 0xFF0C0C0C, 0xFF000000, 0xFF010203},
+	};
+	for (int y = 0; y < 2; y++) {
+		memcpy(img->scanLine(y), src_px[y], sizeof(src_px[y]));
+	}
+
+	const rp_image_ptr scaled = img->scaled(2, 1, rp_image::ScaleMethod::Area);
+	ASSERT_TRUE((bool)scaled);
+	ASSERT_EQ(2, scaled->width());
+	ASSERT_EQ(1, scaled->height());
+
+	// Average of each 2x2 block, rounded.
+	const uint32_t *const px = static_cast<const uint32_t*>(scaled->scanLine(0));
+	EXPECT_EQ(0xFF080C10u, px[0]);
+	EXPECT_EQ(0xFF606061u, px[1]);
+}
+
+/**
+ * Filtering is done on premultiplied pixels, so the color
+ * of transparent pixels must not bleed into the result.
+ */
+TEST_F(RpImageScaleTest, premultipliedAlpha)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(2, 1, rp_image::Format::ARGB32);
+	uint32_t *const src = static_cast<uint32_t*>(img->bits());
+	src[0] = 0xFFFF0000;	// opaque red
+	src[1] = 0x0000FF00;	// transparent green
+
+	for (rp_image::ScaleMethod method : {rp_image::ScaleMethod::Bilinear, rp_image::ScaleMethod::Area}) {
+		const rp_image_ptr scaled = img->scaled(1, 1, method);
+		ASSERT_TRUE((bool)scaled);
+		const uint32_t px = *static_cast<const uint32_t*>(scaled->bits());
+		EXPECT_EQ(0x80FF0000u, px);
+	}
+}
+
+/**
+ * A solid-color image must remain solid with all scaling methods.
+ */
+TEST_F(RpImageScaleTest, solidColor)
+{
+	static const uint32_t color = 0xFF336699;
+	rp_image_ptr img = std::make_shared<rp_image>(37, 23, rp_image::Format::ARGB32);
+	for (int y = 0; y < img->height(); y++) {
+		uint32_t *const px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++) {
+			px[x] = color;
+		}
+	}
+
+	static const array<array<int, 2>, 4> sizes = {{
+		{{10, 7}}, {{36, 1}}, {{80, 45}}, {{1, 100}},
+	}};
+	for (rp_image::ScaleMethod method : scaleMethods) {
+		for (const auto &sz : sizes) {
+			const rp_image_ptr scaled = img->scaled(sz[0], sz[1], method);
+			ASSERT_TRUE((bool)scaled);
+			ASSERT_EQ(sz[0], scaled->width());
+			ASSERT_EQ(sz[1], scaled->height());
+			for (int y = 0; y < scaled->height(); y++) {
+				const uint32_t *const px = static_cast<const uint32_t*>(scaled->scanLine(y));
+				for (int x = 0; x < scaled->width(); x++) {
+					ASSERT_EQ(color, px[x]) << "method " << static_cast<int>(method)
+						<< ", size " << sz[0] << 'x' << sz[1]
+						<< ", pixel (" << x << ", " << y << ')';
+				}
+			}
+		}
+	}
+}
+
+/**
+ * CI8 images should be scaled the same way as their ARGB32 equivalent.
+ */
+TEST_F(RpImageScaleTest, CI8)
+{
+	rp_image_ptr img = std::make_shared<rp_image>(33, 17, rp_image::Format::CI8);
+	uint32_t *const palette = img->palette();
+	const rp_image_ptr pal_img = createRandomImage(256, 1, 0x12345678);
+	memcpy(palette, pal_img->bits(), 256 * sizeof(uint32_t));
+	for (int y = 0; y < img->height(); y++) {
+		uint8_t *const px = static_cast<uint8_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++) {
+			px[x] = static_cast<uint8_t>((x * 7) + (y * 13));
+		}
+	}
+
+	const rp_image_ptr img_argb = img->dup_ARGB32();
+	ASSERT_TRUE((bool)img_argb);
+	for (rp_image::ScaleMethod method : scaleMethods) {
+		compareImages(img_argb->scaled(11, 40, method), img->scaled(11, 40, method));
+	}
+}
+
+/**
+ * The CPU-optimized versions must match the standard version exactly.
+ */
+TEST_F(RpImageScaleTest, optimizedMatchesCpp)
+{
+	static const array<array<int, 2>, 6> sizes = {{
+		{{1, 1}}, {{7, 5}}, {{32, 32}}, {{50, 13}}, {{160, 200}}, {{97, 61}},
+	}};
+	const rp_image_ptr img = createRandomImage(97, 61, 0xDEADBEEF);
+
+	for (rp_image::ScaleMethod method : scaleMethods) {
+		for (const auto &sz : sizes) {
+			const rp_image_ptr expected = img->scaled_cpp(sz[0], sz[1], method);
+			ASSERT_TRUE((bool)expected);
+			compareImages(expected, img->scaled(sz[0], sz[1], method));
+#ifdef RP_IMAGE_HAS_SSE2
+			if (RP_CPU_x86_HasSSE2()) {
+				compareImages(expected, img->scaled_sse2(sz[0], sz[1], method));
+			}
+#endif /* RP_IMAGE_HAS_SSE2 */
+#ifdef RP_IMAGE_HAS_NEON
+			if (RP_CPU_arm_HasNEON()) {
+				compareImages(expected, img->scaled_neon(sz[0], sz[1], method));
+			}
+#endif /* RP_IMAGE_HAS_NEON */
+		}
+	}
+}
+
+/**
+ * Invalid dimensions should return nullptr.
+ */
+TEST_F(RpImageScaleTest, invalidSize)
+{
+	const rp_image_ptr img = createRandomImage(8, 8, 1);
+	EXPECT_FALSE((bool)img->scaled(0, 8));
+	EXPECT_FALSE((bool)img->scaled(8, -1));
+}
+
+/**
+ * Benchmark rp_image::scaled_cpp(). (Area averaging, 1024x1024 -> 256x256)
+ */
+TEST_F(RpImageScaleTest, scaled_cpp_benchmark)
+{
+	const rp_image_ptr img = createRandomImage(1024, 1024, 0xDEADBEEF);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		img->scaled_cpp(256, 256, rp_image::ScaleMethod::Area);
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Benchmark rp_image::scaled_sse2(). (Area averaging, 1024x1024 -> 256x256)
+ */
+TEST_F(RpImageScaleTest, scaled_sse2_benchmark)
+{
+	if (!RP_CPU_x86_HasSSE2()) {
+		fputs("*** SSE2 is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	const rp_image_ptr img = createRandomImage(1024, 1024, 0xDEADBEEF);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		img->scaled_sse2(256, 256, rp_image::ScaleMethod::Area);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Benchmark rp_image::scaled_neon(). (Area averaging, 1024x1024 -> 256x256)
+ */
+TEST_F(RpImageScaleTest, scaled_neon_benchmark)
+{
+	if (!RP_CPU_arm_HasNEON()) {
+		fputs("*** NEON is not supported on this CPU. Skipping test.\n", stderr);
+		return;
+	}
+
+	const rp_image_ptr img = createRandomImage(1024, 1024, 0xDEADBEEF);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		img->scaled_neon(256, 256, rp_image::ScaleMethod::Area);
+	}
+}
+#endif /* RP_IMAGE_HAS_NEON */
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = 0;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("LibRpTexture test suite: rp_image::scaled() tests.\n\n", stderr);
+	fmt::print(stderr, FSTR("Benchmark iterations: {:d}\n"),
+		LibRpTexture::Tests::RpImageScaleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
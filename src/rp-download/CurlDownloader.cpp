@@ -57,6 +57,7 @@ DEF_STATIC_FUNCPTR(curl_easy_init);
 DEF_STATIC_FUNCPTR(curl_easy_setopt);
 DEF_STATIC_FUNCPTR(curl_easy_perform);
 DEF_STATIC_FUNCPTR(curl_easy_cleanup);
+DEF_STATIC_FUNCPTR(curl_easy_reset);
 DEF_STATIC_FUNCPTR(curl_easy_getinfo);
 
 /**
@@ -99,6 +100,7 @@ static void init_curl_once(void)
 	LOAD_FUNCPTR(curl_easy_setopt);
 	LOAD_FUNCPTR(curl_easy_perform);
 	LOAD_FUNCPTR(curl_easy_cleanup);
+	LOAD_FUNCPTR(curl_easy_reset);	// optional (added in cURL 7.12.1)
 	LOAD_FUNCPTR(curl_easy_getinfo);
 
 	if (!pcurl_global_init ||
@@ -125,6 +127,7 @@ static void init_curl_once(void)
 }
 
 CurlDownloader::CurlDownloader()
+	: m_curl(nullptr)
 {
 	std::call_once(curl_once_flag, init_curl_once);
 	// FIXME: Set a flag if initialization fails.
@@ -132,6 +135,7 @@ CurlDownloader::CurlDownloader()
 
 CurlDownloader::CurlDownloader(const TCHAR *url)
 	: super(url)
+	, m_curl(nullptr)
 {
 	std::call_once(curl_once_flag, init_curl_once);
 	// FIXME: Set a flag if initialization fails.
@@ -139,11 +143,19 @@ CurlDownloader::CurlDownloader(const TCHAR *url)
 
 CurlDownloader::CurlDownloader(const tstring &url)
 	: super(url)
+	, m_curl(nullptr)
 {
 	std::call_once(curl_once_flag, init_curl_once);
 	// FIXME: Set a flag if initialization fails.
 }
 
+CurlDownloader::~CurlDownloader()
+{
+	if (m_curl) {
+		pcurl_easy_cleanup(m_curl);
+	}
+}
+
 /**
  * Internal cURL data write function.
  * @param ptr Data to write.
@@ -304,11 +316,24 @@ int CurlDownloader::download(void)
 	}
 
 	// Initialize cURL.
-	CURL *curl = pcurl_easy_init();
-	if (!curl) {
-		// Could not initialize cURL.
-		return -ENOMEM;	// TODO: Better error?
+	// The "easy" handle is kept across downloads so its connection
+	// cache (HTTP keep-alive, TLS sessions, DNS) can be reused when
+	// multiple files are downloaded by the same CurlDownloader.
+	if (m_curl && pcurl_easy_reset) {
+		// Reset the options, but keep the connection cache.
+		pcurl_easy_reset(m_curl);
+	} else {
+		if (m_curl) {
+			// curl_easy_reset() isn't available.
+			pcurl_easy_cleanup(m_curl);
+		}
+		m_curl = pcurl_easy_init();
+		if (!m_curl) {
+			// Could not initialize cURL.
+			return -ENOMEM;	// TODO: Better error?
+		}
 	}
+	CURL *const curl = m_curl;
 
 	// Proxy settings should be set by the calling application
 	// in the http_proxy and https_proxy variables.
@@ -327,11 +352,18 @@ int CurlDownloader::download(void)
 	// NOTE: Probably not needed for http...
 	pcurl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
 
+	// Check the cURL version.
+	const curl_version_info_data *const verinfo = pcurl_version_info(CURLVERSION_FIRST);
+
+	// Keep connections alive between downloads, and use HTTP/2
+	// for HTTPS if available. (default since cURL 7.62.0)
+	pcurl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+	if (verinfo && verinfo->version_num >= CURL_VERSION_BITS(7, 47, 0)) {
+		pcurl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	}
+
 	if (m_if_modified_since >= 0) {
 		// Add an "If-Modified-Since" header.
-
-		// Check the cURL version.
-		const curl_version_info_data *const verinfo = pcurl_version_info(CURLVERSION_FIRST);
 		if (verinfo && verinfo->version_num >= CURL_VERSION_BITS(7, 59, 0)) {
 			static_assert(sizeof(curl_off_t) == 8, "sizeof(curl_off_t) != 8");
 			pcurl_easy_setopt(curl, CURLOPT_TIMEVALUE_LARGE, static_cast<curl_off_t>(m_if_modified_since));
@@ -444,14 +476,17 @@ int CurlDownloader::download(void)
 			if (response_code <= 0) {
 				// No HTTP response code.
 				// TODO: Return a cURL error code and/or message...
-				return -EIO;
+				ret = -EIO;
+				break;
 			}
 			ret = static_cast<int>(response_code);
 			break;
 	}
 
+	// NOTE: The request headers must remain valid until
+	// the handle is reset, so clear them from the handle.
+	pcurl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
 	pcurl_slist_free_all(req_headers);
-	pcurl_easy_cleanup(curl);
 	if (ret != 0) {
 		return ret;
 	}
@@ -18,6 +18,7 @@ public:
 	CurlDownloader();
 	explicit CurlDownloader(const TCHAR *url);
 	explicit CurlDownloader(const std::tstring &url);
+	~CurlDownloader() final;
 
 private:
 	typedef IDownloader super;
@@ -63,6 +64,11 @@ public:
 	 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
 	 */
 	int download(void) final;
+
+private:
+	// cURL "easy" handle
+	// Kept between downloads in order to reuse connections.
+	void *m_curl;	// CURL*
 };
 
 } // namespace RpDownload
@@ -0,0 +1,175 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * RequestServer.cpp: Persistent mode request loop. (POSIX only)           *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "RequestServer.hpp"
+
+// C includes
+#include <poll.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+// C++ includes
+#include <string>
+using std::string;
+
+namespace RpDownload { namespace RequestServer {
+
+/**
+ * Write a buffer to a file descriptor, handling partial writes.
+ * @param fd	[in] File descriptor
+ * @param buf	[in] Buffer
+ * @param size	[in] Size of buf
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int write_all(int fd, const char *buf, size_t size)
+{
+	while (size > 0) {
+		const ssize_t n = write(fd, buf, size);
+		if (n < 0) {
+			const int err = errno;
+			if (err == EINTR) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+		buf += n;
+		size -= static_cast<size_t>(n);
+	}
+	return 0;
+}
+
+/**
+ * Send a response.
+ * @param fd_out	[in] Output file descriptor
+ * @param status	[in] Status code
+ * @param cache_key	[in] Cache key
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int send_response(int fd_out, int status, const string &cache_key)
+{
+	string response = std::to_string(status);
+	response.reserve(response.size() + 1 + cache_key.size() + 1);
+	response += ' ';
+	response += cache_key;
+	response += '\n';
+	return write_all(fd_out, response.data(), response.size());
+}
+
+/**
+ * Process requests until the input is closed.
+ * @param fd_in		[in] Input file descriptor
+ * @param fd_out	[in] Output file descriptor
+ * @param handler	[in] Request handler
+ * @param userdata	[in] User data for the request handler
+ * @param idle_timeout	[in] Idle timeout, in milliseconds (-1 for none)
+ * @return 0 if the input was closed or the idle timeout expired; negative POSIX error code on error.
+ */
+int run(int fd_in, int fd_out, request_handler_t handler, void *userdata, int idle_timeout)
+{
+	assert(handler != nullptr);
+	if (!handler) {
+		return -EINVAL;
+	}
+
+	string buf;
+	buf.reserve(MAX_REQUEST_LEN);
+	bool discard = false;	// Discarding the rest of an overlong request.
+
+	for (;;) {
+		// Process all complete requests in the buffer.
+		// NOTE: Multiple requests may have been received at once.
+		size_t start = 0;
+		for (;;) {
+			const size_t nl = buf.find('\n', start);
+			if (nl == string::npos) {
+				break;
+			}
+
+			const size_t len = nl - start;
+			string cache_key(buf, start, len);
+			start = nl + 1;
+			if (discard) {
+				// End of an overlong request.
+				discard = false;
+				continue;
+			} else if (len >= MAX_REQUEST_LEN) {
+				// Request is too long.
+				const int ret = send_response(fd_out, 1, string());
+				if (ret != 0) {
+					return ret;
+				}
+				continue;
+			}
+
+			if (!cache_key.empty() && cache_key.back() == '\r') {
+				cache_key.resize(cache_key.size() - 1);
+			}
+			if (cache_key.empty()) {
+				// Ignore empty lines.
+				continue;
+			}
+
+			const int status = handler(cache_key.c_str(), userdata);
+			const int ret = send_response(fd_out, status, cache_key);
+			if (ret != 0) {
+				return ret;
+			}
+		}
+		buf.erase(0, start);
+
+		if (discard) {
+			buf.clear();
+		} else if (buf.size() >= MAX_REQUEST_LEN) {
+			// Request is too long. Reject it now so the client
+			// doesn't wait for a response that will never arrive.
+			buf.clear();
+			discard = true;
+			const int ret = send_response(fd_out, 1, string());
+			if (ret != 0) {
+				return ret;
+			}
+		}
+
+		// Wait for more data.
+		struct pollfd pfd;
+		pfd.fd = fd_in;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, idle_timeout);
+		if (ret == 0) {
+			// Idle timeout expired.
+			return 0;
+		} else if (ret < 0) {
+			const int err = errno;
+			if (err == EINTR) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+
+		char rdbuf[4096];
+		const ssize_t n = read(fd_in, rdbuf, sizeof(rdbuf));
+		if (n == 0) {
+			// Input was closed.
+			// NOTE: An incomplete request at the end is ignored.
+			return 0;
+		} else if (n < 0) {
+			const int err = errno;
+			if (err == EINTR || err == EAGAIN) {
+				continue;
+			}
+			return (err != 0 ? -err : -EIO);
+		}
+		buf.append(rdbuf, static_cast<size_t>(n));
+	}
+}
+
+} }
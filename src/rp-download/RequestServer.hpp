@@ -0,0 +1,54 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * RequestServer.hpp: Persistent mode request loop. (POSIX only)           *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#  error RequestServer is not supported on Windows.
+#endif /* _WIN32 */
+
+namespace RpDownload { namespace RequestServer {
+
+/**
+ * Persistent mode protocol:
+ * - Each request is a single line containing a cache key,
+ *   terminated by '\n'. Empty lines are ignored.
+ * - Each response is a single line: "%d %s\n", where %d is
+ *   the request handler's return value (0 == success), and
+ *   %s is the cache key from the request.
+ * - Multiple requests may be sent without waiting for the
+ *   responses. Responses are sent in the same order as the
+ *   requests were received.
+ * - The loop exits when the input is closed or if no requests
+ *   are received within the idle timeout.
+ */
+
+// Maximum length of a request line, including the '\n'.
+// Longer requests are rejected.
+static constexpr unsigned int MAX_REQUEST_LEN = 1024;
+
+/**
+ * Request handler.
+ * @param cache_key	[in] Cache key
+ * @param userdata	[in] User data
+ * @return 0 on success; non-zero on error.
+ */
+typedef int (*request_handler_t)(const char *cache_key, void *userdata);
+
+/**
+ * Process requests until the input is closed.
+ * @param fd_in		[in] Input file descriptor
+ * @param fd_out	[in] Output file descriptor
+ * @param handler	[in] Request handler
+ * @param userdata	[in] User data for the request handler
+ * @param idle_timeout	[in] Idle timeout, in milliseconds (-1 for none)
+ * @return 0 if the input was closed or the idle timeout expired; negative POSIX error code on error.
+ */
+int run(int fd_in, int fd_out, request_handler_t handler, void *userdata, int idle_timeout);
+
+} }
@@ -1356,6 +1356,13 @@ typedef enum {
 #define CURL_TIMECOND_IFUNMODSINCE 2L
 #define CURL_TIMECOND_LASTMOD      3L
 
+/* These enums are for use with the CURLOPT_HTTP_VERSION option. */
+#define CURL_HTTP_VERSION_NONE              0L
+#define CURL_HTTP_VERSION_1_0               1L
+#define CURL_HTTP_VERSION_1_1               2L
+#define CURL_HTTP_VERSION_2_0               3L
+#define CURL_HTTP_VERSION_2TLS              4L
+
 typedef enum {
   /* we set a single member here, just to make sure we still provide
      the enum typedef, but the values to use are defined above with L
@@ -1673,6 +1680,7 @@ CURL_EXTERN CURL *curl_easy_init(void);
 CURL_EXTERN CURLcode curl_easy_setopt(CURL *curl, CURLoption option, ...);
 CURL_EXTERN CURLcode curl_easy_perform(CURL *curl);
 CURL_EXTERN void curl_easy_cleanup(CURL *curl);
+CURL_EXTERN void curl_easy_reset(CURL *curl);
 
 /*
  * NAME curl_easy_getinfo()
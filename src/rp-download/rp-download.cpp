@@ -67,6 +67,11 @@ using namespace RpDownload;
 // CacheKeyVerify
 #include "CacheKeyVerify.hpp"
 
+#ifndef _WIN32
+// Persistent mode
+#  include "RequestServer.hpp"
+#endif /* !_WIN32 */
+
 static const TCHAR *argv0 = nullptr;
 static bool verbose = false;
 
@@ -83,6 +88,10 @@ static bool verbose = false;
 static void show_usage(void)
 {
 	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] cache_key\n"), argv0);
+#ifndef _WIN32
+	_ftprintf(stderr, _T("       %s [-v] [-f] -s\n"), argv0);
+	_ftprintf(stderr, _T("  -s: Persistent mode. Read cache keys from stdin, one per line.\n"));
+#endif /* !_WIN32 */
 }
 
 /**
@@ -236,80 +245,14 @@ static const TCHAR *getMimeType(const TCHAR *cache_key)
 }
 
 /**
- * rp-download: Download an image from a supported online database.
- * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
- * @return 0 on success; non-zero on error.
- *
- * TODO:
- * - More error codes based on the error.
+ * Download a file from a supported online database.
+ * @param downloader	[in] IDownloader
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
  */
-int RP_C_API _tmain(int argc, TCHAR *argv[])
+static int download_cache_key(IDownloader *downloader, const TCHAR *cache_key, bool force)
 {
-	// Create a downloader based on OS:
-	// - Linux: CurlDownloader
-	// - Windows: WinInetDownloader
-
-	// Syntax: rp-download cache_key
-	// Example: rp-download ds/coverM/US/ADAE.png
-
-	// If http_proxy or https_proxy are set, they will be used
-	// by the downloader code if supported.
-
-	// Enable security options.
-	rp_download_do_security_options();
-
-#ifdef __GLIBC__
-	// Reduce /etc/localtime stat() calls.
-	// References:
-	// - https://lwn.net/Articles/944499/
-	// - https://gitlab.com/procps-ng/procps/-/merge_requests/119
-	setenv("TZ", ":/etc/localtime", 0);
-#endif /* __GLIBC__ */
-
-	// Store argv[0] globally.
-	argv0 = argv[0];
-
-	if (argc < 2) {
-		show_usage();
-		return EXIT_FAILURE;
-	}
-
-	// Check for arguments. (simple non-getopt version)
-	bool force = false;
-	int optind = 1;
-	for (; optind < argc; optind++) {
-		if (!argv[optind] || argv[optind][0] != '-') {
-			// End of options.
-			break;
-		}
-
-		// Allow multiple options in one argument, e.g. '-vf'.
-		for (int i = 1; argv[optind][i] != '\0'; i++) {
-			switch (argv[optind][i]) {
-				case 'v':
-					// Verbose mode is enabled.
-					verbose = true;
-					break;
-				case 'f':
-					// Force download is enabled.
-					force = true;
-					break;
-				default:
-					// Invalid parameter.
-					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
-					show_usage();
-					return EXIT_FAILURE;
-			}
-		}
-	}
-
-	if (optind >= argc) {
-		show_error(_T("No cache key specified."));
-		show_usage();
-		return EXIT_FAILURE;
-	}
-	const TCHAR *const cache_key = argv[optind];
-
 	tstring full_url;
 	bool check_newer = false;
 	CacheKeyError ckerr = verifyCacheKey(full_url, check_newer, cache_key);
@@ -327,28 +270,6 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 			return EXIT_FAILURE;
 	}
 
-	// IDownloader
-	unique_ptr<IDownloader> downloader(DownloaderFactory::create());
-	assert((bool)downloader);
-	if (!downloader) {
-		SHOW_ERROR(_T("Could not instantiate an IDownloader object."));
-		return EXIT_FAILURE;
-	}
-
-	if (verbose) {
-		_ftprintf(stderr, _T("Downloader class: %s\nUser-Agent: %s\nURL: %s\n"),
-			downloader->name(), downloader->userAgent().c_str(), full_url.c_str());
-	}
-
-	// Make sure we have a valid cache directory.
-	const string &cache_dir = LibCacheCommon::getCacheDirectory();
-	if (cache_dir.empty()) {
-		// Cache directory is invalid...
-		// This may happen if bubblewrap is in use.
-		SHOW_ERROR(_T("Unable to access cache directory. Check the sandbox environment!"));
-		return EXIT_FAILURE;
-	}
-
 	// Get the cache filename.
 	tstring cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
@@ -357,7 +278,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		return EXIT_FAILURE;
 	}
 	if (verbose) {
-		_ftprintf(stderr, _T("Cache Filename: %s\n"), cache_filename.c_str());
+		_ftprintf(stderr, _T("URL: %s\nCache Filename: %s\n"), full_url.c_str(), cache_filename.c_str());
 	}
 
 	// If the cache_filename is >= 240 characters, prepend "\\\\?\\".
@@ -428,6 +349,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	// Attempt to download the file.
 	// TODO: Configure this somewhere?
 	downloader->setMaxSize(4*1024*1024);
+	downloader->setIfModifiedSince(-1);
+	downloader->setRequestedMimeType(nullptr);
 
 	if (check_newer && filemtime >= 0) {
 		// Only download if the file on the server is newer than
@@ -505,3 +428,161 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		unlikely(dataSize == 1) ? "" : "s");
 	return EXIT_SUCCESS;
 }
+
+#ifndef _WIN32
+// Persistent mode: Exit if no requests are received within 30 seconds.
+// The client will start a new rp-download process if needed.
+static constexpr int PERSISTENT_IDLE_TIMEOUT = 30*1000;
+
+struct PersistentParams {
+	IDownloader *downloader;
+	bool force;
+};
+
+/**
+ * Persistent mode request handler.
+ * @param cache_key	[in] Cache key
+ * @param userdata	[in] PersistentParams
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int persistent_request_handler(const char *cache_key, void *userdata)
+{
+	const PersistentParams *const params = static_cast<const PersistentParams*>(userdata);
+	return download_cache_key(params->downloader, cache_key, params->force);
+}
+#endif /* !_WIN32 */
+
+/**
+ * rp-download: Download an image from a supported online database.
+ * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @return 0 on success; non-zero on error.
+ *
+ * TODO:
+ * - More error codes based on the error.
+ */
+int RP_C_API _tmain(int argc, TCHAR *argv[])
+{
+	// Create a downloader based on OS:
+	// - Linux: CurlDownloader
+	// - Windows: WinInetDownloader
+
+	// Syntax: rp-download cache_key
+	// Example: rp-download ds/coverM/US/ADAE.png
+
+	// Persistent mode: rp-download -s
+	// Cache keys are read from stdin. See RequestServer.hpp.
+
+	// If http_proxy or https_proxy are set, they will be used
+	// by the downloader code if supported.
+
+	// Enable security options.
+	rp_download_do_security_options();
+
+#ifdef __GLIBC__
+	// Reduce /etc/localtime stat() calls.
+	// References:
+	// - https://lwn.net/Articles/944499/
+	// - https://gitlab.com/procps-ng/procps/-/merge_requests/119
+	setenv("TZ", ":/etc/localtime", 0);
+#endif /* __GLIBC__ */
+
+	// Store argv[0] globally.
+	argv0 = argv[0];
+
+	if (argc < 2) {
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Check for arguments. (simple non-getopt version)
+	bool force = false;
+	bool persistent = false;
+	int optind = 1;
+	for (; optind < argc; optind++) {
+		if (!argv[optind] || argv[optind][0] != '-') {
+			// End of options.
+			break;
+		}
+
+		// Allow multiple options in one argument, e.g. '-vf'.
+		for (int i = 1; argv[optind][i] != '\0'; i++) {
+			switch (argv[optind][i]) {
+				case 'v':
+					// Verbose mode is enabled.
+					verbose = true;
+					break;
+				case 'f':
+					// Force download is enabled.
+					force = true;
+					break;
+#ifndef _WIN32
+				case 's':
+					// Persistent mode is enabled.
+					persistent = true;
+					break;
+#endif /* !_WIN32 */
+				default:
+					// Invalid parameter.
+					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
+					show_usage();
+					return EXIT_FAILURE;
+			}
+		}
+	}
+
+	const TCHAR *cache_key = nullptr;
+	if (!persistent) {
+		if (optind >= argc) {
+			show_error(_T("No cache key specified."));
+			show_usage();
+			return EXIT_FAILURE;
+		}
+		cache_key = argv[optind];
+	} else if (optind < argc) {
+		show_error(_T("Cache keys cannot be specified on the command line in persistent mode."));
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// IDownloader
+	unique_ptr<IDownloader> downloader(DownloaderFactory::create());
+	assert((bool)downloader);
+	if (!downloader) {
+		SHOW_ERROR(_T("Could not instantiate an IDownloader object."));
+		return EXIT_FAILURE;
+	}
+
+	if (verbose) {
+		_ftprintf(stderr, _T("Downloader class: %s\nUser-Agent: %s\n"),
+			downloader->name(), downloader->userAgent().c_str());
+	}
+
+	// Make sure we have a valid cache directory.
+	const string &cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty()) {
+		// Cache directory is invalid...
+		// This may happen if bubblewrap is in use.
+		SHOW_ERROR(_T("Unable to access cache directory. Check the sandbox environment!"));
+		return EXIT_FAILURE;
+	}
+
+#ifndef _WIN32
+	if (persistent) {
+		// Persistent mode: Process requests from stdin.
+		// The downloader is reused for all requests, which allows
+		// connections to be kept alive between downloads.
+		PersistentParams params;
+		params.downloader = downloader.get();
+		params.force = force;
+		const int ret = RequestServer::run(STDIN_FILENO, STDOUT_FILENO,
+			persistent_request_handler, &params, PERSISTENT_IDLE_TIMEOUT);
+		if (ret != 0) {
+			SHOW_ERROR(_T("Error processing requests: %s"), _tcserror(-ret));
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+#endif /* !_WIN32 */
+
+	return download_cache_key(downloader.get(), cache_key, force);
+}
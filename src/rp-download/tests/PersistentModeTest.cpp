@@ -0,0 +1,389 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download/tests)                *
+ * PersistentModeTest.cpp: Persistent mode tests.                          *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest_init.hpp"
+
+// rp-download
+#include "../RequestServer.hpp"
+#include "../CurlDownloader.hpp"
+
+// C includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ STL classes
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace RpDownload { namespace Tests {
+
+/**
+ * Minimal HTTP/1.1 server on localhost.
+ * Responds to every GET request with the request path as the body,
+ * and keeps connections alive until the client closes them.
+ */
+class HttpStandIn
+{
+public:
+	HttpStandIn();
+	~HttpStandIn();
+
+public:
+	RP_DISABLE_COPY(HttpStandIn)
+
+public:
+	/**
+	 * Start the server.
+	 * @return True on success; false on error.
+	 */
+	bool start(void);
+
+	/**
+	 * Get the server's URL prefix.
+	 * @return URL prefix, e.g. "http://127.0.0.1:12345"
+	 */
+	string urlPrefix(void) const;
+
+	int connectionCount(void) const { return m_connections; }
+	int requestCount(void) const { return m_requests; }
+
+private:
+	/**
+	 * Server thread.
+	 */
+	void run(void);
+
+	struct Client {
+		int fd;
+		string buf;
+	};
+
+	/**
+	 * Handle incoming data from a client.
+	 * @param client Client
+	 * @return True to keep the connection open; false to close it.
+	 */
+	bool handleClient(Client &client);
+
+private:
+	int m_listen_fd;
+	uint16_t m_port;
+	std::thread m_thread;
+	std::atomic<bool> m_stop;
+	std::atomic<int> m_connections;
+	std::atomic<int> m_requests;
+};
+
+HttpStandIn::HttpStandIn()
+	: m_listen_fd(-1)
+	, m_port(0)
+	, m_stop(false)
+	, m_connections(0)
+	, m_requests(0)
+{}
+
+HttpStandIn::~HttpStandIn()
+{
+	m_stop = true;
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	if (m_listen_fd >= 0) {
+		close(m_listen_fd);
+	}
+}
+
+bool HttpStandIn::start(void)
+{
+	m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (m_listen_fd < 0) {
+		return false;
+	}
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;	// any available port
+	socklen_t addrlen = sizeof(addr);
+	if (bind(m_listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+	    listen(m_listen_fd, 8) != 0 ||
+	    getsockname(m_listen_fd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen) != 0)
+	{
+		return false;
+	}
+	m_port = ntohs(addr.sin_port);
+
+	m_thread = std::thread(&HttpStandIn::run, this);
+	return true;
+}
+
+string HttpStandIn::urlPrefix(void) const
+{
+	return "http://127.0.0.1:" + std::to_string(m_port);
+}
+
+void HttpStandIn::run(void)
+{
+	vector<Client> clients;
+	vector<struct pollfd> pfds;
+
+	while (!m_stop) {
+		pfds.resize(clients.size() + 1);
+		pfds[0].fd = m_listen_fd;
+		pfds[0].events = POLLIN;
+		pfds[0].revents = 0;
+		for (size_t i = 0; i < clients.size(); i++) {
+			pfds[i+1].fd = clients[i].fd;
+			pfds[i+1].events = POLLIN;
+			pfds[i+1].revents = 0;
+		}
+
+		if (poll(pfds.data(), pfds.size(), 50) <= 0) {
+			continue;
+		}
+
+		// Check the clients first, since accepting a new
+		// connection will invalidate the pollfd indexes.
+		for (size_t i = clients.size(); i > 0; i--) {
+			if (pfds[i].revents == 0) {
+				continue;
+			}
+			if (!handleClient(clients[i-1])) {
+				close(clients[i-1].fd);
+				clients.erase(clients.begin() + (i-1));
+			}
+		}
+
+		if (pfds[0].revents & POLLIN) {
+			const int fd = accept(m_listen_fd, nullptr, nullptr);
+			if (fd >= 0) {
+				clients.push_back({fd, string()});
+				m_connections++;
+			}
+		}
+	}
+
+	for (const Client &client : clients) {
+		close(client.fd);
+	}
+}
+
+bool HttpStandIn::handleClient(Client &client)
+{
+	char buf[4096];
+	const ssize_t n = read(client.fd, buf, sizeof(buf));
+	if (n <= 0) {
+		// Connection closed.
+		return false;
+	}
+	client.buf.append(buf, static_cast<size_t>(n));
+
+	// Process all complete requests.
+	size_t end;
+	while ((end = client.buf.find("\r\n\r\n")) != string::npos) {
+		// Request line: "GET /path HTTP/1.1"
+		const size_t sp1 = client.buf.find(' ');
+		const size_t sp2 = client.buf.find(' ', sp1 + 1);
+		if (sp1 == string::npos || sp2 == string::npos || sp2 > end) {
+			return false;
+		}
+		const string path = client.buf.substr(sp1 + 1, sp2 - sp1 - 1);
+		client.buf.erase(0, end + 4);
+		m_requests++;
+
+		string response = "HTTP/1.1 200 OK\r\n"
+			"Content-Type: image/png\r\n"
+			"Content-Length: " + std::to_string(path.size()) + "\r\n"
+			"\r\n";
+		response += path;
+		if (write(client.fd, response.data(), response.size()) != static_cast<ssize_t>(response.size())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+class PersistentModeTest : public ::testing::Test
+{
+protected:
+	void SetUp(void) override
+	{
+		// Make sure cURL doesn't try to use a proxy server.
+		unsetenv("http_proxy");
+		unsetenv("all_proxy");
+		unsetenv("ALL_PROXY");
+	}
+
+public:
+	/**
+	 * Request handler that records the cache keys.
+	 * Cache keys starting with "bad/" fail.
+	 * @param cache_key	[in] Cache key
+	 * @param userdata	[in] vector<string>
+	 * @return 0 on success; 1 on error.
+	 */
+	static int record_handler(const char *cache_key, void *userdata)
+	{
+		static_cast<vector<string>*>(userdata)->emplace_back(cache_key);
+		return (!strncmp(cache_key, "bad/", 4) ? 1 : 0);
+	}
+
+	/**
+	 * Read all data from a file descriptor until EOF.
+	 * @param fd File descriptor
+	 * @return Data
+	 */
+	static string read_all(int fd)
+	{
+		string data;
+		char buf[1024];
+		ssize_t n;
+		while ((n = read(fd, buf, sizeof(buf))) > 0) {
+			data.append(buf, static_cast<size_t>(n));
+		}
+		return data;
+	}
+};
+
+/**
+ * Multiple pipelined requests are answered in order.
+ */
+TEST_F(PersistentModeTest, pipelinedRequests)
+{
+	int sv[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	// Send all requests at once, then close the write side.
+	static constexpr char requests[] =
+		"wii/disc/US/GALE01.png\n"
+		"\n"
+		"bad/key.png\r\n"
+		"ds/cover/US/ADAE.png\n"
+		"incomplete";
+	ASSERT_EQ(static_cast<ssize_t>(sizeof(requests)-1), write(sv[0], requests, sizeof(requests)-1));
+	ASSERT_EQ(0, shutdown(sv[0], SHUT_WR));
+
+	vector<string> keys;
+	EXPECT_EQ(0, RequestServer::run(sv[1], sv[1], record_handler, &keys, 1000));
+	close(sv[1]);
+
+	const vector<string> expected_keys = {
+		"wii/disc/US/GALE01.png",
+		"bad/key.png",
+		"ds/cover/US/ADAE.png",
+	};
+	EXPECT_EQ(expected_keys, keys);
+
+	EXPECT_EQ("0 wii/disc/US/GALE01.png\n"
+		  "1 bad/key.png\n"
+		  "0 ds/cover/US/ADAE.png\n", read_all(sv[0]));
+	close(sv[0]);
+}
+
+/**
+ * Overlong requests are rejected without affecting subsequent requests.
+ */
+TEST_F(PersistentModeTest, overlongRequest)
+{
+	int sv[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	string requests(RequestServer::MAX_REQUEST_LEN * 2, 'x');
+	requests += "\nds/cover/US/ADAE.png\n";
+	ASSERT_EQ(static_cast<ssize_t>(requests.size()), write(sv[0], requests.data(), requests.size()));
+	ASSERT_EQ(0, shutdown(sv[0], SHUT_WR));
+
+	vector<string> keys;
+	EXPECT_EQ(0, RequestServer::run(sv[1], sv[1], record_handler, &keys, 1000));
+	close(sv[1]);
+
+	ASSERT_EQ(1U, keys.size());
+	EXPECT_EQ("ds/cover/US/ADAE.png", keys[0]);
+	EXPECT_EQ("1 \n0 ds/cover/US/ADAE.png\n", read_all(sv[0]));
+	close(sv[0]);
+}
+
+/**
+ * The request loop exits if no requests are received within the idle timeout.
+ */
+TEST_F(PersistentModeTest, idleTimeout)
+{
+	int sv[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	vector<string> keys;
+	EXPECT_EQ(0, RequestServer::run(sv[1], sv[1], record_handler, &keys, 50));
+	EXPECT_TRUE(keys.empty());
+
+	close(sv[0]);
+	close(sv[1]);
+}
+
+/**
+ * CurlDownloader reuses the same connection for multiple downloads.
+ */
+TEST_F(PersistentModeTest, curlConnectionReuse)
+{
+	CurlDownloader downloader;
+	if (!downloader.isUsable()) {
+		GTEST_SKIP() << "libcurl is not available.";
+	}
+
+	HttpStandIn server;
+	ASSERT_TRUE(server.start());
+
+	static constexpr const char *paths[] = {
+		"/wii/disc/US/GALE01.png",
+		"/ds/cover/US/ADAE.png",
+		"/gba/title/US/AGBJ.png",
+	};
+	for (const char *path : paths) {
+		downloader.setUrl(server.urlPrefix() + path);
+		ASSERT_EQ(0, downloader.download());
+		ASSERT_EQ(strlen(path), downloader.dataSize());
+		EXPECT_EQ(0, memcmp(path, downloader.data(), downloader.dataSize()));
+	}
+
+	EXPECT_EQ(3, server.requestCount());
+	EXPECT_EQ(1, server.connectionCount());
+}
+
+} }
+
+#ifdef HAVE_SECCOMP
+const unsigned int rp_gtest_syscall_set = RP_GTEST_SYSCALL_SET_NETWORK;
+#endif /* HAVE_SECCOMP */
+
+/**
+ * Test suite main function
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fputs("rp-download test suite: Persistent mode tests\n\n", stderr);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -75,6 +75,9 @@ int rp_stub_do_security_options(bool config)
 
 		SCMP_SYS(getppid),	// dll-search.c: walk_proc_tree()
 
+		// ConfReader watches the configuration directory for changes.
+		SCMP_SYS(inotify_init1), SCMP_SYS(inotify_add_watch),
+
 		// ConfReader checks timestamps between rpcli runs.
 		// NOTE: Only seems to get triggered on PowerPC...
 		SCMP_SYS(clock_gettime), SCMP_SYS(clock_gettime64),
@@ -101,10 +104,24 @@ int rp_stub_do_security_options(bool config)
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),		// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 
+		// LibRomData::CacheIndex [CacheManager::download()]
+		SCMP_SYS(flock),
+		SCMP_SYS(rename), SCMP_SYS(renameat),
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),	// mkstemp() [glibc-2.34]
+#endif /* __SNR_getrandom */
+
 		// ExecRpDownload_posix.cpp
 		// FIXME: Need to fix the clone() check in librpsecure/os-secure_linux.c.
 		SCMP_SYS(clock_nanosleep), SCMP_SYS(clone), SCMP_SYS(fork),
 		SCMP_SYS(execve), SCMP_SYS(wait4),
+		// Persistent rp-download helpers
+		SCMP_SYS(socketpair), SCMP_SYS(poll), SCMP_SYS(ppoll),
+		SCMP_SYS(recvfrom), SCMP_SYS(kill), SCMP_SYS(dup2), SCMP_SYS(dup3),
 
 		// FIXME: Child process inherits the seccomp filter...
 		// rp-download child process
@@ -127,11 +144,12 @@ int rp_stub_do_security_options(bool config)
 	// - wpath: Write to the specified file.
 	// - cpath: Create the specified file if it doesn't exist. (TODO: Dirs only?)
 	// - getpw: Get user's home directory if HOME is empty.
+	// - flock: Lock the download cache index.
 	// - unix: UNIX domain sockets. (for D-Bus)
-	param.promises = "stdio rpath wpath cpath getpw unix";
+	param.promises = "stdio rpath wpath cpath getpw flock unix";
 #elif defined(HAVE_TAME)
 	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW | TAME_UNIX;
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW | TAME_FLOCK | TAME_UNIX;
 #else
 	param.dummy = 0;
 #endif
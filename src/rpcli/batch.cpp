@@ -0,0 +1,509 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * batch.cpp: Batch processing of multiple files using a worker pool.      *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.rpcli.h"
+#include "librpbase/config.librpbase.h"
+#include "batch.hpp"
+#include "common.h"
+
+// libgsvt for VT handling
+#include "gsvtpp.hpp"
+
+// Other rom-properties libraries
+#include "libi18n/i18n.hpp"
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextOut.hpp"
+#include "librpbase/config/Config.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+#include "libromdata/RomDataFactory.hpp"
+#ifdef ENABLE_DECRYPTION
+#  include "librpbase/crypto/KeyManager.hpp"
+#endif /* ENABLE_DECRYPTION */
+using namespace LibRpBase;
+using namespace LibRpFile;
+using namespace LibRomData;
+
+// d_type compatibility values
+#include "d_type.h"
+
+// OS-specific includes
+#ifdef _WIN32
+#  include "libwin32common/RpWin32_sdk.h"
+#  include "librptext/wchar.hpp"
+#else /* !_WIN32 */
+#  include <dirent.h>
+#endif /* _WIN32 */
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+using std::ostringstream;
+using std::string;
+using std::tstring;
+using std::vector;
+
+// libfmt
+#include "rp-libfmt.h"
+
+// Mini-T2U8()
+#ifdef _WIN32
+#  define T2U8c(tcs) (T2U8(tcs).c_str())
+#else /* !_WIN32 */
+#  define T2U8c(tcs) (tcs)
+#endif /* _WIN32 */
+
+/**
+ * Result of processing a single file in batch mode.
+ */
+struct BatchResult {
+	string out;	// Formatted output (text or JSON), or exception message if err == -2
+	int err;	// 0 on success; positive POSIX error code if the file couldn't be opened;
+			// -1 if the ROM is not supported; -2 if an exception was thrown.
+	unsigned int probes;	// Number of RomDataFactory detection probes
+	bool is_dir;	// True if this was opened as a directory.
+	bool done;	// True if this result is ready.
+
+	BatchResult()
+		: err(0)
+		, probes(0)
+		, is_dir(false)
+		, done(false)
+	{}
+};
+
+/**
+ * Escape a string for use as a JSON string value.
+ * @param str UTF-8 string
+ * @return Escaped string, including surrounding quotes
+ */
+static string json_escape(const char *str)
+{
+	string ret;
+	ret.reserve(strlen(str) + 2);
+	ret += '"';
+	for (; *str != '\0'; str++) {
+		const uint8_t chr = static_cast<uint8_t>(*str);
+		switch (chr) {
+			case '"':	ret += "\\\""; break;
+			case '\\':	ret += "\\\\"; break;
+			case '\b':	ret += "\\b"; break;
+			case '\f':	ret += "\\f"; break;
+			case '\n':	ret += "\\n"; break;
+			case '\r':	ret += "\\r"; break;
+			case '\t':	ret += "\\t"; break;
+			default:
+				if (chr < 0x20) {
+					ret += fmt::format(FSTR("\\u{:0>4x}"), chr);
+				} else {
+					ret += static_cast<char>(chr);
+				}
+				break;
+		}
+	}
+	ret += '"';
+	return ret;
+}
+
+/**
+ * Recursively add all regular files in a directory to a filename list.
+ * Entries are added in sorted order for reproducible output.
+ * @param path		[in] Directory path
+ * @param filenames	[in/out] Filename vector to append to
+ */
+static void walkDirectory(const tstring &path, vector<tstring> &filenames)
+{
+	vector<tstring> entries;
+
+#ifdef _WIN32
+	tstring pattern = path;
+	pattern += _T("\\*");
+	WIN32_FIND_DATA ffd;
+	HANDLE hFind = FindFirstFile(pattern.c_str(), &ffd);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (ffd.cFileName[0] == _T('.') &&
+		    (ffd.cFileName[1] == _T('\0') ||
+		     (ffd.cFileName[1] == _T('.') && ffd.cFileName[2] == _T('\0'))))
+		{
+			continue;
+		}
+		entries.emplace_back(ffd.cFileName);
+	} while (FindNextFile(hFind, &ffd));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		return;
+	}
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		if (dirent->d_name[0] == '.' &&
+		    (dirent->d_name[1] == '\0' ||
+		     (dirent->d_name[1] == '.' && dirent->d_name[2] == '\0')))
+		{
+			continue;
+		}
+		entries.emplace_back(dirent->d_name);
+	}
+	closedir(pdir);
+#endif /* _WIN32 */
+
+	std::sort(entries.begin(), entries.end());
+	for (const tstring &name : entries) {
+		tstring fullpath = path;
+		if (!fullpath.empty() && fullpath.back() != DIR_SEP_CHR) {
+			fullpath += DIR_SEP_CHR;
+		}
+		fullpath += name;
+
+		// NOTE: Symlinks are dereferenced, but symlinks to
+		// directories are not followed to prevent loops.
+		const uint8_t d_type = FileSystem::get_file_d_type(fullpath.c_str(), true);
+		if (d_type == DT_LNK) {
+			if (FileSystem::get_file_d_type(fullpath.c_str(), false) == DT_REG) {
+				filenames.emplace_back(std::move(fullpath));
+			}
+			continue;
+		}
+
+		switch (d_type) {
+			case DT_DIR:
+				walkDirectory(fullpath, filenames);
+				break;
+			case DT_REG:
+				filenames.emplace_back(std::move(fullpath));
+				break;
+			default:
+				// Skip devices, FIFOs, sockets, etc.
+				break;
+		}
+	}
+}
+
+/**
+ * Read a list of filenames, one per line.
+ * Empty lines are skipped. Lines are assumed to be UTF-8.
+ * @param listfile	[in] List filename, or "-" for stdin
+ * @param filenames	[in/out] Filename vector to append to
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ReadFileList(const TCHAR *listfile, vector<tstring> &filenames)
+{
+	std::ifstream ifs;
+	std::istream *is;
+	if (!_tcscmp(listfile, _T("-"))) {
+		is = &std::cin;
+	} else {
+		ifs.open(listfile);
+		if (!ifs.is_open()) {
+			return -ENOENT;
+		}
+		is = &ifs;
+	}
+
+	string line;
+	while (std::getline(*is, line)) {
+		// Remove trailing CRs from DOS-style lists.
+		while (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty())
+			continue;
+
+#ifdef _WIN32
+		filenames.emplace_back(U82T_s(line));
+#else /* !_WIN32 */
+		filenames.emplace_back(std::move(line));
+#endif /* _WIN32 */
+	}
+
+	return (is->bad() ? -EIO : 0);
+}
+
+/**
+ * Process a single file. (Called from worker threads.)
+ * @param filename	[in] Filename
+ * @param params	[in] Batch parameters
+ * @param result	[out] Result
+ */
+static void processFile(const tstring &filename, const BatchParams &params, BatchResult &result)
+{
+	RomDataPtr romData;
+
+	if (likely(!FileSystem::is_directory(filename))) {
+		IRpFilePtr file = std::make_shared<RpFile>(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+		if (!file->isOpen()) {
+			result.err = file->lastError();
+			if (result.err == 0) {
+				result.err = EIO;
+			}
+			return;
+		}
+		RomDataFactory::CreateStats stats;
+		romData = RomDataFactory::create(file, 0, &stats);
+		result.probes = stats.probes;
+	} else {
+		result.is_dir = true;
+		romData = RomDataFactory::create(filename.c_str());
+	}
+
+	if (!romData) {
+		result.err = -1;
+		return;
+	}
+
+	// Format the output here so the expensive parts
+	// (loadFieldData(), image decoding for JSON, etc.)
+	// run on the worker thread.
+	ostringstream oss;
+	if (params.json) {
+		oss << JSONROMOutput(romData.get(), params.flags);
+	} else {
+		oss << ROMOutput(romData.get(), params.lc, params.flags) << '\n';
+	}
+	result.out = oss.str();
+}
+
+/**
+ * Write a batch result to stdout, with status messages on stderr.
+ * @param filename	[in] Filename
+ * @param params	[in] Batch parameters
+ * @param result	[in] Result
+ * @param first		[in] True if this is the first JSON array element
+ */
+static void writeResult(const tstring &filename, const BatchParams &params, const BatchResult &result, bool first)
+{
+	// FIXME: Make T2U8c() unnecessary here.
+	Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_CYAN, true);
+	Gsvt::StdErr.fputs("== ");
+	Gsvt::StdErr.fputs(fmt::format(FRUN(result.is_dir
+			? C_("rpcli", "Reading directory '{:s}'...")
+			: C_("rpcli", "Reading file '{:s}'...")),
+		T2U8c(filename.c_str())));
+	Gsvt::StdErr.textColorReset();
+	Gsvt::StdErr.newline();
+	if (result.err != 0) {
+		Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_RED, true);
+		Gsvt::StdErr.fputs("-- ");
+		if (result.err > 0) {
+			Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Couldn't open file: {:s}")), strerror(result.err)));
+		} else if (result.err == -2) {
+			Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Error processing file: {:s}")), result.out));
+		} else {
+			Gsvt::StdErr.fputs(C_("rpcli", "ROM is not supported"));
+		}
+		Gsvt::StdErr.textColorReset();
+		Gsvt::StdErr.newline();
+	}
+	Gsvt::StdErr.fflush();
+
+	if (!params.json) {
+		if (result.err == 0) {
+			Gsvt::StdOut.fputs(result.out);
+			Gsvt::StdOut.newline();
+		}
+		Gsvt::StdOut.fflush();
+		return;
+	}
+
+	string obj;
+	if (result.err > 0) {
+		obj = fmt::format(FSTR("{{\"error\":\"couldn't open file\",\"code\":{:d}}}"), result.err);
+	} else if (result.err == -2) {
+		obj = "{\"error\":\"exception\",\"what\":";
+		obj += json_escape(result.out.c_str());
+		obj += '}';
+	} else if (result.err < 0) {
+		obj = "{\"error\":\"rom is not supported\"}";
+	}
+	const string &data = (result.err == 0) ? result.out : obj;
+
+	if (params.ndjson) {
+		// NDJSON: One object per line, tagged with the filename,
+		// since results are written in completion order.
+		string line = "{\"filename\":";
+		line += json_escape(T2U8c(filename.c_str()));
+		line += ",\"data\":";
+		line += data;
+		line += "}\n";
+		Gsvt::StdOut.fputs(line);
+	} else {
+		if (!first) {
+			Gsvt::StdOut.fputs(",\n");
+		}
+		Gsvt::StdOut.fputs(data);
+		Gsvt::StdOut.newline();
+	}
+	Gsvt::StdOut.fflush();
+}
+
+/**
+ * Process multiple files using a pool of worker threads.
+ *
+ * Each worker opens the file, calls RomDataFactory::create(), and
+ * formats the output into a string. The main thread writes the
+ * results to stdout in the same order as the filename list, unless
+ * NDJSON output is requested, in which case results are written as
+ * soon as they're available.
+ *
+ * @param filenames	[in] Filenames
+ * @param params	[in] Batch parameters
+ * @return 0 on success; non-zero if any files could not be processed.
+ */
+int DoBatch(const vector<tstring> &filenames, const BatchParams &params_in)
+{
+	BatchParams params = params_in;
+	if (params.ndjson) {
+		// NDJSON requires one object per line.
+		params.flags |= OF_JSON_NoPrettyPrint;
+	}
+
+	// Expand directories if recursion is enabled.
+	vector<tstring> vfiles;
+	if (params.recurse) {
+		vfiles.reserve(filenames.size());
+		for (const tstring &filename : filenames) {
+			if (FileSystem::is_directory(filename)) {
+				walkDirectory(filename, vfiles);
+			} else {
+				vfiles.emplace_back(filename);
+			}
+		}
+	}
+	const vector<tstring> &files = (params.recurse ? vfiles : filenames);
+
+	// Make sure the configuration singletons are loaded before starting
+	// the worker threads. Reloading is serialized internally, but loading
+	// everything up front prevents all workers from contending for the
+	// load mutexes on the first file.
+	Config::instance();
+#ifdef ENABLE_DECRYPTION
+	KeyManager::instance()->load();
+#endif /* ENABLE_DECRYPTION */
+
+	unsigned int threads = params.threads;
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+	if (threads > files.size()) {
+		threads = static_cast<unsigned int>(files.size());
+	}
+
+	if (params.json && !params.ndjson) {
+		Gsvt::StdOut.fputs("[\n");
+		Gsvt::StdOut.fflush();
+	}
+
+	vector<BatchResult> results(files.size());
+	std::atomic<size_t> nextIdx(0);
+	std::mutex mtxResults;
+	std::condition_variable cvResults;
+	vector<size_t> completed;	// NDJSON: indexes completed but not written yet
+	completed.reserve(threads);
+
+	auto worker = [&]() {
+		size_t idx;
+		while ((idx = nextIdx.fetch_add(1)) < files.size()) {
+			BatchResult result;
+			try {
+				processFile(files[idx], params, result);
+			} catch (const std::exception &e) {
+				// Report the exception as this file's error.
+				result = BatchResult();
+				result.err = -2;
+				result.out = e.what();
+			} catch (...) {
+				result = BatchResult();
+				result.err = -2;
+				result.out = "unknown exception";
+			}
+
+			std::lock_guard<std::mutex> mtxLocker(mtxResults);
+			results[idx] = std::move(result);
+			results[idx].done = true;
+			completed.push_back(idx);
+			cvResults.notify_one();
+		}
+	};
+
+	vector<std::thread> pool;
+	pool.reserve(threads);
+	for (unsigned int i = 0; i < threads; i++) {
+		pool.emplace_back(worker);
+	}
+
+	// Write the results from the main thread.
+	int ret = 0;
+	size_t written = 0;
+	uint64_t probes = 0;
+	size_t nextOrdered = 0;
+	while (written < files.size()) {
+		vector<size_t> toWrite;
+		{
+			std::unique_lock<std::mutex> mtxLocker(mtxResults);
+			if (params.ndjson) {
+				cvResults.wait(mtxLocker, [&]() { return !completed.empty(); });
+				toWrite.swap(completed);
+			} else {
+				cvResults.wait(mtxLocker, [&]() { return results[nextOrdered].done; });
+				while (nextOrdered < files.size() && results[nextOrdered].done) {
+					toWrite.push_back(nextOrdered++);
+				}
+				completed.clear();
+			}
+		}
+
+		for (size_t idx : toWrite) {
+			BatchResult &result = results[idx];
+			writeResult(files[idx], params, result, (written == 0));
+			if (result.err != 0) {
+				ret = 1;
+			}
+			probes += result.probes;
+			// Free the output buffer once it's written.
+			string().swap(result.out);
+			written++;
+		}
+	}
+
+	for (std::thread &thread : pool) {
+		thread.join();
+	}
+
+	if (params.json && !params.ndjson) {
+		Gsvt::StdOut.fputs("]\n");
+		Gsvt::StdOut.fflush();
+	}
+
+	// Detection statistics
+	if (!files.empty()) {
+		Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "-- {:d} files processed; {:d} detection probes ({:.2f} per file)")),
+			files.size(), probes, static_cast<double>(probes) / files.size()));
+		Gsvt::StdErr.newline();
+		Gsvt::StdErr.fflush();
+	}
+
+	return ret;
+}
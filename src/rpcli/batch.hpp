@@ -0,0 +1,60 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * batch.hpp: Batch processing of multiple files using a worker pool.      *
+ *                                                                         *
+ * Copyright (c) 2016-2026 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "tcharx.h"
+
+// C includes (C++ namespace)
+#include <cstdint>
+
+// C++ includes
+#include <string>
+#include <vector>
+
+struct BatchParams {
+	unsigned int threads;	// Number of worker threads (0 == number of CPUs)
+	uint32_t lc;		// Language code (0 for default)
+	unsigned int flags;	// ROMOutput flags (see OutputFlags)
+	bool json;		// Use JSON output format
+	bool ndjson;		// JSON: Output NDJSON in completion order instead of an array
+	bool recurse;		// Recurse into directories instead of opening them as RomData
+
+	BatchParams()
+		: threads(0)
+		, lc(0)
+		, flags(0)
+		, json(false)
+		, ndjson(false)
+		, recurse(false)
+	{}
+};
+
+/**
+ * Read a list of filenames, one per line.
+ * Empty lines are skipped. Lines are assumed to be UTF-8.
+ * @param listfile	[in] List filename, or "-" for stdin
+ * @param filenames	[in/out] Filename vector to append to
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ReadFileList(const TCHAR *listfile, std::vector<std::tstring> &filenames);
+
+/**
+ * Process multiple files using a pool of worker threads.
+ *
+ * Each worker opens the file, calls RomDataFactory::create(), and
+ * formats the output into a string. The main thread writes the
+ * results to stdout in the same order as the filename list, unless
+ * NDJSON output is requested, in which case results are written as
+ * soon as they're available.
+ *
+ * @param filenames	[in] Filenames
+ * @param params	[in] Batch parameters
+ * @return 0 on success; non-zero if any files could not be processed.
+ */
+int DoBatch(const std::vector<std::tstring> &filenames, const BatchParams &params);
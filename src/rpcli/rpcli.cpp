@@ -28,8 +28,13 @@
 #include "librpbase/img/RpPng.hpp"
 #include "librpbase/img/IconAnimData.hpp"
 #include "librpbase/TextOut.hpp"
+#include "librpbase/config/Config.hpp"
 using namespace LibRpBase;
 
+// librptext
+#include "librptext/formatting.hpp"
+using LibRpText::formatFileSize;
+
 // librpfile
 #include "librpfile/config.librpfile.h"
 #include "librpfile/FileSystem.hpp"
@@ -38,6 +43,7 @@ using namespace LibRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/CacheIndex.hpp"
 using namespace LibRomData;
 
 // librptexture
@@ -52,6 +58,7 @@ using namespace LibRpTexture;
 #ifdef ENABLE_DECRYPTION
 #  include "verifykeys.hpp"
 #endif /* ENABLE_DECRYPTION */
+#include "batch.hpp"
 #include "device.hpp"
 #include "printcpufeatures.hpp"
 
@@ -82,6 +89,7 @@ using std::ofstream;
 using std::ostringstream;
 using std::shared_ptr;
 using std::string;
+using std::tstring;
 using std::unique_ptr;
 using std::vector;
 
@@ -440,6 +448,93 @@ static void PrintPathnames(void)
 	Gsvt::StdOut.fflush();
 }
 
+/**
+ * Print the download cache usage.
+ * This only reads the cache index; the cache directory is not scanned.
+ * @return 0 on success; EXIT_FAILURE on error.
+ */
+static int PrintCacheUsage(void)
+{
+	CacheIndex::Usage usage;
+	int ret = CacheIndex::getUsage(usage);
+	if (ret == -ENOENT) {
+		// No index yet. The cache might have been populated
+		// by an older version, so build the index now.
+		ret = CacheIndex::rebuild();
+		if (ret >= 0) {
+			ret = CacheIndex::getUsage(usage);
+		}
+	}
+	if (ret != 0) {
+		Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_RED, true);
+		Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Unable to read the cache index: {:s}")), strerror(-ret)));
+		Gsvt::StdErr.textColorReset();
+		Gsvt::StdErr.newline();
+		Gsvt::StdErr.fflush();
+		return EXIT_FAILURE;
+	}
+
+	const uint32_t limit = Config::instance()->cacheSizeLimit();
+	// TODO: Localize these strings?
+	Gsvt::StdOut.fputs(fmt::format(FSTR(
+		"Cache files:             {:d}\n"
+		"Cache size:              {:s}\n"
+		"Cache size limit:        {:s}\n"),
+		usage.fileCount,
+		formatFileSize(static_cast<off64_t>(usage.totalSize)),
+		(limit != 0 ? formatFileSize(static_cast<off64_t>(limit) * 1024 * 1024) : string("unlimited"))));
+	Gsvt::StdOut.newline();
+	Gsvt::StdOut.fflush();
+	return 0;
+}
+
+/**
+ * Trim the download cache by deleting least-recently used files.
+ * @param s_size Maximum size in MiB, or empty string to use the configured limit.
+ * @return 0 on success; EXIT_FAILURE on error.
+ */
+static int TrimCache(const TCHAR *s_size)
+{
+	uint64_t maxSize;
+	if (s_size[0] != _T('\0')) {
+		TCHAR *endptr = nullptr;
+		const long mib = _tcstol(s_size, &endptr, 10);
+		if (*endptr != _T('\0') || mib < 0) {
+			Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_RED, true);
+			Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Invalid cache size '{:s}'")), T2U8c(s_size)));
+			Gsvt::StdErr.textColorReset();
+			Gsvt::StdErr.newline();
+			Gsvt::StdErr.fflush();
+			return EXIT_FAILURE;
+		}
+		maxSize = static_cast<uint64_t>(mib) * 1024U * 1024U;
+	} else {
+		const uint32_t limit = Config::instance()->cacheSizeLimit();
+		if (limit == 0) {
+			// No size limit. Nothing to do.
+			return 0;
+		}
+		maxSize = static_cast<uint64_t>(limit) * 1024U * 1024U;
+	}
+
+	const int ret = CacheIndex::trim(maxSize);
+	if (ret < 0) {
+		Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_RED, true);
+		Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Unable to trim the cache: {:s}")), strerror(-ret)));
+		Gsvt::StdErr.textColorReset();
+		Gsvt::StdErr.newline();
+		Gsvt::StdErr.fflush();
+		return EXIT_FAILURE;
+	}
+
+	Gsvt::StdOut.fputs(fmt::format(FRUN(NC_("rpcli",
+		"Deleted {:d} file from the cache.",
+		"Deleted {:d} files from the cache.", ret)), ret));
+	Gsvt::StdOut.newline();
+	Gsvt::StdOut.fflush();
+	return 0;
+}
+
 #ifdef RP_OS_SCSI_SUPPORTED
 /**
  * Run a SCSI INQUIRY command on a device.
@@ -607,12 +702,16 @@ static void ShowUsage(void)
 {
 	// TODO: Use argv[0] instead of hard-coding 'rpcli'?
 #ifdef ENABLE_DECRYPTION	
-	const char *const s_usage = C_("rpcli", "Usage: rpcli [-cCdjkpPS] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]...");
+	const char *const s_usage = C_("rpcli", "Usage: rpcli [-cCdjkpPSu] [-UN] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]...");
+	const char *const s_usage_batch = C_("rpcli", "       rpcli -t[N] [-jnr] [-cCdkpP] [-l lang] [-f listfile] [filename]...");
 #else /* !ENABLE_DECRYPTION */
-	const char *const s_usage = C_("rpcli", "Usage: rpcli [-cCdjpPS] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]...");
+	const char *const s_usage = C_("rpcli", "Usage: rpcli [-cCdjpPSu] [-UN] [-l lang] [[-xN outfile]... [-mN outfile]... [-a apngoutfile] filename]...");
+	const char *const s_usage_batch = C_("rpcli", "       rpcli -t[N] [-jnr] [-cCdpP] [-l lang] [-f listfile] [filename]...");
 #endif /* ENABLE_DECRYPTION */
 	Gsvt::StdErr.fputs(s_usage);
 	Gsvt::StdErr.newline();
+	Gsvt::StdErr.fputs(s_usage_batch);
+	Gsvt::StdErr.newline();
 
 	struct cmd_t {
 		char opt[8];	// TODO: Automatic padding?
@@ -621,10 +720,10 @@ static void ShowUsage(void)
 
 	// Normal commands
 #ifdef ENABLE_DECRYPTION
-	static const array<cmd_t, 12> cmds = {{
+	static const array<cmd_t, 14> cmds = {{
 		{"  -k:  ", NOP_C_("rpcli", "Verify encryption keys in keys.conf.")},
 #else /* !ENABLE_DECRYPTION */
-	static const array<cmd_t, 11> cmds = {{
+	static const array<cmd_t, 13> cmds = {{
 #endif /* ENABLE_DECRYPTION */
 		{"  -c:  ", NOP_C_("rpcli", "Print system region information.")},
 		{"  -C:  ", NOP_C_("rpcli", "Force-enable ANSI escape sequences.")},
@@ -634,6 +733,8 @@ static void ShowUsage(void)
 		{"  -p:  ", NOP_C_("rpcli", "Print system path information.")},
 		{"  -P:  ", NOP_C_("rpcli", "Print detected CPU features.")},
 		{"  -S:  ", NOP_C_("rpcli", "Disable Sixel/Kitty graphics. (only for terminal output)")},
+		{"  -u:  ", NOP_C_("rpcli", "Print download cache usage.")},
+		{"  -UN: ", NOP_C_("rpcli", "Trim the download cache to N MiB. (default is the configured limit)")},
 		{"  -xN: ", NOP_C_("rpcli", "Extract image N to outfile in PNG format.")},
 		{"  -mN: ", NOP_C_("rpcli", "Extract mipmap level N to outfile in PNG format.")},
 		{"  -a:  ", NOP_C_("rpcli", "Extract the animated icon to outfile in APNG format.")},
@@ -646,6 +747,23 @@ static void ShowUsage(void)
 	}
 	Gsvt::StdErr.newline();
 
+	// Commands for batch mode
+	static const array<cmd_t, 4> cmds_batch = {{
+		{"  -tN: ", NOP_C_("rpcli", "Batch mode: Process files using N worker threads. (default is the number of CPUs)")},
+		{"  -f:  ", NOP_C_("rpcli", "Batch mode: Read filenames from listfile, one per line. ('-' for stdin)")},
+		{"  -r:  ", NOP_C_("rpcli", "Batch mode: Recursively scan directories for files. (implies -t)")},
+		{"  -n:  ", NOP_C_("rpcli", "Batch mode: Output NDJSON in completion order instead of a JSON array. (implies -t)")},
+	}};
+
+	Gsvt::StdErr.fputs(C_("rpcli", "Special options for batch mode:"));
+	Gsvt::StdErr.newline();
+	for (const auto &p : cmds_batch) {
+		Gsvt::StdErr.fputs(p.opt);
+		Gsvt::StdErr.fputs(pgettext_expr("rpcli", p.desc));
+		Gsvt::StdErr.newline();
+	}
+	Gsvt::StdErr.newline();
+
 #ifdef RP_OS_SCSI_SUPPORTED
 	// Commands for devices
 	static const array<cmd_t, 3> cmds_dev = {{
@@ -674,6 +792,10 @@ static void ShowUsage(void)
 	Gsvt::StdErr.fputs("\t ");
 		Gsvt::StdErr.fputs(C_("rpcli", "extracts icon from pokeb2.nds"));
 		Gsvt::StdErr.newline();
+	Gsvt::StdErr.fputs("* rpcli -t8 -j -n -r roms/\n");
+	Gsvt::StdErr.fputs("\t ");
+		Gsvt::StdErr.fputs(C_("rpcli", "scans all files in roms/ using 8 threads and outputs NDJSON"));
+		Gsvt::StdErr.newline();
 	Gsvt::StdErr.fflush();
 }
 
@@ -792,18 +914,32 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		}
 	}
 
+	// Batch mode parameters
+	bool batch = false;
+	BatchParams batchParams;
+	vector<tstring> batchFiles;
+
 	// TODO: Switch to GNU getopt?
-	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
+	for (int i = 1; i < argc; i++) { // figure out the json and batch modes in advance
 		if (argv[i][0] == _T('-')) {
 			if (argv[i][1] == _T('j')) {
 				json = true;
 			} else if (argv[i][1] == _T('J')) {
 				json = true;
 				flags |= OF_JSON_NoPrettyPrint;
+			} else if (argv[i][1] == _T('t') || argv[i][1] == _T('f') || argv[i][1] == _T('r')) {
+				// NOTE: -r implies batch mode.
+				batch = true;
+			} else if (argv[i][1] == _T('n')) {
+				// NOTE: -n implies batch mode and JSON output.
+				batch = true;
+				json = true;
+				batchParams.ndjson = true;
 			}
 		}
 	}
-	if (json) {
+	if (json && !batch) {
+		// NOTE: In batch mode, DoBatch() handles the JSON array.
 		cout.flush();
 		Gsvt::StdOut.fputs("[\n");
 		Gsvt::StdOut.fflush();
@@ -941,6 +1077,17 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				doSixel = false;
 				break;
 
+			case _T('u'):
+				// Print the download cache usage.
+				ret = PrintCacheUsage();
+				break;
+
+			case _T('U'):
+				// Trim the download cache.
+				// NOTE: Size must be immediately after 'U'.
+				ret = TrimCache(&argv[i][2]);
+				break;
+
 			case _T('x'): {
 				const TCHAR *const ts_imgType = argv[i] + 2;
 				TCHAR *endptr = nullptr;
@@ -1005,6 +1152,63 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 			case _T('j'): // do nothing
 			case _T('J'): // still do nothing
+			case _T('n'): // handled above
+				break;
+
+			case _T('t'): {
+				// Batch mode: Number of worker threads.
+				// NOTE: Number is optional. If not specified, use the number of CPUs.
+				const TCHAR *const ts_threads = argv[i] + 2;
+				TCHAR *endptr = nullptr;
+				const long num = _tcstol(ts_threads, &endptr, 10);
+				if (*endptr != '\0' || num < 0 || num > 1024) {
+#ifdef _WIN32
+					// fmt::print() doesn't allow mixing narrow and wide strings.
+					const string s_threads = T2U8(ts_threads);
+#else /* !_WIN32 */
+					const char *const s_threads = ts_threads;
+#endif /* _WIN32 */
+					Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_YELLOW, true);
+					Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Warning: ignoring invalid thread count '{:s}'")), s_threads));
+					Gsvt::StdErr.textColorReset();
+					Gsvt::StdErr.newline();
+					Gsvt::StdErr.fflush();
+					break;
+				}
+				batchParams.threads = static_cast<unsigned int>(num);
+				break;
+			}
+
+			case _T('f'): {
+				// Batch mode: Read filenames from a list file.
+				// NOTE: Filename may be immediately after 'f',
+				// or it might be a completely separate argument.
+				const TCHAR *listfile;
+				if (argv[i][2] == _T('\0')) {
+					listfile = argv[++i];
+				} else {
+					listfile = &argv[i][2];
+				}
+				if (!listfile) {
+					break;
+				}
+
+				int lret = ReadFileList(listfile, batchFiles);
+				if (lret != 0) {
+					Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_RED, true);
+					Gsvt::StdErr.fputs(fmt::format(FRUN(C_("rpcli", "Couldn't read file list '{0:s}': {1:s}")),
+						T2U8c(listfile), strerror(-lret)));
+					Gsvt::StdErr.textColorReset();
+					Gsvt::StdErr.newline();
+					Gsvt::StdErr.fflush();
+					ret = EXIT_FAILURE;
+				}
+				break;
+			}
+
+			case _T('r'):
+				// Batch mode: Recursively scan directories.
+				batchParams.recurse = true;
 				break;
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -1049,6 +1253,17 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				Gsvt::StdErr.fflush();
 				break;
 			}
+		} else if (batch) {
+			// Batch mode: Files are processed after all arguments are parsed.
+			if (!extract.empty()) {
+				Gsvt::StdErr.textColorSet8(ANSI_COLOR_8_YELLOW, true);
+				Gsvt::StdErr.fputs(C_("rpcli", "Warning: image extraction is not supported in batch mode"));
+				Gsvt::StdErr.textColorReset();
+				Gsvt::StdErr.newline();
+				Gsvt::StdErr.fflush();
+				extract.clear();
+			}
+			batchFiles.emplace_back(argv[i]);
 		} else {
 			if (first) {
 				first = false;
@@ -1084,7 +1299,15 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 			extract.clear();
 		}
 	}
-	if (json) {
+	if (batch) {
+		// Process all files using the worker pool.
+		batchParams.lc = lc;
+		batchParams.flags = flags;
+		batchParams.json = json;
+		if (DoBatch(batchFiles, batchParams) != 0 && ret == 0) {
+			ret = EXIT_FAILURE;
+		}
+	} else if (json) {
 		cout.flush();
 		Gsvt::StdOut.fputs("]\n");
 		Gsvt::StdOut.fflush();
@@ -62,6 +62,20 @@ int rpcli_do_security_options(void)
 #endif /* __SNR_openat2 || __NR_openat2 */
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 
+		// LibRomData::CacheIndex (-u, -U)
+		SCMP_SYS(flock), SCMP_SYS(mkdir),
+		SCMP_SYS(rename), SCMP_SYS(renameat),
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),	// mkstemp() [glibc-2.34]
+#endif /* __SNR_getrandom */
+
+		// ConfReader watches the configuration directory for changes.
+		SCMP_SYS(inotify_init1), SCMP_SYS(inotify_add_watch),
+
 		// ConfReader checks timestamps between rpcli runs.
 		// NOTE: Only seems to get triggered on PowerPC...
 		SCMP_SYS(clock_gettime),
@@ -110,9 +124,10 @@ int rpcli_do_security_options(void)
 	// - wpath: Write to ~/.cache/rom-properties/
 	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
 	// - getpw: Get user's home directory if HOME is empty.
-	param.promises = "stdio rpath wpath cpath getpw";
+	// - flock: Lock the download cache index.
+	param.promises = "stdio rpath wpath cpath getpw flock";
 #elif defined(HAVE_TAME)
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW;
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH | TAME_GETPW | TAME_FLOCK;
 #else
 	param.dummy = 0;
 #endif